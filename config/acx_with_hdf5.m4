@@ -0,0 +1,54 @@
+# Check for HDF5.
+#
+# Sets $acx_with_hdf5 to yes if HDF5 is found and in working order; no otherwise
+#
+# If HDF5 is found, sets HDF5_INCLUDE, HDF5_LDFLAGS, and HDF5_LIBS
+AC_DEFUN([ACX_WITH_HDF5],
+[
+  acx_with_hdf5=no
+  AC_ARG_WITH([hdf5],
+    [AS_HELP_STRING([--with-hdf5@<:@=Install DIR@:>@], [Build with HDF5.])],
+    [
+      if test x"$withval" != xno; then
+        acx_with_hdf5=yes
+        if test x"$withval" != xyes; then
+          HDF5_INCLUDE="-I$withval/include"
+          HDF5_LDFLAGS="-L$withval/lib"
+        fi
+        HDF5_LIBS="-lhdf5"
+      fi
+    ]
+  )
+  
+  if test x"$acx_with_hdf5" != xno; then
+    # store the existing CPPFLAGS and LDFLAGS
+    my_CPPFLAGS=$CPPFLAGS
+    my_LDFLAGS=$LDFLAGS
+    my_LIBS=$LIBS
+
+    # append the HDF5 information and perform the tests
+    CPPFLAGS="$HDF5_INCLUDE $CPPFLAGS"
+    LDFLAGS="$HDF5_LDFLAGS $LDFLAGS"
+
+    # Check for the pressence of the necessary HDF5 headers
+    AC_CHECK_HEADER([hdf5.h], [],
+      [AC_MSG_WARN([Unable to find the hdf5.h header file.])
+       acx_with_hdf5=no])
+
+    # Check for the HDF5 library
+    AC_CHECK_LIB([hdf5], [H5Fcreate], [:],
+      [AC_MSG_WARN([Unable to link with the HDF5 library.])
+       acx_with_hdf5=no])
+
+    # revert the CPPFLAGS and LDFLAGS
+    CPPFLAGS=$my_CPPFLAGS
+    LDFLAGS=$my_LDFLAGS
+    LIBS=$my_LIBS
+  fi
+
+  if test x"$acx_with_hdf5" != xno; then
+    AC_SUBST([HDF5_INCLUDE], [$HDF5_INCLUDE])
+    AC_SUBST([HDF5_LDFLAGS], [$HDF5_LDFLAGS])
+    AC_SUBST([HDF5_LIBS], [$HDF5_LIBS])
+  fi
+])
@@ -0,0 +1,162 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bench-compare.cc
+ * \brief Compares benchmark results against a baseline, for catching
+ *    performance regressions.
+ *
+ * Usage: `bench-compare baseline.csv results.csv [tolerance]`. The files are
+ * those written by `make bench` (see molstat::bench::Header), possibly from
+ * different versions. Each benchmark in both files is listed with its time
+ * per item and the ratio of the times; a benchmark regresses if its time per
+ * item grows by more than the tolerance (a fraction, 0.25 by default).
+ * Benchmarks in only one of the files are listed, but are not regressions.
+ *
+ * The exit status is 0 if no benchmark regresses, 1 if any does, and 2 if
+ * the files cannot be read.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * \brief Splits a line of comma-separated values.
+ *
+ * \param[in] line The line.
+ * \return The values.
+ */
+vector<string> split_csv(const string &line)
+{
+	vector<string> ret;
+	istringstream stream{ line };
+	string value;
+
+	while(getline(stream, value, ','))
+		ret.push_back(value);
+
+	return ret;
+}
+
+/**
+ * \brief Reads the time per item of each benchmark from a results file.
+ *
+ * The columns are found from the header, so that files from versions with
+ * other columns can be compared.
+ *
+ * \throw std::runtime_error if the file cannot be read or has no
+ *    `benchmark` and `ns_per_item` columns.
+ *
+ * \param[in] filename The name of the file.
+ * \return The time per item (ns) of each benchmark.
+ */
+map<string, double> read_results(const string &filename)
+{
+	ifstream file{ filename };
+	string line;
+	if(!file.is_open() || !getline(file, line))
+		throw runtime_error("Unable to read \"" + filename + "\".");
+
+	const vector<string> header{ split_csv(line) };
+	size_t name_col{ header.size() }, time_col{ header.size() };
+	for(size_t j = 0; j < header.size(); ++j)
+	{
+		if(header[j] == "benchmark")
+			name_col = j;
+		else if(header[j] == "ns_per_item")
+			time_col = j;
+	}
+	if(name_col == header.size() || time_col == header.size())
+		throw runtime_error("\"" + filename + "\" does not have the " \
+			"benchmark and ns_per_item columns.");
+
+	map<string, double> ret;
+	while(getline(file, line))
+	{
+		const vector<string> values{ split_csv(line) };
+		if(values.size() > name_col && values.size() > time_col)
+			ret[values[name_col]] = atof(values[time_col].c_str());
+	}
+
+	return ret;
+}
+
+/**
+ * \brief Main function for comparing benchmark results.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 without regressions, 1 with regressions, 2 for
+ *    errors.
+ */
+int main(int argc, char **argv)
+{
+	if(argc < 3)
+	{
+		cerr << "Usage: " << argv[0] << " baseline.csv results.csv " \
+			"[tolerance]" << endl;
+		return 2;
+	}
+
+	const double tolerance{ argc > 3 ? atof(argv[3]) : 0.25 };
+	map<string, double> baseline, results;
+	try
+	{
+		baseline = read_results(argv[1]);
+		results = read_results(argv[2]);
+	}
+	catch(const runtime_error &e)
+	{
+		cerr << e.what() << endl;
+		return 2;
+	}
+
+	size_t nregressed{ 0 };
+	cout << "benchmark,baseline_ns_per_item,ns_per_item,ratio,status" << endl;
+	for(const auto &result : results)
+	{
+		const auto base = baseline.find(result.first);
+		if(base == baseline.end())
+		{
+			cout << result.first << ",," << result.second << ",,new" << endl;
+			continue;
+		}
+
+		const double ratio{ result.second / base->second };
+		const bool regressed{ ratio > 1. + tolerance };
+		if(regressed)
+			++nregressed;
+
+		ostringstream ratio_str;
+		ratio_str << fixed << setprecision(3) << ratio;
+		cout << result.first << ',' << base->second << ',' << result.second <<
+			',' << ratio_str.str() << ',' << (regressed ? "REGRESSED" : "ok") <<
+			endl;
+	}
+	for(const auto &base : baseline)
+		if(results.count(base.first) == 0)
+			cout << base.first << ',' << base.second << ",,,missing" << endl;
+
+	if(nregressed > 0)
+	{
+		cerr << nregressed << " benchmark(s) regressed by more than " <<
+			(100. * tolerance) << "%." << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,80 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bench-distributions.cc
+ * \brief Microbenchmarks for the random number distributions.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/uniform.h>
+#include <general/random_distributions/normal.h>
+#include <general/random_distributions/lognormal.h>
+#include <general/random_distributions/gamma.h>
+#include "benchmark.h"
+
+using namespace std;
+
+/**
+ * \brief Main function for the distribution benchmarks.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr size_t n = 4096;
+	const double min_time{ molstat::bench::MinimumTime(argc, argv) };
+
+	const vector<pair<string, shared_ptr<const molstat::RandomDistribution>>>
+		dists {
+			{ "constant", make_shared<molstat::ConstantDistribution>(1.) },
+			{ "uniform", make_shared<molstat::UniformDistribution>(0., 1.) },
+			{ "normal", make_shared<molstat::NormalDistribution>(0., 1.) },
+			{ "lognormal", make_shared<molstat::LognormalDistribution>(0., 1.) },
+			{ "gamma", make_shared<molstat::GammaDistribution>(2., 1.) }
+		};
+
+	for(const molstat::EngineKind kind : { molstat::EngineKind::Xoshiro256pp,
+		molstat::EngineKind::PCG64, molstat::EngineKind::Philox4x32 })
+	{
+		molstat::Engine engine{ 5489, 0, kind };
+		const string prefix{ "distribution/" +
+			molstat::EngineKindName(kind) + '/' };
+		vector<double> out(n);
+
+		for(const auto &dist : dists)
+		{
+			molstat::bench::Run(cout, prefix + dist.first + "/sample", n,
+				min_time,
+				[&engine, &dist] () -> void
+				{
+					double sum{ 0. };
+					for(size_t j = 0; j < n; ++j)
+						sum += dist.second->sample(engine);
+					molstat::bench::KeepValue(sum);
+				});
+
+			molstat::bench::Run(cout, prefix + dist.first + "/sample_n", n,
+				min_time,
+				[&engine, &dist, &out] () -> void
+				{
+					dist.second->sample_n(engine, out.data(), n);
+					molstat::bench::KeepValue(out[n-1]);
+				});
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bench-fitter.cc
+ * \brief Benchmarks for the transport fit models: evaluating the residuals
+ *    and Jacobians, and fitting from several initial guesses.
+ *
+ * Each model is benchmarked on synthetic histograms of 100 to \f$10^5\f$
+ * bins, with one thread and with the workers of a molstat::TaskScheduler
+ * (as in the fitter program), to show how the evaluations scale with the
+ * threads. The fits use the `lmsder` solver with at most `maxiter`
+ * iterations per guess; their items are the evaluations of the residuals,
+ * so that the benchmark reports the evaluations per second.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <algorithm>
+#include <array>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+#include <general/string_tools.h>
+#include <general/task_scheduler.h>
+#include <general/fitter_tools/fit_model_interface.h>
+#include <general/fitter_tools/fit_solver.h>
+#include <electron_transport/fitter_models/transport_fit_module.h>
+#include "benchmark.h"
+
+using namespace std;
+
+/**
+ * \brief Gets the numbers of threads for the scaling benchmarks: 1, 2, 4,
+ *    ..., and the number of hardware threads.
+ *
+ * \return The numbers of threads.
+ */
+static vector<size_t> thread_counts()
+{
+	const size_t nhardware{ max(1u, thread::hardware_concurrency()) };
+
+	vector<size_t> ret;
+	for(size_t n = 1; n < nhardware; n *= 2)
+		ret.push_back(n);
+	ret.push_back(nhardware);
+	return ret;
+}
+
+/**
+ * \brief Fits a model from each of several initial guesses, in parallel.
+ *
+ * \param[in] model The model.
+ * \param[in] solver The factory for the solver.
+ * \param[in] guesses The initial guesses.
+ * \param[in] maxiter The maximum number of iterations per guess.
+ * \param[in] scheduler The scheduler that runs the guesses.
+ * \return The number of evaluations of the residuals.
+ */
+static size_t fit_guesses(molstat::FitModel<1> &model,
+	const molstat::FitSolverFactory &solver,
+	const vector<vector<double>> &guesses, size_t maxiter,
+	molstat::TaskScheduler &scheduler)
+{
+	gsl_multifit_function_fdf fdf{ model.gsl_handle() };
+	const molstat::FitTolerance tol;
+	vector<molstat::FitProfile> profiles(guesses.size());
+
+	scheduler.run(guesses.size(),
+		[&model, &solver, &guesses, maxiter, &fdf, &tol, &profiles]
+		(size_t j, size_t) -> void
+		{
+			const molstat::FitProfileScope scope{ profiles[j] };
+
+			unique_ptr<gsl_vector, decltype(&gsl_vector_free)>
+				initval{ gsl_vector_alloc(model.nfit), &gsl_vector_free };
+			for(size_t p = 0; p < model.nfit; ++p)
+				gsl_vector_set(initval.get(), p, guesses[j][p]);
+
+			const unique_ptr<molstat::FitSolver> fit{ solver(fdf,
+				initval.get()) };
+			int status{ GSL_CONTINUE };
+			for(size_t iter = 0; status == GSL_CONTINUE && iter < maxiter;
+				++iter)
+			{
+				status = fit->iterate();
+				if(status == GSL_SUCCESS)
+					status = fit->test(tol);
+			}
+			molstat::bench::KeepValue(gsl_vector_get(fit->position(), 0));
+		});
+
+	size_t nresid{ 0 };
+	for(const molstat::FitProfile &profile : profiles)
+		nresid += profile.nresid;
+	return nresid;
+}
+
+/**
+ * \brief Main function for the fitter benchmarks.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	// the fits are only run while the bins times the guesses is at most
+	// max_fit_points, so that the largest histograms do not take minutes
+	constexpr size_t maxiter = 20, max_fit_points = 100000;
+	const vector<size_t> sizes{ 100, 1000, 10000, 100000 },
+		nguesses{ 1, 4, 16 };
+	const double min_time{ molstat::bench::MinimumTime(argc, argv) };
+
+	// failed fits are reported by their status; do not abort
+	gsl_set_error_handler_off();
+
+	molstat::NameRegistry<molstat::FitModelFactory<1>> models;
+	molstat::transport::load_models(models);
+	const molstat::FitSolverFactory solver{
+		molstat::GetFitSolverFactory(molstat::tokenize("lmsder")) };
+
+	// one scheduler for each number of threads, reused by every benchmark
+	vector<unique_ptr<molstat::TaskScheduler>> schedulers;
+	for(const size_t nthreads : thread_counts())
+		schedulers.emplace_back(new molstat::TaskScheduler(nthreads));
+
+	for(const size_t ndata : sizes)
+	{
+		// a histogram-like data set on (0, 1)
+		list<pair<array<double, 1>, double>> data;
+		for(size_t j = 0; j < ndata; ++j)
+		{
+			const double x{ (j + 0.5) / ndata };
+			data.emplace_back(array<double, 1>{{ x }}, x * (1. - x));
+		}
+
+		for(const auto &factory : models)
+		{
+			const unique_ptr<molstat::FitModel<1>> model{
+				factory.second(data) };
+
+			// evaluate at the first default initial guess
+			list<vector<double>> defaults;
+			model->append_default_guesses(defaults);
+			if(defaults.empty())
+				continue;
+			const vector<double> &guess = defaults.front();
+
+			gsl_multifit_function_fdf handle{ model->gsl_handle() };
+			unique_ptr<gsl_vector, decltype(&gsl_vector_free)>
+				x{ gsl_vector_alloc(handle.p), &gsl_vector_free },
+				f{ gsl_vector_alloc(handle.n), &gsl_vector_free };
+			unique_ptr<gsl_matrix, decltype(&gsl_matrix_free)>
+				J{ gsl_matrix_alloc(handle.n, handle.p), &gsl_matrix_free };
+			for(size_t p = 0; p < handle.p; ++p)
+				gsl_vector_set(x.get(), p, guess[p]);
+
+			const string prefix{ "fitter/" + factory.first + '/' +
+				to_string(ndata) + '/' };
+
+			molstat::bench::Run(cout, prefix + "residual", ndata, min_time,
+				[&handle, &x, &f] () -> void
+				{
+					handle.f(x.get(), handle.params, f.get());
+					molstat::bench::KeepValue(gsl_vector_get(f.get(), 0));
+				});
+
+			molstat::bench::Run(cout, prefix + "jacobian", ndata, min_time,
+				[&handle, &x, &J] () -> void
+				{
+					handle.df(x.get(), handle.params, J.get());
+					molstat::bench::KeepValue(gsl_matrix_get(J.get(), 0, 0));
+				});
+
+			// scaling with the threads
+			for(const unique_ptr<molstat::TaskScheduler> &scheduler :
+				schedulers)
+			{
+				model->set_scheduler(scheduler.get());
+				molstat::bench::Run(cout, prefix + "residual_jacobian/threads" +
+					to_string(scheduler->numWorkers()), ndata, min_time,
+					[&handle, &x, &f, &J] () -> void
+					{
+						handle.fdf(x.get(), handle.params, f.get(), J.get());
+						molstat::bench::KeepValue(
+							gsl_matrix_get(J.get(), 0, 0));
+					});
+			}
+
+			// fits from the first default guesses (repeated if there are
+			// fewer); the guesses and data points share the threads
+			for(const size_t nguess : nguesses)
+			{
+				if(ndata * nguess > max_fit_points)
+					continue;
+
+				vector<vector<double>> guesses;
+				while(guesses.size() < nguess)
+					for(const vector<double> &g : defaults)
+						if(guesses.size() < nguess)
+							guesses.push_back(g);
+
+				for(const unique_ptr<molstat::TaskScheduler> &scheduler :
+					schedulers)
+				{
+					model->set_scheduler(scheduler.get());
+
+					// the fits are deterministic: count the evaluations once
+					const size_t nresid{ fit_guesses(*model, solver, guesses,
+						maxiter, *scheduler) };
+
+					molstat::bench::Run(cout, prefix + "fit/guesses" +
+						to_string(nguess) + "/threads" +
+						to_string(scheduler->numWorkers()),
+						max<size_t>(1, nresid), min_time,
+						[&model, &solver, &guesses, &scheduler] () -> void
+						{
+							fit_guesses(*model, solver, guesses, maxiter,
+								*scheduler);
+						});
+				}
+			}
+			model->set_scheduler(nullptr);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bench-histogram.cc
+ * \brief Microbenchmarks for binning data into histograms.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <general/task_scheduler.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/lognormal.h>
+#include "benchmark.h"
+
+using namespace std;
+
+/**
+ * \brief Benchmarks binning data with the specified bin styles.
+ *
+ * \param[in] name The name of the binning (e.g., "1d-linear").
+ * \param[in] styles The bin styles, with fixed bounds.
+ * \param[in] data The data (row-major).
+ * \param[in] min_time The minimum time (s) for each benchmark.
+ */
+void bench_binning(const string &name,
+	const vector<shared_ptr<const molstat::BinStyle>> &styles,
+	const vector<double> &data, double min_time)
+{
+	const size_t ndim{ styles.size() };
+	const size_t n{ data.size() / ndim };
+
+	// store the data and then bin it
+	molstat::bench::Run(cout, "histogram/" + name + "/bin_data", n, min_time,
+		[&styles, &data, ndim, n] () -> void
+		{
+			molstat::Histogram hist(ndim);
+			hist.add_data(data.data(), n);
+			hist.bin_data(styles);
+			molstat::bench::KeepValue(hist.getBinCount(hist.begin()));
+		});
+
+	// store the data and then bin it with every hardware thread
+	molstat::TaskScheduler scheduler{ thread::hardware_concurrency() };
+	molstat::bench::Run(cout, "histogram/" + name + "/bin_data-parallel", n,
+		min_time, [&styles, &data, &scheduler, ndim, n] () -> void
+		{
+			molstat::Histogram hist(ndim);
+			hist.add_data(data.data(), n);
+			hist.bin_data(styles, &scheduler);
+			molstat::bench::KeepValue(hist.getBinCount(hist.begin()));
+		});
+
+	// bin the data as it is added (the styles have fixed bounds)
+	molstat::Histogram streaming(styles);
+	molstat::bench::Run(cout, "histogram/" + name + "/streaming", n, min_time,
+		[&streaming, &data, n] () -> void
+		{
+			streaming.add_data(data.data(), n);
+		});
+}
+
+/**
+ * \brief Main function for the histogram benchmarks.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr size_t n = 100000;
+	constexpr size_t nbins = 100;
+	const double min_time{ molstat::bench::MinimumTime(argc, argv) };
+
+	// the data are positive so that logarithmic binning can be used
+	molstat::Engine engine{ 5489, 0, molstat::EngineKind::Xoshiro256pp };
+	const molstat::LognormalDistribution dist{ -2., 1. };
+	vector<double> data(2 * n);
+	dist.sample_n(engine, data.data(), data.size());
+
+	const auto make_style = [nbins] (bool logarithmic)
+		-> shared_ptr<const molstat::BinStyle>
+	{
+		shared_ptr<molstat::BinStyle> ret;
+		if(logarithmic)
+			ret = make_shared<molstat::BinLog>(nbins, 10.);
+		else
+			ret = make_shared<molstat::BinLinear>(nbins);
+
+		ret->setBounds(1.e-4, 10.);
+		return ret;
+	};
+
+	bench_binning("1d-linear", { make_style(false) },
+		vector<double>(data.begin(), data.begin() + n), min_time);
+	bench_binning("1d-log", { make_style(true) },
+		vector<double>(data.begin(), data.begin() + n), min_time);
+	bench_binning("2d-linear", { make_style(false), make_style(false) }, data,
+		min_time);
+	bench_binning("2d-log", { make_style(true), make_style(true) }, data,
+		min_time);
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bench-simulator.cc
+ * \brief Microbenchmarks for simulating trials and for routing parameters
+ *    through composite observables.
+ *
+ * The composite models are those used by the test suite.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <typeindex>
+#include <valarray>
+#include <vector>
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/identity_tools.h>
+#include <general/simulator_tools/simulate_model.h>
+#include <general/tests/simulate_model_interface_models.h>
+#include "benchmark.h"
+#include "model_benchmark.h"
+
+/**
+ * \brief Main function for the simulator benchmarks.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	const double min_time{ molstat::bench::MinimumTime(argc, argv) };
+
+	// a trivial model, for the overhead of the simulator
+	{
+		molstat::SimulateModelFactory factory
+			{ molstat::SimulateModelFactory::makeFactory<molstat::IdentityModel>() };
+		factory.setDistribution("parameter",
+			make_shared<molstat::UniformDistribution>(-1., 1.));
+
+		molstat::bench::RunModel("simulator/identity", factory.getModel(),
+			type_index{ typeid(molstat::IdentityObservable) }, min_time);
+	}
+
+	// composite models with several submodels
+	for(const size_t nsub : { 1, 4 })
+	{
+		molstat::SimulateModelFactory cfactory
+			{ molstat::SimulateModelFactory::makeFactory<CompositeTestModelAdd>() };
+		cfactory.setDistribution("ef",
+			make_shared<molstat::UniformDistribution>(-1., 1.));
+		cfactory.setDistribution("v",
+			make_shared<molstat::UniformDistribution>(0., 2.));
+
+		for(size_t k = 0; k < nsub; ++k)
+		{
+			molstat::SimulateModelFactory subfactory
+				{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+			subfactory.setDistribution("eps",
+				make_shared<molstat::UniformDistribution>(-5., 5.));
+			subfactory.setDistribution("gamma",
+				make_shared<molstat::UniformDistribution>(0.1, 1.));
+			cfactory.addSubmodel(subfactory.getModel());
+		}
+
+		molstat::bench::RunModel("composite/" + to_string(nsub) + "-submodels",
+			cfactory.getModel(), type_index{ typeid(BasicObs1) }, min_time);
+	}
+
+	return 0;
+}
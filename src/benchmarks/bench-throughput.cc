@@ -0,0 +1,141 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bench-throughput.cc
+ * \brief Throughput benchmarks for the simulator's sampling path.
+ *
+ * As in `tests/simulator-dists.py`, the parameter of molstat::IdentityModel
+ * is sampled from each type of distribution (specified as in an input file),
+ * and the observables are binned into a histogram. The trials are simulated
+ * one at a time, in batches, and in batches on every hardware thread (each
+ * with its own stream and histogram, as in the simulator program).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <typeindex>
+#include <utility>
+#include <valarray>
+#include <vector>
+#include <general/string_tools.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/random_distributions/rng.h>
+#include <general/simulator_tools/identity_tools.h>
+#include <general/simulator_tools/simulate_model.h>
+#include <general/simulator_tools/simulator.h>
+#include "benchmark.h"
+
+using namespace std;
+
+/**
+ * \brief Benchmarks simulating and binning trials for one distribution.
+ *
+ * \param[in] name The name of the distribution.
+ * \param[in] spec The distribution, as in an input file.
+ * \param[in] min_time The minimum time (s) for each benchmark.
+ */
+void bench_throughput(const string &name, const string &spec,
+	double min_time)
+{
+	constexpr size_t n = 16384;
+	const string prefix{ "throughput/" + name + '/' };
+
+	molstat::SimulateModelFactory factory{
+		molstat::SimulateModelFactory::makeFactory<molstat::IdentityModel>() };
+	factory.setDistribution("parameter",
+		molstat::RandomDistributionFactory(molstat::tokenize(spec)));
+
+	molstat::Simulator sim{ factory.getModel() };
+	sim.setObservable(0, type_index{ typeid(molstat::IdentityObservable) });
+
+	// a fixed range, so that the histogram is binned as the data are added
+	shared_ptr<molstat::BinStyle> style{ make_shared<molstat::BinLinear>(100) };
+	style->setBounds(-10., 10.);
+	const vector<shared_ptr<const molstat::BinStyle>> styles{ style };
+
+	molstat::Engine engine{ 5489, 0, molstat::EngineKind::Xoshiro256pp };
+	molstat::Histogram hist(styles);
+	molstat::bench::Run(cout, prefix + "single", n, min_time,
+		[&sim, &engine, &hist] () -> void
+		{
+			for(size_t t = 0; t < n; ++t)
+			{
+				const valarray<double> obs{ sim.simulate(engine) };
+				hist.add_data(&obs[0], 1);
+			}
+		});
+
+	vector<double> out(n), workspace;
+	molstat::bench::Run(cout, prefix + "batch", n, min_time,
+		[&sim, &engine, &hist, &out, &workspace] () -> void
+		{
+			hist.add_data(out.data(),
+				sim.simulateBatch(engine, n, out.data(), workspace));
+		});
+
+	// each thread has its own stream, workspace, and histogram
+	const size_t nthreads{ max(1u, thread::hardware_concurrency()) };
+	vector<molstat::Engine> engines;
+	vector<molstat::Histogram> hists;
+	vector<vector<double>> outs(nthreads, vector<double>(n)),
+		workspaces(nthreads);
+	for(size_t t = 0; t < nthreads; ++t)
+	{
+		engines.push_back(engine.stream(t + 1));
+		hists.emplace_back(styles);
+	}
+
+	molstat::bench::Run(cout, prefix + "batch_threads", nthreads * n,
+		min_time,
+		[&sim, &engines, &hists, &outs, &workspaces, nthreads] () -> void
+		{
+			vector<thread> threads;
+			for(size_t t = 0; t < nthreads; ++t)
+				threads.emplace_back(
+					[&sim, &engines, &hists, &outs, &workspaces, t] () -> void
+					{
+						hists[t].add_data(outs[t].data(),
+							sim.simulateBatch(engines[t], n, outs[t].data(),
+								workspaces[t]));
+					});
+			for(thread &th : threads)
+				th.join();
+		});
+}
+
+/**
+ * \brief Main function for the throughput benchmarks.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	const double min_time{ molstat::bench::MinimumTime(argc, argv) };
+
+	const vector<pair<string, string>> dists {
+		{ "constant", "constant 5" },
+		{ "uniform", "uniform -2 2" },
+		{ "normal", "normal 1 2" },
+		{ "lognormal", "lognormal 0 0.5" },
+		{ "gamma", "gamma 2 1" },
+		{ "poisson", "poisson 3" },
+		{ "normal-truncated", "normal 1 2 truncate 0 inf" }
+	};
+
+	for(const auto &dist : dists)
+		bench_throughput(dist.first, dist.second, min_time);
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bench-transport.cc
+ * \brief Microbenchmarks for the observables of the transport channels.
+ *
+ * Each channel is placed in a molstat::transport::TransportJunction, so the
+ * benchmarks include the routing of parameters through the junction's
+ * composite observables.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/simulate_model.h>
+#include <general/simulator_tools/simulator_exceptions.h>
+#include <electron_transport/simulator_models/transport_simulate_module.h>
+#include "benchmark.h"
+#include "model_benchmark.h"
+
+using namespace std;
+
+/// The range of values for a model parameter.
+using ParameterRange = pair<string, pair<double, double>>;
+
+/**
+ * \brief Main function for the transport benchmarks.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	const double min_time{ molstat::bench::MinimumTime(argc, argv) };
+
+	molstat::NameRegistry<molstat::SimulateModelFactoryFunction> models;
+	molstat::transport::load_models(models);
+	molstat::NameRegistry<molstat::ObservableIndex> observables;
+	molstat::transport::load_observables(observables);
+
+	// the channels and their parameters
+	const vector<pair<string, vector<ParameterRange>>> channels {
+		{ "symmetriconesitechannel", { { "epsilon", { -1., 1. } },
+			{ "gamma", { 0.1, 0.5 } }, { "a", { -0.1, 0.1 } },
+			{ "nm", { 1., 2. } } } },
+		{ "asymmetriconesitechannel", { { "epsilon", { -1., 1. } },
+			{ "gammal", { 0.1, 0.5 } }, { "gammar", { 0.1, 0.5 } },
+			{ "a", { -0.1, 0.1 } } } },
+		{ "symmetrictwositechannel", { { "epsilon", { -1., 1. } },
+			{ "gamma", { 0.1, 0.5 } }, { "beta", { -1., -0.5 } } } },
+		{ "asymmetrictwositechannel", { { "epsilon", { -1., 1. } },
+			{ "gammal", { 0.1, 0.5 } }, { "gammar", { 0.1, 0.5 } },
+			{ "beta", { -1., -0.5 } } } },
+		{ "interferencechannel", { { "epsilon", { -1., 1. } },
+			{ "gamma", { 0.1, 0.5 } }, { "beta", { -1., -0.5 } } } },
+		{ "rectangularbarrierchannel", { { "height", { 4., 5. } },
+			{ "width", { 0.5, 1. } } } }
+	};
+
+	for(const size_t nchannels : { 1, 3 })
+	{
+		for(const auto &channel : channels)
+		{
+			molstat::SimulateModelFactory junction
+				{ models.at("transportjunction")() };
+			junction.setDistribution("ef",
+				make_shared<molstat::UniformDistribution>(-0.5, 0.5));
+			junction.setDistribution("v",
+				make_shared<molstat::UniformDistribution>(0.1, 1.));
+
+			for(size_t k = 0; k < nchannels; ++k)
+			{
+				molstat::SimulateModelFactory factory
+					{ models.at(channel.first)() };
+				for(const ParameterRange &param : channel.second)
+				{
+					factory.setDistribution(param.first,
+						make_shared<molstat::UniformDistribution>(
+							param.second.first, param.second.second));
+				}
+				junction.addSubmodel(factory.getModel());
+			}
+
+			shared_ptr<molstat::SimulateModel> model{ junction.getModel() };
+
+			// benchmark each observable the channel implements
+			for(const auto &obs : observables)
+			{
+				try
+				{
+					model->getObservableFunction(obs.second);
+				}
+				catch(const molstat::IncompatibleObservable &e)
+				{
+					continue;
+				}
+
+				molstat::bench::RunModel("transport/" + channel.first + '/' +
+					to_string(nchannels) + "-channels/" + obs.first, model,
+					obs.second, min_time);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,70 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file benchmark.cc
+ * \brief Implements the tools for the microbenchmarks.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <config.h>
+#include "benchmark.h"
+#include <chrono>
+#include <cstdlib>
+
+namespace molstat {
+namespace bench {
+
+/// Sink for molstat::bench::KeepValue.
+static volatile double kept_value{ 0. };
+
+std::string Header()
+{
+	return "version,benchmark,calls,items_per_call,seconds,ns_per_item," \
+		"items_per_second";
+}
+
+void KeepValue(double value)
+{
+	kept_value = value;
+}
+
+double MinimumTime(int argc, char **argv)
+{
+	if(argc > 1)
+	{
+		const double ret{ std::atof(argv[1]) };
+		if(ret > 0.)
+			return ret;
+	}
+
+	return 0.2;
+}
+
+void Run(std::ostream &output, const std::string &name, std::size_t items,
+	double min_time, const std::function<void()> &func)
+{
+	// warm up (caches, lazily allocated workspaces, etc.)
+	func();
+
+	std::size_t calls{ 0 };
+	double elapsed{ 0. };
+	const Clock::time_point start{ Clock::now() };
+	do
+	{
+		func();
+		++calls;
+		elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	} while(elapsed < min_time);
+
+	output << PACKAGE_VERSION << ',' << name << ',' << calls << ',' << items <<
+		',' << elapsed << ',' << (1.e9 * elapsed / (calls * items)) << ',' <<
+		(calls * items / elapsed) << std::endl;
+}
+
+} // namespace molstat::bench
+} // namespace molstat
@@ -0,0 +1,84 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file benchmark.h
+ * \brief Tools for the microbenchmarks run by `make bench`.
+ *
+ * Each benchmark program prints one line of comma-separated values per
+ * benchmark (see molstat::bench::Header for the columns), so that results
+ * can be collected and compared across versions.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __benchmark_h__
+#define __benchmark_h__
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+namespace molstat {
+namespace bench {
+
+/**
+ * \brief The clock used to time the benchmarks.
+ *
+ * The high-resolution clock is used where it is monotonic (it is an alias of
+ * the system clock with some standard libraries, which can be adjusted while
+ * a benchmark runs); otherwise, the steady clock.
+ */
+using Clock = std::conditional<std::chrono::high_resolution_clock::is_steady,
+	std::chrono::high_resolution_clock, std::chrono::steady_clock>::type;
+
+/**
+ * \brief The header line for the benchmark results.
+ *
+ * \return The names of the columns.
+ */
+std::string Header();
+
+/**
+ * \brief Keeps the compiler from discarding a calculated value.
+ *
+ * \param[in] value The value.
+ */
+void KeepValue(double value);
+
+/**
+ * \brief Gets the minimum time to spend on each benchmark.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments; the first (if present) is the
+ *    time in seconds.
+ * \return The minimum time (s); 0.2 if unspecified.
+ */
+double MinimumTime(int argc, char **argv);
+
+/**
+ * \brief Times a benchmark and prints its results.
+ *
+ * The function is called once to warm up, and then repeatedly until at
+ * least `min_time` seconds have elapsed.
+ *
+ * \param[out] output The output stream.
+ * \param[in] name The name of the benchmark.
+ * \param[in] items The number of items (e.g., trials or samples) processed
+ *    by each call to `func`.
+ * \param[in] min_time The minimum time (s) to spend on the benchmark.
+ * \param[in] func The function to time.
+ */
+void Run(std::ostream &output, const std::string &name, std::size_t items,
+	double min_time, const std::function<void()> &func);
+
+} // namespace molstat::bench
+} // namespace molstat
+
+#endif
@@ -0,0 +1,89 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file model_benchmark.cc
+ * \brief Implements the microbenchmarks for a model's observables.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "model_benchmark.h"
+#include "benchmark.h"
+#include <iostream>
+#include <valarray>
+#include <vector>
+#include <general/random_distributions/rng.h>
+#include <general/simulator_tools/simulator.h>
+#include <general/simulator_tools/simulator_exceptions.h>
+
+namespace molstat {
+namespace bench {
+
+void RunModel(const std::string &name,
+	std::shared_ptr<SimulateModel> model, const ObservableIndex &obs,
+	double min_time)
+{
+	using namespace std;
+
+	constexpr size_t n = 4096;
+	Engine engine{ 5489, 0, EngineKind::Xoshiro256pp };
+
+	// the same parameters are used for each call
+	const size_t nparams{ model->get_num_parameters() };
+	vector<double> params(nparams * n);
+	model->generateParameterBatch(engine, n, params.data());
+
+	vector<valarray<double>> trials(n, valarray<double>(nparams));
+	for(size_t t = 0; t < n; ++t)
+		for(size_t p = 0; p < nparams; ++p)
+			trials[t][p] = params[p*n + t];
+
+	vector<const double *> rows(nparams);
+	for(size_t p = 0; p < nparams; ++p)
+		rows[p] = params.data() + p*n;
+
+	const ObservableFunction single{ model->getObservableFunction(obs) };
+	Run(cout, name + "/observable", n, min_time,
+		[&single, &trials] () -> void
+		{
+			double sum{ 0. };
+			for(const valarray<double> &trial : trials)
+			{
+				try
+				{
+					sum += single(trial);
+				}
+				catch(const NoObservableProduced &e)
+				{
+					// trials without the observable are not summed
+				}
+			}
+			KeepValue(sum);
+		});
+
+	const BatchObservableFunction batch
+		{ model->getBatchObservableFunction(obs) };
+	vector<double> out(n);
+	Run(cout, name + "/batch_observable", n, min_time,
+		[&batch, &rows, &out, nparams] () -> void
+		{
+			batch(rows.data(), nparams, n, out.data());
+			KeepValue(out[n-1]);
+		});
+
+	Simulator sim{ model };
+	sim.setObservable(0, obs);
+	vector<double> workspace;
+	Run(cout, name + "/simulate_batch", n, min_time,
+		[&sim, &engine, &out, &workspace] () -> void
+		{
+			KeepValue(sim.simulateBatch(engine, n, out.data(), workspace));
+		});
+}
+
+} // namespace molstat::bench
+} // namespace molstat
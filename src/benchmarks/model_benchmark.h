@@ -0,0 +1,43 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file model_benchmark.h
+ * \brief Microbenchmarks for calculating a model's observables.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __model_benchmark_h__
+#define __model_benchmark_h__
+
+#include <memory>
+#include <string>
+#include <general/simulator_tools/simulate_model.h>
+
+namespace molstat {
+namespace bench {
+
+/**
+ * \brief Benchmarks calculating an observable, one trial at a time and for
+ *    a batch, and simulating a batch of trials.
+ *
+ * The benchmarks are named `name/observable`, `name/batch_observable`, and
+ * `name/simulate_batch`; the results are printed to standard output.
+ *
+ * \param[in] name The name of the benchmark.
+ * \param[in] model The (full) model.
+ * \param[in] obs The observable.
+ * \param[in] min_time The minimum time (s) for each benchmark.
+ */
+void RunModel(const std::string &name,
+	std::shared_ptr<SimulateModel> model, const ObservableIndex &obs,
+	double min_time);
+
+} // namespace molstat::bench
+} // namespace molstat
+
+#endif
@@ -0,0 +1,196 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file channel_kernels.h
+ * \brief The closed-form physics of the simple channels, shared by the
+ *    simulator and fitter models.
+ *
+ * Each formula is written once, as a template on its scalar type, and
+ * called by every model that needs it:
+ * - `double` in the channels' observables and their batch kernels (whose
+ *   loops the compiler vectorizes; see batch_kernels.h),
+ * - `double` on a device, in molstat::transport::DeviceChannelEvaluator,
+ *   and
+ * - molstat::Dual in the residuals of the fit models, which are
+ *   differentiated automatically (see molstat::AutoDiffFitModel).
+ *
+ * The line shapes of the symmetric fit models come from the one-site
+ * transmission, \f$g = 1 / (1 + x^2)\f$, by a change of variables. The
+ * inverses and Jacobians of that map are kept here, with the transmission.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __channel_kernels_h__
+#define __channel_kernels_h__
+
+#include <cmath>
+#include <general/random_distributions/device_rng.h>
+
+namespace molstat {
+namespace transport {
+
+/**
+ * \brief Transmission of the symmetric one-site channel,
+ *    \f$\Gamma^2 / [(E - \varepsilon - aV)^2 + \Gamma^2]\f$.
+ *
+ * \tparam T The scalar type.
+ * \param[in] e The energy.
+ * \param[in] V The applied bias.
+ * \param[in] eps The site energy.
+ * \param[in] gamma The site/lead coupling.
+ * \param[in] a The voltage drop.
+ * \return The transmission.
+ */
+template<typename T>
+MOLSTAT_HOST_DEVICE inline T SymOneSiteTransmission(const T &e, const T &V,
+	const T &eps, const T &gamma, const T &a)
+{
+	const T z{ e - eps - a*V };
+	return gamma*gamma / (z*z + gamma*gamma);
+}
+
+/**
+ * \brief Zero-temperature current through the symmetric one-site channel,
+ *    in units where \f$2e/h = 1\f$.
+ *
+ * \tparam T The scalar type.
+ * \param[in] ef The Fermi energy.
+ * \param[in] V The applied bias.
+ * \param[in] eps The site energy.
+ * \param[in] gamma The site/lead coupling.
+ * \param[in] a The voltage drop.
+ * \return The current.
+ */
+template<typename T>
+MOLSTAT_HOST_DEVICE inline T SymOneSiteCurrent(const T &ef, const T &V,
+	const T &eps, const T &gamma, const T &a)
+{
+	using std::atan;
+
+	return gamma * (atan((ef - eps + (0.5 - a)*V) / gamma) -
+		atan((ef - eps - (0.5 + a)*V) / gamma));
+}
+
+/**
+ * \brief Zero-bias thermopower of the symmetric one-site channel,
+ *    \f$2z / (z^2 + \Gamma^2)\f$ with \f$z = E_\mathrm{F} - \varepsilon\f$.
+ *
+ * \tparam T The scalar type.
+ * \param[in] z The detuning, \f$E_\mathrm{F} - \varepsilon\f$.
+ * \param[in] gamma The site/lead coupling.
+ * \return The thermopower.
+ */
+template<typename T>
+MOLSTAT_HOST_DEVICE inline T SymOneSiteThermopower(const T &z, const T &gamma)
+{
+	return 2.*z / (z*z + gamma*gamma);
+}
+
+/**
+ * \brief Transmission of the (asymmetric) two-site channel; the symmetric
+ *    channel has equal couplings.
+ *
+ * \tparam T The scalar type.
+ * \param[in] e The energy.
+ * \param[in] eps The site energy.
+ * \param[in] gammal The left coupling.
+ * \param[in] gammar The right coupling.
+ * \param[in] beta The inter-site coupling.
+ * \return The transmission.
+ */
+template<typename T>
+MOLSTAT_HOST_DEVICE inline T TwoSiteTransmission(const T &e, const T &eps,
+	const T &gammal, const T &gammar, const T &beta)
+{
+	const T temp{ 4.*(e-eps)*(e-eps) - 4.*beta*beta - gammal*gammar };
+
+	return 16.*gammal*gammar*beta*beta /
+		(temp*temp + 4.*(gammal+gammar)*(gammal+gammar)*(e-eps)*(e-eps));
+}
+
+/**
+ * \brief Zero-bias transmission of the symmetric interference channel.
+ *
+ * \tparam T The scalar type.
+ * \param[in] z The detuning, \f$E - \varepsilon\f$.
+ * \param[in] gamma The site/lead coupling.
+ * \param[in] beta The coupling between the sites.
+ * \return The transmission.
+ */
+template<typename T>
+MOLSTAT_HOST_DEVICE inline T SymInterferenceTransmission(const T &z,
+	const T &gamma, const T &beta)
+{
+	const T temp{ z*z - beta*beta };
+	return gamma*gamma*z*z / (temp*temp + z*z*gamma*gamma);
+}
+
+/**
+ * \brief Inverts the one-site transmission for resonant tunneling,
+ *    \f$x^2 = (1-g)/g\f$, where \f$x = z/\Gamma\f$.
+ *
+ * \tparam T The scalar type.
+ * \param[in] g The conductance, in \f$(0, 1]\f$.
+ * \return \f$(z/\Gamma)^2\f$.
+ */
+template<typename T>
+MOLSTAT_HOST_DEVICE inline T SymOneSiteResonantRatio(const T &g)
+{
+	return (1. - g) / g;
+}
+
+/**
+ * \brief Jacobian (up to a factor of 2) of the inverse for resonant
+ *    tunneling, \f$|\mathrm{d}x/\mathrm{d}g| = 1 / [2\sqrt{g^3(1-g)}]\f$.
+ *
+ * \tparam T The scalar type.
+ * \param[in] g The conductance, in \f$(0, 1)\f$.
+ * \return \f$1 / \sqrt{g^3(1-g)}\f$.
+ */
+template<typename T>
+MOLSTAT_HOST_DEVICE inline T SymOneSiteResonantJacobian(const T &g)
+{
+	using std::sqrt;
+
+	return 1. / sqrt(g*g*g*(1. - g));
+}
+
+/**
+ * \brief Inverts the one-site transmission for nonresonant tunneling,
+ *    \f$y^2 = g/(1-g)\f$, where \f$y = \Gamma/z\f$.
+ *
+ * \tparam T The scalar type.
+ * \param[in] g The conductance, in \f$[0, 1)\f$.
+ * \return \f$(\Gamma/z)^2\f$.
+ */
+template<typename T>
+MOLSTAT_HOST_DEVICE inline T SymOneSiteNonresonantRatio(const T &g)
+{
+	return g / (1. - g);
+}
+
+/**
+ * \brief Jacobian (up to a factor of 2) of the inverse for nonresonant
+ *    tunneling, \f$|\mathrm{d}y/\mathrm{d}g| = 1 / [2\sqrt{g(1-g)^3}]\f$.
+ *
+ * \tparam T The scalar type.
+ * \param[in] g The conductance, in \f$(0, 1)\f$.
+ * \return \f$1 / \sqrt{g(1-g)^3}\f$.
+ */
+template<typename T>
+MOLSTAT_HOST_DEVICE inline T SymOneSiteNonresonantJacobian(const T &g)
+{
+	using std::sqrt;
+
+	return 1. / sqrt(g*(1.-g)*(1.-g)*(1.-g));
+}
+
+} // namespace molstat::transport
+} // namespace molstat
+
+#endif
@@ -13,6 +13,7 @@
  */
 
 #include "asymmetric_resonant.h"
+#include <cmath>
 #include <iomanip>
 
 using namespace std;
@@ -53,18 +54,27 @@ std::vector<double> AsymmetricResonantFitModel::create_initial_guess(
 
 AsymmetricResonantFitModel::AsymmetricResonantFitModel(
 	const std::list<std::pair<std::array<double, 1>, double>> &data)
-	: FitModel<1>(4, data), w(gsl_integration_workspace_alloc(nquad),
-		&gsl_integration_workspace_free) 
-{}
+	: FitModel<1>(4, data)
+{
+	set_derived(3, [] (const array<double, 1> &x, double *d) -> void
+		{
+			const double g = x[0];
+			d[INTMIN] = (2.0 - g - 2.0*std::sqrt(1.0-g)) / g;
+			d[INTMAX] = (2.0 - g + 2.0*std::sqrt(1.0-g)) / g;
+			d[PREFACTOR] = 1. / (g*std::sqrt(g));
+		});
+}
 
 double AsymmetricResonantFitModel::resid(const std::vector<double> &fitparam,
 	const std::array<double, 1> &x, const double f) const
 {
-	vector<double> params(nfit+1);
+	array<double, 5> params;
 	double error, intmin, intmax, integral;
 	gsl_function func;
+	gsl_integration_workspace *const w{ integration_workspace(nquad) };
+	const double epsrel{ FitIntegrationTolerance() };
 	func.function = &AsymmetricResonantFitModel::int_p;
-	func.params = &params;
+	func.params = params.data();
 
 	const double g = x[0];
 
@@ -74,24 +84,27 @@ double AsymmetricResonantFitModel::resid(const std::vector<double> &fitparam,
 	params[NORM] = fitparam[NORM];
 	params[nfit] = g; // need to pass in the conductance value
 
-	intmin = (2.0 - g - 2.0*sqrt(1.0-g)) / g;
-	intmax = (2.0 - g + 2.0*sqrt(1.0-g)) / g;
+	const double *const d = derived(x);
+	intmin = d[INTMIN];
+	intmax = d[INTMAX];
 
 	// calculate the integral
-	gsl_integration_qags(&func, intmin, intmax, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, intmin, intmax, 0.0, epsrel, nquad, w,
 		&integral, &error);
-	integral *= fitparam[NORM] / (g*sqrt(g));
+	integral *= fitparam[NORM] * d[PREFACTOR];
 	return integral - f;
 }
 
-std::vector<double> AsymmetricResonantFitModel::jacobian(
+void AsymmetricResonantFitModel::jacobian_row(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
-	const double f) const
+	const double f, double *jac) const
 {
-	vector<double> params(nfit+1), ret(nfit);
+	array<double, 5> params;
 	double error, intmin, intmax, integral, intgl, intgr, intr;
 	gsl_function func;
-	func.params = &params;
+	gsl_integration_workspace *const w{ integration_workspace(nquad) };
+	const double epsrel{ FitIntegrationTolerance() };
+	func.params = params.data();
 
 	const double g = x[0];
 	const double gammaL = fitparam[GAMMAL];
@@ -105,50 +118,49 @@ std::vector<double> AsymmetricResonantFitModel::jacobian(
 	params[NORM] = norm;
 	params[nfit] = g; // need to pass in the conductance value
 
-	intmin = (2.0 - g - 2.0*sqrt(1.0-g)) / g;
-	intmax = (2.0 - g + 2.0*sqrt(1.0-g)) / g;
+	const double *const d = derived(x);
+	intmin = d[INTMIN];
+	intmax = d[INTMAX];
 
 	// evaluate the four integrals
 	func.function = &AsymmetricResonantFitModel::int_p;
-	gsl_integration_qags(&func, intmin, intmax, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, intmin, intmax, 0.0, epsrel, nquad, w,
 		&integral, &error);
 
 	func.function = &AsymmetricResonantFitModel::int_dp_dgammaL;
-	gsl_integration_qags(&func, intmin, intmax, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, intmin, intmax, 0.0, epsrel, nquad, w,
 		&intgl, &error);
 
 	func.function = &AsymmetricResonantFitModel::int_dp_dgammaR;
-	gsl_integration_qags(&func, intmin, intmax, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, intmin, intmax, 0.0, epsrel, nquad, w,
 		&intgr, &error);
 
 	func.function = &AsymmetricResonantFitModel::int_dp_dr;
-	gsl_integration_qags(&func, intmin, intmax, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, intmin, intmax, 0.0, epsrel, nquad, w,
 		&intr, &error);
 
 	// set the derivatives
-	ret[GAMMAL] = norm / (g*sqrt(g)) * intgl;
-
-	ret[GAMMAR] = norm / (g*sqrt(g)) * intgr;
+	jac[GAMMAL] = norm * d[PREFACTOR] * intgl;
 
-	ret[R] = -0.25 * norm * r * intr * (gammaL*gammaL + gammaR*gammaR)
-		/ (g*g*sqrt(g));
+	jac[GAMMAR] = norm * d[PREFACTOR] * intgr;
 
-	ret[NORM] = integral / (g*sqrt(g));
+	jac[R] = -0.25 * norm * r * intr * (gammaL*gammaL + gammaR*gammaR)
+		* d[PREFACTOR] / g;
 
-	return ret;
+	jac[NORM] = integral * d[PREFACTOR];
 }
 
-std::pair<double, std::vector<double>> AsymmetricResonantFitModel::resid_j(
+double AsymmetricResonantFitModel::resid_j_row(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
-	const double f) const
+	const double f, double *jac) const
 {
-	pair<double, vector<double>> ret;
-	vector<double> params(nfit+1);
+	double ret;
+	array<double, 5> params;
 	double error, intmin, intmax, integral, intgl, intgr, intr;
 	gsl_function func;
-	func.params = &params;
-
-	ret.second.resize(nfit);
+	gsl_integration_workspace *const w{ integration_workspace(nquad) };
+	const double epsrel{ FitIntegrationTolerance() };
+	func.params = params.data();
 
 	const double g = x[0];
 	const double gammaL = fitparam[GAMMAL];
@@ -162,37 +174,38 @@ std::pair<double, std::vector<double>> AsymmetricResonantFitModel::resid_j(
 	params[NORM] = norm;
 	params[nfit] = g; // need to pass in the conductance value
 
-	intmin = (2.0 - g - 2.0*sqrt(1.0-g)) / g;
-	intmax = (2.0 - g + 2.0*sqrt(1.0-g)) / g;
+	const double *const d = derived(x);
+	intmin = d[INTMIN];
+	intmax = d[INTMAX];
 
 	// evaluate the four integrals
 	func.function = &AsymmetricResonantFitModel::int_p;
-	gsl_integration_qags(&func, intmin, intmax, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, intmin, intmax, 0.0, epsrel, nquad, w,
 		&integral, &error);
 
 	func.function = &AsymmetricResonantFitModel::int_dp_dgammaL;
-	gsl_integration_qags(&func, intmin, intmax, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, intmin, intmax, 0.0, epsrel, nquad, w,
 		&intgl, &error);
 
 	func.function = &AsymmetricResonantFitModel::int_dp_dgammaR;
-	gsl_integration_qags(&func, intmin, intmax, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, intmin, intmax, 0.0, epsrel, nquad, w,
 		&intgr, &error);
 
 	func.function = &AsymmetricResonantFitModel::int_dp_dr;
-	gsl_integration_qags(&func, intmin, intmax, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, intmin, intmax, 0.0, epsrel, nquad, w,
 		&intr, &error);
 
 	// set the residual and derivatives
-	ret.first = norm * integral / (g*sqrt(g)) - f;
+	ret = norm * integral * d[PREFACTOR] - f;
 
-	ret.second[GAMMAL] = norm / (g*sqrt(g)) * intgl;
+	jac[GAMMAL] = norm * d[PREFACTOR] * intgl;
 
-	ret.second[GAMMAR] = norm / (g*sqrt(g)) * intgr;
+	jac[GAMMAR] = norm * d[PREFACTOR] * intgr;
 
-	ret.second[R] = -0.25 * norm * r * intr * (gammaL*gammaL + gammaR*gammaR)
-		/ (g*g*sqrt(g));
+	jac[R] = -0.25 * norm * r * intr * (gammaL*gammaL + gammaR*gammaR)
+		* d[PREFACTOR] / g;
 
-	ret.second[NORM] = integral / (g*sqrt(g));
+	jac[NORM] = integral * d[PREFACTOR];
 
 	return ret;
 }
@@ -253,7 +266,7 @@ void AsymmetricResonantFitModel::process_fit_parameters(
 
 double AsymmetricResonantFitModel::int_p(double x, void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[4];
 	const double gammaL = fitparams[GAMMAL];
@@ -271,7 +284,7 @@ double AsymmetricResonantFitModel::int_p(double x, void *params)
 
 double AsymmetricResonantFitModel::int_dp_dr(double x, void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[4];
 	const double gammaL = fitparams[GAMMAL];
@@ -289,7 +302,7 @@ double AsymmetricResonantFitModel::int_dp_dr(double x, void *params)
 
 double AsymmetricResonantFitModel::int_dp_dgammaL(double x, void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[4];
 	const double gammaL = fitparams[GAMMAL];
@@ -311,7 +324,7 @@ double AsymmetricResonantFitModel::int_dp_dgammaL(double x, void *params)
 
 double AsymmetricResonantFitModel::int_dp_dgammaR(double x, void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[4];
 	const double gammaL = fitparams[GAMMAL];
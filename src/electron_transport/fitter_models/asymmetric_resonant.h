@@ -48,10 +48,6 @@ protected:
 	/// Maximum number of quadrature points for the adaptive GSL routines.
 	const std::size_t nquad = 2000;
 
-	/// Integration workspace for GSL numerical integration.
-	std::unique_ptr<gsl_integration_workspace,
-	                decltype(&gsl_integration_workspace_free)> w;
-
 	/**
 	 * \brief Converts a map of names to values to an initial guess (ordered
 	 *    vector).
@@ -129,6 +125,17 @@ protected:
 	 */
 	static double int_dp_dr(double x, void *params);
 
+	/// Index of the lower limit of the integrals in the derived quantities
+	/// of a point.
+	const static std::size_t INTMIN = 0;
+
+	/// Index of the upper limit of the integrals in the derived quantities
+	/// of a point.
+	const static std::size_t INTMAX = 1;
+
+	/// Index of \f$g^{-3/2}\f$ in the derived quantities of a point.
+	const static std::size_t PREFACTOR = 2;
+
 public:
 	/// Index for the \f$\gamma_\mathrm{L}\f$ fitting parameter.
 	const static int GAMMAL = 0;
@@ -187,11 +194,12 @@ public:
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return The Jacobian evaluated at these independent variables and
-	 *    fitting parameters.
+	 * \param[out] jac The Jacobian (`nfit` elements) evaluated at these
+	 *    independent variables and fitting parameters.
 	 */
-	virtual std::vector<double> jacobian(const std::vector<double> &fitparam,
-		const std::array<double, 1> &x, const double f) const override;
+	virtual void jacobian_row(const std::vector<double> &fitparam,
+		const std::array<double, 1> &x, const double f, double *jac)
+		const override;
 
 	/**
 	 * \brief Calculates both the residual and Jacobian of the fit for a given
@@ -203,12 +211,14 @@ public:
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return A pair of the residual and Jacobian evaluated at these
+	 * \param[out] jac The Jacobian (`nfit` elements) evaluated at these
 	 *    independent variables and fitting parameters.
+	 * \return The residual evaluated at these independent variables and
+	 *    fitting parameters.
 	 */
-	virtual std::pair<double, std::vector<double>> resid_j(
-		const std::vector<double> &fitparam, const std::array<double, 1> &x,
-		const double f) const override;
+	virtual double resid_j_row(const std::vector<double> &fitparam,
+		const std::array<double, 1> &x, const double f, double *jac)
+		const override;
 
 	virtual void append_default_guesses(std::list<std::vector<double>> &guess)
 		const override;
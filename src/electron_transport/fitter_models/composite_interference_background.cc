@@ -54,19 +54,20 @@ std::vector<double> CompositeInterferenceBackgroundFitModel
 CompositeInterferenceBackgroundFitModel
 	::CompositeInterferenceBackgroundFitModel(
 	const std::list<std::pair<std::array<double, 1>, double>> &data)
-	: FitModel<1>(3, data), w(gsl_integration_workspace_alloc(nquad),
-		&gsl_integration_workspace_free) 
+	: FitModel<1>(3, data)
 {}
 
 double CompositeInterferenceBackgroundFitModel::resid(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
 	const double f) const
 {
-	vector<double> params(nfit+1);
+	array<double, 4> params;
 	double error, integral;
 	gsl_function func;
+	gsl_integration_workspace *const w{ integration_workspace(nquad) };
+	const double epsrel{ FitIntegrationTolerance() };
 	func.function = &CompositeInterferenceBackgroundFitModel::int_p;
-	func.params = &params;
+	func.params = params.data();
 
 	const double g = x[0];
 
@@ -76,8 +77,8 @@ double CompositeInterferenceBackgroundFitModel::resid(
 	params[nfit] = g; // need to pass in the conductance value
 
 	// calculate the integral
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad,
-		w.get(), &integral, &error);
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad,
+		w, &integral, &error);
 
 	const double model = integral * fitparam[NORM];
 
@@ -88,14 +89,16 @@ double CompositeInterferenceBackgroundFitModel::resid(
 	return (model - f) / f;
 }
 
-std::vector<double> CompositeInterferenceBackgroundFitModel::jacobian(
+void CompositeInterferenceBackgroundFitModel::jacobian_row(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
-	const double f) const
+	const double f, double *jac) const
 {
-	vector<double> params(nfit+1), ret(nfit);
+	array<double, 4> params;
 	double error, integral, intcomega, intgminus;
 	gsl_function func;
-	func.params = &params;
+	gsl_integration_workspace *const w{ integration_workspace(nquad) };
+	const double epsrel{ FitIntegrationTolerance() };
+	func.params = params.data();
 
 	const double g = x[0];
 	const double comega = fitparam[COMEGA];
@@ -109,42 +112,39 @@ std::vector<double> CompositeInterferenceBackgroundFitModel::jacobian(
 
 	// evaluate the integrals
 	func.function = &CompositeInterferenceBackgroundFitModel::int_p;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&integral, &error);
 
 	func.function = &CompositeInterferenceBackgroundFitModel::int_dp_dcomega;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intcomega, &error);
 
 	func.function = &CompositeInterferenceBackgroundFitModel::int_dp_dgminus;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intgminus, &error);
 
 	// set the derivatives
-	ret[COMEGA] = -comega * norm * intcomega;
-	ret[COMEGA] /= f; // scaling as described above
-
-	ret[GMINUS] = -2.*norm / (k * gminus * gminus * M_SQRTPI) * intgminus;
-	ret[GMINUS] /= f; // scaling, again
+	jac[COMEGA] = -comega * norm * intcomega;
+	jac[COMEGA] /= f; // scaling as described above
 
-	ret[NORM] = integral;
-	ret[NORM] /= f; // scaling, again
+	jac[GMINUS] = -2.*norm / (k * gminus * gminus * M_SQRTPI) * intgminus;
+	jac[GMINUS] /= f; // scaling, again
 
-	return ret;
+	jac[NORM] = integral;
+	jac[NORM] /= f; // scaling, again
 }
 
-std::pair<double, std::vector<double>>
-	CompositeInterferenceBackgroundFitModel::resid_j(
+double CompositeInterferenceBackgroundFitModel::resid_j_row(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
-	const double f) const
+	const double f, double *jac) const
 {
-	pair<double, vector<double>> ret;
-	vector<double> params(nfit+1);
+	double ret;
+	array<double, 4> params;
 	double error, integral, intcomega, intgminus;
 	gsl_function func;
-	func.params = &params;
-
-	ret.second.resize(nfit);
+	gsl_integration_workspace *const w{ integration_workspace(nquad) };
+	const double epsrel{ FitIntegrationTolerance() };
+	func.params = params.data();
 
 	const double g = x[0];
 	const double comega = fitparam[COMEGA];
@@ -158,30 +158,30 @@ std::pair<double, std::vector<double>>
 
 	// evaluate the integrals
 	func.function = &CompositeInterferenceBackgroundFitModel::int_p;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&integral, &error);
 
 	func.function = &CompositeInterferenceBackgroundFitModel::int_dp_dcomega;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intcomega, &error);
 
 	func.function = &CompositeInterferenceBackgroundFitModel::int_dp_dgminus;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intgminus, &error);
 
 	// set the residual and derivatives
-	ret.first = norm * integral - f;
-	ret.first /= f; // scaling as described above
+	ret = norm * integral - f;
+	ret /= f; // scaling as described above
 
-	ret.second[COMEGA] = -comega * norm * intcomega;
-	ret.second[COMEGA] /= f; // scaling, again
+	jac[COMEGA] = -comega * norm * intcomega;
+	jac[COMEGA] /= f; // scaling, again
 
-	ret.second[GMINUS] = -2.*norm / (k * gminus * gminus * M_SQRTPI)
+	jac[GMINUS] = -2.*norm / (k * gminus * gminus * M_SQRTPI)
 		* intgminus;
-	ret.second[GMINUS] /= f; // scaling, again
+	jac[GMINUS] /= f; // scaling, again
 
-	ret.second[NORM] = integral;
-	ret.second[NORM] /= f; // scaling, again
+	jac[NORM] = integral;
+	jac[NORM] /= f; // scaling, again
 
 	return ret;
 }
@@ -224,10 +224,16 @@ void CompositeInterferenceBackgroundFitModel::process_fit_parameters(
 		fitparams[COMEGA] = -fitparams[COMEGA];
 }
 
+double CompositeInterferenceBackgroundFitModel::residual_scale(
+	const std::array<double, 1> &x, const double f) const
+{
+	return f;
+}
+
 double CompositeInterferenceBackgroundFitModel::int_p(double gp,
 	void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[3];
 	const double comega = fitparams[COMEGA];
@@ -242,7 +248,7 @@ double CompositeInterferenceBackgroundFitModel::int_p(double gp,
 double CompositeInterferenceBackgroundFitModel::int_dp_dcomega(double gp,
 	void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[3];
 	const double comega = fitparams[COMEGA];
@@ -257,7 +263,7 @@ double CompositeInterferenceBackgroundFitModel::int_dp_dcomega(double gp,
 double CompositeInterferenceBackgroundFitModel::int_dp_dgminus(double gp,
 	void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[3];
 	const double comega = fitparams[COMEGA];
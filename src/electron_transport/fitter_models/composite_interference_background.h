@@ -75,10 +75,6 @@ protected:
 	/// The effective standard deviation of the step function smoothing.
 	constexpr static double k = 0.05;
 
-	/// Integration workspace for GSL numerical integration.
-	std::unique_ptr<gsl_integration_workspace,
-	                decltype(&gsl_integration_workspace_free)> w;
-
 	/**
 	 * \brief Converts a map of names to values to an initial guess (ordered
 	 *    vector).
@@ -191,11 +187,12 @@ public:
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return The Jacobian evaluated at these independent variables and
-	 *    fitting parameters.
+	 * \param[out] jac The Jacobian (`nfit` elements) evaluated at these
+	 *    independent variables and fitting parameters.
 	 */
-	virtual std::vector<double> jacobian(const std::vector<double> &fitparam,
-		const std::array<double, 1> &x, const double f) const override;
+	virtual void jacobian_row(const std::vector<double> &fitparam,
+		const std::array<double, 1> &x, const double f, double *jac)
+		const override;
 
 	/**
 	 * \brief Calculates both the residual and Jacobian of the fit for a given
@@ -207,12 +204,14 @@ public:
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return A pair of the residual and Jacobian evaluated at these
+	 * \param[out] jac The Jacobian (`nfit` elements) evaluated at these
 	 *    independent variables and fitting parameters.
+	 * \return The residual evaluated at these independent variables and
+	 *    fitting parameters.
 	 */
-	virtual std::pair<double, std::vector<double>> resid_j(
-		const std::vector<double> &fitparam, const std::array<double, 1> &x,
-		const double f) const override;
+	virtual double resid_j_row(const std::vector<double> &fitparam,
+		const std::array<double, 1> &x, const double f, double *jac)
+		const override;
 
 	virtual void append_default_guesses(std::list<std::vector<double>> &guess)
 		const override;
@@ -227,6 +226,18 @@ public:
 	 */
 	virtual void process_fit_parameters(std::vector<double> &fitparams) const
 		override;
+
+	/**
+	 * \brief Gets the scale of the residuals (see FitModel::residual_scale).
+	 *
+	 * The residuals are relative to the observed value.
+	 *
+	 * \param[in] x The independent variables of the point.
+	 * \param[in] f The observed value of the fit function at x.
+	 * \return The observed value.
+	 */
+	virtual double residual_scale(const std::array<double, 1> &x,
+		const double f) const override;
 };
 
 } // namespace molstat::transport
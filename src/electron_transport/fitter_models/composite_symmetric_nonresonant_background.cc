@@ -56,19 +56,20 @@ std::vector<double> CompositeSymmetricNonresonantBackgroundFitModel
 CompositeSymmetricNonresonantBackgroundFitModel
 	::CompositeSymmetricNonresonantBackgroundFitModel(
 	const std::list<std::pair<std::array<double, 1>, double>> &data)
-	: FitModel<1>(4, data), w(gsl_integration_workspace_alloc(nquad),
-		&gsl_integration_workspace_free) 
+	: FitModel<1>(4, data)
 {}
 
 double CompositeSymmetricNonresonantBackgroundFitModel::resid(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
 	const double f) const
 {
-	vector<double> params(nfit+1);
+	array<double, 5> params;
 	double error, integral;
 	gsl_function func;
+	gsl_integration_workspace *const w{ integration_workspace(nquad) };
+	const double epsrel{ FitIntegrationTolerance() };
 	func.function = &CompositeSymmetricNonresonantBackgroundFitModel::int_p;
-	func.params = &params;
+	func.params = params.data();
 
 	const double g = x[0];
 
@@ -79,20 +80,22 @@ double CompositeSymmetricNonresonantBackgroundFitModel::resid(
 	params[nfit] = g; // need to pass in the conductance value
 
 	// calculate the integral
-	gsl_integration_qags(&func, 0., g, 0., 1.0e-7, nquad, w.get(), &integral,
+	gsl_integration_qags(&func, 0., g, 0., epsrel, nquad, w, &integral,
 		&error);
 
 	return integral * fitparam[NORM] - f;
 }
 
-std::vector<double> CompositeSymmetricNonresonantBackgroundFitModel::jacobian(
+void CompositeSymmetricNonresonantBackgroundFitModel::jacobian_row(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
-	const double f) const
+	const double f, double *jac) const
 {
-	vector<double> params(nfit+1), ret(nfit);
+	array<double, 5> params;
 	double error, integral, intceps, intcgamma, intgminus;
 	gsl_function func;
-	func.params = &params;
+	gsl_integration_workspace *const w{ integration_workspace(nquad) };
+	const double epsrel{ FitIntegrationTolerance() };
+	func.params = params.data();
 
 	const double g = x[0];
 	const double ceps = fitparam[CEPSILON];
@@ -108,45 +111,42 @@ std::vector<double> CompositeSymmetricNonresonantBackgroundFitModel::jacobian(
 
 	// evaluate the integrals
 	func.function = &CompositeSymmetricNonresonantBackgroundFitModel::int_p;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&integral, &error);
 
 	func.function = &CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dcepsilon;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intceps, &error);
 
 	func.function = &CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dcgamma;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intcgamma, &error);
 
 	func.function = &CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dgminus;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intgminus, &error);
 
 	// set the derivatives
-	ret[CEPSILON] = -norm * intceps;
-
-	ret[CGAMMA] = norm * intcgamma;
+	jac[CEPSILON] = -norm * intceps;
 
-	ret[GMINUS] = -2.*norm / (k * gminus * gminus * M_SQRTPI) * intgminus;
+	jac[CGAMMA] = norm * intcgamma;
 
-	ret[NORM] = integral;
+	jac[GMINUS] = -2.*norm / (k * gminus * gminus * M_SQRTPI) * intgminus;
 
-	return ret;
+	jac[NORM] = integral;
 }
 
-std::pair<double, std::vector<double>>
-	CompositeSymmetricNonresonantBackgroundFitModel::resid_j(
+double CompositeSymmetricNonresonantBackgroundFitModel::resid_j_row(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
-	const double f) const
+	const double f, double *jac) const
 {
-	pair<double, vector<double>> ret;
-	vector<double> params(nfit+1);
+	double ret;
+	array<double, 5> params;
 	double error, integral, intceps, intcgamma, intgminus;
 	gsl_function func;
-	func.params = &params;
-
-	ret.second.resize(nfit);
+	gsl_integration_workspace *const w{ integration_workspace(nquad) };
+	const double epsrel{ FitIntegrationTolerance() };
+	func.params = params.data();
 
 	const double g = x[0];
 	const double ceps = fitparam[CEPSILON];
@@ -162,31 +162,31 @@ std::pair<double, std::vector<double>>
 
 	// evaluate the integrals
 	func.function = &CompositeSymmetricNonresonantBackgroundFitModel::int_p;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&integral, &error);
 
 	func.function = &CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dcepsilon;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intceps, &error);
 
 	func.function = &CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dcgamma;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intcgamma, &error);
 
 	func.function = &CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dgminus;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
+	gsl_integration_qags(&func, 0., g, 0.0, epsrel, nquad, w,
 		&intgminus, &error);
 
 	// set the residual and derivatives
-	ret.first = norm * integral - f;
+	ret = norm * integral - f;
 
-	ret.second[CEPSILON] = -norm * intceps;
+	jac[CEPSILON] = -norm * intceps;
 
-	ret.second[CGAMMA] = norm * intcgamma;
+	jac[CGAMMA] = norm * intcgamma;
 
-	ret.second[GMINUS] = -2.*norm / (k * gminus * gminus * M_SQRTPI) * intgminus;
+	jac[GMINUS] = -2.*norm / (k * gminus * gminus * M_SQRTPI) * intgminus;
 
-	ret.second[NORM] = integral;
+	jac[NORM] = integral;
 
 	return ret;
 }
@@ -241,7 +241,7 @@ void CompositeSymmetricNonresonantBackgroundFitModel::process_fit_parameters(
 double CompositeSymmetricNonresonantBackgroundFitModel::int_p(double gp,
 	void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[4];
 	const double ceps = fitparams[CEPSILON];
@@ -260,7 +260,7 @@ double CompositeSymmetricNonresonantBackgroundFitModel::int_p(double gp,
 double CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dcepsilon(
 	double gp, void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[4];
 	const double ceps = fitparams[CEPSILON];
@@ -279,7 +279,7 @@ double CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dcepsilon(
 double CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dcgamma(
 	double gp, void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[4];
 	const double ceps = fitparams[CEPSILON];
@@ -298,7 +298,7 @@ double CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dcgamma(
 double CompositeSymmetricNonresonantBackgroundFitModel::int_dp_dgminus(
 	double gp, void *params)
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
+	const double *const fitparams = (const double*)params;
 
 	const double g = fitparams[4];
 	const double ceps = fitparams[CEPSILON];
@@ -15,6 +15,7 @@
 
 #include "experiment_symmetric_nonresonant.h"
 #include <iomanip>
+#include <general/gauss_kronrod.h>
 #include <gsl/gsl_math.h>
 #include <gsl/gsl_sf_erf.h>
 
@@ -50,157 +51,83 @@ std::vector<double> ExperimentSymmetricNonresonantFitModel
 ExperimentSymmetricNonresonantFitModel
 	::ExperimentSymmetricNonresonantFitModel(
 	const std::list<std::pair<std::array<double, 1>, double>> &data)
-	: FitModel<1>(6, data), w(gsl_integration_workspace_alloc(nquad),
-		&gsl_integration_workspace_free) 
-{}
+	: FitModel<1>(6, data)
+{
+	set_derived(1, [] (const array<double, 1> &x, double *d) -> void
+		{
+			d[INV_G] = 1. / x[0];
+		});
+}
 
 double ExperimentSymmetricNonresonantFitModel::resid(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
 	const double f) const
 {
-	vector<double> params(nfit+1);
-	double error, integral;
-	gsl_function func;
-	func.function = &ExperimentSymmetricNonresonantFitModel::int_p;
-	func.params = &params;
-
 	const double g = x[0];
 
-	params[CEPSILON] = fitparam[CEPSILON];
-	params[CGAMMA] = fitparam[CGAMMA];
-	params[GMINUS] = fitparam[GMINUS];
-	params[NSIGNAL] = fitparam[NSIGNAL];
-	params[NBACKGROUND] = fitparam[NBACKGROUND];
-	params[NBASELINE] = fitparam[NBASELINE];
-	params[nfit] = g; // need to pass in the conductance value
-
 	// calculate the integral
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad,
-		w.get(), &integral, &error);
+	const array<double, 4> ints(integrals(fitparam, g));
 
-	return integral * fitparam[NSIGNAL] + fitparam[NBACKGROUND] / g
-		+ fitparam[NBASELINE] - f;
+	return ints[INT_P] * fitparam[NSIGNAL]
+		+ fitparam[NBACKGROUND] * derived(x)[INV_G] + fitparam[NBASELINE] - f;
 }
 
-std::vector<double> ExperimentSymmetricNonresonantFitModel
-	::jacobian(const std::vector<double> &fitparam,
-	const std::array<double, 1> &x, const double f) const
+void ExperimentSymmetricNonresonantFitModel
+	::jacobian_row(const std::vector<double> &fitparam,
+	const std::array<double, 1> &x, const double f, double *jac) const
 {
-	vector<double> params(nfit+1), ret(nfit);
-	double error, integral, intceps, intcgamma, intgminus;
-	gsl_function func;
-	func.params = &params;
-
 	const double g = x[0];
-	const double ceps = fitparam[CEPSILON];
-	const double cgamma = fitparam[CGAMMA];
 	const double gminus = fitparam[GMINUS];
 	const double nsignal = fitparam[NSIGNAL];
-	const double nbackground = fitparam[NBACKGROUND];
-	const double nbaseline = fitparam[NBASELINE];
-
-	params[CEPSILON] = ceps;
-	params[CGAMMA] = cgamma;
-	params[GMINUS] = gminus;
-	params[NSIGNAL] = nsignal;
-	params[NBACKGROUND] = nbackground;
-	params[NBASELINE] = nbaseline;
-	params[nfit] = g; // need to pass in the conductance value
-
-	func.function = &ExperimentSymmetricNonresonantFitModel::int_p;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
-		&integral, &error);
 
-	func.function = &ExperimentSymmetricNonresonantFitModel::int_dp_dcepsilon;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
-		&intceps, &error);
-
-	func.function = &ExperimentSymmetricNonresonantFitModel::int_dp_dcgamma;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
-		&intcgamma, &error);
-
-	func.function = &ExperimentSymmetricNonresonantFitModel::int_dp_dgminus;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
-		&intgminus, &error);
+	// evaluate the four integrals
+	const array<double, 4> ints(integrals(fitparam, g));
 
 	// set the derivatives
-	ret[CEPSILON] = -nsignal * intceps;
+	jac[CEPSILON] = nsignal * ints[INT_DP_DCEPSILON];
 
-	ret[CGAMMA] = nsignal * intcgamma;
+	jac[CGAMMA] = nsignal * ints[INT_DP_DCGAMMA];
 
-	ret[GMINUS] = -2.*nsignal / (k * gminus * gminus * M_SQRTPI) * intgminus;
+	jac[GMINUS] = -2.*nsignal / (k * gminus * gminus * M_SQRTPI)
+		* ints[INT_DP_DGMINUS];
 
-	ret[NSIGNAL] = integral;
+	jac[NSIGNAL] = ints[INT_P];
 
-	ret[NBACKGROUND] = 1. / g;
+	jac[NBACKGROUND] = derived(x)[INV_G];
 
-	ret[NBASELINE] = 1.;
-
-	return ret;
+	jac[NBASELINE] = 1.;
 }
 
-std::pair<double, std::vector<double>>
-	ExperimentSymmetricNonresonantFitModel::resid_j(
+double ExperimentSymmetricNonresonantFitModel::resid_j_row(
 	const std::vector<double> &fitparam, const std::array<double, 1> &x,
-	const double f) const
+	const double f, double *jac) const
 {
-	pair<double, vector<double>> ret;
-	vector<double> params(nfit+1);
-	double error, integral, intceps, intcgamma, intgminus;
-	gsl_function func;
-	func.params = &params;
-
-	ret.second.resize(nfit);
-
 	const double g = x[0];
-	const double ceps = fitparam[CEPSILON];
-	const double cgamma = fitparam[CGAMMA];
 	const double gminus = fitparam[GMINUS];
 	const double nsignal = fitparam[NSIGNAL];
 	const double nbackground = fitparam[NBACKGROUND];
 	const double nbaseline = fitparam[NBASELINE];
 
-	params[CEPSILON] = ceps;
-	params[CGAMMA] = cgamma;
-	params[GMINUS] = gminus;
-	params[NSIGNAL] = nsignal;
-	params[NBACKGROUND] = nbackground;
-	params[NBASELINE] = nbaseline;
-	params[nfit] = g; // need to pass in the conductance value
-
 	// evaluate the integrals
-	func.function = &ExperimentSymmetricNonresonantFitModel::int_p;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
-		&integral, &error);
-
-	func.function = &ExperimentSymmetricNonresonantFitModel::int_dp_dcepsilon;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
-		&intceps, &error);
-
-	func.function = &ExperimentSymmetricNonresonantFitModel::int_dp_dcgamma;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
-		&intcgamma, &error);
-
-	func.function = &ExperimentSymmetricNonresonantFitModel::int_dp_dgminus;
-	gsl_integration_qags(&func, 0., g, 0.0, 1.0e-7, nquad, w.get(),
-		&intgminus, &error);
+	const array<double, 4> ints(integrals(fitparam, g));
 
-	// set the residual and derivatives
-	ret.first = nsignal * integral + nbackground / g + nbaseline - f;
-
-	ret.second[CEPSILON] = -nsignal * intceps;
+	// set the derivatives
+	jac[CEPSILON] = nsignal * ints[INT_DP_DCEPSILON];
 
-	ret.second[CGAMMA] = nsignal * intcgamma;
+	jac[CGAMMA] = nsignal * ints[INT_DP_DCGAMMA];
 
-	ret.second[GMINUS] = -2.*nsignal / (k * gminus * gminus * M_SQRTPI) * intgminus;
+	jac[GMINUS] = -2.*nsignal / (k * gminus * gminus * M_SQRTPI)
+		* ints[INT_DP_DGMINUS];
 
-	ret.second[NSIGNAL] = integral;
+	jac[NSIGNAL] = ints[INT_P];
 
-	ret.second[NBACKGROUND] = 1. / g;
+	jac[NBACKGROUND] = derived(x)[INV_G];
 
-	ret.second[NBASELINE] = 1.;
+	jac[NBASELINE] = 1.;
 
-	return ret;
+	// and the residual
+	return nsignal * ints[INT_P] + nbackground * jac[NBACKGROUND] + nbaseline
+		- f;
 }
 
 void ExperimentSymmetricNonresonantFitModel
@@ -253,80 +180,53 @@ void ExperimentSymmetricNonresonantFitModel
 	}
 }
 
-double ExperimentSymmetricNonresonantFitModel::int_p(double gp,
-	void *params)
-{
-	const vector<double> &fitparams = *(const vector<double>*)params;
-
-	const double g = fitparams[6];
-	const double ceps = fitparams[CEPSILON];
-	const double cgamma = fitparams[CGAMMA];
-	const double gminus = fitparams[GMINUS];
-
-	const double temp1 = g-gp;
-	const double temp2 = 1.-g+gp;
-	const double temp3 = ceps*sqrt(temp1) - cgamma*sqrt(temp2);
-
-	return (1. + gsl_sf_erf((gp - gminus) / (k * gminus)))
-		* exp(-0.5 * temp3 * temp3 / temp2)
-		/ (gp * sqrt(temp1 * temp2 * temp2 * temp2));
-}
-
-double ExperimentSymmetricNonresonantFitModel::int_dp_dcepsilon(
-	double gp, void *params)
-{
-	const vector<double> &fitparams = *(const vector<double>*)params;
-
-	const double g = fitparams[6];
-	const double ceps = fitparams[CEPSILON];
-	const double cgamma = fitparams[CGAMMA];
-	const double gminus = fitparams[GMINUS];
-
-	const double temp1 = g-gp;
-	const double temp2 = 1.-g+gp;
-	const double temp3 = ceps*sqrt(temp1) - cgamma*sqrt(temp2);
-
-	return (1. + gsl_sf_erf((gp - gminus) / (k * gminus))) * temp3
-		* exp(-0.5 * temp3 * temp3 / temp2)
-		/ (gp * sqrt(temp2) * temp2 * temp2);
-}
-
-double ExperimentSymmetricNonresonantFitModel::int_dp_dcgamma(
-	double gp, void *params)
+std::array<double, 4> ExperimentSymmetricNonresonantFitModel::integrals(
+	const std::vector<double> &fitparam, const double g) const
 {
-	const vector<double> &fitparams = *(const vector<double>*)params;
-
-	const double g = fitparams[6];
-	const double ceps = fitparams[CEPSILON];
-	const double cgamma = fitparams[CGAMMA];
-	const double gminus = fitparams[GMINUS];
-
-	const double temp1 = g-gp;
-	const double temp2 = 1.-g+gp;
-	const double temp3 = ceps*sqrt(temp1) - cgamma*sqrt(temp2);
+	// each thread keeps its own quadrature workspace
+	static thread_local AdaptiveGaussKronrod<4> quad{ nquad };
 
-	return (1. + gsl_sf_erf((gp - gminus) / (k * gminus))) * temp3
-		* exp(-0.5 * temp3 * temp3 / temp2)
-		/ (gp * sqrt(temp1) * temp2 * temp2);
-}
-
-double ExperimentSymmetricNonresonantFitModel::int_dp_dgminus(
-	double gp, void *params)
-{
-	const vector<double> &fitparams = *(const vector<double>*)params;
-
-	const double g = fitparams[6];
-	const double ceps = fitparams[CEPSILON];
-	const double cgamma = fitparams[CGAMMA];
-	const double gminus = fitparams[GMINUS];
-
-	const double temp1 = g-gp;
-	const double temp2 = 1.-g+gp;
-	const double temp3 = ceps*sqrt(temp1) - cgamma*sqrt(temp2);
-	const double temp4 = (gp - gminus) / (k * gminus);
+	const double ceps = fitparam[CEPSILON];
+	const double cgamma = fitparam[CGAMMA];
+	const double gminus = fitparam[GMINUS];
+	const double inv_width = 1. / (k * gminus);
 
-	return exp(-temp4*temp4 -0.5 * temp3 * temp3 / temp2)
-		/ sqrt(temp1 * temp2 * temp2 * temp2);
+	// integrate over u, where g' = g - u^2 and dg' = -2u du. the factors of
+	// sqrt(g-g') = u in the integrands cancel (or become regular).
+	const auto integrands = [g, ceps, cgamma, gminus, inv_width]
+		(double u, array<double, 4> &vals) -> void
+	{
+		const double gp = g - u*u;
+		if(gp <= 0.)
+		{
+			// the step function vanishes (faster than 1/g') as g' -> 0
+			vals.fill(0.);
+			return;
+		}
+
+		const double temp2 = 1.-g+gp;
+		const double sqrt2 = sqrt(temp2);
+		const double temp3 = ceps*u - cgamma*sqrt2;
+		const double temp4 = (gp - gminus) * inv_width;
+
+		// the kernel shared by all of the integrands
+		const double kernel = 2. * exp(-0.5 * temp3 * temp3 / temp2)
+			/ (temp2 * temp2);
+
+		// the smoothed step function. erf(x) rounds to +-1 for |x| >= 6,
+		// which is most of the nodes (the smoothing width is much smaller
+		// than g), so erf is only evaluated near the threshold.
+		const double step = (temp4 >= 6. ? 2. : temp4 <= -6. ? 0. :
+			1. + gsl_sf_erf(temp4)) / gp;
+
+		vals[INT_P] = step * kernel * sqrt2;
+		vals[INT_DP_DCEPSILON] = -step * kernel * temp3 * u / sqrt2;
+		vals[INT_DP_DCGAMMA] = step * kernel * temp3;
+		vals[INT_DP_DGMINUS] = exp(-temp4*temp4) * kernel * sqrt2;
+	};
+
+	return quad.integrate(integrands, 0., sqrt(g), 0.,
+		FitIntegrationTolerance());
 }
 
 } // namespace molstat::transport
@@ -16,7 +16,6 @@
 #define __experiment_symmetric_nonresonant_h__
 
 #include <general/fitter_tools/fit_model_interface.h>
-#include <gsl/gsl_integration.h>
 
 namespace molstat {
 namespace transport {
@@ -72,16 +71,12 @@ class ExperimentSymmetricNonresonantFitModel
 	: public FitModel<1>
 {
 protected:
-	/// Maximum number of quadrature points for the adaptive GSL routines.
+	/// Maximum number of subintervals for the adaptive quadrature.
 	const std::size_t nquad = 2000;
 
 	/// The effective standard deviation of the step function smoothing.
 	constexpr static double k = 0.05;
 
-	/// Integration workspace for GSL numerical integration.
-	std::unique_ptr<gsl_integration_workspace,
-	                decltype(&gsl_integration_workspace_free)> w;
-
 	/**
 	 * \brief Converts a map of names to values to an initial guess (ordered
 	 *    vector).
@@ -99,64 +94,45 @@ protected:
 	virtual std::vector<double> create_initial_guess(
 		const std::map<std::string, double> &values) const override;
 
-	/**
-	 * \brief GSL integrand function for the fit function integral.
-	 *
-	 * Function to be used in the GSL QAGS routine to evaluate \f[
-	 * \int\limits_{0}^{g} \mathrm{d}g' \frac{1+\mathrm{erf}\left( \frac{g'-g_-}{kg_-} \right)}{g' \sqrt{(g-g')(1-g+g')^3}} \exp\left[ - \frac{\left( c_\varepsilon\sqrt{g-g'} - c_\Gamma\sqrt{1-g+g'} \right)^2}{2(1-g+g')} \right].
-	 * \f]
-	 *
-	 * \param[in] gp The current value of \f$g'\f$.
-	 * \param[in] params The fit parameters, assumed to be in vector<double>
-	 *    form (although passed as void* to satisfy GSL requirements).
-	 * \return The integrand evaluated at this value of \f$g'\f$.
-	 */
-	static double int_p(double gp, void *params);
+	/// Index of \f$\mathrm{int\_p}\f$ in the output of integrals().
+	const static std::size_t INT_P = 0;
 
-	/**
-	 * \brief GSL integrand function for the derivative of the fit function
-	 *    integral with respect to \f$c_\varepsilon\f$.
-	 *
-	 * Function to be used in the GSL QAGS routine to evaluate \f[
-	 * \int\limits_{0}^{g} \mathrm{d}g' \frac{\left[ 1+\mathrm{erf}\left( \frac{g'-g_-}{kg_-} \right) \right] \left(c_\Gamma\sqrt{1-g+g'}-c_\varepsilon\sqrt{g-g'}\right)}{g' (1-g+g')^{5/2}} \exp\left[ - \frac{\left( c_\varepsilon\sqrt{g-g'} - c_\Gamma\sqrt{1-g+g'} \right)^2}{2(1-g+g')} \right].
-	 * \f]
-	 *
-	 * \param[in] gp The current value of \f$g'\f$.
-	 * \param[in] params The fit parameters, assumed to be in vector<double>
-	 *    form (although passed as void* to satisfy GSL requirements).
-	 * \return The integrand evaluated at this value of \f$g'\f$.
-	 */
-	static double int_dp_dcepsilon(double gp, void *params);
+	/// Index of \f$\mathrm{int\_dp\_dcepsilon}\f$ in the output of integrals().
+	const static std::size_t INT_DP_DCEPSILON = 1;
 
-	/**
-	 * \brief GSL integrand function for the derivative of the fit function
-	 *    integral with respect to \f$c_\Gamma\f$.
-	 *
-	 * Function to be used in the GSL QAGS routine to evaluate \f[
-	 * \int\limits_{0}^{g} \mathrm{d}g' \frac{\left[ 1+\mathrm{erf}\left( \frac{g'-g_-}{kg_-} \right) \right] \left( c_\varepsilon\sqrt{g-g'}-c_\Gamma\sqrt{1-g+g'}\right)}{g' \sqrt{g-g'} (1-g+g')^2} \exp\left[ - \frac{\left( c_\varepsilon\sqrt{g-g'} - c_\Gamma\sqrt{1-g+g'} \right)^2}{2(1-g+g')} \right].
-	 * \f]
-	 *
-	 * \param[in] gp The current value of \f$g'\f$.
-	 * \param[in] params The fit parameters, assumed to be in vector<double>
-	 *    form (although passed as void* to satisfy GSL requirements).
-	 * \return The integrand evaluated at this value of \f$g'\f$.
-	 */
-	static double int_dp_dcgamma(double gp, void *params);
+	/// Index of \f$\mathrm{int\_dp\_dcgamma}\f$ in the output of integrals().
+	const static std::size_t INT_DP_DCGAMMA = 2;
+
+	/// Index of \f$\mathrm{int\_dp\_dgminus}\f$ in the output of integrals().
+	const static std::size_t INT_DP_DGMINUS = 3;
+
+	/// Index of \f$1/g\f$ in the derived quantities of a point.
+	const static std::size_t INV_G = 0;
 
 	/**
-	 * \brief GSL integrand function for the derivative of the fit function
-	 *    integral with respect to \f$g_-\f$.
-	 *
-	 * Function to be used in the GSL QAGS routine to evaluate \f[
-	 * \int\limits_{0}^{g} \mathrm{d}g' \frac{1}{\sqrt{(g-g')(1-g+g')^3}} \exp\left[ -\left( \frac{g'-g_-}{kg_-} \right)^2 - \frac{\left( c_\varepsilon\sqrt{g-g'} - c_\Gamma\sqrt{1-g+g'} \right)^2}{2(1-g+g')} \right].
-	 * \f]
+	 * \brief Evaluates the fit function integral and the integrals for its
+	 *    derivatives.
+	 *
+	 * The integrals are \f{eqnarray}
+	 * \mathrm{int\_p}(g) & = & \int\limits_{0}^{g} \mathrm{d}g' \frac{1+\mathrm{erf}\left( \frac{g'-g_-}{kg_-} \right)}{g' \sqrt{(g-g')(1-g+g')^3}} \exp\left[ - \frac{\left( c_\varepsilon\sqrt{g-g'} - c_\Gamma\sqrt{1-g+g'} \right)^2}{2(1-g+g')} \right], \\
+	 * \mathrm{int\_dp\_dcepsilon}(g) & = & \int\limits_{0}^{g} \mathrm{d}g' \frac{\left[ 1+\mathrm{erf}\left( \frac{g'-g_-}{kg_-} \right) \right] \left(c_\Gamma\sqrt{1-g+g'}-c_\varepsilon\sqrt{g-g'}\right)}{g' (1-g+g')^{5/2}} \exp\left[ - \frac{\left( c_\varepsilon\sqrt{g-g'} - c_\Gamma\sqrt{1-g+g'} \right)^2}{2(1-g+g')} \right], \\
+	 * \mathrm{int\_dp\_dcgamma}(g) & = & \int\limits_{0}^{g} \mathrm{d}g' \frac{\left[ 1+\mathrm{erf}\left( \frac{g'-g_-}{kg_-} \right) \right] \left( c_\varepsilon\sqrt{g-g'}-c_\Gamma\sqrt{1-g+g'}\right)}{g' \sqrt{g-g'} (1-g+g')^2} \exp\left[ - \frac{\left( c_\varepsilon\sqrt{g-g'} - c_\Gamma\sqrt{1-g+g'} \right)^2}{2(1-g+g')} \right], \\
+	 * \mathrm{int\_dp\_dgminus}(g) & = & \int\limits_{0}^{g} \mathrm{d}g' \frac{1}{\sqrt{(g-g')(1-g+g')^3}} \exp\left[ -\left( \frac{g'-g_-}{kg_-} \right)^2 - \frac{\left( c_\varepsilon\sqrt{g-g'} - c_\Gamma\sqrt{1-g+g'} \right)^2}{2(1-g+g')} \right].
+	 * \f}
+	 * All four integrands share the same kernel, so they are evaluated
+	 * together at the same nodes of an adaptive Gauss-Kronrod quadrature.
+	 * The substitution \f$g'=g-u^2\f$ removes the integrable singularity at
+	 * \f$g'=g\f$. The error function is only evaluated within six smoothing
+	 * widths (\f$kg_-\f$) of the threshold; elsewhere it is \f$\pm1\f$ to
+	 * machine precision.
 	 *
-	 * \param[in] gp The current value of \f$g'\f$.
-	 * \param[in] params The fit parameters, assumed to be in vector<double>
-	 *    form (although passed as void* to satisfy GSL requirements).
-	 * \return The integrand evaluated at this value of \f$g'\f$.
+	 * \param[in] fitparam The fitting parameters.
+	 * \param[in] g The conductance.
+	 * \return The four integrals, indexed by INT_P, INT_DP_DCEPSILON,
+	 *    INT_DP_DCGAMMA, and INT_DP_DGMINUS.
 	 */
-	static double int_dp_dgminus(double gp, void *params);
+	std::array<double, 4> integrals(const std::vector<double> &fitparam,
+		const double g) const;
 
 public:
 	/// Index for the \f$c_\varepsilon\f$ fitting parameter.
@@ -216,35 +192,38 @@ public:
 	 * \frac{\partial \hat{P}(g)}{\partial N_\mathrm{background}} & = & \frac{1}{g}, \\
 	 * \frac{\partial \hat{P}(g)}{\partial N_\mathrm{baseline}} & = & 1.
 	 * \f}
-	 * where int_p is evaluated with \c SymmetricNonresonantPlusBackgroundFitModel::int_p,
-	 * and likewise for \c SymmetricNonresonantPlusBackgroundFitModel::int_dp_dcepsilon
-	 * and \c SymmetricNonresonantPlusBackgroundFitModel::int_dp_dcgamma.
+	 * where the integrals are evaluated with
+	 * \c ExperimentSymmetricNonresonantFitModel::integrals.
 	 *
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return The Jacobian evaluated at these independent variables and
-	 *    fitting parameters.
+	 * \param[out] jac The Jacobian (`nfit` elements) evaluated at these
+	 *    independent variables and fitting parameters.
 	 */
-	virtual std::vector<double> jacobian(const std::vector<double> &fitparam,
-		const std::array<double, 1> &x, const double f) const override;
+	virtual void jacobian_row(const std::vector<double> &fitparam,
+		const std::array<double, 1> &x, const double f, double *jac)
+		const override;
 
 	/**
 	 * \brief Calculates both the residual and Jacobian of the fit for a given
 	 *    set of fitting parameters.
 	 *
 	 * The residual and the derivative with respect to \f$N_\mathrm{signal}\f$
-	 * both require the integral in \c SymmetricNonresonantPlusBackgroundFitModel::int_p.
+	 * both require \f$\mathrm{int\_p}\f$; all of the integrals are evaluated
+	 * together.
 	 *
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return A pair of the residual and Jacobian evaluated at these
+	 * \param[out] jac The Jacobian (`nfit` elements) evaluated at these
 	 *    independent variables and fitting parameters.
+	 * \return The residual evaluated at these independent variables and
+	 *    fitting parameters.
 	 */
-	virtual std::pair<double, std::vector<double>> resid_j(
-		const std::vector<double> &fitparam, const std::array<double, 1> &x,
-		const double f) const override;
+	virtual double resid_j_row(const std::vector<double> &fitparam,
+		const std::array<double, 1> &x, const double f, double *jac)
+		const override;
 
 	virtual void append_default_guesses(std::list<std::vector<double>> &guess)
 		const override;
@@ -13,6 +13,7 @@
  */
 
 #include "interference.h"
+#include <cmath>
 #include <iomanip>
 
 using namespace std;
@@ -50,45 +51,12 @@ std::vector<double> InterferenceFitModel::create_initial_guess(
 
 InterferenceFitModel::InterferenceFitModel(
 	const std::list<std::pair<std::array<double, 1>, double>> &data)
-	: FitModel<1>(2, data)
+	: AutoDiffFitModel<InterferenceFitModel, 1, 2>(data)
 {
-}
-
-double InterferenceFitModel::resid(const std::vector<double> &fitparam,
-	const std::array<double, 1> &x, const double f) const
-{
-	// get the current fit parameters and independent variable
-	const double g = x[0];
-	const double comega = fitparam[COMEGA];
-	const double norm = fitparam[NORM];
-	
-	const double model = norm / sqrt(g) * exp(-0.5*comega*comega * g);
-
-	// owing to the singularity in the form -- the data can span several
-	// orders of magnitude with most points much smaller than a few --
-	// scale by the size of the point to give more weight to the smaller
-	// points
-	return (model - f) / f;
-}
-
-std::vector<double> InterferenceFitModel::jacobian(
-	const std::vector<double> &fitparam,
-	const std::array<double, 1> &x, const double f) const
-{
-	// get the current fit parameters and independent variable
-	const double g = x[0];
-	const double comega = fitparam[COMEGA];
-	const double norm = fitparam[NORM];
-
-	vector<double> ret(nfit);
-
-	ret[COMEGA] = -norm * comega * sqrt(g) * exp(-0.5*comega*comega*g);
-	ret[COMEGA] /= f; // scaling as described above
-
-	ret[NORM] = exp(-0.5*comega*comega*g) / sqrt(g);
-	ret[NORM] /= f; // scaling, again
-
-	return ret;
+	set_derived(1, [] (const array<double, 1> &x, double *d) -> void
+		{
+			d[INV_SQRT_G] = 1. / std::sqrt(x[0]);
+		});
 }
 
 void InterferenceFitModel::append_default_guesses(
@@ -123,5 +91,11 @@ void InterferenceFitModel::process_fit_parameters(
 		fitparams[COMEGA] = -fitparams[COMEGA];
 }
 
+double InterferenceFitModel::residual_scale(
+	const std::array<double, 1> &x, const double f) const
+{
+	return f;
+}
+
 } // namespace molstat::transport
 } // namespace molstat
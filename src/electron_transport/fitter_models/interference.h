@@ -14,7 +14,9 @@
 #ifndef __interference_h__
 #define __interference_h__
 
-#include <general/fitter_tools/fit_model_interface.h>
+#include <array>
+#include <cmath>
+#include <general/fitter_tools/autodiff_fit_model.h>
 
 namespace molstat {
 namespace transport {
@@ -39,7 +41,8 @@ namespace transport {
  * effect, provides a more equal weighting for all points and provides more
  * accurate fits.
  */
-class InterferenceFitModel : public FitModel<1>
+class InterferenceFitModel :
+	public AutoDiffFitModel<InterferenceFitModel, 1, 2>
 {
 protected:
 	/**
@@ -58,6 +61,9 @@ protected:
 	virtual std::vector<double> create_initial_guess(
 		const std::map<std::string, double> &values) const override;
 
+	/// Index of \f$1/\sqrt{g}\f$ in the derived quantities of a point.
+	const static std::size_t INV_SQRT_G = 0;
+
 public:
 	/// Index for the \f$c_\omega\f$ fitting parameter.
 	const static int COMEGA = 0;
@@ -78,39 +84,22 @@ public:
 		const std::list<std::pair<std::array<double, 1>, double>> &data);
 
 	/**
-	 * \brief Evaluates the fit function for this model at a given set of
-	 *    independent variables and fitting parameters.
-	 *
-	 * \param[in] fitparam The fitting parameters.
-	 * \param[in] x The independent variables for the function.
-	 * \param[in] f The observed value of the fit function at x.
-	 * \return The function evaluated at these independent variables and
-	 *    fitting parameters.
-	 */
-	virtual double resid(const std::vector<double> &fitparam,
-		const std::array<double, 1> &x, const double f) const override;
-
-	/**
-	 * \brief Calculates the Jacobian of the fit function for a given set of
-	 *    fitting parameters and a specific set of independent variables.
+	 * \brief Evaluates the residual for the specified data point at a given
+	 *    set of independent variables and fitting parameters.
 	 *
-	 * For reference, the elements of the Jacobian are given by
-	 * \f{eqnarray}
-	 * \frac{\partial \hat{P}(g)}{\partial c_\omega} & = & -N c_\omega \sqrt{g} \exp\left[ -\frac{c_\omega^2 g}{2} \right]; \\
-	 * \frac{\partial \hat{P}(g)}{\partial N} & = & \frac{1}{\sqrt{g}} \exp\left[ -\frac{c_\omega^2 g}{2} \right].
-	 * \f}
+	 * The Jacobian is calculated from this function by automatic
+	 * differentiation; see AutoDiffFitModel.
 	 *
+	 * \tparam T The type of the fitting parameters (double or Dual).
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return The Jacobian evaluated at these independent variables and
+	 * \return The residual evaluated at these independent variables and
 	 *    fitting parameters.
 	 */
-	virtual std::vector<double> jacobian(const std::vector<double> &fitparam,
-		const std::array<double, 1> &x, const double f) const override;
-
-	/* There is no redundency in calculating fit_function and jacobian, so we
-	 * can use the simple default resid_j function in FitModel<1>. */
+	template<typename T>
+	T generic_resid(const std::array<T, 2> &fitparam,
+		const std::array<double, 1> &x, const double f) const;
 
 	virtual void append_default_guesses(std::list<std::vector<double>> &guess)
 		const override;
@@ -127,8 +116,42 @@ public:
 	 */
 	virtual void process_fit_parameters(std::vector<double> &fitparams) const
 		override;
+
+	/**
+	 * \brief Gets the scale of the residuals (see FitModel::residual_scale).
+	 *
+	 * The residuals are relative to the observed value.
+	 *
+	 * \param[in] x The independent variables of the point.
+	 * \param[in] f The observed value of the fit function at x.
+	 * \return The observed value.
+	 */
+	virtual double residual_scale(const std::array<double, 1> &x,
+		const double f) const override;
 };
 
+// templated function definitions
+template<typename T>
+T InterferenceFitModel::generic_resid(const std::array<T, 2> &fitparam,
+	const std::array<double, 1> &x, const double f) const
+{
+	using std::exp;
+
+	// get the current fit parameters and independent variable
+	const double g = x[0];
+	const T &comega = fitparam[COMEGA];
+	const T &norm = fitparam[NORM];
+
+	const T model = norm * derived(x)[INV_SQRT_G]
+		* exp(-0.5*comega*comega * g);
+
+	// owing to the singularity in the form -- the data can span several
+	// orders of magnitude with most points much smaller than a few --
+	// scale by the size of the point to give more weight to the smaller
+	// points
+	return (model - f) / f;
+}
+
 } // namespace transport
 } // namespace molstat
 
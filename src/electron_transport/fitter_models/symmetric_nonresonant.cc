@@ -13,7 +13,9 @@
  */
 
 #include "symmetric_nonresonant.h"
+#include <cmath>
 #include <iomanip>
+#include <electron_transport/channel_kernels.h>
 
 using namespace std;
 
@@ -52,49 +54,16 @@ std::vector<double> SymmetricNonresonantFitModel::create_initial_guess(
 
 SymmetricNonresonantFitModel::SymmetricNonresonantFitModel(
 	const std::list<std::pair<std::array<double, 1>, double>> &data)
-	: FitModel<1>(3, data)
+	: AutoDiffFitModel<SymmetricNonresonantFitModel, 1, 3>(data)
 {
-}
-
-double SymmetricNonresonantFitModel::resid(const std::vector<double> &fitparam,
-	const std::array<double, 1> &x, const double f) const
-{
-	// get the current parameters and independent variable
-	const double g = x[0];
-	const double ceps = fitparam[CEPSILON];
-	const double cgamma = fitparam[CGAMMA];
-	const double norm = fitparam[NORM];
-
-	const double cd = ceps*sqrt(g) - cgamma*sqrt(1. - g);
-	const double expcd = exp(-0.5*cd*cd / (1. - g));
-
-	const double model = norm / sqrt(g*(1.-g)*(1.-g)*(1.-g)) * expcd;
-
-	return model - f;
-}
-
-std::vector<double> SymmetricNonresonantFitModel::jacobian(
-	const std::vector<double> &fitparam,
-	const std::array<double, 1> &x, const double f) const
-{
-	// get the current parameters and independent variable
-	const double g = x[0];
-	const double ceps = fitparam[CEPSILON];
-	const double cgamma = fitparam[CGAMMA];
-	const double norm = fitparam[NORM];
-
-	const double cd = ceps*sqrt(g) - cgamma*sqrt(1. - g);
-	const double expcd = exp(-0.5*cd*cd / (1. - g));
-
-	vector<double> ret(nfit);
-
-	ret[CEPSILON] = -norm * cd * expcd / ((1.-g)*(1.-g)*sqrt(1.-g));
-
-	ret[CGAMMA] = norm * cd * expcd / ((1.-g)*(1.-g)*sqrt(g));
-
-	ret[NORM] = expcd / ((1.-g)*sqrt(g*(1.-g)));
-
-	return ret;
+	set_derived(4, [] (const array<double, 1> &x, double *d) -> void
+		{
+			const double g = x[0];
+			d[SQRT_G] = std::sqrt(g);
+			d[SQRT_1MG] = std::sqrt(1. - g);
+			d[INV_1MG] = 1. / (1. - g);
+			d[PREFACTOR] = SymOneSiteNonresonantJacobian(g);
+		});
 }
 
 void SymmetricNonresonantFitModel::append_default_guesses(
@@ -14,7 +14,9 @@
 #ifndef __symmetric_nonresonant_h__
 #define __symmetric_nonresonant_h__
 
-#include <general/fitter_tools/fit_model_interface.h>
+#include <array>
+#include <cmath>
+#include <general/fitter_tools/autodiff_fit_model.h>
 
 namespace molstat {
 namespace transport {
@@ -38,7 +40,8 @@ namespace transport {
  *
  * This model is detailed in Reference \cite williams-5937.
  */
-class SymmetricNonresonantFitModel : public FitModel<1>
+class SymmetricNonresonantFitModel :
+	public AutoDiffFitModel<SymmetricNonresonantFitModel, 1, 3>
 {
 protected:
 	/**
@@ -57,6 +60,18 @@ protected:
 	virtual std::vector<double> create_initial_guess(
 		const std::map<std::string, double> &values) const override;
 
+	/// Index of \f$\sqrt{g}\f$ in the derived quantities of a point.
+	const static std::size_t SQRT_G = 0;
+
+	/// Index of \f$\sqrt{1-g}\f$ in the derived quantities of a point.
+	const static std::size_t SQRT_1MG = 1;
+
+	/// Index of \f$1/(1-g)\f$ in the derived quantities of a point.
+	const static std::size_t INV_1MG = 2;
+
+	/// Index of \f$1/\sqrt{g(1-g)^3}\f$ in the derived quantities of a point.
+	const static std::size_t PREFACTOR = 3;
+
 public:
 	/// Index for the \f$c_\varepsilon\f$ fitting parameter.
 	const static int CEPSILON = 0;
@@ -80,40 +95,22 @@ public:
 		const std::list<std::pair<std::array<double, 1>, double>> &data);
 
 	/**
-	 * \brief Evaluates the fit function for this model at a given set of
-	 *    independent variables and fitting parameters.
+	 * \brief Evaluates the residual for the specified data point at a given
+	 *    set of independent variables and fitting parameters.
 	 *
-	 * \param[in] fitparam The fitting parameters.
-	 * \param[in] x The independent variables for the function.
-	 * \param[in] f The observed value of the fit function at x.
-	 * \return The function evaluated at these independent variables and
-	 *    fitting parameters.
-	 */
-	virtual double resid(const std::vector<double> &fitparam,
-		const std::array<double, 1> &x, const double f) const override;
-
-	/**
-	 * \brief Calculates the Jacobian of the fit function for a given set of
-	 *    fitting parameters and a specific set of independent variables.
-	 *
-	 * For reference, the elements of the Jacobian are given by
-	 * \f{eqnarray}
-	 * \frac{\partial \hat{P}(g)}{\partial c_\varepsilon} & = & -\frac{N (c_\varepsilon\sqrt{g} - c_\Gamma\sqrt{1-g})}{(1-g)^{5/2}} \exp\left[ - \frac{(c_\varepsilon\sqrt{g} - c_\Gamma\sqrt{1-g})^2}{2(1-g)} \right]; \\
-	 * \frac{\partial \hat{P}(g)}{\partial c_\Gamma} & = & \frac{N (c_\varepsilon\sqrt{g} - c_\Gamma\sqrt{1-g})}{\sqrt{g} (1-g)^2} \exp\left[ - \frac{(c_\varepsilon\sqrt{g} - c_\Gamma\sqrt{1-g})^2}{2(1-g)} \right]; \\
-	 * \frac{\partial \hat{P}(g)}{\partial N} & = & \frac{1}{\sqrt{g(1-g)^3}} \exp\left[ - \frac{(c_\varepsilon\sqrt{g} - c_\Gamma\sqrt{1-g})^2}{2(1-g)} \right]; \\
-	 * \f}
+	 * The Jacobian is calculated from this function by automatic
+	 * differentiation; see AutoDiffFitModel.
 	 *
+	 * \tparam T The type of the fitting parameters (double or Dual).
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return The Jacobian evaluated at these independent variables and
+	 * \return The residual evaluated at these independent variables and
 	 *    fitting parameters.
 	 */
-	virtual std::vector<double> jacobian(const std::vector<double> &fitparam,
-		const std::array<double, 1> &x, const double f) const override;
-
-	/* There is no redundency in calculating fit_function and jacobian, so we
-	 * can use the simple default resid_j function in FitModel<1>. */
+	template<typename T>
+	T generic_resid(const std::array<T, 3> &fitparam,
+		const std::array<double, 1> &x, const double f) const;
 
 	virtual void append_default_guesses(std::list<std::vector<double>> &guess)
 		const override;
@@ -125,6 +122,28 @@ public:
 		override;
 };
 
+// templated function definitions
+template<typename T>
+T SymmetricNonresonantFitModel::generic_resid(const std::array<T, 3> &fitparam,
+	const std::array<double, 1> &x, const double f) const
+{
+	using std::exp;
+
+	// get the current parameters and the functions of the independent
+	// variable
+	const double *const d = derived(x);
+	const T &ceps = fitparam[CEPSILON];
+	const T &cgamma = fitparam[CGAMMA];
+	const T &norm = fitparam[NORM];
+
+	const T cd = ceps*d[SQRT_G] - cgamma*d[SQRT_1MG];
+	const T expcd = exp(-0.5*cd*cd * d[INV_1MG]);
+
+	const T model = norm * d[PREFACTOR] * expcd;
+
+	return model - f;
+}
+
 } // namespace molstat::transport
 } // namespace molstat
 
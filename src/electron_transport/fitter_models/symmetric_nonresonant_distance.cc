@@ -0,0 +1,139 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file symmetric_nonresonant_distance.cc
+ * \brief Implementation of the fitting model for conductance-distance
+ *    histograms of nonresonant tunneling (symmetric coupling).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "symmetric_nonresonant_distance.h"
+#include <cmath>
+#include <iomanip>
+#include <electron_transport/channel_kernels.h>
+
+using namespace std;
+
+namespace molstat {
+namespace transport {
+
+std::vector<double> SymmetricNonresonantDistanceFitModel::create_initial_guess(
+	const std::map<std::string, double> &values) const
+{
+	vector<double> ret(5);
+
+	try
+	{
+		ret[CEPSILON] = values.at("cepsilon");
+		ret[CGAMMA] = values.at("cgamma");
+	}
+	catch(const out_of_range &e)
+	{
+		throw invalid_argument("Initial guesses for the Symmetric" \
+			"NonresonantDistanceFitModel must specify \"cepsilon\" and " \
+			"\"cgamma\" parameters.");
+	}
+
+	// the distance parameters and norm are optional
+	const auto optional = [&values] (const string &name, double def) -> double
+	{
+		const auto iter = values.find(name);
+		return iter == values.end() ? def : iter->second;
+	};
+	ret[Z0] = optional("z0", data_z0);
+	ret[SIGMA] = optional("sigma", data_sigma);
+	ret[NORM] = optional("norm", 1.);
+
+	return ret;
+}
+
+SymmetricNonresonantDistanceFitModel::SymmetricNonresonantDistanceFitModel(
+	const std::list<std::pair<std::array<double, 2>, double>> &data)
+	: AutoDiffFitModel<SymmetricNonresonantDistanceFitModel, 2, 5>(data),
+	  data_z0(0.), data_sigma(1.)
+{
+	set_derived(4, [] (const array<double, 2> &x, double *d) -> void
+		{
+			const double g = x[0];
+			d[SQRT_G] = std::sqrt(g);
+			d[SQRT_1MG] = std::sqrt(1. - g);
+			d[INV_1MG] = 1. / (1. - g);
+			d[PREFACTOR] = SymOneSiteNonresonantJacobian(g);
+		});
+
+	// moments of the distance, weighted by the histogram
+	double sum{ 0. }, sumz{ 0. }, sumz2{ 0. };
+	for(const pair<array<double, 2>, double> &point : data)
+	{
+		if(point.second <= 0.)
+			continue;
+
+		sum += point.second;
+		sumz += point.second * point.first[1];
+		sumz2 += point.second * point.first[1] * point.first[1];
+	}
+
+	if(sum > 0.)
+	{
+		data_z0 = sumz / sum;
+
+		const double var{ sumz2 / sum - data_z0 * data_z0 };
+		if(var > 0.)
+			data_sigma = std::sqrt(var);
+	}
+}
+
+void SymmetricNonresonantDistanceFitModel::append_default_guesses(
+	std::list<std::vector<double>> &guess) const
+{
+	const list<double> list_ceps{50., 100., 200., 300., 400., 500.},
+		list_cgamma{5., 10., 20., 30., 40., 50.};
+
+	for(const double ceps : list_ceps)
+	{
+		for(const double cgamma : list_cgamma)
+		{
+			vector<double> init(nfit);
+			init[CEPSILON] = ceps;
+			init[CGAMMA] = cgamma;
+			init[Z0] = data_z0;
+			init[SIGMA] = data_sigma;
+			init[NORM] = 1.;
+
+			guess.emplace_back(init);
+		}
+	}
+}
+
+void SymmetricNonresonantDistanceFitModel::print_fit(std::ostream &out,
+	const std::vector<double> &fitparam) const
+{
+	out << "cepsilon=" << scientific << setprecision(4) << fitparam[CEPSILON] <<
+		", cgamma=" << scientific << setprecision(4) << fitparam[CGAMMA] <<
+		", z0=" << scientific << setprecision(4) << fitparam[Z0] <<
+		", sigma=" << scientific << setprecision(4) << fitparam[SIGMA] <<
+		", norm=" << scientific << setprecision(4) << fitparam[NORM];
+}
+
+void SymmetricNonresonantDistanceFitModel::process_fit_parameters(
+	std::vector<double> &fitparams) const
+{
+	// the line shape only depends on sigma^2
+	if(fitparams[SIGMA] < 0.)
+		fitparams[SIGMA] = -fitparams[SIGMA];
+
+	// sometimes both cepsilon and cgamma go negative
+	if(fitparams[CEPSILON] < 0. && fitparams[CGAMMA] < 0.)
+	{
+		fitparams[CEPSILON] = -fitparams[CEPSILON];
+		fitparams[CGAMMA] = -fitparams[CGAMMA];
+	}
+}
+
+} // namespace molstat::transport
+} // namespace molstat
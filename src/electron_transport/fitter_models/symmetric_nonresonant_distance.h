@@ -0,0 +1,180 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file symmetric_nonresonant_distance.h
+ * \brief Fitting model for conductance-distance histograms of nonresonant
+ *    tunneling (symmetric coupling).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __symmetric_nonresonant_distance_h__
+#define __symmetric_nonresonant_distance_h__
+
+#include <array>
+#include <cmath>
+#include <general/fitter_tools/autodiff_fit_model.h>
+
+namespace molstat {
+namespace transport {
+
+/**
+ * \brief The fit model for two-dimensional conductance-distance histograms
+ *    of nonresonant tunneling through a single site with symmetric
+ *    electrode/site couplings.
+ *
+ * The conductance is assumed to be independent of the distance (the
+ * electrode separation), which is normally distributed. The line shape is
+ * then the product of the SymmetricNonresonantFitModel line shape and a
+ * Gaussian,
+ * \f[
+ * \hat{P}(g,z) = \frac{N}{\sqrt{g(1-g)^3}} \exp\left[ - \frac{(c_\varepsilon \sqrt{g} - c_\Gamma \sqrt{1-g})^2}{2(1-g)} \right] \exp\left[ -\frac{(z-z_0)^2}{2\sigma^2} \right],
+ * \f]
+ * where \f$g\f$ is the conductance in atomic units and \f$z\f$ is the
+ * distance. The fitting parameters are \f$c_\varepsilon\f$ and
+ * \f$c_\Gamma\f$ (see SymmetricNonresonantFitModel); \f$z_0\f$ and
+ * \f$\sigma\f$, the average and standard deviation of the distance; and
+ * \f$N\f$, the normalization constant.
+ *
+ * Two-dimensional histograms have many empty bins, so (unlike some of the
+ * one-dimensional models) the residuals are not scaled by the observed
+ * values.
+ */
+class SymmetricNonresonantDistanceFitModel :
+	public AutoDiffFitModel<SymmetricNonresonantDistanceFitModel, 2, 5>
+{
+protected:
+	/// The average distance in the data, used for initial guesses.
+	double data_z0;
+
+	/// The standard deviation of the distance in the data.
+	double data_sigma;
+
+	/**
+	 * \brief Converts a map of names to values to an initial guess (ordered
+	 *    vector).
+	 *
+	 * `cepsilon` and `cgamma` parameters are needed for this model; `z0` and
+	 * `sigma` default to the average and standard deviation of the distance
+	 * in the data. See FitModel::create_initial_guess for more information.
+	 *
+	 * \throw invalid_argument_exception if `cepsilon` and `cgamma` parameters
+	 *    are not specified.
+	 *
+	 * \param[in] values The map of names to values.
+	 * \return A vector containing the initial guess.
+	 */
+	virtual std::vector<double> create_initial_guess(
+		const std::map<std::string, double> &values) const override;
+
+	/// Index of \f$\sqrt{g}\f$ in the derived quantities of a point.
+	const static std::size_t SQRT_G = 0;
+
+	/// Index of \f$\sqrt{1-g}\f$ in the derived quantities of a point.
+	const static std::size_t SQRT_1MG = 1;
+
+	/// Index of \f$1/(1-g)\f$ in the derived quantities of a point.
+	const static std::size_t INV_1MG = 2;
+
+	/// Index of \f$1/\sqrt{g(1-g)^3}\f$ in the derived quantities of a point.
+	const static std::size_t PREFACTOR = 3;
+
+public:
+	/// Index for the \f$c_\varepsilon\f$ fitting parameter.
+	const static int CEPSILON = 0;
+
+	/// Index for the \f$c_\Gamma\f$ fitting parameter.
+	const static int CGAMMA = 1;
+
+	/// Index for the \f$z_0\f$ fitting parameter.
+	const static int Z0 = 2;
+
+	/// Index for the \f$\sigma\f$ fitting parameter.
+	const static int SIGMA = 3;
+
+	/// Index for the norm fitting parameter.
+	const static int NORM = 4;
+
+	SymmetricNonresonantDistanceFitModel() = delete;
+	virtual ~SymmetricNonresonantDistanceFitModel() = default;
+
+	/**
+	 * \brief Constructor requiring the data that we will be fitting against.
+	 *
+	 * \param[in] data The data, organized in pairs of array<double, 2>
+	 *    (conductance, distance), double objects.
+	 */
+	SymmetricNonresonantDistanceFitModel(
+		const std::list<std::pair<std::array<double, 2>, double>> &data);
+
+	/**
+	 * \brief Evaluates the residual for the specified data point at a given
+	 *    set of independent variables and fitting parameters.
+	 *
+	 * The Jacobian is calculated from this function by automatic
+	 * differentiation; see AutoDiffFitModel.
+	 *
+	 * \tparam T The type of the fitting parameters (double or Dual).
+	 * \param[in] fitparam The fitting parameters.
+	 * \param[in] x The independent variables (conductance, distance).
+	 * \param[in] f The observed value of the fit function at x.
+	 * \return The residual evaluated at these independent variables and
+	 *    fitting parameters.
+	 */
+	template<typename T>
+	T generic_resid(const std::array<T, 5> &fitparam,
+		const std::array<double, 2> &x, const double f) const;
+
+	virtual void append_default_guesses(std::list<std::vector<double>> &guess)
+		const override;
+
+	virtual void print_fit(std::ostream &out,
+		const std::vector<double> &fitparam) const override;
+
+	/**
+	 * \brief Perform post-processing on a set of fit parameters.
+	 *
+	 * Makes sure `sigma` is positive and, if both are negative, flips the
+	 * signs of `cepsilon` and `cgamma`.
+	 *
+	 * \param[in,out] fitparams The fitting parameters.
+	 */
+	virtual void process_fit_parameters(std::vector<double> &fitparams) const
+		override;
+};
+
+// templated function definitions
+template<typename T>
+T SymmetricNonresonantDistanceFitModel::generic_resid(
+	const std::array<T, 5> &fitparam, const std::array<double, 2> &x,
+	const double f) const
+{
+	using std::exp;
+
+	// get the current parameters and the functions of the independent
+	// variables
+	const double *const d = derived(x);
+	const double z = x[1];
+	const T &ceps = fitparam[CEPSILON];
+	const T &cgamma = fitparam[CGAMMA];
+	const T &z0 = fitparam[Z0];
+	const T &sigma = fitparam[SIGMA];
+	const T &norm = fitparam[NORM];
+
+	const T cd = ceps*d[SQRT_G] - cgamma*d[SQRT_1MG];
+	const T dz = (z - z0) / sigma;
+
+	const T model = norm * d[PREFACTOR]
+		* exp(-0.5*cd*cd * d[INV_1MG] - 0.5*dz*dz);
+
+	return model - f;
+}
+
+} // namespace molstat::transport
+} // namespace molstat
+
+#endif
@@ -13,7 +13,9 @@
  */
 
 #include "symmetric_resonant.h"
+#include <cmath>
 #include <iomanip>
+#include <electron_transport/channel_kernels.h>
 
 using namespace std;
 
@@ -50,48 +52,14 @@ std::vector<double> SymmetricResonantFitModel::create_initial_guess(
 
 SymmetricResonantFitModel::SymmetricResonantFitModel(
 	const std::list<std::pair<std::array<double, 1>, double>> &data)
-	: FitModel<1>(2, data)
+	: AutoDiffFitModel<SymmetricResonantFitModel, 1, 2>(data)
 {
-}
-
-double SymmetricResonantFitModel::resid(const std::vector<double> &fitparam,
-	const std::array<double, 1> &x, const double f) const
-{
-	// get the current fit parameters and independent variable
-	const double g = x[0];
-	const double gamma = fitparam[GAMMA];
-	const double norm = fitparam[NORM];
-	
-	const double model = norm / sqrt(g*g*g*(1.0 - g))
-		* exp(-0.5*gamma*gamma*(1.0 - g) / g);
-
-	// owing to the singularity in the form -- the data can span several
-	// orders of magnitude with most points much smaller than a few --
-	// scale by the size of the point to give more weight to the smaller
-	// points
-	return (model - f) / f;
-}
-
-std::vector<double> SymmetricResonantFitModel::jacobian(
-	const std::vector<double> &fitparam,
-	const std::array<double, 1> &x, const double f) const
-{
-	// get the current fit parameters and independent variable
-	const double g = x[0];
-	const double gamma = fitparam[GAMMA];
-	const double norm = fitparam[NORM];
-
-	vector<double> ret(nfit);
-
-	ret[GAMMA] = -gamma * norm * sqrt((1.0 - g) / g)
-		* exp(-0.5*gamma*gamma*(1.0-g)/g) / (g*g);
-	ret[GAMMA] /= f; // scaling as described above
-
-	ret[NORM] = 1.0 / sqrt(g*g*g*(1.0 - g))
-		* exp(-0.5*gamma*gamma*(1.0 - g) / g);
-	ret[NORM] /= f; // scaling, again
-
-	return ret;
+	set_derived(2, [] (const array<double, 1> &x, double *d) -> void
+		{
+			const double g = x[0];
+			d[PREFACTOR] = SymOneSiteResonantJacobian(g);
+			d[RATIO] = SymOneSiteResonantRatio(g);
+		});
 }
 
 void SymmetricResonantFitModel::append_default_guesses(
@@ -126,5 +94,11 @@ void SymmetricResonantFitModel::process_fit_parameters(
 		fitparams[GAMMA] = -fitparams[GAMMA];
 }
 
+double SymmetricResonantFitModel::residual_scale(
+	const std::array<double, 1> &x, const double f) const
+{
+	return f;
+}
+
 } // namespace molstat::transport
 } // namespace molstat
@@ -14,7 +14,9 @@
 #ifndef __symmetric_resonant_h__
 #define __symmetric_resonant_h__
 
-#include <general/fitter_tools/fit_model_interface.h>
+#include <array>
+#include <cmath>
+#include <general/fitter_tools/autodiff_fit_model.h>
 
 namespace molstat {
 namespace transport {
@@ -46,7 +48,8 @@ namespace transport {
  *
  * This model is detailed in Reference \cite williams-5937.
  */
-class SymmetricResonantFitModel : public FitModel<1>
+class SymmetricResonantFitModel :
+	public AutoDiffFitModel<SymmetricResonantFitModel, 1, 2>
 {
 protected:
 	/**
@@ -65,6 +68,12 @@ protected:
 	virtual std::vector<double> create_initial_guess(
 		const std::map<std::string, double> &values) const override;
 
+	/// Index of \f$1/\sqrt{g^3(1-g)}\f$ in the derived quantities of a point.
+	const static std::size_t PREFACTOR = 0;
+
+	/// Index of \f$(1-g)/g\f$ in the derived quantities of a point.
+	const static std::size_t RATIO = 1;
+
 public:
 	/// Index for the gamma fitting parameter.
 	const static int GAMMA = 0;
@@ -85,39 +94,22 @@ public:
 		const std::list<std::pair<std::array<double, 1>, double>> &data);
 
 	/**
-	 * \brief Evaluates the fit function for this model at a given set of
-	 *    independent variables and fitting parameters.
-	 *
-	 * \param[in] fitparam The fitting parameters.
-	 * \param[in] x The independent variables for the function.
-	 * \param[in] f The observed value of the fit function at x.
-	 * \return The function evaluated at these independent variables and
-	 *    fitting parameters.
-	 */
-	virtual double resid(const std::vector<double> &fitparam,
-		const std::array<double, 1> &x, const double f) const override;
-
-	/**
-	 * \brief Calculates the Jacobian of the fit function for a given set of
-	 *    fitting parameters and a specific set of independent variables.
+	 * \brief Evaluates the residual for the specified data point at a given
+	 *    set of independent variables and fitting parameters.
 	 *
-	 * For reference, the elements of the Jacobian are given by
-	 * \f{eqnarray}
-	 * \frac{\partial \hat{P}(g)}{\partial \gamma} & = & -\frac{N \gamma}{g^2} \sqrt{\frac{1-g}{g}} \exp\left[ -\gamma^2 \frac{1-g}{2g} \right]; \\
-	 * \frac{\partial \hat{P}(g)}{\partial N} & = & \frac{1}{\sqrt{g^3(1-g)}} \exp\left[ -\gamma^2 \frac{1-g}{2g} \right].
-	 * \f}
+	 * The Jacobian is calculated from this function by automatic
+	 * differentiation; see AutoDiffFitModel.
 	 *
+	 * \tparam T The type of the fitting parameters (double or Dual).
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return The Jacobian evaluated at these independent variables and
+	 * \return The residual evaluated at these independent variables and
 	 *    fitting parameters.
 	 */
-	virtual std::vector<double> jacobian(const std::vector<double> &fitparam,
-		const std::array<double, 1> &x, const double f) const override;
-
-	/* There is no redundency in calculating fit_function and jacobian, so we
-	 * can use the simple default resid_j function in FitModel<1>. */
+	template<typename T>
+	T generic_resid(const std::array<T, 2> &fitparam,
+		const std::array<double, 1> &x, const double f) const;
 
 	virtual void append_default_guesses(std::list<std::vector<double>> &guess)
 		const override;
@@ -134,8 +126,43 @@ public:
 	 */
 	virtual void process_fit_parameters(std::vector<double> &fitparams) const
 		override;
+
+	/**
+	 * \brief Gets the scale of the residuals (see FitModel::residual_scale).
+	 *
+	 * The residuals are relative to the observed value.
+	 *
+	 * \param[in] x The independent variables of the point.
+	 * \param[in] f The observed value of the fit function at x.
+	 * \return The observed value.
+	 */
+	virtual double residual_scale(const std::array<double, 1> &x,
+		const double f) const override;
 };
 
+// templated function definitions
+template<typename T>
+T SymmetricResonantFitModel::generic_resid(const std::array<T, 2> &fitparam,
+	const std::array<double, 1> &x, const double f) const
+{
+	using std::exp;
+
+	// get the current fit parameters and the functions of the independent
+	// variable
+	const double *const d = derived(x);
+	const T &gamma = fitparam[GAMMA];
+	const T &norm = fitparam[NORM];
+
+	const T model = norm * d[PREFACTOR]
+		* exp(-0.5*gamma*gamma * d[RATIO]);
+
+	// owing to the singularity in the form -- the data can span several
+	// orders of magnitude with most points much smaller than a few --
+	// scale by the size of the point to give more weight to the smaller
+	// points
+	return (model - f) / f;
+}
+
 } // namespace transport
 } // namespace molstat
 
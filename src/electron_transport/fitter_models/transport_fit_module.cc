@@ -19,6 +19,7 @@
 #include "composite_symmetric_nonresonant_background.h"
 #include "experiment_symmetric_nonresonant.h"
 #include "composite_interference_background.h"
+#include "symmetric_nonresonant_distance.h"
 #include <exception>
 
 using namespace std;
@@ -27,28 +28,35 @@ namespace molstat {
 namespace transport {
 
 void load_models(
-	std::map<std::string, FitModelFactory<1>> &models)
+	NameRegistry<FitModelFactory<1>> &models)
 {
-	models["symmetricresonant"] =
-		GetFitModelFactory<SymmetricResonantFitModel, 1>();
+	models.add(MOLSTAT_REGISTRY_KEY("SymmetricResonant"),
+		GetFitModelFactory<SymmetricResonantFitModel, 1>());
 
-	models["symmetricnonresonant"] =
-		GetFitModelFactory<SymmetricNonresonantFitModel, 1>();
+	models.add(MOLSTAT_REGISTRY_KEY("SymmetricNonresonant"),
+		GetFitModelFactory<SymmetricNonresonantFitModel, 1>());
 
-	models["asymmetricresonant"] =
-		GetFitModelFactory<AsymmetricResonantFitModel, 1>();
+	models.add(MOLSTAT_REGISTRY_KEY("AsymmetricResonant"),
+		GetFitModelFactory<AsymmetricResonantFitModel, 1>());
 
-	models["compositesymmetricnonresonantbackground"] =
-		GetFitModelFactory<CompositeSymmetricNonresonantBackgroundFitModel, 1>();
+	models.add(MOLSTAT_REGISTRY_KEY("CompositeSymmetricNonresonantBackground"),
+		GetFitModelFactory<CompositeSymmetricNonresonantBackgroundFitModel, 1>());
 
-	models["experimentsymmetricnonresonant"] =
-		GetFitModelFactory<ExperimentSymmetricNonresonantFitModel, 1>();
+	models.add(MOLSTAT_REGISTRY_KEY("ExperimentSymmetricNonresonant"),
+		GetFitModelFactory<ExperimentSymmetricNonresonantFitModel, 1>());
 
-	models["interference"] =
-		GetFitModelFactory<InterferenceFitModel, 1>();
+	models.add(MOLSTAT_REGISTRY_KEY("Interference"),
+		GetFitModelFactory<InterferenceFitModel, 1>());
 
-	models["compositeinterferencebackground"] =
-		GetFitModelFactory<CompositeInterferenceBackgroundFitModel, 1>();
+	models.add(MOLSTAT_REGISTRY_KEY("CompositeInterferenceBackground"),
+		GetFitModelFactory<CompositeInterferenceBackgroundFitModel, 1>());
+}
+
+void load_models(
+	NameRegistry<FitModelFactory<2>> &models)
+{
+	models.add(MOLSTAT_REGISTRY_KEY("SymmetricNonresonantDistance"),
+		GetFitModelFactory<SymmetricNonresonantDistanceFitModel, 2>());
 }
 
 } // namespace molstat::transport
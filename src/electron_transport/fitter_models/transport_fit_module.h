@@ -15,8 +15,7 @@
 #define __transport_fit_models_h__
 
 #include <general/fitter_tools/fit_model_interface.h>
-#include <map>
-#include <string>
+#include <general/name_registry.h>
 
 namespace molstat {
 namespace transport {
@@ -24,14 +23,25 @@ namespace transport {
 /**
  * \brief Loads the transport models into the MolStat "database".
  *
- * Models are stored as a map from a string (the name of the model) to a
- * factory for the model (of type FitModelFactory).
+ * Models are stored in a registry from the name of the model (case
+ * insensitive) to a factory for the model (of type FitModelFactory).
  *
- * \param[in,out] models The map of models in MolStat. On output, the models
- *    for transport have been added to it.
+ * \param[in,out] models The registry of models in MolStat. On output, the
+ *    models for transport have been added to it.
  */
 void load_models(
-	std::map<std::string, FitModelFactory<1>> &models);
+	NameRegistry<FitModelFactory<1>> &models);
+
+/**
+ * \brief Loads the transport models for two-dimensional data (e.g.,
+ *    conductance-distance histograms) into the MolStat "database".
+ *
+ * \param[in,out] models The registry of two-dimensional models in MolStat.
+ *    On output, the two-dimensional models for transport have been added to
+ *    it.
+ */
+void load_models(
+	NameRegistry<FitModelFactory<2>> &models);
 
 } // namespace molstat::transport
 } // namespace molstat
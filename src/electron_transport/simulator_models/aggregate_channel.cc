@@ -0,0 +1,231 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file aggregate_channel.cc
+ * \brief Channel comprised of a random number of independent copies of
+ *    another channel.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "aggregate_channel.h"
+#include <cmath>
+#include <stdexcept>
+#include <general/simulator_tools/simulator_exceptions.h>
+
+namespace molstat {
+namespace transport {
+
+const std::size_t AggregateChannel::Index_EF = TransportJunction::Index_EF;
+const std::size_t AggregateChannel::Index_V = TransportJunction::Index_V;
+const std::size_t AggregateChannel::Index_kT = TransportJunction::Index_kT;
+const std::size_t AggregateChannel::Index_copies = 3;
+const std::size_t AggregateChannel::Index_maxcopies = 4;
+
+namespace {
+
+/// \cond
+/**
+ * \brief Sums an observable over the molecules in each trial of a batch.
+ *
+ * \param[in] channel The batch function of the submodel.
+ * \param[in] routes The indices of the parameters for each copy of the
+ *    submodel.
+ * \param[in] params The parameters of the aggregate channel.
+ * \param[in] ntrials The number of trials.
+ * \param[out] out The observable for each trial.
+ */
+void AggregateBatch(const BatchObservableFunction &channel,
+	const SubmodelRoutes &routes, const double *const *params,
+	const std::size_t ntrials, double *out)
+{
+	const std::size_t nchannel{ routes.routeSize(0) };
+	const double *const copies{ params[AggregateChannel::Index_copies] };
+
+	// one buffer for the number of molecules in each trial, one for the
+	// parameters of all molecules, and one for their observables
+	SubmodelParameterBuffers::Frame frame{ 3 };
+	std::valarray<double> &nmol = frame.get(0, ntrials);
+
+	std::size_t total{ 0 };
+	for(std::size_t t = 0; t < ntrials; ++t)
+	{
+		const double k{ std::round(copies[t]) };
+		nmol[t] = (k >= 1. && k <= routes.size()) ? k : 0.;
+		total += static_cast<std::size_t>(nmol[t]);
+	}
+
+	std::valarray<double> &rows = frame.get(1, nchannel * total);
+	std::valarray<double> &subout = frame.get(2, total);
+
+	if(total > 0)
+	{
+		// gather the parameters, molecule-by-molecule within each trial
+		std::vector<const double *> subparams(nchannel);
+		for(std::size_t p = 0; p < nchannel; ++p)
+		{
+			double *const row{ &rows[p * total] };
+			std::size_t r{ 0 };
+			for(std::size_t t = 0; t < ntrials; ++t)
+				for(std::size_t k = 0; k < nmol[t]; ++k)
+					row[r++] = params[routes.route(k)[p]][t];
+
+			subparams[p] = row;
+		}
+
+		// all molecules in one call
+		channel(subparams.data(), nchannel, total, &subout[0]);
+	}
+
+	// sum over the molecules; a trial does not produce the observable if
+	// any of its molecules does not
+	std::size_t r{ 0 };
+	for(std::size_t t = 0; t < ntrials; ++t)
+	{
+		if(nmol[t] == 0.)
+		{
+			out[t] = NoObservableValue;
+			continue;
+		}
+
+		double sum{ 0. };
+		for(std::size_t k = 0; k < nmol[t]; ++k)
+			sum += subout[r++];
+		out[t] = sum;
+	}
+}
+/// \endcond
+
+} // anonymous namespace
+
+AggregateChannel::AggregateChannel()
+{
+	aggregateObservable(GetObservableIndex<ElectricCurrent>());
+	aggregateObservable(GetObservableIndex<ZeroBiasConductance>());
+	aggregateObservable(GetObservableIndex<DifferentialConductance>());
+	aggregateObservable(GetObservableIndex<StaticConductance>());
+}
+
+void AggregateChannel::aggregateObservable(const ObservableIndex &obs)
+{
+	batch_observables[obs] =
+		[obs] (std::shared_ptr<const SimulateModel> model)
+			-> BatchObservableFunction
+		{
+			std::shared_ptr<const AggregateChannel> cast =
+				std::dynamic_pointer_cast<const AggregateChannel>(model);
+			if(cast == nullptr)
+				throw IncompatibleObservable();
+			if(cast->submodels.empty())
+				throw NoSubmodels();
+
+			// the parameter indices of each copy of the submodel
+			const SubmodelRoutes routes{ cast->submodel_routes };
+
+			// the copies share the submodel (and its batch function), which
+			// throws IncompatibleObservable if the submodel is incompatible
+			const BatchObservableFunction channel
+				{ cast->submodels.front()->getBatchObservableFunction(obs) };
+
+			return [channel, routes] (const double *const *params,
+				std::size_t nparams, std::size_t ntrials, double *out) -> void
+			{
+				AggregateBatch(channel, routes, params, ntrials, out);
+			};
+		};
+
+	// individual trials are batches of one
+	compatible_observables[obs] =
+		[obs] (std::shared_ptr<const SimulateModel> model)
+			-> ObservableFunction
+		{
+			const BatchObservableFunction batch
+				{ model->getBatchObservableFunction(obs) };
+
+			return [batch] (const std::valarray<double> &params) -> double
+			{
+				std::vector<const double *> rows(params.size());
+				for(std::size_t p = 0; p < params.size(); ++p)
+					rows[p] = &params[p];
+
+				double ret;
+				batch(rows.data(), rows.size(), 1, &ret);
+				return ret;
+			};
+		};
+}
+
+std::vector<std::string> AggregateChannel::get_names() const
+{
+	std::vector<std::string> ret(2);
+
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_copies - 3] = "copies";
+	ret[Index_maxcopies - 3] = "maxcopies";
+
+	return ret;
+}
+
+void AggregateChannel::addSubmodel(std::shared_ptr<SimulateModel> submodel)
+{
+	if(!submodels.empty())
+		throw std::invalid_argument("An aggregate channel has only one " \
+			"submodel.");
+
+	double maxcopies;
+	if(!isConstantParameter(Index_maxcopies - 3, maxcopies) ||
+		maxcopies < 1. || maxcopies != std::round(maxcopies))
+	{
+		throw std::invalid_argument("The distribution of maxcopies must be a " \
+			"constant positive integer.");
+	}
+
+	// each copy gets the parameters from the TransportJunction and its own
+	// block of parameters, which follow this model's parameters (and those of
+	// the previous copies)
+	const std::size_t snparam{ submodel->get_num_parameters() };
+	for(std::size_t k = 0; k < maxcopies; ++k)
+	{
+		const std::size_t offset{ 3 + get_num_parameters() };
+
+		std::vector<std::size_t> sub_params(3 + snparam);
+		for(std::size_t j = 0; j < 3; ++j)
+			sub_params[j] = j;
+		for(std::size_t j = 0; j < snparam; ++j)
+			sub_params[j + 3] = offset + j;
+
+		submodels.emplace_back(submodel);
+		submodel_routes.append(sub_params);
+	}
+}
+
+double AggregateChannel::ECurrent(const std::valarray<double> &params) const
+{
+	return getObservableFunction(GetObservableIndex<ElectricCurrent>())
+		(params);
+}
+
+double AggregateChannel::ZeroBiasG(const std::valarray<double> &params) const
+{
+	return getObservableFunction(GetObservableIndex<ZeroBiasConductance>())
+		(params);
+}
+
+double AggregateChannel::DiffG(const std::valarray<double> &params) const
+{
+	return getObservableFunction(GetObservableIndex<DifferentialConductance>())
+		(params);
+}
+
+double AggregateChannel::StaticG(const std::valarray<double> &params) const
+{
+	return getObservableFunction(GetObservableIndex<StaticConductance>())
+		(params);
+}
+
+} // namespace molstat::transport
+} // namespace molstat
@@ -0,0 +1,126 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file aggregate_channel.h
+ * \brief Channel comprised of a random number of independent copies of
+ *    another channel.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __aggregate_channel_h__
+#define __aggregate_channel_h__
+
+#include "observables.h"
+#include "junction.h"
+
+namespace molstat {
+namespace transport {
+
+/**
+ * \brief Simulator submodel for a junction bridged by several identical
+ *    (but independent) molecules.
+ *
+ * The aggregate channel has one submodel, another channel, that describes a
+ * single molecule. Each trial has \f$K\f$ molecules, and each molecule has
+ * its own set of the submodel's parameters (sampled independently from the
+ * submodel's distributions). The observables are the sums of the
+ * submodel's observables over the \f$K\f$ molecules. \f$K\f$ is itself a
+ * model parameter, so the number of molecules can vary from trial to trial
+ * (e.g., with a Poisson distribution).
+ *
+ * Parameters are generated for \f$K_\mathrm{max}\f$ copies of the submodel
+ * in every trial; only the first \f$K\f$ are used. For a batch of trials,
+ * the used copies are gathered so that the submodel's batch function is
+ * called once for all molecules in the batch, rather than once per
+ * molecule (as with \f$K_\mathrm{max}\f$ channels in a
+ * molstat::transport::TransportJunction).
+ *
+ * Inherited model parameters (from molstat::transport::TransportJunction) are
+ * - `ef` (\f$E_\mathrm{F}\f$), the Fermi energy,
+ * - `v` (\f$V\f$), the applied bias,
+ * - `kt` (\f$k_\mathrm{B}T\f$), the thermal energy.
+ *
+ * These are passed to each copy of the submodel. Model parameters are
+ * - `copies` (\f$K\f$), the number of molecules (rounded to the nearest
+ *   integer),
+ * - `maxcopies` (\f$K_\mathrm{max}\f$), the largest number of molecules. Its
+ *   distribution must be a constant positive integer, and must be specified
+ *   before the submodel is added.
+ *
+ * No observables are produced if \f$K < 1\f$ (no molecules bridge the
+ * junction), if \f$K > K_\mathrm{max}\f$, or if any of the molecules does not
+ * produce the observable. The aggregate channel is compatible with an
+ * observable only if its submodel is.
+ */
+class AggregateChannel : public Channel,
+	public UseSubmodelType<Channel>,
+	public ElectricCurrent,
+	public ZeroBiasConductance,
+	public DifferentialConductance,
+	public StaticConductance
+{
+public:
+	/// Container index for the Fermi energy.
+	static const std::size_t Index_EF;
+
+	/// Container index for the applied bias.
+	static const std::size_t Index_V;
+
+	/// Container index for the thermal energy.
+	static const std::size_t Index_kT;
+
+	/// Container index for the number of molecules.
+	static const std::size_t Index_copies;
+
+	/// Container index for the largest number of molecules.
+	static const std::size_t Index_maxcopies;
+
+private:
+	/**
+	 * \brief Replaces the functions for an observable with sums over the
+	 *    copies of the submodel.
+	 *
+	 * \param[in] obs The observable.
+	 */
+	void aggregateObservable(const ObservableIndex &obs);
+
+protected:
+	virtual std::vector<std::string> get_names() const override;
+
+	/**
+	 * \brief Adds the submodel, making one copy for each possible molecule.
+	 *
+	 * Each copy is passed the parameters inherited from the
+	 * molstat::transport::TransportJunction and its own set of the submodel's
+	 * parameters.
+	 *
+	 * \throw std::invalid_argument if a submodel was already added or if the
+	 *    distribution of `maxcopies` is not a constant positive integer.
+	 *
+	 * \param[in] submodel The submodel.
+	 */
+	virtual void addSubmodel(std::shared_ptr<SimulateModel> submodel)
+		override;
+
+public:
+	/// Constructor registering the aggregated observable functions.
+	AggregateChannel();
+
+	virtual ~AggregateChannel() = default;
+
+	virtual double ECurrent(const std::valarray<double> &params) const override;
+	virtual double ZeroBiasG(const std::valarray<double> &params) const
+		override;
+	virtual double DiffG(const std::valarray<double> &params) const override;
+	virtual double StaticG(const std::valarray<double> &params) const override;
+};
+
+} // namespace molstat::transport
+} // namespace molstat
+
+#endif
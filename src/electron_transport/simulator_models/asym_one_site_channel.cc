@@ -14,26 +14,28 @@
 
 #include "asym_one_site_channel.h"
 #include <cmath>
+#include <complex>
 
 namespace molstat {
 namespace transport {
 
 const std::size_t AsymOneSiteChannel::Index_EF = TransportJunction::Index_EF;
 const std::size_t AsymOneSiteChannel::Index_V = TransportJunction::Index_V;
-const std::size_t AsymOneSiteChannel::Index_epsilon = 2;
-const std::size_t AsymOneSiteChannel::Index_gammaL = 3;
-const std::size_t AsymOneSiteChannel::Index_gammaR = 4;
-const std::size_t AsymOneSiteChannel::Index_a = 5;
+const std::size_t AsymOneSiteChannel::Index_kT = TransportJunction::Index_kT;
+const std::size_t AsymOneSiteChannel::Index_epsilon = 3;
+const std::size_t AsymOneSiteChannel::Index_gammaL = 4;
+const std::size_t AsymOneSiteChannel::Index_gammaR = 5;
+const std::size_t AsymOneSiteChannel::Index_a = 6;
 
 std::vector<std::string> AsymOneSiteChannel::get_names() const
 {
 	std::vector<std::string> ret(4);
 
-	// subtract two because we expect 2 parameters from the TransportJunction
-	ret[Index_epsilon - 2] = "epsilon";
-	ret[Index_gammaL - 2] = "gammal";
-	ret[Index_gammaR - 2] = "gammar";
-	ret[Index_a - 2] = "a";
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_epsilon - 3] = "epsilon";
+	ret[Index_gammaL - 3] = "gammal";
+	ret[Index_gammaR - 3] = "gammar";
+	ret[Index_a - 3] = "a";
 
 	return ret;
 }
@@ -55,6 +57,17 @@ double AsymOneSiteChannel::ECurrent(const std::valarray<double> &params) const
 	const double &gammal = params[Index_gammaL];
 	const double &gammar = params[Index_gammaR];
 	const double &a = params[Index_a];
+	const double &kT = params[Index_kT];
+
+	if(kT > 0.)
+	{
+		// T(E) = -gammal*gammar/g * Im[1 / (E - z)], g = (gammal + gammar)/2
+		const double g{ 0.5 * (gammal + gammar) };
+		const std::complex<double> z{ eps + a*V, -g };
+
+		return -gammal * gammar / g * std::imag(
+			TransportJunction::FermiWindowPole(z, ef + 0.5*V, ef - 0.5*V, kT));
+	}
 
 	return 2.*gammal*gammar / (gammal + gammar) *
 		(atan(2. * (ef-eps+(0.5-a)*V) / (gammal + gammar))
@@ -27,7 +27,8 @@ namespace transport {
  *
  * Inherited model parameters (from molstat::transport::TransportJunction) are
  * - `ef` (\f$E_\mathrm{F}\f$), the Fermi energy,
- * - `v` (\f$V\f$), the applied bias.
+ * - `v` (\f$V\f$), the applied bias,
+ * - `kt` (\f$k_\mathrm{B}T\f$), the thermal energy (for the current).
  *
  * Model parameters are
  * - `epsilon` (\f$\varepsilon\f$), the site-energy,
@@ -41,6 +42,9 @@ namespace transport {
  * \f[ T(E) = \frac{4\Gamma_\mathrm{L} \Gamma_\mathrm{R}}{4(E-\varepsilon-aeV)^2 + (\Gamma_\mathrm{L} + \Gamma_\mathrm{R})^2}. \f]
  * - Electric current:
  *   \f[ I(V) = \frac{2e}{h} \frac{2\Gamma_\mathrm{L} \Gamma_\mathrm{R}}{(\Gamma_\mathrm{L} +\Gamma_\mathrm{R})} \left[ \arctan\left( \frac{2[E_\mathrm{F} - \varepsilon + (1/2-a) eV]}{\Gamma_\mathrm{L} + \Gamma_\mathrm{R}} \right) - \arctan\left( \frac{2[E_\mathrm{F} - \varepsilon - (1/2+a)eV]}{\Gamma_\mathrm{L} + \Gamma_\mathrm{R}} \right) \right]. \f]
+ *
+ *   At finite temperature, the transmission's pole is integrated over the
+ *   Fermi window (molstat::transport::TransportJunction::FermiWindowPole).
  * - Differential conductance:
  *   \f[ G_\mathrm{d}(V) = \frac{2e^2}{h} \left[ (1/2-a) T(E_\mathrm{F} + eV/2) + (1/2+a) T(E_\mathrm{F} - eV/2) \right]. \f]
  * - Static conductance:
@@ -58,6 +62,9 @@ public:
 
 	/// Container index for the applied bias.
 	static const std::size_t Index_V;
+
+	/// Container index for the thermal energy.
+	static const std::size_t Index_kT;
 	
 	/// Container index for the site energy.
 	static const std::size_t Index_epsilon;
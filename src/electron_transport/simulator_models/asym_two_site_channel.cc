@@ -13,40 +13,239 @@
  */
 
 #include "asym_two_site_channel.h"
+#include "transport_device.h"
 #include <cmath>
 #include <complex>
+#include <general/batch_kernels.h>
+#include <electron_transport/channel_kernels.h>
 
 namespace molstat {
 namespace transport {
 
 const std::size_t AsymTwoSiteChannel::Index_EF = TransportJunction::Index_EF;
 const std::size_t AsymTwoSiteChannel::Index_V = TransportJunction::Index_V;
-const std::size_t AsymTwoSiteChannel::Index_epsilon = 2;
-const std::size_t AsymTwoSiteChannel::Index_gammaL = 3;
-const std::size_t AsymTwoSiteChannel::Index_gammaR = 4;
-const std::size_t AsymTwoSiteChannel::Index_beta = 5;
+const std::size_t AsymTwoSiteChannel::Index_kT = TransportJunction::Index_kT;
+const std::size_t AsymTwoSiteChannel::Index_epsilon = 3;
+const std::size_t AsymTwoSiteChannel::Index_gammaL = 4;
+const std::size_t AsymTwoSiteChannel::Index_gammaR = 5;
+const std::size_t AsymTwoSiteChannel::Index_beta = 6;
+
+namespace {
+
+/// \cond
+using Model = AsymTwoSiteChannel;
+
+MOLSTAT_BATCH_KERNEL
+void ZeroBiasGKernel(std::size_t n, const double *ef, const double *eps,
+	const double *gammal, const double *gammar, const double *beta,
+	double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		out[t] = Model::transmission(ef[t], 0., eps[t], gammal[t], gammar[t],
+			beta[t]);
+	}
+}
+
+MOLSTAT_BATCH_KERNEL
+void DiffGKernel(std::size_t n, const double *ef, const double *V,
+	const double *eps, const double *gammal, const double *gammar,
+	const double *beta, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		out[t] = 0.5 * Model::transmission(ef[t] + 0.5*V[t], V[t], eps[t],
+				gammal[t], gammar[t], beta[t])
+			+ 0.5 * Model::transmission(ef[t] - 0.5*V[t], V[t], eps[t],
+				gammal[t], gammar[t], beta[t]);
+	}
+}
+
+// complex arithmetic on separate real and imaginary parts, which (unlike
+// std::complex) the compiler can vectorize across trials
+
+/// Square root (principal branch) of x + iy, stored in re + i im.
+inline void split_sqrt(const double x, const double y, double &re,
+	double &im)
+{
+	const double r{ std::sqrt(x*x + y*y) };
+
+	re = std::sqrt(0.5 * (r + x));
+	im = std::copysign(std::sqrt(0.5 * (r - x)), y);
+}
+
+/**
+ * Calculates atan(c / d) / d for real c and complex d = dre + i dim, stored
+ * in re + i im. This is even in d, so the branch of d is irrelevant.
+ */
+inline void split_atan_quotient(const double c, const double dre,
+	const double dim, double &re, double &im)
+{
+	const double dnorm{ 1. / (dre*dre + dim*dim) };
+
+	// w = c / d
+	const double wre{ c * dre * dnorm }, wim{ -c * dim * dnorm };
+
+	// atan(w) = [atan2(2 Re w, 1 - |w|^2) + i log(|w+i|^2 / |w-i|^2) / 2] / 2
+	const double are{ 0.5 * std::atan2(2.*wre, 1. - wre*wre - wim*wim) };
+	const double aim{ 0.25 * std::log((wre*wre + (wim+1.)*(wim+1.)) /
+		(wre*wre + (wim-1.)*(wim-1.))) };
+
+	// divide by d
+	re = (are*dre + aim*dim) * dnorm;
+	im = (aim*dre - are*dim) * dnorm;
+}
+
+MOLSTAT_BATCH_KERNEL
+void ECurrentKernel(std::size_t n, const double *ef, const double *V,
+	const double *eps, const double *gammal, const double *gammar,
+	const double *beta, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		const double gl{ gammal[t] }, gr{ gammar[t] }, b2{ beta[t]*beta[t] };
+
+		// the terms that depend only on the couplings: bgg and the two
+		// denominators (see current_integral)
+		const double disc{ (gl-gr)*(gl-gr) - 16.*b2 };
+		const double bre{ disc >= 0. ? std::sqrt(disc) : 0. },
+			bim{ disc >= 0. ? 0. : std::sqrt(-disc) };
+		const double diag{ gl*gl + gr*gr - 8.*b2 };
+
+		double d1re, d1im, d2re, d2im;
+		split_sqrt(diag - (gl+gr)*bre, -(gl+gr)*bim, d1re, d1im);
+		split_sqrt(diag + (gl+gr)*bre, (gl+gr)*bim, d2re, d2im);
+
+		// both ends of the bias window
+		const double cp{ std::sqrt(8.) * (ef[t] + 0.5*V[t] - eps[t]) },
+			cm{ std::sqrt(8.) * (ef[t] - 0.5*V[t] - eps[t]) };
+
+		double f1pre, f1pim, f2pre, f2pim, f1mre, f1mim, f2mre, f2mim;
+		split_atan_quotient(cp, d1re, d1im, f1pre, f1pim);
+		split_atan_quotient(cp, d2re, d2im, f2pre, f2pim);
+		split_atan_quotient(cm, d1re, d1im, f1mre, f1mim);
+		split_atan_quotient(cm, d2re, d2im, f2mre, f2mim);
+
+		const double sre{ f1pre - f2pre - f1mre + f2mre },
+			sim{ f1pim - f2pim - f1mim + f2mim };
+
+		// real part of the sum divided by bgg
+		out[t] = std::sqrt(128.) * gl*gr*b2 / (gl + gr) *
+			(sre*bre + sim*bim) / (bre*bre + bim*bim);
+	}
+}
+/// \endcond
+
+} // anonymous namespace
+
+AsymTwoSiteChannel::AsymTwoSiteChannel()
+{
+	using Params = const double *const *;
+
+	setBatchObservableKernel<ZeroBiasConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			ZeroBiasGKernel(n, params[Index_EF], params[Index_epsilon],
+				params[Index_gammaL], params[Index_gammaR], params[Index_beta],
+				out);
+		});
+	setBatchObservableKernel<DifferentialConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			DiffGKernel(n, params[Index_EF], params[Index_V],
+				params[Index_epsilon], params[Index_gammaL],
+				params[Index_gammaR], params[Index_beta], out);
+		});
+	setBatchObservableKernel<ElectricCurrent, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			ECurrentKernel(n, params[Index_EF], params[Index_V],
+				params[Index_epsilon], params[Index_gammaL],
+				params[Index_gammaR], params[Index_beta], out);
+
+			// redo the trials at finite temperature
+			const double *kT = params[Index_kT];
+			for(std::size_t t = 0; t < n; ++t)
+			{
+				if(kT[t] > 0.)
+					out[t] = thermal_current(params[Index_EF][t],
+						params[Index_V][t], kT[t], params[Index_epsilon][t],
+						params[Index_gammaL][t], params[Index_gammaR][t],
+						params[Index_beta][t]);
+			}
+		});
+	setBatchObservableKernel<StaticConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			ECurrentKernel(n, params[Index_EF], params[Index_V],
+				params[Index_epsilon], params[Index_gammaL],
+				params[Index_gammaR], params[Index_beta], out);
+
+			const double *kT = params[Index_kT];
+			const double *V = params[Index_V];
+			for(std::size_t t = 0; t < n; ++t)
+			{
+				if(kT[t] > 0.)
+					out[t] = thermal_current(params[Index_EF][t], V[t], kT[t],
+						params[Index_epsilon][t], params[Index_gammaL][t],
+						params[Index_gammaR][t], params[Index_beta][t]);
+
+				out[t] /= V[t];
+			}
+		});
+
+	setObservableParameters<ZeroBiasConductance>(
+		{ Index_EF, Index_epsilon, Index_gammaL, Index_gammaR, Index_beta });
+	setObservableParameters<DifferentialConductance>(
+		{ Index_EF, Index_V, Index_epsilon, Index_gammaL, Index_gammaR,
+			Index_beta });
+	setObservableParameters<ElectricCurrent>(
+		{ Index_EF, Index_V, Index_kT, Index_epsilon, Index_gammaL,
+			Index_gammaR, Index_beta });
+	setObservableParameters<StaticConductance>(
+		{ Index_EF, Index_V, Index_kT, Index_epsilon, Index_gammaL,
+			Index_gammaR, Index_beta });
+}
 
 std::vector<std::string> AsymTwoSiteChannel::get_names() const
 {
 	std::vector<std::string> ret(4);
 
-	// subtract two because we expect 2 parameters from the TranportJunction
-	ret[Index_epsilon - 2] = "epsilon";
-	ret[Index_gammaL - 2] = "gammal";
-	ret[Index_gammaR - 2] = "gammar";
-	ret[Index_beta - 2] = "beta";
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_epsilon - 3] = "epsilon";
+	ret[Index_gammaL - 3] = "gammal";
+	ret[Index_gammaR - 3] = "gammar";
+	ret[Index_beta - 3] = "beta";
 
 	return ret;
 }
 
+bool AsymTwoSiteChannel::appendDeviceTerms(const ObservableIndex &obs,
+	std::vector<DeviceTerm> &terms) const
+{
+	if(obs == GetObservableIndex<ZeroBiasConductance>())
+		terms.push_back(MakeDeviceTerm(AsymTwoSiteZeroBiasG,
+			{ Index_EF, Index_epsilon, Index_gammaL, Index_gammaR,
+				Index_beta }));
+	else if(obs == GetObservableIndex<DifferentialConductance>())
+		terms.push_back(MakeDeviceTerm(AsymTwoSiteDiffG,
+			{ Index_EF, Index_V, Index_epsilon, Index_gammaL, Index_gammaR,
+				Index_beta }));
+	else
+		return false;
+
+	return true;
+}
+
 double AsymTwoSiteChannel::transmission(const double e, const double V,
 	const double eps, const double gammal, const double gammar,
 	const double beta)
 {
-	double temp = 4.*(e-eps)*(e-eps) - 4.*beta*beta - gammal*gammar;
-
-	return 16.*gammal*gammar*beta*beta /
-		(temp*temp + 4.*(gammal+gammar)*(gammal+gammar)*(e-eps)*(e-eps));
+	return TwoSiteTransmission(e, eps, gammal, gammar, beta);
 }
 
 double AsymTwoSiteChannel::current_integral(const double z,
@@ -68,16 +267,49 @@ double AsymTwoSiteChannel::current_integral(const double z,
 		);
 }
 
+double AsymTwoSiteChannel::thermal_current(const double ef, const double V,
+	const double kT, const double eps, const double gammal, const double gammar,
+	const double beta)
+{
+	if(beta == 0.)
+		return 0.;
+
+	// the poles in the lower half-plane are eps - i(gammal+gammar)/4 +/- s;
+	// they coalesce when s = 0, which is avoided by nudging s
+	std::complex<double> s{ sqrt(std::complex<double>(beta*beta
+		- (gammal-gammar)*(gammal-gammar)/16., 0.)) };
+	const double tiny{ 1.e-6 * (gammal + gammar) };
+	if(abs(s) < tiny)
+		s = tiny;
+
+	const std::complex<double> z1{ eps + s - std::complex<double>(0.,
+			0.25*(gammal + gammar)) },
+		z2{ eps - s - std::complex<double>(0., 0.25*(gammal + gammar)) };
+	const std::complex<double> r1{ 1. / ((z1 - z2) * (z1 - conj(z1))
+		* (z1 - conj(z2))) };
+	const std::complex<double> r2{ 1. / ((z2 - z1) * (z2 - conj(z1))
+		* (z2 - conj(z2))) };
+
+	return 2. * gammal*gammar*beta*beta * real(
+		r1 * TransportJunction::FermiWindowPole(z1, ef + 0.5*V, ef - 0.5*V, kT)
+		+ r2 * TransportJunction::FermiWindowPole(z2, ef + 0.5*V, ef - 0.5*V,
+			kT));
+}
+
 double AsymTwoSiteChannel::ECurrent(const std::valarray<double> &params) const
 {
 	// unpack the parameters
 	const double &ef = params[Index_EF];
 	const double &V = params[Index_V];
+	const double &kT = params[Index_kT];
 	const double &eps = params[Index_epsilon];
 	const double &gammal = params[Index_gammaL];
 	const double &gammar = params[Index_gammaR];
 	const double &beta = params[Index_beta];
 
+	if(kT > 0.)
+		return thermal_current(ef, V, kT, eps, gammal, gammar, beta);
+
 	return current_integral(ef + 0.5*V, eps, gammal, gammar, beta) -
 		current_integral(ef - 0.5*V, eps, gammal, gammar, beta);
 }
@@ -116,5 +348,70 @@ double AsymTwoSiteChannel::DiffG(const std::valarray<double> &params) const
 		0.5*transmission(ef - 0.5*V, V, eps, gammal, gammar, beta);
 }
 
+FusedObservableFunction AsymTwoSiteChannel::getFusedObservableFunction(
+	const std::vector<ObservableIndex> &obs) const
+{
+	// the quantity stored in each output
+	enum class Output { Current, StaticG, ZeroBiasG, DiffG };
+	std::vector<Output> outputs;
+	std::size_t uses_current{ 0 };
+
+	for(const ObservableIndex &o : obs)
+	{
+		// tabulated observables must use their tables
+		if(tabulated_observables.count(o) > 0)
+			return FusedObservableFunction();
+
+		if(o == GetObservableIndex<ElectricCurrent>())
+		{
+			outputs.push_back(Output::Current);
+			++uses_current;
+		}
+		else if(o == GetObservableIndex<StaticConductance>())
+		{
+			outputs.push_back(Output::StaticG);
+			++uses_current;
+		}
+		else if(o == GetObservableIndex<ZeroBiasConductance>())
+			outputs.push_back(Output::ZeroBiasG);
+		else if(o == GetObservableIndex<DifferentialConductance>())
+			outputs.push_back(Output::DiffG);
+		else
+			return FusedObservableFunction();
+	}
+
+	// nothing to share unless the current is used more than once
+	if(uses_current < 2)
+		return FusedObservableFunction();
+
+	std::shared_ptr<const AsymTwoSiteChannel> model
+		= std::dynamic_pointer_cast<const AsymTwoSiteChannel>(shared_from_this());
+
+	return [model, outputs] (const std::valarray<double> &params, double *out)
+		-> void
+	{
+		const double current{ model->AsymTwoSiteChannel::ECurrent(params) };
+
+		for(std::size_t j = 0; j < outputs.size(); ++j)
+		{
+			switch(outputs[j])
+			{
+			case Output::Current:
+				out[j] = current;
+				break;
+			case Output::StaticG:
+				out[j] = current / params[Index_V];
+				break;
+			case Output::ZeroBiasG:
+				out[j] = model->AsymTwoSiteChannel::ZeroBiasG(params);
+				break;
+			case Output::DiffG:
+				out[j] = model->AsymTwoSiteChannel::DiffG(params);
+				break;
+			}
+		}
+	};
+}
+
 } // namespace molstat::transport
 } // namespace molstat
@@ -27,7 +27,8 @@ namespace transport {
  *
  * Inherited model parameters (from molstat::transport::TransportJunction) are
  * - `ef` (\f$E_\mathrm{F}\f$), the Fermi energy,
- * - `v` (\f$V\f$), the applied bias.
+ * - `v` (\f$V\f$), the applied bias,
+ * - `kt` (\f$k_\mathrm{B}T\f$), the thermal energy (for the current).
  *
  * Model parameters are
  * - `epsilon` (\f$\varepsilon\f$), the site-energy,
@@ -42,6 +43,14 @@ namespace transport {
  * \hat{\Sigma}_\mathrm{R} = \left[ \begin{array}{cc} 0 & 0 \\ 0 & -i\Gamma_\mathrm{R}/2 \end{array} \right], \f]
  * the transmission function is
  * \f[ T(E) = \frac{16 \Gamma_\mathrm{L} \Gamma_\mathrm{R} \beta^2}{\left[ 4(E-\varepsilon)^2-4\beta^2-\Gamma_\mathrm{L} \Gamma_\mathrm{R} \right]^2 + 4 (\Gamma_\mathrm{L} + \Gamma_\mathrm{R})^2(E-\varepsilon)^2}. \f]
+ * - Electric current: the difference of the antiderivative (below) at
+ *   \f$E_\mathrm{F} \pm eV/2\f$ at zero temperature. At finite temperature,
+ *   the transmission is split into its two poles (the eigenvalues of
+ *   \f$\hat{H} + \hat{\Sigma}_\mathrm{L} + \hat{\Sigma}_\mathrm{R}\f$), which
+ *   are integrated over the Fermi window. For batches of trials, the terms
+ *   that depend only on the couplings are calculated once for both ends of
+ *   the bias window, with the real and imaginary parts of the complex
+ *   arithmetic kept separate so that the trials vectorize.
  * - Differential conductance:
  *   \f[ G_\mathrm{d}(V) = \frac{2e^2}{h} \frac{1}{2} \left[ T(E_\mathrm{F} + eV/2) + T(E_\mathrm{F} - eV/2) \right]. \f]
  * - Indefinite integral for the static conductance:
@@ -71,6 +80,24 @@ private:
 	static double current_integral(const double z, const double eps,
 		const double gammal, const double gammar, const double beta);
 
+	/**
+	 * \brief Calculates the electric current at finite temperature.
+	 *
+	 * \param[in] ef The Fermi energy.
+	 * \param[in] V The applied bias.
+	 * \param[in] kT The thermal energy.
+	 * \param[in] eps The channel energy, \f$\varepsilon\f$.
+	 * \param[in] gammal The left channel-lead coupling,
+	 *    \f$\Gamma_\mathrm{L}\f$.
+	 * \param[in] gammar The right channel-lead coupling,
+	 *    \f$\Gamma_\mathrm{R}\f$.
+	 * \param[in] beta The site-site coupling, \f$\beta\f$.
+	 * \return The electric current.
+	 */
+	static double thermal_current(const double ef, const double V,
+		const double kT, const double eps, const double gammal,
+		const double gammar, const double beta);
+
 public:
 	/// Container index for the Fermi energy.
 	static const std::size_t Index_EF;
@@ -78,6 +105,9 @@ public:
 	/// Container index for the applied bias.
 	static const std::size_t Index_V;
 
+	/// Container index for the thermal energy.
+	static const std::size_t Index_kT;
+
 	/// Container index for the site energy.
 	static const std::size_t Index_epsilon;
 
@@ -93,7 +123,24 @@ public:
 protected:
 	virtual std::vector<std::string> get_names() const override;
 
+	/**
+	 * \brief Appends the device kernels of the zero-bias and differential
+	 *    conductances (see transport_device.h).
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in,out] terms The terms.
+	 * \return True if the observable has a kernel, false otherwise.
+	 */
+	virtual bool appendDeviceTerms(const ObservableIndex &obs,
+		std::vector<DeviceTerm> &terms) const override;
+
 public:
+	/**
+	 * \brief Constructor registering the batch kernels for the observables
+	 *    and the parameters they read.
+	 */
+	AsymTwoSiteChannel();
+
 	virtual ~AsymTwoSiteChannel() = default;
 
 	/**
@@ -115,6 +162,19 @@ public:
 		override;
 	virtual double StaticG(const std::valarray<double> &params) const override;
 	virtual double DiffG(const std::valarray<double> &params) const override;
+
+	/**
+	 * \brief Gets a function that calculates several observables together.
+	 *
+	 * The electric current is calculated once and shared by the current and
+	 * the static conductance.
+	 *
+	 * \param[in] obs The observables.
+	 * \return The fused function, or an empty function if the observables
+	 *    do not share the current.
+	 */
+	virtual FusedObservableFunction getFusedObservableFunction(
+		const std::vector<ObservableIndex> &obs) const override;
 };
 
 } // namespace molstat::transport
@@ -0,0 +1,217 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file image_charge_channel.cc
+ * \brief One-site channel whose level and couplings are renormalized by the
+ *    electrode separation (image charges and coupling decay).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "image_charge_channel.h"
+#include <cmath>
+#include <complex>
+#include <general/batch_kernels.h>
+#include <general/simulator_tools/trace_protocol.h>
+
+namespace molstat {
+namespace transport {
+
+const std::size_t ImageChargeChannel::Index_EF = TransportJunction::Index_EF;
+const std::size_t ImageChargeChannel::Index_V = TransportJunction::Index_V;
+const std::size_t ImageChargeChannel::Index_kT = TransportJunction::Index_kT;
+const std::size_t ImageChargeChannel::Index_epsilon = 3;
+const std::size_t ImageChargeChannel::Index_gamma = 4;
+const std::size_t ImageChargeChannel::Index_a = 5;
+const std::size_t ImageChargeChannel::Index_nm = 6;
+const std::size_t ImageChargeChannel::Index_d = 7;
+const std::size_t ImageChargeChannel::Index_d0 = 8;
+const std::size_t ImageChargeChannel::Index_zip = 9;
+const std::size_t ImageChargeChannel::Index_decay = 10;
+
+bool ImageChargeChannel::renormalize(const double eps, const double gamma,
+	const double d, const double d0, const double zip, const double decay,
+	double &epsd, double &gammad)
+{
+	const double kehalf{ 0.5 * TraceProtocol::coulomb_constant };
+
+	epsd = eps + kehalf / (0.5*d - zip) - kehalf / (0.5*d0 - zip);
+	gammad = gamma * std::exp(-decay * (d - d0));
+
+	return 0.5*d > zip && 0.5*d0 > zip;
+}
+
+double ImageChargeChannel::transmission(const double e, const double V,
+	const double epsd, const double gammad, const double a)
+{
+	return gammad*gammad /
+		((e - epsd - a*V)*(e - epsd - a*V) + gammad*gammad);
+}
+
+namespace {
+
+/// \cond
+using Model = ImageChargeChannel;
+
+MOLSTAT_BATCH_KERNEL
+void ZeroBiasGKernel(std::size_t n, const double *ef, const double *eps,
+	const double *gamma, const double *a, const double *nm, const double *d,
+	const double *d0, const double *zip, const double *decay, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		double epsd, gammad;
+		const bool valid{ Model::renormalize(eps[t], gamma[t], d[t], d0[t],
+			zip[t], decay[t], epsd, gammad) };
+
+		out[t] = valid ? nm[t] * Model::transmission(ef[t], 0., epsd, gammad,
+			a[t]) : NoObservableValue;
+	}
+}
+
+MOLSTAT_BATCH_KERNEL
+void DiffGKernel(std::size_t n, const double *ef, const double *V,
+	const double *eps, const double *gamma, const double *a, const double *nm,
+	const double *d, const double *d0, const double *zip, const double *decay,
+	double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		double epsd, gammad;
+		const bool valid{ Model::renormalize(eps[t], gamma[t], d[t], d0[t],
+			zip[t], decay[t], epsd, gammad) };
+
+		out[t] = valid ? nm[t] * ((0.5 - a[t]) * Model::transmission(
+				ef[t] + 0.5*V[t], V[t], epsd, gammad, a[t])
+			+ (0.5 + a[t]) * Model::transmission(ef[t] - 0.5*V[t], V[t], epsd,
+				gammad, a[t])) : NoObservableValue;
+	}
+}
+/// \endcond
+
+} // anonymous namespace
+
+ImageChargeChannel::ImageChargeChannel()
+{
+	using Params = const double *const *;
+
+	setBatchObservableKernel<ZeroBiasConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			ZeroBiasGKernel(n, params[Index_EF], params[Index_epsilon],
+				params[Index_gamma], params[Index_a], params[Index_nm],
+				params[Index_d], params[Index_d0], params[Index_zip],
+				params[Index_decay], out);
+		});
+	setBatchObservableKernel<DifferentialConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			DiffGKernel(n, params[Index_EF], params[Index_V],
+				params[Index_epsilon], params[Index_gamma], params[Index_a],
+				params[Index_nm], params[Index_d], params[Index_d0],
+				params[Index_zip], params[Index_decay], out);
+		});
+}
+
+std::vector<std::string> ImageChargeChannel::get_names() const
+{
+	std::vector<std::string> ret(8);
+
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_epsilon - 3] = "epsilon";
+	ret[Index_gamma - 3] = "gamma";
+	ret[Index_a - 3] = "a";
+	ret[Index_nm - 3] = "nm";
+	ret[Index_d - 3] = "separation";
+	ret[Index_d0 - 3] = "d0";
+	ret[Index_zip - 3] = "zip";
+	ret[Index_decay - 3] = "decay";
+
+	return ret;
+}
+
+double ImageChargeChannel::ECurrent(const std::valarray<double> &params) const
+{
+	// unpack the parameters
+	const double &ef = params[Index_EF];
+	const double &V = params[Index_V];
+	const double &kT = params[Index_kT];
+	const double &a = params[Index_a];
+	const double &nm = params[Index_nm];
+
+	double epsd, gammad;
+	if(!renormalize(params[Index_epsilon], params[Index_gamma],
+		params[Index_d], params[Index_d0], params[Index_zip],
+		params[Index_decay], epsd, gammad))
+	{
+		return NoObservableValue;
+	}
+
+	if(kT > 0.)
+	{
+		// T(E) = -gammad * Im[1 / (E - z)]
+		const std::complex<double> z{ epsd + a*V, -gammad };
+
+		return -nm * gammad * std::imag(TransportJunction::FermiWindowPole(z,
+			ef + 0.5*V, ef - 0.5*V, kT));
+	}
+
+	return nm * gammad * (std::atan((ef - epsd + (0.5-a)*V) / gammad)
+		- std::atan((ef - epsd - (0.5+a)*V) / gammad));
+}
+
+double ImageChargeChannel::ZeroBiasG(const std::valarray<double> &params)
+	const
+{
+	// unpack the parameters
+	const double &ef = params[Index_EF];
+	const double &a = params[Index_a];
+	const double &nm = params[Index_nm];
+
+	double epsd, gammad;
+	if(!renormalize(params[Index_epsilon], params[Index_gamma],
+		params[Index_d], params[Index_d0], params[Index_zip],
+		params[Index_decay], epsd, gammad))
+	{
+		return NoObservableValue;
+	}
+
+	return nm * transmission(ef, 0., epsd, gammad, a);
+}
+
+double ImageChargeChannel::DiffG(const std::valarray<double> &params) const
+{
+	// unpack the parameters
+	const double &ef = params[Index_EF];
+	const double &V = params[Index_V];
+	const double &a = params[Index_a];
+	const double &nm = params[Index_nm];
+
+	double epsd, gammad;
+	if(!renormalize(params[Index_epsilon], params[Index_gamma],
+		params[Index_d], params[Index_d0], params[Index_zip],
+		params[Index_decay], epsd, gammad))
+	{
+		return NoObservableValue;
+	}
+
+	return nm * ((0.5 - a) * transmission(ef + 0.5*V, V, epsd, gammad, a)
+		+ (0.5 + a) * transmission(ef - 0.5*V, V, epsd, gammad, a));
+}
+
+double ImageChargeChannel::StaticG(const std::valarray<double> &params) const
+{
+	// unpack the parameters
+	const double &V = params[Index_V];
+
+	return ECurrent(params) / V;
+}
+
+} // namespace molstat::transport
+} // namespace molstat
@@ -0,0 +1,170 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file image_charge_channel.h
+ * \brief One-site channel whose level and couplings are renormalized by the
+ *    electrode separation (image charges and coupling decay).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __image_charge_channel_h__
+#define __image_charge_channel_h__
+
+#include "observables.h"
+#include "junction.h"
+
+namespace molstat {
+namespace transport {
+
+/**
+ * \brief Simulator submodel for transport through a single site between
+ *    planar electrodes, where the site's level and couplings depend on the
+ *    electrode separation.
+ *
+ * The site energy and coupling are specified at a reference separation
+ * \f$d_0\f$ (e.g., where the molecule first bridges the junction). At
+ * separation \f$d\f$, the level is shifted by the image charges in the
+ * electrodes, and the coupling decays exponentially,
+ * \f[ \tilde{\varepsilon}(d) = \varepsilon + U(d) - U(d_0), \;\;\;\; \tilde{\Gamma}(d) = \Gamma e^{-\kappa(d-d_0)}, \f]
+ * where \f$U(d) = k_e / (2|d/2 - z_\mathrm{ip}|)\f$ is the image-charge
+ * energy of a level midway between the electrodes (see
+ * molstat::TraceProtocol::ImageChargeShift). Distances are in nm and energies
+ * in eV.
+ *
+ * The separation is a model parameter, so it can be sampled, swept, or,
+ * in a trace, shifted with the displacement (e.g.,
+ * `shift separation linear d0 1.`); the renormalization then follows the
+ * trace without regenerating the model parameters.
+ *
+ * Inherited model parameters (from molstat::transport::TransportJunction) are
+ * - `ef` (\f$E_\mathrm{F}\f$), the Fermi energy,
+ * - `v` (\f$V\f$), the applied bias,
+ * - `kt` (\f$k_\mathrm{B}T\f$), the thermal energy (for the current).
+ *
+ * Model parameters are
+ * - `epsilon` (\f$\varepsilon\f$), the site-energy at the reference
+ *   separation,
+ * - `gamma` (\f$\Gamma\f$), the site/lead coupling at the reference
+ *   separation,
+ * - `a` (\f$a\f$), the scaling factor for the voltage drop,
+ * - `nm` (\f$n_\mathrm{m}\f$), the number of molecules in the junction,
+ * - `separation` (\f$d\f$), the electrode separation,
+ * - `d0` (\f$d_0\f$), the reference separation,
+ * - `zip` (\f$z_\mathrm{ip}\f$), the distance from each electrode to its
+ *   image plane,
+ * - `decay` (\f$\kappa\f$), the decay constant of the coupling.
+ *
+ * No observables are produced if either separation is not larger than
+ * \f$2z_\mathrm{ip}\f$ (the image planes cross).
+ *
+ * With \f$\tilde{\varepsilon}\f$ and \f$\tilde{\Gamma}\f$, the transmission
+ * function is that of molstat::transport::SymOneSiteChannel,
+ * \f[ T(E) = \frac{\tilde{\Gamma}^2}{(E-\tilde{\varepsilon}-aeV)^2 + \tilde{\Gamma}^2}, \f]
+ * and each molecule contributes equally to the observables.
+ * - Electric current:
+ *   \f[ I(V) = \frac{2e}{h} n_\mathrm{m} \tilde{\Gamma} \left[ \arctan\left( \frac{E_\mathrm{F} - \tilde{\varepsilon} + (1/2-a) eV}{\tilde{\Gamma}} \right) - \arctan\left( \frac{E_\mathrm{F} - \tilde{\varepsilon} - (1/2+a) eV}{\tilde{\Gamma}} \right) \right]. \f]
+ *
+ *   At finite temperature, the transmission's pole is integrated over the
+ *   Fermi window (molstat::transport::TransportJunction::FermiWindowPole).
+ * - Differential conductance:
+ *   \f[ G_\mathrm{d}(V) = \frac{2e^2}{h} n_\mathrm{m} \left[ (1/2-a) T(E_\mathrm{F} + eV/2) + (1/2+a) T(E_\mathrm{F} - eV/2) \right]. \f]
+ * - Static conductance: \f$G_\mathrm{s}(V) = I(V) / V\f$.
+ */
+class ImageChargeChannel : public Channel,
+	public ElectricCurrent,
+	public ZeroBiasConductance,
+	public DifferentialConductance,
+	public StaticConductance
+{
+public:
+	/// Container index for the Fermi energy.
+	static const std::size_t Index_EF;
+
+	/// Container index for the applied bias.
+	static const std::size_t Index_V;
+
+	/// Container index for the thermal energy.
+	static const std::size_t Index_kT;
+
+	/// Container index for the site energy.
+	static const std::size_t Index_epsilon;
+
+	/// Container index for the site-lead coupling.
+	static const std::size_t Index_gamma;
+
+	/// Container index for the bias drop scaling factor.
+	static const std::size_t Index_a;
+
+	/// Container index for the number of molecules.
+	static const std::size_t Index_nm;
+
+	/// Container index for the electrode separation.
+	static const std::size_t Index_d;
+
+	/// Container index for the reference separation.
+	static const std::size_t Index_d0;
+
+	/// Container index for the image-plane distance.
+	static const std::size_t Index_zip;
+
+	/// Container index for the decay constant of the coupling.
+	static const std::size_t Index_decay;
+
+protected:
+	virtual std::vector<std::string> get_names() const override;
+
+public:
+	/// Constructor registering the batch kernels for the observables.
+	ImageChargeChannel();
+
+	virtual ~ImageChargeChannel() = default;
+
+	/**
+	 * \brief Renormalizes the site energy and coupling for an electrode
+	 *    separation.
+	 *
+	 * \param[in] eps The site energy at the reference separation.
+	 * \param[in] gamma The coupling at the reference separation.
+	 * \param[in] d The electrode separation.
+	 * \param[in] d0 The reference separation.
+	 * \param[in] zip The distance from each electrode to its image plane.
+	 * \param[in] decay The decay constant of the coupling.
+	 * \param[out] epsd The site energy at separation `d`.
+	 * \param[out] gammad The coupling at separation `d`.
+	 * \return False if either separation is not larger than `2*zip`; true
+	 *    otherwise.
+	 */
+	static bool renormalize(const double eps, const double gamma,
+		const double d, const double d0, const double zip, const double decay,
+		double &epsd, double &gammad);
+
+	/**
+	 * \brief Calculates the transmission (per molecule) for a set of model
+	 *    parameters.
+	 *
+	 * \param[in] e The energy of the incident electron.
+	 * \param[in] v The applied bias.
+	 * \param[in] epsd The renormalized level energy.
+	 * \param[in] gammad The renormalized level-electrode coupling.
+	 * \param[in] a The voltage drop scaling factor.
+	 * \return The transmission for this set of parameters.
+	 */
+	static double transmission(const double e, const double v,
+		const double epsd, const double gammad, const double a);
+
+	virtual double ECurrent(const std::valarray<double> &params) const override;
+	virtual double ZeroBiasG(const std::valarray<double> &params) const
+		override;
+	virtual double DiffG(const std::valarray<double> &params) const override;
+	virtual double StaticG(const std::valarray<double> &params) const override;
+};
+
+} // namespace molstat::transport
+} // namespace molstat
+
+#endif
@@ -19,23 +19,52 @@
  */
 
 #include "junction.h"
+#include <algorithm>
+#include <cmath>
+#include <general/simulator_tools/simulator_exceptions.h>
 
 namespace molstat {
 namespace transport {
 
 const std::size_t TransportJunction::Index_EF = 0;
 const std::size_t TransportJunction::Index_V = 1;
+const std::size_t TransportJunction::Index_kT = 2;
+const double TransportJunction::qc = 1.;
 
 std::vector<std::string> TransportJunction::get_names() const
 {
-	std::vector<std::string> ret(2);
+	std::vector<std::string> ret(3);
 
 	ret[Index_EF] = "ef";
 	ret[Index_V] = "v";
+	ret[Index_kT] = "kt";
 
 	return ret;
 }
 
+std::map<std::string, double> TransportJunction::get_default_values() const
+{
+	// zero temperature unless specified
+	return { { "kt", 0. } };
+}
+
+bool TransportJunction::appendDeviceTerms(const ObservableIndex &obs,
+	std::vector<DeviceTerm> &terms) const
+{
+	if(composite_operations.count(obs) == 0)
+		return false;
+
+	if(obs == GetObservableIndex<ElectricCurrent>() ||
+		obs == GetObservableIndex<StaticConductance>())
+	{
+		double kT;
+		if(!isConstantParameter(Index_kT, kT) || kT != 0.)
+			return false;
+	}
+
+	return appendSubmodelDeviceTerms(obs, terms);
+}
+
 /// \cond
 TransportJunction::TransportJunction() :
 	CompositeObservable<ElectricCurrent>(
@@ -51,6 +80,101 @@ TransportJunction::TransportJunction() :
 		std::plus<double>()
 	)
 {
+	const ObservableIndex sindex{ GetObservableIndex<ZeroBiasThermopower>() };
+
+	// the thermopower is not a sum over the channels; it is calculated with
+	// the conductances that weight the channels' thermopowers
+	compatible_observables[sindex] =
+		[] (std::shared_ptr<const SimulateModel> model) -> ObservableFunction
+		{
+			const FusedObservableFunction fused{
+				model->getFusedObservableFunction(
+					{ GetObservableIndex<ZeroBiasThermopower>() }) };
+
+			return [fused] (const std::valarray<double> &params) -> double
+			{
+				double ret;
+				fused(params, &ret);
+				return ret;
+			};
+		};
+
+	batch_observables[sindex] =
+		[] (std::shared_ptr<const SimulateModel> model)
+			-> BatchObservableFunction
+		{
+			std::shared_ptr<const TransportJunction> junction =
+				std::dynamic_pointer_cast<const TransportJunction>(model);
+			if(junction == nullptr)
+				throw IncompatibleObservable();
+			if(junction->submodels.empty())
+				throw NoSubmodels();
+
+			// the batch functions for the conductance and thermopower of each
+			// channel, and the parameter indices
+			struct ChannelInfo
+			{
+				BatchObservableFunction g, s;
+			};
+			std::vector<ChannelInfo> subinfo;
+
+			for(const auto &submodel : junction->submodels)
+			{
+				subinfo.push_back({
+					submodel->getBatchObservableFunction(
+						GetObservableIndex<ZeroBiasConductance>()),
+					submodel->getBatchObservableFunction(
+						GetObservableIndex<ZeroBiasThermopower>()) });
+			}
+			const SubmodelRoutes routes{ junction->submodel_routes };
+
+			return [subinfo, routes] (const double *const *params,
+				std::size_t nparams, std::size_t ntrials, double *out) -> void
+			{
+				if(ntrials == 0)
+					return;
+
+				// the total conductance and each channel's observables; out
+				// accumulates the weighted thermopowers
+				SubmodelParameterBuffers::Frame frame{ 3 };
+				std::valarray<double> &gsum = frame.get(0, ntrials);
+				std::valarray<double> &g = frame.get(1, ntrials);
+				std::valarray<double> &s = frame.get(2, ntrials);
+
+				std::vector<const double *> subparams;
+
+				for(std::size_t k = 0; k < subinfo.size(); ++k)
+				{
+					const std::size_t *const route{ routes.route(k) };
+					subparams.resize(routes.routeSize(k));
+					for(std::size_t p = 0; p < subparams.size(); ++p)
+						subparams[p] = params[route[p]];
+
+					subinfo[k].g(subparams.data(), subparams.size(), ntrials,
+						&g[0]);
+					subinfo[k].s(subparams.data(), subparams.size(), ntrials,
+						&s[0]);
+
+					// NaNs (no observable) propagate through the sums
+					for(std::size_t t = 0; t < ntrials; ++t)
+					{
+						if(k == 0)
+						{
+							gsum[t] = g[t];
+							out[t] = g[t] * s[t];
+						}
+						else
+						{
+							gsum[t] += g[t];
+							out[t] += g[t] * s[t];
+						}
+					}
+				}
+
+				for(std::size_t t = 0; t < ntrials; ++t)
+					out[t] = gsum[t] != 0. ? out[t] / gsum[t] : NoObservableValue;
+			};
+		};
 }
 /// \endcond
 
@@ -59,5 +183,170 @@ double TransportJunction::AppBias(const std::valarray<double> &params) const
 	return params[Index_V];
 }
 
+double TransportJunction::ZeroBiasS(const std::valarray<double> &params) const
+{
+	return getObservableFunction(GetObservableIndex<ZeroBiasThermopower>())
+		(params);
+}
+
+FusedObservableFunction TransportJunction::getFusedObservableFunction(
+	const std::vector<ObservableIndex> &obs) const
+{
+	const ObservableIndex gindex{ GetObservableIndex<ZeroBiasConductance>() };
+	const ObservableIndex sindex{ GetObservableIndex<ZeroBiasThermopower>() };
+
+	if(std::find(obs.begin(), obs.end(), sindex) == obs.end() ||
+		tabulated_observables.count(sindex) > 0)
+	{
+		return CompositeSimulateModel::getFusedObservableFunction(obs);
+	}
+
+	if(submodels.empty())
+		throw NoSubmodels();
+
+	// sort the observables into composite observables, thermopowers, and
+	// observables calculated directly by the junction
+	std::vector<std::size_t> slots, sslots;
+	std::vector<ObservableIndex> subobs;
+	std::vector<std::function<double(double, double)>> opers;
+	std::vector<std::pair<std::size_t, ObservableFunction>> direct;
+
+	for(std::size_t j = 0; j < obs.size(); ++j)
+	{
+		const auto oper = composite_operations.find(obs[j]);
+
+		if(obs[j] == sindex)
+			sslots.push_back(j);
+		else if(oper == composite_operations.end())
+			direct.emplace_back(j, getObservableFunction(obs[j]));
+		else
+		{
+			slots.push_back(j);
+			subobs.push_back(obs[j]);
+			opers.push_back(oper->second);
+		}
+	}
+
+	// each channel also calculates its conductance and thermopower
+	const std::size_t gsub{ subobs.size() }, ssub{ subobs.size() + 1 };
+	subobs.push_back(gindex);
+	subobs.push_back(sindex);
+
+	std::vector<FusedObservableFunction> subfuncs;
+	for(const auto &submodel : submodels)
+	{
+		bool fused;
+		subfuncs.emplace_back(getSubmodelFusedFunction(*submodel, subobs,
+			fused));
+	}
+	const SubmodelRoutes routes{ submodel_routes };
+
+	return [slots, sslots, opers, direct, subfuncs, routes, gsub, ssub]
+		(const std::valarray<double> &params, double *out) -> void
+	{
+		// one buffer for the parameters of each channel, one for the
+		// channel's observables, and one for the combined observables
+		SubmodelParameterBuffers::Frame frame{ subfuncs.size() + 2 };
+		std::valarray<double> &subout =
+			frame.get(subfuncs.size(), slots.size() + 2);
+		std::valarray<double> &total =
+			frame.get(subfuncs.size() + 1, slots.size() + 2);
+
+		for(std::size_t k = 0; k < subfuncs.size(); ++k)
+		{
+			const std::size_t *const route{ routes.route(k) };
+			std::valarray<double> &subparams =
+				frame.get(k, routes.routeSize(k));
+			for(std::size_t p = 0; p < subparams.size(); ++p)
+				subparams[p] = params[route[p]];
+
+			subfuncs[k](subparams, &subout[0]);
+
+			// the composite observables are not produced if any channel
+			// doesn't produce them
+			for(std::size_t c = 0; c < slots.size(); ++c)
+			{
+				if(k == 0)
+					total[c] = subout[c];
+				else if(std::isnan(total[c]) || std::isnan(subout[c]))
+					total[c] = NoObservableValue;
+				else
+					total[c] = opers[c](total[c], subout[c]);
+			}
+
+			// the total conductance and the weighted thermopowers
+			if(k == 0)
+			{
+				total[gsub] = subout[gsub];
+				total[ssub] = subout[gsub] * subout[ssub];
+			}
+			else
+			{
+				total[gsub] += subout[gsub];
+				total[ssub] += subout[gsub] * subout[ssub];
+			}
+		}
+
+		for(std::size_t c = 0; c < slots.size(); ++c)
+			out[slots[c]] = total[c];
+
+		const double s{ total[gsub] != 0. ? total[ssub] / total[gsub] :
+			NoObservableValue };
+		for(const std::size_t j : sslots)
+			out[j] = s;
+
+		// the observables calculated directly by the junction
+		for(const auto &func : direct)
+		{
+			try
+			{
+				out[func.first] = func.second(params);
+			}
+			catch(const NoObservableProduced &e)
+			{
+				out[func.first] = NoObservableValue;
+			}
+		}
+	};
+}
+
+namespace {
+
+/**
+ * \brief The digamma function for complex arguments with positive real part.
+ *
+ * The argument is shifted until it is large, and then the asymptotic series
+ * is used (the error is below 1e-13).
+ *
+ * \param[in] w The argument.
+ * \return The digamma function at w.
+ */
+std::complex<double> digamma(std::complex<double> w)
+{
+	std::complex<double> shift{ 0. };
+	while(std::abs(w) < 10.)
+	{
+		shift -= 1. / w;
+		w += 1.;
+	}
+
+	const std::complex<double> winv2{ 1. / (w * w) };
+	return shift + std::log(w) - 0.5 / w - winv2 * (1./12. - winv2 *
+		(1./120. - winv2 * (1./252. - winv2 * (1./240. - winv2 / 132.))));
+}
+
+} // anonymous namespace
+
+std::complex<double> TransportJunction::FermiWindowPole(
+	const std::complex<double> z, const double muL, const double muR,
+	const double kT)
+{
+	if(!(kT > 0.))
+		return std::log(muL - z) - std::log(muR - z);
+
+	const std::complex<double> scale{ 0., 0.5 / (std::acos(-1.) * kT) };
+	return digamma(0.5 + scale * (z - muL)) - digamma(0.5 + scale * (z - muR));
+}
+
 } // namespace molstat::transport
 } // namespace molstat
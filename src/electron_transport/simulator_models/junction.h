@@ -21,6 +21,8 @@
 #ifndef __transport_junction_h__
 #define __transport_junction_h__
 
+#include <complex>
+#include <map>
 #include "observables.h"
 
 namespace molstat {
@@ -32,14 +34,36 @@ class Channel
 {
 };
 
-/// Composite model representing a junction.
+/**
+ * \brief Composite model representing a junction.
+ *
+ * Model parameters are
+ * - `ef` (\f$E_\mathrm{F}\f$), the Fermi energy,
+ * - `v` (\f$V\f$), the applied bias,
+ * - `kt` (\f$k_\mathrm{B}T\f$), the thermal energy of the electrodes. This
+ *   parameter is optional; the default is 0 (zero temperature).
+ *
+ * The electrodes' chemical potentials are
+ * \f$\mu_\mathrm{L/R} = E_\mathrm{F} \pm eV/2\f$. At finite temperature,
+ * the current through a channel is
+ * \f[ I(V) = \frac{2e}{h} \int \mathrm{d}E T(E) \left[ f\left( \frac{E - \mu_\mathrm{L}}{k_\mathrm{B}T} \right) - f\left( \frac{E - \mu_\mathrm{R}}{k_\mathrm{B}T} \right) \right], \f]
+ * where \f$f(x) = 1 / (1 + e^x)\f$ is the Fermi function. The conductances
+ * are calculated at zero temperature.
+ *
+ * The channels are in parallel, so the transmissions add. The thermopower
+ * is thus the average of the channels' thermopowers, weighted by their
+ * zero-bias conductances,
+ * \f[ S = \frac{\sum_i G_i S_i}{\sum_i G_i}. \f]
+ * No thermopower is produced if the total conductance vanishes.
+ */
 class TransportJunction :
 	public UseSubmodelType<Channel>,
 	public AppliedBias,
 	public CompositeObservable<ElectricCurrent>,
 	public CompositeObservable<StaticConductance>,
 	public CompositeObservable<ZeroBiasConductance>,
-	public CompositeObservable<DifferentialConductance>
+	public CompositeObservable<DifferentialConductance>,
+	public ZeroBiasThermopower
 {
 public:
 	/// Container index for the Fermi energy.
@@ -48,9 +72,38 @@ public:
 	/// Container index for the applied bias.
 	static const std::size_t Index_V;
 
+	/// Container index for the thermal energy.
+	static const std::size_t Index_kT;
+
+	/**
+	 * \brief The prefactor of the current, \f$2e/h\f$.
+	 *
+	 * Currents are reported in units where \f$2e/h = 1\f$, so that
+	 * conductances are in units of \f$2e^2/h\f$.
+	 */
+	static const double qc;
+
 protected:
 	virtual std::vector<std::string> get_names() const override;
 
+	virtual std::map<std::string, double> get_default_values() const override;
+
+	/**
+	 * \brief Appends the channels' device kernels of a composite observable
+	 *    (see transport_device.h).
+	 *
+	 * The composite observables are sums over the channels. The kernels of
+	 * the current and static conductance are at zero temperature, so they
+	 * are only used if \f$k_\mathrm{B}T\f$ is the constant 0.
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in,out] terms The terms.
+	 * \return True if every channel has a kernel for the observable, false
+	 *    otherwise.
+	 */
+	virtual bool appendDeviceTerms(const ObservableIndex &obs,
+		std::vector<DeviceTerm> &terms) const override;
+
 public:
 	/**
 	 * \brief Constructor that tells the MolStat framework to add conductances
@@ -59,6 +112,47 @@ public:
 	TransportJunction();
 
 	virtual double AppBias(const std::valarray<double> &params) const override;
+
+	virtual double ZeroBiasS(const std::valarray<double> &params) const
+		override;
+
+	/**
+	 * \brief Gets a function that calculates several observables together.
+	 *
+	 * If the thermopower is requested, each channel calculates its
+	 * conductance and thermopower together with the other composite
+	 * observables (see CompositeSimulateModel::getFusedObservableFunction);
+	 * otherwise, this is the composite model's function.
+	 *
+	 * \param[in] obs The observables.
+	 * \return A function that calculates all of the observables, or an
+	 *    empty function if nothing is shared.
+	 */
+	virtual FusedObservableFunction getFusedObservableFunction(
+		const std::vector<ObservableIndex> &obs) const override;
+
+	/**
+	 * \brief Integrates a simple pole of the transmission over the Fermi
+	 *    window.
+	 *
+	 * Calculates
+	 * \f[ \int \mathrm{d}E \frac{f((E-\mu_\mathrm{L})/k_\mathrm{B}T) - f((E-\mu_\mathrm{R})/k_\mathrm{B}T)}{E - z} = \psi\left( \frac{1}{2} + \frac{i(z-\mu_\mathrm{L})}{2\pi k_\mathrm{B}T} \right) - \psi\left( \frac{1}{2} + \frac{i(z-\mu_\mathrm{R})}{2\pi k_\mathrm{B}T} \right), \f]
+	 * where \f$\psi\f$ is the digamma function; this resums the Matsubara
+	 * poles of the Fermi functions. At zero temperature, it reduces to
+	 * \f$\ln(\mu_\mathrm{L} - z) - \ln(\mu_\mathrm{R} - z)\f$. A channel
+	 * whose transmission is a sum of simple poles thus has a finite-temperature
+	 * current with a few digamma evaluations, instead of a numerical
+	 * integral.
+	 *
+	 * \param[in] z The pole, which must be in the lower half of the complex
+	 *    plane.
+	 * \param[in] muL The chemical potential of the left electrode.
+	 * \param[in] muR The chemical potential of the right electrode.
+	 * \param[in] kT The thermal energy.
+	 * \return The integral.
+	 */
+	static std::complex<double> FermiWindowPole(const std::complex<double> z,
+		const double muL, const double muR, const double kT);
 };
 
 } // namespace molstat::transport
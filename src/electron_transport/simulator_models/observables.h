@@ -96,6 +96,32 @@ public:
 	virtual double ZeroBiasG(const std::valarray<double> &params) const = 0;
 };
 
+/**
+ * \brief Observable class for the zero-bias thermopower (Seebeck
+ *    coefficient).
+ *
+ * In the low-temperature (Mott) limit, the thermopower is proportional to
+ * the logarithmic derivative of the transmission at the Fermi energy,
+ * \f$S \propto -T'(E_\mathrm{F}) / T(E_\mathrm{F})\f$.
+ */
+class ZeroBiasThermopower : public Observable<ZeroBiasThermopower>
+{
+public:
+	ZeroBiasThermopower()
+		: Observable<ZeroBiasThermopower>(&ZeroBiasThermopower::ZeroBiasS)
+	{}
+
+	virtual ~ZeroBiasThermopower() = default;
+
+	/**
+	 * \brief Returns the zero-bias thermopower for a set of model parameters.
+	 *
+	 * \param[in] params A set of model parameters.
+	 * \return The zero-bias thermopower for the model parameters.
+	 */
+	virtual double ZeroBiasS(const std::valarray<double> &params) const = 0;
+};
+
 /**
  * \brief Observable class for the differential conductance.
  *
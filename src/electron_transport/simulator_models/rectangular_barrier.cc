@@ -11,8 +11,13 @@
  * \date January 2015
  */
 
+#include <config.h>
 #include "rectangular_barrier.h"
 #include <cmath>
+#include <stdexcept>
+#include <general/gauss_kronrod.h>
+#include <general/gauss_legendre.h>
+#include <general/batch_kernels.h>
 
 #if HAVE_GSL
 #include <memory>
@@ -24,16 +29,72 @@ namespace transport {
 
 const std::size_t RectangularBarrier::Index_EF = TransportJunction::Index_EF;
 const std::size_t RectangularBarrier::Index_V = TransportJunction::Index_V;
-const std::size_t RectangularBarrier::Index_h = 2;
-const std::size_t RectangularBarrier::Index_w = 3;
+const std::size_t RectangularBarrier::Index_h = 3;
+const std::size_t RectangularBarrier::Index_w = 4;
+
+std::size_t RectangularBarrier::quadrature_order = 0;
+double RectangularBarrier::quadrature_epsabs = 1.e-9;
+double RectangularBarrier::quadrature_epsrel = 1.e-9;
+
+void RectangularBarrier::setStaticGQuadrature(std::size_t order, double epsabs,
+	double epsrel)
+{
+	if(!(epsabs >= 0.) || !(epsrel >= 0.) || epsabs + epsrel == 0.)
+		throw std::invalid_argument("The quadrature tolerances must be " \
+			"non-negative and not both zero.");
+
+	quadrature_order = order;
+	quadrature_epsabs = epsabs;
+	quadrature_epsrel = epsrel;
+}
+
+namespace {
+
+/// \cond
+using Model = RectangularBarrier;
+
+MOLSTAT_BATCH_KERNEL
+void ZeroBiasGKernel(std::size_t n, const double *ef, const double *h,
+	const double *w, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+		out[t] = Model::transmission(ef[t], h[t], w[t]);
+}
+
+MOLSTAT_BATCH_KERNEL
+void ZeroBiasSKernel(std::size_t n, const double *ef, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+		out[t] = -1. / ef[t];
+}
+/// \endcond
+
+} // anonymous namespace
+
+RectangularBarrier::RectangularBarrier()
+{
+	setBatchObservableKernel<ZeroBiasConductance, Model>(
+		[] (const Model &model, const double *const *params, std::size_t n,
+			double *out) -> void
+		{
+			ZeroBiasGKernel(n, params[Index_EF], params[Index_h],
+				params[Index_w], out);
+		});
+	setBatchObservableKernel<ZeroBiasThermopower, Model>(
+		[] (const Model &model, const double *const *params, std::size_t n,
+			double *out) -> void
+		{
+			ZeroBiasSKernel(n, params[Index_EF], out);
+		});
+}
 
 std::vector<std::string> RectangularBarrier::get_names() const
 {
 	std::vector<std::string> ret(2);
 
-	// subtract two because we expect 2 parameters from the TransportJunction
-	ret[Index_h - 2] = "height";
-	ret[Index_w - 2] = "width";
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_h - 3] = "height";
+	ret[Index_w - 3] = "width";
 
 	return ret;
 }
@@ -66,7 +127,7 @@ double RectangularBarrier::ZeroBiasS(const std::valarray<double> &params) const
 	return -1. / ef;
 }
 
-double RectangularBarrier::DispW(const std::valarray<double> &params) const
+double RectangularBarrier::DistD(const std::valarray<double> &params) const
 {
 	// unpack the width
 	const double &w = params[Index_w];
@@ -83,20 +144,39 @@ double RectangularBarrier::gsl_StaticG_integrand(double E, void *p)
 
 	return RectangularBarrier::transmission(E, h, w);
 }
+#endif
 
 double RectangularBarrier::StaticG(const std::valarray<double> &params) const
 {
 	// unpack the parameters
-	const double &ef = params[Index_EF];
 	const double &V = params[Index_V];
 	const double &h = params[Index_h];
 	const double &w = params[Index_w];
-	double result, intmin, intmax;
+	double result;
+
+	// fixed-order quadrature; each thread keeps its rule
+	if(quadrature_order > 0)
+	{
+		static thread_local GaussLegendre rule{ quadrature_order };
+		if(rule.numPoints() != quadrature_order)
+			rule = GaussLegendre(quadrature_order);
+
+		result = rule.integrate(
+			[h, w] (double E) -> double
+			{
+				return transmission(E, h, w);
+			}, 0., V);
+
+		return result / V;
+	}
+
+#if HAVE_GSL
+	double intmin, intmax;
 	double abserr;
 	size_t neval;
 
-	// set up the GSL workspace
-	std::unique_ptr<gsl_integration_cquad_workspace,
+	// adaptive quadrature; each thread keeps its GSL workspace
+	static thread_local std::unique_ptr<gsl_integration_cquad_workspace,
 			decltype(&gsl_integration_cquad_workspace_free)>
 		ws { gsl_integration_cquad_workspace_alloc(1000),
 		     &gsl_integration_cquad_workspace_free };
@@ -109,12 +189,22 @@ double RectangularBarrier::StaticG(const std::valarray<double> &params) const
   // perform the integration
 	intmin = 0;
 	intmax = V;
-  gsl_integration_cquad(&F, intmin, intmax, 1e-9, 1e-9,
-                        ws.get(), &result, &abserr, &neval); 
+  gsl_integration_cquad(&F, intmin, intmax, quadrature_epsabs,
+                        quadrature_epsrel, ws.get(), &result, &abserr,
+                        &neval); 
+#else
+	// adaptive quadrature; each thread keeps its workspace
+	static thread_local AdaptiveGaussKronrod<1> quad{ 1000 };
+
+	result = quad.integrate(
+		[h, w] (double E, AdaptiveGaussKronrod<1>::Values &f) -> void
+		{
+			f[0] = transmission(E, h, w);
+		}, 0., V, quadrature_epsabs, quadrature_epsrel)[0];
+#endif
 
 	return result / V;
 }
-#endif
 
 } // namespace molstat::transport
 } // namespace molstat
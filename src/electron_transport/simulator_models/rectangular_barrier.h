@@ -16,7 +16,6 @@
 
 #include "observables.h"
 #include "junction.h"
-#include <gsl/gsl_integration.h>
 
 namespace molstat {
 namespace transport {
@@ -54,6 +53,7 @@ namespace transport {
 class RectangularBarrier : public Channel,
 	public ZeroBiasConductance,
 	public StaticConductance,
+	public ZeroBiasThermopower,
 	public Distance
 {
 public:
@@ -69,10 +69,46 @@ public:
 	/// Container index for the width (distance) of the barrier.
 	static const std::size_t Index_w;
 
+private:
+	/// The parameters of the integrand for the static conductance.
+	struct StaticG_data
+	{
+		/// The height of the barrier.
+		double h;
+
+		/// The width of the barrier.
+		double w;
+	};
+
+	/**
+	 * \brief The integrand for the static conductance (the transmission), in
+	 *    the form used by the GSL.
+	 *
+	 * \param[in] E The energy.
+	 * \param[in] p The parameters of the barrier (a StaticG_data).
+	 * \return The transmission at the energy.
+	 */
+	static double gsl_StaticG_integrand(double E, void *p);
+
+	/**
+	 * \brief The number of Gauss-Legendre points for the static conductance;
+	 *    0 for adaptive quadrature.
+	 */
+	static std::size_t quadrature_order;
+
+	/// The absolute tolerance for adaptive quadrature.
+	static double quadrature_epsabs;
+
+	/// The relative tolerance for adaptive quadrature.
+	static double quadrature_epsrel;
+
 protected:
 	virtual std::vector<std::string> get_names() const override;
 
 public:
+	/// Constructor registering the batch kernels for the observables.
+	RectangularBarrier();
+
 	virtual ~RectangularBarrier() = default;
 
 	/**
@@ -87,10 +123,53 @@ public:
 	
 	virtual double ZeroBiasG(const std::valarray<double> &params) const override;
 
+	/**
+	 * \brief Calculates the static conductance, which integrates the
+	 *    transmission over the bias window.
+	 *
+	 * The quadrature is set by setStaticGQuadrature().
+	 *
+	 * \param[in] params The model parameters.
+	 * \return The static conductance.
+	 */
 	virtual double StaticG(const std::valarray<double> &params) const override;
 
-	virtual double DistD(const std::valarray<double> &params) const override;
+	/**
+	 * \brief Sets the quadrature used for the static conductance.
+	 *
+	 * By default, adaptive quadrature (GSL's cquad, or Gauss-Kronrod without
+	 * the GSL) is used with tolerance 1e-9. When this accuracy is much finer
+	 * than the histogram's bins, a fixed-order Gauss-Legendre rule is
+	 * considerably faster. This should be called before simulating.
+	 *
+	 * The tolerances can instead be chosen from the precision needed by the
+	 * histogram (see the simulator's `precision` command); a relative
+	 * tolerance alone is then enough, and often much looser.
+	 *
+	 * \throw std::invalid_argument if a tolerance is negative or both are
+	 *    zero.
+	 *
+	 * \param[in] order The number of Gauss-Legendre points; 0 for adaptive
+	 *    quadrature.
+	 * \param[in] epsabs The absolute tolerance for adaptive quadrature.
+	 * \param[in] epsrel The relative tolerance for adaptive quadrature.
+	 */
+	static void setStaticGQuadrature(std::size_t order, double epsabs,
+		double epsrel);
 
+	/**
+	 * \brief Calculates the zero-bias thermopower.
+	 *
+	 * The thermopower is approximated as \f$S = -1/E_\mathrm{F}\f$ (in the
+	 * units of molstat::transport::SymOneSiteChannel::ZeroBiasS).
+	 *
+	 * \param[in] params The model parameters.
+	 * \return The zero-bias thermopower.
+	 */
+	virtual double ZeroBiasS(const std::valarray<double> &params) const
+		override;
+
+	virtual double DistD(const std::valarray<double> &params) const override;
 };
 
 } // namespace molstat::transport
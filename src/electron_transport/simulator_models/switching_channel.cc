@@ -0,0 +1,410 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file switching_channel.cc
+ * \brief One-site channel whose molecule switches between two binding
+ *    conformations (and ruptures) while the junction is stretched.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <config.h>
+#include "switching_channel.h"
+
+#if HAVE_CVODE
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <cvode/cvode.h>
+#include <cvode/cvode_band.h>
+#include <nvector/nvector_serial.h>
+
+namespace molstat {
+namespace transport {
+
+const std::size_t SwitchingChannel::Index_EF = TransportJunction::Index_EF;
+const std::size_t SwitchingChannel::Index_V = TransportJunction::Index_V;
+const std::size_t SwitchingChannel::Index_epsilon = 3;
+const std::size_t SwitchingChannel::Index_gammaA = 4;
+const std::size_t SwitchingChannel::Index_gammaB = 5;
+const std::size_t SwitchingChannel::Index_kAB = 6;
+const std::size_t SwitchingChannel::Index_kBA = 7;
+const std::size_t SwitchingChannel::Index_kR = 8;
+const std::size_t SwitchingChannel::Index_loading = 9;
+const std::size_t SwitchingChannel::Index_time = 10;
+
+namespace {
+
+/**
+ * \brief CVODE solver for the rate equations of up to a fixed number of
+ *    trials.
+ *
+ * The populations of trial `t` are components `2t` (A) and `2t+1` (B), so
+ * the Jacobian is block diagonal with 2x2 blocks, which the banded solver
+ * handles in linear time. Time is scaled by each trial's duration, so that
+ * every trial is integrated from 0 to 1. Fewer trials are padded with
+ * trials whose rates are zero, whose populations do not change.
+ */
+class PopulationSolver
+{
+private:
+	/// The largest number of trials.
+	const std::size_t ntrials;
+
+	/// The CVODE memory.
+	void *mem;
+
+	/// The populations.
+	N_Vector y;
+
+	/// The rates and scaled times for each trial.
+	std::vector<double> kab, kba, kr, loading, time;
+
+	/**
+	 * \brief The right-hand side of the rate equations, for CVODE.
+	 *
+	 * \param[in] s The scaled time.
+	 * \param[in] y The populations.
+	 * \param[out] ydot The derivatives of the populations.
+	 * \param[in] data The PopulationSolver.
+	 * \return 0 (success).
+	 */
+	static int rhs(realtype s, N_Vector y, N_Vector ydot, void *data)
+	{
+		const PopulationSolver &solver{
+			*static_cast<const PopulationSolver *>(data) };
+		const double *p = NV_DATA_S(y);
+		double *dp = NV_DATA_S(ydot);
+
+		for(std::size_t t = 0; t < solver.ntrials; ++t)
+		{
+			const double tau{ solver.time[t] };
+			const double force{ std::exp(solver.loading[t] * s * tau) };
+			const double ab{ tau * solver.kab[t] * force },
+				ba{ tau * solver.kba[t] / force },
+				r{ tau * solver.kr[t] * force };
+
+			dp[2*t] = -ab * p[2*t] + ba * p[2*t+1];
+			dp[2*t+1] = ab * p[2*t] - (ba + r) * p[2*t+1];
+		}
+
+		return 0;
+	}
+
+public:
+	PopulationSolver() = delete;
+
+	/**
+	 * \brief Constructor, setting up CVODE.
+	 *
+	 * The weighted root-mean-square error over the batch is controlled, so
+	 * the tolerances are scaled by the square root of the number of
+	 * components; each population then has (at most) the requested error.
+	 *
+	 * \throw std::runtime_error if CVODE cannot be set up.
+	 *
+	 * \param[in] n The largest number of trials.
+	 */
+	PopulationSolver(const std::size_t n) :
+		ntrials(n), mem(CVodeCreate(CV_BDF, CV_NEWTON)),
+		y(N_VNew_Serial(2*n)), kab(n), kba(n), kr(n), loading(n), time(n)
+	{
+		if(mem == nullptr || y == nullptr)
+		{
+			CVodeFree(&mem);
+			if(y != nullptr)
+				N_VDestroy_Serial(y);
+			throw std::runtime_error("Unable to allocate CVODE memory.");
+		}
+
+		N_VConst(0., y);
+		const double scale{ 1. / std::sqrt(2.*n) };
+		if(CVodeInit(mem, &rhs, 0., y) != CV_SUCCESS
+			|| CVodeSStolerances(mem, 1.e-8 * scale, 1.e-10 * scale)
+				!= CV_SUCCESS
+			|| CVodeSetUserData(mem, this) != CV_SUCCESS
+			|| CVodeSetMaxNumSteps(mem, 100000) != CV_SUCCESS
+			|| CVBand(mem, 2*n, 1, 1) != CVDLS_SUCCESS)
+		{
+			CVodeFree(&mem);
+			N_VDestroy_Serial(y);
+			throw std::runtime_error("Unable to set up CVODE.");
+		}
+	}
+
+	PopulationSolver(const PopulationSolver &) = delete;
+	PopulationSolver &operator=(const PopulationSolver &) = delete;
+
+	~PopulationSolver()
+	{
+		CVodeFree(&mem);
+		N_VDestroy_Serial(y);
+	}
+
+	/**
+	 * \brief Gets the largest number of trials.
+	 *
+	 * \return The largest number of trials.
+	 */
+	std::size_t size() const noexcept
+	{
+		return ntrials;
+	}
+
+	/**
+	 * \brief Integrates the rate equations for the trials.
+	 *
+	 * \param[in] n The number of trials, at most size().
+	 * \param[in] kab0 The rates from A to B.
+	 * \param[in] kba0 The rates from B to A.
+	 * \param[in] kr0 The rupture rates.
+	 * \param[in] loading0 The growth rates of the force.
+	 * \param[in] time0 The durations of the stretch.
+	 * \param[out] pa The populations of conformation A.
+	 * \param[out] pb The populations of conformation B.
+	 * \return True if the integration succeeded, false otherwise.
+	 */
+	bool solve(const std::size_t n, const double *kab0, const double *kba0,
+		const double *kr0, const double *loading0, const double *time0,
+		double *pa, double *pb)
+	{
+		double *p = NV_DATA_S(y);
+		for(std::size_t t = 0; t < ntrials; ++t)
+		{
+			const bool active{ t < n };
+			kab[t] = active ? kab0[t] : 0.;
+			kba[t] = active ? kba0[t] : 0.;
+			kr[t] = active ? kr0[t] : 0.;
+			loading[t] = active ? loading0[t] : 0.;
+			time[t] = active ? time0[t] : 0.;
+
+			p[2*t] = 1.;
+			p[2*t+1] = 0.;
+		}
+
+		realtype s;
+		if(CVodeReInit(mem, 0., y) != CV_SUCCESS
+			|| CVode(mem, 1., y, &s, CV_NORMAL) < 0)
+		{
+			return false;
+		}
+
+		p = NV_DATA_S(y);
+		for(std::size_t t = 0; t < n; ++t)
+		{
+			pa[t] = p[2*t];
+			pb[t] = p[2*t+1];
+		}
+
+		return true;
+	}
+};
+
+/**
+ * \brief Gets this thread's solver for a number of trials.
+ *
+ * Each thread keeps one solver for single trials and one for batches, which
+ * is replaced only by a larger batch. The latter thus has the size of the
+ * largest batch, and smaller batches are padded.
+ *
+ * \param[in] n The number of trials.
+ * \return The solver.
+ */
+PopulationSolver &GetPopulationSolver(const std::size_t n)
+{
+	static thread_local std::unique_ptr<PopulationSolver> batch, single;
+
+	std::unique_ptr<PopulationSolver> &solver = (n == 1 ? single : batch);
+	if(!solver || solver->size() < n)
+		solver.reset(new PopulationSolver(n));
+
+	return *solver;
+}
+
+/// \cond
+using Model = SwitchingChannel;
+/// \endcond
+
+} // anonymous namespace
+
+SwitchingChannel::SwitchingChannel()
+{
+	using Params = const double *const *;
+
+	setBatchObservableKernel<ZeroBiasConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			std::vector<double> pa(n), pb(n);
+			populations(n, params[Index_kAB], params[Index_kBA],
+				params[Index_kR], params[Index_loading], params[Index_time],
+				pa.data(), pb.data());
+
+			const double *ef = params[Index_EF];
+			const double *eps = params[Index_epsilon];
+			const double *gammaa = params[Index_gammaA];
+			const double *gammab = params[Index_gammaB];
+			for(std::size_t t = 0; t < n; ++t)
+			{
+				out[t] = pa[t] * transmission(ef[t], eps[t], gammaa[t])
+					+ pb[t] * transmission(ef[t], eps[t], gammab[t]);
+			}
+		});
+	setBatchObservableKernel<DifferentialConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			std::vector<double> pa(n), pb(n);
+			populations(n, params[Index_kAB], params[Index_kBA],
+				params[Index_kR], params[Index_loading], params[Index_time],
+				pa.data(), pb.data());
+
+			const double *ef = params[Index_EF];
+			const double *V = params[Index_V];
+			const double *eps = params[Index_epsilon];
+			const double *gammaa = params[Index_gammaA];
+			const double *gammab = params[Index_gammaB];
+			for(std::size_t t = 0; t < n; ++t)
+			{
+				const double el{ ef[t] + 0.5*V[t] }, er{ ef[t] - 0.5*V[t] };
+
+				out[t] = 0.5 * pa[t] * (transmission(el, eps[t], gammaa[t])
+						+ transmission(er, eps[t], gammaa[t]))
+					+ 0.5 * pb[t] * (transmission(el, eps[t], gammab[t])
+						+ transmission(er, eps[t], gammab[t]));
+			}
+		});
+}
+
+std::vector<std::string> SwitchingChannel::get_names() const
+{
+	std::vector<std::string> ret(8);
+
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_epsilon - 3] = "epsilon";
+	ret[Index_gammaA - 3] = "gammaa";
+	ret[Index_gammaB - 3] = "gammab";
+	ret[Index_kAB - 3] = "kab";
+	ret[Index_kBA - 3] = "kba";
+	ret[Index_kR - 3] = "krupture";
+	ret[Index_loading - 3] = "loading";
+	ret[Index_time - 3] = "time";
+
+	return ret;
+}
+
+double SwitchingChannel::transmission(const double e, const double eps,
+	const double gamma)
+{
+	return gamma*gamma / ((e-eps)*(e-eps) + gamma*gamma);
+}
+
+void SwitchingChannel::populations(std::size_t n, const double *kab,
+	const double *kba, const double *kr, const double *loading,
+	const double *time, double *pa, double *pb)
+{
+	// gather the valid trials
+	std::vector<std::size_t> valid;
+	valid.reserve(n);
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		pa[t] = pb[t] = NoObservableValue;
+
+		if(kab[t] >= 0. && kba[t] >= 0. && kr[t] >= 0. && time[t] >= 0.
+			&& std::isfinite(loading[t]))
+		{
+			valid.push_back(t);
+		}
+	}
+
+	if(valid.empty())
+		return;
+
+	std::vector<double> buffer(7 * valid.size());
+	double *vkab = buffer.data(),
+		*vkba = vkab + valid.size(),
+		*vkr = vkba + valid.size(),
+		*vloading = vkr + valid.size(),
+		*vtime = vloading + valid.size(),
+		*vpa = vtime + valid.size(),
+		*vpb = vpa + valid.size();
+	for(std::size_t j = 0; j < valid.size(); ++j)
+	{
+		vkab[j] = kab[valid[j]];
+		vkba[j] = kba[valid[j]];
+		vkr[j] = kr[valid[j]];
+		vloading[j] = loading[valid[j]];
+		vtime[j] = time[valid[j]];
+	}
+
+	// integrate the batch together; if that fails (one trial may be too
+	// stiff), integrate the trials separately so that only the failing
+	// trials are lost
+	if(GetPopulationSolver(valid.size()).solve(valid.size(), vkab, vkba, vkr,
+		vloading, vtime, vpa, vpb))
+	{
+		for(std::size_t j = 0; j < valid.size(); ++j)
+		{
+			pa[valid[j]] = vpa[j];
+			pb[valid[j]] = vpb[j];
+		}
+	}
+	else
+	{
+		PopulationSolver &solver = GetPopulationSolver(1);
+		for(std::size_t j = 0; j < valid.size(); ++j)
+		{
+			const std::size_t t{ valid[j] };
+			if(!solver.solve(1, &kab[t], &kba[t], &kr[t], &loading[t],
+				&time[t], &pa[t], &pb[t]))
+			{
+				pa[t] = pb[t] = NoObservableValue;
+			}
+		}
+	}
+}
+
+double SwitchingChannel::ZeroBiasG(const std::valarray<double> &params) const
+{
+	// unpack the parameters
+	const double &ef = params[Index_EF];
+	const double &eps = params[Index_epsilon];
+	const double &gammaa = params[Index_gammaA];
+	const double &gammab = params[Index_gammaB];
+
+	double pa, pb;
+	populations(1, &params[Index_kAB], &params[Index_kBA], &params[Index_kR],
+		&params[Index_loading], &params[Index_time], &pa, &pb);
+
+	return pa * transmission(ef, eps, gammaa)
+		+ pb * transmission(ef, eps, gammab);
+}
+
+double SwitchingChannel::DiffG(const std::valarray<double> &params) const
+{
+	// unpack the parameters
+	const double &ef = params[Index_EF];
+	const double &V = params[Index_V];
+	const double &eps = params[Index_epsilon];
+	const double &gammaa = params[Index_gammaA];
+	const double &gammab = params[Index_gammaB];
+
+	double pa, pb;
+	populations(1, &params[Index_kAB], &params[Index_kBA], &params[Index_kR],
+		&params[Index_loading], &params[Index_time], &pa, &pb);
+
+	return 0.5 * pa * (transmission(ef + 0.5*V, eps, gammaa)
+			+ transmission(ef - 0.5*V, eps, gammaa))
+		+ 0.5 * pb * (transmission(ef + 0.5*V, eps, gammab)
+			+ transmission(ef - 0.5*V, eps, gammab));
+}
+
+} // namespace molstat::transport
+} // namespace molstat
+
+#endif
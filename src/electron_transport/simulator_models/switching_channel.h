@@ -0,0 +1,161 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file switching_channel.h
+ * \brief One-site channel whose molecule switches between two binding
+ *    conformations (and ruptures) while the junction is stretched.
+ *
+ * The conformations' populations are found by integrating rate equations
+ * with CVODE. This channel is only available when MolStat is compiled with
+ * CVODE.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __switching_channel_h__
+#define __switching_channel_h__
+
+#include "observables.h"
+#include "junction.h"
+
+namespace molstat {
+namespace transport {
+
+/**
+ * \brief Simulator submodel for transport through a single site whose
+ *    binding conformation changes while the junction is stretched.
+ *
+ * The molecule starts in conformation A. As the junction is stretched, it
+ * switches to conformation B (and back), and the junction can rupture from
+ * conformation B. The force on the molecule grows during the stretch, so
+ * the rates follow the Bell model with a linearly increasing force,
+ * \f[ k_\mathrm{AB}(t) = k_\mathrm{AB} e^{ft}, \;\;\;\; k_\mathrm{BA}(t) = k_\mathrm{BA} e^{-ft}, \;\;\;\; k_\mathrm{r}(t) = k_\mathrm{r} e^{ft}, \f]
+ * and the populations of the conformations satisfy
+ * \f{eqnarray*}{ \frac{\mathrm{d}p_\mathrm{A}}{\mathrm{d}t} & = & -k_\mathrm{AB}(t) p_\mathrm{A} + k_\mathrm{BA}(t) p_\mathrm{B}, \\
+ * \frac{\mathrm{d}p_\mathrm{B}}{\mathrm{d}t} & = & k_\mathrm{AB}(t) p_\mathrm{A} - \left[ k_\mathrm{BA}(t) + k_\mathrm{r}(t) \right] p_\mathrm{B}, \f}
+ * with \f$p_\mathrm{A}(0) = 1\f$ and \f$p_\mathrm{B}(0) = 0\f$. A ruptured
+ * junction does not conduct, so the observables are the conformations'
+ * observables, weighted by their populations at the end of the stretch.
+ *
+ * Inherited model parameters (from molstat::transport::TransportJunction) are
+ * - `ef` (\f$E_\mathrm{F}\f$), the Fermi energy,
+ * - `v` (\f$V\f$), the applied bias.
+ *
+ * Model parameters are
+ * - `epsilon` (\f$\varepsilon\f$), the site-energy,
+ * - `gammaa` (\f$\Gamma_\mathrm{A}\f$), the site/lead coupling in
+ *   conformation A,
+ * - `gammab` (\f$\Gamma_\mathrm{B}\f$), the site/lead coupling in
+ *   conformation B,
+ * - `kab` (\f$k_\mathrm{AB}\f$), the rate from A to B without force,
+ * - `kba` (\f$k_\mathrm{BA}\f$), the rate from B to A without force,
+ * - `krupture` (\f$k_\mathrm{r}\f$), the rupture rate from B without force,
+ * - `loading` (\f$f\f$), the growth rate of the force (in units of the
+ *   thermal energy per transition-state distance),
+ * - `time` (\f$t\f$), the duration of the stretch.
+ *
+ * Trials with negative rates or a negative duration produce no observables.
+ *
+ * In each conformation, the transmission function is
+ * \f[ T_\mathrm{A/B}(E) = \frac{\Gamma_\mathrm{A/B}^2}{(E-\varepsilon)^2 + \Gamma_\mathrm{A/B}^2}. \f]
+ * - Zero-bias conductance:
+ *   \f[ G_0 = \frac{2e^2}{h} \left[ p_\mathrm{A} T_\mathrm{A}(E_\mathrm{F}) + p_\mathrm{B} T_\mathrm{B}(E_\mathrm{F}) \right]. \f]
+ * - Differential conductance:
+ *   \f[ G_\mathrm{d}(V) = \frac{2e^2}{h} \sum_{c=\mathrm{A,B}} \frac{p_c}{2} \left[ T_c(E_\mathrm{F} + eV/2) + T_c(E_\mathrm{F} - eV/2) \right]. \f]
+ *
+ * Setting up CVODE for each trial would dominate the cost of these small
+ * systems. Instead, each thread keeps two solvers (one sized for its largest
+ * batch, with smaller batches padded, and one for single trials), and a
+ * batch of trials is integrated as one block-diagonal system (with a banded
+ * linear solver); time is scaled by each trial's duration so that all
+ * trials end together. If the batch cannot be integrated, its trials are
+ * integrated one at a time.
+ */
+class SwitchingChannel : public Channel,
+	public ZeroBiasConductance,
+	public DifferentialConductance
+{
+public:
+	/// Container index for the Fermi energy.
+	static const std::size_t Index_EF;
+
+	/// Container index for the applied bias.
+	static const std::size_t Index_V;
+
+	/// Container index for the site energy.
+	static const std::size_t Index_epsilon;
+
+	/// Container index for the coupling in conformation A.
+	static const std::size_t Index_gammaA;
+
+	/// Container index for the coupling in conformation B.
+	static const std::size_t Index_gammaB;
+
+	/// Container index for the rate from A to B.
+	static const std::size_t Index_kAB;
+
+	/// Container index for the rate from B to A.
+	static const std::size_t Index_kBA;
+
+	/// Container index for the rupture rate.
+	static const std::size_t Index_kR;
+
+	/// Container index for the growth rate of the force.
+	static const std::size_t Index_loading;
+
+	/// Container index for the duration of the stretch.
+	static const std::size_t Index_time;
+
+protected:
+	virtual std::vector<std::string> get_names() const override;
+
+public:
+	/// Constructor registering the batch kernels for the observables.
+	SwitchingChannel();
+
+	virtual ~SwitchingChannel() = default;
+
+	/**
+	 * \brief Calculates the transmission in one conformation.
+	 *
+	 * \param[in] e The energy of the incident electron.
+	 * \param[in] eps The site energy.
+	 * \param[in] gamma The site-electrode coupling in the conformation.
+	 * \return The transmission.
+	 */
+	static double transmission(const double e, const double eps,
+		const double gamma);
+
+	/**
+	 * \brief Calculates the populations of the conformations at the end of
+	 *    the stretch for a batch of trials.
+	 *
+	 * Trials with negative rates or durations, and trials that cannot be
+	 * integrated, get populations of molstat::NoObservableValue.
+	 *
+	 * \param[in] n The number of trials.
+	 * \param[in] kab The rates from A to B.
+	 * \param[in] kba The rates from B to A.
+	 * \param[in] kr The rupture rates.
+	 * \param[in] loading The growth rates of the force.
+	 * \param[in] time The durations of the stretch.
+	 * \param[out] pa The populations of conformation A.
+	 * \param[out] pb The populations of conformation B.
+	 */
+	static void populations(std::size_t n, const double *kab,
+		const double *kba, const double *kr, const double *loading,
+		const double *time, double *pa, double *pb);
+
+	virtual double ZeroBiasG(const std::valarray<double> &params) const
+		override;
+	virtual double DiffG(const std::valarray<double> &params) const override;
+};
+
+} // namespace molstat::transport
+} // namespace molstat
+
+#endif
@@ -13,34 +13,75 @@
  */
 
 #include "sym_interference.h"
+#include "transport_device.h"
+#include <general/batch_kernels.h>
+#include <electron_transport/channel_kernels.h>
 
 namespace molstat {
 namespace transport {
 
 const std::size_t SymInterferenceChannel::Index_EF = TransportJunction::Index_EF;
 const std::size_t SymInterferenceChannel::Index_V = TransportJunction::Index_V;
-const std::size_t SymInterferenceChannel::Index_epsilon = 2;
-const std::size_t SymInterferenceChannel::Index_gamma = 3;
-const std::size_t SymInterferenceChannel::Index_beta = 4;
+const std::size_t SymInterferenceChannel::Index_epsilon = 3;
+const std::size_t SymInterferenceChannel::Index_gamma = 4;
+const std::size_t SymInterferenceChannel::Index_beta = 5;
+
+namespace {
+
+/// \cond
+using Model = SymInterferenceChannel;
+
+MOLSTAT_BATCH_KERNEL
+void ZeroBiasGKernel(std::size_t n, const double *ef, const double *eps,
+	const double *gamma, const double *beta, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+		out[t] = Model::transmission(ef[t], eps[t], gamma[t], beta[t]);
+}
+/// \endcond
+
+} // anonymous namespace
+
+SymInterferenceChannel::SymInterferenceChannel()
+{
+	setBatchObservableKernel<ZeroBiasConductance, Model>(
+		[] (const Model &model, const double *const *params, std::size_t n,
+			double *out) -> void
+		{
+			ZeroBiasGKernel(n, params[Index_EF], params[Index_epsilon],
+				params[Index_gamma], params[Index_beta], out);
+		});
+	setObservableParameters<ZeroBiasConductance>(
+		{ Index_EF, Index_epsilon, Index_gamma, Index_beta });
+}
 
 std::vector<std::string> SymInterferenceChannel::get_names() const
 {
 	std::vector<std::string> ret(3);
 
-	// subtract two because we expect 2 parameters from the TransportJunction
-	ret[Index_epsilon - 2] = "epsilon";
-	ret[Index_gamma - 2] = "gamma";
-	ret[Index_beta - 2] = "beta";
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_epsilon - 3] = "epsilon";
+	ret[Index_gamma - 3] = "gamma";
+	ret[Index_beta - 3] = "beta";
 
 	return ret;
 }
 
+bool SymInterferenceChannel::appendDeviceTerms(const ObservableIndex &obs,
+	std::vector<DeviceTerm> &terms) const
+{
+	if(obs != GetObservableIndex<ZeroBiasConductance>())
+		return false;
+
+	terms.push_back(MakeDeviceTerm(SymInterferenceZeroBiasG,
+		{ Index_EF, Index_epsilon, Index_gamma, Index_beta }));
+	return true;
+}
+
 double SymInterferenceChannel::transmission(const double e, const double eps,
 	const double gamma, const double beta)
 {
-	const double temp1 = e - eps;
-	const double temp2 = temp1*temp1 - beta*beta;
-	return gamma*gamma*temp1*temp1 / (temp2*temp2 + temp1*temp1*gamma*gamma);
+	return SymInterferenceTransmission(e - eps, gamma, beta);
 }
 
 double SymInterferenceChannel::ZeroBiasG(const std::valarray<double> &params) const
@@ -64,7 +64,24 @@ public:
 protected:
 	virtual std::vector<std::string> get_names() const override;
 
+	/**
+	 * \brief Appends the device kernels of the zero-bias conductance (see
+	 *    transport_device.h).
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in,out] terms The terms.
+	 * \return True if the observable has a kernel, false otherwise.
+	 */
+	virtual bool appendDeviceTerms(const ObservableIndex &obs,
+		std::vector<DeviceTerm> &terms) const override;
+
 public:
+	/**
+	 * \brief Constructor registering the batch kernels for the observables
+	 *    and the parameters they read.
+	 */
+	SymInterferenceChannel();
+
 	virtual ~SymInterferenceChannel() = default;
 
 	/**
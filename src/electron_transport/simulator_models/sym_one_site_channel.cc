@@ -13,35 +13,182 @@
  */
 
 #include "sym_one_site_channel.h"
+#include "transport_device.h"
 #include <cmath>
+#include <complex>
+#include <general/batch_kernels.h>
+#include <electron_transport/channel_kernels.h>
 
 namespace molstat {
 namespace transport {
 
 const std::size_t SymOneSiteChannel::Index_EF = TransportJunction::Index_EF;
 const std::size_t SymOneSiteChannel::Index_V = TransportJunction::Index_V;
-const std::size_t SymOneSiteChannel::Index_epsilon = 2;
-const std::size_t SymOneSiteChannel::Index_gamma = 3;
-const std::size_t SymOneSiteChannel::Index_a = 4;
-const std::size_t SymOneSiteChannel::Index_nm = 5;
+const std::size_t SymOneSiteChannel::Index_kT = TransportJunction::Index_kT;
+const std::size_t SymOneSiteChannel::Index_epsilon = 3;
+const std::size_t SymOneSiteChannel::Index_gamma = 4;
+const std::size_t SymOneSiteChannel::Index_a = 5;
+const std::size_t SymOneSiteChannel::Index_nm = 6;
+
+namespace {
+
+/// \cond
+using Model = SymOneSiteChannel;
+
+MOLSTAT_BATCH_KERNEL
+void ZeroBiasGKernel(std::size_t n, const double *ef, const double *eps,
+	const double *gamma, const double *a, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+		out[t] = Model::transmission(ef[t], 0., eps[t], gamma[t], a[t]);
+}
+
+MOLSTAT_BATCH_KERNEL
+void ZeroBiasSKernel(std::size_t n, const double *ef, const double *eps,
+	const double *gamma, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+		out[t] = SymOneSiteThermopower(ef[t] - eps[t], gamma[t]);
+}
+
+MOLSTAT_BATCH_KERNEL
+void DiffGKernel(std::size_t n, const double *ef, const double *V,
+	const double *eps, const double *gamma, const double *a, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		out[t] = (0.5 - a[t]) *
+				Model::transmission(ef[t] + 0.5*V[t], V[t], eps[t], gamma[t], a[t])
+			+ (0.5 + a[t]) *
+				Model::transmission(ef[t] - 0.5*V[t], V[t], eps[t], gamma[t], a[t]);
+	}
+}
+
+MOLSTAT_BATCH_KERNEL
+void ECurrentKernel(std::size_t n, const double *ef, const double *V,
+	const double *kT, const double *eps, const double *gamma, const double *a,
+	double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		out[t] = TransportJunction::qc *
+			SymOneSiteCurrent(ef[t], V[t], eps[t], gamma[t], a[t]);
+	}
+
+	// redo the trials at finite temperature
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		if(kT[t] > 0.)
+			out[t] = Model::thermal_current(ef[t], V[t], kT[t], eps[t],
+				gamma[t], a[t]);
+	}
+}
+/// \endcond
+
+} // anonymous namespace
+
+SymOneSiteChannel::SymOneSiteChannel()
+{
+	using Params = const double *const *;
+
+	setBatchObservableKernel<ZeroBiasConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			ZeroBiasGKernel(n, params[Index_EF], params[Index_epsilon],
+				params[Index_gamma], params[Index_a], out);
+		});
+	setBatchObservableKernel<ZeroBiasThermopower, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			ZeroBiasSKernel(n, params[Index_EF], params[Index_epsilon],
+				params[Index_gamma], out);
+		});
+	setBatchObservableKernel<DifferentialConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			DiffGKernel(n, params[Index_EF], params[Index_V],
+				params[Index_epsilon], params[Index_gamma], params[Index_a],
+				out);
+		});
+	setBatchObservableKernel<ElectricCurrent, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			ECurrentKernel(n, params[Index_EF], params[Index_V],
+				params[Index_kT], params[Index_epsilon], params[Index_gamma],
+				params[Index_a], out);
+		});
+	setBatchObservableKernel<StaticConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			ECurrentKernel(n, params[Index_EF], params[Index_V],
+				params[Index_kT], params[Index_epsilon], params[Index_gamma],
+				params[Index_a], out);
+
+			// G = nm * I / (qc * V)
+			const double *V = params[Index_V];
+			const double *nm = params[Index_nm];
+			for(std::size_t t = 0; t < n; ++t)
+				out[t] = nm[t] * out[t] / (TransportJunction::qc * V[t]);
+		});
+
+	// the zero-bias observables do not depend on the voltage drop (a*V = 0)
+	setObservableParameters<ZeroBiasConductance>(
+		{ Index_EF, Index_epsilon, Index_gamma });
+	setObservableParameters<ZeroBiasThermopower>(
+		{ Index_EF, Index_epsilon, Index_gamma });
+	setObservableParameters<DifferentialConductance>(
+		{ Index_EF, Index_V, Index_epsilon, Index_gamma, Index_a });
+	setObservableParameters<ElectricCurrent>(
+		{ Index_EF, Index_V, Index_kT, Index_epsilon, Index_gamma, Index_a });
+	setObservableParameters<StaticConductance>(
+		{ Index_EF, Index_V, Index_kT, Index_epsilon, Index_gamma, Index_a,
+			Index_nm });
+}
 
 std::vector<std::string> SymOneSiteChannel::get_names() const
 {
 	std::vector<std::string> ret(4);
 
-	// subtract two because we expect 2 parameters from the TransportJunction
-	ret[Index_epsilon - 2] = "epsilon";
-	ret[Index_gamma - 2] = "gamma";
-	ret[Index_a - 2] = "a";
-	ret[Index_nm - 2] = "nm";
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_epsilon - 3] = "epsilon";
+	ret[Index_gamma - 3] = "gamma";
+	ret[Index_a - 3] = "a";
+	ret[Index_nm - 3] = "nm";
 
 	return ret;
 }
 
+bool SymOneSiteChannel::appendDeviceTerms(const ObservableIndex &obs,
+	std::vector<DeviceTerm> &terms) const
+{
+	if(obs == GetObservableIndex<ZeroBiasConductance>())
+		terms.push_back(MakeDeviceTerm(SymOneSiteZeroBiasG,
+			{ Index_EF, Index_epsilon, Index_gamma }));
+	else if(obs == GetObservableIndex<DifferentialConductance>())
+		terms.push_back(MakeDeviceTerm(SymOneSiteDiffG,
+			{ Index_EF, Index_V, Index_epsilon, Index_gamma, Index_a }));
+	else if(obs == GetObservableIndex<ElectricCurrent>())
+		terms.push_back(MakeDeviceTerm(SymOneSiteECurrent,
+			{ Index_EF, Index_V, Index_epsilon, Index_gamma, Index_a }));
+	else if(obs == GetObservableIndex<StaticConductance>())
+		terms.push_back(MakeDeviceTerm(SymOneSiteStaticG,
+			{ Index_EF, Index_V, Index_epsilon, Index_gamma, Index_a,
+				Index_nm }));
+	else
+		return false;
+
+	return true;
+}
+
 double SymOneSiteChannel::transmission(const double e, const double V,
 	const double eps, const double gamma, const double a)
 {
-	return gamma*gamma / ((e - eps - a*V)*(e - eps - a*V) + gamma*gamma);
+	return SymOneSiteTransmission(e, V, eps, gamma, a);
 }
 
 double SymOneSiteChannel::ZeroBiasG(const std::valarray<double> &params) const
@@ -68,17 +215,30 @@ double SymOneSiteChannel::DiffG(const std::valarray<double> &params) const
 		(0.5 + a) * transmission(ef-0.5*V, V, eps, gamma, a);
 }
 
+double SymOneSiteChannel::thermal_current(const double ef, const double V,
+	const double kT, const double eps, const double gamma, const double a)
+{
+	// T(E) = -gamma * Im[1 / (E - z)]
+	const std::complex<double> z{ eps + a*V, -gamma };
+
+	return -TransportJunction::qc * gamma * std::imag(
+		TransportJunction::FermiWindowPole(z, ef + 0.5*V, ef - 0.5*V, kT));
+}
+
 double SymOneSiteChannel::ECurrent(const std::valarray<double> & params) const
 {
 	// unpack the parameters
 	const double &ef = params[Index_EF];
 	const double &V = params[Index_V];
+	const double &kT = params[Index_kT];
 	const double &eps = params[Index_epsilon];
 	const double &gamma = params[Index_gamma];
 	const double &a = params[Index_a];
 
-	return TransportJunction::qc * gamma *
-		(atan((ef-eps+(0.5-a)*V) / gamma) - atan((ef-eps-(0.5+a)*V) / gamma));
+	if(kT > 0.)
+		return thermal_current(ef, V, kT, eps, gamma, a);
+
+	return TransportJunction::qc * SymOneSiteCurrent(ef, V, eps, gamma, a);
 }
 
 double SymOneSiteChannel::StaticG(const std::valarray<double> &params) const
@@ -97,9 +257,96 @@ double SymOneSiteChannel::ZeroBiasS(const std::valarray<double> &params) const
 	const double &ef = params[Index_EF];
 	const double &eps = params[Index_epsilon];
 	const double &gamma = params[Index_gamma];
-	const double z = ef - eps;
 
-	return 2.*z / (z*z + gamma*gamma);
+	return SymOneSiteThermopower(ef - eps, gamma);
+}
+
+FusedObservableFunction SymOneSiteChannel::getFusedObservableFunction(
+	const std::vector<ObservableIndex> &obs) const
+{
+	// the quantity stored in each output
+	enum class Output { Current, StaticG, ZeroBiasG, DiffG, ZeroBiasS };
+	std::vector<Output> outputs;
+	std::size_t uses_current{ 0 }, uses_zerobias{ 0 };
+	bool thermopower{ false };
+
+	for(const ObservableIndex &o : obs)
+	{
+		// tabulated observables must use their tables
+		if(tabulated_observables.count(o) > 0)
+			return FusedObservableFunction();
+
+		if(o == GetObservableIndex<ElectricCurrent>())
+		{
+			outputs.push_back(Output::Current);
+			++uses_current;
+		}
+		else if(o == GetObservableIndex<StaticConductance>())
+		{
+			outputs.push_back(Output::StaticG);
+			++uses_current;
+		}
+		else if(o == GetObservableIndex<ZeroBiasConductance>())
+		{
+			outputs.push_back(Output::ZeroBiasG);
+			++uses_zerobias;
+		}
+		else if(o == GetObservableIndex<ZeroBiasThermopower>())
+		{
+			outputs.push_back(Output::ZeroBiasS);
+			++uses_zerobias;
+			thermopower = true;
+		}
+		else if(o == GetObservableIndex<DifferentialConductance>())
+			outputs.push_back(Output::DiffG);
+		else
+			return FusedObservableFunction();
+	}
+
+	// nothing to share unless the current is used more than once or the
+	// thermopower is used with the zero-bias conductance (they share
+	// ef - eps and the denominator of the transmission)
+	if(uses_current < 2 && !(thermopower && uses_zerobias >= 2))
+		return FusedObservableFunction();
+
+	std::shared_ptr<const SymOneSiteChannel> model
+		= std::dynamic_pointer_cast<const SymOneSiteChannel>(shared_from_this());
+
+	return [model, outputs, uses_current] (const std::valarray<double> &params,
+		double *out) -> void
+	{
+		const double current{ uses_current > 0 ?
+			model->SymOneSiteChannel::ECurrent(params) : 0. };
+
+		// the zero-bias transmission is gamma^2 / (z^2 + gamma^2) and the
+		// thermopower is 2z / (z^2 + gamma^2)
+		const double z{ params[Index_EF] - params[Index_epsilon] };
+		const double gamma2{ params[Index_gamma] * params[Index_gamma] };
+		const double rdenom{ 1. / (z*z + gamma2) };
+
+		for(std::size_t j = 0; j < outputs.size(); ++j)
+		{
+			switch(outputs[j])
+			{
+			case Output::Current:
+				out[j] = current;
+				break;
+			case Output::StaticG:
+				out[j] = params[Index_nm] * current /
+					(TransportJunction::qc * params[Index_V]);
+				break;
+			case Output::ZeroBiasG:
+				out[j] = gamma2 * rdenom;
+				break;
+			case Output::ZeroBiasS:
+				out[j] = 2.*z * rdenom;
+				break;
+			case Output::DiffG:
+				out[j] = model->SymOneSiteChannel::DiffG(params);
+				break;
+			}
+		}
+	};
 }
 
 } // namespace molstat::transport
@@ -27,7 +27,8 @@ namespace transport {
  *
  * Inherited model parameters (from molstat::transport::TransportJunction) are
  * - `ef` (\f$E_\mathrm{F}\f$), the Fermi energy,
- * - `v` (\f$V\f$), the applied bias.
+ * - `v` (\f$V\f$), the applied bias,
+ * - `kt` (\f$k_\mathrm{B}T\f$), the thermal energy (for the current).
  *
  * Submodel parameters are
  * - `epsilon` (\f$\varepsilon\f$), the site-energy,
@@ -44,6 +45,9 @@ namespace transport {
  *   \f[ \frac{\partial}{\partial V}T(E) = \frac{2ea\Gamma^2(E - \varepsilon-aeV)}{[(E-\varepsilon-aeV)^2+\Gamma^2]^2}; \f]
  *   \f[ \frac{2e}{h} \int\limits_{E_\mathrm{F}-eV/2}^{E_\mathrm{F}+eV/2} \mathrm{d}E \frac{\partial}{\partial V} T(E) = \frac{2e^2a}{h} T(E_\mathrm{F}-eV/2) - \frac{2e^2a}{h}T(E_\mathrm{F}+eV/2); \f]
  *   \f[ G_\mathrm{d}(V) = \frac{2e^2}{h} \left[ (1/2-a) T(E_\mathrm{F} + eV/2) + (1/2+a) T(E_\mathrm{F} - eV/2) \right]. \f]
+ *
+ *   At finite temperature, the Lorentzian is integrated against the Fermi
+ *   functions with thermal_current().
  * - Static conductance:
  *   \f[ G_\mathrm{s}(V) = \frac{2e^2}{h} \frac{\Gamma}{eV} \left[ \arctan\left( \frac{E_\mathrm{F} - \varepsilon + (1/2-a) eV}{\Gamma} \right) - \arctan\left( \frac{E_\mathrm{F} - \varepsilon - (1/2+a) eV}{\Gamma} \right) \right]. \f]
  * - Seebeck coefficient (zero bias, "atomic" units):
@@ -63,6 +67,9 @@ public:
 	/// Container index for the applied bias.
 	static const std::size_t Index_V;
 
+	/// Container index for the thermal energy.
+	static const std::size_t Index_kT;
+
 	/// Container index for the site energy.
 	static const std::size_t Index_epsilon;
 
@@ -79,7 +86,28 @@ public:
 protected:
 	virtual std::vector<std::string> get_names() const override;
 
+	/**
+	 * \brief Appends the device kernels of the conductances and the current
+	 *    (see transport_device.h).
+	 *
+	 * The kernels of the current and static conductance are at zero
+	 * temperature; molstat::transport::TransportJunction only uses them
+	 * when \f$k_\mathrm{B}T=0\f$.
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in,out] terms The terms.
+	 * \return True if the observable has a kernel, false otherwise.
+	 */
+	virtual bool appendDeviceTerms(const ObservableIndex &obs,
+		std::vector<DeviceTerm> &terms) const override;
+
 public:
+	/**
+	 * \brief Constructor registering the batch kernels for the observables
+	 *    and the parameters they read.
+	 */
+	SymOneSiteChannel();
+
 	virtual ~SymOneSiteChannel() = default;
 
 	/**
@@ -95,12 +123,44 @@ public:
 
 	static double transmission(const double e, const double V, const double eps,
 		const double gamma, const double a);
+
+	/**
+	 * \brief Calculates the electric current at finite temperature.
+	 *
+	 * The transmission is a single pole, which is integrated over the Fermi
+	 * window by molstat::transport::TransportJunction::FermiWindowPole.
+	 *
+	 * \param[in] ef The Fermi energy.
+	 * \param[in] V The applied bias.
+	 * \param[in] kT The thermal energy.
+	 * \param[in] eps The level energy.
+	 * \param[in] gamma The level-electrode coupling.
+	 * \param[in] a The voltage drop scaling factor.
+	 * \return The electric current.
+	 */
+	static double thermal_current(const double ef, const double V,
+		const double kT, const double eps, const double gamma, const double a);
 	
 	virtual double ECurrent(const std::valarray<double> &params) const override;
 	virtual double ZeroBiasG(const std::valarray<double> &params) const override;
 	virtual double DiffG(const std::valarray<double> &params) const override;
 	virtual double StaticG(const std::valarray<double> &params) const override;
 	virtual double ZeroBiasS(const std::valarray<double> &params) const override;
+
+	/**
+	 * \brief Gets a function that calculates several observables together.
+	 *
+	 * The electric current is calculated once and shared by the current and
+	 * the static conductance. The zero-bias conductance and thermopower
+	 * share \f$E_\mathrm{F}-\varepsilon\f$ and the denominator
+	 * \f$(E_\mathrm{F}-\varepsilon)^2 + \Gamma^2\f$.
+	 *
+	 * \param[in] obs The observables.
+	 * \return The fused function, or an empty function if the observables
+	 *    share nothing.
+	 */
+	virtual FusedObservableFunction getFusedObservableFunction(
+		const std::vector<ObservableIndex> &obs) const override;
 };
 
 } // namespace molstat::transport
@@ -13,37 +13,66 @@
  */
 
 #include "sym_two_site_channel.h"
+#include "transport_device.h"
 #include <cmath>
 #include <complex>
+#include <electron_transport/channel_kernels.h>
 
 namespace molstat {
 namespace transport {
 
 const std::size_t SymTwoSiteChannel::Index_EF = TransportJunction::Index_EF;
 const std::size_t SymTwoSiteChannel::Index_V = TransportJunction::Index_V;
-const std::size_t SymTwoSiteChannel::Index_epsilon = 2;
-const std::size_t SymTwoSiteChannel::Index_gamma = 3;
-const std::size_t SymTwoSiteChannel::Index_beta = 4;
+const std::size_t SymTwoSiteChannel::Index_kT = TransportJunction::Index_kT;
+const std::size_t SymTwoSiteChannel::Index_epsilon = 3;
+const std::size_t SymTwoSiteChannel::Index_gamma = 4;
+const std::size_t SymTwoSiteChannel::Index_beta = 5;
+
+SymTwoSiteChannel::SymTwoSiteChannel()
+{
+	setObservableParameters<ZeroBiasConductance>(
+		{ Index_EF, Index_epsilon, Index_gamma, Index_beta });
+	setObservableParameters<DifferentialConductance>(
+		{ Index_EF, Index_V, Index_epsilon, Index_gamma, Index_beta });
+	setObservableParameters<ElectricCurrent>(
+		{ Index_EF, Index_V, Index_kT, Index_epsilon, Index_gamma,
+			Index_beta });
+	setObservableParameters<StaticConductance>(
+		{ Index_EF, Index_V, Index_kT, Index_epsilon, Index_gamma,
+			Index_beta });
+}
 
 std::vector<std::string> SymTwoSiteChannel::get_names() const
 {
 	std::vector<std::string> ret(3);
 
-	// subtract two because we expect 2 parameters from the TransportJunction
-	ret[Index_epsilon - 2] = "epsilon";
-	ret[Index_gamma - 2] = "gamma";
-	ret[Index_beta - 2] = "beta";
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_epsilon - 3] = "epsilon";
+	ret[Index_gamma - 3] = "gamma";
+	ret[Index_beta - 3] = "beta";
 
 	return ret;
 }
 
+bool SymTwoSiteChannel::appendDeviceTerms(const ObservableIndex &obs,
+	std::vector<DeviceTerm> &terms) const
+{
+	if(obs == GetObservableIndex<ZeroBiasConductance>())
+		terms.push_back(MakeDeviceTerm(SymTwoSiteZeroBiasG,
+			{ Index_EF, Index_epsilon, Index_gamma, Index_beta }));
+	else if(obs == GetObservableIndex<DifferentialConductance>())
+		terms.push_back(MakeDeviceTerm(SymTwoSiteDiffG,
+			{ Index_EF, Index_V, Index_epsilon, Index_gamma, Index_beta }));
+	else
+		return false;
+
+	return true;
+}
+
 double SymTwoSiteChannel::transmission(const double e, const double V,
 	const double eps, const double gamma, const double beta)
 {
-	double temp = 4.*(e-eps)*(e-eps) - 4.*beta*beta - gamma*gamma;
-
-	return 16.*gamma*gamma*beta*beta /
-		(temp*temp + 16.*gamma*gamma*(e-eps)*(e-eps));
+	return TwoSiteTransmission(e, eps, gamma, gamma, beta);
 }
 
 double SymTwoSiteChannel::current_integral(const double z,
@@ -54,14 +83,39 @@ double SymTwoSiteChannel::current_integral(const double z,
 		* atanh(2.*(z-eps) / std::complex<double>(2.*beta, gamma)));
 }
 
+double SymTwoSiteChannel::thermal_current(const double ef, const double V,
+	const double kT, const double eps, const double gamma, const double beta)
+{
+	if(beta == 0.)
+		return 0.;
+
+	// T(E) = gamma^2 beta^2 / |(E - z1)(E - z2)|^2; the residues of the
+	// poles in the lower half-plane (the others are their conjugates)
+	const std::complex<double> z1{ eps + beta, -0.5*gamma },
+		z2{ eps - beta, -0.5*gamma };
+	const std::complex<double> r1{ 1. / ((z1 - z2) * (z1 - conj(z1))
+		* (z1 - conj(z2))) };
+	const std::complex<double> r2{ 1. / ((z2 - z1) * (z2 - conj(z1))
+		* (z2 - conj(z2))) };
+
+	return 2. * gamma*gamma*beta*beta * real(
+		r1 * TransportJunction::FermiWindowPole(z1, ef + 0.5*V, ef - 0.5*V, kT)
+		+ r2 * TransportJunction::FermiWindowPole(z2, ef + 0.5*V, ef - 0.5*V,
+			kT));
+}
+
 double SymTwoSiteChannel::ECurrent(const std::valarray<double> &params) const
 {
 	// unpack the parameters
 	const double &ef = params[Index_EF];
 	const double &V = params[Index_V];
+	const double &kT = params[Index_kT];
 	const double &eps = params[Index_epsilon];
 	const double &gamma = params[Index_gamma];
 	const double &beta = params[Index_beta];
+
+	if(kT > 0.)
+		return thermal_current(ef, V, kT, eps, gamma, beta);
 	
 	return (current_integral(ef + 0.5*V, eps, gamma, beta) -
 		current_integral(ef - 0.5*V, eps, gamma, beta));
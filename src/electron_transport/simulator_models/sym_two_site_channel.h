@@ -27,7 +27,8 @@ namespace transport {
  *
  * Inherited model parameters (from molstat::transport::TransportJunction) are
  * - `ef` (\f$E_\mathrm{F}\f$), the Fermi energy,
- * - `v` (\f$V\f$), the applied bias.
+ * - `v` (\f$V\f$), the applied bias,
+ * - `kt` (\f$k_\mathrm{B}T\f$), the thermal energy (for the current).
  *
  * Model parameters are
  * - `epsilon` (\f$\varepsilon\f$), the site-energy,
@@ -42,6 +43,10 @@ namespace transport {
  * - Electric current:
  *   \f{eqnarray*}{ G_\mathrm{s}(V) & = & \frac{2e}{h} \frac{2\beta\Gamma}{4\beta^2+\Gamma^2} \mathrm{Re} \left[ (\Gamma + i2\beta) \mathrm{arctanh}\left( \frac{2(E_\mathrm{F} - \varepsilon + eV/2)}{2\beta + i\Gamma} \right) \right] \\
  *   && -\frac{2e}{h} \frac{2\beta\Gamma}{4\beta^2+\Gamma^2} \mathrm{Re} \left[ (\Gamma + i2\beta) \mathrm{arctanh}\left( \frac{2(E_\mathrm{F} - \varepsilon - eV/2)}{2\beta + i\Gamma} \right) \right]. \f}
+ *
+ *   At finite temperature, the transmission is split into its poles,
+ *   \f$\varepsilon \pm \beta - i\Gamma/2\f$, which are integrated over the
+ *   Fermi window.
  * - Differential conductance:
  *   \f[ G_\mathrm{d}(V) = \frac{2e^2}{h} \frac{1}{2} \left[ T(E_\mathrm{F} + eV/2) + T(E_\mathrm{F} - eV/2) \right]. \f]
  * - Static conductance:
@@ -68,6 +73,21 @@ private:
 	static double current_integral(const double z, const double eps,
 		const double gamma, const double beta);
 
+	/**
+	 * \brief Calculates the electric current at finite temperature.
+	 *
+	 * \param[in] ef The Fermi energy.
+	 * \param[in] V The applied bias.
+	 * \param[in] kT The thermal energy.
+	 * \param[in] eps The channel energy, epsilon.
+	 * \param[in] gamma The channel-lead coupling, gamma.
+	 * \param[in] beta The site-site coupling, beta.
+	 * \return The electric current.
+	 */
+	static double thermal_current(const double ef, const double V,
+		const double kT, const double eps, const double gamma,
+		const double beta);
+
 public:
 	/// Container index for the Fermi energy.
 	static const std::size_t Index_EF;
@@ -75,6 +95,9 @@ public:
 	/// Container index for the applied bias.
 	static const std::size_t Index_V;
 
+	/// Container index for the thermal energy.
+	static const std::size_t Index_kT;
+
 	/// Container index for the site energy.
 	static const std::size_t Index_epsilon;
 
@@ -87,7 +110,21 @@ public:
 protected:
 	virtual std::vector<std::string> get_names() const override;
 
+	/**
+	 * \brief Appends the device kernels of the zero-bias and differential
+	 *    conductances (see transport_device.h).
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in,out] terms The terms.
+	 * \return True if the observable has a kernel, false otherwise.
+	 */
+	virtual bool appendDeviceTerms(const ObservableIndex &obs,
+		std::vector<DeviceTerm> &terms) const override;
+
 public:
+	/// Constructor registering the parameters read by the observables.
+	SymTwoSiteChannel();
+
 	virtual ~SymTwoSiteChannel() = default;
 
 	/**
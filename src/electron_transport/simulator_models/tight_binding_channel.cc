@@ -0,0 +1,553 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tight_binding_channel.cc
+ * \brief Tight-binding channel with an N-site chain (or ring) that couples
+ *    asymmetrically to both electrodes.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "tight_binding_channel.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+#include <general/gauss_kronrod.h>
+#include <general/gauss_legendre.h>
+#include <general/batch_kernels.h>
+
+namespace molstat {
+namespace transport {
+
+const std::size_t TightBindingChannel::Index_EF = TransportJunction::Index_EF;
+const std::size_t TightBindingChannel::Index_V = TransportJunction::Index_V;
+const std::size_t TightBindingChannel::Index_kT = TransportJunction::Index_kT;
+const std::size_t TightBindingChannel::Index_epsilon = 3;
+const std::size_t TightBindingChannel::Index_gammaL = 4;
+const std::size_t TightBindingChannel::Index_gammaR = 5;
+const std::size_t TightBindingChannel::Index_beta = 6;
+const std::size_t TightBindingChannel::Index_nsites = 7;
+const std::size_t TightBindingChannel::Index_betaring = 8;
+
+std::size_t TightBindingChannel::quadrature_order = 0;
+double TightBindingChannel::quadrature_epsabs = 1.e-9;
+double TightBindingChannel::quadrature_epsrel = 1.e-9;
+
+void TightBindingChannel::setStaticGQuadrature(std::size_t order, double epsabs,
+	double epsrel)
+{
+	if(!(epsabs >= 0.) || !(epsrel >= 0.) || epsabs + epsrel == 0.)
+		throw std::invalid_argument("The quadrature tolerances must be " \
+			"non-negative and not both zero.");
+
+	quadrature_order = order;
+	quadrature_epsabs = epsabs;
+	quadrature_epsrel = epsrel;
+}
+
+namespace {
+
+/**
+ * \brief Diagonalizes a real, symmetric matrix with the cyclic Jacobi method.
+ *
+ * The matrices are small (tens of sites), where Jacobi rotations are simple
+ * and accurate.
+ *
+ * \param[in,out] a The matrix (row-major); it is overwritten.
+ * \param[in] n The dimension of the matrix.
+ * \param[out] evals The eigenvalues.
+ * \param[out] evecs The eigenvectors (row-major; each column is an
+ *    eigenvector).
+ */
+void symmetric_eigensystem(std::vector<double> &a, const std::size_t n,
+	std::vector<double> &evals, std::vector<double> &evecs)
+{
+	evecs.assign(n * n, 0.);
+	for(std::size_t j = 0; j < n; ++j)
+		evecs[j*n + j] = 1.;
+
+	double norm{ 0. };
+	for(const double x : a)
+		norm += x * x;
+
+	for(std::size_t sweep = 0; sweep < 50; ++sweep)
+	{
+		double off{ 0. };
+		for(std::size_t p = 0; p < n; ++p)
+			for(std::size_t q = p + 1; q < n; ++q)
+				off += 2. * a[p*n + q] * a[p*n + q];
+		if(off <= 1.e-30 * norm)
+			break;
+
+		for(std::size_t p = 0; p < n; ++p)
+			for(std::size_t q = p + 1; q < n; ++q)
+			{
+				const double apq{ a[p*n + q] };
+				if(apq == 0.)
+					continue;
+
+				// the rotation that zeroes a[p][q]
+				const double theta{ (a[q*n + q] - a[p*n + p]) / (2. * apq) };
+				const double t{ (theta >= 0. ? 1. : -1.) /
+					(std::abs(theta) + std::sqrt(theta * theta + 1.)) };
+				const double c{ 1. / std::sqrt(t * t + 1.) };
+				const double s{ t * c };
+
+				for(std::size_t k = 0; k < n; ++k)
+				{
+					const double akp{ a[k*n + p] }, akq{ a[k*n + q] };
+					a[k*n + p] = c * akp - s * akq;
+					a[k*n + q] = s * akp + c * akq;
+				}
+				for(std::size_t k = 0; k < n; ++k)
+				{
+					const double apk{ a[p*n + k] }, aqk{ a[q*n + k] };
+					a[p*n + k] = c * apk - s * aqk;
+					a[q*n + k] = s * apk + c * aqk;
+				}
+				for(std::size_t k = 0; k < n; ++k)
+				{
+					const double vkp{ evecs[k*n + p] }, vkq{ evecs[k*n + q] };
+					evecs[k*n + p] = c * vkp - s * vkq;
+					evecs[k*n + q] = s * vkp + c * vkq;
+				}
+			}
+	}
+
+	evals.resize(n);
+	for(std::size_t j = 0; j < n; ++j)
+		evals[j] = a[j*n + j];
+}
+
+/**
+ * \brief The transmission function for one set of model parameters.
+ *
+ * Everything that does not depend on the energy (for a ring, the
+ * eigendecomposition of the Hamiltonian) is prepared on construction, so
+ * that the transmission can be evaluated at many energies in the bias
+ * window.
+ */
+class Transmission
+{
+private:
+	/// The site energy.
+	double eps;
+
+	/// The left site-electrode coupling.
+	double gammal;
+
+	/// The right site-electrode coupling.
+	double gammar;
+
+	/// The inter-site coupling.
+	double beta;
+
+	/// The number of sites (0 if there are none).
+	std::size_t nsites;
+
+	/// Whether the Hamiltonian was diagonalized (a ring).
+	bool spectral;
+
+	/// The eigenvalues of the Hamiltonian.
+	std::vector<double> lambda;
+
+	/// The first component of each eigenvector.
+	std::vector<double> v1;
+
+	/// The last component of each eigenvector.
+	std::vector<double> vN;
+
+	/**
+	 * \brief \f$(v_{1k}v_{Nl} - v_{1l}v_{Nk})^2\f$ for each pair of
+	 *    eigenvectors, \f$k<l\f$, packed by rows.
+	 */
+	std::vector<double> minors;
+
+	/// Workspace for \f$1/(E-\lambda_k)\f$.
+	mutable std::vector<double> inv;
+
+public:
+	/**
+	 * \brief Constructor preparing the transmission function.
+	 *
+	 * \param[in] eps_ The site energy.
+	 * \param[in] gammal_ The left site-electrode coupling.
+	 * \param[in] gammar_ The right site-electrode coupling.
+	 * \param[in] beta_ The inter-site coupling.
+	 * \param[in] nsites_ The number of sites (rounded to an integer).
+	 * \param[in] betaring The coupling between the first and last sites.
+	 */
+	Transmission(const double eps_, const double gammal_,
+		const double gammar_, const double beta_, const double nsites_,
+		const double betaring)
+		: eps(eps_), gammal(gammal_), gammar(gammar_), beta(beta_),
+		  nsites(0), spectral(false)
+	{
+		if(!(nsites_ >= 0.5))
+			return;
+		nsites = static_cast<std::size_t>(std::lround(nsites_));
+
+		// with two sites, the ring coupling is another inter-site coupling
+		if(nsites == 2)
+			beta += betaring;
+
+		if(nsites < 3 || betaring == 0.)
+			return;
+
+		// diagonalize the Hamiltonian of the ring
+		spectral = true;
+		std::vector<double> h(nsites * nsites, 0.), evecs;
+		for(std::size_t j = 0; j < nsites; ++j)
+		{
+			h[j*nsites + j] = eps;
+			if(j + 1 < nsites)
+				h[j*nsites + j + 1] = h[(j + 1)*nsites + j] = beta;
+		}
+		h[nsites - 1] += betaring;
+		h[(nsites - 1)*nsites] += betaring;
+
+		symmetric_eigensystem(h, nsites, lambda, evecs);
+
+		v1.assign(evecs.begin(), evecs.begin() + nsites);
+		vN.assign(evecs.end() - nsites, evecs.end());
+		minors.reserve(nsites * (nsites - 1) / 2);
+		for(std::size_t k = 0; k < nsites; ++k)
+			for(std::size_t l = k + 1; l < nsites; ++l)
+			{
+				const double m{ v1[k] * vN[l] - v1[l] * vN[k] };
+				minors.push_back(m * m);
+			}
+		inv.resize(nsites);
+	}
+
+	/**
+	 * \brief Evaluates the transmission.
+	 *
+	 * \param[in] e The energy of the incident electron.
+	 * \return The transmission, or molstat::NoObservableValue if there are
+	 *    no sites.
+	 */
+	double operator() (const double e) const
+	{
+		if(nsites == 0)
+			return NoObservableValue;
+		if(gammal * gammar == 0.)
+			return 0.;
+
+		if(!spectral)
+		{
+			// the recursion for a tridiagonal Hamiltonian, accumulating
+			// |G_{1N}|^2 one site at a time
+			const double z{ e - eps };
+
+			if(nsites == 1)
+				return gammal * gammar /
+					std::norm(std::complex<double>(z, 0.5 * (gammal + gammar)));
+
+			std::complex<double> r(z, 0.5 * gammal);
+			double g{ 1. / std::norm(r) };
+			for(std::size_t k = 1; k < nsites; ++k)
+			{
+				const std::complex<double> a(z,
+					k + 1 == nsites ? 0.5 * gammar : 0.);
+				r = a - beta * beta / r;
+				g *= beta * beta / std::norm(r);
+			}
+
+			return gammal * gammar * g;
+		}
+
+		// the Green's function of the isolated ring, from its spectrum; an
+		// energy at an eigenvalue is nudged (the limit is finite)
+		const double tiny{ 1.e-12 * (1. + std::abs(e)) };
+		double g11{ 0. }, gNN{ 0. }, g1N{ 0. }, det{ 0. };
+		for(std::size_t k = 0; k < nsites; ++k)
+		{
+			double d{ e - lambda[k] };
+			if(std::abs(d) < tiny)
+				d = d < 0. ? -tiny : tiny;
+			inv[k] = 1. / d;
+
+			g11 += v1[k] * v1[k] * inv[k];
+			gNN += vN[k] * vN[k] * inv[k];
+			g1N += v1[k] * vN[k] * inv[k];
+		}
+
+		// g11*gNN - g1N^2 without cancellation (Cauchy-Binet)
+		std::size_t kl{ 0 };
+		for(std::size_t k = 0; k < nsites; ++k)
+			for(std::size_t l = k + 1; l < nsites; ++l, ++kl)
+				det += minors[kl] * inv[k] * inv[l];
+
+		const std::complex<double> denom(1. - 0.25 * gammal * gammar * det,
+			0.5 * (gammal * g11 + gammar * gNN));
+
+		return gammal * gammar * g1N * g1N / std::norm(denom);
+	}
+
+	/**
+	 * \brief Integrates the transmission over the Fermi window.
+	 *
+	 * At zero temperature, the window is the bias window. Otherwise, the
+	 * transmission is weighted by the difference of the Fermi functions,
+	 * which is negligible more than \f$40k_\mathrm{B}T\f$ outside the bias
+	 * window.
+	 *
+	 * \param[in] ef The Fermi energy.
+	 * \param[in] V The applied bias.
+	 * \param[in] kT The thermal energy.
+	 * \param[in] order The number of Gauss-Legendre points; 0 for adaptive
+	 *    quadrature.
+	 * \param[in] epsabs The absolute tolerance for adaptive quadrature.
+	 * \param[in] epsrel The relative tolerance for adaptive quadrature.
+	 * \return The electric current.
+	 */
+	double current(const double ef, const double V, const double kT,
+		const std::size_t order, const double epsabs, const double epsrel)
+		const
+	{
+		if(nsites == 0)
+			return NoObservableValue;
+
+		const double muL{ ef + 0.5*V }, muR{ ef - 0.5*V };
+		const bool thermal{ kT > 0. };
+		const auto integrand = [this, muL, muR, kT, thermal] (double E)
+			-> double
+		{
+			if(!thermal)
+				return (*this)(E);
+
+			return (*this)(E) * (1. / (1. + std::exp((E - muL) / kT))
+				- 1. / (1. + std::exp((E - muR) / kT)));
+		};
+
+		double a{ muR }, b{ muL };
+		if(thermal)
+		{
+			a = std::min(muL, muR) - 40.*kT;
+			b = std::max(muL, muR) + 40.*kT;
+		}
+
+		// fixed-order quadrature; each thread keeps its rule
+		if(order > 0)
+		{
+			static thread_local GaussLegendre rule{ order };
+			if(rule.numPoints() != order)
+				rule = GaussLegendre(order);
+
+			return rule.integrate(integrand, a, b);
+		}
+
+		// adaptive quadrature; each thread keeps its workspace
+		static thread_local AdaptiveGaussKronrod<1> quad{ 1000 };
+
+		return quad.integrate(
+			[&integrand] (double E, AdaptiveGaussKronrod<1>::Values &f) -> void
+			{
+				f[0] = integrand(E);
+			}, a, b, epsabs, epsrel)[0];
+	}
+};
+
+/// \cond
+using Model = TightBindingChannel;
+
+MOLSTAT_BATCH_KERNEL
+void ZeroBiasGKernel(std::size_t n, const double *ef, const double *eps,
+	const double *gammal, const double *gammar, const double *beta,
+	const double *nsites, const double *betaring, double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		out[t] = Transmission(eps[t], gammal[t], gammar[t], beta[t], nsites[t],
+			betaring[t])(ef[t]);
+	}
+}
+
+MOLSTAT_BATCH_KERNEL
+void DiffGKernel(std::size_t n, const double *ef, const double *V,
+	const double *eps, const double *gammal, const double *gammar,
+	const double *beta, const double *nsites, const double *betaring,
+	double *out)
+{
+	for(std::size_t t = 0; t < n; ++t)
+	{
+		const Transmission trans(eps[t], gammal[t], gammar[t], beta[t],
+			nsites[t], betaring[t]);
+
+		out[t] = 0.5 * trans(ef[t] + 0.5*V[t])
+			+ 0.5 * trans(ef[t] - 0.5*V[t]);
+	}
+}
+/// \endcond
+
+} // anonymous namespace
+
+TightBindingChannel::TightBindingChannel()
+{
+	using Params = const double *const *;
+
+	setBatchObservableKernel<ZeroBiasConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			ZeroBiasGKernel(n, params[Index_EF], params[Index_epsilon],
+				params[Index_gammaL], params[Index_gammaR], params[Index_beta],
+				params[Index_nsites], params[Index_betaring], out);
+		});
+	setBatchObservableKernel<DifferentialConductance, Model>(
+		[] (const Model &model, Params params, std::size_t n, double *out)
+			-> void
+		{
+			DiffGKernel(n, params[Index_EF], params[Index_V],
+				params[Index_epsilon], params[Index_gammaL],
+				params[Index_gammaR], params[Index_beta], params[Index_nsites],
+				params[Index_betaring], out);
+		});
+}
+
+std::vector<std::string> TightBindingChannel::get_names() const
+{
+	std::vector<std::string> ret(6);
+
+	// subtract three because we expect 3 parameters from the TransportJunction
+	ret[Index_epsilon - 3] = "epsilon";
+	ret[Index_gammaL - 3] = "gammal";
+	ret[Index_gammaR - 3] = "gammar";
+	ret[Index_beta - 3] = "beta";
+	ret[Index_nsites - 3] = "nsites";
+	ret[Index_betaring - 3] = "betaring";
+
+	return ret;
+}
+
+double TightBindingChannel::transmission(const double e, const double eps,
+	const double gammal, const double gammar, const double beta,
+	const double nsites, const double betaring)
+{
+	return Transmission(eps, gammal, gammar, beta, nsites, betaring)(e);
+}
+
+double TightBindingChannel::ECurrent(const std::valarray<double> &params)
+	const
+{
+	// unpack the parameters
+	const double &ef = params[Index_EF];
+	const double &V = params[Index_V];
+
+	return Transmission(params[Index_epsilon], params[Index_gammaL],
+		params[Index_gammaR], params[Index_beta], params[Index_nsites],
+		params[Index_betaring])
+		.current(ef, V, params[Index_kT], quadrature_order,
+			quadrature_epsabs, quadrature_epsrel);
+}
+
+double TightBindingChannel::StaticG(const std::valarray<double> &params) const
+{
+	// unpack the parameters
+	const double &V = params[Index_V];
+
+	return ECurrent(params) / V;
+}
+
+double TightBindingChannel::ZeroBiasG(const std::valarray<double> &params)
+	const
+{
+	return transmission(params[Index_EF], params[Index_epsilon],
+		params[Index_gammaL], params[Index_gammaR], params[Index_beta],
+		params[Index_nsites], params[Index_betaring]);
+}
+
+double TightBindingChannel::DiffG(const std::valarray<double> &params) const
+{
+	// unpack the parameters
+	const double &ef = params[Index_EF];
+	const double &V = params[Index_V];
+
+	const Transmission trans(params[Index_epsilon], params[Index_gammaL],
+		params[Index_gammaR], params[Index_beta], params[Index_nsites],
+		params[Index_betaring]);
+
+	return 0.5*trans(ef + 0.5*V) + 0.5*trans(ef - 0.5*V);
+}
+
+FusedObservableFunction TightBindingChannel::getFusedObservableFunction(
+	const std::vector<ObservableIndex> &obs) const
+{
+	// the quantity stored in each output
+	enum class Output { Current, StaticG, ZeroBiasG, DiffG };
+	std::vector<Output> outputs;
+
+	for(const ObservableIndex &o : obs)
+	{
+		// tabulated observables must use their tables
+		if(tabulated_observables.count(o) > 0)
+			return FusedObservableFunction();
+
+		if(o == GetObservableIndex<ElectricCurrent>())
+			outputs.push_back(Output::Current);
+		else if(o == GetObservableIndex<StaticConductance>())
+			outputs.push_back(Output::StaticG);
+		else if(o == GetObservableIndex<ZeroBiasConductance>())
+			outputs.push_back(Output::ZeroBiasG);
+		else if(o == GetObservableIndex<DifferentialConductance>())
+			outputs.push_back(Output::DiffG);
+		else
+			return FusedObservableFunction();
+	}
+
+	// nothing to share with only one observable
+	if(outputs.size() < 2)
+		return FusedObservableFunction();
+
+	return [outputs] (const std::valarray<double> &params, double *out)
+		-> void
+	{
+		const double &ef = params[Index_EF];
+		const double &V = params[Index_V];
+
+		const Transmission trans(params[Index_epsilon], params[Index_gammaL],
+			params[Index_gammaR], params[Index_beta], params[Index_nsites],
+			params[Index_betaring]);
+
+		// the current is calculated (at most) once
+		bool have_current{ false };
+		double current{ 0. };
+
+		for(std::size_t j = 0; j < outputs.size(); ++j)
+		{
+			if((outputs[j] == Output::Current ||
+				outputs[j] == Output::StaticG) && !have_current)
+			{
+				current = trans.current(ef, V, params[Index_kT],
+					quadrature_order, quadrature_epsabs, quadrature_epsrel);
+				have_current = true;
+			}
+
+			switch(outputs[j])
+			{
+			case Output::Current:
+				out[j] = current;
+				break;
+			case Output::StaticG:
+				out[j] = current / V;
+				break;
+			case Output::ZeroBiasG:
+				out[j] = trans(ef);
+				break;
+			case Output::DiffG:
+				out[j] = 0.5*trans(ef + 0.5*V) + 0.5*trans(ef - 0.5*V);
+				break;
+			}
+		}
+	};
+}
+
+} // namespace molstat::transport
+} // namespace molstat
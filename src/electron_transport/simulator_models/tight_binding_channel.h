@@ -0,0 +1,200 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tight_binding_channel.h
+ * \brief Tight-binding channel with an N-site chain (or ring) that couples
+ *    asymmetrically to both electrodes. The chain does not drop voltage.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __tight_binding_channel_h__
+#define __tight_binding_channel_h__
+
+#include <cstddef>
+#include "observables.h"
+#include "junction.h"
+
+namespace molstat {
+namespace transport {
+
+/**
+ * \brief Simulator submodel for transport through an N-site tight-binding
+ *    chain whose end sites couple to the electrodes.
+ *
+ * Inherited model parameters (from molstat::transport::TransportJunction) are
+ * - `ef` (\f$E_\mathrm{F}\f$), the Fermi energy,
+ * - `v` (\f$V\f$), the applied bias,
+ * - `kt` (\f$k_\mathrm{B}T\f$), the thermal energy (for the current).
+ *
+ * Model parameters are
+ * - `epsilon` (\f$\varepsilon\f$), the site-energy,
+ * - `gammal` (\f$\Gamma_\mathrm{L}\f$), the coupling between the first site
+ *   and one electrode,
+ * - `gammar` (\f$\Gamma_\mathrm{R}\f$), the coupling between the last site
+ *   and the other electrode,
+ * - `beta` (\f$\beta\f$), the coupling between neighboring sites,
+ * - `nsites` (\f$N\f$), the number of sites (rounded to the nearest integer;
+ *   no observables are produced without any sites),
+ * - `betaring` (\f$\beta_\mathrm{r}\f$), the coupling between the first and
+ *   last sites; 0 for a linear chain.
+ *
+ * The Hamiltonian is \f$N\times N\f$ with \f$\varepsilon\f$ on the diagonal
+ * and \f$\beta\f$ on the first off-diagonals (plus \f$\beta_\mathrm{r}\f$ in
+ * the corners), and \f$\hat{\Sigma}_\mathrm{L}\f$ (\f$\hat{\Sigma}_\mathrm{R}\f$)
+ * is \f$-i\Gamma_\mathrm{L}/2\f$ (\f$-i\Gamma_\mathrm{R}/2\f$) on the first
+ * (last) site. The transmission function is
+ * \f[ T(E) = \Gamma_\mathrm{L} \Gamma_\mathrm{R} \left| G_{1N}(E) \right|^2, \f]
+ * where \f$\hat{G}(E) = (E - \hat{H} - \hat{\Sigma}_\mathrm{L} - \hat{\Sigma}_\mathrm{R})^{-1}\f$
+ * is the retarded Green's function. With \f$N=2\f$, this is
+ * molstat::transport::AsymTwoSiteChannel.
+ *
+ * Only one element of \f$\hat{G}\f$ is needed, and it is found without
+ * inverting a matrix.
+ * - For a chain, the Hamiltonian is tridiagonal and
+ *   \f[ G_{1N}(E) = \frac{\beta^{N-1}}{r_1 r_2 \cdots r_N}, \;\;\;\; r_1 = a_1, \;\;\;\; r_k = a_k - \frac{\beta^2}{r_{k-1}}, \f]
+ *   where \f$a_k\f$ is the \f$k\f$th diagonal element of
+ *   \f$E - \hat{H} - \hat{\Sigma}_\mathrm{L} - \hat{\Sigma}_\mathrm{R}\f$.
+ *   This costs \f$O(N)\f$ operations for each energy.
+ * - For a ring, \f$\hat{H}\f$ is diagonalized once for each set of model
+ *   parameters. The Green's function of the isolated molecule,
+ *   \f$g_{ij}(E) = \sum_k v_{ik}v_{jk}/(E-\lambda_k)\f$, then gives
+ *   \f[ G_{1N}(E) = \frac{g_{1N}}{\left( 1 + i\Gamma_\mathrm{L} g_{11}/2 \right) \left( 1 + i\Gamma_\mathrm{R} g_{NN}/2 \right) + \Gamma_\mathrm{L} \Gamma_\mathrm{R} g_{1N}^2 / 4} \f]
+ *   in \f$O(N^2)\f$ operations for each energy, regardless of how many
+ *   energies are needed in the bias window.
+ *
+ * - Differential conductance:
+ *   \f[ G_\mathrm{d}(V) = \frac{2e^2}{h} \frac{1}{2} \left[ T(E_\mathrm{F} + eV/2) + T(E_\mathrm{F} - eV/2) \right]. \f]
+ * - Electric current:
+ *   \f[ I(V) = \frac{2e}{h} \int_{E_\mathrm{F}-eV/2}^{E_\mathrm{F}+eV/2} \mathrm{d}E T(E), \f]
+ *   which is integrated numerically (see setStaticGQuadrature()). At finite
+ *   temperature, the transmission is instead weighted by the difference of
+ *   the electrodes' Fermi functions.
+ */
+class TightBindingChannel : public Channel,
+	public ElectricCurrent,
+	public ZeroBiasConductance,
+	public DifferentialConductance,
+	public StaticConductance
+{
+private:
+	/// The number of Gauss-Legendre points for the current; 0 for adaptive.
+	static std::size_t quadrature_order;
+
+	/// The absolute tolerance for adaptive quadrature.
+	static double quadrature_epsabs;
+
+	/// The relative tolerance for adaptive quadrature.
+	static double quadrature_epsrel;
+
+public:
+	/// Container index for the Fermi energy.
+	static const std::size_t Index_EF;
+
+	/// Container index for the applied bias.
+	static const std::size_t Index_V;
+
+	/// Container index for the thermal energy.
+	static const std::size_t Index_kT;
+
+	/// Container index for the site energy.
+	static const std::size_t Index_epsilon;
+
+	/// Container index for the left site-lead coupling.
+	static const std::size_t Index_gammaL;
+
+	/// Container index for the right site-lead coupling.
+	static const std::size_t Index_gammaR;
+
+	/// Container index for the inter-site coupling.
+	static const std::size_t Index_beta;
+
+	/// Container index for the number of sites.
+	static const std::size_t Index_nsites;
+
+	/// Container index for the coupling between the first and last sites.
+	static const std::size_t Index_betaring;
+
+protected:
+	virtual std::vector<std::string> get_names() const override;
+
+public:
+	/// Constructor registering the batch kernels for the observables.
+	TightBindingChannel();
+
+	virtual ~TightBindingChannel() = default;
+
+	/**
+	 * \brief Calculates the transmission for a set of model parameters.
+	 *
+	 * When several energies are needed for the same parameters, the
+	 * observables prepare the Hamiltonian once instead of calling this
+	 * function.
+	 *
+	 * \param[in] e The energy of the incident electron.
+	 * \param[in] eps The site energy.
+	 * \param[in] gammal The left site-electrode coupling.
+	 * \param[in] gammar The right site-electrode coupling.
+	 * \param[in] beta The inter-site coupling.
+	 * \param[in] nsites The number of sites.
+	 * \param[in] betaring The coupling between the first and last sites.
+	 * \return The transmission for this set of parameters, or
+	 *    molstat::NoObservableValue if there are no sites.
+	 */
+	static double transmission(const double e, const double eps,
+		const double gammal, const double gammar, const double beta,
+		const double nsites, const double betaring);
+
+	virtual double ECurrent(const std::valarray<double> &params) const override;
+	virtual double ZeroBiasG(const std::valarray<double> &params) const
+		override;
+	virtual double StaticG(const std::valarray<double> &params) const override;
+	virtual double DiffG(const std::valarray<double> &params) const override;
+
+	/**
+	 * \brief Sets the quadrature used for the electric current and static
+	 *    conductance.
+	 *
+	 * By default, adaptive Gauss-Kronrod quadrature is used with tolerance
+	 * 1e-9. When this accuracy is much finer than the histogram's bins, a
+	 * fixed-order Gauss-Legendre rule is considerably faster. This should be
+	 * called before simulating.
+	 *
+	 * The tolerances can instead be chosen from the precision needed by the
+	 * histogram (see the simulator's `precision` command); a relative
+	 * tolerance alone is then enough, and often much looser.
+	 *
+	 * \throw std::invalid_argument if a tolerance is negative or both are
+	 *    zero.
+	 *
+	 * \param[in] order The number of Gauss-Legendre points; 0 for adaptive
+	 *    quadrature.
+	 * \param[in] epsabs The absolute tolerance for adaptive quadrature.
+	 * \param[in] epsrel The relative tolerance for adaptive quadrature.
+	 */
+	static void setStaticGQuadrature(std::size_t order, double epsabs,
+		double epsrel);
+
+	/**
+	 * \brief Gets a function that calculates several observables together.
+	 *
+	 * The Hamiltonian is prepared once for each set of model parameters and
+	 * shared by all of the observables; the electric current is also shared
+	 * with the static conductance.
+	 *
+	 * \param[in] obs The observables.
+	 * \return The fused function, or an empty function if an observable is
+	 *    not provided by this channel.
+	 */
+	virtual FusedObservableFunction getFusedObservableFunction(
+		const std::vector<ObservableIndex> &obs) const override;
+};
+
+} // namespace molstat::transport
+} // namespace molstat
+
+#endif
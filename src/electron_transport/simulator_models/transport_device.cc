@@ -0,0 +1,156 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file transport_device.cc
+ * \brief Closed-form channel kernels for simulations on an accelerator (GPU).
+ *
+ * The GPU backend itself is in transport_device.cu, which is only compiled
+ * (by nvcc) when MolStat is configured with `--enable-cuda`.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <config.h>
+#include "transport_device.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace molstat {
+namespace transport {
+
+#if HAVE_CUDA
+/// \cond
+// defined in transport_device.cu
+std::shared_ptr<const DeviceBackend> MakeCudaChannelBackend();
+/// \endcond
+#endif
+
+std::shared_ptr<const DeviceBackend> GetGPUChannelBackend()
+{
+#if HAVE_CUDA
+	return MakeCudaChannelBackend();
+#else
+	return nullptr;
+#endif
+}
+
+/**
+ * \brief Determines if a distribution is normal (with nonzero width).
+ *
+ * \param[in] dist The distribution.
+ * \return True if the distribution is normal.
+ */
+static bool is_normal(const DeviceDistribution &dist)
+{
+	return dist.kind == DeviceDistribution::Normal && dist.b != 0.;
+}
+
+/**
+ * \brief Determines if a distribution is a single value.
+ *
+ * \param[in] dist The distribution.
+ * \return True if the distribution is constant (or normal with zero width).
+ */
+static bool is_fixed(const DeviceDistribution &dist)
+{
+	return dist.kind == DeviceDistribution::Constant ||
+		(dist.kind == DeviceDistribution::Normal && dist.b == 0.);
+}
+
+AnalyticCDF AnalyticChannelSolver::getCDF(const DeviceProgram &program,
+	std::size_t obs, std::string &reason) const
+{
+	const std::uint32_t first{ program.term_offsets.at(obs) },
+		last{ program.term_offsets.at(obs + 1) };
+	if(last - first != 1 ||
+		program.terms[first].kernel != SymOneSiteZeroBiasG)
+	{
+		reason = "Only the zero-bias conductance of one SymOneSiteChannel " \
+			"has a closed-form distribution.";
+		return AnalyticCDF();
+	}
+
+	const std::uint32_t *const i{ program.terms[first].params };
+	const DeviceDistribution &ef = program.distributions[i[0]],
+		&eps = program.distributions[i[1]],
+		&gamma = program.distributions[i[2]];
+
+	// the widths are the standard deviations; the distribution of g is
+	// symmetric in z and in gamma, so only the magnitudes of the means matter
+	const auto width = [] (const DeviceDistribution &dist) -> double
+	{
+		return dist.kind == DeviceDistribution::Normal ? std::abs(dist.b) : 0.;
+	};
+	const double zmean{ std::abs(ef.a - eps.a) };
+
+	if(is_fixed(gamma) && (is_normal(ef) || is_normal(eps)) &&
+		(is_fixed(ef) || is_normal(ef)) && (is_fixed(eps) || is_normal(eps)))
+	{
+		if(gamma.a == 0.)
+		{
+			reason = "The coupling is zero.";
+			return AnalyticCDF();
+		}
+
+		// resonant: z is normal, and g <= G when |z| >= r(G)
+		const double g2{ gamma.a * gamma.a },
+			scale{ M_SQRT2 * std::hypot(width(ef), width(eps)) };
+		return [g2, zmean, scale] (double g) -> double
+		{
+			if(g <= 0.)
+				return 0.;
+			if(g >= 1.)
+				return 1.;
+
+			const double r{ std::sqrt(g2 * SymOneSiteResonantRatio(g)) };
+			return 0.5 * std::erfc((r - zmean) / scale)
+				+ 0.5 * std::erfc((r + zmean) / scale);
+		};
+	}
+
+	if(is_fixed(ef) && is_fixed(eps) && is_normal(gamma))
+	{
+		// nonresonant: gamma is normal, and g <= G when |gamma| <= s(G)
+		const double z2{ zmean * zmean }, mean{ std::abs(gamma.a) },
+			scale{ M_SQRT2 * width(gamma) };
+		return [z2, mean, scale] (double g) -> double
+		{
+			if(g >= 1.)
+				return 1.;
+			if(g <= 0. || z2 == 0.)
+				return 0.;
+
+			const double s{ std::sqrt(z2 * SymOneSiteNonresonantRatio(g)) };
+			return 0.5 * std::erfc((mean - s) / scale)
+				- 0.5 * std::erfc((mean + s) / scale);
+		};
+	}
+
+	reason = "The conductance of a SymOneSiteChannel has a closed-form " \
+		"distribution only if epsilon (or ef) is normal with gamma constant, " \
+		"or gamma is normal with epsilon and ef constant.";
+	return AnalyticCDF();
+}
+
+DeviceTerm MakeDeviceTerm(DeviceChannelKernel kernel,
+	std::initializer_list<std::size_t> params)
+{
+	if(params.size() > DeviceMaxTermParameters)
+		throw std::logic_error("Too many parameters for a device term.");
+
+	DeviceTerm ret{};
+	ret.kernel = kernel;
+
+	std::size_t j{ 0 };
+	for(const std::size_t p : params)
+		ret.params[j++] = static_cast<std::uint32_t>(p);
+
+	return ret;
+}
+
+} // namespace molstat::transport
+} // namespace molstat
@@ -0,0 +1,275 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file transport_device.cu
+ * \brief The CUDA backend for the closed-form channel kernels.
+ *
+ * Each device thread simulates one trial with molstat::DeviceSimulateTrial
+ * and molstat::transport::DeviceChannelEvaluator, the same code that the
+ * host backend runs. The observables are copied back to the host, where
+ * they are binned into the histograms.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "transport_device.h"
+#include <algorithm>
+#include <cuda_runtime.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace molstat {
+namespace transport {
+
+/// \cond
+namespace {
+
+/// Threads per block.
+constexpr unsigned BlockSize = 128;
+
+__global__ void SimulateKernel(const DeviceProgramView program,
+	const std::uint64_t first, const std::size_t ntrials, double *out)
+{
+	const std::size_t t{ blockIdx.x * std::size_t(blockDim.x) + threadIdx.x };
+	if(t >= ntrials)
+		return;
+
+	double params[DeviceMaxParameters];
+	DeviceSimulateTrial(program, DeviceChannelEvaluator{}, first + t, params,
+		out + t*program.nobs);
+}
+
+/**
+ * \brief Throws if a CUDA call failed.
+ *
+ * \throw std::runtime_error if the call failed.
+ *
+ * \param[in] err The return value of the call.
+ */
+void check(const cudaError_t err)
+{
+	if(err != cudaSuccess)
+		throw std::runtime_error(std::string("CUDA error: ") +
+			cudaGetErrorString(err));
+}
+
+/**
+ * \brief An array in the device's memory, which grows as needed.
+ *
+ * \tparam T The type of the elements.
+ */
+template<typename T>
+class DeviceArray
+{
+private:
+	/// The array on the device.
+	T *dev;
+
+	/// The number of elements allocated.
+	std::size_t capacity;
+
+public:
+	DeviceArray() : dev(nullptr), capacity(0)
+	{
+	}
+
+	DeviceArray(const DeviceArray &) = delete;
+	DeviceArray &operator=(const DeviceArray &) = delete;
+
+	~DeviceArray()
+	{
+		cudaFree(dev);
+	}
+
+	/**
+	 * \brief Makes room for at least `n` elements.
+	 *
+	 * The contents are not kept when the array grows.
+	 *
+	 * \param[in] n The number of elements.
+	 * \return The array on the device.
+	 */
+	T *reserve(const std::size_t n)
+	{
+		if(n > capacity)
+		{
+			cudaFree(dev);
+			dev = nullptr;
+			capacity = 0;
+
+			check(cudaMalloc(&dev, n * sizeof(T)));
+			capacity = n;
+		}
+
+		return dev;
+	}
+
+	/**
+	 * \brief Copies an array from the host.
+	 *
+	 * \param[in] host The array on the host.
+	 * \param[in] n The number of elements.
+	 * \return The array on the device.
+	 */
+	T *assign(const T *host, const std::size_t n)
+	{
+		reserve(n);
+		check(cudaMemcpy(dev, host, n * sizeof(T), cudaMemcpyHostToDevice));
+		return dev;
+	}
+};
+
+/**
+ * \brief Determines if two programs are the same simulation.
+ *
+ * \param[in] a One program.
+ * \param[in] b The other program.
+ * \return True if the programs have the same key, distributions, and terms.
+ */
+bool same_program(const DeviceProgram &a, const DeviceProgram &b)
+{
+	const auto same_dist = [] (const DeviceDistribution &x,
+		const DeviceDistribution &y) -> bool
+	{
+		return x.kind == y.kind && x.a == y.a && x.b == y.b;
+	};
+	const auto same_term = [] (const DeviceTerm &x, const DeviceTerm &y)
+		-> bool
+	{
+		return x.kernel == y.kernel &&
+			std::equal(x.params, x.params + DeviceMaxTermParameters, y.params);
+	};
+
+	return a.key == b.key && a.term_offsets == b.term_offsets &&
+		a.distributions.size() == b.distributions.size() &&
+		std::equal(a.distributions.begin(), a.distributions.end(),
+			b.distributions.begin(), same_dist) &&
+		a.terms.size() == b.terms.size() &&
+		std::equal(a.terms.begin(), a.terms.end(), b.terms.begin(), same_term);
+}
+
+/**
+ * \brief Runs the channel kernels on the current CUDA device.
+ *
+ * Calls are serialized; the device does the parallel work. The program is
+ * copied to the device when it first runs (and again only if a different
+ * program runs), and the device's buffer for the observables is kept
+ * between batches.
+ */
+class CudaChannelBackend : public DeviceBackend
+{
+private:
+	/// The device.
+	int device;
+
+	/// The name of the device.
+	std::string name;
+
+	/// Serializes the calls from several host threads.
+	mutable std::mutex mutex;
+
+	/// The program on the device.
+	mutable DeviceProgram uploaded;
+
+	/// Whether or not a program has been copied to the device.
+	mutable bool have_program;
+
+	/// The view of the program on the device.
+	mutable DeviceProgramView view;
+
+	/// The distributions on the device.
+	mutable DeviceArray<DeviceDistribution> dists;
+
+	/// The term offsets on the device.
+	mutable DeviceArray<std::uint32_t> offsets;
+
+	/// The terms on the device.
+	mutable DeviceArray<DeviceTerm> terms;
+
+	/// The observables on the device.
+	mutable DeviceArray<double> dout;
+
+	/**
+	 * \brief Copies a program to the device, unless it is already there.
+	 *
+	 * The mutex must be held.
+	 *
+	 * \param[in] program The program.
+	 */
+	void upload(const DeviceProgram &program) const
+	{
+		if(have_program && same_program(program, uploaded))
+			return;
+
+		have_program = false;
+		view = program.view();
+		view.distributions = dists.assign(program.distributions.data(),
+			program.distributions.size());
+		view.term_offsets = offsets.assign(program.term_offsets.data(),
+			program.term_offsets.size());
+		view.terms = terms.assign(program.terms.data(),
+			program.terms.size());
+
+		uploaded = program;
+		have_program = true;
+	}
+
+public:
+	CudaChannelBackend(const int device_) : device(device_),
+		have_program(false), view()
+	{
+		cudaDeviceProp prop;
+		check(cudaGetDeviceProperties(&prop, device));
+		name = prop.name;
+	}
+
+	virtual void simulate(const DeviceProgram &program, std::uint64_t first,
+		std::size_t ntrials, double *out) const override
+	{
+		if(ntrials == 0)
+			return;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		check(cudaSetDevice(device));
+		upload(program);
+
+		const std::size_t nout{ ntrials * view.nobs };
+		double *const buffer{ dout.reserve(nout) };
+
+		const unsigned nblocks{ static_cast<unsigned>(
+			(ntrials + BlockSize - 1) / BlockSize) };
+		SimulateKernel<<<nblocks, BlockSize>>>(view, first, ntrials, buffer);
+		check(cudaGetLastError());
+
+		check(cudaMemcpy(out, buffer, nout * sizeof(double),
+			cudaMemcpyDeviceToHost));
+	}
+
+	virtual std::string info() const override
+	{
+		return "CUDA device " + std::to_string(device) + " (" + name + ")";
+	}
+};
+
+} // anonymous namespace
+/// \endcond
+
+std::shared_ptr<const DeviceBackend> MakeCudaChannelBackend()
+{
+	int ndevices{ 0 };
+	if(cudaGetDeviceCount(&ndevices) != cudaSuccess || ndevices == 0)
+		return nullptr;
+
+	int device{ 0 };
+	check(cudaGetDevice(&device));
+
+	return std::make_shared<CudaChannelBackend>(device);
+}
+
+} // namespace molstat::transport
+} // namespace molstat
@@ -0,0 +1,198 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file transport_device.h
+ * \brief Closed-form channel kernels for simulations on an accelerator (GPU),
+ *    and the backends that run them.
+ *
+ * The kernels are the zero-temperature, closed-form observables of the
+ * simple channels. Channels describe their observables with these kernels
+ * (see molstat::SimulateModel::appendDeviceTerms), and the
+ * molstat::transport::TransportJunction sums them over its channels.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __transport_device_h__
+#define __transport_device_h__
+
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <general/simulator_tools/device_simulator.h>
+#include <general/simulator_tools/analytic_histogram.h>
+#include <electron_transport/channel_kernels.h>
+
+namespace molstat {
+namespace transport {
+
+/**
+ * \brief The kernels of molstat::transport::DeviceChannelEvaluator.
+ *
+ * The parameters of each kernel (see molstat::DeviceTerm::params) are listed
+ * with it.
+ */
+enum DeviceChannelKernel : std::uint32_t
+{
+	/// SymOneSiteChannel, \f$G_0\f$: `ef`, `epsilon`, `gamma`.
+	SymOneSiteZeroBiasG,
+
+	/// SymOneSiteChannel, \f$G_\mathrm{d}\f$: `ef`, `v`, `epsilon`, `gamma`,
+	/// `a`.
+	SymOneSiteDiffG,
+
+	/// SymOneSiteChannel, \f$I\f$ (zero temperature): `ef`, `v`, `epsilon`,
+	/// `gamma`, `a`.
+	SymOneSiteECurrent,
+
+	/// SymOneSiteChannel, \f$G_\mathrm{s}\f$ (zero temperature): `ef`, `v`,
+	/// `epsilon`, `gamma`, `a`, `nm`.
+	SymOneSiteStaticG,
+
+	/// SymInterferenceChannel, \f$G_0\f$: `ef`, `epsilon`, `gamma`, `beta`.
+	SymInterferenceZeroBiasG,
+
+	/// SymTwoSiteChannel, \f$G_0\f$: `ef`, `epsilon`, `gamma`, `beta`.
+	SymTwoSiteZeroBiasG,
+
+	/// SymTwoSiteChannel, \f$G_\mathrm{d}\f$: `ef`, `v`, `epsilon`, `gamma`,
+	/// `beta`.
+	SymTwoSiteDiffG,
+
+	/// AsymTwoSiteChannel, \f$G_0\f$: `ef`, `epsilon`, `gammal`, `gammar`,
+	/// `beta`.
+	AsymTwoSiteZeroBiasG,
+
+	/// AsymTwoSiteChannel, \f$G_\mathrm{d}\f$: `ef`, `v`, `epsilon`,
+	/// `gammal`, `gammar`, `beta`.
+	AsymTwoSiteDiffG
+};
+
+/**
+ * \brief Evaluates the channel kernels; see molstat::DeviceSimulateTrial.
+ *
+ * The formulas are those of the channels' observable functions (see
+ * channel_kernels.h); currents are in units where \f$2e/h = 1\f$
+ * (molstat::transport::TransportJunction::qc).
+ */
+struct DeviceChannelEvaluator
+{
+	/**
+	 * \brief Evaluates one term.
+	 *
+	 * \param[in] term The term.
+	 * \param[in] p The model parameters of the trial.
+	 * \return The value of the term.
+	 */
+	MOLSTAT_HOST_DEVICE double operator()(const DeviceTerm &term,
+		const double *p) const
+	{
+		const std::uint32_t *const i{ term.params };
+
+		switch(term.kernel)
+		{
+		case SymOneSiteZeroBiasG:
+			return SymOneSiteTransmission(p[i[0]], 0., p[i[1]], p[i[2]], 0.);
+
+		case SymOneSiteDiffG:
+			return (0.5 - p[i[4]]) * SymOneSiteTransmission(p[i[0]] +
+					0.5*p[i[1]], p[i[1]], p[i[2]], p[i[3]], p[i[4]])
+				+ (0.5 + p[i[4]]) * SymOneSiteTransmission(p[i[0]] -
+					0.5*p[i[1]], p[i[1]], p[i[2]], p[i[3]], p[i[4]]);
+
+		case SymOneSiteECurrent:
+		case SymOneSiteStaticG:
+		{
+			const double current{ SymOneSiteCurrent(p[i[0]], p[i[1]], p[i[2]],
+				p[i[3]], p[i[4]]) };
+
+			if(term.kernel == SymOneSiteECurrent)
+				return current;
+			return p[i[5]] * current / p[i[1]];
+		}
+
+		case SymInterferenceZeroBiasG:
+			return SymInterferenceTransmission(p[i[0]] - p[i[1]], p[i[2]],
+				p[i[3]]);
+
+		case SymTwoSiteZeroBiasG:
+			return TwoSiteTransmission(p[i[0]], p[i[1]], p[i[2]], p[i[2]],
+				p[i[3]]);
+
+		case SymTwoSiteDiffG:
+			return 0.5*TwoSiteTransmission(p[i[0]] + 0.5*p[i[1]], p[i[2]],
+					p[i[3]], p[i[3]], p[i[4]])
+				+ 0.5*TwoSiteTransmission(p[i[0]] - 0.5*p[i[1]], p[i[2]],
+					p[i[3]], p[i[3]], p[i[4]]);
+
+		case AsymTwoSiteZeroBiasG:
+			return TwoSiteTransmission(p[i[0]], p[i[1]], p[i[2]], p[i[3]],
+				p[i[4]]);
+
+		case AsymTwoSiteDiffG:
+			return 0.5*TwoSiteTransmission(p[i[0]] + 0.5*p[i[1]], p[i[2]],
+					p[i[3]], p[i[4]], p[i[5]])
+				+ 0.5*TwoSiteTransmission(p[i[0]] - 0.5*p[i[1]], p[i[2]],
+					p[i[3]], p[i[4]], p[i[5]]);
+		}
+
+		// unknown kernel
+		return nan("");
+	}
+};
+
+/// Backend that runs the channel kernels on the host.
+using HostChannelBackend = HostDeviceBackend<DeviceChannelEvaluator>;
+
+/**
+ * \brief Gets the backend that runs the channel kernels on a GPU.
+ *
+ * \return The backend, or nullptr if MolStat was built without GPU support
+ *    (see the `--enable-cuda` option of `configure`) or no GPU is available.
+ */
+std::shared_ptr<const DeviceBackend> GetGPUChannelBackend();
+
+/**
+ * \brief Finds the distribution of the zero-bias conductance of a
+ *    symmetric one-site channel in closed form.
+ *
+ * The observable must be one molstat::transport::SymOneSiteZeroBiasG term,
+ * \f$g = \Gamma^2 / (z^2 + \Gamma^2)\f$ with \f$z = E_\mathrm{F} -
+ * \varepsilon\f$, and either
+ * - \f$\Gamma\f$ is constant and \f$E_\mathrm{F}\f$ and
+ *   \f$\varepsilon\f$ are constant or normal (resonant tunneling; see
+ *   molstat::transport::SymmetricResonantFitModel), or
+ * - \f$E_\mathrm{F}\f$ and \f$\varepsilon\f$ are constant and
+ *   \f$\Gamma\f$ is normal (nonresonant tunneling; see
+ *   molstat::transport::SymmetricNonresonantFitModel).
+ *
+ * The other model parameters do not affect the observable.
+ */
+class AnalyticChannelSolver : public AnalyticSolver
+{
+public:
+	virtual ~AnalyticChannelSolver() = default;
+
+	virtual AnalyticCDF getCDF(const DeviceProgram &program, std::size_t obs,
+		std::string &reason) const override;
+};
+
+/**
+ * \brief Makes a device kernel term.
+ *
+ * \param[in] kernel The kernel.
+ * \param[in] params The indices of the kernel's parameters.
+ * \return The term.
+ */
+DeviceTerm MakeDeviceTerm(DeviceChannelKernel kernel,
+	std::initializer_list<std::size_t> params);
+
+} // namespace molstat::transport
+} // namespace molstat
+
+#endif
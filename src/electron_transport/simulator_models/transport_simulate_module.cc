@@ -12,7 +12,7 @@
  * \date October 2014
  */
 
-#include <general/string_tools.h>
+#include <config.h>
 #include "transport_simulate_module.h"
 #include "observables.h"
 #include "junction.h"
@@ -23,66 +23,73 @@
 #include "asym_two_site_channel.h"
 #include "rectangular_barrier.h"
 #include "sym_interference.h"
+#include "tight_binding_channel.h"
+#include "image_charge_channel.h"
+#include "switching_channel.h"
+#include "aggregate_channel.h"
 
 namespace molstat {
 namespace transport {
 
 void load_models(
-	std::map<std::string,
-	         SimulateModelFactoryFunction> &models)
+	NameRegistry<SimulateModelFactoryFunction> &models)
 {
-	models.emplace(
-		to_lower("TransportJunction"),
-		GetSimulateModelFactory<TransportJunction>() );
+	models.add(MOLSTAT_REGISTRY_KEY("TransportJunction"),
+		GetSimulateModelFactory<TransportJunction>());
 
-	models.emplace(
-		to_lower("SymmetricOneSiteChannel"),
-		GetSimulateModelFactory<SymOneSiteChannel>() );
+	models.add(MOLSTAT_REGISTRY_KEY("SymmetricOneSiteChannel"),
+		GetSimulateModelFactory<SymOneSiteChannel>());
 
-	models.emplace(
-		to_lower("AsymmetricOneSiteChannel"),
-		GetSimulateModelFactory<AsymOneSiteChannel>() );
+	models.add(MOLSTAT_REGISTRY_KEY("AsymmetricOneSiteChannel"),
+		GetSimulateModelFactory<AsymOneSiteChannel>());
 
-	models.emplace(
-		to_lower("SymmetricTwoSiteChannel"),
-		GetSimulateModelFactory<SymTwoSiteChannel>() );
+	models.add(MOLSTAT_REGISTRY_KEY("SymmetricTwoSiteChannel"),
+		GetSimulateModelFactory<SymTwoSiteChannel>());
 
-	models.emplace(
-		to_lower("AsymmetricTwoSiteChannel"),
-		GetSimulateModelFactory<AsymTwoSiteChannel>() );
+	models.add(MOLSTAT_REGISTRY_KEY("AsymmetricTwoSiteChannel"),
+		GetSimulateModelFactory<AsymTwoSiteChannel>());
 
-	models.emplace(
-		to_lower("RectangularBarrierChannel"),
-		GetSimulateModelFactory<RectangularBarrier>() );
+	models.add(MOLSTAT_REGISTRY_KEY("TightBindingChannel"),
+		GetSimulateModelFactory<TightBindingChannel>());
 
-	models.emplace(
-		to_lower("InterferenceChannel"),
-		GetSimulateModelFactory<SymInterferenceChannel>() );
+	models.add(MOLSTAT_REGISTRY_KEY("RectangularBarrierChannel"),
+		GetSimulateModelFactory<RectangularBarrier>());
+
+	models.add(MOLSTAT_REGISTRY_KEY("InterferenceChannel"),
+		GetSimulateModelFactory<SymInterferenceChannel>());
+
+	models.add(MOLSTAT_REGISTRY_KEY("ImageChargeChannel"),
+		GetSimulateModelFactory<ImageChargeChannel>());
+
+	models.add(MOLSTAT_REGISTRY_KEY("AggregateChannel"),
+		GetSimulateModelFactory<AggregateChannel>());
+
+#if HAVE_CVODE
+	models.add(MOLSTAT_REGISTRY_KEY("SwitchingChannel"),
+		GetSimulateModelFactory<SwitchingChannel>());
+#endif
 }
 
 void load_observables(
-	std::map<std::string,
-	         ObservableIndex> &observables)
+	NameRegistry<ObservableIndex> &observables)
 {
-	observables.emplace(
-		to_lower("AppliedBias"),
-		GetObservableIndex<AppliedBias>() );
+	observables.add(MOLSTAT_REGISTRY_KEY("AppliedBias"),
+		GetObservableIndex<AppliedBias>());
+
+	observables.add(MOLSTAT_REGISTRY_KEY("ElectricCurrent"),
+		GetObservableIndex<ElectricCurrent>());
 
-	observables.emplace(
-		to_lower("ElectricCurrent"),
-		GetObservableIndex<ElectricCurrent>() );
+	observables.add(MOLSTAT_REGISTRY_KEY("StaticConductance"),
+		GetObservableIndex<StaticConductance>());
 
-	observables.emplace(
-		to_lower("StaticConductance"),
-		GetObservableIndex<StaticConductance>() );
+	observables.add(MOLSTAT_REGISTRY_KEY("ZeroBiasConductance"),
+		GetObservableIndex<ZeroBiasConductance>());
 
-	observables.emplace(
-		to_lower("ZeroBiasConductance"),
-		GetObservableIndex<ZeroBiasConductance>() );
+	observables.add(MOLSTAT_REGISTRY_KEY("ZeroBiasThermopower"),
+		GetObservableIndex<ZeroBiasThermopower>());
 
-	observables.emplace(
-		to_lower("DifferentialConductance"),
-		GetObservableIndex<DifferentialConductance>() );
+	observables.add(MOLSTAT_REGISTRY_KEY("DifferentialConductance"),
+		GetObservableIndex<DifferentialConductance>());
 }
 
 } // namespace molstat::transport
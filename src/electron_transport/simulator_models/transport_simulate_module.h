@@ -15,8 +15,7 @@
 #ifndef __transport_simulate_module_h__
 #define __transport_simulate_module_h__
 
-#include <string>
-#include <map>
+#include <general/name_registry.h>
 #include <general/simulator_tools/simulate_model.h>
 
 namespace molstat {
@@ -25,28 +24,28 @@ namespace transport {
 /**
  * \brief Loads the transport models into the MolStat "database".
  *
- * Models are stored as a map from a string (the name of the model) to a
- * function that creates the desired molstat::SimulateModelFactory.
+ * Models are stored in a registry from the name of the model (case
+ * insensitive) to a function that creates the desired
+ * molstat::SimulateModelFactory.
  *
- * \param[in,out] models The map of models in MolStat. On output, the models
- *    for transport have been added to it.
+ * \param[in,out] models The registry of models in MolStat. On output, the
+ *    models for transport have been added to it.
  */
 void load_models(
-	std::map<std::string,
-	         SimulateModelFactoryFunction> &models);
+	NameRegistry<SimulateModelFactoryFunction> &models);
 
 /**
  * \brief Loads the transport observables into the MolStat "database".
  *
- * Observables are stored as a map from a string (the name of the observable)
- * to an index that can be used to add the observable to a molstat:Simulator.
+ * Observables are stored in a registry from the name of the observable (case
+ * insensitive) to an index that can be used to add the observable to a
+ * molstat:Simulator.
  *
- * \param[in,out] observables The map of observables in MolStat. On output, the
- *    observables for transport have been added to it.
+ * \param[in,out] observables The registry of observables in MolStat. On
+ *    output, the observables for transport have been added to it.
  */
 void load_observables(
-	std::map<std::string,
-	         ObservableIndex> &observables);
+	NameRegistry<ObservableIndex> &observables);
 
 } // namespace molstat::transport
 } // namespace molstat
@@ -0,0 +1,128 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/fit-SymNonresonantDistance.cc
+ * \brief Test suite for the two-dimensional (conductance-distance),
+ *    symmetric-coupling, nonresonant-tunneling fit model.
+ *
+ * \test Test suite for the conductance-distance, symmetric-coupling,
+ *    nonresonant-tunneling fit model.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <array>
+#include <list>
+#include <utility>
+#include <cmath>
+
+#include <electron_transport/fitter_models/symmetric_nonresonant.h>
+#include <electron_transport/fitter_models/symmetric_nonresonant_distance.h>
+
+using namespace std;
+
+/// Shortcut for the model type in this test.
+using ModelType = molstat::transport::SymmetricNonresonantDistanceFitModel;
+
+/// Shortcut for the one-dimensional model type.
+using Model1DType = molstat::transport::SymmetricNonresonantFitModel;
+
+/// Alias for the type of data values.
+using DataType = std::array<double, 2>;
+
+/// Alias for the type of one-dimensional data values.
+using Data1DType = std::array<double, 1>;
+
+/**
+ * \brief Main function for testing the conductance-distance, symmetric-
+ *    coupling, one-site model.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh{ 1.e-5 };
+	constexpr double gvals[3]{ 0.002, 0.001, 0.0005 };
+	constexpr double zvals[3]{ 1.2, 1.0, 0.8 };
+	constexpr double obs[3]{ 20., 5., 4. };
+
+	// set up a dummy data set
+	list<pair<DataType, double>> datalist;
+	list<pair<Data1DType, double>> datalist1d;
+	for(size_t j = 0; j < 3; ++j)
+	{
+		datalist.emplace_back(DataType{{ gvals[j], zvals[j] }}, obs[j]);
+		datalist1d.emplace_back(Data1DType{{ gvals[j] }}, obs[j]);
+	}
+
+	// make the models
+	ModelType model(datalist);
+	Model1DType model1d(datalist1d);
+
+	// the default guesses use the moments of the distance data
+	{
+		list<vector<double>> guesses;
+		model.append_default_guesses(guesses);
+		assert(guesses.size() > 0);
+
+		const double z0{ (20.*1.2 + 5.*1.0 + 4.*0.8) / 29. };
+		const double sigma{ sqrt((20.*1.44 + 5.*1.0 + 4.*0.64) / 29. - z0*z0) };
+		assert(abs(z0 - guesses.front()[ModelType::Z0]) < thresh);
+		assert(abs(sigma - guesses.front()[ModelType::SIGMA]) < thresh);
+	}
+
+	// fit parameters
+	vector<double> fitparam(model.nfit), fitparam1d(model1d.nfit);
+	fitparam[ModelType::CEPSILON] = fitparam1d[Model1DType::CEPSILON] = 100.;
+	fitparam[ModelType::CGAMMA] = fitparam1d[Model1DType::CGAMMA] = 5.;
+	fitparam[ModelType::NORM] = fitparam1d[Model1DType::NORM] = 1.;
+	fitparam[ModelType::Z0] = 1.1;
+	fitparam[ModelType::SIGMA] = 0.25;
+
+	// the line shape is the one-dimensional line shape times a Gaussian
+	for(size_t j = 0; j < 3; ++j)
+	{
+		const DataType x{{ gvals[j], zvals[j] }};
+		const Data1DType x1d{{ gvals[j] }};
+		const double dz{ (zvals[j] - 1.1) / 0.25 };
+		const double gauss{ exp(-0.5*dz*dz) };
+
+		const pair<double, vector<double>> returnval
+			{ model.resid_j(fitparam, x, obs[j]) };
+		const pair<double, vector<double>> returnval1d
+			{ model1d.resid_j(fitparam1d, x1d, obs[j]) };
+		const double model1dval{ returnval1d.first + obs[j] };
+		const double modelval{ model1dval * gauss };
+
+		assert(abs(modelval - obs[j] - returnval.first) / abs(returnval.first)
+			< thresh);
+		assert(abs(gauss * returnval1d.second[Model1DType::CEPSILON]
+			- returnval.second[ModelType::CEPSILON])
+			/ abs(returnval.second[ModelType::CEPSILON]) < thresh);
+		assert(abs(gauss * returnval1d.second[Model1DType::CGAMMA]
+			- returnval.second[ModelType::CGAMMA])
+			/ abs(returnval.second[ModelType::CGAMMA]) < thresh);
+		assert(abs(gauss * returnval1d.second[Model1DType::NORM]
+			- returnval.second[ModelType::NORM])
+			/ abs(returnval.second[ModelType::NORM]) < thresh);
+		assert(abs(modelval * dz / 0.25 - returnval.second[ModelType::Z0])
+			/ abs(returnval.second[ModelType::Z0]) < thresh);
+		assert(abs(modelval * dz * dz / 0.25
+			- returnval.second[ModelType::SIGMA])
+			/ abs(returnval.second[ModelType::SIGMA]) < thresh);
+	}
+
+	// the sign of sigma is irrelevant
+	fitparam[ModelType::SIGMA] = -0.25;
+	model.process_fit_parameters(fitparam);
+	assert(fitparam[ModelType::SIGMA] == 0.25);
+
+	return 0;
+}
@@ -0,0 +1,53 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/midpoint_current.h
+ * \brief The finite-temperature current of a transmission function, by
+ *    direct integration, for testing the channels.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __test_midpoint_current_h__
+#define __test_midpoint_current_h__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+
+/**
+ * \brief Integrates the transmission over the Fermi window with the midpoint
+ *    rule.
+ *
+ * \param[in] trans The transmission function.
+ * \param[in] ef The Fermi energy.
+ * \param[in] V The applied bias.
+ * \param[in] kT The thermal energy.
+ * \return The electric current.
+ */
+static double midpoint_current(const std::function<double(double)> &trans,
+	const double ef, const double V, const double kT)
+{
+	const double muL{ ef + 0.5*V }, muR{ ef - 0.5*V };
+	const double a{ std::min(muL, muR) - 40.*kT },
+		b{ std::max(muL, muR) + 40.*kT };
+	const std::size_t n = 400000;
+	const double h{ (b - a) / n };
+
+	double sum{ 0. };
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		const double E{ a + (j + 0.5) * h };
+		sum += h * trans(E) * (1. / (1. + std::exp((E - muL) / kT))
+			- 1. / (1. + std::exp((E - muR) / kT)));
+	}
+
+	return sum;
+}
+
+#endif
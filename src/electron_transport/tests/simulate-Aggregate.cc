@@ -0,0 +1,208 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/simulate-Aggregate.cc
+ * \brief Test suite for the channel comprised of several independent
+ *    molecules.
+ *
+ * \test Test suite for the channel comprised of several independent
+ *    molecules. The observables are compared to sums over junctions with a
+ *    single molecule.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <valarray>
+#include <vector>
+
+#include <electron_transport/simulator_models/aggregate_channel.h>
+#include <electron_transport/simulator_models/asym_one_site_channel.h>
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/uniform.h>
+#include <general/random_distributions/poisson.h>
+
+using namespace std;
+
+/// Shortcut for the type of channel used in this test.
+using ChannelType = molstat::transport::AggregateChannel;
+
+/// Shortcut for the type of the molecules.
+using MoleculeType = molstat::transport::AsymOneSiteChannel;
+
+/**
+ * \brief Main function for testing the aggregate channel.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh{ 1.e-12 };
+	const size_t maxcopies{ 3 };
+
+	// the channel for each molecule
+	shared_ptr<molstat::SimulateModel> molecule =
+		molstat::SimulateModelFactory::makeFactory<MoleculeType>()
+		.setDistribution("epsilon",
+			make_shared<molstat::UniformDistribution>(-1., -0.2))
+		.setDistribution("gammal",
+			make_shared<molstat::UniformDistribution>(0.05, 0.2))
+		.setDistribution("gammar",
+			make_shared<molstat::UniformDistribution>(0.05, 0.2))
+		.setDistribution("a",
+			make_shared<molstat::UniformDistribution>(-0.1, 0.1))
+		.getModel();
+
+	// the aggregate channel, with a Poisson number of molecules
+	shared_ptr<molstat::SimulateModel> channel =
+		molstat::SimulateModelFactory::makeFactory<ChannelType>()
+		.setDistribution("copies",
+			make_shared<molstat::PoissonDistribution>(1.5))
+		.setDistribution("maxcopies",
+			make_shared<molstat::ConstantDistribution>(maxcopies))
+		.addSubmodel(molecule)
+		.getModel();
+
+	// junctions with the aggregate channel and with only one molecule
+	shared_ptr<molstat::SimulateModel> junction =
+		molstat::SimulateModelFactory::makeFactory
+			<molstat::transport::TransportJunction>()
+		.setDistribution("ef", make_shared<molstat::ConstantDistribution>(0.))
+		.setDistribution("v",
+			make_shared<molstat::UniformDistribution>(-0.5, 0.5))
+		.addSubmodel(channel)
+		.getModel();
+
+	shared_ptr<molstat::SimulateModel> single =
+		molstat::SimulateModelFactory::makeFactory
+			<molstat::transport::TransportJunction>()
+		.setDistribution("ef", nullptr)
+		.setDistribution("v", nullptr)
+		.addSubmodel(molecule)
+		.getModel();
+
+	// each molecule has its own parameters
+	const size_t nmolecule{ single->get_num_parameters() - 3 };
+	assert(junction->get_num_parameters() == 5 + maxcopies * nmolecule);
+
+	const vector<type_index> observables{
+		type_index{ typeid(molstat::transport::ElectricCurrent) },
+		type_index{ typeid(molstat::transport::ZeroBiasConductance) },
+		type_index{ typeid(molstat::transport::DifferentialConductance) },
+		type_index{ typeid(molstat::transport::StaticConductance) } };
+
+	molstat::Engine engine{ 0xC0FFEE };
+
+	for(const type_index &obs : observables)
+	{
+		auto Func = junction->getObservableFunction(obs);
+		auto Single = single->getObservableFunction(obs);
+		auto Batch = junction->getBatchObservableFunction(obs);
+
+		// the observable is the sum over the molecules
+		valarray<double> params{ junction->generateParameters(engine) };
+		assert(params[ChannelType::Index_copies] ==
+			round(params[ChannelType::Index_copies]));
+		assert(params[5] != params[5 + nmolecule]);
+		for(size_t k = 0; k <= maxcopies + 1; ++k)
+		{
+			params[ChannelType::Index_copies] = k + 0.2;
+
+			valarray<double> subparams(3 + nmolecule);
+			subparams[slice(0, 3, 1)] = params[slice(0, 3, 1)];
+
+			double sum{ 0. };
+			for(size_t j = 0; j < k; ++j)
+			{
+				subparams[slice(3, nmolecule, 1)] =
+					params[slice(5 + j*nmolecule, nmolecule, 1)];
+				sum += Single(subparams);
+			}
+
+			if(k == 0 || k > maxcopies)
+				assert(std::isnan(Func(params)));
+			else
+				assert(abs(sum - Func(params)) < thresh);
+		}
+
+		// batches, including trials without molecules or with too many,
+		// agree with the individual trials
+		const size_t nparams{ junction->get_num_parameters() };
+		const size_t ntrials{ 200 };
+		vector<double> storage(nparams * ntrials);
+		junction->generateParameterBatch(engine, ntrials, storage.data());
+		vector<const double *> batch(nparams);
+		for(size_t j = 0; j < nparams; ++j)
+			batch[j] = storage.data() + j*ntrials;
+
+		vector<double> out(ntrials);
+		Batch(batch.data(), nparams, ntrials, out.data());
+
+		size_t nvalid{ 0 };
+		for(size_t t = 0; t < ntrials; ++t)
+		{
+			valarray<double> trial(nparams);
+			for(size_t j = 0; j < nparams; ++j)
+				trial[j] = storage[j*ntrials + t];
+
+			const double k{ trial[ChannelType::Index_copies] };
+			if(k < 1. || k > maxcopies)
+			{
+				assert(std::isnan(out[t]));
+				continue;
+			}
+
+			++nvalid;
+			assert(abs(out[t] - Func(trial)) < thresh);
+		}
+		assert(nvalid > 0 && nvalid < ntrials);
+	}
+
+	// maxcopies must be a constant integer, specified before the molecule
+	for(const double maxk : { 0., 2.5 })
+	{
+		bool caught{ false };
+		try
+		{
+			molstat::SimulateModelFactory::makeFactory<ChannelType>()
+				.setDistribution("copies", nullptr)
+				.setDistribution("maxcopies",
+					make_shared<molstat::ConstantDistribution>(maxk))
+				.addSubmodel(molecule);
+		}
+		catch(const invalid_argument &e)
+		{
+			caught = true;
+		}
+		assert(caught);
+	}
+
+	// only one submodel
+	{
+		bool caught{ false };
+		try
+		{
+			molstat::SimulateModelFactory::makeFactory<ChannelType>()
+				.setDistribution("copies", nullptr)
+				.setDistribution("maxcopies",
+					make_shared<molstat::ConstantDistribution>(2.))
+				.addSubmodel(molecule)
+				.addSubmodel(molecule);
+		}
+		catch(const invalid_argument &e)
+		{
+			caught = true;
+		}
+		assert(caught);
+	}
+
+	return 0;
+}
@@ -16,9 +16,11 @@
  */
 
 #include <cassert>
+#include <cmath>
 #include <valarray>
 
 #include <electron_transport/simulator_models/asym_one_site_channel.h>
+#include "midpoint_current.h"
 
 using namespace std;
 
@@ -145,5 +147,32 @@ int main(int argc, char **argv)
 	assert(abs(0.00480763 - DiffG(params)) < thresh);
 	assert(abs(params[ChannelType::Index_V] - AppBias(params)) < thresh);
 
+
+	// finite temperature
+	for(const double kT : { 0.01, 0.1, 0.5 })
+	{
+		params[ChannelType::Index_EF] = 0.3;
+		params[ChannelType::Index_V] = 0.9;
+		params[ChannelType::Index_kT] = kT;
+		params[ChannelType::Index_epsilon] = 0.5;
+		params[ChannelType::Index_gammaL] = 0.1;
+		params[ChannelType::Index_gammaR] = 0.25;
+		params[ChannelType::Index_a] = 0.2;
+
+		const double exact{ midpoint_current(
+			[] (double E) -> double
+			{
+				return ChannelType::transmission(E, 0.9, 0.5, 0.1, 0.25, 0.2);
+			}, 0.3, 0.9, kT) };
+		assert(abs(exact - ECurrent(params)) < thresh);
+		assert(abs(exact / 0.9 - StaticG(params)) < thresh);
+	}
+
+	// the zero-temperature limit
+	params[ChannelType::Index_kT] = 0.;
+	const double zeroT{ ECurrent(params) };
+	params[ChannelType::Index_kT] = 1.e-6;
+	assert(abs(zeroT - ECurrent(params)) < thresh);
+
 	return 0;
 }
@@ -16,9 +16,12 @@
  */
 
 #include <cassert>
+#include <cmath>
 #include <valarray>
+#include <vector>
 
 #include <electron_transport/simulator_models/asym_two_site_channel.h>
+#include "midpoint_current.h"
 
 using namespace std;
 
@@ -109,5 +112,84 @@ int main(int argc, char **argv)
 	assert(abs(0.00340305 - DiffG(params)) < thresh);
 	assert(abs(params[ChannelType::Index_V] - AppBias(params)) < thresh);
 
+
+	// finite temperature, including couplings where the poles are
+	// degenerate or purely imaginary
+	for(const double kT : { 0.01, 0.1, 0.5 })
+	{
+		for(const double beta : { -1.6, 0.3, 0.05 })
+		{
+			params[ChannelType::Index_EF] = 0.3;
+			params[ChannelType::Index_V] = -0.7;
+			params[ChannelType::Index_kT] = kT;
+			params[ChannelType::Index_epsilon] = 0.5;
+			params[ChannelType::Index_gammaL] = 0.4;
+			params[ChannelType::Index_gammaR] = 1.6;
+			params[ChannelType::Index_beta] = beta;
+
+			const double exact{ midpoint_current(
+				[beta] (double E) -> double
+				{
+					return ChannelType::transmission(E, -0.7, 0.5, 0.4, 1.6,
+						beta);
+				}, 0.3, -0.7, kT) };
+			assert(abs(exact - ECurrent(params)) < thresh);
+			assert(abs(exact / -0.7 - StaticG(params)) < thresh);
+		}
+	}
+
+	// the zero-temperature limit
+	params[ChannelType::Index_kT] = 0.;
+	const double zeroT{ ECurrent(params) };
+	params[ChannelType::Index_kT] = 1.e-6;
+	assert(abs(zeroT - ECurrent(params)) < thresh);
+
+	// the batch kernels agree with the individual calculations, both when the
+	// transmission's poles have the same real part (small beta) and when
+	// they do not, and with some trials at finite temperature
+	{
+		const auto BatchCurrent = junction->getBatchObservableFunction(
+			type_index{ typeid(molstat::transport::ElectricCurrent) } );
+		const auto BatchStaticG = junction->getBatchObservableFunction(
+			type_index{ typeid(molstat::transport::StaticConductance) } );
+
+		const size_t nparams{ junction->get_num_parameters() };
+		vector<valarray<double>> trials;
+		for(const double beta : { -2.1, -0.6, -0.1, 0.02, 0.35, 1.4 })
+			for(const double gr : { 0.05, 0.5, 2.3 })
+				for(const double V : { -1.2, 0.4 })
+				{
+					valarray<double> p(nparams);
+					p[ChannelType::Index_EF] = 0.2 * beta;
+					p[ChannelType::Index_V] = V;
+					p[ChannelType::Index_kT] = trials.size() % 5 == 0 ? 0.03 : 0.;
+					p[ChannelType::Index_epsilon] = -0.4 + gr;
+					p[ChannelType::Index_gammaL] = 0.6;
+					p[ChannelType::Index_gammaR] = gr;
+					p[ChannelType::Index_beta] = beta;
+					trials.push_back(p);
+				}
+
+		// parameter-major storage
+		const size_t ntrials{ trials.size() };
+		vector<double> storage(nparams * ntrials);
+		vector<const double *> batch(nparams);
+		for(size_t j = 0; j < nparams; ++j)
+		{
+			for(size_t t = 0; t < ntrials; ++t)
+				storage[j*ntrials + t] = trials[t][j];
+			batch[j] = storage.data() + j*ntrials;
+		}
+
+		vector<double> current(ntrials), staticg(ntrials);
+		BatchCurrent(batch.data(), nparams, ntrials, current.data());
+		BatchStaticG(batch.data(), nparams, ntrials, staticg.data());
+		for(size_t t = 0; t < ntrials; ++t)
+		{
+			assert(abs(current[t] - ECurrent(trials[t])) < 1.e-10);
+			assert(abs(staticg[t] - StaticG(trials[t])) < 1.e-10);
+		}
+	}
+
 	return 0;
 }
@@ -46,6 +46,7 @@ int main(int argc, char **argv)
 			.setDistribution("epsilon", nullptr)
 			.setDistribution("gamma", nullptr)
 			.setDistribution("a", nullptr)
+			.setDistribution("nm", nullptr)
 			.getModel()
 		);
 	assert(channel1 != nullptr);
@@ -83,10 +84,11 @@ int main(int argc, char **argv)
 		type_index{ typeid(molstat::transport::DifferentialConductance) } );
 
 	valarray<double> params(junction->get_num_parameters());
+	params[ChannelType1::Index_nm] = 1.;
 
 	// subarrays for passing parameters directly to the submodels
-	const valarray<size_t> index1 = {0, 1, 2, 3, 4};
-	const valarray<size_t> index2 = {0, 1, 5, 6, 7, 8};
+	const valarray<size_t> index1 = {0, 1, 2, 3, 4, 5, 6};
+	const valarray<size_t> index2 = {0, 1, 2, 7, 8, 9, 10};
 
 	// check known values for several parameter sets
 	params[ChannelType1::Index_EF] = 0.;
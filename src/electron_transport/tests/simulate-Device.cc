@@ -0,0 +1,431 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/simulate-Device.cc
+ * \brief Test suite for simulating closed-form channels with a device
+ *    backend.
+ *
+ * \test Tests molstat::DeviceSimulator with the host backend of the channel
+ *    kernels (molstat::transport::HostChannelBackend): the observables
+ *    match the channels' functions for the device's parameters, batches do
+ *    not depend on how the trials are split, and unsupported simulations are
+ *    rejected. If there is a GPU, its backend gives the same observables as
+ *    the host backend. Also tests the closed-form distributions of the
+ *    zero-bias conductance (molstat::transport::AnalyticChannelSolver)
+ *    against the device's trials.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <valarray>
+#include <vector>
+
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/uniform.h>
+#include <general/random_distributions/normal.h>
+#include <general/random_distributions/lognormal.h>
+#include <general/random_distributions/gamma.h>
+#include <general/simulator_tools/simulator.h>
+#include <general/simulator_tools/device_simulator.h>
+#include <electron_transport/simulator_models/sym_one_site_channel.h>
+#include <electron_transport/simulator_models/sym_two_site_channel.h>
+#include <electron_transport/simulator_models/asym_two_site_channel.h>
+#include <electron_transport/simulator_models/sym_interference.h>
+#include <electron_transport/simulator_models/transport_device.h>
+
+using namespace std;
+using namespace molstat::transport;
+
+/**
+ * \brief Makes a symmetric one-site channel.
+ *
+ * \return The channel.
+ */
+shared_ptr<molstat::SimulateModel> MakeSymOneSite()
+{
+	return molstat::SimulateModelFactory::makeFactory<SymOneSiteChannel>()
+		.setDistribution("epsilon",
+			make_shared<molstat::NormalDistribution>(-1., 0.2))
+		.setDistribution("gamma",
+			make_shared<molstat::LognormalDistribution>(-2.5, 0.3))
+		.setDistribution("a",
+			make_shared<molstat::UniformDistribution>(-0.1, 0.1))
+		.setDistribution("nm",
+			make_shared<molstat::ConstantDistribution>(2.))
+		.getModel();
+}
+
+/**
+ * \brief Checks the device's observables against the model's functions.
+ *
+ * \param[in] sim The simulator.
+ * \param[in] model The simulator's model.
+ * \param[in] device The device simulator.
+ * \param[in] obs The observables.
+ */
+void CheckObservables(const molstat::Simulator &sim,
+	const molstat::SimulateModel &model, const molstat::DeviceSimulator &device,
+	const vector<molstat::ObservableIndex> &obs)
+{
+	constexpr size_t ntrials = 200;
+	const size_t nobs{ obs.size() }, nparams{ sim.numParameters() };
+
+	vector<double> out(ntrials * nobs);
+	assert(device.simulateBatch(100, ntrials, out.data()) == ntrials);
+
+	valarray<double> params(nparams);
+	for(size_t t = 0; t < ntrials; ++t)
+	{
+		device.generateParameters(100 + t, &params[0]);
+
+		for(size_t j = 0; j < nobs; ++j)
+		{
+			const double expected
+				{ model.getObservableFunction(obs[j])(params) };
+			assert(abs(out[t*nobs + j] - expected) <=
+				1.e-10 * max(1., abs(expected)));
+		}
+	}
+
+	// the trials do not depend on the batches
+	vector<double> split(ntrials * nobs);
+	assert(device.simulateBatch(100, 73, split.data()) == 73);
+	assert(device.simulateBatch(173, ntrials - 73, split.data() + 73*nobs)
+		== ntrials - 73);
+	for(size_t k = 0; k < ntrials * nobs; ++k)
+		assert(split[k] == out[k]);
+}
+
+/**
+ * \brief Checks the GPU backend, if there is one, against the host backend.
+ *
+ * The batches change size, and the programs (keys) change between them.
+ *
+ * \param[in] sim The simulator.
+ * \param[in] host The host backend.
+ * \param[in] gpu The GPU backend, or nullptr if there is none.
+ */
+void CheckGPU(const molstat::Simulator &sim,
+	const shared_ptr<const molstat::DeviceBackend> &host,
+	const shared_ptr<const molstat::DeviceBackend> &gpu)
+{
+	if(gpu == nullptr)
+		return;
+
+	const molstat::DeviceSimulator host1(sim, host, 21), host2(sim, host, 22),
+		gpu1(sim, gpu, 21), gpu2(sim, gpu, 22);
+	const size_t nobs{ host1.numObservables() };
+
+	for(const auto &device : { make_pair(&host1, &gpu1),
+		make_pair(&host2, &gpu2), make_pair(&host1, &gpu1) })
+	{
+		size_t first{ 0 };
+		for(const size_t ntrials : { 1000, 10, 5000 })
+		{
+			vector<double> expected(ntrials * nobs), out(ntrials * nobs);
+			const size_t nvalid{ device.first->simulateBatch(first, ntrials,
+				expected.data()) };
+			assert(device.second->simulateBatch(first, ntrials, out.data())
+				== nvalid);
+
+			// to rounding in the device's math library
+			for(size_t k = 0; k < nvalid * nobs; ++k)
+				assert(abs(out[k] - expected[k]) <=
+					1.e-10 * max(1., abs(expected[k])));
+
+			first += ntrials;
+		}
+	}
+}
+
+/**
+ * \brief Checks a closed-form distribution of the zero-bias conductance
+ *    against the device's trials.
+ *
+ * \param[in] sim The simulator, with the zero-bias conductance as its only
+ *    observable.
+ * \param[in] host The host backend.
+ */
+void CheckDistribution(const molstat::Simulator &sim,
+	const shared_ptr<const molstat::DeviceBackend> &host)
+{
+	constexpr size_t ntrials = 100000;
+	const AnalyticChannelSolver solver;
+	string reason;
+
+	const molstat::AnalyticCDF cdf{ solver.getCDF(
+		molstat::DeviceSimulator::translate(sim, 9), 0, reason) };
+	assert(cdf);
+	assert(cdf(0.) == 0. && cdf(1.) == 1.);
+
+	const molstat::DeviceSimulator device(sim, host, 9);
+	vector<double> g(ntrials);
+	assert(device.simulateBatch(0, ntrials, g.data()) == ntrials);
+
+	for(const double x : { 1.e-4, 1.e-3, 1.e-2, 0.1, 0.5, 0.9 })
+	{
+		size_t below{ 0 };
+		for(const double value : g)
+			if(value <= x)
+				++below;
+		assert(abs(below / double(ntrials) - cdf(x)) < 0.01);
+	}
+}
+
+/**
+ * \brief Main function for testing the device simulations.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const shared_ptr<const molstat::DeviceBackend> host
+		{ make_shared<HostChannelBackend>() };
+	const shared_ptr<const molstat::DeviceBackend> gpu
+		{ GetGPUChannelBackend() };
+	const molstat::ObservableIndex zerobiasg
+		{ molstat::GetObservableIndex<ZeroBiasConductance>() };
+	const molstat::ObservableIndex diffg
+		{ molstat::GetObservableIndex<DifferentialConductance>() };
+	const molstat::ObservableIndex current
+		{ molstat::GetObservableIndex<ElectricCurrent>() };
+	const molstat::ObservableIndex staticg
+		{ molstat::GetObservableIndex<StaticConductance>() };
+
+	// the counter-based samples have the right moments
+	{
+		constexpr size_t n = 200000;
+		const molstat::DeviceDistribution uniform
+			{ molstat::DeviceDistribution::Uniform, 1., 3. };
+		const molstat::DeviceDistribution normal
+			{ molstat::DeviceDistribution::Normal, -2., 0.5 };
+
+		double usum{ 0. }, nsum{ 0. }, nsum2{ 0. };
+		for(size_t t = 0; t < n; ++t)
+		{
+			const double u{ molstat::DeviceSample(uniform, 17, t, 0) };
+			assert(u >= 1. && u < 3.);
+			usum += u;
+
+			const double x{ molstat::DeviceSample(normal, 17, t, 1) };
+			nsum += x;
+			nsum2 += x*x;
+		}
+		assert(abs(usum / n - 2.) < 0.01);
+		assert(abs(nsum / n + 2.) < 0.01);
+		assert(abs(nsum2 / n - nsum*nsum / (double(n)*n) - 0.25) < 0.01);
+	}
+
+	// a junction with one- and two-site channels; the conductances
+	{
+		shared_ptr<molstat::SimulateModel> junction =
+			molstat::SimulateModelFactory::makeFactory<TransportJunction>()
+			.setDistribution("ef", make_shared<molstat::UniformDistribution>
+				(-0.5, 0.5))
+			.setDistribution("v", make_shared<molstat::UniformDistribution>
+				(0.1, 1.))
+			.addSubmodel(MakeSymOneSite())
+			.addSubmodel(
+				molstat::SimulateModelFactory::makeFactory<SymTwoSiteChannel>()
+				.setDistribution("epsilon",
+					make_shared<molstat::NormalDistribution>(0., 0.5))
+				.setDistribution("gamma",
+					make_shared<molstat::UniformDistribution>(0.1, 0.3))
+				.setDistribution("beta",
+					make_shared<molstat::UniformDistribution>(-0.5, -0.2))
+				.getModel())
+			.addSubmodel(
+				molstat::SimulateModelFactory::makeFactory<AsymTwoSiteChannel>()
+				.setDistribution("epsilon",
+					make_shared<molstat::NormalDistribution>(0.5, 0.5))
+				.setDistribution("gammal",
+					make_shared<molstat::UniformDistribution>(0.1, 0.3))
+				.setDistribution("gammar",
+					make_shared<molstat::UniformDistribution>(0.05, 0.2))
+				.setDistribution("beta",
+					make_shared<molstat::UniformDistribution>(-0.5, -0.2))
+				.getModel())
+			.getModel();
+
+		molstat::Simulator sim{ junction };
+
+		// no observables
+		try
+		{
+			molstat::DeviceSimulator device(sim, host, 5);
+			assert(false);
+		}
+		catch(const molstat::NoObservables &e)
+		{
+			// should be here
+		}
+
+		sim.setObservable(0, zerobiasg);
+		sim.setObservable(1, diffg);
+
+		const molstat::DeviceSimulator device(sim, host, 5);
+		assert(device.numObservables() == 2);
+		CheckObservables(sim, *junction, device, { zerobiasg, diffg });
+		CheckGPU(sim, host, gpu);
+
+		// the two-site channels have no device kernel for the current
+		sim.setObservable(2, current);
+		try
+		{
+			molstat::DeviceSimulator bad(sim, host, 5);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// the current and static conductance, at zero temperature only
+	{
+		molstat::SimulateModelFactory factory{
+			molstat::SimulateModelFactory::makeFactory<TransportJunction>() };
+		factory.setDistribution("ef",
+				make_shared<molstat::UniformDistribution>(-0.5, 0.5))
+			.setDistribution("v",
+				make_shared<molstat::UniformDistribution>(0.1, 1.))
+			.addSubmodel(MakeSymOneSite())
+			.addSubmodel(MakeSymOneSite());
+		shared_ptr<molstat::SimulateModel> junction{ factory.getModel() };
+
+		molstat::Simulator sim{ junction };
+		sim.setObservable(0, current);
+		sim.setObservable(1, staticg);
+		sim.setObservable(2, zerobiasg);
+
+		const molstat::DeviceSimulator device(sim, host, 11);
+		CheckObservables(sim, *junction, device,
+			{ current, staticg, zerobiasg });
+		CheckGPU(sim, host, gpu);
+
+		// the key selects the trials
+		vector<double> out1(3), out2(3);
+		const molstat::DeviceSimulator other(sim, host, 12);
+		device.simulateBatch(0, 1, out1.data());
+		other.simulateBatch(0, 1, out2.data());
+		assert(out1[0] != out2[0]);
+
+		// finite temperature stays on the host
+		sim.setDistribution(*junction, "kt",
+			make_shared<molstat::UniformDistribution>(0.01, 0.02));
+		try
+		{
+			molstat::DeviceSimulator bad(sim, host, 11);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+
+		// as do distributions without a device description
+		sim.setDistribution(*junction, "kt",
+			make_shared<molstat::ConstantDistribution>(0.));
+		sim.setDistribution(*junction, "ef",
+			make_shared<molstat::GammaDistribution>(2., 1.));
+		try
+		{
+			molstat::DeviceSimulator bad(sim, host, 11);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// the interference channel
+	{
+		shared_ptr<molstat::SimulateModel> junction =
+			molstat::SimulateModelFactory::makeFactory<TransportJunction>()
+			.setDistribution("ef", make_shared<molstat::ConstantDistribution>
+				(0.))
+			.setDistribution("v", make_shared<molstat::ConstantDistribution>
+				(0.2))
+			.addSubmodel(molstat::SimulateModelFactory::makeFactory
+					<SymInterferenceChannel>()
+				.setDistribution("epsilon",
+					make_shared<molstat::NormalDistribution>(0., 1.))
+				.setDistribution("gamma",
+					make_shared<molstat::UniformDistribution>(0.1, 0.3))
+				.setDistribution("beta",
+					make_shared<molstat::UniformDistribution>(0.5, 1.))
+				.getModel())
+			.getModel();
+
+		molstat::Simulator sim{ junction };
+		sim.setObservable(0, zerobiasg);
+
+		const molstat::DeviceSimulator device(sim, host, 3);
+		CheckObservables(sim, *junction, device, { zerobiasg });
+		CheckGPU(sim, host, gpu);
+
+		// the interference channel has no closed-form distribution
+		string reason;
+		assert(!AnalyticChannelSolver().getCDF(
+			molstat::DeviceSimulator::translate(sim, 3), 0, reason));
+		assert(!reason.empty());
+	}
+
+	// the exact distributions of the one-site conductance
+	{
+		shared_ptr<molstat::SimulateModel> channel =
+			molstat::SimulateModelFactory::makeFactory<SymOneSiteChannel>()
+			.setDistribution("epsilon",
+				make_shared<molstat::NormalDistribution>(-0.3, 0.2))
+			.setDistribution("gamma",
+				make_shared<molstat::ConstantDistribution>(0.05))
+			.setDistribution("a",
+				make_shared<molstat::UniformDistribution>(-0.1, 0.1))
+			.setDistribution("nm",
+				make_shared<molstat::ConstantDistribution>(2.))
+			.getModel();
+		shared_ptr<molstat::SimulateModel> junction =
+			molstat::SimulateModelFactory::makeFactory<TransportJunction>()
+			.setDistribution("ef", make_shared<molstat::ConstantDistribution>
+				(0.))
+			.setDistribution("v", make_shared<molstat::UniformDistribution>
+				(0.1, 1.))
+			.addSubmodel(channel)
+			.getModel();
+
+		molstat::Simulator sim{ junction };
+		sim.setObservable(0, zerobiasg);
+
+		// resonant tunneling
+		CheckDistribution(sim, host);
+
+		// nonresonant tunneling
+		sim.setDistribution(*channel, "epsilon",
+			make_shared<molstat::ConstantDistribution>(-0.8));
+		sim.setDistribution(*channel, "gamma",
+			make_shared<molstat::NormalDistribution>(0.1, 0.04));
+		CheckDistribution(sim, host);
+
+		// both vary
+		sim.setDistribution(*channel, "epsilon",
+			make_shared<molstat::NormalDistribution>(-0.8, 0.1));
+		string reason;
+		assert(!AnalyticChannelSolver().getCDF(
+			molstat::DeviceSimulator::translate(sim, 9), 0, reason));
+		assert(!reason.empty());
+	}
+
+	return 0;
+}
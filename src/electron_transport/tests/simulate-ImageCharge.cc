@@ -0,0 +1,181 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/simulate-ImageCharge.cc
+ * \brief Test suite for the one-site channel with separation-dependent
+ *    renormalization.
+ *
+ * \test Test suite for the one-site channel with separation-dependent
+ *    renormalization. The renormalized level is compared to the image-charge
+ *    shift of the trace protocol.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <valarray>
+#include <vector>
+
+#include <electron_transport/simulator_models/image_charge_channel.h>
+#include <general/simulator_tools/trace_protocol.h>
+
+using namespace std;
+
+/// Shortcut for the type of channel used in this test.
+using ChannelType = molstat::transport::ImageChargeChannel;
+
+/**
+ * \brief Main function for testing the image-charge channel.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh{ 1.e-6 };
+
+	// use the factory to create a channel
+	shared_ptr<ChannelType> channel = dynamic_pointer_cast<ChannelType>(
+			molstat::SimulateModelFactory::makeFactory<ChannelType>()
+			// not going to need the distributions, but the factory framework
+			// requires them
+			.setDistribution("epsilon", nullptr)
+			.setDistribution("gamma", nullptr)
+			.setDistribution("a", nullptr)
+			.setDistribution("nm", nullptr)
+			.setDistribution("separation", nullptr)
+			.setDistribution("d0", nullptr)
+			.setDistribution("zip", nullptr)
+			.setDistribution("decay", nullptr)
+			.getModel()
+		);
+	assert(channel != nullptr);
+
+	// use the factory to create a junction
+	shared_ptr<molstat::SimulateModel> junction =
+		molstat::SimulateModelFactory::makeFactory
+			<molstat::transport::TransportJunction>()
+		.setDistribution("ef", nullptr)
+		.setDistribution("v", nullptr)
+		.addSubmodel(channel)
+		.getModel();
+
+	// get the observable functions
+	auto ECurrent = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::ElectricCurrent) } );
+	auto ZeroBiasG = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::ZeroBiasConductance) } );
+	auto StaticG = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::StaticConductance) } );
+	auto DiffG = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::DifferentialConductance) } );
+
+	valarray<double> params(junction->get_num_parameters());
+
+	// at the reference separation, this is the symmetric one-site channel
+	params[ChannelType::Index_EF] = 0.;
+	params[ChannelType::Index_V] = 1.;
+	params[ChannelType::Index_epsilon] = -4.;
+	params[ChannelType::Index_gamma] = 0.8;
+	params[ChannelType::Index_a] = 0.;
+	params[ChannelType::Index_nm] = 1.;
+	params[ChannelType::Index_d] = 0.5;
+	params[ChannelType::Index_d0] = 0.5;
+	params[ChannelType::Index_zip] = 0.1;
+	params[ChannelType::Index_decay] = 8.;
+	assert(abs(0.0384615 - ZeroBiasG(params)) < thresh);
+	assert(abs(0.0390172 - ECurrent(params)) < thresh);
+	assert(abs(0.0390172 - StaticG(params)) < thresh);
+	assert(abs(0.0401438 - DiffG(params)) < thresh);
+
+	// each molecule contributes
+	params[ChannelType::Index_nm] = 3.;
+	assert(abs(3. * 0.0384615 - ZeroBiasG(params)) < 3. * thresh);
+	assert(abs(3. * 0.0390172 - ECurrent(params)) < 3. * thresh);
+
+	// stretched: the level follows the trace protocol's image-charge shift
+	// and the coupling decays
+	const auto shift = molstat::TraceProtocol::ImageChargeShift(0.5, 0.1);
+	for(const double d : { 0.45, 0.5, 0.7, 1.2 })
+	{
+		params[ChannelType::Index_nm] = 2.;
+		params[ChannelType::Index_EF] = -0.3;
+		params[ChannelType::Index_V] = 0.2;
+		params[ChannelType::Index_a] = 0.1;
+		params[ChannelType::Index_epsilon] = -1.;
+		params[ChannelType::Index_gamma] = 0.05;
+		params[ChannelType::Index_d] = d;
+
+		double epsd, gammad;
+		assert(ChannelType::renormalize(-1., 0.05, d, 0.5, 0.1, 8., epsd,
+			gammad));
+		assert(abs(-1. + shift(d - 0.5) - epsd) < 1.e-12);
+		assert(abs(0.05 * exp(-8. * (d - 0.5)) - gammad) < 1.e-12);
+
+		assert(abs(2. * ChannelType::transmission(-0.3, 0., epsd, gammad, 0.1)
+			- ZeroBiasG(params)) < thresh);
+
+		// the zero-temperature limit of the current
+		const double zeroT{ ECurrent(params) };
+		params[ChannelType::Index_kT] = 1.e-7;
+		assert(abs(zeroT - ECurrent(params)) < thresh);
+		params[ChannelType::Index_kT] = 0.;
+	}
+
+	// the image planes cross
+	params[ChannelType::Index_d] = 0.15;
+	assert(std::isnan(ZeroBiasG(params)));
+	assert(std::isnan(ECurrent(params)));
+
+	// the batch kernels agree with the individual trials
+	{
+		const auto BatchG = junction->getBatchObservableFunction(
+			type_index{ typeid(molstat::transport::ZeroBiasConductance) } );
+		const auto BatchDiffG = junction->getBatchObservableFunction(
+			type_index{ typeid(molstat::transport::DifferentialConductance) } );
+
+		const size_t nparams{ junction->get_num_parameters() };
+		vector<valarray<double>> trials;
+		for(const double d : { 0.1, 0.5, 0.63, 0.9, 1.4 })
+			for(const double V : { -0.5, 0.1 })
+			{
+				params[ChannelType::Index_d] = d;
+				params[ChannelType::Index_V] = V;
+				trials.push_back(params);
+			}
+
+		// parameter-major storage
+		const size_t ntrials{ trials.size() };
+		vector<double> storage(nparams * ntrials);
+		vector<const double *> batch(nparams);
+		for(size_t j = 0; j < nparams; ++j)
+		{
+			for(size_t t = 0; t < ntrials; ++t)
+				storage[j*ntrials + t] = trials[t][j];
+			batch[j] = storage.data() + j*ntrials;
+		}
+
+		vector<double> g(ntrials), diffg(ntrials);
+		BatchG(batch.data(), nparams, ntrials, g.data());
+		BatchDiffG(batch.data(), nparams, ntrials, diffg.data());
+		for(size_t t = 0; t < ntrials; ++t)
+		{
+			if(std::isnan(ZeroBiasG(trials[t])))
+			{
+				assert(std::isnan(g[t]) && std::isnan(diffg[t]));
+				continue;
+			}
+
+			assert(abs(g[t] - ZeroBiasG(trials[t])) < 1.e-12);
+			assert(abs(diffg[t] - DiffG(trials[t])) < 1.e-12);
+		}
+	}
+
+	return 0;
+}
@@ -14,6 +14,7 @@
  */
 
 #include <cassert>
+#include <stdexcept>
 #include <valarray>
 #include <iostream>
 
@@ -78,5 +79,33 @@ int main(int argc, char **argv)
 	assert(abs(0.214993 - ZeroBiasG(params)) < thresh);
 	assert(abs(params[ChannelType::Index_V] - AppBias(params)) < thresh);
 
+	// the static conductance, with each quadrature
+	auto StaticG = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::StaticConductance) } );
+
+	params[ChannelType::Index_EF] = 0.3;
+	params[ChannelType::Index_V] = 0.2;
+	params[ChannelType::Index_h] = 0.6;
+	params[ChannelType::Index_w] = 0.5;
+	assert(abs(0.0611606 - StaticG(params)) < thresh);
+
+	ChannelType::setStaticGQuadrature(16, 1.e-9, 1.e-9);
+	assert(abs(0.0611606 - StaticG(params)) < thresh);
+
+	// a relative tolerance alone, as from the histogram's precision
+	ChannelType::setStaticGQuadrature(0, 0., 1.e-4);
+	assert(abs(0.0611606 - StaticG(params)) < 1.e-3 * 0.0611606);
+	ChannelType::setStaticGQuadrature(0, 1.e-9, 1.e-9);
+
+	try
+	{
+		ChannelType::setStaticGQuadrature(0, 0., 0.);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
 	return 0;
 }
@@ -0,0 +1,205 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/simulate-Switching.cc
+ * \brief Test suite for the one-site channel that switches conformations
+ *    during a stretch.
+ *
+ * \test Test suite for the one-site channel that switches conformations
+ *    during a stretch. Without loading, the rate equations have constant
+ *    coefficients and are solved exactly. Batches of any size agree with
+ *    the individual trials.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <valarray>
+#include <vector>
+
+#include <electron_transport/simulator_models/switching_channel.h>
+
+using namespace std;
+
+/// Shortcut for the type of channel used in this test.
+using ChannelType = molstat::transport::SwitchingChannel;
+
+/**
+ * \brief Populations of the conformations without loading.
+ *
+ * \param[in] kab The rate from A to B.
+ * \param[in] kba The rate from B to A.
+ * \param[in] kr The rupture rate.
+ * \param[in] time The duration of the stretch.
+ * \param[out] pa The population of conformation A.
+ * \param[out] pb The population of conformation B.
+ */
+static void exact_populations(const double kab, const double kba,
+	const double kr, const double time, double &pa, double &pb)
+{
+	// the eigenvalues of the rate matrix M; exp(Mt) = c0 I + c1 M
+	const double tr{ -(kab + kba + kr) }, det{ kab * kr };
+	const double disc{ sqrt(tr*tr - 4.*det) };
+	const double lp{ 0.5 * (tr + disc) }, lm{ 0.5 * (tr - disc) };
+	const double c0{ (lp * exp(lm*time) - lm * exp(lp*time)) / disc };
+	const double c1{ (exp(lp*time) - exp(lm*time)) / disc };
+
+	pa = c0 - c1 * kab;
+	pb = c1 * kab;
+}
+
+/**
+ * \brief Main function for testing the switching channel.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh{ 1.e-6 };
+
+	// use the factory to create a channel
+	shared_ptr<ChannelType> channel = dynamic_pointer_cast<ChannelType>(
+			molstat::SimulateModelFactory::makeFactory<ChannelType>()
+			// not going to need the distributions, but the factory framework
+			// requires them
+			.setDistribution("epsilon", nullptr)
+			.setDistribution("gammaa", nullptr)
+			.setDistribution("gammab", nullptr)
+			.setDistribution("kab", nullptr)
+			.setDistribution("kba", nullptr)
+			.setDistribution("krupture", nullptr)
+			.setDistribution("loading", nullptr)
+			.setDistribution("time", nullptr)
+			.getModel()
+		);
+	assert(channel != nullptr);
+
+	// use the factory to create a junction
+	shared_ptr<molstat::SimulateModel> junction =
+		molstat::SimulateModelFactory::makeFactory
+			<molstat::transport::TransportJunction>()
+		.setDistribution("ef", nullptr)
+		.setDistribution("v", nullptr)
+		.addSubmodel(channel)
+		.getModel();
+
+	// get the observable functions
+	auto ZeroBiasG = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::ZeroBiasConductance) } );
+	auto DiffG = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::DifferentialConductance) } );
+
+	valarray<double> params(junction->get_num_parameters());
+	params[ChannelType::Index_EF] = 0.1;
+	params[ChannelType::Index_V] = 0.;
+	params[ChannelType::Index_epsilon] = -0.6;
+	params[ChannelType::Index_gammaA] = 0.05;
+	params[ChannelType::Index_gammaB] = 0.3;
+	params[ChannelType::Index_loading] = 0.;
+
+	const double ta{ ChannelType::transmission(0.1, -0.6, 0.05) },
+		tb{ ChannelType::transmission(0.1, -0.6, 0.3) };
+
+	// no loading and no rupture: relaxation between the conformations
+	params[ChannelType::Index_kAB] = 2.;
+	params[ChannelType::Index_kBA] = 0.5;
+	params[ChannelType::Index_kR] = 0.;
+	params[ChannelType::Index_time] = 0.7;
+	{
+		const double pb{ 2. / 2.5 * (1. - exp(-2.5 * 0.7)) };
+		assert(abs((1. - pb) * ta + pb * tb - ZeroBiasG(params)) < thresh);
+		assert(abs(ZeroBiasG(params) - DiffG(params)) < thresh);
+	}
+
+	// no loading, with rupture
+	for(const double kr : { 0.1, 1., 30. })
+	{
+		params[ChannelType::Index_kR] = kr;
+
+		double pa, pb;
+		exact_populations(2., 0.5, kr, 0.7, pa, pb);
+		assert(abs(pa * ta + pb * tb - ZeroBiasG(params)) < thresh);
+	}
+
+	// no time to switch
+	params[ChannelType::Index_time] = 0.;
+	assert(abs(ta - ZeroBiasG(params)) < thresh);
+
+	// negative rates produce no observables
+	params[ChannelType::Index_time] = 1.;
+	params[ChannelType::Index_kBA] = -0.5;
+	assert(std::isnan(ZeroBiasG(params)));
+
+	// batches (with loading and some invalid trials) agree with the
+	// individual trials
+	{
+		const auto BatchG = junction->getBatchObservableFunction(
+			type_index{ typeid(molstat::transport::ZeroBiasConductance) } );
+		const auto BatchDiffG = junction->getBatchObservableFunction(
+			type_index{ typeid(molstat::transport::DifferentialConductance) } );
+
+		const size_t nparams{ junction->get_num_parameters() };
+		vector<valarray<double>> trials;
+		for(const double loading : { 0., 1.5, 6. })
+			for(const double kba : { 0.3, 4., -1. })
+				for(const double time : { 0.2, 2. })
+				{
+					params[ChannelType::Index_V] = 0.4 * time;
+					params[ChannelType::Index_kAB] = 0.8;
+					params[ChannelType::Index_kBA] = kba;
+					params[ChannelType::Index_kR] = 0.05;
+					params[ChannelType::Index_loading] = loading;
+					params[ChannelType::Index_time] = time;
+					trials.push_back(params);
+				}
+
+		// parameter-major storage
+		const size_t ntrials{ trials.size() };
+		vector<double> storage(nparams * ntrials);
+		vector<const double *> batch(nparams);
+		for(size_t j = 0; j < nparams; ++j)
+		{
+			for(size_t t = 0; t < ntrials; ++t)
+				storage[j*ntrials + t] = trials[t][j];
+			batch[j] = storage.data() + j*ntrials;
+		}
+
+		vector<double> g(ntrials), diffg(ntrials);
+		BatchG(batch.data(), nparams, ntrials, g.data());
+		BatchDiffG(batch.data(), nparams, ntrials, diffg.data());
+		for(size_t t = 0; t < ntrials; ++t)
+		{
+			if(trials[t][ChannelType::Index_kBA] < 0.)
+			{
+				assert(std::isnan(g[t]) && std::isnan(diffg[t]));
+				continue;
+			}
+
+			assert(abs(g[t] - ZeroBiasG(trials[t])) < thresh);
+			assert(abs(diffg[t] - DiffG(trials[t])) < thresh);
+
+			// the junction can only rupture, so the conductance is at most
+			// that of the better-conducting conformation
+			assert(g[t] > -thresh && g[t] < tb + thresh);
+		}
+
+		// smaller batches (padded in the solver of the full batch) agree
+		for(const size_t n : { size_t(5), ntrials - 1 })
+		{
+			vector<double> gn(n);
+			BatchG(batch.data(), nparams, n, gn.data());
+			for(size_t t = 0; t < n; ++t)
+				assert((std::isnan(g[t]) && std::isnan(gn[t])) ||
+					abs(gn[t] - g[t]) < thresh);
+		}
+	}
+
+	return 0;
+}
@@ -16,7 +16,9 @@
  */
 
 #include <cassert>
+#include <cmath>
 #include <valarray>
+#include <vector>
 
 #include <electron_transport/simulator_models/sym_one_site_channel.h>
 
@@ -44,6 +46,7 @@ int main(int argc, char **argv)
 			.setDistribution("epsilon", nullptr)
 			.setDistribution("gamma", nullptr)
 			.setDistribution("a", nullptr)
+			.setDistribution("nm", nullptr)
 			.getModel()
 		);
 	assert(channel != nullptr);
@@ -68,8 +71,11 @@ int main(int argc, char **argv)
 		type_index{ typeid(molstat::transport::StaticConductance) } );
 	auto DiffG = junction->getObservableFunction(
 		type_index{ typeid(molstat::transport::DifferentialConductance) } );
+	auto ZeroBiasS = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::ZeroBiasThermopower) } );
 
 	valarray<double> params(junction->get_num_parameters());
+	params[ChannelType::Index_nm] = 1.;
 
 	// check known values for several parameter sets
 	params[ChannelType::Index_EF] = 0.;
@@ -148,6 +154,74 @@ int main(int argc, char **argv)
 	assert(abs(0.00111445 - StaticG(params)) < thresh);
 	assert(abs(0.00110948 - DiffG(params)) < thresh);
 	assert(abs(params[ChannelType::Index_V] - AppBias(params)) < thresh);
+	assert(abs(2. * 20. / (400. + 0.67*0.67) - ZeroBiasS(params)) < thresh);
+
+	// the fused conductance and thermopower agree with the individual
+	// observables, as do the batch kernels
+	{
+		const vector<type_index> obs{
+			type_index{ typeid(molstat::transport::ZeroBiasConductance) },
+			type_index{ typeid(molstat::transport::ZeroBiasThermopower) } };
+		auto Fused = junction->getFusedObservableFunction(obs);
+		auto BatchS = junction->getBatchObservableFunction(obs[1]);
+
+		vector<valarray<double>> trials;
+		for(const double eps : { -4., -0.5, 0.3, 2. })
+		{
+			params[ChannelType::Index_epsilon] = eps;
+			trials.push_back(params);
+		}
+
+		const size_t nparams{ junction->get_num_parameters() };
+		const size_t ntrials{ trials.size() };
+		vector<double> storage(nparams * ntrials);
+		vector<const double *> batch(nparams);
+		for(size_t j = 0; j < nparams; ++j)
+		{
+			for(size_t t = 0; t < ntrials; ++t)
+				storage[j*ntrials + t] = trials[t][j];
+			batch[j] = storage.data() + j*ntrials;
+		}
+
+		vector<double> s(ntrials);
+		BatchS(batch.data(), nparams, ntrials, s.data());
+		for(size_t t = 0; t < ntrials; ++t)
+		{
+			double fused[2];
+			Fused(trials[t], fused);
+			assert(abs(fused[0] - ZeroBiasG(trials[t])) < 1.e-12);
+			assert(abs(fused[1] - ZeroBiasS(trials[t])) < 1.e-12);
+			assert(abs(s[t] - ZeroBiasS(trials[t])) < 1.e-12);
+		}
+	}
+
+	// with two channels, the thermopower is the conductance-weighted average
+	{
+		shared_ptr<molstat::SimulateModel> two =
+			molstat::SimulateModelFactory::makeFactory
+				<molstat::transport::TransportJunction>()
+			.setDistribution("ef", nullptr)
+			.setDistribution("v", nullptr)
+			.addSubmodel(channel)
+			.addSubmodel(channel)
+			.getModel();
+		auto TwoS = two->getObservableFunction(
+			type_index{ typeid(molstat::transport::ZeroBiasThermopower) } );
+
+		valarray<double> both(two->get_num_parameters());
+		both[slice(0, params.size(), 1)] = params;
+		const size_t nchannel{ params.size() - 3 };
+		both[slice(params.size(), nchannel, 1)] =
+			params[slice(3, nchannel, 1)];
+		both[params.size() + ChannelType::Index_epsilon - 3] = -1.;
+
+		valarray<double> other(params);
+		other[ChannelType::Index_epsilon] = -1.;
+
+		const double g1{ ZeroBiasG(params) }, g2{ ZeroBiasG(other) };
+		assert(abs((g1 * ZeroBiasS(params) + g2 * ZeroBiasS(other))
+			/ (g1 + g2) - TwoS(both)) < 1.e-12);
+	}
 
 	return 0;
 }
@@ -0,0 +1,258 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/simulate-TightBinding.cc
+ * \brief Test suite for the N-site tight-binding channel.
+ *
+ * \test Test suite for the N-site tight-binding channel. The two-site chain
+ *    is compared to the two-site channels, the one-site chain to the one-site
+ *    channel, and the chain and ring algorithms to each other.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <valarray>
+
+#include <electron_transport/simulator_models/tight_binding_channel.h>
+#include <electron_transport/simulator_models/asym_one_site_channel.h>
+#include <electron_transport/simulator_models/asym_two_site_channel.h>
+
+using namespace std;
+
+/// Shortcut for the type of channel used in this test.
+using ChannelType = molstat::transport::TightBindingChannel;
+
+/**
+ * \brief Main function for testing the N-site tight-binding model.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh{ 1.e-6 };
+
+	// use the factory to create a channel
+	shared_ptr<ChannelType> channel = dynamic_pointer_cast<ChannelType>(
+			molstat::SimulateModelFactory::makeFactory<ChannelType>()
+			// not going to need the distributions, but the factory framework
+			// requires them
+			.setDistribution("epsilon", nullptr)
+			.setDistribution("gammal", nullptr)
+			.setDistribution("gammar", nullptr)
+			.setDistribution("beta", nullptr)
+			.setDistribution("nsites", nullptr)
+			.setDistribution("betaring", nullptr)
+			.getModel()
+		);
+	assert(channel != nullptr);
+
+	// use the factory to create a junction
+	shared_ptr<molstat::SimulateModel> junction =
+		molstat::SimulateModelFactory::makeFactory
+			<molstat::transport::TransportJunction>()
+		.setDistribution("ef", nullptr)
+		.setDistribution("v", nullptr)
+		.addSubmodel(channel)
+		.getModel();
+
+	// get the observable functions
+	auto AppBias = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::AppliedBias) } );
+	auto ECurrent = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::ElectricCurrent) } );
+	auto ZeroBiasG = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::ZeroBiasConductance) } );
+	auto StaticG = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::StaticConductance) } );
+	auto DiffG = junction->getObservableFunction(
+		type_index{ typeid(molstat::transport::DifferentialConductance) } );
+
+	valarray<double> params(junction->get_num_parameters());
+
+	// a two-site chain with symmetric couplings (compare to
+	// simulate-SymTwoSite)
+	params[ChannelType::Index_nsites] = 2.;
+	params[ChannelType::Index_betaring] = 0.;
+
+	params[ChannelType::Index_EF] = 0.;
+	params[ChannelType::Index_V] = 1.;
+	params[ChannelType::Index_epsilon] = -4.;
+	params[ChannelType::Index_gammaL] = 0.8;
+	params[ChannelType::Index_gammaR] = 0.8;
+	params[ChannelType::Index_beta] = -3.;
+	assert(abs(0.101007 - ZeroBiasG(params)) < thresh);
+	assert(abs(0.127042 - ECurrent(params)) < thresh);
+	assert(abs(0.127042 - StaticG(params)) < thresh);
+	assert(abs(0.186815 - DiffG(params)) < thresh);
+	assert(abs(params[ChannelType::Index_V] - AppBias(params)) < thresh);
+
+	params[ChannelType::Index_EF] = 1.;
+	params[ChannelType::Index_V] = -0.4;
+	params[ChannelType::Index_epsilon] = -3.;
+	params[ChannelType::Index_gammaL] = 0.4;
+	params[ChannelType::Index_gammaR] = 0.4;
+	params[ChannelType::Index_beta] = -0.8;
+	assert(abs(0.000431590 - ZeroBiasG(params)) < thresh);
+	assert(abs(-0.000174208 - ECurrent(params)) < thresh);
+	assert(abs(0.000435520 - StaticG(params)) < thresh);
+	assert(abs(0.000443426 - DiffG(params)) < thresh);
+
+	// the ring coupling adds to the inter-site coupling for two sites
+	params[ChannelType::Index_EF] = 3.;
+	params[ChannelType::Index_V] = 1.4;
+	params[ChannelType::Index_epsilon] = 1.1;
+	params[ChannelType::Index_gammaL] = 0.67;
+	params[ChannelType::Index_gammaR] = 0.67;
+	params[ChannelType::Index_beta] = -1.;
+	params[ChannelType::Index_betaring] = -0.6;
+	assert(abs(0.459683 - ZeroBiasG(params)) < thresh);
+	assert(abs(0.673107 - ECurrent(params)) < thresh);
+	assert(abs(0.480791 - StaticG(params)) < thresh);
+	assert(abs(0.294527 - DiffG(params)) < thresh);
+
+	// a two-site chain with asymmetric couplings
+	params[ChannelType::Index_betaring] = 0.;
+	for(const double e : { -2., 0.3, 1.1, 2.5 })
+	{
+		const double eps{ 0.4 }, gl{ 0.3 }, gr{ 1.2 }, beta{ -0.7 };
+		const double z{ e - eps };
+		const double temp{ 4.*z*z - 4.*beta*beta - gl*gr };
+		const double exact{ 16.*gl*gr*beta*beta /
+			(temp*temp + 4.*(gl+gr)*(gl+gr)*z*z) };
+
+		assert(abs(exact - ChannelType::transmission(e, eps, gl, gr, beta, 2.,
+			0.)) < 1.e-12);
+	}
+
+	// a single site (compare to the asymmetric one-site channel)
+	for(const double e : { -2., 0.3, 1.1, 2.5 })
+	{
+		const double eps{ 0.4 }, gl{ 0.3 }, gr{ 1.2 };
+		const double exact{ 4.*gl*gr /
+			(4.*(e-eps)*(e-eps) + (gl+gr)*(gl+gr)) };
+
+		assert(abs(exact - ChannelType::transmission(e, eps, gl, gr, -1., 1.,
+			0.5)) < 1.e-12);
+	}
+
+	// no sites, no observables
+	params[ChannelType::Index_nsites] = 0.;
+	assert(std::isnan(ZeroBiasG(params)));
+	assert(std::isnan(ECurrent(params)));
+
+	// longer chains: the ring algorithm with a negligible ring coupling
+	// agrees with the recursion
+	for(const double n : { 3., 6., 12., 20. })
+	{
+		for(const double e : { -2.3, -0.5, 0., 0.21, 1.7 })
+		{
+			const double chain{ ChannelType::transmission(e, 0.1, 0.5, 0.9,
+				-1., n, 0.) };
+			const double ring{ ChannelType::transmission(e, 0.1, 0.5, 0.9,
+				-1., n, 1.e-10) };
+
+			assert(chain >= 0. && chain <= 1.);
+			assert(abs(chain - ring) < 1.e-6);
+		}
+	}
+
+	// a four-site ring with symmetric couplings, where the paths around the
+	// ring interfere: at the site energy (a doubly-degenerate eigenvalue of
+	// the ring), the transmission through the end sites vanishes
+	assert(ChannelType::transmission(0., 0., 1., 1., -1., 4., -1.) < 1.e-12);
+
+	// the chain is fully transparent in the middle of the band when the
+	// couplings match the band
+	assert(abs(1. - ChannelType::transmission(0., 0., 2., 2., -1., 6., 0.))
+		< 1.e-12);
+
+	// the fused observables agree with the individual ones
+	params[ChannelType::Index_nsites] = 7.;
+	params[ChannelType::Index_betaring] = -0.3;
+	params[ChannelType::Index_EF] = 0.2;
+	params[ChannelType::Index_V] = 0.8;
+	params[ChannelType::Index_epsilon] = -0.1;
+	params[ChannelType::Index_gammaL] = 0.2;
+	params[ChannelType::Index_gammaR] = 0.5;
+	params[ChannelType::Index_beta] = -0.9;
+	{
+		const molstat::FusedObservableFunction fused{
+			channel->getFusedObservableFunction({
+				molstat::GetObservableIndex<molstat::transport::ElectricCurrent>(),
+				molstat::GetObservableIndex
+					<molstat::transport::StaticConductance>(),
+				molstat::GetObservableIndex
+					<molstat::transport::ZeroBiasConductance>(),
+				molstat::GetObservableIndex
+					<molstat::transport::DifferentialConductance>() }) };
+		assert(fused);
+
+		double out[4];
+		fused(params, out);
+		assert(abs(out[0] - ECurrent(params)) < thresh);
+		assert(abs(out[1] - StaticG(params)) < thresh);
+		assert(abs(out[2] - ZeroBiasG(params)) < thresh);
+		assert(abs(out[3] - DiffG(params)) < thresh);
+		assert(abs(out[0] - out[1] * params[ChannelType::Index_V]) < thresh);
+	}
+
+	// finite temperature: the numerical integral over the Fermi window agrees
+	// with the pole expansions of the one- and two-site channels (the
+	// parameters are in the same positions, and a = 0 for the one-site
+	// channel)
+	{
+		const auto asym1 = make_shared<molstat::transport::AsymOneSiteChannel>();
+		const auto asym2 = make_shared<molstat::transport::AsymTwoSiteChannel>();
+
+		params[ChannelType::Index_EF] = 0.2;
+		params[ChannelType::Index_V] = 0.6;
+		params[ChannelType::Index_kT] = 0.05;
+		params[ChannelType::Index_epsilon] = 0.5;
+		params[ChannelType::Index_gammaL] = 0.3;
+		params[ChannelType::Index_gammaR] = 0.2;
+		params[ChannelType::Index_beta] = -0.4;
+		params[ChannelType::Index_betaring] = 0.;
+
+		params[ChannelType::Index_nsites] = 2.;
+		assert(abs(asym2->ECurrent(params) - ECurrent(params)) < thresh);
+
+		params[ChannelType::Index_nsites] = 1.;
+		params[ChannelType::Index_beta] = 0.;
+		assert(abs(asym1->ECurrent(params) - ECurrent(params)) < thresh);
+		params[ChannelType::Index_kT] = 0.;
+	}
+
+	// fixed-order quadrature for the current
+	{
+		const double adaptive{ ECurrent(params) };
+		ChannelType::setStaticGQuadrature(64, 1.e-9, 1.e-9);
+		assert(abs(adaptive - ECurrent(params)) < 1.e-4);
+		ChannelType::setStaticGQuadrature(0, 1.e-9, 1.e-9);
+
+		// a relative tolerance alone, as from the histogram's precision
+		ChannelType::setStaticGQuadrature(0, 0., 1.e-4);
+		assert(abs(adaptive - ECurrent(params)) < 1.e-3 * abs(adaptive));
+		ChannelType::setStaticGQuadrature(0, 1.e-9, 1.e-9);
+
+		try
+		{
+			ChannelType::setStaticGQuadrature(0, 0., 0.);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
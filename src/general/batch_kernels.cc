@@ -0,0 +1,32 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file batch_kernels.cc
+ * \brief Support for vectorized batch kernels.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "batch_kernels.h"
+
+namespace molstat {
+
+std::string BatchKernelTarget()
+{
+#if HAVE_TARGET_CLONES
+	// the same priority as the resolvers of the clones
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx512f"))
+		return "avx512f";
+	if(__builtin_cpu_supports("avx2"))
+		return "avx2";
+#endif
+
+	return "generic";
+}
+
+} // namespace molstat
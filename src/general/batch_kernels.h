@@ -0,0 +1,50 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file batch_kernels.h
+ * \brief Support for vectorized batch kernels (see
+ *    molstat::SimulateModel::setBatchObservableKernel).
+ *
+ * Batch kernels are simple loops over arrays (of model parameters, random
+ * numbers, or data to bin), which the compiler vectorizes. When supported,
+ * MOLSTAT_BATCH_KERNEL additionally compiles the kernel for AVX-512 and AVX2;
+ * the best version for the processor is selected (from cpuid) when the
+ * program starts, with a generic fallback. One binary thus runs well on
+ * AVX2-only and AVX-512 processors. Configure with
+ * `--disable-target-clones` to compile only the generic version.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __batch_kernels_h__
+#define __batch_kernels_h__
+
+#include <config.h>
+#include <string>
+
+#if HAVE_TARGET_CLONES
+	/// Attribute for compiling a kernel for several instruction sets.
+	#define MOLSTAT_BATCH_KERNEL \
+		__attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+	/// Attribute for compiling a kernel for several instruction sets.
+	#define MOLSTAT_BATCH_KERNEL
+#endif
+
+namespace molstat {
+
+/**
+ * \brief Gets the instruction set of the batch kernels that run on this
+ *    processor.
+ *
+ * \return "avx512f", "avx2", or "generic".
+ */
+std::string BatchKernelTarget();
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,67 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file src/general/binary_io.cc
+ * \brief Functions for writing and reading the values of MolStat's binary
+ *    file formats.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "binary_io.h"
+#include <stdexcept>
+
+namespace molstat {
+
+void WriteBinaryUInt(std::ostream &out, std::uint64_t val)
+{
+	out.write(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+
+void ReadBinaryBytes(std::istream &in, void *dest, std::size_t n,
+	const char *source)
+{
+	in.read(static_cast<char*>(dest), n);
+	if(static_cast<std::size_t>(in.gcount()) != n)
+		throw std::runtime_error(std::string("Unexpected end of ") + source +
+			'.');
+}
+
+std::uint64_t ReadBinaryUInt(std::istream &in, const char *source)
+{
+	std::uint64_t ret;
+	ReadBinaryBytes(in, &ret, sizeof(ret), source);
+	return ret;
+}
+
+void WriteBinaryDouble(std::ostream &out, double val)
+{
+	out.write(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+
+double ReadBinaryDouble(std::istream &in, const char *source)
+{
+	double ret;
+	ReadBinaryBytes(in, &ret, sizeof(ret), source);
+	return ret;
+}
+
+void WriteBinaryString(std::ostream &out, const std::string &str)
+{
+	WriteBinaryUInt(out, str.size());
+	out.write(str.data(), str.size());
+}
+
+std::string ReadBinaryString(std::istream &in, const char *source)
+{
+	std::string ret(ReadBinaryUInt(in, source), '\0');
+	if(!ret.empty())
+		ReadBinaryBytes(in, &ret[0], ret.size(), source);
+	return ret;
+}
+
+} // namespace molstat
@@ -0,0 +1,104 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file binary_io.h
+ * \brief Functions for writing and reading the values of MolStat's binary
+ *    file formats.
+ *
+ * Values are written in the byte order of the machine; each format records
+ * a version number so that a file from a machine with a different byte
+ * order is detected.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __binary_io_h__
+#define __binary_io_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace molstat {
+
+/**
+ * \brief Writes an unsigned integer to a binary stream.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] val The value.
+ */
+void WriteBinaryUInt(std::ostream &out, std::uint64_t val);
+
+/**
+ * \brief Reads bytes from a binary stream.
+ *
+ * \throw std::runtime_error if the stream ends early.
+ *
+ * \param[in,out] in The input stream.
+ * \param[out] dest The destination.
+ * \param[in] n The number of bytes.
+ * \param[in] source What the stream holds (e.g., "the checkpoint"), for the
+ *    error message.
+ */
+void ReadBinaryBytes(std::istream &in, void *dest, std::size_t n,
+	const char *source);
+
+/**
+ * \brief Reads an unsigned integer from a binary stream.
+ *
+ * \throw std::runtime_error if the stream ends early.
+ *
+ * \param[in,out] in The input stream.
+ * \param[in] source What the stream holds, for the error message.
+ * \return The value.
+ */
+std::uint64_t ReadBinaryUInt(std::istream &in, const char *source);
+
+/**
+ * \brief Writes a double to a binary stream.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] val The value.
+ */
+void WriteBinaryDouble(std::ostream &out, double val);
+
+/**
+ * \brief Reads a double from a binary stream.
+ *
+ * \throw std::runtime_error if the stream ends early.
+ *
+ * \param[in,out] in The input stream.
+ * \param[in] source What the stream holds, for the error message.
+ * \return The value.
+ */
+double ReadBinaryDouble(std::istream &in, const char *source);
+
+/**
+ * \brief Writes a string (its length, then its characters) to a binary
+ *    stream.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] str The string.
+ */
+void WriteBinaryString(std::ostream &out, const std::string &str);
+
+/**
+ * \brief Reads a string written by WriteBinaryString().
+ *
+ * \throw std::runtime_error if the stream ends early.
+ *
+ * \param[in,out] in The input stream.
+ * \param[in] source What the stream holds, for the error message.
+ * \return The string.
+ */
+std::string ReadBinaryString(std::istream &in, const char *source);
+
+} // namespace molstat
+
+#endif
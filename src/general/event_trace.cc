@@ -0,0 +1,172 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file event_trace.cc
+ * \brief Implements the trace events.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "event_trace.h"
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace molstat {
+
+/// \cond
+namespace {
+
+/// A recorded event.
+struct RecordedEvent
+{
+	/// The name of the event.
+	const char *name;
+
+	/// The start (ns since the trace's epoch).
+	std::int64_t start;
+
+	/// The duration (ns).
+	std::int64_t duration;
+};
+
+/// The events recorded by one thread.
+struct ThreadEvents
+{
+	/// The thread's number in the trace.
+	std::size_t tid;
+
+	/// The events, in the order they ended.
+	std::vector<RecordedEvent> events;
+};
+
+/**
+ * \brief The events of every thread.
+ *
+ * The trace is written when this is destroyed, at the program's exit.
+ */
+struct EventTrace
+{
+	/// The time from which the events are measured.
+	const std::chrono::steady_clock::time_point epoch
+		{ std::chrono::steady_clock::now() };
+
+	/// Guards the list of threads.
+	std::mutex mutex;
+
+	/// The events of each thread; threads may end before the trace is written.
+	std::vector<std::shared_ptr<ThreadEvents>> threads;
+
+	~EventTrace()
+	{
+		const char *const env{ std::getenv("MOLSTAT_EVENT_TRACE") };
+		if(env == nullptr || *env == '\0')
+			return;
+
+		std::string filename{ env };
+		const std::size_t pos{ filename.find("%p") };
+		if(pos != std::string::npos)
+			filename.replace(pos, 2, std::to_string(getpid()));
+
+		std::ofstream out{ filename };
+		if(out.is_open())
+			WriteEventTrace(out);
+	}
+};
+
+/**
+ * \brief Gets the events of every thread.
+ *
+ * \return The events.
+ */
+EventTrace &GetEventTrace()
+{
+	static EventTrace trace;
+	return trace;
+}
+
+/**
+ * \brief Gets the events of the calling thread, registering it on first use.
+ *
+ * \return The thread's events.
+ */
+ThreadEvents &GetThreadEvents()
+{
+	thread_local std::shared_ptr<ThreadEvents> local;
+
+	if(local == nullptr)
+	{
+		EventTrace &trace = GetEventTrace();
+		const std::lock_guard<std::mutex> lock{ trace.mutex };
+		local = std::make_shared<ThreadEvents>();
+		local->tid = trace.threads.size();
+		trace.threads.push_back(local);
+	}
+
+	return *local;
+}
+
+} // anonymous namespace
+/// \endcond
+
+TraceEvent::TraceEvent(const char *name_) noexcept
+	: name(name_)
+{
+	// the trace's epoch precedes every event
+	GetEventTrace();
+	start = std::chrono::steady_clock::now();
+}
+
+TraceEvent::~TraceEvent()
+{
+	const std::chrono::steady_clock::time_point end
+		{ std::chrono::steady_clock::now() };
+	ThreadEvents &local = GetThreadEvents();
+	const auto ns = [] (std::chrono::steady_clock::duration d) -> std::int64_t
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+	};
+
+	local.events.push_back(
+		{ name, ns(start - GetEventTrace().epoch), ns(end - start) });
+}
+
+void WriteEventTrace(std::ostream &out)
+{
+	EventTrace &trace = GetEventTrace();
+	const std::lock_guard<std::mutex> lock{ trace.mutex };
+	const long pid{ static_cast<long>(getpid()) };
+	bool first{ true };
+
+	// the times are in microseconds
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	for(const std::shared_ptr<ThreadEvents> &thread : trace.threads)
+		for(const RecordedEvent &event : thread->events)
+		{
+			out << (first ? "\n" : ",\n") << "{\"name\":\"";
+			for(const char *c = event.name; *c != '\0'; ++c)
+			{
+				if(*c == '"' || *c == '\\')
+					out << '\\';
+				out << *c;
+			}
+			out << "\",\"cat\":\"molstat\",\"ph\":\"X\",\"ts\":" <<
+				event.start / 1000 << '.' << event.start % 1000 / 100 <<
+				",\"dur\":" << event.duration / 1000 << '.' <<
+				event.duration % 1000 / 100 << ",\"pid\":" << pid <<
+				",\"tid\":" << thread->tid << '}';
+			first = false;
+		}
+	out << "\n]}" << std::endl;
+}
+
+} // namespace molstat
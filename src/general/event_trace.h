@@ -0,0 +1,99 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file event_trace.h
+ * \brief Scoped trace events on the hot paths, written in the Chrome trace
+ *    format.
+ *
+ * The hot paths (parameter generation, the observables, binning, output, and
+ * the fitter's rounds) are marked with MOLSTAT_TRACE_EVENT. The marks compile
+ * to nothing unless MolStat is configured with `--enable-event-trace`. When
+ * enabled, each thread records the start and duration of its events, and the
+ * events are written when the program exits to the file named by the
+ * `MOLSTAT_EVENT_TRACE` environment variable (nothing is written if it is
+ * unset). Any `%%p` in the name is replaced by the process ID, so that each
+ * MPI process writes its own file.
+ *
+ * The file is in the Chrome trace event format, which can be viewed with
+ * `chrome://tracing` or Perfetto (https://ui.perfetto.dev).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __event_trace_h__
+#define __event_trace_h__
+
+#include <config.h>
+#include <chrono>
+#include <ostream>
+
+/// \cond
+#define MOLSTAT_TRACE_CONCAT_(a, b) a##b
+#define MOLSTAT_TRACE_CONCAT(a, b) MOLSTAT_TRACE_CONCAT_(a, b)
+/// \endcond
+
+#if HAVE_EVENT_TRACE
+/**
+ * \brief Records a trace event from here to the end of the enclosing scope.
+ *
+ * \param[in] name The name of the event, a string literal.
+ */
+#define MOLSTAT_TRACE_EVENT(name) \
+	const molstat::TraceEvent MOLSTAT_TRACE_CONCAT(molstat_trace_, __LINE__) \
+		{ name }
+#else
+#define MOLSTAT_TRACE_EVENT(name) static_cast<void>(0)
+#endif
+
+namespace molstat {
+
+/**
+ * \brief A trace event, from the object's construction to its destruction.
+ *
+ * Use MOLSTAT_TRACE_EVENT to mark the hot paths, so that the events compile
+ * to nothing when tracing is disabled.
+ */
+class TraceEvent
+{
+private:
+	/// The name of the event.
+	const char *const name;
+
+	/// The start of the event.
+	std::chrono::steady_clock::time_point start;
+
+public:
+	TraceEvent() = delete;
+	TraceEvent(const TraceEvent &) = delete;
+	TraceEvent &operator=(const TraceEvent &) = delete;
+
+	/**
+	 * \brief Starts an event.
+	 *
+	 * \param[in] name_ The name of the event. It is not copied, and must be a
+	 *    string literal (or otherwise outlive the program's events).
+	 */
+	explicit TraceEvent(const char *name_) noexcept;
+
+	/**
+	 * \brief Ends the event and records it for this thread.
+	 */
+	~TraceEvent();
+};
+
+/**
+ * \brief Writes the events recorded so far in the Chrome trace format.
+ *
+ * The threads recording events must not be running.
+ *
+ * \param[in,out] out The output stream.
+ */
+void WriteEventTrace(std::ostream &out);
+
+} // namespace molstat
+
+#endif
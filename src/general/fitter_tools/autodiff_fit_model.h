@@ -0,0 +1,102 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file autodiff_fit_model.h
+ * \brief Fit models whose Jacobians are calculated by automatic
+ *    differentiation.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __autodiff_fit_model_h__
+#define __autodiff_fit_model_h__
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <list>
+#include <utility>
+#include <vector>
+#include "dual.h"
+#include "fit_model_interface.h"
+
+namespace molstat {
+
+/**
+ * \brief A FitModel that only defines its residual; the Jacobian is
+ *    calculated (exactly, and together with the residual) by forward-mode
+ *    automatic differentiation.
+ *
+ * The model (`Model`, using the curiously recurring template pattern)
+ * provides the public member function template
+ * \code
+ * template<typename T>
+ * T generic_resid(const std::array<T, M> &fitparam,
+ *    const std::array<double, N> &x, const double f) const;
+ * \endcode
+ * which is instantiated with `T = double` for the residual and with
+ * `T = Dual<M>` for the residual and Jacobian. It should bring the standard
+ * math functions into scope with using-declarations (see dual.h).
+ *
+ * \tparam Model The fit model.
+ * \tparam N The number of independent variables in the fit function.
+ * \tparam M The number of fitting parameters.
+ */
+template<typename Model, std::size_t N, std::size_t M>
+class AutoDiffFitModel : public FitModel<N>
+{
+public:
+	AutoDiffFitModel() = delete;
+	virtual ~AutoDiffFitModel() = default;
+
+	/**
+	 * \brief Constructor requiring the data that we will be fitting against.
+	 *
+	 * \param[in] data The data, organized in pairs of array<double, N>,
+	 *    double objects.
+	 */
+	AutoDiffFitModel(
+		const std::list<std::pair<std::array<double, N>, double>> &data)
+		: FitModel<N>(M, data)
+	{
+	}
+
+	virtual double resid(const std::vector<double> &fitparam,
+		const std::array<double, N> &x, const double f) const override
+	{
+		std::array<double, M> params;
+		std::copy(fitparam.begin(), fitparam.begin() + M, params.begin());
+
+		return static_cast<const Model&>(*this).generic_resid(params, x, f);
+	}
+
+	virtual void jacobian_row(const std::vector<double> &fitparam,
+		const std::array<double, N> &x, const double f, double *jac) const
+		override
+	{
+		resid_j_row(fitparam, x, f, jac);
+	}
+
+	virtual double resid_j_row(const std::vector<double> &fitparam,
+		const std::array<double, N> &x, const double f, double *jac) const
+		override
+	{
+		std::array<Dual<M>, M> params;
+		for(std::size_t i = 0; i < M; ++i)
+			params[i] = Dual<M>::variable(fitparam[i], i);
+
+		const Dual<M> ret{
+			static_cast<const Model&>(*this).generic_resid(params, x, f) };
+		std::copy(ret.grad.begin(), ret.grad.end(), jac);
+
+		return ret.value;
+	}
+};
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,288 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file dual.h
+ * \brief Dual numbers for forward-mode automatic differentiation.
+ *
+ * A molstat::Dual carries a value and its gradient with respect to `M`
+ * independent variables. Evaluating a function with Dual arguments gives its
+ * value and (exact) gradient together, without allocating memory.
+ *
+ * Functions written for both `double` and Dual arguments should bring the
+ * standard math functions into scope with using-declarations (e.g.,
+ * `using std::exp;`); the Dual overloads are then found by argument-dependent
+ * lookup.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __dual_h__
+#define __dual_h__
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace molstat {
+
+/**
+ * \brief A value and its gradient with respect to `M` variables.
+ *
+ * \tparam M The number of independent variables.
+ */
+template<std::size_t M>
+class Dual
+{
+public:
+	/// The value.
+	double value;
+
+	/// The derivative of the value with respect to each variable.
+	std::array<double, M> grad;
+
+	/**
+	 * \brief Constructor for a constant (zero gradient).
+	 *
+	 * \param[in] value_ The value.
+	 */
+	Dual(const double value_ = 0.) : value(value_), grad()
+	{
+		grad.fill(0.);
+	}
+
+	/**
+	 * \brief Creates one of the independent variables.
+	 *
+	 * \param[in] value_ The value of the variable.
+	 * \param[in] index The index of the variable.
+	 * \return The variable (its gradient is the unit vector `index`).
+	 */
+	static Dual variable(const double value_, const std::size_t index)
+	{
+		Dual ret(value_);
+		ret.grad[index] = 1.;
+		return ret;
+	}
+
+	/**
+	 * \brief Applies the chain rule: a function with value `fvalue` and
+	 *    derivative `fprime` evaluated at this number.
+	 *
+	 * \param[in] fvalue The value of the function.
+	 * \param[in] fprime The derivative of the function.
+	 * \return The function, as a Dual number.
+	 */
+	Dual chain(const double fvalue, const double fprime) const
+	{
+		Dual ret(fvalue);
+		for(std::size_t i = 0; i < M; ++i)
+			ret.grad[i] = fprime * grad[i];
+		return ret;
+	}
+
+	Dual &operator+=(const Dual &rhs)
+	{
+		value += rhs.value;
+		for(std::size_t i = 0; i < M; ++i)
+			grad[i] += rhs.grad[i];
+		return *this;
+	}
+
+	Dual &operator-=(const Dual &rhs)
+	{
+		value -= rhs.value;
+		for(std::size_t i = 0; i < M; ++i)
+			grad[i] -= rhs.grad[i];
+		return *this;
+	}
+
+	Dual &operator*=(const Dual &rhs)
+	{
+		for(std::size_t i = 0; i < M; ++i)
+			grad[i] = grad[i] * rhs.value + value * rhs.grad[i];
+		value *= rhs.value;
+		return *this;
+	}
+
+	Dual &operator/=(const Dual &rhs)
+	{
+		const double inv{ 1. / rhs.value };
+		value *= inv;
+		for(std::size_t i = 0; i < M; ++i)
+			grad[i] = (grad[i] - value * rhs.grad[i]) * inv;
+		return *this;
+	}
+
+	Dual &operator+=(const double rhs)
+	{
+		value += rhs;
+		return *this;
+	}
+
+	Dual &operator-=(const double rhs)
+	{
+		value -= rhs;
+		return *this;
+	}
+
+	Dual &operator*=(const double rhs)
+	{
+		value *= rhs;
+		for(std::size_t i = 0; i < M; ++i)
+			grad[i] *= rhs;
+		return *this;
+	}
+
+	Dual &operator/=(const double rhs)
+	{
+		return *this *= 1. / rhs;
+	}
+};
+
+// arithmetic
+template<std::size_t M>
+inline Dual<M> operator-(const Dual<M> &x)
+{
+	return x.chain(-x.value, -1.);
+}
+
+template<std::size_t M>
+inline Dual<M> operator+(Dual<M> lhs, const Dual<M> &rhs)
+{
+	return lhs += rhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator+(Dual<M> lhs, const double rhs)
+{
+	return lhs += rhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator+(const double lhs, Dual<M> rhs)
+{
+	return rhs += lhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator-(Dual<M> lhs, const Dual<M> &rhs)
+{
+	return lhs -= rhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator-(Dual<M> lhs, const double rhs)
+{
+	return lhs -= rhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator-(const double lhs, const Dual<M> &rhs)
+{
+	return -rhs + lhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator*(Dual<M> lhs, const Dual<M> &rhs)
+{
+	return lhs *= rhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator*(Dual<M> lhs, const double rhs)
+{
+	return lhs *= rhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator*(const double lhs, Dual<M> rhs)
+{
+	return rhs *= lhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator/(Dual<M> lhs, const Dual<M> &rhs)
+{
+	return lhs /= rhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator/(Dual<M> lhs, const double rhs)
+{
+	return lhs /= rhs;
+}
+
+template<std::size_t M>
+inline Dual<M> operator/(const double lhs, const Dual<M> &rhs)
+{
+	const double inv{ 1. / rhs.value };
+	return rhs.chain(lhs * inv, -lhs * inv * inv);
+}
+
+// math functions
+template<std::size_t M>
+inline Dual<M> exp(const Dual<M> &x)
+{
+	const double e{ std::exp(x.value) };
+	return x.chain(e, e);
+}
+
+template<std::size_t M>
+inline Dual<M> log(const Dual<M> &x)
+{
+	return x.chain(std::log(x.value), 1. / x.value);
+}
+
+template<std::size_t M>
+inline Dual<M> sqrt(const Dual<M> &x)
+{
+	const double s{ std::sqrt(x.value) };
+	return x.chain(s, 0.5 / s);
+}
+
+template<std::size_t M>
+inline Dual<M> pow(const Dual<M> &x, const double p)
+{
+	const double xp{ std::pow(x.value, p - 1.) };
+	return x.chain(xp * x.value, p * xp);
+}
+
+template<std::size_t M>
+inline Dual<M> sin(const Dual<M> &x)
+{
+	return x.chain(std::sin(x.value), std::cos(x.value));
+}
+
+template<std::size_t M>
+inline Dual<M> cos(const Dual<M> &x)
+{
+	return x.chain(std::cos(x.value), -std::sin(x.value));
+}
+
+template<std::size_t M>
+inline Dual<M> atan(const Dual<M> &x)
+{
+	return x.chain(std::atan(x.value), 1. / (1. + x.value * x.value));
+}
+
+template<std::size_t M>
+inline Dual<M> erf(const Dual<M> &x)
+{
+	// d/dx erf(x) = 2/sqrt(pi) exp(-x^2)
+	return x.chain(std::erf(x.value),
+		1.1283791670955126 * std::exp(-x.value * x.value));
+}
+
+template<std::size_t M>
+inline Dual<M> abs(const Dual<M> &x)
+{
+	return x.value < 0. ? -x : x;
+}
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,88 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file fit_data.cc
+ * \brief Implements reading the data to fit from text files.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "fit_data.h"
+#include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace molstat {
+
+std::vector<double> ReadDataColumns(std::istream &in, const std::size_t ncol)
+{
+	// read the whole stream; the buffer is null-terminated, which std::strtod
+	// needs to stop at the end
+	const std::string buffer{ std::istreambuf_iterator<char>(in),
+		std::istreambuf_iterator<char>() };
+	std::vector<double> ret;
+	ret.reserve(buffer.size() / 8);
+
+	const char *pos{ buffer.c_str() };
+	std::size_t line{ 1 }, col{ 0 };
+	while(true)
+	{
+		// skip spaces within the line
+		while(*pos == ' ' || *pos == '\t' || *pos == '\r')
+			++pos;
+
+		// ignore comments
+		if(*pos == '#')
+			while(*pos != '\n' && *pos != '\0')
+				++pos;
+
+		if(*pos == '\n' || *pos == '\0')
+		{
+			if(col != 0)
+				throw std::runtime_error("Line " + std::to_string(line) +
+					" has " + std::to_string(col) + " number(s); " +
+					std::to_string(ncol) + " expected.");
+
+			if(*pos == '\0')
+				break;
+
+			++pos;
+			++line;
+			continue;
+		}
+
+		char *end;
+		const double value{ std::strtod(pos, &end) };
+		if(end == pos || (*end != '\0' && *end != ' ' && *end != '\t' &&
+			*end != '\r' && *end != '\n' && *end != '#'))
+		{
+			throw std::runtime_error("Unable to read a number in line " +
+				std::to_string(line) + ".");
+		}
+
+		ret.push_back(value);
+		pos = end;
+
+		++col;
+		if(col == ncol)
+		{
+			// the row is complete; nothing else can be on this line
+			while(*pos == ' ' || *pos == '\t' || *pos == '\r')
+				++pos;
+			if(*pos != '\n' && *pos != '\0' && *pos != '#')
+				throw std::runtime_error("Line " + std::to_string(line) +
+					" has more than " + std::to_string(ncol) + " numbers.");
+
+			col = 0;
+		}
+	}
+
+	return ret;
+}
+
+} // namespace molstat
@@ -0,0 +1,149 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file fit_data.h
+ * \brief Reading the data to fit from text files.
+ *
+ * The data files have one data point per line: the independent variable(s)
+ * followed by the value (e.g., the value of the observable and the
+ * probability density function for this value, as output by
+ * `molstat-simulator`). The whole file is read at once and parsed in place,
+ * which is much faster than extracting the numbers one at a time from a
+ * stream.
+ *
+ * Binary and mergeable histograms written by `molstat-simulator` or
+ * `molstat-merge` (see histogram_io.h) are also accepted; they are detected
+ * automatically.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __fit_data_h__
+#define __fit_data_h__
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <list>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include <general/histogram_tools/histogram_io.h>
+
+namespace molstat {
+
+/**
+ * \brief Reads rows of numbers from a stream.
+ *
+ * Each non-blank line must have exactly `ncol` numbers, separated by spaces
+ * or tabs. Anything after a `#` on a line is ignored.
+ *
+ * \throw std::runtime_error if a line does not have `ncol` numbers.
+ *
+ * \param[in,out] in The input stream; it is read until EOF.
+ * \param[in] ncol The number of numbers per line.
+ * \return The numbers, row by row.
+ */
+std::vector<double> ReadDataColumns(std::istream &in, const std::size_t ncol);
+
+/**
+ * \brief Converts a binary histogram to the data to fit.
+ *
+ * \throw std::runtime_error if the histogram does not have `N` dimensions.
+ *
+ * \tparam N The number of independent variables.
+ * \param[in] hist The histogram.
+ * \return The data points: the coordinates of each bin and its count.
+ */
+template<std::size_t N>
+std::list<std::pair<std::array<double, N>, double>> FitDataFromHistogram(
+	const HistogramData &hist);
+
+/**
+ * \brief Reads the data to fit from a stream.
+ *
+ * The stream contains either text (see ReadDataColumns) or a binary
+ * histogram.
+ *
+ * \throw std::runtime_error if a line does not have `N+1` numbers, or if
+ *    a binary histogram cannot be read or does not have `N` dimensions.
+ *
+ * \tparam N The number of independent variables.
+ * \param[in,out] in The input stream; it is read until EOF.
+ * \param[out] weights If not nullptr, the factor between the raw count and
+ *    the value of each data point: the bin weights of a mergeable
+ *    histogram, and 1 otherwise (the values are taken to be counts).
+ * \return The data points: the independent variables and the value.
+ */
+template<std::size_t N>
+std::list<std::pair<std::array<double, N>, double>> ReadFitData(
+	std::istream &in, std::vector<double> *weights = nullptr);
+
+// templated function definitions
+template<std::size_t N>
+std::list<std::pair<std::array<double, N>, double>> FitDataFromHistogram(
+	const HistogramData &hist)
+{
+	if(hist.coordinates.size() != N)
+		throw std::runtime_error("The histogram has " +
+			std::to_string(hist.coordinates.size()) + " dimension(s); " +
+			std::to_string(N) + " expected.");
+
+	std::list<std::pair<std::array<double, N>, double>> ret;
+
+	// the first dimension changes the fastest
+	std::array<std::size_t, N> index;
+	index.fill(0);
+	for(const double count : hist.counts)
+	{
+		std::pair<std::array<double, N>, double> point;
+		for(std::size_t j = 0; j < N; ++j)
+			point.first[j] = hist.coordinates[j][index[j]];
+		point.second = count;
+		ret.emplace_back(point);
+
+		for(std::size_t j = 0; j < N; ++j)
+		{
+			if(++index[j] < hist.coordinates[j].size())
+				break;
+			index[j] = 0;
+		}
+	}
+
+	return ret;
+}
+
+template<std::size_t N>
+std::list<std::pair<std::array<double, N>, double>> ReadFitData(
+	std::istream &in, std::vector<double> *weights)
+{
+	if(IsBinaryHistogram(in))
+		return FitDataFromHistogram<N>(ReadHistogramBinary(in, weights));
+
+	const std::vector<double> values{ ReadDataColumns(in, N + 1) };
+	std::list<std::pair<std::array<double, N>, double>> ret;
+	if(weights != nullptr)
+		weights->assign(values.size() / (N + 1), 1.);
+
+	for(std::size_t j = 0; j < values.size(); j += N + 1)
+	{
+		std::pair<std::array<double, N>, double> point;
+		std::copy(values.begin() + j, values.begin() + j + N,
+			point.first.begin());
+		point.second = values[j + N];
+
+		ret.emplace_back(point);
+	}
+
+	return ret;
+}
+
+} // namespace molstat
+
+#endif
@@ -12,9 +12,44 @@
  */
 
 #include "fit_model_interface.h"
+#include <cmath>
+#include <stdexcept>
 
 namespace molstat {
 
+thread_local FitProfile *FitProfileScope::current{ nullptr };
+
+/// The relative tolerance of the fit models' numerical integrals.
+static double fit_integration_tolerance{ 1.e-7 };
+
+/// The smallest expected raw count of the Poisson objective.
+static const double min_expected_count{ 1.e-10 };
+
+FitProfileScope::FitProfileScope(FitProfile &profile)
+	: previous(current)
+{
+	current = &profile;
+}
+
+FitProfileScope::~FitProfileScope()
+{
+	current = previous;
+}
+
+void FitProfileScope::record(bool resid, bool jac,
+	std::chrono::steady_clock::time_point start)
+{
+	if(current == nullptr)
+		return;
+
+	if(resid)
+		++current->nresid;
+	if(jac)
+		++current->njac;
+	current->model_seconds += std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
 std::vector<double> gsl_to_std(const gsl_vector *gslv)
 {
 	std::vector<double> ret(gslv->size);
@@ -25,4 +60,92 @@ std::vector<double> gsl_to_std(const gsl_vector *gslv)
 	return ret;
 }
 
+void gsl_to_std(const gsl_vector *gslv, std::vector<double> &stdv)
+{
+	stdv.resize(gslv->size);
+
+	for(std::size_t i = 0; i < gslv->size; ++i)
+		stdv[i] = gsl_vector_get(gslv, i);
+}
+
+void SetFitIntegrationTolerance(double tolerance)
+{
+	if(!(tolerance > 0.))
+		throw std::invalid_argument("The integration tolerance must be " \
+			"positive.");
+
+	fit_integration_tolerance = tolerance;
+}
+
+double FitIntegrationTolerance() noexcept
+{
+	return fit_integration_tolerance;
+}
+
+FitObjective FitObjectiveFromName(const std::string &name)
+{
+	const std::string lname{ to_lower(name) };
+
+	if(lname == "leastsquares")
+		return FitObjective::LeastSquares;
+	else if(lname == "weighted")
+		return FitObjective::WeightedLeastSquares;
+	else if(lname == "poisson")
+		return FitObjective::Poisson;
+
+	throw std::invalid_argument("Unknown fit objective: " + name + ".");
+}
+
+double ObjectiveResidual(FitObjective objective, double model, double f,
+	double weight, std::size_t nfit, double *jac)
+{
+	// the residual and its derivative with respect to the model's value
+	double ret, deriv;
+
+	switch(objective)
+	{
+	case FitObjective::WeightedLeastSquares:
+	{
+		// the standard deviation of the value, at least that of one count
+		const double sigma{ weight * std::sqrt(std::max(f / weight, 1.)) };
+		ret = (model - f) / sigma;
+		deriv = 1. / sigma;
+		break;
+	}
+
+	case FitObjective::Poisson:
+	{
+		// the observed and expected raw counts
+		const double n{ std::max(f / weight, 0.) },
+			mu{ std::max(model / weight, min_expected_count) };
+		// mu - n + n ln(n/mu) = n [t - ln(1 + t)], with t = (mu - n)/n,
+		// avoids the cancellation when mu is close to n
+		const double t{ (mu - n) / n };
+		const double deviance{ n > 0. ? 2. * n * (t - std::log1p(t)) :
+			2. * mu };
+		ret = std::copysign(std::sqrt(std::max(deviance, 0.)), mu - n);
+
+		// the limit at mu = n is 1/sqrt(n); where mu is clamped, the residual
+		// does not depend on the model
+		if(model / weight < min_expected_count)
+			deriv = 0.;
+		else
+			deriv = (ret != 0. ? (1. - n / mu) / ret : 1. / std::sqrt(mu)) /
+				weight;
+		break;
+	}
+
+	default:
+		ret = model - f;
+		deriv = 1.;
+		break;
+	}
+
+	if(jac != nullptr)
+		for(std::size_t k = 0; k < nfit; ++k)
+			jac[k] *= deriv;
+
+	return ret;
+}
+
 } // namespace molstat
@@ -16,6 +16,9 @@
 #define __fit_model_interface_h__
 
 #include <memory>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <iostream>
 #include <vector>
 #include <array>
@@ -24,14 +27,142 @@
 #include <string>
 #include <map>
 #include <functional>
+#include <exception>
+#include <stdexcept>
+#include <thread>
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_multifit_nlin.h>
+#include <gsl/gsl_integration.h>
 
+#include <general/event_trace.h>
 #include <general/string_tools.h>
+#include <general/task_scheduler.h>
 
 namespace molstat {
 
+/// Tallies of the work done while fitting from one initial guess.
+struct FitProfile
+{
+	/// The number of evaluations of the residuals.
+	std::size_t nresid{ 0 };
+
+	/// The number of evaluations of the Jacobian.
+	std::size_t njac{ 0 };
+
+	/// The time (s) spent evaluating the model's residuals and Jacobian.
+	double model_seconds{ 0. };
+
+	/// The time (s) spent in the solver, including the model's evaluations.
+	double solver_seconds{ 0. };
+};
+
+/**
+ * \brief Records the model evaluations made by the calling thread into a
+ *    molstat::FitProfile, for as long as the object exists.
+ *
+ * The evaluations of a FitModel (through its GSL handle) are recorded in the
+ * profile of the innermost scope on the calling thread, if any.
+ */
+class FitProfileScope
+{
+private:
+	/// The profile of the calling thread, or nullptr.
+	static thread_local FitProfile *current;
+
+	/// The profile of the enclosing scope, restored on destruction.
+	FitProfile *const previous;
+
+public:
+	FitProfileScope() = delete;
+	FitProfileScope(const FitProfileScope &) = delete;
+	FitProfileScope &operator=(const FitProfileScope &) = delete;
+
+	/**
+	 * \brief Constructor; records the calling thread's evaluations in a
+	 *    profile.
+	 *
+	 * \param[in,out] profile The profile; it must outlive this object.
+	 */
+	explicit FitProfileScope(FitProfile &profile);
+
+	~FitProfileScope();
+
+	/**
+	 * \brief Records an evaluation of the model in the calling thread's
+	 *    profile, if any.
+	 *
+	 * \param[in] resid Whether or not the residuals were evaluated.
+	 * \param[in] jac Whether or not the Jacobian was evaluated.
+	 * \param[in] start The time when the evaluation began.
+	 */
+	static void record(bool resid, bool jac,
+		std::chrono::steady_clock::time_point start);
+};
+
+/**
+ * \brief The quantity minimized by a fit, as the sum of squares of the
+ *    residuals.
+ *
+ * The data are (weighted) bin counts: each value is its raw count times a
+ * known factor (see FitModel::set_objective), and the raw counts follow
+ * Poisson distributions.
+ */
+enum class FitObjective
+{
+	/// The model's own residuals (unweighted, or relative for some models).
+	LeastSquares,
+
+	/**
+	 * \brief Weighted least squares: the residuals are divided by the
+	 *    standard deviations of the counts, \f$\sqrt{\max(n, 1)}\f$ for raw
+	 *    count \f$n\f$.
+	 */
+	WeightedLeastSquares,
+
+	/**
+	 * \brief Poisson maximum likelihood: the residuals are the deviance
+	 *    residuals, for raw count \f$n\f$ and expected raw count \f$\mu\f$,
+	 *    \f[ \mathrm{sign}(\mu - n) \sqrt{2[\mu - n + n\ln(n/\mu)]}, \f]
+	 *    so that their sum of squares is twice the negative log-likelihood
+	 *    (up to a constant).
+	 */
+	Poisson
+};
+
+/**
+ * \brief Gets a fit objective from its name.
+ *
+ * Names are case insensitive: `leastsquares`, `weighted`, and `poisson`.
+ *
+ * \throw std::invalid_argument if the name is not recognized.
+ *
+ * \param[in] name The name of the objective.
+ * \return The objective.
+ */
+FitObjective FitObjectiveFromName(const std::string &name);
+
+/**
+ * \brief Converts the value of a model at a data point (and its derivatives)
+ *    to the residual (and its derivatives) of a fit objective.
+ *
+ * For the Poisson objective, the expected raw count is kept above a tiny
+ * positive value, so that the residual is defined for any model value; the
+ * derivatives are zero where the count is clamped.
+ *
+ * \param[in] objective The objective.
+ * \param[in] model The value of the model at the point.
+ * \param[in] f The observed value at the point.
+ * \param[in] weight The factor between the raw count and the value at the
+ *    point.
+ * \param[in] nfit The number of fitting parameters.
+ * \param[in,out] jac If not nullptr, the derivatives of the model's value
+ *    (`nfit` elements), replaced by those of the residual.
+ * \return The residual.
+ */
+double ObjectiveResidual(FitObjective objective, double model, double f,
+	double weight, std::size_t nfit, double *jac);
+
 /**
  * \brief Abstract class encapsulating models can fit data.
  *
@@ -53,15 +184,75 @@ class FitModel
 {
 private:
 	/**
-	 * \brief The data we fit against.
+	 * \brief The independent variables of the data we fit against.
 	 *
-	 * This is a list of pairs; each pair contains the independent variables
-	 * (the array) and the observed value of the fit function.
+	 * The data is copied into contiguous storage (one array for the
+	 * independent variables, one for the observed values) when the model is
+	 * constructed.
+	 */
+	std::vector<std::array<double, N>> data_x;
+
+	/// The observed value of the fit function at each data point.
+	std::vector<double> data_f;
+
+	/// The number of derived quantities of each data point.
+	std::size_t nderived;
+
+	/**
+	 * \brief The derived quantities of each data point (see
+	 *    FitModel::set_derived), contiguous by point.
+	 */
+	std::vector<double> data_derived;
+
+	/// Calculates the derived quantities of a point.
+	std::function<void(const std::array<double, N> &, double *)> derive;
+
+	/// The number of threads used to evaluate the residuals and Jacobian.
+	std::size_t nthreads;
+
+	/// The scheduler used to evaluate the residuals and Jacobian (if any).
+	TaskScheduler *scheduler;
+
+	/// The objective of the fit.
+	FitObjective objective;
+
+	/**
+	 * \brief The factor between the raw count and the value of each data
+	 *    point; empty if every factor is 1.
+	 */
+	std::vector<double> data_weight;
+
+	/**
+	 * \brief Evaluates the residual of a data point, and optionally its
+	 *    Jacobian, for an objective other than least squares.
 	 *
-	 * \todo Rework this class and main-fitter.cc so that the data is moved
-	 *    into this class.
+	 * The model's value is recovered from its residual (see
+	 * FitModel::residual_scale) and converted by ObjectiveResidual.
+	 *
+	 * \param[in] fitparam The fitting parameters.
+	 * \param[in] i The index of the data point.
+	 * \param[out] jac If not nullptr, the Jacobian (`nfit` elements).
+	 * \return The residual.
 	 */
-	const std::list<std::pair<std::array<double, N>, double>> &data;
+	double objective_resid(const std::vector<double> &fitparam,
+		std::size_t i, double *jac) const;
+
+	/**
+	 * \brief Calls a function for each data point, dividing the points among
+	 *    the threads.
+	 *
+	 * Each thread handles a contiguous range of data points (with a
+	 * scheduler, chunks of data points that idle workers may steal). The data
+	 * points
+	 * are independent, so `func` may write to its own row of the residual
+	 * vector and Jacobian matrix without synchronization.
+	 *
+	 * \tparam Func The function type; it is called as `func(i)`, where `i` is
+	 *    the index of the data point.
+	 * \param[in] func The function.
+	 */
+	template<typename Func>
+	void for_each_point(const Func &func) const;
 
 protected:
 	/**
@@ -80,6 +271,55 @@ protected:
 	virtual std::vector<double> create_initial_guess(
 		const std::map<std::string, double> &values) const = 0;
 
+	/**
+	 * \brief Gets the calling thread's scratch workspace for GSL numerical
+	 *    integration.
+	 *
+	 * FitModel::resid, FitModel::jacobian, and FitModel::resid_j are const
+	 * and may be called concurrently (for instance, when fitting from several
+	 * initial guesses at once), so models should not store a mutable
+	 * workspace as a member. Each thread instead gets its own workspace,
+	 * allocated on first use and reused afterwards.
+	 *
+	 * \param[in] n The number of subintervals the workspace must hold.
+	 * \return The workspace; valid until this thread requests a larger one.
+	 */
+	static gsl_integration_workspace *integration_workspace(std::size_t n);
+
+	/**
+	 * \brief Declares quantities that depend only on the independent
+	 *    variables of a data point (e.g., \f$\sqrt{g}\f$ or \f$1/g\f$), so
+	 *    that they are calculated once for each point instead of at every
+	 *    evaluation of the residual.
+	 *
+	 * Models call this from their constructors; the quantities of every
+	 * data point are calculated immediately and stored contiguously. The
+	 * residual and Jacobian functions then get them with FitModel::derived.
+	 *
+	 * \param[in] n The number of derived quantities of each point.
+	 * \param[in] func The function that calculates them; it is called as
+	 *    `func(x, out)`, writing the `n` quantities of the point `x` to
+	 *    `out`.
+	 */
+	void set_derived(std::size_t n,
+		const std::function<void(const std::array<double, N> &, double *)>
+		&func);
+
+	/**
+	 * \brief Gets the derived quantities (see FitModel::set_derived) of a
+	 *    point.
+	 *
+	 * When `x` is one of the model's data points (as it is for the residuals
+	 * and Jacobian calculated by FitModel::f, FitModel::df, and
+	 * FitModel::fdf), the stored quantities are returned. Otherwise they are
+	 * calculated into a scratch array of the calling thread, which is valid
+	 * until the thread's next such call.
+	 *
+	 * \param[in] x The independent variables of the point.
+	 * \return The derived quantities of the point.
+	 */
+	const double *derived(const std::array<double, N> &x) const;
+
 public:
 	/// The number of fitting parameters in the model.
 	const std::size_t nfit;
@@ -97,6 +337,64 @@ public:
 	FitModel(const std::size_t nfit_,
 		const std::list<std::pair<std::array<double, N>, double>> &data_);
 
+	/**
+	 * \brief Sets the number of threads used to evaluate the residuals and
+	 *    Jacobian (across data points).
+	 *
+	 * The default is 1 (serial evaluation).
+	 *
+	 * \throw std::invalid_argument if `nthreads_` is 0.
+	 *
+	 * \param[in] nthreads_ The number of threads.
+	 */
+	void set_num_threads(std::size_t nthreads_);
+
+	/**
+	 * \brief Sets a scheduler whose workers evaluate the residuals and
+	 *    Jacobian (across data points), instead of the model's own threads.
+	 *
+	 * When the model is evaluated from within a task of the scheduler (e.g.,
+	 * several initial guesses fit in parallel), the data points are shared
+	 * with any idle workers.
+	 *
+	 * \param[in] scheduler_ The scheduler, or nullptr to use the number of
+	 *    threads from set_num_threads.
+	 */
+	void set_scheduler(TaskScheduler *scheduler_) noexcept;
+
+	/**
+	 * \brief Sets the objective of the fit.
+	 *
+	 * The default is FitObjective::LeastSquares.
+	 *
+	 * \throw std::invalid_argument if the number of weights is not 0 or the
+	 *    number of data points, or if a weight is not positive.
+	 *
+	 * \param[in] objective_ The objective.
+	 * \param[in] weights The factor between the raw count and the value of
+	 *    each data point (e.g., from ReadFitData); empty if every factor is
+	 *    1.
+	 */
+	void set_objective(FitObjective objective_,
+		const std::vector<double> &weights = std::vector<double>());
+
+	/**
+	 * \brief Gets the scale of the residuals: the residual of a data point is
+	 *    the difference between the model and the observed value, divided by
+	 *    the scale.
+	 *
+	 * The objectives other than least squares use the scale to recover the
+	 * model's value from its residual. This basic implementation returns 1;
+	 * models whose residuals are relative to the observed value return the
+	 * observed value.
+	 *
+	 * \param[in] x The independent variables of the point.
+	 * \param[in] f The observed value of the fit function at x.
+	 * \return The scale of the residual.
+	 */
+	virtual double residual_scale(const std::array<double, N> &x,
+		const double f) const;
+
 	/**
 	 * \brief Calculates the residuals of the fit for each set of model
 	 *    parameters and for a given set of fitting parameters.
@@ -155,14 +453,17 @@ public:
 	 * \brief Calculates the Jacobian of the fit function for a given set of
 	 *    fitting parameters and a specific set of independent variables.
 	 *
+	 * The Jacobian is written directly into `jac` (for instance, a row of
+	 * the GSL Jacobian matrix), so that no memory is allocated.
+	 *
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
-	 * \return The Jacobian evaluated at these independent variables and
-	 *    fitting parameters.
+	 * \param[out] jac The Jacobian (`nfit` elements) evaluated at these
+	 *    independent variables and fitting parameters.
 	 */
-	virtual std::vector<double> jacobian(const std::vector<double> &fitparam,
-		const std::array<double, N> &x, const double f) const = 0;
+	virtual void jacobian_row(const std::vector<double> &fitparam,
+		const std::array<double, N> &x, const double f, double *jac) const = 0;
 
 	/**
 	 * \brief Calculates both the residual and Jacobian of the fit for a given
@@ -176,10 +477,42 @@ public:
 	 * \param[in] fitparam The fitting parameters.
 	 * \param[in] x The independent variables for the function.
 	 * \param[in] f The observed value of the fit function at x.
+	 * \param[out] jac The Jacobian (`nfit` elements) evaluated at these
+	 *    independent variables and fitting parameters.
+	 * \return The residual evaluated at these independent variables and
+	 *    fitting parameters.
+	 */
+	virtual double resid_j_row(const std::vector<double> &fitparam,
+		const std::array<double, N> &x, const double f, double *jac) const;
+
+	/**
+	 * \brief Calculates the Jacobian of the fit function for a given set of
+	 *    fitting parameters and a specific set of independent variables.
+	 *
+	 * Convenience wrapper around FitModel::jacobian_row.
+	 *
+	 * \param[in] fitparam The fitting parameters.
+	 * \param[in] x The independent variables for the function.
+	 * \param[in] f The observed value of the fit function at x.
+	 * \return The Jacobian evaluated at these independent variables and
+	 *    fitting parameters.
+	 */
+	std::vector<double> jacobian(const std::vector<double> &fitparam,
+		const std::array<double, N> &x, const double f) const;
+
+	/**
+	 * \brief Calculates both the residual and Jacobian of the fit for a given
+	 *    set of fitting parameters.
+	 *
+	 * Convenience wrapper around FitModel::resid_j_row.
+	 *
+	 * \param[in] fitparam The fitting parameters.
+	 * \param[in] x The independent variables for the function.
+	 * \param[in] f The observed value of the fit function at x.
 	 * \return A pair of the residual and Jacobian evaluated at these
 	 *    independent variables and fitting parameters.
 	 */
-	virtual std::pair<double, std::vector<double>> resid_j(
+	std::pair<double, std::vector<double>> resid_j(
 		const std::vector<double> &fitparam, const std::array<double, N> &x,
 		const double f) const;
 
@@ -283,61 +616,293 @@ inline FitModelFactory<N> GetFitModelFactory()
  */
 std::vector<double> gsl_to_std(const gsl_vector *gslv);
 
+/**
+ * \brief Copies a gsl_vector into an existing std::vector<double>.
+ *
+ * Memory is only allocated if `stdv` is too small to hold `gslv`.
+ *
+ * \param[in] gslv The gsl_vector.
+ * \param[out] stdv The std::vector<double>, resized to the size of `gslv`.
+ */
+void gsl_to_std(const gsl_vector *gslv, std::vector<double> &stdv);
+
+/**
+ * \brief Sets the relative tolerance of the numerical integrals in the
+ *    residuals and Jacobians of the fit models.
+ *
+ * The default, 1e-7, is much finer than the noise in most histograms; a
+ * looser tolerance makes each evaluation of such a model faster. This should
+ * be called before fitting.
+ *
+ * \throw std::invalid_argument if the tolerance is not positive.
+ *
+ * \param[in] tolerance The relative tolerance.
+ */
+void SetFitIntegrationTolerance(double tolerance);
+
+/**
+ * \brief Gets the relative tolerance of the numerical integrals in the fit
+ *    models (see SetFitIntegrationTolerance()).
+ *
+ * \return The relative tolerance.
+ */
+double FitIntegrationTolerance() noexcept;
+
 // Implementation of templated class functions
 template<std::size_t N>
 FitModel<N>::FitModel(const std::size_t nfit_,
 	const std::list<std::pair<std::array<double, N>, double>> &data_)
-	: data(data_), nfit(nfit_)
+	: data_x(), data_f(), nderived(0), data_derived(), derive(), nthreads(1),
+	scheduler(nullptr), objective(FitObjective::LeastSquares), data_weight(),
+	nfit(nfit_)
 {
+	data_x.reserve(data_.size());
+	data_f.reserve(data_.size());
+	for(const std::pair<std::array<double, N>, double> &datai : data_)
+	{
+		data_x.emplace_back(datai.first);
+		data_f.emplace_back(datai.second);
+	}
 }
 
 template<std::size_t N>
-int FitModel<N>::f(const gsl_vector *x, void *model, gsl_vector *f)
+void FitModel<N>::set_derived(std::size_t n,
+	const std::function<void(const std::array<double, N> &, double *)> &func)
 {
-	const FitModel<N> *fitmodel = (FitModel<N>*)model;
-	std::size_t i;
-	const std::vector<double> fitparam(gsl_to_std(x));
-	typename std::list<std::pair<std::array<double, N>, double>>::const_iterator
-		iter;
+	nderived = n;
+	derive = func;
+
+	data_derived.resize(data_x.size() * n);
+	for(std::size_t i = 0; i < data_x.size(); ++i)
+		derive(data_x[i], data_derived.data() + i*n);
+}
+
+template<std::size_t N>
+const double *FitModel<N>::derived(const std::array<double, N> &x) const
+{
+	// std::less orders any pointers, even those not into data_x
+	const std::less<const std::array<double, N> *> before{};
+	const std::array<double, N> *const first{ data_x.data() };
+	if(!before(&x, first) && before(&x, first + data_x.size()))
+		return data_derived.data() + (&x - first)*nderived;
+
+	static thread_local std::vector<double> scratch;
+	scratch.resize(nderived);
+	if(derive)
+		derive(x, scratch.data());
+
+	return scratch.data();
+}
+
+template<std::size_t N>
+void FitModel<N>::set_num_threads(std::size_t nthreads_)
+{
+	if(nthreads_ == 0)
+		throw std::invalid_argument("The number of threads must be positive.");
+
+	nthreads = nthreads_;
+}
+
+template<std::size_t N>
+void FitModel<N>::set_scheduler(TaskScheduler *scheduler_) noexcept
+{
+	scheduler = scheduler_;
+}
+
+template<std::size_t N>
+void FitModel<N>::set_objective(FitObjective objective_,
+	const std::vector<double> &weights)
+{
+	if(weights.size() != 0 && weights.size() != data_f.size())
+		throw std::invalid_argument("The number of weights does not match " \
+			"the number of data points.");
+	for(const double w : weights)
+		if(!(w > 0.))
+			throw std::invalid_argument("The weights must be positive.");
+
+	objective = objective_;
+	data_weight = weights;
+}
+
+template<std::size_t N>
+double FitModel<N>::residual_scale(const std::array<double, N> &x,
+	const double f) const
+{
+	return 1.;
+}
+
+template<std::size_t N>
+double FitModel<N>::objective_resid(const std::vector<double> &fitparam,
+	std::size_t i, double *jac) const
+{
+	const std::array<double, N> &x = data_x[i];
+	const double f{ data_f[i] };
+
+	// a relative residual cannot be formed for an empty bin; use a reference
+	// value of 1 instead (the model's value does not depend on it)
+	double fref{ f }, scale{ residual_scale(x, f) };
+	if(scale == 0.)
+	{
+		fref = 1.;
+		scale = residual_scale(x, fref);
+	}
+
+	const double r{ jac == nullptr ? resid(fitparam, x, fref) :
+		resid_j_row(fitparam, x, fref, jac) };
+	if(jac != nullptr)
+		for(std::size_t k = 0; k < nfit; ++k)
+			jac[k] *= scale;
+
+	return ObjectiveResidual(objective, fref + scale * r, f,
+		data_weight.empty() ? 1. : data_weight[i], nfit, jac);
+}
+
+template<std::size_t N>
+template<typename Func>
+void FitModel<N>::for_each_point(const Func &func) const
+{
+	const std::size_t npoints{ data_f.size() };
+	const std::size_t nchunks{ std::max<std::size_t>(1,
+		std::min(nthreads, npoints)) };
+
+	// evaluates the points [first, last)
+	const auto run = [&func] (std::size_t first, std::size_t last) -> void
+	{
+		for(std::size_t i = first; i < last; ++i)
+			func(i);
+	};
 
-	i = 0;
-	for(iter = fitmodel->data.cbegin(); iter != fitmodel->data.cend(); ++iter)
+	if(scheduler != nullptr)
 	{
-		// get the data point
-		const std::pair<std::array<double, N>, double> &datai = *iter;
+		// a few chunks per worker, so that the load can be balanced
+		const std::size_t ntasks{ std::min(npoints,
+			4 * scheduler->numWorkers()) };
+		scheduler->run(ntasks, [&run, npoints, ntasks] (std::size_t c,
+			std::size_t) -> void
+			{
+				run(c * npoints / ntasks, (c + 1) * npoints / ntasks);
+			});
+		return;
+	}
 
-		gsl_vector_set(f, i,
-			fitmodel->resid(fitparam, datai.first, datai.second));
-		++i;
+	if(nchunks == 1)
+	{
+		run(0, npoints);
+		return;
 	}
 
+	// the calling thread does the first chunk; errors are passed back to it
+	std::vector<std::exception_ptr> errors(nchunks);
+	std::vector<std::thread> workers;
+	for(std::size_t c = 1; c < nchunks; ++c)
+		workers.emplace_back([&run, &errors, npoints, nchunks, c] () -> void
+			{
+				try
+				{
+					run(c * npoints / nchunks, (c + 1) * npoints / nchunks);
+				}
+				catch(...)
+				{
+					errors[c] = std::current_exception();
+				}
+			});
+
+	try
+	{
+		run(0, npoints / nchunks);
+	}
+	catch(...)
+	{
+		errors[0] = std::current_exception();
+	}
+
+	for(std::thread &worker : workers)
+		worker.join();
+
+	for(const std::exception_ptr &error : errors)
+		if(error)
+			std::rethrow_exception(error);
+}
+
+template<std::size_t N>
+gsl_integration_workspace *FitModel<N>::integration_workspace(std::size_t n)
+{
+	static thread_local std::unique_ptr<gsl_integration_workspace,
+			decltype(&gsl_integration_workspace_free)>
+		w{ nullptr, &gsl_integration_workspace_free };
+
+	if(!w || w->limit < n)
+		w.reset(gsl_integration_workspace_alloc(n));
+
+	return w.get();
+}
+
+template<std::size_t N>
+int FitModel<N>::f(const gsl_vector *x, void *model, gsl_vector *f)
+{
+	MOLSTAT_TRACE_EVENT("residuals");
+	const FitModel<N> *fitmodel = (FitModel<N>*)model;
+	const std::chrono::steady_clock::time_point start
+		{ std::chrono::steady_clock::now() };
+
+	// reuse this thread's copy of the fit parameters (the worker threads
+	// share it by reference)
+	static thread_local std::vector<double> fitparam_buffer;
+	gsl_to_std(x, fitparam_buffer);
+	const std::vector<double> &fitparam = fitparam_buffer;
+
+	if(fitmodel->objective == FitObjective::LeastSquares)
+		fitmodel->for_each_point(
+			[fitmodel, &fitparam, f] (std::size_t i) -> void
+			{
+				gsl_vector_set(f, i, fitmodel->resid(fitparam,
+					fitmodel->data_x[i], fitmodel->data_f[i]));
+			});
+	else
+		fitmodel->for_each_point(
+			[fitmodel, &fitparam, f] (std::size_t i) -> void
+			{
+				gsl_vector_set(f, i,
+					fitmodel->objective_resid(fitparam, i, nullptr));
+			});
+
+	FitProfileScope::record(true, false, start);
+
 	return GSL_SUCCESS;
 }
 
 template<std::size_t N>
 int FitModel<N>::df(const gsl_vector *x, void *model, gsl_matrix *J)
 {
+	MOLSTAT_TRACE_EVENT("jacobian");
 	const FitModel<N> *fitmodel = (FitModel<N>*)model;
-	std::size_t i, j;
-	const std::vector<double> fitparam(gsl_to_std(x));
-	typename std::list<std::pair<std::array<double, N>, double>>::const_iterator
-		iter;
-
-	i = 0;
-	for(iter = fitmodel->data.cbegin(); iter != fitmodel->data.cend(); ++iter)
-	{
-		// get the data point
-		const std::pair<std::array<double, N>, double> &datai = *iter;
+	const std::chrono::steady_clock::time_point start
+		{ std::chrono::steady_clock::now() };
 
-		const std::vector<double> jac(
-			fitmodel->jacobian(fitparam, datai.first, datai.second));
+	// reuse this thread's copy of the fit parameters (the worker threads
+	// share it by reference)
+	static thread_local std::vector<double> fitparam_buffer;
+	gsl_to_std(x, fitparam_buffer);
+	const std::vector<double> &fitparam = fitparam_buffer;
 
-		// set the matrix elements
-		for(j = 0; j < fitmodel->nfit; ++j)
-			gsl_matrix_set(J, i, j, jac[j]);
+	// write directly into the rows of the Jacobian (the other objectives
+	// also need the model's value)
+	if(fitmodel->objective == FitObjective::LeastSquares)
+		fitmodel->for_each_point(
+			[fitmodel, &fitparam, J] (std::size_t i) -> void
+			{
+				fitmodel->jacobian_row(fitparam, fitmodel->data_x[i],
+					fitmodel->data_f[i], gsl_matrix_ptr(J, i, 0));
+			});
+	else
+		fitmodel->for_each_point(
+			[fitmodel, &fitparam, J] (std::size_t i) -> void
+			{
+				fitmodel->objective_resid(fitparam, i,
+					gsl_matrix_ptr(J, i, 0));
+			});
 
-		++i;
-	}
+	FitProfileScope::record(false, true, start);
 
 	return GSL_SUCCESS;
 }
@@ -346,32 +911,56 @@ template<std::size_t N>
 int FitModel<N>::fdf(const gsl_vector *x, void *model, gsl_vector *f,
 	gsl_matrix *J)
 {
+	MOLSTAT_TRACE_EVENT("residuals and jacobian");
 	const FitModel<N> *fitmodel = (FitModel<N>*)model;
-	std::size_t i, j;
-	const std::vector<double> fitparam(gsl_to_std(x));
-	typename std::list<std::pair<std::array<double, N>, double>>::const_iterator
-		iter;
+	const std::chrono::steady_clock::time_point start
+		{ std::chrono::steady_clock::now() };
 
-	i = 0;
-	for(iter = fitmodel->data.cbegin(); iter != fitmodel->data.cend(); ++iter)
-	{
-		// get the data point
-		const std::pair<std::array<double, N>, double> &datai = *iter;
+	// reuse this thread's copy of the fit parameters (the worker threads
+	// share it by reference)
+	static thread_local std::vector<double> fitparam_buffer;
+	gsl_to_std(x, fitparam_buffer);
+	const std::vector<double> &fitparam = fitparam_buffer;
 
-		const std::pair<double, std::vector<double>> vals(
-			fitmodel->resid_j(fitparam, datai.first, datai.second));
+	if(fitmodel->objective == FitObjective::LeastSquares)
+		fitmodel->for_each_point(
+			[fitmodel, &fitparam, f, J] (std::size_t i) -> void
+			{
+				gsl_vector_set(f, i, fitmodel->resid_j_row(fitparam,
+					fitmodel->data_x[i], fitmodel->data_f[i],
+					gsl_matrix_ptr(J, i, 0)));
+			});
+	else
+		fitmodel->for_each_point(
+			[fitmodel, &fitparam, f, J] (std::size_t i) -> void
+			{
+				gsl_vector_set(f, i, fitmodel->objective_resid(fitparam, i,
+					gsl_matrix_ptr(J, i, 0)));
+			});
 
-		// set the residual
-		gsl_vector_set(f, i, vals.first);
+	FitProfileScope::record(true, true, start);
 
-		// set the matrix elements
-		for(j = 0; j < fitmodel->nfit; ++j)
-			gsl_matrix_set(J, i, j, vals.second[j]);
+	return GSL_SUCCESS;
+}
 
-		++i;
-	}
+template<std::size_t N>
+double FitModel<N>::resid_j_row(const std::vector<double> &fitparam,
+	const std::array<double, N> &x, const double f, double *jac) const
+{
+	jacobian_row(fitparam, x, f, jac);
 
-	return GSL_SUCCESS;
+	return resid(fitparam, x, f);
+}
+
+template<std::size_t N>
+std::vector<double> FitModel<N>::jacobian(const std::vector<double> &fitparam,
+	const std::array<double, N> &x, const double f) const
+{
+	std::vector<double> ret(nfit);
+
+	jacobian_row(fitparam, x, f, ret.data());
+
+	return ret;
 }
 
 template<std::size_t N>
@@ -381,8 +970,8 @@ std::pair<double, std::vector<double>> FitModel<N>::resid_j(
 {
 	std::pair<double, std::vector<double>> ret;
 
-	ret.first = resid(fitparam, x, f);
-	ret.second = jacobian(fitparam, x, f);
+	ret.second.resize(nfit);
+	ret.first = resid_j_row(fitparam, x, f, ret.second.data());
 
 	return ret;
 }
@@ -395,7 +984,7 @@ gsl_multifit_function_fdf FitModel<N>::gsl_handle() const
 	fit.f = &f;
 	fit.df = &df;
 	fit.fdf = &fdf;
-	fit.n = data.size();
+	fit.n = data_f.size();
 	fit.p = nfit;
 	fit.params = (void*)this;
 
@@ -0,0 +1,210 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file fit_solver.cc
+ * \brief Implementation of the non-linear least-squares solvers.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <config.h>
+#include "fit_solver.h"
+#include <stdexcept>
+
+#if HAVE_GSL_NLINEAR
+#include <gsl/gsl_multifit_nlinear.h>
+#endif
+
+using namespace std;
+
+namespace molstat {
+
+int FitSolver::test(const FitTolerance &tol) const
+{
+	return gsl_multifit_test_delta(step(), position(), tol.epsabs,
+		tol.epsrel);
+}
+
+/**
+ * \brief A solver using the GSL's `gsl_multifit_fdfsolver` interface.
+ */
+class GSLFdfSolver : public FitSolver
+{
+private:
+	/// The GSL solver.
+	unique_ptr<gsl_multifit_fdfsolver, decltype(&gsl_multifit_fdfsolver_free)>
+		solver;
+
+public:
+	GSLFdfSolver() = delete;
+
+	/**
+	 * \brief Constructor; allocates and initializes the solver.
+	 *
+	 * \param[in] type The GSL solver type.
+	 * \param[in] fdf The GSL handle for the model.
+	 * \param[in] initval The initial guess.
+	 */
+	GSLFdfSolver(const gsl_multifit_fdfsolver_type *type,
+		gsl_multifit_function_fdf &fdf, const gsl_vector *initval)
+		: solver(gsl_multifit_fdfsolver_alloc(type, fdf.n, fdf.p),
+			&gsl_multifit_fdfsolver_free)
+	{
+		gsl_multifit_fdfsolver_set(solver.get(), &fdf, initval);
+	}
+
+	virtual int iterate() override
+	{
+		return gsl_multifit_fdfsolver_iterate(solver.get());
+	}
+
+	virtual const gsl_vector *position() const override
+	{
+		return solver->x;
+	}
+
+	virtual const gsl_vector *residuals() const override
+	{
+		return solver->f;
+	}
+
+	virtual const gsl_vector *step() const override
+	{
+		return solver->dx;
+	}
+};
+
+#if HAVE_GSL_NLINEAR
+/**
+ * \brief A solver using the trust-region methods in the GSL's
+ *    `gsl_multifit_nlinear` interface.
+ *
+ * The second directional derivatives needed for geodesic acceleration are
+ * approximated by finite differences.
+ */
+class GSLNlinearSolver : public FitSolver
+{
+private:
+	/// The functions for the model, in the form used by this GSL interface.
+	gsl_multifit_nlinear_fdf nlfdf;
+
+	/// The GSL workspace.
+	unique_ptr<gsl_multifit_nlinear_workspace,
+		decltype(&gsl_multifit_nlinear_free)> work;
+
+public:
+	GSLNlinearSolver() = delete;
+
+	/**
+	 * \brief Constructor; allocates and initializes the solver.
+	 *
+	 * \param[in] params The parameters of the trust-region method.
+	 * \param[in] fdf The GSL handle for the model.
+	 * \param[in] initval The initial guess.
+	 */
+	GSLNlinearSolver(const gsl_multifit_nlinear_parameters &params,
+		gsl_multifit_function_fdf &fdf, const gsl_vector *initval)
+		: nlfdf(),
+		  work(gsl_multifit_nlinear_alloc(gsl_multifit_nlinear_trust, &params,
+			fdf.n, fdf.p), &gsl_multifit_nlinear_free)
+	{
+		// the residual and Jacobian functions have the same signatures
+		nlfdf.f = fdf.f;
+		nlfdf.df = fdf.df;
+		nlfdf.fvv = nullptr;
+		nlfdf.n = fdf.n;
+		nlfdf.p = fdf.p;
+		nlfdf.params = fdf.params;
+
+		gsl_multifit_nlinear_init(initval, &nlfdf, work.get());
+	}
+
+	virtual int iterate() override
+	{
+		return gsl_multifit_nlinear_iterate(work.get());
+	}
+
+	virtual const gsl_vector *position() const override
+	{
+		return gsl_multifit_nlinear_position(work.get());
+	}
+
+	virtual const gsl_vector *residuals() const override
+	{
+		return gsl_multifit_nlinear_residual(work.get());
+	}
+
+	virtual const gsl_vector *step() const override
+	{
+		return work->dx;
+	}
+};
+#endif
+
+FitSolverFactory GetFitSolverFactory(TokenContainer &&tokens)
+{
+	if(tokens.size() == 0)
+		throw invalid_argument("No solver specified.");
+
+	const string name{ to_lower(tokens.front()) };
+	tokens.pop();
+
+	if(name == "lmsder" || name == "lmder")
+	{
+		const gsl_multifit_fdfsolver_type *type{ name == "lmsder" ?
+			gsl_multifit_fdfsolver_lmsder : gsl_multifit_fdfsolver_lmder };
+
+		return [type] (gsl_multifit_function_fdf &fdf, const gsl_vector *initval)
+			-> unique_ptr<FitSolver>
+		{
+			return unique_ptr<FitSolver>(new GSLFdfSolver(type, fdf, initval));
+		};
+	}
+	else if(name == "trust")
+	{
+#if HAVE_GSL_NLINEAR
+		gsl_multifit_nlinear_parameters params
+			{ gsl_multifit_nlinear_default_parameters() };
+
+		string method{ "lmaccel" };
+		if(tokens.size() > 0)
+		{
+			method = to_lower(tokens.front());
+			tokens.pop();
+		}
+
+		if(method == "lm")
+			params.trs = gsl_multifit_nlinear_trs_lm;
+		else if(method == "lmaccel")
+			params.trs = gsl_multifit_nlinear_trs_lmaccel;
+		else if(method == "dogleg")
+			params.trs = gsl_multifit_nlinear_trs_dogleg;
+		else if(method == "ddogleg")
+			params.trs = gsl_multifit_nlinear_trs_ddogleg;
+		else if(method == "subspace2d")
+			params.trs = gsl_multifit_nlinear_trs_subspace2D;
+		else
+			throw invalid_argument("Unknown trust-region method: " + method +
+				".");
+
+		return [params]
+			(gsl_multifit_function_fdf &fdf, const gsl_vector *initval)
+			-> unique_ptr<FitSolver>
+		{
+			return unique_ptr<FitSolver>(
+				new GSLNlinearSolver(params, fdf, initval));
+		};
+#else
+		throw invalid_argument("The trust-region solvers require GSL 2.2 or " \
+			"newer.");
+#endif
+	}
+
+	throw invalid_argument("Unknown solver: " + name + ".");
+}
+
+} // namespace molstat
@@ -0,0 +1,130 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file fit_solver.h
+ * \brief Interface to the non-linear least-squares solvers used by the
+ *    fitter.
+ *
+ * The fitter always uses the GSL's `gsl_multifit_function_fdf` form of a
+ * model (see molstat::FitModel::gsl_handle). This file abstracts the
+ * solver that performs the iterations so that different GSL solvers can be
+ * selected at runtime.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __fit_solver_h__
+#define __fit_solver_h__
+
+#include <functional>
+#include <memory>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_multifit_nlin.h>
+#include <general/string_tools.h>
+
+namespace molstat {
+
+/**
+ * \brief The convergence criteria for a fit.
+ *
+ * A fit has converged when every component of the last step, \f$dx_i\f$,
+ * satisfies \f$|dx_i| < \epsilon_\mathrm{abs} + \epsilon_\mathrm{rel}
+ * |x_i|\f$ (see `gsl_multifit_test_delta`). Looser tolerances trade
+ * accuracy for throughput.
+ */
+struct FitTolerance
+{
+	/// The absolute tolerance on the step.
+	double epsabs{ 1.e-4 };
+
+	/// The relative tolerance on the step.
+	double epsrel{ 1.e-4 };
+};
+
+/**
+ * \brief Abstract class for an iterative non-linear least-squares solver.
+ *
+ * Each solver fits one initial guess; it is allocated and initialized by a
+ * molstat::FitSolverFactory.
+ */
+class FitSolver
+{
+public:
+	virtual ~FitSolver() = default;
+
+	/**
+	 * \brief Performs one iteration of the solver.
+	 *
+	 * \return The GSL status of the iteration.
+	 */
+	virtual int iterate() = 0;
+
+	/**
+	 * \brief Gets the current fitting parameters.
+	 *
+	 * \return The current fitting parameters.
+	 */
+	virtual const gsl_vector *position() const = 0;
+
+	/**
+	 * \brief Gets the residuals at the current fitting parameters.
+	 *
+	 * \return The residuals.
+	 */
+	virtual const gsl_vector *residuals() const = 0;
+
+	/**
+	 * \brief Gets the last step taken by the solver.
+	 *
+	 * \return The last step.
+	 */
+	virtual const gsl_vector *step() const = 0;
+
+	/**
+	 * \brief Tests the fit for convergence.
+	 *
+	 * \param[in] tol The convergence criteria.
+	 * \return GSL_SUCCESS if the fit has converged, GSL_CONTINUE otherwise.
+	 */
+	int test(const FitTolerance &tol) const;
+};
+
+/**
+ * \brief Type for a function that creates a solver for a model, starting
+ *    from an initial guess.
+ *
+ * The model's GSL handle must outlive the solver.
+ */
+using FitSolverFactory = std::function<std::unique_ptr<FitSolver>(
+	gsl_multifit_function_fdf &fdf, const gsl_vector *initval)>;
+
+/**
+ * \brief Gets a solver factory from a vector of string tokens.
+ *
+ * The first token is the name of the solver:
+ * - `lmsder` (default): the GSL's scaled Levenberg-Marquardt solver,
+ *   `gsl_multifit_fdfsolver_lmsder`.
+ * - `lmder`: the unscaled Levenberg-Marquardt solver,
+ *   `gsl_multifit_fdfsolver_lmder`.
+ * - `trust`: the trust-region solvers of `gsl_multifit_nlinear` (GSL 2.2
+ *   or newer). An optional second token selects the trust-region method:
+ *   `lm`, `lmaccel` (default; Levenberg-Marquardt with geodesic
+ *   acceleration), `dogleg`, `ddogleg`, or `subspace2d`.
+ *
+ * This function destroys the tokens.
+ *
+ * \throw invalid_argument if the solver is unknown or is not available in
+ *    this build.
+ *
+ * \param[in] tokens The tokens describing the solver.
+ * \return The factory for the solver.
+ */
+FitSolverFactory GetFitSolverFactory(TokenContainer &&tokens);
+
+} // namespace molstat
+
+#endif
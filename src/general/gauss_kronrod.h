@@ -0,0 +1,270 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file gauss_kronrod.h
+ * \brief Adaptive Gauss-Kronrod quadrature for several integrands at once.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __gauss_kronrod_h__
+#define __gauss_kronrod_h__
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace molstat {
+
+/**
+ * \brief Nodes and weights of the 15-point Gauss-Kronrod rule (and its
+ *    embedded 7-point Gauss rule) on [-1, 1].
+ *
+ * Only the nonnegative nodes are stored; the rule is symmetric. These are
+ * the same rules used by QUADPACK (and the GSL) in QK15.
+ */
+struct GaussKronrod15
+{
+	/// The Kronrod nodes; the odd-indexed ones are also the Gauss nodes.
+	static const double nodes[8];
+
+	/// The Kronrod weights.
+	static const double kronrod_weights[8];
+
+	/// The Gauss weights, for nodes[1], nodes[3], nodes[5], and nodes[7].
+	static const double gauss_weights[4];
+};
+
+/**
+ * \brief Adaptive Gauss-Kronrod integration of several integrands over the
+ *    same interval.
+ *
+ * The integrands are evaluated together at each node; this is useful when
+ * they share an expensive kernel (for instance, a function and its
+ * derivatives with respect to several parameters). The interval is bisected
+ * until every integral has converged, using the QUADPACK error estimate for
+ * each integrand.
+ *
+ * Storage for the subintervals is allocated on construction, so an object
+ * can be reused for many integrals without memory allocations. An object
+ * should not be used by several threads at once.
+ *
+ * \tparam M The number of integrands.
+ */
+template<std::size_t M>
+class AdaptiveGaussKronrod
+{
+public:
+	/// The values of the integrands (or their integrals).
+	using Values = std::array<double, M>;
+
+private:
+	/// A subinterval and the integrals over it.
+	struct Interval
+	{
+		/// The lower limit.
+		double a;
+
+		/// The upper limit.
+		double b;
+
+		/// The integrals over the subinterval.
+		Values integral;
+
+		/// The estimated error in each integral.
+		Values error;
+	};
+
+	/// The maximum number of subintervals.
+	std::size_t limit;
+
+	/// The subintervals.
+	std::vector<Interval> intervals;
+
+	/**
+	 * \brief Applies the Gauss-Kronrod rule to a subinterval.
+	 *
+	 * \tparam Function The type of the integrand function.
+	 * \param[in] f The integrand function.
+	 * \param[in,out] interval The subinterval; its integrals and errors are
+	 *    set.
+	 */
+	template<typename Function>
+	static void rule(const Function &f, Interval &interval);
+
+public:
+	AdaptiveGaussKronrod() = delete;
+
+	/**
+	 * \brief Constructor specifying the maximum number of subintervals.
+	 *
+	 * \param[in] limit_ The maximum number of subintervals. At least one
+	 *    subinterval is always used.
+	 */
+	explicit AdaptiveGaussKronrod(std::size_t limit_);
+
+	/**
+	 * \brief Integrates the functions over an interval.
+	 *
+	 * If the maximum number of subintervals is reached before the integrals
+	 * converge, the best estimates so far are returned.
+	 *
+	 * \tparam Function The type of the integrand function; the signature
+	 *    should be `void(double, Values &)`, setting the value of each
+	 *    integrand at the specified point.
+	 * \param[in] f The integrand function.
+	 * \param[in] a The lower limit of integration.
+	 * \param[in] b The upper limit of integration.
+	 * \param[in] epsabs The absolute error tolerance.
+	 * \param[in] epsrel The relative error tolerance.
+	 * \return The integrals.
+	 */
+	template<typename Function>
+	Values integrate(const Function &f, double a, double b, double epsabs,
+		double epsrel);
+};
+
+// templated definitions
+template<std::size_t M>
+AdaptiveGaussKronrod<M>::AdaptiveGaussKronrod(std::size_t limit_)
+	: limit(std::max<std::size_t>(1, limit_)), intervals()
+{
+	intervals.reserve(limit);
+}
+
+template<std::size_t M>
+template<typename Function>
+void AdaptiveGaussKronrod<M>::rule(const Function &f, Interval &interval)
+{
+	constexpr double epmach{ std::numeric_limits<double>::epsilon() };
+	constexpr double uflow{ std::numeric_limits<double>::min() };
+
+	const double center{ 0.5 * (interval.a + interval.b) };
+	const double halfwidth{ 0.5 * (interval.b - interval.a) };
+
+	// the function values at each node (the center is last)
+	std::array<Values, 15> fvals;
+	for(std::size_t j = 0; j < 7; ++j)
+	{
+		const double dx{ halfwidth * GaussKronrod15::nodes[j] };
+		f(center - dx, fvals[2*j]);
+		f(center + dx, fvals[2*j + 1]);
+	}
+	f(center, fvals[14]);
+
+	for(std::size_t m = 0; m < M; ++m)
+	{
+		const double fc{ fvals[14][m] };
+		double resk{ GaussKronrod15::kronrod_weights[7] * fc };
+		double resg{ GaussKronrod15::gauss_weights[3] * fc };
+		double resabs{ std::abs(resk) };
+
+		for(std::size_t j = 0; j < 7; ++j)
+		{
+			const double f1{ fvals[2*j][m] }, f2{ fvals[2*j + 1][m] };
+			resk += GaussKronrod15::kronrod_weights[j] * (f1 + f2);
+			resabs += GaussKronrod15::kronrod_weights[j] *
+				(std::abs(f1) + std::abs(f2));
+			if(j % 2 == 1)
+				resg += GaussKronrod15::gauss_weights[j / 2] * (f1 + f2);
+		}
+
+		const double mean{ 0.5 * resk };
+		double resasc{ GaussKronrod15::kronrod_weights[7] *
+			std::abs(fc - mean) };
+		for(std::size_t j = 0; j < 7; ++j)
+			resasc += GaussKronrod15::kronrod_weights[j] *
+				(std::abs(fvals[2*j][m] - mean) +
+				 std::abs(fvals[2*j + 1][m] - mean));
+
+		resk *= halfwidth;
+		resabs *= std::abs(halfwidth);
+		resasc *= std::abs(halfwidth);
+
+		// QUADPACK's error estimate
+		double err{ std::abs((resk - resg * halfwidth)) };
+		if(resasc != 0. && err != 0.)
+			err = resasc * std::min(1., std::pow(200. * err / resasc, 1.5));
+		if(resabs > uflow / (50. * epmach))
+			err = std::max(50. * epmach * resabs, err);
+
+		interval.integral[m] = resk;
+		interval.error[m] = err;
+	}
+}
+
+template<std::size_t M>
+template<typename Function>
+typename AdaptiveGaussKronrod<M>::Values AdaptiveGaussKronrod<M>::integrate(
+	const Function &f, double a, double b, double epsabs, double epsrel)
+{
+	intervals.clear();
+	intervals.push_back(Interval{ a, b, Values(), Values() });
+	rule(f, intervals.back());
+
+	Values total, tolerance;
+	while(true)
+	{
+		// the current estimates and tolerances
+		Values error;
+		total.fill(0.);
+		error.fill(0.);
+		for(const Interval &interval : intervals)
+			for(std::size_t m = 0; m < M; ++m)
+			{
+				total[m] += interval.integral[m];
+				error[m] += interval.error[m];
+			}
+
+		bool converged{ true };
+		for(std::size_t m = 0; m < M; ++m)
+		{
+			tolerance[m] = std::max(epsabs, epsrel * std::abs(total[m]));
+			if(error[m] > tolerance[m])
+				converged = false;
+		}
+
+		if(converged || intervals.size() >= limit)
+			break;
+
+		// bisect the subinterval whose error is largest relative to the
+		// tolerances
+		std::size_t worst{ 0 };
+		double worst_error{ -1. };
+		for(std::size_t k = 0; k < intervals.size(); ++k)
+			for(std::size_t m = 0; m < M; ++m)
+			{
+				const double scaled{ tolerance[m] > 0. ?
+					intervals[k].error[m] / tolerance[m] :
+					intervals[k].error[m] };
+				if(scaled > worst_error)
+				{
+					worst = k;
+					worst_error = scaled;
+				}
+			}
+
+		const double left{ intervals[worst].a }, right{ intervals[worst].b };
+		const double mid{ 0.5 * (left + right) };
+		if(mid == left || mid == right)
+			break; // can't subdivide any further
+
+		intervals[worst].b = mid;
+		rule(f, intervals[worst]);
+		intervals.push_back(Interval{ mid, right, Values(), Values() });
+		rule(f, intervals.back());
+	}
+
+	return total;
+}
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,81 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file gauss_legendre.cc
+ * \brief Implements fixed-order Gauss-Legendre quadrature.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "gauss_legendre.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace molstat {
+
+GaussLegendre::GaussLegendre(std::size_t npoints)
+	: nodes(npoints), weights(npoints)
+{
+	if(npoints == 0)
+		throw std::invalid_argument("A quadrature rule needs at least one " \
+			"point.");
+
+	const double pi{ std::acos(-1.) };
+	const double eps{ 4. * std::numeric_limits<double>::epsilon() };
+
+	// the nodes are symmetric about 0; find the positive ones with Newton's
+	// method on the Legendre polynomial P_n
+	for(std::size_t j = 0; j < (npoints + 1) / 2; ++j)
+	{
+		double x{ std::cos(pi * (j + 0.75) / (npoints + 0.5)) };
+		double dp{ 1. };
+
+		for(int iter = 0; iter < 100; ++iter)
+		{
+			// three-term recurrence for P_n(x) and P_{n-1}(x)
+			double p0{ 1. }, p1{ x };
+			for(std::size_t k = 2; k <= npoints; ++k)
+			{
+				const double p2{ ((2.*k - 1.) * x * p1 - (k - 1.) * p0) / k };
+				p0 = p1;
+				p1 = p2;
+			}
+
+			// derivative of P_n
+			dp = npoints * (x * p1 - p0) / (x*x - 1.);
+
+			const double dx{ p1 / dp };
+			x -= dx;
+			if(std::abs(dx) < eps)
+				break;
+		}
+
+		const double w{ 2. / ((1. - x*x) * dp * dp) };
+		nodes[j] = -x;
+		weights[j] = w;
+		nodes[npoints - 1 - j] = x;
+		weights[npoints - 1 - j] = w;
+	}
+}
+
+std::size_t GaussLegendre::numPoints() const noexcept
+{
+	return nodes.size();
+}
+
+double GaussLegendre::node(std::size_t j) const
+{
+	return nodes.at(j);
+}
+
+double GaussLegendre::weight(std::size_t j) const
+{
+	return weights.at(j);
+}
+
+} // namespace molstat
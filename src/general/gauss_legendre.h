@@ -0,0 +1,102 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file gauss_legendre.h
+ * \brief Fixed-order Gauss-Legendre quadrature.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __gauss_legendre_h__
+#define __gauss_legendre_h__
+
+#include <cstddef>
+#include <vector>
+
+namespace molstat {
+
+/**
+ * \brief Gauss-Legendre quadrature rule with a fixed number of points.
+ *
+ * An \f$n\f$-point rule integrates polynomials of degree up to \f$2n-1\f$
+ * exactly. The nodes and weights are calculated once, on construction, so
+ * that a rule can be reused for many integrals without memory allocations.
+ */
+class GaussLegendre
+{
+private:
+	/// The nodes on [-1, 1].
+	std::vector<double> nodes;
+
+	/// The weights for [-1, 1].
+	std::vector<double> weights;
+
+public:
+	GaussLegendre() = delete;
+
+	/**
+	 * \brief Constructor specifying the number of points.
+	 *
+	 * \throw std::invalid_argument if `npoints` is 0.
+	 *
+	 * \param[in] npoints The number of points in the rule.
+	 */
+	explicit GaussLegendre(std::size_t npoints);
+
+	/**
+	 * \brief Gets the number of points in the rule.
+	 *
+	 * \return The number of points.
+	 */
+	std::size_t numPoints() const noexcept;
+
+	/**
+	 * \brief Gets a node of the rule on [-1, 1].
+	 *
+	 * \param[in] j The index of the node.
+	 * \return The node.
+	 */
+	double node(std::size_t j) const;
+
+	/**
+	 * \brief Gets a weight of the rule on [-1, 1].
+	 *
+	 * \param[in] j The index of the weight.
+	 * \return The weight.
+	 */
+	double weight(std::size_t j) const;
+
+	/**
+	 * \brief Approximates the integral of a function.
+	 *
+	 * \tparam Function The type of the function; the signature should be
+	 *    `double(double)`.
+	 * \param[in] f The function.
+	 * \param[in] a The lower limit of integration.
+	 * \param[in] b The upper limit of integration.
+	 * \return The approximate integral.
+	 */
+	template<typename Function>
+	double integrate(const Function &f, double a, double b) const;
+};
+
+// templated definitions
+template<typename Function>
+double GaussLegendre::integrate(const Function &f, double a, double b) const
+{
+	const double center{ 0.5 * (a + b) }, halfwidth{ 0.5 * (b - a) };
+	double sum{ 0. };
+
+	for(std::size_t j = 0; j < nodes.size(); ++j)
+		sum += weights[j] * f(center + halfwidth * nodes[j]);
+
+	return halfwidth * sum;
+}
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,71 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bin_arcsinh.cc
+ * \brief Implements inverse hyperbolic sine binning.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "bin_arcsinh.h"
+#include <cmath>
+#include <sstream>
+#include <general/batch_kernels.h>
+
+namespace molstat
+{
+
+namespace {
+
+/// \cond
+MOLSTAT_BATCH_KERNEL
+void ArcsinhMaskKernel(std::size_t n, const double *x, double inv_s,
+	double *u)
+{
+	for(std::size_t j = 0; j < n; ++j)
+		u[j] = asinh(x[j] * inv_s);
+}
+/// \endcond
+
+} // anonymous namespace
+
+BinArcsinh::BinArcsinh(const std::size_t nbin_, const double s_)
+	: BinStyle(nbin_), s(s_), inv_s(1. / s_)
+{
+	if(!(s > 0.) || !std::isfinite(s))
+		throw std::invalid_argument("The arcsinh scale must be positive.");
+}
+
+double BinArcsinh::mask(const double x) const
+{
+	return asinh(x * inv_s);
+}
+
+void BinArcsinh::mask_n(const double *x, double *u, std::size_t n) const
+{
+	ArcsinhMaskKernel(n, x, inv_s, u);
+}
+
+double BinArcsinh::invmask(const double u) const
+{
+	return s * sinh(u);
+}
+
+double BinArcsinh::dmaskdx(const double x) const
+{
+	return 1. / hypot(x, s);
+}
+
+std::string BinArcsinh::info() const
+{
+	// the scale may be small (e.g., a conductance)
+	std::ostringstream ret;
+	ret << nbins << " arcsinh bins, scale " << s;
+	return ret.str();
+}
+
+} // namespace molstat
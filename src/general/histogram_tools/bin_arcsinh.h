@@ -0,0 +1,95 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bin_arcsinh.h
+ * \brief Implements inverse hyperbolic sine binning.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __bin_arcsinh_h__
+#define __bin_arcsinh_h__
+
+#include "bin_style.h"
+
+namespace molstat
+{
+
+/**
+ * \brief Inverse hyperbolic sine binning style.
+ *
+ * \f$u = f(x) = \sinh^{-1}(x/s)\f$ for a scale \f$s>0\f$. Then,
+ * \f$x = f^{-1}(u) = s \sinh(u)\f$ and \f$f'(x) = (x^2 + s^2)^{-1/2}\f$.
+ *
+ * The bins are (nearly) linear for \f$|x| \ll s\f$ and logarithmic for
+ * \f$|x| \gg s\f$, so that, unlike logarithmic binning, 0 and negative
+ * values (e.g., currents of either sign) can be binned.
+ */
+class BinArcsinh : public BinStyle
+{
+protected:
+	/// The scale, \f$s\f$.
+	const double s;
+
+	/// The reciprocal of the scale.
+	const double inv_s;
+
+public:
+	BinArcsinh() = delete;
+	virtual ~BinArcsinh() = default;
+
+	/**
+	 * \brief Constructor specifying the scale.
+	 *
+	 * \throw std::invalid_argument if the scale is not positive.
+	 *
+	 * \param[in] nbin_ The number of bins.
+	 * \param[in] s_ The scale.
+	 */
+	BinArcsinh(const std::size_t nbin_, const double s_);
+
+	/**
+	 * \brief The mask function, \f$u = f(x) = \sinh^{-1}(x/s)\f$.
+	 *
+	 * \param[in] x The unmasked data value.
+	 * \return The transformed (masked) data value.
+	 */
+	virtual double mask(const double x) const override;
+
+	/**
+	 * \brief The mask function for several values.
+	 *
+	 * \param[in] x The unmasked data values.
+	 * \param[out] u The masked values; may be the same array as `x`.
+	 * \param[in] n The number of values.
+	 */
+	virtual void mask_n(const double *x, double *u, std::size_t n) const
+		override;
+
+	/**
+	 * \brief The inverse mask function, \f$x=f^{-1}(u) = s \sinh(u)\f$.
+	 *
+	 * \param[in] u The transformed (masked) data value.
+	 * \return The unmasked data value.
+	 */
+	virtual double invmask(const double u) const override;
+
+	/**
+	 * \brief The derivative
+	 *    \f$\mathrm{d}f / \mathrm{d}x = (x^2 + s^2)^{-1/2}\f$.
+	 *
+	 * \param[in] x The unmasked data value, \f$x\f$.
+	 * \return The derivative evaluated at \f$x\f$, \f$f'(x)\f$.
+	 */
+	virtual double dmaskdx(const double x) const override;
+
+	virtual std::string info() const override;
+};
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,146 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bin_edges.cc
+ * \brief Implements binning with user-supplied bin edges.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "bin_edges.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace molstat
+{
+
+/**
+ * \brief Checks that the bin edges are finite and increasing.
+ *
+ * \throw std::invalid_argument if they are not, or if there are fewer than
+ *    two edges.
+ *
+ * \param[in] edges The edges.
+ * \return The number of bins.
+ */
+static std::size_t count_bins(const std::vector<double> &edges)
+{
+	if(edges.size() < 2)
+		throw std::invalid_argument("At least two bin edges are required.");
+
+	for(std::size_t k = 0; k < edges.size(); ++k)
+	{
+		if(!std::isfinite(edges[k]) || (k > 0 && !(edges[k] > edges[k-1])))
+			throw std::invalid_argument("The bin edges must be finite and " \
+				"increasing.");
+	}
+
+	return edges.size() - 1;
+}
+
+BinEdges::BinEdges(const std::vector<double> &edges_)
+	: BinStyle(count_bins(edges_)), edges(edges_), inv_cell(0.),
+	  table(2 * nbins)
+{
+	// the table has (about) two cells per bin, so that, unless the bins are
+	// very uneven, only a bin or two are checked for each value
+	const double lower{ edges.front() };
+	inv_cell = table.size() / (edges.back() - lower);
+
+	std::size_t k{ 0 };
+	for(std::size_t c = 0; c < table.size(); ++c)
+	{
+		const double start{ lower + c / inv_cell };
+		while(k + 1 < nbins && edges[k+1] <= start)
+			++k;
+		table[c] = k;
+	}
+
+	setBounds(edges.front(), edges.back());
+}
+
+std::size_t BinEdges::find(const double x) const
+{
+	const std::size_t cell{ std::min(
+		static_cast<std::size_t>((x - edges.front()) * inv_cell),
+		table.size() - 1) };
+
+	// the cell may start (due to roundoff) just above the value
+	std::size_t k{ table[cell] };
+	while(k > 0 && x < edges[k])
+		--k;
+	while(k + 1 < nbins && x >= edges[k+1])
+		++k;
+
+	return k;
+}
+
+double BinEdges::edge_mask(const double x) const
+{
+	// extend the first and last bins beyond the edges (NaNs stay NaNs)
+	if(!(x >= edges.front()))
+		return (x - edges[0]) / (edges[1] - edges[0]);
+	if(x >= edges.back())
+		return nbins + (x - edges[nbins]) / (edges[nbins] - edges[nbins-1]);
+
+	// the position within the bin is less than 1, even after roundoff, so
+	// that the value is in bin k
+	const std::size_t k{ find(x) };
+	const double u{ k + (x - edges[k]) / (edges[k+1] - edges[k]) };
+	return std::min(u, std::nextafter(static_cast<double>(k + 1), 0.));
+}
+
+double BinEdges::mask(const double x) const
+{
+	return edge_mask(x);
+}
+
+void BinEdges::mask_n(const double *x, double *u, std::size_t n) const
+{
+	for(std::size_t j = 0; j < n; ++j)
+		u[j] = edge_mask(x[j]);
+}
+
+double BinEdges::invmask(const double u) const
+{
+	const double fk{ std::floor(u) };
+	const std::size_t k{ fk < 0. ? 0 :
+		std::min(static_cast<std::size_t>(fk), nbins - 1) };
+
+	return edges[k] + (u - k) * (edges[k+1] - edges[k]);
+}
+
+double BinEdges::dmaskdx(const double x) const
+{
+	std::size_t k{ 0 };
+	if(x >= edges.back())
+		k = nbins - 1;
+	else if(x >= edges.front())
+		k = find(x);
+
+	return 1. / (edges[k+1] - edges[k]);
+}
+
+std::string BinEdges::info() const
+{
+	// the edges are written exactly, so that different edges are never
+	// confused (e.g., when merging histograms)
+	std::ostringstream ret;
+	ret.precision(17);
+	ret << nbins << " bins with edges";
+	for(const double edge : edges)
+		ret << ' ' << edge;
+	return ret.str();
+}
+
+const std::vector<double> &BinEdges::getEdges() const noexcept
+{
+	return edges;
+}
+
+} // namespace molstat
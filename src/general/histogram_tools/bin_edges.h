@@ -0,0 +1,132 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bin_edges.h
+ * \brief Implements binning with user-supplied bin edges.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __bin_edges_h__
+#define __bin_edges_h__
+
+#include "bin_style.h"
+#include <vector>
+
+namespace molstat
+{
+
+/**
+ * \brief Binning style with user-supplied (increasing) bin edges,
+ *    \f$e_0 < e_1 < \ldots < e_n\f$.
+ *
+ * The mask maps each bin onto a unit interval: for
+ * \f$e_k \le x < e_{k+1}\f$,
+ * \f$u = f(x) = k + (x - e_k) / (e_{k+1} - e_k)\f$, so that the bins are
+ * uniform (of width 1) in masked coordinates and bin \f$k\f$ is
+ * \f$[k, k+1)\f$. Then, \f$f'(x) = (e_{k+1} - e_k)^{-1}\f$, and the bin
+ * counts are divided by the bin widths. The first and last bins are
+ * extended (linearly) beyond the edges.
+ *
+ * The bin containing a value is found without a search: a table divides
+ * \f$[e_0, e_n]\f$ into equal cells and holds the first bin in each cell,
+ * from which only the (few) bins within the cell are checked.
+ *
+ * The bounds of the binning style are always the first and last edges.
+ */
+class BinEdges : public BinStyle
+{
+protected:
+	/// The edges of the bins.
+	const std::vector<double> edges;
+
+	/// The reciprocal of the width of each cell of the lookup table.
+	double inv_cell;
+
+	/// The first bin in each cell of the lookup table.
+	std::vector<std::size_t> table;
+
+	/**
+	 * \brief Finds the bin containing a value.
+	 *
+	 * \param[in] x The value, which must be in \f$[e_0, e_n)\f$.
+	 * \return The bin, \f$k\f$, such that \f$e_k \le x < e_{k+1}\f$.
+	 */
+	std::size_t find(const double x) const;
+
+	/**
+	 * \brief The mask function (non-virtual).
+	 *
+	 * \param[in] x The unmasked data value.
+	 * \return The masked data value.
+	 */
+	double edge_mask(const double x) const;
+
+public:
+	BinEdges() = delete;
+	virtual ~BinEdges() = default;
+
+	/**
+	 * \brief Constructor specifying the bin edges.
+	 *
+	 * \throw std::invalid_argument if there are fewer than two edges or the
+	 *    edges are not finite and increasing.
+	 *
+	 * \param[in] edges_ The bin edges.
+	 */
+	BinEdges(const std::vector<double> &edges_);
+
+	/**
+	 * \brief The mask function, the position of \f$x\f$ among the edges.
+	 *
+	 * \param[in] x The unmasked data value.
+	 * \return The transformed (masked) data value.
+	 */
+	virtual double mask(const double x) const override;
+
+	/**
+	 * \brief The mask function for several values.
+	 *
+	 * \param[in] x The unmasked data values.
+	 * \param[out] u The masked values; may be the same array as `x`.
+	 * \param[in] n The number of values.
+	 */
+	virtual void mask_n(const double *x, double *u, std::size_t n) const
+		override;
+
+	/**
+	 * \brief The inverse mask function,
+	 *    \f$x = f^{-1}(u) = e_k + (u - k)(e_{k+1} - e_k)\f$ for
+	 *    \f$k = \lfloor u \rfloor\f$.
+	 *
+	 * \param[in] u The transformed (masked) data value.
+	 * \return The unmasked data value.
+	 */
+	virtual double invmask(const double u) const override;
+
+	/**
+	 * \brief The derivative \f$\mathrm{d}f / \mathrm{d}x\f$, the reciprocal
+	 *    of the width of the bin containing \f$x\f$.
+	 *
+	 * \param[in] x The unmasked data value, \f$x\f$.
+	 * \return The derivative evaluated at \f$x\f$, \f$f'(x)\f$.
+	 */
+	virtual double dmaskdx(const double x) const override;
+
+	virtual std::string info() const override;
+
+	/**
+	 * \brief Gets the bin edges.
+	 *
+	 * \return The edges.
+	 */
+	const std::vector<double> &getEdges() const noexcept;
+};
+
+} // namespace molstat
+
+#endif
@@ -12,6 +12,7 @@
  */
 
 #include "bin_linear.h"
+#include <algorithm>
 
 namespace molstat
 {
@@ -21,6 +22,12 @@ double BinLinear::mask(const double x) const
 	return x;
 }
 
+void BinLinear::mask_n(const double *x, double *u, std::size_t n) const
+{
+	if(u != x)
+		std::copy(x, x + n, u);
+}
+
 double BinLinear::invmask(const double u) const
 {
 	return u;
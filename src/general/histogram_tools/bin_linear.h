@@ -38,6 +38,16 @@ public:
 	 */
 	virtual double mask(const double x) const override;
 
+	/**
+	 * \brief The mask function for several values (a copy).
+	 *
+	 * \param[in] x The unmasked data values.
+	 * \param[out] u The masked values; may be the same array as `x`.
+	 * \param[in] n The number of values.
+	 */
+	virtual void mask_n(const double *x, double *u, std::size_t n) const
+		override;
+
 	/**
 	 * \brief The inverse mask function, \f$x=f^{-1}(u) = u\f$.
 	 *
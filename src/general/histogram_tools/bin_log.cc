@@ -13,18 +13,38 @@
 
 #include "bin_log.h"
 #include <cmath>
+#include <general/batch_kernels.h>
 
 namespace molstat
 {
 
+namespace {
+
+/// \cond
+MOLSTAT_BATCH_KERNEL
+void LogMaskKernel(std::size_t n, const double *x, double inv_log_b,
+	double *u)
+{
+	for(std::size_t j = 0; j < n; ++j)
+		u[j] = log(x[j]) * inv_log_b;
+}
+/// \endcond
+
+} // anonymous namespace
+
 BinLog::BinLog(const std::size_t nbin_, const double b_)
-	: BinStyle(nbin_), b(b_)
+	: BinStyle(nbin_), b(b_), inv_log_b(1. / log(b_))
 {
 }
 
 double BinLog::mask(const double x) const
 {
-	return log(x) / log(b);
+	return log(x) * inv_log_b;
+}
+
+void BinLog::mask_n(const double *x, double *u, std::size_t n) const
+{
+	LogMaskKernel(n, x, inv_log_b, u);
 }
 
 double BinLog::invmask(const double u) const
@@ -34,7 +54,7 @@ double BinLog::invmask(const double u) const
 
 double BinLog::dmaskdx(const double x) const
 {
-	return 1. / (x * log(b));
+	return inv_log_b / x;
 }
 
 std::string BinLog::info() const
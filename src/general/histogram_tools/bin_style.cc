@@ -14,7 +14,12 @@
 #include "bin_style.h"
 #include "bin_linear.h"
 #include "bin_log.h"
+#include "bin_arcsinh.h"
+#include "bin_edges.h"
 #include <general/string_tools.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace std;
 
@@ -22,10 +27,60 @@ namespace molstat
 {
 
 BinStyle::BinStyle(const std::size_t nbins_)
-	: nbins(nbins_)
+	: have_bounds(false), bounds({{0., 0.}}), nbins(nbins_)
 {
 }
 
+void BinStyle::setBounds(const double lower, const double upper)
+{
+	const double mlower{ mask(lower) }, mupper{ mask(upper) };
+
+	if(!std::isfinite(mlower) || !std::isfinite(mupper) || mlower >= mupper)
+		throw invalid_argument("The lower bound must be less than the upper " \
+			"bound.");
+
+	bounds = {{ lower, upper }};
+	have_bounds = true;
+}
+
+void BinStyle::mask_n(const double *x, double *u, std::size_t n) const
+{
+	for(std::size_t j = 0; j < n; ++j)
+		u[j] = mask(x[j]);
+}
+
+bool BinStyle::hasBounds() const noexcept
+{
+	return have_bounds;
+}
+
+std::array<double, 2> BinStyle::getBounds() const
+{
+	if(!have_bounds)
+		throw logic_error("No bounds have been set for this binning style.");
+
+	return bounds;
+}
+
+double BinStyle::relativeResolution() const
+{
+	const array<double, 2> b{ getBounds() };
+	const double u0{ mask(b[0]) }, du{ (mask(b[1]) - u0) / nbins };
+
+	double ret{ numeric_limits<double>::infinity() };
+	double x0{ b[0] };
+	for(size_t j = 1; j <= nbins; ++j)
+	{
+		const double x1{ j == nbins ? b[1] : invmask(u0 + j * du) };
+		const double scale{ max(abs(x0), abs(x1)) };
+		if(scale > 0.)
+			ret = min(ret, (x1 - x0) / scale);
+		x0 = x1;
+	}
+
+	return ret;
+}
+
 std::unique_ptr<BinStyle> BinStyleFactory(TokenContainer &&tokens)
 {
 	unique_ptr<BinStyle> ret;
@@ -35,14 +90,8 @@ std::unique_ptr<BinStyle> BinStyleFactory(TokenContainer &&tokens)
 
 	// the first token is the number of bins to use
 	size_t nbins;
-	try
-	{
-		nbins = cast_string<size_t>(tokens.front());
-	}
-	catch(const bad_cast &e)
-	{
+	if(!parse_number(tokens.front(), nbins))
 		throw invalid_argument("Unable to determine the number of bins.");
-	}
 	tokens.pop();
 
 	// the next token is the name of the binning style
@@ -61,17 +110,12 @@ std::unique_ptr<BinStyle> BinStyleFactory(TokenContainer &&tokens)
 		// need to read the base, if available. If not, use 10.
 		double b;
 
-		if(tokens.size() > 0)
+		if(tokens.size() > 0 && !lower_equals(tokens.front(), "bounds"))
 		{
-			try
-			{
-				b = cast_string<double>(tokens.front());
-			}
-			catch(const bad_cast &e)
-			{
+			if(!parse_number(tokens.front(), b))
 				throw invalid_argument(
 					"Unable to convert the base to a numerical value.");
-			}
+			tokens.pop();
 
 			if(b <= 0.)
 				throw invalid_argument("The logarithm base must be positive.");
@@ -81,12 +125,74 @@ std::unique_ptr<BinStyle> BinStyleFactory(TokenContainer &&tokens)
 
 		ret.reset(new BinLog(nbins, b));
 	}
+	else if(name == "arcsinh")
+	{
+		// need to read the scale, if available. If not, use 1.
+		double s;
+
+		if(tokens.size() > 0 && !lower_equals(tokens.front(), "bounds"))
+		{
+			if(!parse_number(tokens.front(), s))
+				throw invalid_argument(
+					"Unable to convert the scale to a numerical value.");
+			tokens.pop();
+		}
+		else
+			s = 1.;
+
+		ret.reset(new BinArcsinh(nbins, s));
+	}
+	else if(name == "edges")
+	{
+		// the edges (one more than the number of bins) are the bounds
+		if(tokens.size() != nbins + 1)
+			throw invalid_argument("The number of bin edges must be one more " \
+				"than the number of bins.");
+
+		vector<double> edges(nbins + 1);
+		for(double &edge : edges)
+		{
+			if(!parse_number(tokens.front(), edge))
+				throw invalid_argument(
+					"Unable to convert the bin edges to numerical values.");
+			tokens.pop();
+		}
+
+		ret.reset(new BinEdges(edges));
+	}
 	else
 		throw invalid_argument(
 			"Unrecognized binning style: \"" + name + "\".\n" \
 			"Possible options are:\n" \
 			"   Linear - Linear binning.\n" \
-			"   Log - Logarithmic binning (base defaults to 10).\n");
+			"   Log - Logarithmic binning (base defaults to 10).\n" \
+			"   Arcsinh - Inverse hyperbolic sine binning (scale defaults to " \
+				"1).\n" \
+			"   Edges - Bins with the specified edges.\n");
+
+	// look for fixed bounds
+	if(tokens.size() > 0)
+	{
+		if(!lower_equals(tokens.front(), "bounds"))
+			throw invalid_argument("Unexpected token \"" + tokens.front() +
+				"\" in the binning style.");
+		tokens.pop();
+
+		if(tokens.size() != 2)
+			throw invalid_argument("Bounds require a lower and an upper value.");
+
+		double lower, upper;
+		if(!parse_number(tokens.front(), lower))
+			throw invalid_argument(
+				"Unable to convert the bounds to numerical values.");
+		tokens.pop();
+		if(!parse_number(tokens.front(), upper))
+			throw invalid_argument(
+				"Unable to convert the bounds to numerical values.");
+		tokens.pop();
+
+		ret->setBounds(lower, upper);
+	}
 
 	return ret;
 }
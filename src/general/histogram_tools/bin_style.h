@@ -17,6 +17,8 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <array>
+#include <stdexcept>
 #include <general/string_tools.h>
 
 namespace molstat
@@ -38,9 +40,20 @@ namespace molstat
  * -# The derivative of the mask function: \f$ \mathrm{d}f / \mathrm{d}x \f$.
  * .
  * Full details about binning styles can be found in \ref sec_histograms.
+ *
+ * Optionally, a binning style can carry fixed (unmasked) lower and upper
+ * bounds for the data. When every dimension of a histogram has fixed bounds,
+ * the data can be binned as it is generated (see molstat::Histogram).
  */
 class BinStyle
 {
+private:
+	/// True if fixed bounds have been set.
+	bool have_bounds;
+
+	/// The fixed lower and upper bounds (unmasked), if set.
+	std::array<double, 2> bounds;
+
 public:
 	/// The number of bins.
 	const std::size_t nbins;
@@ -63,6 +76,18 @@ public:
 	 */
 	virtual double mask(const double x) const = 0;
 
+	/**
+	 * \brief The mask function for several values.
+	 *
+	 * One (virtual) call masks a block of values, so that the loop can be
+	 * vectorized. The default implementation calls mask() for each value.
+	 *
+	 * \param[in] x The unmasked data values.
+	 * \param[out] u The masked values; may be the same array as `x`.
+	 * \param[in] n The number of values.
+	 */
+	virtual void mask_n(const double *x, double *u, std::size_t n) const;
+
 	/**
 	 * \brief The inverse mask function, \f$x=f^{-1}(u)\f$.
 	 *
@@ -85,13 +110,58 @@ public:
 	 * \return The string representation.
 	 */
 	virtual std::string info() const = 0;
+
+	/**
+	 * \brief Sets fixed bounds for the data.
+	 *
+	 * \throw std::invalid_argument if the lower bound is not less than the
+	 *    upper bound, in masked coordinates (this includes bounds outside the
+	 *    domain of the mask function).
+	 *
+	 * \param[in] lower The lower bound.
+	 * \param[in] upper The upper bound.
+	 */
+	void setBounds(const double lower, const double upper);
+
+	/**
+	 * \brief Determines if fixed bounds have been set.
+	 *
+	 * \return True if there are fixed bounds, false otherwise.
+	 */
+	bool hasBounds() const noexcept;
+
+	/**
+	 * \brief Gets the fixed bounds.
+	 *
+	 * \throw std::logic_error if no bounds have been set.
+	 *
+	 * \return The lower and upper bounds.
+	 */
+	std::array<double, 2> getBounds() const;
+
+	/**
+	 * \brief Gets the narrowest bin, relative to the magnitude of the data in
+	 *    it.
+	 *
+	 * The relative width of a bin \f$[x_0, x_1]\f$ is
+	 * \f$(x_1 - x_0) / \max(|x_0|, |x_1|)\f$. A relative error in a value
+	 * that is much smaller than this rarely moves the value to another bin.
+	 *
+	 * \throw std::logic_error if no bounds have been set.
+	 *
+	 * \return The smallest relative width of the bins (infinity if there
+	 *    are no bins).
+	 */
+	double relativeResolution() const;
 };
 
 /**
  * \brief Gets a binning style from a vector of string tokens.
  *
- * The first token is the name of the binning style. All subsequent tokens, if
- * any, are options for that binning style.
+ * The first token is the number of bins and the second is the name of the
+ * binning style. All subsequent tokens, if any, are options for that binning
+ * style. The last three tokens may be `bounds lower upper`, which set fixed
+ * bounds for the data.
  *
  * This function destroys the tokens.
  *
@@ -13,41 +13,659 @@
 
 #include "histogram.h"
 #include "bin_style.h"
+#include <general/batch_kernels.h>
+#include <general/event_trace.h>
+#include <general/task_scheduler.h>
 #include <limits>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
 
 namespace molstat {
 
+namespace {
+
+/// \cond
+MOLSTAT_BATCH_KERNEL
+void BinIndexKernel(std::size_t n, const double *masked, double lower,
+	double upper, double inverse, std::size_t nbins, std::size_t *offsets,
+	unsigned char *valid, std::size_t &under, std::size_t &over)
+{
+	std::size_t nunder{ 0 }, nover{ 0 };
+
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		const double element{ masked[i] };
+
+		// check the bounds (negated to catch NaNs, too)
+		const bool inside{ element >= lower && element <= upper };
+		nunder += element < lower;
+		nover += element > upper;
+
+		// figure out which bin for this dimension; the upper bound (and any
+		// roundoff near it) is in the last bin
+		const double x{ inside ? (element - lower) * inverse : 0. };
+		const std::size_t index{ std::min(static_cast<std::size_t>(x),
+			nbins - 1) };
+
+		offsets[i] = nbins * offsets[i] + index;
+		valid[i] &= inside;
+	}
+
+	under += nunder;
+	over += nover;
+}
+/// \endcond
+
+} // anonymous namespace
+
+// 2^22 bins; 32 MiB of dense counts
+const std::size_t Histogram::sparse_min_bins = 4194304;
+
+// a hash table entry takes several times the memory of a dense count
+const std::size_t Histogram::sparse_occupancy = 8;
+
+/**
+ * \brief The reciprocal of a bin width.
+ *
+ * \param[in] width The width of the bins (masked coordinates).
+ * \return The reciprocal; 0 if the width is 0 (a single bin).
+ */
+static double reciprocal_width(double width)
+{
+	return width > 0. ? 1. / width : 0.;
+}
+
 Histogram::Histogram(std::size_t ndim_)
-	: haveBinned(false), ndim(ndim_), data(),
-	  extremes(ndim_, {{std::numeric_limits<double>::max(),
-	                    std::numeric_limits<double>::lowest()}}),
-	  nbin_dim(ndim_, 0), bin_value(0), binned_data(0)
+	: haveBinned(false), streaming(false), ndim(ndim_), data(ndim_),
+	  nbin_dim(ndim_, 0), bin_value(0), bin_weight(0), total_bins(0),
+	  sparse(false), binned_data(0), weighted(false), weighted_data(0),
+	  masked_bounds(0), inverse_width(0),
+	  styles(0), n_out_of_range(0), out_of_range_dim(ndim_, {{0, 0}}),
+	  retain_out(false)
+{
+}
+
+Histogram::Histogram(
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	const std::vector<std::array<double, 2>> &bounds)
+	: haveBinned(true), streaming(true), ndim(binstyles.size()),
+	  data(binstyles.size(), 1024), nbin_dim(binstyles.size(), 0),
+	  bin_value(binstyles.size()), bin_weight(binstyles.size()),
+	  total_bins(0), sparse(false), binned_data(0), weighted(false),
+	  weighted_data(0), masked_bounds(binstyles.size()),
+	  inverse_width(binstyles.size()), styles(binstyles),
+	  n_out_of_range(0), out_of_range_dim(binstyles.size(), {{0, 0}}),
+	  retain_out(false)
+{
+	if(bounds.size() != ndim)
+		throw std::invalid_argument("Incorrect number of bounds.");
+
+	std::size_t nbins = 1;
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		if(binstyles[j] == nullptr)
+			throw std::invalid_argument(
+				"No binning style specified for dimension " + std::to_string(j) +
+					".");
+
+		if(binstyles[j]->nbins == 0)
+			throw std::invalid_argument(
+				"There must be at least 1 bin in every dimension.");
+
+		masked_bounds[j][0] = binstyles[j]->mask(bounds[j][0]); // minimum
+		masked_bounds[j][1] = binstyles[j]->mask(bounds[j][1]); // maximum
+
+		// the bounds must be in the domain of the mask
+		if(!std::isfinite(masked_bounds[j][0]) ||
+			!std::isfinite(masked_bounds[j][1]) ||
+			masked_bounds[j][0] >= masked_bounds[j][1])
+			throw std::invalid_argument("Invalid bounds for dimension " +
+				std::to_string(j) + ": the lower bound must be less than the " \
+				"upper bound.");
+
+		masked_bounds[j][2] = (masked_bounds[j][1] - masked_bounds[j][0]) /
+			binstyles[j]->nbins;
+		inverse_width[j] = reciprocal_width(masked_bounds[j][2]);
+
+		// set the values of the bins for this dimension
+		bin_value[j] = bin_values(masked_bounds[j][0], masked_bounds[j][1],
+			masked_bounds[j][2], binstyles[j]);
+		bin_weight[j] = bin_weights(bin_value[j], *binstyles[j]);
+
+		nbin_dim[j] = binstyles[j]->nbins;
+		nbins *= binstyles[j]->nbins;
+	}
+
+	// the bins start empty; the counts are moved to dense storage if the
+	// histogram fills
+	allocateBins(nbins, 0);
+}
+
+/**
+ * \brief Collects the fixed bounds from a set of binning styles.
+ *
+ * \throw std::invalid_argument if a binning style is null or does not have
+ *    fixed bounds.
+ *
+ * \param[in] binstyles The binning styles.
+ * \return The bounds of each binning style.
+ */
+static std::vector<std::array<double, 2>> binStyleBounds(
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles)
+{
+	std::vector<std::array<double, 2>> ret(binstyles.size());
+
+	for(std::size_t j = 0; j < binstyles.size(); ++j)
+	{
+		if(binstyles[j] == nullptr || !binstyles[j]->hasBounds())
+			throw std::invalid_argument("No bounds specified for dimension " +
+				std::to_string(j) + ".");
+
+		ret[j] = binstyles[j]->getBounds();
+	}
+
+	return ret;
+}
+
+Histogram::Histogram(
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles)
+	: Histogram(binstyles, binStyleBounds(binstyles))
+{
+}
+
+void Histogram::allocateBins(std::size_t nbins, std::size_t expected)
+{
+	total_bins = nbins;
+	sparse = nbins >= sparse_min_bins &&
+		expected <= nbins / sparse_occupancy;
+
+	if(sparse)
+	{
+		binned_data = std::vector<std::size_t>();
+		sparse_data.clear();
+	}
+	else
+		binned_data.assign(nbins, 0);
+}
+
+void Histogram::useDenseStorage()
 {
+	if(!sparse)
+		return;
+
+	binned_data.assign(total_bins, 0);
+	for(const auto &bin : sparse_data)
+		binned_data[bin.first] = bin.second;
+
+	// release the memory of the hash table
+	std::unordered_map<std::size_t, std::size_t>().swap(sparse_data);
+	sparse = false;
+}
+
+void Histogram::checkOccupancy()
+{
+	if(sparse && sparse_data.size() > total_bins / sparse_occupancy)
+		useDenseStorage();
+}
+
+std::size_t Histogram::countBlock(std::size_t n, const double *w)
+{
+	std::size_t nout{ 0 };
+
+	// weighted histograms are dense
+	if(weighted)
+	{
+		for(std::size_t i = 0; i < n; ++i)
+			if(block.valid[i])
+				weighted_data[block.offsets[i]] += w == nullptr ? 1. : w[i];
+	}
+
+	if(sparse)
+	{
+		for(std::size_t i = 0; i < n; ++i)
+		{
+			if(block.valid[i])
+				++sparse_data[block.offsets[i]];
+			else
+				++nout;
+		}
+
+		checkOccupancy();
+	}
+	else
+	{
+		for(std::size_t i = 0; i < n; ++i)
+		{
+			if(block.valid[i])
+				++binned_data[block.offsets[i]];
+			else
+				++nout;
+		}
+	}
+
+	return nout;
+}
+
+void Histogram::binDimension(std::size_t j, const BinStyle &bstyle,
+	const double *values, std::size_t stride, std::size_t n,
+	BinBlock &scratch, std::array<std::size_t, 2> &tallies) const
+{
+	// convert the values to the masked space
+	scratch.masked.resize(n);
+	double *const masked{ scratch.masked.data() };
+	if(stride == 1)
+		bstyle.mask_n(values, masked, n);
+	else
+	{
+		for(std::size_t i = 0; i < n; ++i)
+			masked[i] = values[i * stride];
+		bstyle.mask_n(masked, masked, n);
+	}
+
+	BinIndexKernel(n, masked, masked_bounds[j][0], masked_bounds[j][1],
+		inverse_width[j], nbin_dim[j], scratch.offsets.data(),
+		scratch.valid.data(), tallies[0], tallies[1]);
+}
+
+void Histogram::binBlock(const double *v, std::size_t n, BinBlock &scratch,
+	std::vector<std::array<std::size_t, 2>> &tallies) const
+{
+	scratch.offsets.assign(n, 0);
+	scratch.valid.assign(n, 1);
+
+	for(std::size_t j = ndim; j-- > 0;)
+		binDimension(j, *styles[j], v + j, ndim, n, scratch, tallies[j]);
 }
 
 void Histogram::add_data(std::valarray<double> v)
 {
-	if(haveBinned)
+	if(haveBinned && !streaming)
 		throw std::runtime_error("Cannot add data after binning the histogram.");
 
 	if(v.size() != ndim)
 		throw std::invalid_argument("Data has incorrect dimensionality.");
 
-	// check the limits
+	add_data(&v[0], 1);
+}
+
+void Histogram::add_data(const double *v, std::size_t n)
+{
+	MOLSTAT_TRACE_EVENT("bin");
+	if(haveBinned && !streaming)
+		throw std::runtime_error("Cannot add data after binning the histogram.");
+
+	if(!streaming)
+	{
+		// store the data
+		for(std::size_t k = 0; k < n; ++k, v += ndim)
+			data.push_back(v);
+		return;
+	}
+
+	// bin the data elements a block at a time, one dimension at a time
+	// an element outside the bounds in any dimension is not binned; the
+	// underflows and overflows are tallied for each dimension
+	constexpr std::size_t block_size{ 1024 };
+	for(std::size_t k = 0; k < n; k += block_size, v += block_size * ndim)
+	{
+		const std::size_t m{ std::min(block_size, n - k) };
+		binBlock(v, m, block, out_of_range_dim);
+		const std::size_t nout{ countBlock(m) };
+		n_out_of_range += nout;
+
+		if(retain_out && nout > 0)
+			for(std::size_t i = 0; i < m; ++i)
+				if(!block.valid[i])
+					data.push_back(v + i * ndim);
+	}
+}
+
+void Histogram::add_data(const double *v, const double *w, std::size_t n)
+{
+	MOLSTAT_TRACE_EVENT("bin");
+	useWeights();
+
+	constexpr std::size_t block_size{ 1024 };
+	for(std::size_t k = 0; k < n; k += block_size, v += block_size * ndim,
+		w += block_size)
+	{
+		const std::size_t m{ std::min(block_size, n - k) };
+		binBlock(v, m, block, out_of_range_dim);
+		n_out_of_range += countBlock(m, w);
+	}
+}
+
+void Histogram::useWeights()
+{
+	if(!streaming)
+		throw std::runtime_error("Only streaming histograms can have " \
+			"weighted data.");
+	if(retain_out)
+		throw std::runtime_error("Weighted data outside the bounds cannot be " \
+			"kept.");
+	if(weighted)
+		return;
+
+	useDenseStorage();
+	weighted_data.assign(binned_data.begin(), binned_data.end());
+	weighted = true;
+}
+
+bool Histogram::isWeighted() const noexcept
+{
+	return weighted;
+}
+
+void Histogram::localize()
+{
+	// the new arrays are zeroed, and thus first written, by this thread
+	if(!binned_data.empty())
+	{
+		std::vector<std::size_t> local(binned_data.size());
+		std::copy(binned_data.begin(), binned_data.end(), local.begin());
+		binned_data.swap(local);
+	}
+
+	if(!weighted_data.empty())
+	{
+		std::vector<double> local(weighted_data.size());
+		std::copy(weighted_data.begin(), weighted_data.end(), local.begin());
+		weighted_data.swap(local);
+	}
+}
+
+void Histogram::binChunk(const SampleBuffer::Chunk &chunk,
+	BinBlock &scratch, std::vector<std::array<std::size_t, 2>> &tallies) const
+{
+	scratch.offsets.assign(chunk.count, 0);
+	scratch.valid.assign(chunk.count, 1);
+
+	// the values of each dimension are contiguous
+	for(std::size_t j = ndim; j-- > 0;)
+		binDimension(j, *styles[j], chunk.dimension(j), 1, chunk.count,
+			scratch, tallies[j]);
+}
+
+void Histogram::add_samples(const SampleBuffer &samples)
+{
+	std::vector<double> element(ndim);
+	for(const auto &chunk : samples)
+	{
+		binChunk(chunk, block, out_of_range_dim);
+		const std::size_t nout{ countBlock(chunk.count) };
+		n_out_of_range += nout;
+
+		if(!retain_out || nout == 0)
+			continue;
+
+		for(std::size_t i = 0; i < chunk.count; ++i)
+		{
+			if(block.valid[i])
+				continue;
+
+			for(std::size_t j = 0; j < ndim; ++j)
+				element[j] = chunk.dimension(j)[i];
+			data.push_back(element.data());
+		}
+	}
+}
+
+void Histogram::add_stored(Histogram &&stored)
+{
+	if(!streaming)
+		throw std::invalid_argument("Only a streaming histogram can bin the " \
+			"data of another histogram.");
+	if(stored.streaming || stored.haveBinned)
+		throw std::runtime_error("The data of the histogram has already been " \
+			"binned.");
+	if(stored.ndim != ndim)
+		throw std::invalid_argument("Histograms have different dimensionality.");
+
+	add_samples(stored.data);
+	stored.data.clear();
+}
+
+void Histogram::retainOutOfRange(bool retain)
+{
+	if(!streaming)
+		throw std::runtime_error("Only streaming histograms have data outside " \
+			"the bounds.");
+
+	if(retain && weighted)
+		throw std::runtime_error("Weighted data outside the bounds cannot be " \
+			"kept.");
+
+	retain_out = retain;
+	if(!retain_out)
+		data.clear();
+}
+
+std::size_t Histogram::numRetained() const noexcept
+{
+	return streaming ? data.size() : 0;
+}
+
+std::vector<std::array<double, 2>> Histogram::getRetainedExtremes() const
+{
+	std::vector<std::array<double, 2>> extremes(ndim,
+		{{std::numeric_limits<double>::max(),
+		  std::numeric_limits<double>::lowest()}});
+	if(!streaming)
+		return extremes;
+
+	std::vector<double> masked;
+	for(const auto &chunk : data)
+	{
+		masked.resize(chunk.count);
+		for(std::size_t j = 0; j < ndim; ++j)
+		{
+			styles[j]->mask_n(chunk.dimension(j), masked.data(), chunk.count);
+			for(const double u : masked)
+			{
+				if(!std::isfinite(u))
+					continue;
+				extremes[j][0] = std::min(extremes[j][0], u);
+				extremes[j][1] = std::max(extremes[j][1], u);
+			}
+		}
+	}
+
+	return extremes;
+}
+
+void Histogram::coarsen(std::size_t j, std::size_t factor, std::size_t shift)
+{
+	// the bins with index k in dimension j form blocks of `stride`
+	// consecutive counts, `stride * nbins` apart
+	std::size_t stride{ 1 };
+	for(std::size_t d = 0; d < j; ++d)
+		stride *= nbin_dim[d];
+	const std::size_t nbins{ nbin_dim[j] };
+
+	// old bin k is in new bin (k + shift) / factor
+	const auto new_offset = [stride, nbins, factor, shift]
+		(std::size_t offset) -> std::size_t
+	{
+		const std::size_t k{ (offset / stride) % nbins };
+		return offset + ((k + shift) / factor - k) * stride;
+	};
+
+	if(sparse)
+	{
+		std::unordered_map<std::size_t, std::size_t> merged;
+		for(const auto &bin : sparse_data)
+			merged[new_offset(bin.first)] += bin.second;
+		sparse_data.swap(merged);
+	}
+	else
+	{
+		std::vector<std::size_t> merged(binned_data.size(), 0);
+		for(std::size_t offset = 0; offset < binned_data.size(); ++offset)
+			if(binned_data[offset] > 0)
+				merged[new_offset(offset)] += binned_data[offset];
+		binned_data.swap(merged);
+	}
+	if(weighted)
+	{
+		std::vector<double> merged(weighted_data.size(), 0.);
+		for(std::size_t offset = 0; offset < weighted_data.size(); ++offset)
+			merged[new_offset(offset)] += weighted_data[offset];
+		weighted_data.swap(merged);
+	}
+
+	std::array<double, 3> &bounds = masked_bounds[j];
+	bounds[0] -= shift * bounds[2];
+	bounds[2] *= factor;
+	bounds[1] = bounds[0] + nbins * bounds[2];
+	inverse_width[j] = reciprocal_width(bounds[2]);
+
+	bin_value[j] = bin_values(bounds[0], bounds[1], bounds[2], styles[j]);
+	bin_weight[j] = bin_weights(bin_value[j], *styles[j]);
+}
+
+bool Histogram::widen(const std::vector<std::array<double, 2>> &extremes)
+{
+	if(!streaming)
+		throw std::runtime_error("Only streaming histograms can be widened.");
+	if(extremes.size() != ndim)
+		throw std::invalid_argument("Incorrect number of extremes.");
+
+	// the kept elements are binned again, so they are first removed from
+	// the tallies of elements outside the bounds
+	SampleBuffer kept(ndim, 1024);
+	kept.splice(data);
+	{
+		std::vector<std::array<std::size_t, 2>> tallies(ndim, {{0, 0}});
+		for(const auto &chunk : kept)
+			binChunk(chunk, block, tallies);
+
+		n_out_of_range -= kept.size();
+		for(std::size_t j = 0; j < ndim; ++j)
+		{
+			out_of_range_dim[j][0] -= tallies[j][0];
+			out_of_range_dim[j][1] -= tallies[j][1];
+		}
+	}
+
+	bool changed{ false };
 	for(std::size_t j = 0; j < ndim; ++j)
 	{
-		if(v[j] < extremes[j][0]) // are we smaller than the min?
-			extremes[j][0] = v[j];
-		if(v[j] > extremes[j][1]) // are we larger than the max?
-			extremes[j][1] = v[j];
+		const double lower{ masked_bounds[j][0] }, upper{ masked_bounds[j][1] };
+		const double width{ masked_bounds[j][2] };
+		const double lo{ extremes[j][0] }, hi{ extremes[j][1] };
+		if(!std::isfinite(lo) || !std::isfinite(hi) || lo > hi ||
+			!(width > 0.) || (lo >= lower && hi <= upper))
+		{
+			continue;
+		}
+
+		// the (old) bins needed below and above the bounds
+		const double below{ lo < lower ? std::ceil((lower - lo) / width) : 0. };
+		const double above{ hi > upper ? std::ceil((hi - upper) / width) : 0. };
+		const double nbins{ static_cast<double>(nbin_dim[j]) };
+
+		// the smallest factor of 2 that fits them; extremes that are too far
+		// away (which would leave too few bins for the data) are ignored
+		double factor{ 2. };
+		while(factor * nbins < below + nbins + above && factor <= 1048576.)
+			factor *= 2.;
+		if(factor * nbins < below + nbins + above)
+			continue;
+
+		// the extra bins go to the side(s) that needed them
+		const double slack{ factor * nbins - (below + nbins + above) };
+		const double shift{ below + (below > 0. && above > 0. ? std::floor(0.5 *
+			slack) : (below > 0. ? slack : 0.)) };
+
+		coarsen(j, static_cast<std::size_t>(factor),
+			static_cast<std::size_t>(shift));
+		changed = true;
+	}
+
+	// bin the kept elements; those still outside the bounds cannot be binned
+	// (their masked values are not finite, or are too far away), so they are
+	// no longer kept
+	const bool retain{ retain_out };
+	retain_out = false;
+	add_samples(kept);
+	retain_out = retain;
+
+	return changed;
+}
+
+void Histogram::merge(Histogram &&other)
+{
+	if(streaming || other.streaming)
+	{
+		if(!streaming || !other.streaming)
+			throw std::invalid_argument("Cannot merge a streaming histogram " \
+				"with a non-streaming histogram.");
+
+		if(other.nbin_dim != nbin_dim)
+			throw std::invalid_argument("Histograms have different bins.");
+		for(std::size_t j = 0; j < ndim; ++j)
+			if(other.masked_bounds[j] != masked_bounds[j])
+				throw std::invalid_argument("Histograms have different bins.");
+
+		// add the bin counts (and weights)
+		if(weighted || other.weighted)
+		{
+			useWeights();
+			other.useWeights();
+			for(std::size_t j = 0; j < weighted_data.size(); ++j)
+			{
+				weighted_data[j] += other.weighted_data[j];
+				other.weighted_data[j] = 0.;
+			}
+		}
+		if(sparse && !other.sparse)
+			useDenseStorage();
+		if(other.sparse)
+		{
+			if(sparse)
+				for(const auto &bin : other.sparse_data)
+					sparse_data[bin.first] += bin.second;
+			else
+				for(const auto &bin : other.sparse_data)
+					binned_data[bin.first] += bin.second;
+			other.sparse_data.clear();
+			checkOccupancy();
+		}
+		else
+		{
+			for(std::size_t j = 0; j < binned_data.size(); ++j)
+			{
+				binned_data[j] += other.binned_data[j];
+				other.binned_data[j] = 0;
+			}
+		}
+		n_out_of_range += other.n_out_of_range;
+		other.n_out_of_range = 0;
+		data.splice(other.data);
+		for(std::size_t j = 0; j < ndim; ++j)
+		{
+			out_of_range_dim[j][0] += other.out_of_range_dim[j][0];
+			out_of_range_dim[j][1] += other.out_of_range_dim[j][1];
+			other.out_of_range_dim[j] = {{0, 0}};
+		}
+
+		return;
 	}
 
+	if(haveBinned || other.haveBinned)
+		throw std::runtime_error("Cannot merge histograms after binning.");
+
+	if(other.ndim != ndim)
+		throw std::invalid_argument("Histograms have different dimensionality.");
+
 	// move the data
-	data.emplace_front(move(v));
+	data.splice(other.data);
 }
 
 void Histogram::bin_data(
-	const std::vector<std::shared_ptr<const BinStyle>> &binstyles)
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	TaskScheduler *scheduler)
 {
 	if(haveBinned)
 		throw std::runtime_error("Data has already been binned.");
@@ -55,9 +673,56 @@ void Histogram::bin_data(
 	if(binstyles.size() != ndim)
 		throw std::invalid_argument("Incorrect number of binning styles.");
 
+	bin_data(binstyles, getDataExtremes(), scheduler);
+}
+
+std::vector<std::array<double, 2>> Histogram::getDataExtremes() const
+{
+	if(haveBinned)
+		throw std::runtime_error("Data has already been binned.");
+
+	// find the minimum and maximum values in each dimension
+	std::vector<std::array<double, 2>> extremes(ndim,
+		{{std::numeric_limits<double>::max(),
+		  std::numeric_limits<double>::lowest()}});
+	for(const auto &chunk : data)
+	{
+		for(std::size_t j = 0; j < ndim; ++j)
+		{
+			const double *values = chunk.dimension(j);
+			double dmin{ extremes[j][0] }, dmax{ extremes[j][1] };
+
+			for(std::size_t i = 0; i < chunk.count; ++i)
+			{
+				dmin = std::min(dmin, values[i]);
+				dmax = std::max(dmax, values[i]);
+			}
+
+			extremes[j][0] = dmin;
+			extremes[j][1] = dmax;
+		}
+	}
+
+	return extremes;
+}
+
+void Histogram::bin_data(
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	const std::vector<std::array<double, 2>> &extremes,
+	TaskScheduler *scheduler)
+{
+	MOLSTAT_TRACE_EVENT("bin");
+	if(haveBinned)
+		throw std::runtime_error("Data has already been binned.");
+
+	if(binstyles.size() != ndim)
+		throw std::invalid_argument("Incorrect number of binning styles.");
+	if(extremes.size() != ndim)
+		throw std::invalid_argument("Incorrect number of extremes.");
+
 	// make sure that, if more than 1 bin is specified in a dimension, there is
 	// a range of data values
-	std::size_t total_bins = 1;
+	std::size_t nbins = 1;
 	for(std::size_t j = 0; j < ndim; ++j)
 	{
 		if(binstyles[j] == nullptr)
@@ -72,73 +737,157 @@ void Histogram::bin_data(
 		if(extremes[j][0] == extremes[j][1] && binstyles[j]->nbins != 1)
 			throw j;
 
-		total_bins *= binstyles[j]->nbins;
+		nbins *= binstyles[j]->nbins;
 	}
 
 	// determine the bounds of each dimension (in masked coordinates), as well
 	// as the width of each bin (in masked coordinates)
-	std::vector<std::array<double, 3>> bounds(ndim);
+	masked_bounds.resize(ndim);
+	inverse_width.resize(ndim);
 	bin_value.resize(ndim);
+	bin_weight.resize(ndim);
 	for(std::size_t j = 0; j < ndim; ++j)
 	{
-		bounds[j][0] = binstyles[j]->mask(extremes[j][0]); // minimum
-		bounds[j][1] = binstyles[j]->mask(extremes[j][1]); // maximum
-		bounds[j][2] = (bounds[j][1] - bounds[j][0]) / binstyles[j]->nbins;
-	
+		masked_bounds[j][0] = binstyles[j]->mask(extremes[j][0]); // minimum
+		masked_bounds[j][1] = binstyles[j]->mask(extremes[j][1]); // maximum
+		masked_bounds[j][2] = (masked_bounds[j][1] - masked_bounds[j][0]) /
+			binstyles[j]->nbins;
+		inverse_width[j] = reciprocal_width(masked_bounds[j][2]);
+
 		// set the values of the bins for this dimension
-		bin_value[j] = bin_values(bounds[j][0], bounds[j][1], bounds[j][2],
-			binstyles[j]);
+		bin_value[j] = bin_values(masked_bounds[j][0], masked_bounds[j][1],
+			masked_bounds[j][2], binstyles[j]);
+		bin_weight[j] = bin_weights(bin_value[j], *binstyles[j]);
 	}
 
-	// set the size of binned_data vector
-	binned_data.resize(total_bins);
-	for(std::size_t j = 0; j < total_bins; ++j)
-		binned_data[j] = 0.;
+	// allocate the bins; at most one bin per data element is occupied
+	allocateBins(nbins, data.size());
 
-	// set up the indexor for accesing the bins in binned_data
-	// -> need to get the number of bins in each dimension
+	// the number of bins in each dimension
 	for(std::size_t j = 0; j < ndim; ++j)
 		nbin_dim[j] = binstyles[j]->nbins;
-	CounterIndex ci{ nbin_dim };
 
-	// go through the data
-	while(!data.empty())
+	// the weight function is applied when the counts are accessed (as in
+	// streaming mode), so that the raw counts remain available
+	styles = binstyles;
+
+	// the data are within the extremes, so there should always be a bin
+	// (unless the binning style cannot mask the value)
+	bin_stored(scheduler);
+
+	// discard the data
+	data.clear();
+
+	// note that we've finished the binning
+	haveBinned = true;
+}
+
+void Histogram::bin_stored(TaskScheduler *scheduler)
+{
+	std::vector<const SampleBuffer::Chunk *> chunks;
+	for(const auto &chunk : data)
+		chunks.push_back(&chunk);
+
+	// one partition per worker, but the dense private counts should not need
+	// more memory than the data
+	std::size_t nparts{ scheduler == nullptr ? 1 :
+		std::min(scheduler->numWorkers(), chunks.size()) };
+	if(!sparse)
+		nparts = std::min(nparts,
+			data.memoryUsage() / (total_bins * sizeof(std::size_t)));
+
+	std::array<std::size_t, 2> tallies{{ 0, 0 }};
+	if(nparts <= 1)
 	{
-		for(std::size_t j = 0; j < ndim; ++j)
+		// go through the data, one chunk at a time
+		for(const SampleBuffer::Chunk *chunk : chunks)
 		{
-			// convert each value to the masked space
-			double element = binstyles[j]->mask(data.front()[j]);
-
-			// figure out which bin for this dimension
-			if(binstyles[j]->nbins == 1) // only 1 bin to put it in
-				ci.setIndex(j, 0);
-			else if(element == bounds[j][1]) // the upper bound
-				ci.setIndex(j, nbin_dim[j] - 1);
-			else
-				ci.setIndex(j, static_cast<std::size_t>(
-					(element - bounds[j][0]) / bounds[j][2]
-				));
-		}
+			block.offsets.assign(chunk->count, 0);
+			block.valid.assign(chunk->count, 1);
 
-		// increase the bin count
-		binned_data[ci.arrayOffset()] += 1.;
+			for(std::size_t j = ndim; j-- > 0;)
+				binDimension(j, *styles[j], chunk->dimension(j), 1,
+					chunk->count, block, tallies);
 
-		// discard this data point
-		data.pop_front();
+			// increase the bin counts
+			countBlock(chunk->count);
+		}
+		return;
 	}
 
-	// apply the weight function to account for the bin sizes
-	for(ci.reset(); !ci.at_end(); ++ci)
+	// the private counts of a partition (a contiguous range of chunks)
+	struct Partition
 	{
-		for(std::size_t j = 0; j < ndim; ++j)
+		BinBlock scratch;
+		std::vector<std::size_t> counts;
+		std::unordered_map<std::size_t, std::size_t> occupied;
+	};
+	std::vector<Partition> parts(nparts);
+
+	scheduler->run(nparts, [this, &chunks, &parts, nparts]
+		(std::size_t p, std::size_t) -> void
 		{
-			binned_data[ci.arrayOffset()] *= binstyles[j]->dmaskdx(
-				bin_value[j][ci[j]]);
-		}
-	}
+			Partition &part = parts[p];
+			if(!sparse)
+				part.counts.assign(total_bins, 0);
 
-	// note that we've finished the binning
-	haveBinned = true;
+			std::array<std::size_t, 2> ptallies{{ 0, 0 }};
+			const std::size_t first{ p * chunks.size() / nparts },
+				last{ (p + 1) * chunks.size() / nparts };
+			for(std::size_t c = first; c < last; ++c)
+			{
+				const SampleBuffer::Chunk &chunk = *chunks[c];
+				part.scratch.offsets.assign(chunk.count, 0);
+				part.scratch.valid.assign(chunk.count, 1);
+
+				for(std::size_t j = ndim; j-- > 0;)
+					binDimension(j, *styles[j], chunk.dimension(j), 1,
+						chunk.count, part.scratch, ptallies);
+
+				for(std::size_t i = 0; i < chunk.count; ++i)
+				{
+					if(!part.scratch.valid[i])
+						continue;
+
+					if(sparse)
+						++part.occupied[part.scratch.offsets[i]];
+					else
+						++part.counts[part.scratch.offsets[i]];
+				}
+			}
+		});
+
+	// sum the private counts pairwise: partition p + stride is added to
+	// partition p, for p a multiple of 2*stride
+	for(std::size_t stride = 1; stride < nparts; stride *= 2)
+		scheduler->run((nparts + 2 * stride - 1) / (2 * stride),
+			[this, &parts, nparts, stride] (std::size_t t, std::size_t) -> void
+			{
+				const std::size_t p{ 2 * stride * t }, q{ p + stride };
+				if(q >= nparts)
+					return;
+
+				if(sparse)
+				{
+					for(const auto &bin : parts[q].occupied)
+						parts[p].occupied[bin.first] += bin.second;
+					parts[q].occupied.clear();
+				}
+				else
+				{
+					for(std::size_t b = 0; b < total_bins; ++b)
+						parts[p].counts[b] += parts[q].counts[b];
+					parts[q].counts = std::vector<std::size_t>();
+				}
+			});
+
+	if(sparse)
+	{
+		sparse_data = std::move(parts[0].occupied);
+		checkOccupancy();
+	}
+	else
+		binned_data = std::move(parts[0].counts);
 }
 
 std::vector<double> Histogram::bin_values(double dmin, double dmax,
@@ -159,6 +908,86 @@ std::vector<double> Histogram::bin_values(double dmin, double dmax,
 	return ret;
 }
 
+void ApplyBinWeights(std::vector<double> &counts,
+	const std::vector<std::vector<double>> &weights)
+{
+	// scale by the weights of each dimension in turn. the bins with index k
+	// in dimension j form blocks of `stride` consecutive counts, `stride *
+	// nbins` apart.
+	std::size_t stride{ 1 };
+	for(const std::vector<double> &dim_weights : weights)
+	{
+		const std::size_t nbins{ dim_weights.size() };
+
+		for(std::size_t base = 0; base < counts.size(); base += stride * nbins)
+		{
+			for(std::size_t k = 0; k < nbins; ++k)
+			{
+				double *const block{ &counts[base + k * stride] };
+				const double weight{ dim_weights[k] };
+				for(std::size_t i = 0; i < stride; ++i)
+					block[i] *= weight;
+			}
+		}
+
+		stride *= nbins;
+	}
+}
+
+/**
+ * \brief Calculates the Hellinger distance between two histograms, for
+ *    either type of bin counts.
+ *
+ * \tparam T The type of the bin counts.
+ * \param[in] a The bin counts of the first histogram.
+ * \param[in] b The bin counts of the second histogram.
+ * \return The Hellinger distance.
+ */
+template<typename T>
+static double hellinger_distance(const std::vector<T> &a,
+	const std::vector<T> &b)
+{
+	if(a.size() != b.size())
+		throw std::invalid_argument("The histograms have different bins.");
+
+	double na{ 0. }, nb{ 0. }, overlap{ 0. };
+	for(std::size_t k = 0; k < a.size(); ++k)
+	{
+		na += a[k];
+		nb += b[k];
+		overlap += std::sqrt(static_cast<double>(a[k]) * b[k]);
+	}
+
+	if(na == 0. || nb == 0.)
+		return 1.;
+
+	// roundoff can make the overlap slightly larger than 1
+	return std::sqrt(std::max(0., 1. - overlap / std::sqrt(na * nb)));
+}
+
+double HellingerDistance(const std::vector<std::size_t> &a,
+	const std::vector<std::size_t> &b)
+{
+	return hellinger_distance(a, b);
+}
+
+double HellingerDistance(const std::vector<double> &a,
+	const std::vector<double> &b)
+{
+	return hellinger_distance(a, b);
+}
+
+std::vector<double> Histogram::bin_weights(const std::vector<double> &values,
+	const BinStyle &bstyle)
+{
+	std::vector<double> ret(values.size());
+
+	for(std::size_t j = 0; j < values.size(); ++j)
+		ret[j] = bstyle.dmaskdx(values[j]);
+
+	return ret;
+}
+
 CounterIndex Histogram::begin() const
 {
 	if(!haveBinned)
@@ -187,7 +1016,194 @@ double Histogram::getBinCount(const CounterIndex &index) const
 	if(!haveBinned)
 		throw std::runtime_error("Cannot get a bin count before binning.");
 
+	double ret{ weighted ? weighted_data[index.arrayOffset()] :
+		static_cast<double>(getRawBinCount(index)) };
+
+	// apply the weight function to account for the bin sizes
+	for(std::size_t j = 0; j < ndim; ++j)
+		ret *= bin_weight[j][index[j]];
+
+	return ret;
+}
+
+const std::vector<double> &Histogram::getBinCoordinates(std::size_t dim)
+	const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot get coordinates before binning.");
+
+	return bin_value.at(dim);
+}
+
+const std::vector<double> &Histogram::getBinWeights(std::size_t dim) const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot get the weights before binning.");
+
+	return bin_weight.at(dim);
+}
+
+std::vector<double> Histogram::getBinCounts() const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot get the bin counts before binning.");
+
+	std::vector<double> ret{ getRawBinSums() };
+
+	ApplyBinWeights(ret, bin_weight);
+	return ret;
+}
+
+std::vector<double> Histogram::getRawBinSums() const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot get the bin counts before binning.");
+
+	if(weighted)
+		return weighted_data;
+
+	// the raw counts are integers
+	std::vector<double> ret(total_bins, 0.);
+	if(sparse)
+		for(const auto &bin : sparse_data)
+			ret[bin.first] = bin.second;
+	else
+		std::copy(binned_data.begin(), binned_data.end(), ret.begin());
+
+	return ret;
+}
+
+void Histogram::setRawBinSums(std::vector<double> sums)
+{
+	if(!weighted)
+		throw std::runtime_error("The histogram is not weighted.");
+
+	if(sums.size() != total_bins)
+		throw std::invalid_argument("Incorrect number of bin sums.");
+
+	weighted_data = std::move(sums);
+}
+
+std::size_t Histogram::getRawBinCount(const CounterIndex &index) const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot get a bin count before binning.");
+
+	if(sparse)
+	{
+		const auto bin = sparse_data.find(index.arrayOffset());
+		return bin == sparse_data.end() ? 0 : bin->second;
+	}
+
 	return binned_data[index.arrayOffset()];
 }
 
+std::vector<std::size_t> Histogram::getRawBinCounts() const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot get the bin counts before binning.");
+
+	if(!sparse)
+		return binned_data;
+
+	std::vector<std::size_t> ret(total_bins, 0);
+	for(const auto &bin : sparse_data)
+		ret[bin.first] = bin.second;
+	return ret;
+}
+
+void Histogram::setRawBinCounts(std::vector<std::size_t> counts,
+	std::size_t nout,
+	const std::vector<std::array<std::size_t, 2>> &out_of_range)
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot set the bin counts before binning.");
+
+	if(counts.size() != total_bins)
+		throw std::invalid_argument("Incorrect number of bin counts.");
+	if(out_of_range.size() != ndim)
+		throw std::invalid_argument("Incorrect number of underflows and " \
+			"overflows.");
+
+	const std::size_t occupied = total_bins - static_cast<std::size_t>(
+		std::count(counts.begin(), counts.end(), std::size_t{ 0 }));
+	allocateBins(total_bins, occupied);
+	if(sparse)
+	{
+		for(std::size_t j = 0; j < counts.size(); ++j)
+			if(counts[j] != 0)
+				sparse_data[j] = counts[j];
+	}
+	else
+		binned_data = std::move(counts);
+	if(weighted)
+		useDenseStorage();
+	n_out_of_range = nout;
+	out_of_range_dim = out_of_range;
+}
+
+std::size_t Histogram::numDimensions() const noexcept
+{
+	return ndim;
+}
+
+std::size_t Histogram::numBins(std::size_t dim) const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot get the number of bins before binning.");
+
+	return nbin_dim.at(dim);
+}
+
+std::array<double, 2> Histogram::getMaskedBounds(std::size_t dim) const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot get the bounds before binning.");
+
+	const std::array<double, 3> &bounds = masked_bounds.at(dim);
+	return {{ bounds[0], bounds[1] }};
+}
+
+bool Histogram::isStreaming() const noexcept
+{
+	return streaming;
+}
+
+bool Histogram::isSparse() const noexcept
+{
+	return sparse;
+}
+
+std::size_t Histogram::memoryUsage() const noexcept
+{
+	// each sparse bin is a node of the hash table and a bucket
+	std::size_t ret{ data.memoryUsage() +
+		binned_data.capacity() * sizeof(std::size_t) +
+		weighted_data.capacity() * sizeof(double) +
+		sparse_data.size() * (sizeof(std::pair<std::size_t, std::size_t>) +
+			sizeof(void *)) +
+		sparse_data.bucket_count() * sizeof(void *) };
+	for(const std::vector<double> &values : bin_value)
+		ret += values.capacity() * sizeof(double);
+	for(const std::vector<double> &weights : bin_weight)
+		ret += weights.capacity() * sizeof(double);
+
+	return ret;
+}
+
+std::size_t Histogram::numOutOfRange() const noexcept
+{
+	return n_out_of_range;
+}
+
+std::size_t Histogram::numUnderflow(std::size_t dim) const
+{
+	return out_of_range_dim.at(dim)[0];
+}
+
+std::size_t Histogram::numOverflow(std::size_t dim) const
+{
+	return out_of_range_dim.at(dim)[1];
+}
+
 } // namespace molstat
@@ -15,16 +15,19 @@
 #define __histogram_h__
 
 #include <memory>
+#include <unordered_map>
 #include <valarray>
 #include <vector>
-#include <forward_list>
 #include <array>
 #include "counterindex.h"
+#include "sample_buffer.h"
 
 namespace molstat {
 
-// forward declaration
+// forward declarations
 class BinStyle;
+class SharedHistogram;
+class TaskScheduler;
 
 /**
  * \brief Class that accumulates data and then bins it into a histogram.
@@ -36,26 +39,58 @@ class BinStyle;
  *    specified by a molstat::BinStyle object.
  *
  * The reason for this split is that the binning operation needs to know the
- * bounds of the data. As data is added, the class tracks the minimum and
- * maximum values.
+ * bounds of the data. The data is stored in a molstat::SampleBuffer (one
+ * contiguous array per dimension), and the bounds are found when binning.
+ *
+ * Alternatively, if the bounds of each dimension are known in advance, the
+ * histogram can be constructed in a streaming mode. In this case the bins are
+ * formed at construction and each data element is binned (and discarded) as
+ * it is added, so that the memory required is proportional to the number of
+ * bins, not the number of data elements. Data elements outside the bounds are
+ * not binned; instead, the underflows and overflows are counted for each
+ * dimension.
  *
  * Histograms of any dimensionality can be constructed.
+ *
+ * The bin counts of a histogram with many bins (at least
+ * Histogram::sparse_min_bins) are stored sparsely, as a hash table of the
+ * occupied bins, while few of the bins are occupied; once more than
+ * 1/Histogram::sparse_occupancy of the bins are occupied, the counts are
+ * moved to a dense array. The storage is chosen automatically and does not
+ * change the results; the functions that return all of the counts (e.g.,
+ * getBinCounts) always return dense arrays.
  */
 class Histogram
 {
 private:
+	/// SharedHistogram bins data with the bins of a streaming histogram.
+	friend class SharedHistogram;
+
+	/// Scratch space for binning a block of data elements.
+	struct BinBlock
+	{
+		/// The masked values of the elements (in one dimension).
+		std::vector<double> masked;
+
+		/// The bin (array offset) of each element.
+		std::vector<std::size_t> offsets;
+
+		/// Whether each element is within the bounds.
+		std::vector<unsigned char> valid;
+	};
+
 	/// State of the histogram: False if binning has not occurred; true if it
 	/// has.
 	bool haveBinned;
 
+	/// True if the histogram bins data as it is added (streaming mode).
+	const bool streaming;
+
 	/// The dimensionality of the data.
 	const std::size_t ndim;
 
 	/// The accumulated data.
-	std::forward_list<std::valarray<double>> data;
-
-	/// The minimum and maximum values in each dimension.
-	std::vector<std::array<double, 2>> extremes;
+	SampleBuffer data;
 
 	/// The number of bins in each dimension.
 	std::vector<std::size_t> nbin_dim;
@@ -67,8 +102,195 @@ private:
 	 */
 	std::vector<std::vector<double>> bin_value;
 
-	/// The counts in each bin.
-	std::vector<double> binned_data;
+	/**
+	 * \brief The weight of each bin in each dimension (the derivative of the
+	 *    mask, molstat::BinStyle::dmaskdx, at the middle of the bin).
+	 *
+	 * The weight of a bin is the product of its weights in each dimension.
+	 * The indices are as in Histogram::bin_value.
+	 */
+	std::vector<std::vector<double>> bin_weight;
+
+	/// The total number of bins.
+	std::size_t total_bins;
+
+	/// True if the counts are stored in Histogram::sparse_data.
+	bool sparse;
+
+	/// The (raw) counts in each bin (dense storage).
+	std::vector<std::size_t> binned_data;
+
+	/// The (raw) counts in the occupied bins, by array offset (sparse
+	/// storage).
+	std::unordered_map<std::size_t, std::size_t> sparse_data;
+
+	/**
+	 * \brief True if the data elements carry weights (e.g., from importance
+	 *    sampling), whose sums are stored in Histogram::weighted_data.
+	 */
+	bool weighted;
+
+	/**
+	 * \brief The sum of the weights of the data elements in each bin (dense
+	 *    storage, only for weighted histograms).
+	 */
+	std::vector<double> weighted_data;
+
+	/**
+	 * \brief The bounds of each dimension in masked coordinates.
+	 *
+	 * For each dimension, the elements are the minimum, the maximum, and the
+	 * width of each bin.
+	 */
+	std::vector<std::array<double, 3>> masked_bounds;
+
+	/**
+	 * \brief The reciprocal of the width of the bins in each dimension
+	 *    (masked coordinates); 0 if the width is 0.
+	 */
+	std::vector<double> inverse_width;
+
+	/**
+	 * \brief The binning styles (set once the bins are formed).
+	 *
+	 * The bin counts are stored unweighted, as integers (so that histograms
+	 * sum exactly); the weights are applied when the counts are accessed.
+	 */
+	std::vector<std::shared_ptr<const BinStyle>> styles;
+
+	/// The number of data elements outside the bounds (streaming mode only).
+	std::size_t n_out_of_range;
+
+	/**
+	 * \brief The number of underflows and overflows in each dimension
+	 *    (streaming mode only).
+	 */
+	std::vector<std::array<std::size_t, 2>> out_of_range_dim;
+
+	/// Scratch space for binning a block of data elements.
+	BinBlock block;
+
+	/**
+	 * \brief True if a streaming histogram keeps the data elements outside
+	 *    its bounds (in Histogram::data), so that they can be binned if the
+	 *    bins are widened.
+	 */
+	bool retain_out;
+
+	/**
+	 * \brief Allocates (empty) storage for the bin counts.
+	 *
+	 * \param[in] nbins The total number of bins.
+	 * \param[in] expected The number of bins expected to be occupied (e.g.,
+	 *    the number of data elements to bin, or 0 for an empty streaming
+	 *    histogram).
+	 */
+	void allocateBins(std::size_t nbins, std::size_t expected);
+
+	/// Moves the bin counts to dense storage.
+	void useDenseStorage();
+
+	/**
+	 * \brief Moves the bin counts to dense storage if too many bins are
+	 *    occupied for sparse storage.
+	 */
+	void checkOccupancy();
+
+	/**
+	 * \brief Adds the binned elements of a block to the bin counts.
+	 *
+	 * \param[in] n The number of elements, whose bins are in
+	 *    Histogram::block.
+	 * \param[in] w The weight of each element (for weighted histograms), or
+	 *    nullptr if each element has weight 1.
+	 * \return The number of elements that were not binned.
+	 */
+	std::size_t countBlock(std::size_t n, const double *w = nullptr);
+
+	/**
+	 * \brief Bins one dimension of a block of data elements.
+	 *
+	 * The values are masked with one call to BinStyle::mask_n and the bin
+	 * indices are found without branches, so that the loops can be
+	 * vectorized. The array offsets are computed as in
+	 * CounterIndex::arrayOffset (the first dimension changes the fastest), so
+	 * the dimensions must be binned from last to first.
+	 *
+	 * The offsets and validities of the block must hold (at least) `n`
+	 * elements, initially 0 and 1, respectively.
+	 *
+	 * \param[in] j The dimension.
+	 * \param[in] bstyle The binning style of the dimension.
+	 * \param[in] values The values of dimension `j`, `stride` apart.
+	 * \param[in] stride The distance between consecutive values.
+	 * \param[in] n The number of data elements.
+	 * \param[in,out] scratch The block.
+	 * \param[in,out] tallies The underflows and overflows of the dimension,
+	 *    incremented for the elements of the block.
+	 */
+	void binDimension(std::size_t j, const BinStyle &bstyle,
+		const double *values, std::size_t stride, std::size_t n,
+		BinBlock &scratch, std::array<std::size_t, 2> &tallies) const;
+
+	/**
+	 * \brief Bins a block of data elements (streaming mode), without
+	 *    changing the bin counts.
+	 *
+	 * \param[in] v The data, stored contiguously as in add_data.
+	 * \param[in] n The number of data elements.
+	 * \param[in,out] scratch The block, which receives the bin and validity
+	 *    of each element.
+	 * \param[in,out] tallies The underflows and overflows of each dimension,
+	 *    incremented for the elements of the block.
+	 */
+	void binBlock(const double *v, std::size_t n, BinBlock &scratch,
+		std::vector<std::array<std::size_t, 2>> &tallies) const;
+
+	/**
+	 * \brief Bins the stored data elements of a chunk (streaming mode),
+	 *    without changing the bin counts.
+	 *
+	 * \param[in] chunk The chunk of data elements.
+	 * \param[in,out] scratch The block, which receives the bin and validity
+	 *    of each element.
+	 * \param[in,out] tallies The underflows and overflows of each dimension,
+	 *    incremented for the elements of the chunk.
+	 */
+	void binChunk(const SampleBuffer::Chunk &chunk, BinBlock &scratch,
+		std::vector<std::array<std::size_t, 2>> &tallies) const;
+
+	/**
+	 * \brief Adds the stored data elements of a buffer (streaming mode).
+	 *
+	 * Elements outside the bounds are tallied and, if they are retained, are
+	 * stored in Histogram::data.
+	 *
+	 * \param[in] samples The data elements.
+	 */
+	void add_samples(const SampleBuffer &samples);
+
+	/**
+	 * \brief Bins the stored data elements (non-streaming mode) into the
+	 *    allocated bins, with the binning styles in Histogram::styles.
+	 *
+	 * \param[in,out] scheduler The threads that bin the data, or nullptr to
+	 *    bin them on the calling thread.
+	 */
+	void bin_stored(TaskScheduler *scheduler);
+
+	/**
+	 * \brief Doubles the width of the bins of a dimension (in masked
+	 *    coordinates) one or more times, merging the bin counts.
+	 *
+	 * Each new bin is a whole number of the old bins, so that the counts of
+	 * the new bins are exact.
+	 *
+	 * \param[in] j The dimension.
+	 * \param[in] factor The number of old bins in each new bin, a power of 2.
+	 * \param[in] shift The number of (old) bins between the new lower bound
+	 *    and the old lower bound.
+	 */
+	void coarsen(std::size_t j, std::size_t factor, std::size_t shift);
 
 	/**
 	 * \brief Calculates the values of the bins (for a particular dimension).
@@ -82,7 +304,26 @@ private:
 	static std::vector<double> bin_values(double dmin, double dmax,
 		double dwidth, std::shared_ptr<const BinStyle> bstyle);
 
+	/**
+	 * \brief Calculates the weights of the bins (for a particular dimension).
+	 *
+	 * \param[in] values The values of the bins in the dimension.
+	 * \param[in] bstyle The binning style of the dimension.
+	 * \return The weight of each bin in the dimension.
+	 */
+	static std::vector<double> bin_weights(const std::vector<double> &values,
+		const BinStyle &bstyle);
+
 public:
+	/// The fewest bins for which the counts may be stored sparsely.
+	static const std::size_t sparse_min_bins;
+
+	/**
+	 * \brief Sparse storage is used while at most 1 in this many bins are
+	 *    occupied.
+	 */
+	static const std::size_t sparse_occupancy;
+
 	Histogram() = delete;
 	
 	/**
@@ -92,32 +333,277 @@ public:
 	 */
 	Histogram(std::size_t ndim_);
 
+	/**
+	 * \brief Constructor for a streaming histogram with fixed bounds.
+	 *
+	 * The dimensionality is the number of binning styles.
+	 *
+	 * \throw std::invalid_argument if the number of bounds does not match the
+	 *    number of binning styles, if a binning style is null or has 0 bins,
+	 *    or if the bounds for a dimension are not increasing (in masked
+	 *    coordinates).
+	 *
+	 * \param[in] binstyles The binning styles for each dimension.
+	 * \param[in] bounds The lower and upper bounds for each dimension.
+	 */
+	Histogram(const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+		const std::vector<std::array<double, 2>> &bounds);
+
+	/**
+	 * \brief Constructor for a streaming histogram, using the fixed bounds
+	 *    of the binning styles.
+	 *
+	 * \throw std::invalid_argument if a binning style is null, has 0 bins, or
+	 *    does not have fixed bounds.
+	 *
+	 * \param[in] binstyles The binning styles for each dimension.
+	 */
+	Histogram(const std::vector<std::shared_ptr<const BinStyle>> &binstyles);
+
 	/**
 	 * \brief Adds a data element to the histogram.
 	 *
+	 * In streaming mode, the data element is binned immediately.
+	 *
 	 * \throw std::invalid_argument if the data has the wrong dimensionality.
-	 * \throw std::runtime_error if the bins have already been formed.
+	 * \throw std::runtime_error if the bins have already been formed (and the
+	 *    histogram is not in streaming mode).
 	 *
 	 * \param[in] v The data.
 	 */
 	void add_data(std::valarray<double> v);
 
+	/**
+	 * \brief Adds several data elements to the histogram.
+	 *
+	 * The data elements are stored contiguously, one after another; that is,
+	 * the `j`th value of element `k` is `v[k*ndim + j]`.
+	 *
+	 * \throw std::runtime_error if the bins have already been formed (and the
+	 *    histogram is not in streaming mode).
+	 *
+	 * \param[in] v The data.
+	 * \param[in] n The number of data elements.
+	 */
+	void add_data(const double *v, std::size_t n);
+
+	/**
+	 * \brief Adds several weighted data elements to a streaming histogram.
+	 *
+	 * Each bin accumulates the weights of its data elements instead of
+	 * counting them (see useWeights()), as needed for importance sampling.
+	 * The raw counts and the elements outside the bounds are still counted.
+	 *
+	 * \throw std::runtime_error if the histogram is not in streaming mode or
+	 *    keeps the elements outside its bounds (see retainOutOfRange).
+	 *
+	 * \param[in] v The data, stored contiguously as in
+	 *    add_data(const double*, std::size_t).
+	 * \param[in] w The weight of each data element.
+	 * \param[in] n The number of data elements.
+	 */
+	void add_data(const double *v, const double *w, std::size_t n);
+
+	/**
+	 * \brief Makes a streaming histogram accumulate the weights of its data
+	 *    elements.
+	 *
+	 * The elements already binned (and those added without weights) have
+	 * weight 1. The bin counts are then stored densely. This does nothing if
+	 * the histogram is already weighted.
+	 *
+	 * \throw std::runtime_error if the histogram is not in streaming mode or
+	 *    keeps the elements outside its bounds (see retainOutOfRange).
+	 */
+	void useWeights();
+
+	/**
+	 * \brief Determines if the data elements are weighted.
+	 *
+	 * \return True if the bins accumulate weights (see useWeights()).
+	 */
+	bool isWeighted() const noexcept;
+
+	/**
+	 * \brief Moves the dense bin counts (and sums of weights) to memory
+	 *    first written by the calling thread.
+	 *
+	 * On a NUMA machine, a page is placed on the node of the thread that
+	 * first writes it. A histogram constructed by one thread and filled by
+	 * another should thus be localized by the filling thread (pinned to its
+	 * CPU; see PinThread) before it adds data. The counts are unchanged.
+	 * Sparse counts, and the stored data, are already allocated by the thread
+	 * that adds the data.
+	 */
+	void localize();
+
+	/**
+	 * \brief Merges the (unbinned) data of another histogram into this one.
+	 *
+	 * This is intended for combining histograms that were accumulated
+	 * independently (e.g., by different threads). The data in `other` is
+	 * moved into this histogram and `other` is left empty.
+	 *
+	 * Streaming histograms can only be merged with streaming histograms that
+	 * have the same bins; the bin counts are summed. If either histogram is
+	 * weighted, so is the result.
+	 *
+	 * \throw std::invalid_argument if the dimensionalities differ, if only one
+	 *    of the histograms is in streaming mode, or if the bins of two
+	 *    streaming histograms differ.
+	 * \throw std::runtime_error if either histogram has already been binned
+	 *    (and is not in streaming mode).
+	 *
+	 * \param[in,out] other The histogram whose data is merged.
+	 */
+	void merge(Histogram &&other);
+
+	/**
+	 * \brief Bins the (unbinned) data of a non-streaming histogram into this
+	 *    streaming histogram.
+	 *
+	 * This is intended for data collected before the bounds are known (e.g.,
+	 * a pilot run that estimates the bounds). The data in `stored` is
+	 * removed.
+	 *
+	 * \throw std::invalid_argument if the dimensionalities differ or if this
+	 *    histogram is not in streaming mode.
+	 * \throw std::runtime_error if `stored` is in streaming mode or has
+	 *    already been binned.
+	 *
+	 * \param[in,out] stored The histogram whose data is binned.
+	 */
+	void add_stored(Histogram &&stored);
+
+	/**
+	 * \brief Sets whether a streaming histogram keeps the data elements
+	 *    outside its bounds.
+	 *
+	 * The kept elements are binned if the bins are later widened (see
+	 * widen). They are still tallied as outside the bounds until then. When
+	 * elements are no longer kept, those already kept are discarded.
+	 *
+	 * \throw std::runtime_error if the histogram is not in streaming mode, or
+	 *    if it is weighted and `retain` is true.
+	 *
+	 * \param[in] retain True to keep the elements outside the bounds.
+	 */
+	void retainOutOfRange(bool retain);
+
+	/**
+	 * \brief Gets the number of data elements outside the bounds that are
+	 *    kept (see retainOutOfRange).
+	 *
+	 * \return The number of kept elements.
+	 */
+	std::size_t numRetained() const noexcept;
+
+	/**
+	 * \brief Gets the extremes, in masked coordinates, of the kept data
+	 *    elements outside the bounds (see retainOutOfRange).
+	 *
+	 * Values whose masked values are not finite (e.g., negative values with
+	 * logarithmic binning) are ignored. Without such values in a dimension,
+	 * the minimum is the largest double and the maximum is the lowest double.
+	 *
+	 * \return The minimum and maximum masked values in each dimension.
+	 */
+	std::vector<std::array<double, 2>> getRetainedExtremes() const;
+
+	/**
+	 * \brief Widens the bins of a streaming histogram to include the
+	 *    specified (masked) extremes, and bins the kept data elements that
+	 *    are then inside the bounds.
+	 *
+	 * The kept elements that are still outside the bounds (e.g., those whose
+	 * masked values are not finite) are no longer kept, but remain tallied as
+	 * outside the bounds.
+	 *
+	 * The number of bins in each dimension is unchanged. Instead, the width
+	 * of the bins is doubled (in masked coordinates) as many times as
+	 * needed, merging pairs of bins, so that the bin counts remain exact.
+	 * The extra range goes to the side(s) of the bounds that the extremes
+	 * exceed. Histograms with the same bins that are widened with the same
+	 * extremes continue to have the same bins.
+	 *
+	 * \throw std::invalid_argument if the number of extremes does not match
+	 *    the dimensionality.
+	 * \throw std::runtime_error if the histogram is not in streaming mode.
+	 *
+	 * \param[in] extremes The minimum and maximum masked values to include
+	 *    in each dimension (e.g., from getRetainedExtremes, over several
+	 *    histograms). Dimensions whose extremes are within the bounds (or are
+	 *    not finite) are not changed.
+	 * \return True if the bins changed.
+	 */
+	bool widen(const std::vector<std::array<double, 2>> &extremes);
+
 	/**
 	 * \brief Bins the data using the specified binning styles for each
 	 *    dimension.
 	 *
 	 * \throw std::invalid_argument if the number of binning styles doesn't
 	 *    match the dimensionality of the data.
-	 * \throw std::runtime_error if the histogram has already been binned, if
-	 *    one dimension doesn't specify a binning style, or if one dimension
-	 *    uses a binning style with 0 bins.
+	 * \throw std::runtime_error if the histogram has already been binned (this
+	 *    includes histograms in streaming mode), if one dimension doesn't
+	 *    specify a binning style, or if one dimension uses a binning style
+	 *    with 0 bins.
 	 * \throw std::size_t if a dimenion (its index is thrown) has a null data
 	 *    range (all values are the same) and more than one bin is requested.
 	 *
 	 * \param[in] binstyles The binning styles.
+	 * \param[in,out] scheduler The threads that bin the data (as when the
+	 *    extremes are specified), or nullptr to bin them on the calling
+	 *    thread.
 	 */
 	void bin_data(
-		const std::vector<std::shared_ptr<const BinStyle>> &binstyles);
+		const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+		TaskScheduler *scheduler = nullptr);
+
+	/**
+	 * \brief Bins the data using the specified binning styles and the
+	 *    specified extremes of the data.
+	 *
+	 * This is intended for data divided among several histograms (e.g., in
+	 * different processes): binning each with the extremes of all the data
+	 * gives every histogram the same bins, which are those of a single
+	 * histogram of all the data.
+	 *
+	 * \throw std::invalid_argument if the number of binning styles or
+	 *    extremes doesn't match the dimensionality of the data.
+	 * \throw std::runtime_error as for bin_data() without the extremes.
+	 * \throw std::size_t as for bin_data() without the extremes.
+	 *
+	 * With a scheduler, the chunks of stored data are divided into
+	 * contiguous partitions, each binned by a task into its own (private)
+	 * counts; the private counts are then summed pairwise, as a tree. The
+	 * counts are integers, so the histogram is the same as when the data are
+	 * binned on the calling thread. The dense private counts are limited
+	 * (by using fewer partitions) to the memory of the stored data.
+	 *
+	 * \param[in] binstyles The binning styles.
+	 * \param[in] extremes The minimum and maximum values in each dimension,
+	 *    which must include the data in this histogram.
+	 * \param[in,out] scheduler The threads that bin the data, or nullptr to
+	 *    bin them on the calling thread.
+	 */
+	void bin_data(
+		const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+		const std::vector<std::array<double, 2>> &extremes,
+		TaskScheduler *scheduler = nullptr);
+
+	/**
+	 * \brief Gets the minimum and maximum values of the (unbinned) data in
+	 *    each dimension.
+	 *
+	 * Without data, the minimum is the largest double and the maximum is
+	 * the lowest double.
+	 *
+	 * \throw std::runtime_error if the histogram has already been binned.
+	 *
+	 * \return The minimum and maximum in each dimension.
+	 */
+	std::vector<std::array<double, 2>> getDataExtremes() const;
 
 	/**
 	 * \brief Gets an index that iterates over all the bins.
@@ -139,6 +625,48 @@ public:
 	 */
 	std::valarray<double> getCoordinates(const CounterIndex &index) const;
 
+	/**
+	 * \brief Gets the coordinates of the bins in one dimension.
+	 *
+	 * The coordinates of a bin are, in each dimension, the coordinate of its
+	 * index in that dimension; unlike getCoordinates, this does not allocate
+	 * memory for each bin.
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The coordinate (middle) of each bin in dimension `dim`.
+	 */
+	const std::vector<double> &getBinCoordinates(std::size_t dim) const;
+
+	/**
+	 * \brief Gets the weights of the bins in one dimension.
+	 *
+	 * The weight of a bin (the factor between its raw and weighted counts) is
+	 * the product of its weights in each dimension.
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The weight of each bin in dimension `dim`.
+	 */
+	const std::vector<double> &getBinWeights(std::size_t dim) const;
+
+	/**
+	 * \brief Gets all of the (weighted) bin counts.
+	 *
+	 * The weights are applied one dimension at a time, which is much faster
+	 * than calling getBinCount for each bin.
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 *
+	 * \return The bin counts, with the first dimension changing the fastest
+	 *    (as in molstat::CounterIndex::arrayOffset).
+	 */
+	std::vector<double> getBinCounts() const;
+
 	/**
 	 * \brief Returns the bin count for the given bin.
 	 *
@@ -148,8 +676,215 @@ public:
 	 * \return The bin count of the bin.
 	 */
 	double getBinCount(const CounterIndex &index) const;
+
+	/**
+	 * \brief Returns the raw (unweighted) bin count for the given bin.
+	 *
+	 * This is the number of data elements in the bin, before the weight
+	 * function of the binning styles (molstat::BinStyle::dmaskdx) is
+	 * applied. Raw counts from histograms with identical bins can be summed.
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 *
+	 * \param[in] index The index of the bin.
+	 * \return The raw bin count of the bin.
+	 */
+	std::size_t getRawBinCount(const CounterIndex &index) const;
+
+	/**
+	 * \brief Gets all of the raw (unweighted) bin counts.
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 *
+	 * \return The raw bin counts, with the first dimension changing the
+	 *    fastest (as in molstat::CounterIndex::arrayOffset).
+	 */
+	std::vector<std::size_t> getRawBinCounts() const;
+
+	/**
+	 * \brief Gets the sum of the weights of the data elements in each bin.
+	 *
+	 * These are the bin counts before the weight function of the binning
+	 * styles is applied; for an unweighted histogram, they are the raw bin
+	 * counts. Sums from histograms with identical bins can be added.
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 *
+	 * \return The sums, with the first dimension changing the fastest (as in
+	 *    molstat::CounterIndex::arrayOffset).
+	 */
+	std::vector<double> getRawBinSums() const;
+
+	/**
+	 * \brief Replaces the sums of the weights in each bin of a weighted
+	 *    histogram.
+	 *
+	 * This is intended for combining weighted histograms with the same bins
+	 * that cannot be merged directly (e.g., sums over several processes),
+	 * after setRawBinCounts.
+	 *
+	 * \throw std::runtime_error if the histogram is not weighted.
+	 * \throw std::invalid_argument if there are the wrong number of sums.
+	 *
+	 * \param[in] sums The sums, as from getRawBinSums.
+	 */
+	void setRawBinSums(std::vector<double> sums);
+
+	/**
+	 * \brief Replaces the raw bin counts and the numbers of data elements
+	 *    outside the bounds.
+	 *
+	 * This is intended for combining histograms with the same bins that
+	 * cannot be merged directly (e.g., sums over several processes). The
+	 * storage of the counts is chosen from their occupancy.
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 * \throw std::invalid_argument if there are the wrong number of counts
+	 *    or underflows and overflows.
+	 *
+	 * \param[in] counts The raw bin counts, as from getRawBinCounts.
+	 * \param[in] nout The number of data elements outside the bounds.
+	 * \param[in] out_of_range The numbers of underflows and overflows in
+	 *    each dimension.
+	 */
+	void setRawBinCounts(std::vector<std::size_t> counts, std::size_t nout,
+		const std::vector<std::array<std::size_t, 2>> &out_of_range);
+
+	/**
+	 * \brief Gets the dimensionality of the data.
+	 *
+	 * \return The number of dimensions.
+	 */
+	std::size_t numDimensions() const noexcept;
+
+	/**
+	 * \brief Gets the number of bins in a dimension.
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The number of bins in dimension `dim`.
+	 */
+	std::size_t numBins(std::size_t dim) const;
+
+	/**
+	 * \brief Gets the bounds of a dimension, in masked coordinates.
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The lower and upper bounds of dimension `dim`.
+	 */
+	std::array<double, 2> getMaskedBounds(std::size_t dim) const;
+
+	/**
+	 * \brief Determines if the histogram is in streaming mode.
+	 *
+	 * \return True if the histogram bins data as it is added.
+	 */
+	bool isStreaming() const noexcept;
+
+	/**
+	 * \brief Determines if the bin counts are stored sparsely.
+	 *
+	 * \return True if only the occupied bins are stored.
+	 */
+	bool isSparse() const noexcept;
+
+	/**
+	 * \brief Gets the memory allocated for the stored data (including the
+	 *    data kept outside the bounds) and the bins.
+	 *
+	 * The sparse bins are estimated from the number of occupied bins.
+	 *
+	 * \return The memory (bytes).
+	 */
+	std::size_t memoryUsage() const noexcept;
+
+	/**
+	 * \brief Gets the number of data elements that were outside the bounds.
+	 *
+	 * This is always 0 if the histogram is not in streaming mode.
+	 *
+	 * \return The number of data elements that were not binned.
+	 */
+	std::size_t numOutOfRange() const noexcept;
+
+	/**
+	 * \brief Gets the number of data elements below the lower bound in a
+	 *    dimension.
+	 *
+	 * An element can be out of range in several dimensions, so the sum over
+	 * dimensions may exceed numOutOfRange(). This is always 0 if the
+	 * histogram is not in streaming mode.
+	 *
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The number of underflows in dimension `dim`.
+	 */
+	std::size_t numUnderflow(std::size_t dim) const;
+
+	/**
+	 * \brief Gets the number of data elements above the upper bound in a
+	 *    dimension.
+	 *
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The number of overflows in dimension `dim`.
+	 */
+	std::size_t numOverflow(std::size_t dim) const;
 };
 
+/**
+ * \brief Applies separable bin weights to a block of bin counts.
+ *
+ * The weight of a bin is the product of its weights in each dimension; the
+ * counts are scaled one dimension at a time, without visiting each bin
+ * `ndim` times.
+ *
+ * \param[in,out] counts The bin counts, with the first dimension changing
+ *    the fastest (as in molstat::CounterIndex::arrayOffset). The number of
+ *    counts must be the product of the numbers of weights.
+ * \param[in] weights The weight of each bin in each dimension.
+ */
+void ApplyBinWeights(std::vector<double> &counts,
+	const std::vector<std::vector<double>> &weights);
+
+/**
+ * \brief Calculates the Hellinger distance between two histograms with the
+ *    same bins.
+ *
+ * Each histogram is normalized to a probability distribution over its bins,
+ * `p` and `q`, respectively. The distance is `sqrt(1 - sum_i sqrt(p_i
+ * q_i))`, which is 0 for identical distributions and 1 for distributions
+ * that do not overlap.
+ *
+ * \throw std::invalid_argument if the numbers of bins differ.
+ *
+ * \param[in] a The raw bin counts of the first histogram.
+ * \param[in] b The raw bin counts of the second histogram.
+ * \return The Hellinger distance; 1 if either histogram is empty.
+ */
+double HellingerDistance(const std::vector<std::size_t> &a,
+	const std::vector<std::size_t> &b);
+
+/**
+ * \brief Calculates the Hellinger distance between two histograms with the
+ *    same bins, from their (weighted) sums in each bin.
+ *
+ * \throw std::invalid_argument if the numbers of bins differ.
+ *
+ * \param[in] a The raw bin sums of the first histogram.
+ * \param[in] b The raw bin sums of the second histogram.
+ * \return The Hellinger distance; 1 if either histogram is empty.
+ */
+double HellingerDistance(const std::vector<double> &a,
+	const std::vector<double> &b);
+
 } // namespace molstat
 
 #endif
@@ -0,0 +1,231 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_hdf5.cc
+ * \brief Implementation of writing histograms to HDF5 files.
+ *
+ * This function is separate from the rest of histogram_io.cc so that only
+ * programs that write HDF5 files need to link with HDF5.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <config.h>
+#include "histogram_io.h"
+#include "histogram.h"
+#include "bin_style.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#if HAVE_HDF5
+#include <hdf5.h>
+#endif
+
+namespace molstat {
+
+#if HAVE_HDF5
+/**
+ * \brief Owns an HDF5 identifier, closing it when destroyed.
+ */
+class HDF5Handle
+{
+private:
+	/// The identifier.
+	hid_t id;
+
+	/// The function that closes the identifier.
+	herr_t (*closer)(hid_t);
+
+public:
+	HDF5Handle() = delete;
+	HDF5Handle(const HDF5Handle &) = delete;
+	HDF5Handle &operator=(const HDF5Handle &) = delete;
+
+	/**
+	 * \brief Takes ownership of an HDF5 identifier.
+	 *
+	 * \throw std::runtime_error if the identifier is invalid (i.e., the
+	 *    HDF5 call that produced it failed).
+	 *
+	 * \param[in] id_ The identifier.
+	 * \param[in] closer_ The function that closes the identifier.
+	 * \param[in] what Description of the HDF5 call, for error messages.
+	 */
+	HDF5Handle(hid_t id_, herr_t (*closer_)(hid_t), const std::string &what)
+		: id(id_), closer(closer_)
+	{
+		if(id < 0)
+			throw std::runtime_error("HDF5 error: unable to " + what + ".");
+	}
+
+	/**
+	 * \brief Closes the identifier.
+	 */
+	~HDF5Handle()
+	{
+		closer(id);
+	}
+
+	/**
+	 * \brief Gets the identifier.
+	 *
+	 * \return The identifier.
+	 */
+	operator hid_t() const noexcept
+	{
+		return id;
+	}
+};
+
+/**
+ * \brief Checks the status returned by an HDF5 call.
+ *
+ * \throw std::runtime_error if the call failed.
+ *
+ * \param[in] status The status.
+ * \param[in] what Description of the HDF5 call, for error messages.
+ */
+static void check_hdf5(herr_t status, const std::string &what)
+{
+	if(status < 0)
+		throw std::runtime_error("HDF5 error: unable to " + what + ".");
+}
+
+/**
+ * \brief Writes an array of doubles as an attribute.
+ *
+ * \param[in] obj The object that gets the attribute.
+ * \param[in] name The name of the attribute.
+ * \param[in] vals The values.
+ */
+static void write_attribute(hid_t obj, const std::string &name,
+	const std::vector<double> &vals)
+{
+	const hsize_t n{ vals.size() };
+	HDF5Handle space{ H5Screate_simple(1, &n, nullptr), H5Sclose,
+		"create the dataspace for " + name };
+	HDF5Handle attr{ H5Acreate2(obj, name.c_str(), H5T_IEEE_F64LE, space,
+		H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "create attribute " + name };
+	check_hdf5(H5Awrite(attr, H5T_NATIVE_DOUBLE, vals.data()),
+		"write attribute " + name);
+}
+
+/**
+ * \brief Writes an unsigned integer as an attribute.
+ *
+ * \param[in] obj The object that gets the attribute.
+ * \param[in] name The name of the attribute.
+ * \param[in] val The value.
+ */
+static void write_attribute(hid_t obj, const std::string &name,
+	std::uint64_t val)
+{
+	HDF5Handle space{ H5Screate(H5S_SCALAR), H5Sclose,
+		"create the dataspace for " + name };
+	HDF5Handle attr{ H5Acreate2(obj, name.c_str(), H5T_STD_U64LE, space,
+		H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "create attribute " + name };
+	check_hdf5(H5Awrite(attr, H5T_NATIVE_UINT64, &val),
+		"write attribute " + name);
+}
+
+/**
+ * \brief Writes a string as an attribute.
+ *
+ * \param[in] obj The object that gets the attribute.
+ * \param[in] name The name of the attribute.
+ * \param[in] val The string.
+ */
+static void write_attribute(hid_t obj, const std::string &name,
+	const std::string &val)
+{
+	HDF5Handle type{ H5Tcopy(H5T_C_S1), H5Tclose,
+		"create the string type for " + name };
+	check_hdf5(H5Tset_size(type, val.empty() ? 1 : val.size()),
+		"set the string size for " + name);
+	HDF5Handle space{ H5Screate(H5S_SCALAR), H5Sclose,
+		"create the dataspace for " + name };
+	HDF5Handle attr{ H5Acreate2(obj, name.c_str(), type, space, H5P_DEFAULT,
+		H5P_DEFAULT), H5Aclose, "create attribute " + name };
+	check_hdf5(H5Awrite(attr, type, val.empty() ? "" : val.data()),
+		"write attribute " + name);
+}
+#endif
+
+void WriteHistogramHDF5(const std::string &filename, const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, std::size_t nbinned)
+{
+#if HAVE_HDF5
+	const std::size_t ndim{ binstyles.size() };
+	if(ndim != hist.numDimensions())
+		throw std::invalid_argument("Incorrect number of binning styles.");
+
+	// the counts, in one block, with the first dimension changing the fastest
+	const std::vector<double> counts{ hist.getBinCounts() };
+
+	// HDF5 stores arrays with the last axis changing the fastest, so the axes
+	// are the dimensions in reverse order. the chunks hold roughly 64K bins.
+	const hsize_t chunk_side{ std::max<hsize_t>(1,
+		static_cast<hsize_t>(std::pow(65536., 1. / ndim))) };
+	std::vector<hsize_t> dims(ndim), chunk(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		dims[ndim - 1 - j] = hist.numBins(j);
+		chunk[ndim - 1 - j] = std::min(dims[ndim - 1 - j], chunk_side);
+	}
+
+	HDF5Handle file{ H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT,
+		H5P_DEFAULT), H5Fclose, "create " + filename };
+	HDF5Handle group{ H5Gcreate2(file, "histogram", H5P_DEFAULT, H5P_DEFAULT,
+		H5P_DEFAULT), H5Gclose, "create the histogram group" };
+
+	HDF5Handle plist{ H5Pcreate(H5P_DATASET_CREATE), H5Pclose,
+		"create the dataset properties" };
+	check_hdf5(H5Pset_chunk(plist, ndim, chunk.data()),
+		"set the chunk size");
+	if(H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0)
+		check_hdf5(H5Pset_deflate(plist, 4), "set the compression");
+
+	HDF5Handle space{ H5Screate_simple(ndim, dims.data(), nullptr), H5Sclose,
+		"create the dataspace for the counts" };
+	HDF5Handle dset{ H5Dcreate2(group, "counts", H5T_IEEE_F64LE, space,
+		H5P_DEFAULT, plist, H5P_DEFAULT), H5Dclose,
+		"create the counts dataset" };
+	check_hdf5(H5Dwrite(dset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL,
+		H5P_DEFAULT, counts.data()), "write the counts");
+
+	write_attribute(dset, "ntrials", static_cast<std::uint64_t>(ntrials));
+	write_attribute(dset, "nbinned", static_cast<std::uint64_t>(nbinned));
+
+	// the bins in each dimension
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		const std::size_t nbins{ hist.numBins(j) };
+		const std::array<double, 2> masked{ hist.getMaskedBounds(j) };
+		const std::string suffix{ "_" + std::to_string(j) };
+
+		// the edges are evenly spaced in the masked coordinates
+		std::vector<double> edges(nbins + 1);
+		for(std::size_t k = 0; k <= nbins; ++k)
+			edges[k] = binstyles[j]->invmask(masked[0] +
+				(masked[1] - masked[0]) * k / nbins);
+		write_attribute(dset, "edges" + suffix, edges);
+
+		write_attribute(dset, "coordinates" + suffix,
+			hist.getBinCoordinates(j));
+
+		write_attribute(dset, "style" + suffix, binstyles[j]->info());
+	}
+#else
+	throw std::runtime_error("The hdf5 output format is unavailable: " \
+		"MolStat was compiled without HDF5.");
+#endif
+}
+
+} // namespace molstat
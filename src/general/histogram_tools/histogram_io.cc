@@ -0,0 +1,610 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_io.cc
+ * \brief Implementation of writing and reading histograms.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <config.h>
+#include "histogram_io.h"
+#include "histogram.h"
+#include "bin_style.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <general/binary_io.h>
+#include <general/string_tools.h>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace molstat {
+
+/// The characters at the beginning of a binary histogram file.
+static const char binary_magic[8]{ 'M', 'O', 'L', 'S', 'T', 'A', 'T', 'H' };
+
+/// The version of the binary histogram format.
+static constexpr std::uint64_t binary_version{ 1 };
+
+/// The characters at the beginning of a mergeable histogram file.
+static const char mergeable_magic[8]{ 'M', 'O', 'L', 'S', 'T', 'A', 'T', 'M' };
+
+/// The version of the mergeable histogram format.
+static constexpr std::uint64_t mergeable_version{ 1 };
+
+/// What the binary streams hold, for the error messages.
+static const char histogram_source[]{ "the histogram file" };
+
+/**
+ * \brief Writes an array of doubles to a binary stream.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] vals The values.
+ * \param[in] n The number of values.
+ */
+static void write_doubles(std::ostream &out, const double *vals,
+	std::size_t n)
+{
+	out.write(reinterpret_cast<const char*>(vals), n * sizeof(double));
+}
+
+/**
+ * \brief Reads a version number from a binary stream.
+ *
+ * \throw std::runtime_error if the stream ends early or if the version is
+ *    not the expected one.
+ *
+ * \param[in,out] in The input stream.
+ * \param[in] expected The expected version.
+ */
+static void read_version(std::istream &in, std::uint64_t expected)
+{
+	if(ReadBinaryUInt(in, histogram_source) != expected)
+		throw std::runtime_error("Unsupported version of the binary " \
+			"histogram format (possibly written on a machine with a different " \
+			"byte order).");
+}
+
+/**
+ * \brief Collects the coordinates and (weighted) bin counts of a histogram.
+ *
+ * \throw std::runtime_error if the data has not yet been binned.
+ *
+ * \param[in] hist The histogram.
+ * \return The coordinates and bin counts; the other members are empty.
+ */
+static HistogramData histogram_data(const Histogram &hist)
+{
+	HistogramData ret;
+
+	// the coordinates of the bins, one dimension at a time
+	ret.coordinates.resize(hist.numDimensions());
+	for(std::size_t j = 0; j < ret.coordinates.size(); ++j)
+		ret.coordinates[j] = hist.getBinCoordinates(j);
+
+	// the counts, in one block
+	ret.counts = hist.getBinCounts();
+
+	return ret;
+}
+
+/**
+ * \brief Gets the number of bins in each dimension of a histogram file.
+ *
+ * \param[in] data The histogram.
+ * \return The number of bins in each dimension.
+ */
+static std::vector<std::size_t> bins_per_dimension(const HistogramData &data)
+{
+	std::vector<std::size_t> ret(data.coordinates.size());
+	for(std::size_t j = 0; j < ret.size(); ++j)
+		ret[j] = data.coordinates[j].size();
+	return ret;
+}
+
+/// The size of the blocks used when writing text histograms.
+static constexpr std::size_t text_block{ 1 << 16 };
+
+/**
+ * \brief Formats a histogram as text, one bin per line.
+ *
+ * The numbers are formatted as `%g`, which matches the default formatting
+ * of doubles in an output stream. The text is passed to `sink` in blocks of
+ * (approximately) molstat::text_block characters.
+ *
+ * \param[in] data The coordinates and bin counts of the histogram.
+ * \param[in] sink Function that receives each block of text and its length.
+ */
+static void format_text(const HistogramData &data,
+	const std::function<void(const char*, std::size_t)> &sink)
+{
+	// the extra space holds one more number (at most 13 characters with %g),
+	// its separator, and the terminating null character
+	constexpr std::size_t number_room{ 32 };
+	std::vector<char> buffer(text_block + number_room);
+	std::size_t used{ 0 };
+
+	const auto append = [&](double val, char sep) -> void
+	{
+		if(used >= text_block)
+		{
+			sink(buffer.data(), used);
+			used = 0;
+		}
+
+		used += std::snprintf(&buffer[used], number_room, "%g", val);
+		buffer[used++] = sep;
+	};
+
+	const std::size_t ndim{ data.coordinates.size() };
+	for(CounterIndex ci{ bins_per_dimension(data) }; !ci.at_end(); ++ci)
+	{
+		for(std::size_t j = 0; j < ndim; ++j)
+			append(data.coordinates[j][ci[j]], ' ');
+		append(data.counts[ci.arrayOffset()], '\n');
+	}
+
+	if(used > 0)
+		sink(buffer.data(), used);
+}
+
+HistogramFormat HistogramFormatFromName(const std::string &name)
+{
+	const std::string lname{ to_lower(name) };
+
+	if(lname == "text")
+		return HistogramFormat::Text;
+	else if(lname == "binary")
+		return HistogramFormat::Binary;
+	else if(lname == "gzip")
+	{
+#if HAVE_ZLIB
+		return HistogramFormat::Gzip;
+#else
+		throw std::invalid_argument("The gzip output format is unavailable: " \
+			"MolStat was compiled without zlib.");
+#endif
+	}
+	else if(lname == "hdf5")
+	{
+#if HAVE_HDF5
+		return HistogramFormat::HDF5;
+#else
+		throw std::invalid_argument("The hdf5 output format is unavailable: " \
+			"MolStat was compiled without HDF5.");
+#endif
+	}
+	else if(lname == "mergeable")
+		return HistogramFormat::Mergeable;
+
+	throw std::invalid_argument("Unrecognized output format: \"" + name +
+		"\".\nPossible options are:\n" \
+		"   text - One bin per line (default).\n" \
+		"   binary - Binary header and bin counts.\n" \
+		"   gzip - Text, compressed with gzip.\n" \
+		"   hdf5 - HDF5 file.\n" \
+		"   mergeable - Binary raw counts that can be merged.");
+}
+
+std::string HistogramFormatName(HistogramFormat format)
+{
+	switch(format)
+	{
+	case HistogramFormat::Binary:
+		return "binary";
+	case HistogramFormat::Gzip:
+		return "gzip";
+	case HistogramFormat::HDF5:
+		return "hdf5";
+	case HistogramFormat::Mergeable:
+		return "mergeable";
+	case HistogramFormat::Text:
+	default:
+		return "text";
+	}
+}
+
+void WriteHistogramText(std::ostream &out, const Histogram &hist)
+{
+	WriteHistogramText(out, histogram_data(hist));
+}
+
+void WriteHistogramText(std::ostream &out, const HistogramData &data)
+{
+	format_text(data,
+		[&out](const char *text, std::size_t n) -> void
+		{
+			out.write(text, n);
+		});
+}
+
+void WriteHistogramGzip(std::ostream &out, const Histogram &hist)
+{
+	WriteHistogramGzip(out, histogram_data(hist));
+}
+
+void WriteHistogramGzip(std::ostream &out, const HistogramData &data)
+{
+#if HAVE_ZLIB
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+
+	// a window of 15 bits plus 16 requests the gzip (instead of zlib) wrapper
+	if(deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+		Z_DEFAULT_STRATEGY) != Z_OK)
+		throw std::runtime_error("Unable to initialize gzip compression.");
+
+	std::vector<char> zbuffer(text_block);
+	const auto compress = [&](const char *text, std::size_t n, int flush)
+		-> void
+	{
+		strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text));
+		strm.avail_in = n;
+
+		// deflate until the output buffer is not filled
+		do
+		{
+			strm.next_out = reinterpret_cast<Bytef*>(zbuffer.data());
+			strm.avail_out = zbuffer.size();
+			if(deflate(&strm, flush) == Z_STREAM_ERROR)
+				throw std::runtime_error("Error during gzip compression.");
+			out.write(zbuffer.data(), zbuffer.size() - strm.avail_out);
+		} while(strm.avail_out == 0);
+	};
+
+	try
+	{
+		format_text(data,
+			[&compress](const char *text, std::size_t n) -> void
+			{
+				compress(text, n, Z_NO_FLUSH);
+			});
+		compress(nullptr, 0, Z_FINISH);
+	}
+	catch(...)
+	{
+		deflateEnd(&strm);
+		throw;
+	}
+
+	deflateEnd(&strm);
+#else
+	throw std::runtime_error("The gzip output format is unavailable: " \
+		"MolStat was compiled without zlib.");
+#endif
+}
+
+HistogramData MakeHistogramData(const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, std::size_t nbinned)
+{
+	HistogramData data{ histogram_data(hist) };
+	const std::size_t ndim{ data.coordinates.size() };
+	if(ndim != binstyles.size())
+		throw std::invalid_argument("Incorrect number of binning styles.");
+
+	data.ntrials = ntrials;
+	data.nbinned = nbinned;
+	data.styles.resize(ndim);
+	data.bounds.resize(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		const std::array<double, 2> masked{ hist.getMaskedBounds(j) };
+		data.bounds[j] = {{ binstyles[j]->invmask(masked[0]),
+			binstyles[j]->invmask(masked[1]) }};
+		data.styles[j] = binstyles[j]->info();
+	}
+
+	return data;
+}
+
+void WriteHistogramBinary(std::ostream &out, const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, std::size_t nbinned)
+{
+	WriteHistogramBinary(out,
+		MakeHistogramData(hist, binstyles, ntrials, nbinned));
+}
+
+void WriteHistogramBinary(std::ostream &out, const HistogramData &data)
+{
+	const std::size_t ndim{ data.coordinates.size() };
+
+	out.write(binary_magic, sizeof(binary_magic));
+	WriteBinaryUInt(out, binary_version);
+	WriteBinaryUInt(out, ndim);
+	WriteBinaryUInt(out, data.ntrials);
+	WriteBinaryUInt(out, data.nbinned);
+
+	// the bins in each dimension
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		WriteBinaryUInt(out, data.coordinates[j].size());
+		write_doubles(out, data.bounds[j].data(), 2);
+		WriteBinaryUInt(out, data.styles[j].size());
+		out.write(data.styles[j].data(), data.styles[j].size());
+	}
+
+	// the coordinates of the bins, one dimension at a time
+	for(std::size_t j = 0; j < ndim; ++j)
+		write_doubles(out, data.coordinates[j].data(),
+			data.coordinates[j].size());
+
+	// the counts, in one block
+	write_doubles(out, data.counts.data(), data.counts.size());
+}
+
+MergeableHistogram MakeMergeableHistogram(const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, std::size_t nbinned)
+{
+	MergeableHistogram ret;
+
+	const std::size_t ndim{ binstyles.size() };
+	if(ndim != hist.numDimensions())
+		throw std::invalid_argument("Incorrect number of binning styles.");
+
+	ret.ntrials = ntrials;
+	ret.nbinned = nbinned;
+	ret.nout = hist.numOutOfRange();
+
+	ret.styles.resize(ndim);
+	ret.masked_bounds.resize(ndim);
+	ret.bounds.resize(ndim);
+	ret.out_of_range.resize(ndim);
+	ret.coordinates.resize(ndim);
+	ret.weights.resize(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		ret.styles[j] = binstyles[j]->info();
+		ret.masked_bounds[j] = hist.getMaskedBounds(j);
+		ret.bounds[j] = {{ binstyles[j]->invmask(ret.masked_bounds[j][0]),
+			binstyles[j]->invmask(ret.masked_bounds[j][1]) }};
+		ret.out_of_range[j] = {{ hist.numUnderflow(j), hist.numOverflow(j) }};
+
+		ret.coordinates[j] = hist.getBinCoordinates(j);
+		ret.weights[j] = hist.getBinWeights(j);
+	}
+
+	ret.counts = hist.getRawBinSums();
+
+	return ret;
+}
+
+void MergeHistograms(MergeableHistogram &sum, const MergeableHistogram &other)
+{
+	const std::size_t ndim{ sum.coordinates.size() };
+	if(other.coordinates.size() != ndim)
+		throw std::invalid_argument("The histograms have different " \
+			"dimensionalities.");
+
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		if(other.coordinates[j].size() != sum.coordinates[j].size() ||
+			other.styles[j] != sum.styles[j])
+			throw std::invalid_argument("The histograms have different " \
+				"binning styles in dimension " + std::to_string(j) + ".");
+
+		// the bounds must be identical for the bins to be identical
+		if(other.masked_bounds[j] != sum.masked_bounds[j])
+			throw std::invalid_argument("The histograms have different " \
+				"bounds in dimension " + std::to_string(j) + "; use fixed " \
+				"bounds so that every run has the same bins.");
+	}
+
+	sum.ntrials += other.ntrials;
+	sum.nbinned += other.nbinned;
+	sum.nout += other.nout;
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		sum.out_of_range[j][0] += other.out_of_range[j][0];
+		sum.out_of_range[j][1] += other.out_of_range[j][1];
+	}
+	for(std::size_t k = 0; k < sum.counts.size(); ++k)
+		sum.counts[k] += other.counts[k];
+}
+
+HistogramData WeightMergeableHistogram(const MergeableHistogram &merged)
+{
+	HistogramData ret;
+	ret.ntrials = merged.ntrials;
+	ret.nbinned = merged.nbinned;
+	ret.styles = merged.styles;
+	ret.bounds = merged.bounds;
+	ret.coordinates = merged.coordinates;
+	ret.counts = merged.counts;
+
+	// the weights are applied as in Histogram::getBinCounts
+	ApplyBinWeights(ret.counts, merged.weights);
+
+	return ret;
+}
+
+void WriteHistogramMergeable(std::ostream &out,
+	const MergeableHistogram &merged)
+{
+	const std::size_t ndim{ merged.coordinates.size() };
+
+	out.write(mergeable_magic, sizeof(mergeable_magic));
+	WriteBinaryUInt(out, mergeable_version);
+	WriteBinaryUInt(out, ndim);
+	WriteBinaryUInt(out, merged.ntrials);
+	WriteBinaryUInt(out, merged.nbinned);
+	WriteBinaryUInt(out, merged.nout);
+
+	// the bins in each dimension
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		WriteBinaryUInt(out, merged.coordinates[j].size());
+		write_doubles(out, merged.masked_bounds[j].data(), 2);
+		write_doubles(out, merged.bounds[j].data(), 2);
+		WriteBinaryUInt(out, merged.out_of_range[j][0]);
+		WriteBinaryUInt(out, merged.out_of_range[j][1]);
+		WriteBinaryUInt(out, merged.styles[j].size());
+		out.write(merged.styles[j].data(), merged.styles[j].size());
+	}
+
+	// the coordinates and weights of the bins, one dimension at a time
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		write_doubles(out, merged.coordinates[j].data(),
+			merged.coordinates[j].size());
+		write_doubles(out, merged.weights[j].data(), merged.weights[j].size());
+	}
+
+	// the raw counts, in one block
+	write_doubles(out, merged.counts.data(), merged.counts.size());
+}
+
+bool IsBinaryHistogram(std::istream &in)
+{
+	// text data begins with a number, a comment, or whitespace, so the first
+	// character suffices (and the stream need not be seekable)
+	return in.peek() == binary_magic[0];
+}
+
+/**
+ * \brief Reads a mergeable histogram, after its magic characters.
+ *
+ * \throw std::runtime_error if the stream does not contain a (complete)
+ *    mergeable histogram.
+ *
+ * \param[in,out] in The input stream.
+ * \return The contents of the histogram file.
+ */
+static MergeableHistogram read_mergeable(std::istream &in)
+{
+	MergeableHistogram ret;
+
+	read_version(in, mergeable_version);
+	const std::uint64_t ndim{ ReadBinaryUInt(in, histogram_source) };
+	ret.ntrials = ReadBinaryUInt(in, histogram_source);
+	ret.nbinned = ReadBinaryUInt(in, histogram_source);
+	ret.nout = ReadBinaryUInt(in, histogram_source);
+
+	std::vector<std::size_t> nbins(ndim);
+	ret.styles.resize(ndim);
+	ret.masked_bounds.resize(ndim);
+	ret.bounds.resize(ndim);
+	ret.out_of_range.resize(ndim);
+	std::size_t total_bins{ 1 };
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		nbins[j] = ReadBinaryUInt(in, histogram_source);
+		ReadBinaryBytes(in, ret.masked_bounds[j].data(), 2 * sizeof(double),
+			histogram_source);
+		ReadBinaryBytes(in, ret.bounds[j].data(), 2 * sizeof(double),
+			histogram_source);
+		ret.out_of_range[j][0] = ReadBinaryUInt(in, histogram_source);
+		ret.out_of_range[j][1] = ReadBinaryUInt(in, histogram_source);
+
+		const std::uint64_t len{ ReadBinaryUInt(in, histogram_source) };
+		ret.styles[j].resize(len);
+		if(len > 0)
+			ReadBinaryBytes(in, &ret.styles[j][0], len, histogram_source);
+
+		total_bins *= nbins[j];
+	}
+
+	ret.coordinates.resize(ndim);
+	ret.weights.resize(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		ret.coordinates[j].resize(nbins[j]);
+		ReadBinaryBytes(in, ret.coordinates[j].data(),
+			nbins[j] * sizeof(double), histogram_source);
+		ret.weights[j].resize(nbins[j]);
+		ReadBinaryBytes(in, ret.weights[j].data(), nbins[j] * sizeof(double),
+			histogram_source);
+	}
+
+	ret.counts.resize(total_bins);
+	ReadBinaryBytes(in, ret.counts.data(), total_bins * sizeof(double),
+		histogram_source);
+
+	return ret;
+}
+
+HistogramData ReadHistogramBinary(std::istream &in,
+	std::vector<double> *weights)
+{
+	HistogramData ret;
+
+	char magic[sizeof(binary_magic)];
+	ReadBinaryBytes(in, magic, sizeof(magic), histogram_source);
+	if(std::memcmp(magic, mergeable_magic, sizeof(magic)) == 0)
+	{
+		const MergeableHistogram merged{ read_mergeable(in) };
+		if(weights != nullptr)
+		{
+			weights->assign(merged.counts.size(), 1.);
+			ApplyBinWeights(*weights, merged.weights);
+		}
+		return WeightMergeableHistogram(merged);
+	}
+	if(std::memcmp(magic, binary_magic, sizeof(magic)) != 0)
+		throw std::runtime_error("Not a binary histogram file.");
+
+	read_version(in, binary_version);
+	const std::uint64_t ndim{ ReadBinaryUInt(in, histogram_source) };
+	ret.ntrials = ReadBinaryUInt(in, histogram_source);
+	ret.nbinned = ReadBinaryUInt(in, histogram_source);
+
+	std::vector<std::size_t> nbins(ndim);
+	ret.styles.resize(ndim);
+	ret.bounds.resize(ndim);
+	std::size_t total_bins{ 1 };
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		nbins[j] = ReadBinaryUInt(in, histogram_source);
+		ReadBinaryBytes(in, ret.bounds[j].data(), 2 * sizeof(double),
+			histogram_source);
+
+		const std::uint64_t len{ ReadBinaryUInt(in, histogram_source) };
+		ret.styles[j].resize(len);
+		if(len > 0)
+			ReadBinaryBytes(in, &ret.styles[j][0], len, histogram_source);
+
+		total_bins *= nbins[j];
+	}
+
+	ret.coordinates.resize(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		ret.coordinates[j].resize(nbins[j]);
+		ReadBinaryBytes(in, ret.coordinates[j].data(),
+			nbins[j] * sizeof(double), histogram_source);
+	}
+
+	ret.counts.resize(total_bins);
+	ReadBinaryBytes(in, ret.counts.data(), total_bins * sizeof(double),
+		histogram_source);
+
+	if(weights != nullptr)
+		weights->assign(total_bins, 1.);
+
+	return ret;
+}
+
+MergeableHistogram ReadHistogramMergeable(std::istream &in)
+{
+	char magic[sizeof(mergeable_magic)];
+	ReadBinaryBytes(in, magic, sizeof(magic), histogram_source);
+	if(std::memcmp(magic, mergeable_magic, sizeof(magic)) != 0)
+		throw std::runtime_error("Not a mergeable histogram file.");
+
+	return read_mergeable(in);
+}
+
+} // namespace molstat
@@ -0,0 +1,391 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_io.h
+ * \brief Writing and reading histograms.
+ *
+ * Histograms are written in one of five formats.
+ * -# Text (the default): one bin per line, the coordinates of the bin
+ *    followed by the bin count.
+ * -# Gzip: the text format, compressed with gzip (for archiving). This
+ *    format requires zlib.
+ * -# Binary: a short header followed by the contiguous array of bin counts.
+ *    All numbers are in the byte order of the machine that wrote the file
+ *    (little-endian on all common platforms). The file is
+ *    - 8 characters, `MOLSTATH`.
+ *    - 8-byte unsigned integers: the format version (1), the number of
+ *      dimensions (`ndim`), the number of trials, and the number of trials
+ *      that were binned.
+ *    - For each dimension: the number of bins (8-byte unsigned integer);
+ *      the lower and upper bounds of the bins (doubles); and the length
+ *      (8-byte unsigned integer) and characters of the binning style's
+ *      description (molstat::BinStyle::info).
+ *    - For each dimension: the coordinates of the bins (doubles).
+ *    - The bin counts (doubles), with the first dimension changing the
+ *      fastest (as in molstat::CounterIndex::arrayOffset).
+ * -# HDF5: the dataset `/histogram/counts` holds the bin counts. Its axes
+ *    are the dimensions of the histogram in reverse order (so that the
+ *    first dimension changes the fastest; Matlab's `h5read` restores the
+ *    original order). The dataset is chunked and, when available,
+ *    compressed. Its attributes are `ntrials` and `nbinned` (the numbers of
+ *    trials and binned trials) and, for each dimension `j` of the histogram,
+ *    `edges_j` (the `nbins+1` bin edges), `coordinates_j` (the coordinates
+ *    of the bins), and `style_j` (the binning style's description). This
+ *    format requires HDF5.
+ * -# Mergeable: a binary format that stores everything needed to combine
+ *    histograms from independent runs (e.g., shards of a distributed
+ *    simulation) exactly. The bin counts are raw (unweighted), so that they
+ *    can be summed, and the weights are stored separately. The byte order
+ *    is that of the machine that wrote the file. The file is
+ *    - 8 characters, `MOLSTATM`.
+ *    - 8-byte unsigned integers: the format version (1), the number of
+ *      dimensions (`ndim`), the number of trials, the number of trials that
+ *      were binned, and the number of trials outside the bounds.
+ *    - For each dimension: the number of bins (8-byte unsigned integer);
+ *      the lower and upper bounds of the bins in masked coordinates and in
+ *      unmasked coordinates (doubles); the numbers of underflows and
+ *      overflows (8-byte unsigned integers); and the length (8-byte unsigned
+ *      integer) and characters of the binning style's description.
+ *    - For each dimension: the coordinates of the bins and the weight
+ *      (molstat::BinStyle::dmaskdx) of each bin (doubles).
+ *    - The raw bin counts (doubles), with the first dimension changing the
+ *      fastest.
+ *
+ * Two mergeable histograms can be combined if they have the same binning
+ * styles and the same bounds, which requires fixed bounds (see
+ * molstat::BinStyle::setBounds) unless the runs happen to find identical
+ * extremes. The sum of mergeable histograms is itself mergeable, so shards
+ * can be combined in any order or grouping (e.g., a tree reduction).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __histogram_io_h__
+#define __histogram_io_h__
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace molstat {
+
+// forward declarations
+class BinStyle;
+class Histogram;
+
+/// The formats for writing histograms.
+enum class HistogramFormat
+{
+	/// Text, one bin per line; the default.
+	Text,
+
+	/// The binary format.
+	Binary,
+
+	/// Text, compressed with gzip.
+	Gzip,
+
+	/// HDF5.
+	HDF5,
+
+	/// The mergeable (binary) format.
+	Mergeable
+};
+
+/**
+ * \brief Gets the histogram format from its name.
+ *
+ * Names are case insensitive: `text`, `binary`, `gzip`, `hdf5`, and
+ * `mergeable`.
+ *
+ * \throw std::invalid_argument if the name is not recognized, or if the
+ *    format is not available in this build.
+ *
+ * \param[in] name The name of the format.
+ * \return The format.
+ */
+HistogramFormat HistogramFormatFromName(const std::string &name);
+
+/**
+ * \brief Gets the name of a histogram format.
+ *
+ * \param[in] format The format.
+ * \return The name of the format.
+ */
+std::string HistogramFormatName(HistogramFormat format);
+
+/**
+ * \brief The contents of a binary histogram file.
+ */
+struct HistogramData
+{
+	/// The number of trials.
+	std::size_t ntrials{ 0 };
+
+	/// The number of trials that were binned.
+	std::size_t nbinned{ 0 };
+
+	/// The description of the binning style of each dimension.
+	std::vector<std::string> styles;
+
+	/// The lower and upper bounds of the bins in each dimension.
+	std::vector<std::array<double, 2>> bounds;
+
+	/// The coordinates of the bins in each dimension.
+	std::vector<std::vector<double>> coordinates;
+
+	/// The bin counts, with the first dimension changing the fastest.
+	std::vector<double> counts;
+};
+
+/**
+ * \brief The contents of a mergeable histogram file.
+ */
+struct MergeableHistogram
+{
+	/// The number of trials.
+	std::size_t ntrials{ 0 };
+
+	/// The number of trials that were binned.
+	std::size_t nbinned{ 0 };
+
+	/// The number of trials outside the bounds.
+	std::size_t nout{ 0 };
+
+	/// The description of the binning style of each dimension.
+	std::vector<std::string> styles;
+
+	/// The lower and upper bounds of the bins in each dimension, in masked
+	/// coordinates.
+	std::vector<std::array<double, 2>> masked_bounds;
+
+	/// The lower and upper bounds of the bins in each dimension.
+	std::vector<std::array<double, 2>> bounds;
+
+	/// The numbers of underflows and overflows in each dimension.
+	std::vector<std::array<std::size_t, 2>> out_of_range;
+
+	/// The coordinates of the bins in each dimension.
+	std::vector<std::vector<double>> coordinates;
+
+	/// The weight of each bin (molstat::BinStyle::dmaskdx) in each dimension.
+	std::vector<std::vector<double>> weights;
+
+	/// The raw bin counts, with the first dimension changing the fastest.
+	std::vector<double> counts;
+};
+
+/**
+ * \brief Writes a histogram as text, one bin per line.
+ *
+ * The text is formatted into large blocks before being written, so that
+ * writing a large histogram does not require a write (or flush) per bin.
+ *
+ * \throw std::runtime_error if the data has not yet been binned.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] hist The histogram.
+ */
+void WriteHistogramText(std::ostream &out, const Histogram &hist);
+
+/**
+ * \brief Writes the contents of a histogram file as text, one bin per line.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] data The histogram.
+ */
+void WriteHistogramText(std::ostream &out, const HistogramData &data);
+
+/**
+ * \brief Writes a histogram as gzip-compressed text.
+ *
+ * The uncompressed text is identical to that of WriteHistogramText. The
+ * output stream should be opened in binary mode.
+ *
+ * \throw std::runtime_error if the data has not yet been binned, if
+ *    compression fails, or if MolStat was compiled without zlib.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] hist The histogram.
+ */
+void WriteHistogramGzip(std::ostream &out, const Histogram &hist);
+
+/**
+ * \brief Writes the contents of a histogram file as gzip-compressed text.
+ *
+ * \throw std::runtime_error if compression fails or if MolStat was compiled
+ *    without zlib.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] data The histogram.
+ */
+void WriteHistogramGzip(std::ostream &out, const HistogramData &data);
+
+/**
+ * \brief Writes a histogram in the binary format.
+ *
+ * The output stream should be opened in binary mode.
+ *
+ * \throw std::runtime_error if the data has not yet been binned.
+ * \throw std::invalid_argument if the number of binning styles does not
+ *    match the dimensionality of the histogram.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] hist The histogram.
+ * \param[in] binstyles The binning style of each dimension.
+ * \param[in] ntrials The number of trials.
+ * \param[in] nbinned The number of trials that were binned.
+ */
+void WriteHistogramBinary(std::ostream &out, const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, std::size_t nbinned);
+
+/**
+ * \brief Collects the contents of a (binary) histogram file.
+ *
+ * \throw std::runtime_error if the data has not yet been binned.
+ * \throw std::invalid_argument if the number of binning styles does not
+ *    match the dimensionality of the histogram.
+ *
+ * \param[in] hist The histogram.
+ * \param[in] binstyles The binning style of each dimension.
+ * \param[in] ntrials The number of trials.
+ * \param[in] nbinned The number of trials that were binned.
+ * \return The histogram, with weighted bin counts.
+ */
+HistogramData MakeHistogramData(const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, std::size_t nbinned);
+
+/**
+ * \brief Writes the contents of a histogram file in the binary format.
+ *
+ * \param[in,out] out The output stream, opened in binary mode.
+ * \param[in] data The histogram.
+ */
+void WriteHistogramBinary(std::ostream &out, const HistogramData &data);
+
+/**
+ * \brief Collects the contents of a mergeable histogram file.
+ *
+ * \throw std::runtime_error if the data has not yet been binned.
+ * \throw std::invalid_argument if the number of binning styles does not
+ *    match the dimensionality of the histogram.
+ *
+ * \param[in] hist The histogram.
+ * \param[in] binstyles The binning style of each dimension.
+ * \param[in] ntrials The number of trials.
+ * \param[in] nbinned The number of trials that were binned.
+ * \return The mergeable histogram.
+ */
+MergeableHistogram MakeMergeableHistogram(const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, std::size_t nbinned);
+
+/**
+ * \brief Adds one mergeable histogram to another.
+ *
+ * The bin counts and the numbers of trials, binned trials, and trials
+ * outside the bounds are summed.
+ *
+ * \throw std::invalid_argument if the histograms have different bins
+ *    (dimensionality, binning styles, or bounds).
+ *
+ * \param[in,out] sum The histogram that is added to.
+ * \param[in] other The histogram to add.
+ */
+void MergeHistograms(MergeableHistogram &sum, const MergeableHistogram &other);
+
+/**
+ * \brief Applies the weights of a mergeable histogram to get the contents
+ *    of a (binary) histogram file.
+ *
+ * The result matches what molstat::WriteHistogramBinary writes for the
+ * equivalent molstat::Histogram.
+ *
+ * \param[in] merged The mergeable histogram.
+ * \return The histogram, with weighted bin counts.
+ */
+HistogramData WeightMergeableHistogram(const MergeableHistogram &merged);
+
+/**
+ * \brief Writes a mergeable histogram.
+ *
+ * \param[in,out] out The output stream, opened in binary mode.
+ * \param[in] merged The mergeable histogram.
+ */
+void WriteHistogramMergeable(std::ostream &out,
+	const MergeableHistogram &merged);
+
+/**
+ * \brief Writes a histogram to an HDF5 file.
+ *
+ * Any existing file is replaced.
+ *
+ * \throw std::runtime_error if the data has not yet been binned, if the
+ *    file cannot be written, or if MolStat was compiled without HDF5.
+ * \throw std::invalid_argument if the number of binning styles does not
+ *    match the dimensionality of the histogram.
+ *
+ * \param[in] filename The name of the output file.
+ * \param[in] hist The histogram.
+ * \param[in] binstyles The binning style of each dimension.
+ * \param[in] ntrials The number of trials.
+ * \param[in] nbinned The number of trials that were binned.
+ */
+void WriteHistogramHDF5(const std::string &filename, const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, std::size_t nbinned);
+
+/**
+ * \brief Determines if a stream contains a binary (or mergeable) histogram.
+ *
+ * Only the first character is examined (and not extracted); the rest of
+ * the header is checked by ReadHistogramBinary.
+ *
+ * \param[in,out] in The input stream.
+ * \return True if the stream appears to begin with the binary or mergeable
+ *    histogram header.
+ */
+bool IsBinaryHistogram(std::istream &in);
+
+/**
+ * \brief Reads a histogram in the binary format.
+ *
+ * Mergeable histograms are also accepted; their weights are applied (see
+ * WeightMergeableHistogram).
+ *
+ * \throw std::runtime_error if the stream does not contain a (complete)
+ *    binary or mergeable histogram.
+ *
+ * \param[in,out] in The input stream, opened in binary mode.
+ * \param[out] weights If not nullptr, the weight applied to the raw count of
+ *    each bin (ordered as the counts), so that the raw counts of a mergeable
+ *    histogram can be recovered. The counts of the binary format are taken
+ *    to be raw (each weight is 1).
+ * \return The contents of the histogram file.
+ */
+HistogramData ReadHistogramBinary(std::istream &in,
+	std::vector<double> *weights = nullptr);
+
+/**
+ * \brief Reads a histogram in the mergeable format.
+ *
+ * \throw std::runtime_error if the stream does not contain a (complete)
+ *    mergeable histogram.
+ *
+ * \param[in,out] in The input stream, opened in binary mode.
+ * \return The contents of the histogram file.
+ */
+MergeableHistogram ReadHistogramMergeable(std::istream &in);
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,250 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file kernel_density.cc
+ * \brief Kernel density estimates from binned data.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "kernel_density.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+
+namespace molstat
+{
+
+/// Complex numbers for the Fourier transforms.
+using complex_t = std::complex<double>;
+
+/**
+ * \brief Calculates the twiddle factors for fast Fourier transforms of a
+ *    given length.
+ *
+ * \param[in] m The length, a power of 2.
+ * \return The factors \f$e^{-2\pi i k/m}\f$ for \f$0 \le k < m/2\f$.
+ */
+static std::vector<complex_t> twiddle_factors(const std::size_t m)
+{
+	const double pi{ std::acos(-1.) };
+	std::vector<complex_t> ret(m / 2);
+
+	for(std::size_t k = 0; k < ret.size(); ++k)
+		ret[k] = std::polar(1., -2. * pi * k / m);
+
+	return ret;
+}
+
+/**
+ * \brief In-place (radix-2) fast Fourier transform.
+ *
+ * The inverse transform is not scaled by \f$1/m\f$.
+ *
+ * \param[in,out] a The values to transform; the length must be a power of 2.
+ * \param[in] twiddles The twiddle factors for this length.
+ * \param[in] inverse True for the inverse transform.
+ */
+static void fft(std::vector<complex_t> &a,
+	const std::vector<complex_t> &twiddles, const bool inverse)
+{
+	const std::size_t m{ a.size() };
+
+	// bit-reversed order
+	for(std::size_t i = 1, j = 0; i < m; ++i)
+	{
+		std::size_t bit{ m >> 1 };
+		for(; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+
+		if(i < j)
+			std::swap(a[i], a[j]);
+	}
+
+	// butterflies
+	for(std::size_t len = 2; len <= m; len <<= 1)
+	{
+		const std::size_t half{ len / 2 }, step{ m / len };
+		for(std::size_t start = 0; start < m; start += len)
+		{
+			for(std::size_t k = 0; k < half; ++k)
+			{
+				const complex_t w{ inverse ? std::conj(twiddles[k * step]) :
+					twiddles[k * step] };
+				const complex_t t{ w * a[start + k + half] };
+				a[start + k + half] = a[start + k] - t;
+				a[start + k] += t;
+			}
+		}
+	}
+}
+
+/**
+ * \brief Convolves the counts with a kernel along one dimension.
+ *
+ * Each line of bins along the dimension is zero-padded, so that the
+ * (circular) convolution of the transforms does not wrap around.
+ *
+ * \param[in,out] counts The bin counts, with the first dimension changing
+ *    the fastest.
+ * \param[in] n The number of bins in the dimension.
+ * \param[in] stride The distance between consecutive bins in the dimension
+ *    (the product of the numbers of bins in the earlier dimensions).
+ * \param[in] kernel The kernel, at offsets \f$-R, \ldots, R\f$ (in bins)
+ *    from the center.
+ */
+static void convolve_dimension(std::vector<double> &counts,
+	const std::size_t n, const std::size_t stride,
+	const std::vector<double> &kernel)
+{
+	const std::size_t radius{ kernel.size() / 2 };
+
+	std::size_t m{ 1 };
+	while(m < n + radius)
+		m <<= 1;
+	const std::vector<complex_t> twiddles{ twiddle_factors(m) };
+
+	// the transform of the kernel, with negative offsets wrapped around and
+	// the 1/m of the inverse transform
+	std::vector<complex_t> kernel_ft(m, 0.);
+	for(std::size_t r = 0; r < kernel.size(); ++r)
+		kernel_ft[(r + m - radius) % m] = kernel[r] / m;
+	fft(kernel_ft, twiddles, false);
+
+	std::vector<complex_t> line(m);
+	const std::size_t block{ n * stride };
+	for(std::size_t first = 0; first < counts.size(); first += block)
+	{
+		for(std::size_t offset = first; offset < first + stride; ++offset)
+		{
+			for(std::size_t i = 0; i < n; ++i)
+				line[i] = counts[offset + i * stride];
+			std::fill(line.begin() + n, line.end(), 0.);
+
+			fft(line, twiddles, false);
+			for(std::size_t i = 0; i < m; ++i)
+				line[i] *= kernel_ft[i];
+			fft(line, twiddles, true);
+
+			// the counts are not negative; remove roundoff below 0
+			for(std::size_t i = 0; i < n; ++i)
+				counts[offset + i * stride] = std::max(line[i].real(), 0.);
+		}
+	}
+}
+
+std::vector<double> KernelDensityBandwidths(const Histogram &hist)
+{
+	const std::size_t ndim{ hist.numDimensions() };
+	const std::vector<double> counts{ hist.getRawBinSums() };
+
+	// the counts in each bin of each dimension
+	std::vector<std::vector<double>> marginals(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+		marginals[j].assign(hist.numBins(j), 0.);
+
+	double total{ 0. };
+	for(std::size_t i = 0; i < counts.size(); ++i)
+	{
+		if(counts[i] == 0.)
+			continue;
+
+		total += counts[i];
+		std::size_t rest{ i };
+		for(std::size_t j = 0; j < ndim; ++j)
+		{
+			marginals[j][rest % marginals[j].size()] += counts[i];
+			rest /= marginals[j].size();
+		}
+	}
+
+	std::vector<double> ret(ndim, 0.);
+	if(total < 2.)
+		return ret;
+
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		// the mean and variance of the bin centers, in masked coordinates
+		const std::array<double, 2> bounds{ hist.getMaskedBounds(j) };
+		const double width{ (bounds[1] - bounds[0]) / marginals[j].size() };
+
+		double mean{ 0. }, var{ 0. };
+		for(std::size_t k = 0; k < marginals[j].size(); ++k)
+			mean += marginals[j][k] * (k + 0.5);
+		mean /= total;
+		for(std::size_t k = 0; k < marginals[j].size(); ++k)
+			var += marginals[j][k] * (k + 0.5 - mean) * (k + 0.5 - mean);
+		var /= total - 1.;
+
+		ret[j] = 1.06 * std::sqrt(var) * width * std::pow(total, -0.2);
+	}
+
+	return ret;
+}
+
+std::vector<double> KernelDensityCounts(const Histogram &hist,
+	const std::vector<double> &bandwidths)
+{
+	const std::size_t ndim{ hist.numDimensions() };
+	if(bandwidths.size() != ndim)
+		throw std::invalid_argument("Incorrect number of bandwidths.");
+	for(const double h : bandwidths)
+		if(!(h >= 0.) || !std::isfinite(h))
+			throw std::invalid_argument("The bandwidths must not be negative.");
+
+	std::vector<double> counts{ hist.getRawBinSums() };
+
+	std::size_t stride{ 1 };
+	std::vector<std::vector<double>> weights(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		const std::size_t n{ hist.numBins(j) };
+		const std::array<double, 2> bounds{ hist.getMaskedBounds(j) };
+		const double sigma{ bandwidths[j] * n / (bounds[1] - bounds[0]) };
+
+		weights[j] = hist.getBinWeights(j);
+
+		// the Gaussian (in units of bins), sampled to 8 standard deviations
+		// (offsets beyond the histogram do not contribute) and normalized
+		if(sigma > 0.)
+		{
+			const double full{ std::ceil(8. * sigma) };
+			const std::size_t radius{ full < n ?
+				static_cast<std::size_t>(full) : n - 1 };
+
+			// the sum of all of the samples (not only those to 8 standard
+			// deviations) is sigma sqrt(2 pi), to roundoff, for wide kernels;
+			// for narrow kernels, the samples beyond 20 bins are negligible
+			double sum{ 1. };
+			if(sigma >= 2.)
+				sum = sigma * std::sqrt(2. * std::acos(-1.));
+			else
+				for(double r = 1.; r <= 20.; r += 1.)
+					sum += 2. * std::exp(-0.5 * r * r / (sigma * sigma));
+
+			std::vector<double> kernel(2 * radius + 1);
+			for(std::size_t r = 0; r < kernel.size(); ++r)
+			{
+				const double z{ (static_cast<double>(r) - radius) / sigma };
+				kernel[r] = std::exp(-0.5 * z * z) / sum;
+			}
+
+			if(kernel.size() > 1)
+				convolve_dimension(counts, n, stride, kernel);
+		}
+
+		stride *= n;
+	}
+
+	ApplyBinWeights(counts, weights);
+	return counts;
+}
+
+} // namespace molstat
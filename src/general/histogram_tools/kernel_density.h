@@ -0,0 +1,77 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file kernel_density.h
+ * \brief Kernel density estimates from binned data.
+ *
+ * A kernel density estimate (KDE) is a smooth estimate of the probability
+ * density function. Instead of summing a kernel over every sample (at every
+ * point where the density is evaluated), the samples are first binned into
+ * fine bins, and the bin counts are then convolved with the kernel using
+ * fast Fourier transforms. The cost is then
+ * \f$\mathcal{O}(N_\mathrm{bins} \log N_\mathrm{bins})\f$, independent of
+ * the number of samples.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __kernel_density_h__
+#define __kernel_density_h__
+
+#include <vector>
+#include "histogram.h"
+
+namespace molstat
+{
+
+/**
+ * \brief Chooses the bandwidth of a Gaussian kernel in each dimension.
+ *
+ * The bandwidths use Silverman's rule of thumb,
+ * \f$h = 1.06 \sigma N^{-1/5}\f$, where \f$\sigma\f$ is the standard
+ * deviation of the (binned) data in a dimension and \f$N\f$ is the number of
+ * binned data. The bandwidths are in masked coordinates (see
+ * molstat::BinStyle), where the bins are uniform.
+ *
+ * \throw std::runtime_error if the data has not yet been binned.
+ *
+ * \param[in] hist The histogram.
+ * \return The bandwidth in each dimension; 0 if the data in a dimension do
+ *    not spread (or there are fewer than two data).
+ */
+std::vector<double> KernelDensityBandwidths(const Histogram &hist);
+
+/**
+ * \brief Estimates the probability density function by smoothing the bin
+ *    counts of a histogram with a Gaussian kernel.
+ *
+ * The (raw) bin counts are convolved, one dimension at a time, with a
+ * Gaussian of the specified bandwidth, sampled at the bin centers. The
+ * convolutions use fast Fourier transforms. The kernel is applied in masked
+ * coordinates; afterward, the bin weights are applied, as in
+ * molstat::Histogram::getBinCounts, so that the result is an estimate of
+ * the same density as the histogram.
+ *
+ * The kernel is not reflected at the bounds, so that the estimate is
+ * smaller near the bounds when there are data near (or beyond) them.
+ *
+ * \throw std::runtime_error if the data has not yet been binned.
+ * \throw std::invalid_argument if the number of bandwidths does not match
+ *    the dimensionality of the histogram or a bandwidth is negative.
+ *
+ * \param[in] hist The histogram.
+ * \param[in] bandwidths The bandwidth in each dimension, in masked
+ *    coordinates; a bandwidth of 0 does not smooth that dimension.
+ * \return The smoothed (weighted) bin counts, with the first dimension
+ *    changing the fastest.
+ */
+std::vector<double> KernelDensityCounts(const Histogram &hist,
+	const std::vector<double> &bandwidths);
+
+} // namespace molstat
+
+#endif
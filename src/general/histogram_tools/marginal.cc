@@ -0,0 +1,134 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file marginal.cc
+ * \brief Marginal histograms (and conditional slices) of a histogram.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "marginal.h"
+#include "bin_style.h"
+#include <stdexcept>
+#include <string>
+
+namespace molstat
+{
+
+void CheckMarginalSpec(const MarginalSpec &spec, std::size_t ndim)
+{
+	if(spec.dimensions.empty())
+		throw std::invalid_argument("A marginal histogram must keep at least " \
+			"one dimension.");
+
+	std::vector<bool> used(ndim, false);
+	for(const std::size_t j : spec.dimensions)
+	{
+		if(j >= ndim)
+			throw std::invalid_argument("Invalid dimension " +
+				std::to_string(j) + " for a marginal histogram of " +
+				std::to_string(ndim) + " dimension(s).");
+		if(used[j])
+			throw std::invalid_argument("Dimension " + std::to_string(j) +
+				" is repeated in a marginal histogram.");
+		used[j] = true;
+	}
+
+	for(const HistogramSlice &slice : spec.slices)
+	{
+		if(slice.dimension >= ndim)
+			throw std::invalid_argument("Invalid dimension " +
+				std::to_string(slice.dimension) + " for a slice of " +
+				std::to_string(ndim) + " dimension(s).");
+		if(used[slice.dimension])
+			throw std::invalid_argument("Dimension " +
+				std::to_string(slice.dimension) + " is kept by the marginal " \
+				"histogram, so it cannot be sliced.");
+		if(!(slice.range[0] <= slice.range[1]))
+			throw std::invalid_argument("The lower value of a slice must not " \
+				"exceed the upper value.");
+	}
+}
+
+HistogramData MarginalHistogramData(const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, const MarginalSpec &spec)
+{
+	const std::size_t ndim{ hist.numDimensions() };
+	if(binstyles.size() != ndim)
+		throw std::invalid_argument("Incorrect number of binning styles.");
+	CheckMarginalSpec(spec, ndim);
+
+	// the bins of each dimension that are included, and the stride of each
+	// kept dimension in the marginal histogram (0 for summed dimensions)
+	std::vector<std::vector<bool>> included(ndim);
+	std::vector<std::size_t> strides(ndim, 0);
+	for(std::size_t j = 0; j < ndim; ++j)
+		included[j].assign(hist.numBins(j), true);
+	for(const HistogramSlice &slice : spec.slices)
+	{
+		const std::vector<double> &coords =
+			hist.getBinCoordinates(slice.dimension);
+		for(std::size_t k = 0; k < coords.size(); ++k)
+			included[slice.dimension][k] = included[slice.dimension][k] &&
+				coords[k] >= slice.range[0] && coords[k] <= slice.range[1];
+	}
+
+	HistogramData ret;
+	ret.ntrials = ntrials;
+	std::size_t size{ 1 };
+	for(const std::size_t j : spec.dimensions)
+	{
+		strides[j] = size;
+		size *= hist.numBins(j);
+
+		const std::array<double, 2> masked{ hist.getMaskedBounds(j) };
+		ret.bounds.push_back({{ binstyles[j]->invmask(masked[0]),
+			binstyles[j]->invmask(masked[1]) }});
+		ret.styles.push_back(binstyles[j]->info());
+		ret.coordinates.push_back(hist.getBinCoordinates(j));
+	}
+
+	// sum the raw counts (or weights) of the included bins
+	const std::vector<std::size_t> counts{ hist.getRawBinCounts() };
+	const std::vector<double> raw{ hist.getRawBinSums() };
+	std::vector<double> sums(size, 0.);
+	for(std::size_t i = 0; i < counts.size(); ++i)
+	{
+		if(counts[i] == 0)
+			continue;
+
+		std::size_t rest{ i }, offset{ 0 };
+		bool inside{ true };
+		for(std::size_t j = 0; j < ndim && inside; ++j)
+		{
+			const std::size_t k{ rest % included[j].size() };
+			rest /= included[j].size();
+
+			inside = included[j][k];
+			offset += k * strides[j];
+		}
+
+		if(inside)
+		{
+			sums[offset] += raw[i];
+			ret.nbinned += counts[i];
+		}
+	}
+
+	// the weights of the kept dimensions
+	std::vector<std::vector<double>> weights;
+	for(const std::size_t j : spec.dimensions)
+		weights.push_back(hist.getBinWeights(j));
+
+	ret.counts.assign(sums.begin(), sums.end());
+	ApplyBinWeights(ret.counts, weights);
+
+	return ret;
+}
+
+} // namespace molstat
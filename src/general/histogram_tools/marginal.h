@@ -0,0 +1,96 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file marginal.h
+ * \brief Marginal histograms (and conditional slices) of a histogram.
+ *
+ * A marginal histogram keeps some of the dimensions of a histogram and sums
+ * the raw bin counts over the others. A conditional slice further restricts
+ * the summed dimensions to ranges of values. Both come from the bin counts
+ * of the full histogram, so that one simulation gives, e.g., the 2D
+ * conductance-displacement histogram and the 1D conductance histogram.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __marginal_h__
+#define __marginal_h__
+
+#include <array>
+#include <memory>
+#include <vector>
+#include "histogram.h"
+#include "histogram_io.h"
+
+namespace molstat
+{
+
+/**
+ * \brief A range of values in one dimension of a histogram.
+ */
+struct HistogramSlice
+{
+	/// The dimension.
+	std::size_t dimension;
+
+	/// The lower and upper values; the bins whose coordinates are in this
+	/// range (inclusive) are kept.
+	std::array<double, 2> range;
+};
+
+/**
+ * \brief The dimensions kept by a marginal histogram, and the ranges to
+ *    which the other dimensions are restricted.
+ */
+struct MarginalSpec
+{
+	/// The dimensions kept, in the order of the marginal histogram.
+	std::vector<std::size_t> dimensions;
+
+	/// The conditions on the dimensions that are summed.
+	std::vector<HistogramSlice> slices;
+};
+
+/**
+ * \brief Checks a marginal histogram against the dimensionality of the
+ *    histogram.
+ *
+ * \throw std::invalid_argument if no dimensions are kept, a dimension is
+ *    invalid or repeated, or a slice is of a kept dimension (or has a lower
+ *    value above its upper value).
+ *
+ * \param[in] spec The marginal histogram.
+ * \param[in] ndim The number of dimensions of the histogram.
+ */
+void CheckMarginalSpec(const MarginalSpec &spec, std::size_t ndim);
+
+/**
+ * \brief Makes a marginal histogram (or conditional slice) of a histogram.
+ *
+ * The raw bin counts are summed over the dimensions that are not kept (only
+ * the bins inside the slices), and the bin weights of the kept dimensions
+ * are then applied, as in molstat::Histogram::getBinCounts.
+ *
+ * \throw std::runtime_error if the data has not yet been binned.
+ * \throw std::invalid_argument if the specification is invalid (see
+ *    CheckMarginalSpec) or the number of binning styles is incorrect.
+ *
+ * \param[in] hist The histogram.
+ * \param[in] binstyles The binning style for each dimension of the
+ *    histogram.
+ * \param[in] ntrials The number of trials.
+ * \param[in] spec The marginal histogram.
+ * \return The marginal histogram; the number of binned trials is that of
+ *    the bins in the slices.
+ */
+HistogramData MarginalHistogramData(const Histogram &hist,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t ntrials, const MarginalSpec &spec);
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,108 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sample_buffer.cc
+ * \brief Provides a contiguous, chunked buffer for storing data samples.
+ *
+ * \author Matthew G.\ Reuter
+ * \date October 2014
+ */
+
+#include "sample_buffer.h"
+
+namespace molstat {
+
+const std::size_t SampleBuffer::default_chunk_size = 16384;
+
+const double *SampleBuffer::Chunk::dimension(std::size_t dim) const
+{
+	return values.data() + dim * capacity;
+}
+
+SampleBuffer::SampleBuffer(std::size_t ndim_, std::size_t chunk_size_)
+	: ndim(ndim_), chunk_size(chunk_size_), nsamples(0), chunks()
+{
+	if(chunk_size == 0)
+		throw std::invalid_argument("The chunk size must be positive.");
+}
+
+void SampleBuffer::push_back(const std::valarray<double> &v)
+{
+	if(v.size() != ndim)
+		throw std::invalid_argument("Data has incorrect dimensionality.");
+
+	push_back(&v[0]);
+}
+
+void SampleBuffer::push_back(const double *v)
+{
+	// start a new chunk, if needed
+	if(chunks.empty() || chunks.back().count == chunks.back().capacity)
+		chunks.push_back(Chunk{ std::vector<double>(ndim * chunk_size),
+			chunk_size, 0 });
+
+	Chunk &chunk = chunks.back();
+	for(std::size_t j = 0; j < ndim; ++j)
+		chunk.values[j * chunk.capacity + chunk.count] = v[j];
+	++chunk.count;
+	++nsamples;
+}
+
+void SampleBuffer::splice(SampleBuffer &other)
+{
+	if(other.ndim != ndim)
+		throw std::invalid_argument("Buffers have different dimensionality.");
+
+	// put the other buffer's chunks in front so that our last chunk (which
+	// may have room) stays last
+	chunks.splice(chunks.begin(), other.chunks);
+	nsamples += other.nsamples;
+	other.nsamples = 0;
+}
+
+void SampleBuffer::clear() noexcept
+{
+	chunks.clear();
+	nsamples = 0;
+}
+
+std::size_t SampleBuffer::size() const noexcept
+{
+	return nsamples;
+}
+
+bool SampleBuffer::empty() const noexcept
+{
+	return nsamples == 0;
+}
+
+std::size_t SampleBuffer::dimensionality() const noexcept
+{
+	return ndim;
+}
+
+std::size_t SampleBuffer::memoryUsage() const noexcept
+{
+	std::size_t ret{ 0 };
+	for(const Chunk &chunk : chunks)
+		ret += sizeof(Chunk) + chunk.values.capacity() * sizeof(double);
+
+	return ret;
+}
+
+std::list<SampleBuffer::Chunk>::const_iterator SampleBuffer::begin() const
+	noexcept
+{
+	return chunks.cbegin();
+}
+
+std::list<SampleBuffer::Chunk>::const_iterator SampleBuffer::end() const
+	noexcept
+{
+	return chunks.cend();
+}
+
+} // namespace molstat
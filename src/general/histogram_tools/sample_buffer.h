@@ -0,0 +1,172 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sample_buffer.h
+ * \brief Provides a contiguous, chunked buffer for storing data samples.
+ *
+ * \author Matthew G.\ Reuter
+ * \date October 2014
+ */
+
+#ifndef __sample_buffer_h__
+#define __sample_buffer_h__
+
+#include <vector>
+#include <valarray>
+#include <list>
+#include <stdexcept>
+
+namespace molstat {
+
+/**
+ * \brief Structure-of-arrays buffer for multi-dimensional data samples.
+ *
+ * Samples are stored in chunks. Each chunk holds up to a fixed number of
+ * samples, with the values for each dimension stored contiguously (one
+ * `double` array per dimension). The buffer grows one chunk at a time, so
+ * existing samples are never copied, and a pass over one dimension of a chunk
+ * is a linear scan.
+ *
+ * Chunks other than the last may be partially filled after two buffers are
+ * combined with SampleBuffer::splice().
+ */
+class SampleBuffer
+{
+public:
+	/// The default number of samples per chunk.
+	static const std::size_t default_chunk_size;
+
+	/// A chunk of samples.
+	struct Chunk
+	{
+		/**
+		 * \brief The values, stored dimension by dimension.
+		 *
+		 * The value of dimension `d` for sample `i` is
+		 * `values[d * capacity + i]`.
+		 */
+		std::vector<double> values;
+
+		/// The number of samples this chunk can hold.
+		std::size_t capacity;
+
+		/// The number of samples stored in this chunk.
+		std::size_t count;
+
+		/**
+		 * \brief Gets the (contiguous) values for a dimension.
+		 *
+		 * \param[in] dim The dimension.
+		 * \return Pointer to the first of the `count` values for `dim`.
+		 */
+		const double *dimension(std::size_t dim) const;
+	};
+
+private:
+	/// The dimensionality of each sample.
+	const std::size_t ndim;
+
+	/// The number of samples in each new chunk.
+	const std::size_t chunk_size;
+
+	/// The total number of samples.
+	std::size_t nsamples;
+
+	/// The chunks.
+	std::list<Chunk> chunks;
+
+public:
+	SampleBuffer() = delete;
+
+	/**
+	 * \brief Constructor specifying the dimensionality and chunk size.
+	 *
+	 * \throw std::invalid_argument if the chunk size is 0.
+	 *
+	 * \param[in] ndim_ The dimensionality of the samples.
+	 * \param[in] chunk_size_ The number of samples in each chunk.
+	 */
+	SampleBuffer(std::size_t ndim_,
+		std::size_t chunk_size_ = default_chunk_size);
+
+	/**
+	 * \brief Adds a sample to the buffer.
+	 *
+	 * \throw std::invalid_argument if the sample has the wrong
+	 *    dimensionality.
+	 *
+	 * \param[in] v The sample.
+	 */
+	void push_back(const std::valarray<double> &v);
+
+	/**
+	 * \brief Adds a sample to the buffer.
+	 *
+	 * \param[in] v The sample (`dimensionality()` values).
+	 */
+	void push_back(const double *v);
+
+	/**
+	 * \brief Moves all samples from another buffer into this one.
+	 *
+	 * The chunks of `other` are transferred without copying; `other` is left
+	 * empty.
+	 *
+	 * \throw std::invalid_argument if the dimensionalities differ.
+	 *
+	 * \param[in,out] other The other buffer.
+	 */
+	void splice(SampleBuffer &other);
+
+	/// Removes all samples and releases their memory.
+	void clear() noexcept;
+
+	/**
+	 * \brief Gets the number of samples in the buffer.
+	 *
+	 * \return The number of samples.
+	 */
+	std::size_t size() const noexcept;
+
+	/**
+	 * \brief Determines if the buffer is empty.
+	 *
+	 * \return True if there are no samples.
+	 */
+	bool empty() const noexcept;
+
+	/**
+	 * \brief Gets the dimensionality of the samples.
+	 *
+	 * \return The dimensionality.
+	 */
+	std::size_t dimensionality() const noexcept;
+
+	/**
+	 * \brief Gets the memory allocated for the samples.
+	 *
+	 * \return The memory (bytes) of the chunks.
+	 */
+	std::size_t memoryUsage() const noexcept;
+
+	/**
+	 * \brief Iterator to the first chunk.
+	 *
+	 * \return The iterator.
+	 */
+	std::list<Chunk>::const_iterator begin() const noexcept;
+
+	/**
+	 * \brief Iterator past the last chunk.
+	 *
+	 * \return The iterator.
+	 */
+	std::list<Chunk>::const_iterator end() const noexcept;
+};
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,435 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sample_file.cc
+ * \brief Implementation of writing, reading, and binning raw samples.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "sample_file.h"
+#include "bin_style.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <general/binary_io.h>
+
+namespace molstat {
+
+/// The characters at the beginning of a raw sample file.
+static const char sample_magic[8]{ 'M', 'O', 'L', 'S', 'T', 'A', 'T', 'S' };
+
+/// The version of the raw sample file format.
+static constexpr std::uint64_t sample_version{ 1 };
+
+/// What the header's stream holds, for the error messages.
+static const char header_source[]{ "the sample file header" };
+
+const std::size_t SampleWriter::default_buffer_size = 65536;
+
+SampleFileHeader ReadSampleFileHeader(std::istream &in)
+{
+	SampleFileHeader ret;
+
+	char magic[sizeof(sample_magic)];
+	in.read(magic, sizeof(magic));
+	if(static_cast<std::size_t>(in.gcount()) != sizeof(magic) ||
+		std::memcmp(magic, sample_magic, sizeof(magic)) != 0)
+		throw std::runtime_error("Not a raw sample file.");
+
+	if(ReadBinaryUInt(in, header_source) != sample_version)
+		throw std::runtime_error("Unsupported version of the raw sample " \
+			"format (possibly written on a machine with a different byte " \
+			"order).");
+
+	ret.ndim = ReadBinaryUInt(in, header_source);
+	ret.nparams = ReadBinaryUInt(in, header_source);
+	ret.size = sizeof(magic) + 3 * sizeof(std::uint64_t);
+
+	ret.names.resize(ret.ndim + ret.nparams);
+	for(std::string &name : ret.names)
+	{
+		const std::uint64_t len{ ReadBinaryUInt(in, header_source) };
+		name.resize(len);
+		if(len > 0)
+			ReadBinaryBytes(in, &name[0], len, header_source);
+		ret.size += sizeof(std::uint64_t) + len;
+	}
+
+	// skip the padding
+	const std::size_t padding{ (8 - ret.size % 8) % 8 };
+	in.ignore(padding);
+	if(static_cast<std::size_t>(in.gcount()) != padding)
+		throw std::runtime_error("Unexpected end of the sample file header.");
+	ret.size += padding;
+
+	return ret;
+}
+
+SampleFileReader::SampleFileReader(const std::string &filename)
+{
+	// read the header with a stream
+	{
+		std::ifstream in(filename, std::ios_base::binary);
+		if(!in)
+			throw std::runtime_error("Unable to open " + filename + ".");
+		head = ReadSampleFileHeader(in);
+	}
+
+	const int fd{ ::open(filename.c_str(), O_RDONLY) };
+	if(fd < 0)
+		throw std::runtime_error("Unable to open " + filename + ".");
+
+	struct stat info;
+	if(::fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error("Unable to determine the size of " +
+			filename + ".");
+	}
+	length = info.st_size;
+
+	const std::size_t row_bytes{ rowLength() * sizeof(double) };
+	if(length < head.size || (length - head.size) % row_bytes != 0)
+	{
+		::close(fd);
+		throw std::runtime_error(filename + " does not contain a whole " \
+			"number of samples.");
+	}
+	nsamples = (length - head.size) / row_bytes;
+
+	mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd); // the mapping remains valid
+	if(mapping == MAP_FAILED)
+	{
+		mapping = nullptr;
+		throw std::runtime_error("Unable to map " + filename + ".");
+	}
+
+	// the samples are (mostly) read once, in order
+	::madvise(mapping, length, MADV_SEQUENTIAL);
+}
+
+SampleFileReader::~SampleFileReader()
+{
+	if(mapping != nullptr)
+		::munmap(mapping, length);
+}
+
+const SampleFileHeader &SampleFileReader::header() const noexcept
+{
+	return head;
+}
+
+std::size_t SampleFileReader::size() const noexcept
+{
+	return nsamples;
+}
+
+std::size_t SampleFileReader::rowLength() const noexcept
+{
+	return head.ndim + head.nparams;
+}
+
+const double *SampleFileReader::data() const noexcept
+{
+	return reinterpret_cast<const double*>(
+		static_cast<const char*>(mapping) + head.size);
+}
+
+/**
+ * \brief Runs a function for each thread's block of samples and waits for
+ *    the threads to finish.
+ *
+ * \throw The first exception thrown by a thread, if any.
+ *
+ * \param[in] nsamples The number of samples.
+ * \param[in] nthreads The number of threads.
+ * \param[in] work The function, called with the thread number and the
+ *    first and last (exclusive) samples of the thread's block.
+ */
+static void for_each_block(std::size_t nsamples, std::size_t nthreads,
+	const std::function<void(std::size_t, std::size_t, std::size_t)> &work)
+{
+	std::vector<std::exception_ptr> errors(nthreads, nullptr);
+	const auto run = [&](std::size_t t) -> void
+	{
+		try
+		{
+			work(t, (nsamples * t) / nthreads, (nsamples * (t+1)) / nthreads);
+		}
+		catch(...)
+		{
+			errors[t] = std::current_exception();
+		}
+	};
+
+	// the calling thread does the work of thread 0
+	std::vector<std::thread> workers;
+	for(std::size_t t = 1; t < nthreads; ++t)
+		workers.emplace_back(run, t);
+	run(0);
+	for(auto &worker : workers)
+		worker.join();
+
+	for(const auto &error : errors)
+		if(error != nullptr)
+			std::rethrow_exception(error);
+}
+
+Histogram RebinSamples(const SampleFileReader &samples,
+	const std::vector<std::size_t> &columns,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t nthreads)
+{
+	const std::size_t ndim{ columns.size() };
+	const std::size_t stride{ samples.rowLength() };
+	const std::size_t nsamples{ samples.size() };
+	const double *const rows{ samples.data() };
+
+	if(binstyles.size() != ndim)
+		throw std::invalid_argument("Incorrect number of binning styles.");
+	for(const std::size_t col : columns)
+		if(col >= stride)
+			throw std::invalid_argument("Column " + std::to_string(col) +
+				" is out of range.");
+	if(nsamples == 0)
+		throw std::runtime_error("There are no samples to bin.");
+	nthreads = std::max<std::size_t>(1, std::min(nthreads, nsamples));
+
+	// use the fixed bounds, where available; otherwise, find the extremes of
+	// the data (as in Histogram::bin_data)
+	std::vector<std::array<double, 2>> bounds(ndim);
+	std::vector<std::size_t> find;
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		if(binstyles[j] == nullptr)
+			throw std::invalid_argument("No binning style specified for " \
+				"dimension " + std::to_string(j) + ".");
+
+		if(binstyles[j]->hasBounds())
+			bounds[j] = binstyles[j]->getBounds();
+		else
+			find.push_back(j);
+	}
+
+	if(!find.empty())
+	{
+		std::vector<std::vector<std::array<double, 2>>> thread_extremes(
+			nthreads, std::vector<std::array<double, 2>>(find.size(),
+				{{ std::numeric_limits<double>::max(),
+				   std::numeric_limits<double>::lowest() }}));
+
+		for_each_block(nsamples, nthreads,
+			[&](std::size_t t, std::size_t first, std::size_t last) -> void
+			{
+				for(std::size_t f = 0; f < find.size(); ++f)
+				{
+					const double *values{ rows + columns[find[f]] };
+					double dmin{ thread_extremes[t][f][0] },
+						dmax{ thread_extremes[t][f][1] };
+
+					for(std::size_t k = first; k < last; ++k)
+					{
+						dmin = std::min(dmin, values[k * stride]);
+						dmax = std::max(dmax, values[k * stride]);
+					}
+
+					thread_extremes[t][f] = {{ dmin, dmax }};
+				}
+			});
+
+		for(std::size_t f = 0; f < find.size(); ++f)
+		{
+			const std::size_t j{ find[f] };
+			bounds[j] = thread_extremes[0][f];
+			for(std::size_t t = 1; t < nthreads; ++t)
+			{
+				bounds[j][0] = std::min(bounds[j][0], thread_extremes[t][f][0]);
+				bounds[j][1] = std::max(bounds[j][1], thread_extremes[t][f][1]);
+			}
+
+			if(bounds[j][0] == bounds[j][1])
+				throw std::invalid_argument("Every sample has the same value " \
+					"in dimension " + std::to_string(j) + "; specify bounds " \
+					"for it.");
+		}
+	}
+
+	// each thread bins its block into its own histogram; the values for the
+	// histogram are gathered from the rows a block at a time
+	std::vector<Histogram> thread_hists;
+	thread_hists.reserve(nthreads);
+	for(std::size_t t = 0; t < nthreads; ++t)
+		thread_hists.emplace_back(binstyles, bounds);
+
+	for_each_block(nsamples, nthreads,
+		[&](std::size_t t, std::size_t first, std::size_t last) -> void
+		{
+			constexpr std::size_t block{ 4096 };
+			std::vector<double> values(block * ndim);
+
+			for(std::size_t k = first; k < last; k += block)
+			{
+				const std::size_t n{ std::min(block, last - k) };
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					const double *const row{ rows + (k + i) * stride };
+					for(std::size_t j = 0; j < ndim; ++j)
+						values[i * ndim + j] = row[columns[j]];
+				}
+				thread_hists[t].add_data(values.data(), n);
+			}
+		});
+
+	for(std::size_t t = 1; t < nthreads; ++t)
+		thread_hists[0].merge(std::move(thread_hists[t]));
+
+	return std::move(thread_hists[0]);
+}
+
+SampleWriter::SampleWriter(std::ostream &out_,
+	const std::vector<std::string> &value_names,
+	const std::vector<std::string> &param_names, std::size_t buffer_size_)
+	: out(out_), ndim(value_names.size()), nparams(param_names.size()),
+	  buffer_size(buffer_size_)
+{
+	if(ndim == 0)
+		throw std::invalid_argument("Samples must have at least one value.");
+	if(buffer_size == 0)
+		throw std::invalid_argument("The buffer size must be positive.");
+
+	out.write(sample_magic, sizeof(sample_magic));
+	WriteBinaryUInt(out, sample_version);
+	WriteBinaryUInt(out, ndim);
+	WriteBinaryUInt(out, nparams);
+	std::size_t header_size{ sizeof(sample_magic) +
+		3 * sizeof(std::uint64_t) };
+	for(const std::vector<std::string> *names : { &value_names, &param_names })
+	{
+		for(const std::string &name : *names)
+		{
+			WriteBinaryUInt(out, name.size());
+			out.write(name.data(), name.size());
+			header_size += sizeof(std::uint64_t) + name.size();
+		}
+	}
+
+	// pad the header so that the samples are aligned
+	const char zeros[8]{};
+	out.write(zeros, (8 - header_size % 8) % 8);
+
+	filling.reserve(buffer_size * (ndim + nparams));
+	writing.reserve(buffer_size * (ndim + nparams));
+
+	worker = std::thread(&SampleWriter::run, this);
+}
+
+SampleWriter::~SampleWriter()
+{
+	try
+	{
+		close();
+	}
+	catch(...)
+	{
+		// errors can only be reported by calling close() explicitly
+	}
+}
+
+void SampleWriter::run()
+{
+	std::unique_lock<std::mutex> lock(mtx);
+
+	while(true)
+	{
+		cv.wait(lock, [this] { return pending || done; });
+
+		if(pending)
+		{
+			// the writing buffer is not touched by other threads while pending
+			lock.unlock();
+			out.write(reinterpret_cast<const char*>(writing.data()),
+				writing.size() * sizeof(double));
+			lock.lock();
+
+			writing.clear();
+			pending = false;
+			cv.notify_all();
+		}
+		else
+			return;
+	}
+}
+
+void SampleWriter::handoff(std::unique_lock<std::mutex> &lock)
+{
+	cv.wait(lock, [this] { return !pending; });
+	filling.swap(writing);
+	pending = true;
+	cv.notify_all();
+}
+
+void SampleWriter::write(const double *values, const double *params,
+	std::size_t n)
+{
+	std::unique_lock<std::mutex> lock(mtx);
+
+	if(done)
+		throw std::logic_error("Cannot write samples after closing.");
+
+	for(std::size_t k = 0; k < n; ++k)
+	{
+		filling.insert(filling.end(), values + k*ndim, values + (k+1)*ndim);
+		if(nparams > 0)
+			filling.insert(filling.end(), params + k*nparams,
+				params + (k+1)*nparams);
+
+		if(filling.size() >= buffer_size * (ndim + nparams))
+			handoff(lock);
+	}
+
+	nsamples += n;
+}
+
+void SampleWriter::close()
+{
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		if(done)
+			return;
+
+		if(!filling.empty())
+			handoff(lock);
+		done = true;
+		cv.notify_all();
+	}
+
+	worker.join();
+
+	out.flush();
+	if(!out)
+		throw std::runtime_error("Error writing the raw samples.");
+}
+
+std::size_t SampleWriter::size()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return nsamples;
+}
+
+} // namespace molstat
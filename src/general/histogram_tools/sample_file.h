@@ -0,0 +1,304 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sample_file.h
+ * \brief Writing, reading, and binning raw (unbinned) samples in a binary
+ *    file.
+ *
+ * A raw sample file stores the values of each trial, so that the data can
+ * be analyzed (or binned again) without repeating the simulation. All
+ * numbers are in the byte order of the machine that wrote the file. The
+ * file is
+ * - 8 characters, `MOLSTATS`.
+ * - 8-byte unsigned integers: the format version (1), the number of values
+ *   per sample that form the histogram (`ndim`), and the number of model
+ *   parameters per sample (`nparams`, possibly 0).
+ * - For each of the `ndim + nparams` columns: the length (8-byte unsigned
+ *   integer) and characters of the column's name.
+ * - Zeros, padding the header to a multiple of 8 bytes (so that the samples
+ *   are aligned when the file is memory mapped).
+ * - The samples (doubles), one row of `ndim + nparams` values per sample:
+ *   the histogram values followed by the model parameters.
+ *
+ * The number of samples is determined by the size of the file.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __sample_file_h__
+#define __sample_file_h__
+
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "histogram.h"
+
+namespace molstat {
+
+/**
+ * \brief The header of a raw sample file.
+ */
+struct SampleFileHeader
+{
+	/// The number of values per sample that form the histogram.
+	std::size_t ndim{ 0 };
+
+	/// The number of model parameters per sample.
+	std::size_t nparams{ 0 };
+
+	/// The name of each column (the values, then the parameters).
+	std::vector<std::string> names;
+
+	/// The size of the header, in bytes (the offset of the first sample).
+	std::size_t size{ 0 };
+};
+
+/**
+ * \brief Read-only, memory-mapped view of a raw sample file.
+ *
+ * The samples are not read until they are used, and the operating system
+ * can share and page the mapping, so very large files can be processed
+ * without reading them into memory.
+ */
+class SampleFileReader
+{
+private:
+	/// The header of the file.
+	SampleFileHeader head;
+
+	/// The mapping of the whole file.
+	void *mapping{ nullptr };
+
+	/// The size of the file (and mapping), in bytes.
+	std::size_t length{ 0 };
+
+	/// The number of samples.
+	std::size_t nsamples{ 0 };
+
+public:
+	SampleFileReader() = delete;
+	SampleFileReader(const SampleFileReader &) = delete;
+	SampleFileReader &operator=(const SampleFileReader &) = delete;
+
+	/**
+	 * \brief Opens and maps a raw sample file.
+	 *
+	 * \throw std::runtime_error if the file cannot be opened or mapped, if
+	 *    it is not a raw sample file, or if it does not contain a whole
+	 *    number of samples.
+	 *
+	 * \param[in] filename The name of the file.
+	 */
+	SampleFileReader(const std::string &filename);
+
+	/// Unmaps the file.
+	~SampleFileReader();
+
+	/**
+	 * \brief Gets the header of the file.
+	 *
+	 * \return The header.
+	 */
+	const SampleFileHeader &header() const noexcept;
+
+	/**
+	 * \brief Gets the number of samples.
+	 *
+	 * \return The number of samples.
+	 */
+	std::size_t size() const noexcept;
+
+	/**
+	 * \brief Gets the number of values in each sample (row).
+	 *
+	 * \return The number of values, `ndim + nparams`.
+	 */
+	std::size_t rowLength() const noexcept;
+
+	/**
+	 * \brief Gets the samples.
+	 *
+	 * \return Pointer to the first value of the first sample; sample `k`
+	 *    begins at `data()[k * rowLength()]`.
+	 */
+	const double *data() const noexcept;
+};
+
+/**
+ * \brief Bins columns of raw samples into a histogram, in parallel.
+ *
+ * The samples are divided into contiguous blocks, one per thread; each
+ * thread bins its block into its own (streaming) histogram, and the
+ * histograms are then summed. For dimensions without fixed bounds, the
+ * bounds are first found from the data (also in parallel), which gives
+ * the same bins as molstat::Histogram::bin_data.
+ *
+ * \throw std::invalid_argument if the numbers of columns and binning styles
+ *    differ, if a column is out of range, if a binning style is invalid, or
+ *    if a dimension without fixed bounds has only one value.
+ * \throw std::runtime_error if there are no samples.
+ *
+ * \param[in] samples The samples.
+ * \param[in] columns The column of the samples used for each dimension of
+ *    the histogram.
+ * \param[in] binstyles The binning style of each dimension.
+ * \param[in] nthreads The number of threads to use.
+ * \return The (binned) histogram.
+ */
+Histogram RebinSamples(const SampleFileReader &samples,
+	const std::vector<std::size_t> &columns,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t nthreads);
+
+/**
+ * \brief Reads the header of a raw sample file.
+ *
+ * \throw std::runtime_error if the stream does not begin with a raw sample
+ *    file header.
+ *
+ * \param[in,out] in The input stream, opened in binary mode. On return, it
+ *    is positioned at the first sample.
+ * \return The header.
+ */
+SampleFileHeader ReadSampleFileHeader(std::istream &in);
+
+/**
+ * \brief Writes raw samples to a binary stream in the background.
+ *
+ * Samples are copied into one of two buffers. When that buffer is full, it
+ * is handed to a background thread that writes it to the stream while the
+ * other buffer is filled, so that the output overlaps with the simulation.
+ * A caller only waits if both buffers are full.
+ *
+ * SampleWriter::write may be called from several threads at once; the
+ * samples from each call are stored contiguously, but the calls are
+ * otherwise in no particular order.
+ */
+class SampleWriter
+{
+public:
+	/// The default number of samples in each buffer.
+	static const std::size_t default_buffer_size;
+
+private:
+	/// The output stream.
+	std::ostream &out;
+
+	/// The number of values per sample that form the histogram.
+	const std::size_t ndim;
+
+	/// The number of model parameters per sample.
+	const std::size_t nparams;
+
+	/// The number of samples in each buffer.
+	const std::size_t buffer_size;
+
+	/// The buffer being filled.
+	std::vector<double> filling;
+
+	/// The buffer being written by the background thread.
+	std::vector<double> writing;
+
+	/// True if SampleWriter::writing holds samples to be written.
+	bool pending{ false };
+
+	/// True once no more samples will be added.
+	bool done{ false };
+
+	/// The number of samples accepted.
+	std::size_t nsamples{ 0 };
+
+	/// Protects the buffers and flags.
+	std::mutex mtx;
+
+	/// Signals changes to SampleWriter::pending and SampleWriter::done.
+	std::condition_variable cv;
+
+	/// The background thread.
+	std::thread worker;
+
+	/// The work performed by the background thread.
+	void run();
+
+	/**
+	 * \brief Hands the filled buffer to the background thread.
+	 *
+	 * Waits for the background thread to finish the previous buffer, if
+	 * necessary.
+	 *
+	 * \param[in,out] lock The (locked) lock on SampleWriter::mtx.
+	 */
+	void handoff(std::unique_lock<std::mutex> &lock);
+
+public:
+	SampleWriter() = delete;
+	SampleWriter(const SampleWriter &) = delete;
+	SampleWriter &operator=(const SampleWriter &) = delete;
+
+	/**
+	 * \brief Writes the header and starts the background thread.
+	 *
+	 * \throw std::invalid_argument if there are no values or if the buffer
+	 *    size is 0.
+	 *
+	 * \param[in,out] out_ The output stream, opened in binary mode. It must
+	 *    outlive the writer.
+	 * \param[in] value_names The name of each value that forms the
+	 *    histogram.
+	 * \param[in] param_names The name of each model parameter; empty if the
+	 *    parameters are not written.
+	 * \param[in] buffer_size_ The number of samples in each buffer.
+	 */
+	SampleWriter(std::ostream &out_,
+		const std::vector<std::string> &value_names,
+		const std::vector<std::string> &param_names,
+		std::size_t buffer_size_ = default_buffer_size);
+
+	/**
+	 * \brief Finishes writing; errors are ignored (call
+	 *    SampleWriter::close to detect them).
+	 */
+	~SampleWriter();
+
+	/**
+	 * \brief Adds samples.
+	 *
+	 * \throw std::logic_error if the writer has been closed.
+	 *
+	 * \param[in] values The values that form the histogram, `ndim` per
+	 *    sample.
+	 * \param[in] params The model parameters, `nparams` per sample; ignored
+	 *    if the parameters are not written.
+	 * \param[in] n The number of samples.
+	 */
+	void write(const double *values, const double *params, std::size_t n);
+
+	/**
+	 * \brief Writes the remaining samples and stops the background thread.
+	 *
+	 * Calling this function more than once has no further effect.
+	 *
+	 * \throw std::runtime_error if the output stream reported an error.
+	 */
+	void close();
+
+	/**
+	 * \brief Gets the number of samples that have been added.
+	 *
+	 * \return The number of samples.
+	 */
+	std::size_t size();
+};
+
+} // namespace molstat
+
+#endif
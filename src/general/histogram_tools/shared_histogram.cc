@@ -0,0 +1,133 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file shared_histogram.cc
+ * \brief Implementation of bin counts shared by several threads.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "shared_histogram.h"
+#include <general/task_scheduler.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace molstat {
+
+// 1 GiB
+const std::size_t SharedHistogram::private_memory_limit = 1073741824;
+
+/**
+ * \brief The total number of bins of a histogram.
+ *
+ * \param[in] hist The histogram.
+ * \return The product of the numbers of bins in each dimension.
+ */
+static std::size_t total_bins(const Histogram &hist)
+{
+	std::size_t ret{ 1 };
+	for(std::size_t j = 0; j < hist.numDimensions(); ++j)
+		ret *= hist.numBins(j);
+	return ret;
+}
+
+SharedHistogram::SharedHistogram(Histogram &hist_, std::size_t nreplicas_)
+	: hist(hist_), nbins(hist_.isStreaming() ? total_bins(hist_) : 0),
+	  nreplicas(std::max<std::size_t>(1, nreplicas_)), counts(),
+	  zeroed(new std::once_flag[nreplicas]),
+	  used(new std::atomic<bool>[nreplicas]()), n_out_of_range(0),
+	  out_of_range_dim(new std::atomic<std::size_t>[2 * hist_.ndim]())
+{
+	if(!hist.isStreaming())
+		throw std::invalid_argument("Only the bins of a streaming histogram " \
+			"can be shared.");
+
+	// the counts are not initialized here, so that their pages are placed by
+	// the threads that zero them
+	for(std::size_t r = 0; r < nreplicas; ++r)
+		counts.emplace_back(new std::atomic<std::size_t>[nbins]);
+}
+
+void SharedHistogram::add_data(const double *v, std::size_t n)
+{
+	const std::size_t r{ CurrentNumaNode() % nreplicas };
+	std::atomic<std::size_t> *const replica{ counts[r].get() };
+	std::call_once(zeroed[r], [this, r, replica] () -> void
+		{
+			for(std::size_t k = 0; k < nbins; ++k)
+				replica[k].store(0, std::memory_order_relaxed);
+			used[r].store(true, std::memory_order_relaxed);
+		});
+
+	// bin the elements (in this thread), as in Histogram::add_data
+	Histogram::BinBlock scratch;
+	std::vector<std::array<std::size_t, 2>> tallies(hist.ndim, {{0, 0}});
+	std::size_t nout{ 0 };
+
+	constexpr std::size_t block_size{ 1024 };
+	const std::size_t stride{ block_size * hist.ndim };
+	for(std::size_t k = 0; k < n; k += block_size, v += stride)
+	{
+		const std::size_t m{ std::min(block_size, n - k) };
+		hist.binBlock(v, m, scratch, tallies);
+
+		// the counts are only read once the threads finish, so the
+		// increments need not be ordered
+		for(std::size_t i = 0; i < m; ++i)
+		{
+			if(scratch.valid[i])
+				replica[scratch.offsets[i]].fetch_add(1,
+					std::memory_order_relaxed);
+			else
+				++nout;
+		}
+	}
+
+	n_out_of_range.fetch_add(nout, std::memory_order_relaxed);
+	for(std::size_t j = 0; j < hist.ndim; ++j)
+	{
+		out_of_range_dim[2*j].fetch_add(tallies[j][0],
+			std::memory_order_relaxed);
+		out_of_range_dim[2*j + 1].fetch_add(tallies[j][1],
+			std::memory_order_relaxed);
+	}
+}
+
+void SharedHistogram::finish()
+{
+	std::vector<std::size_t> raw{ hist.getRawBinCounts() };
+	for(std::size_t r = 0; r < nreplicas; ++r)
+		if(used[r].load(std::memory_order_relaxed))
+			for(std::size_t k = 0; k < nbins; ++k)
+				raw[k] += counts[r][k].exchange(0, std::memory_order_relaxed);
+
+	std::vector<std::array<std::size_t, 2>> out_of_range(hist.ndim);
+	for(std::size_t j = 0; j < hist.ndim; ++j)
+		out_of_range[j] = {{
+			hist.numUnderflow(j) +
+				out_of_range_dim[2*j].exchange(0, std::memory_order_relaxed),
+			hist.numOverflow(j) +
+				out_of_range_dim[2*j + 1].exchange(0, std::memory_order_relaxed)
+		}};
+
+	hist.setRawBinCounts(std::move(raw), hist.numOutOfRange() +
+		n_out_of_range.exchange(0, std::memory_order_relaxed), out_of_range);
+}
+
+std::size_t SharedHistogram::memoryUsage() const noexcept
+{
+	return (nreplicas * nbins + 2 * hist.ndim) *
+		sizeof(std::atomic<std::size_t>);
+}
+
+bool SharedHistogram::preferred(std::size_t nbins, std::size_t nthreads,
+	std::size_t limit) noexcept
+{
+	return nthreads > 1 && nbins > limit / sizeof(std::size_t) / nthreads;
+}
+
+} // namespace molstat
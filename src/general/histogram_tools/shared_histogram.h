@@ -0,0 +1,144 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file shared_histogram.h
+ * \brief Bin counts shared by several threads.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __shared_histogram_h__
+#define __shared_histogram_h__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "histogram.h"
+
+namespace molstat {
+
+/**
+ * \brief Accumulates bin counts from several threads at once, with the bins
+ *    of a streaming histogram.
+ *
+ * Usually each thread fills its own histogram and the histograms are merged
+ * at the end, which multiplies the memory of the bin counts by the number of
+ * threads. Here the threads share one array of bin counts that are
+ * incremented atomically. Each thread still bins its data elements on its
+ * own, so only the increments are shared; with many bins, two threads
+ * rarely increment the same bin at the same time.
+ *
+ * On a NUMA machine, the threads of each node can instead share their own
+ * copy (replica) of the counts, so that the increments stay in the node's
+ * memory. A replica is zeroed, and thus placed, by the first thread to add
+ * data to it; a thread uses the replica of its node (see CurrentNumaNode).
+ *
+ * The counts (of every replica) are added to the histogram by finish(), once
+ * the threads are done.
+ */
+class SharedHistogram
+{
+private:
+	/// The histogram that provides the bins and receives the counts.
+	Histogram &hist;
+
+	/// The number of bins.
+	const std::size_t nbins;
+
+	/// The number of replicas of the counts.
+	const std::size_t nreplicas;
+
+	/// The counts in each bin, for each replica (allocated, but not zeroed,
+	/// at construction).
+	std::vector<std::unique_ptr<std::atomic<std::size_t>[]>> counts;
+
+	/// Zeroes each replica once, on the first thread to use it.
+	std::unique_ptr<std::once_flag[]> zeroed;
+
+	/// Whether each replica has been zeroed (and may have counts).
+	std::unique_ptr<std::atomic<bool>[]> used;
+
+	/// The number of data elements outside the bounds.
+	std::atomic<std::size_t> n_out_of_range;
+
+	/// The underflows and overflows of each dimension (interleaved).
+	std::unique_ptr<std::atomic<std::size_t>[]> out_of_range_dim;
+
+public:
+	/**
+	 * \brief The most memory (in bytes) used for the bin counts of private,
+	 *    per-thread histograms before a shared histogram is preferred.
+	 */
+	static const std::size_t private_memory_limit;
+
+	SharedHistogram() = delete;
+	SharedHistogram(const SharedHistogram &) = delete;
+	SharedHistogram &operator=(const SharedHistogram &) = delete;
+
+	/**
+	 * \brief Constructor; the counts start at 0.
+	 *
+	 * \throw std::invalid_argument if the histogram is not in streaming
+	 *    mode.
+	 *
+	 * \param[in] hist_ The histogram whose bins are used. It must not be
+	 *    changed (or destroyed) until finish() is called.
+	 * \param[in] nreplicas_ The number of replicas of the counts (e.g., the
+	 *    number of NUMA nodes, with pinned threads); 0 is treated as 1.
+	 */
+	SharedHistogram(Histogram &hist_, std::size_t nreplicas_ = 1);
+
+	/**
+	 * \brief Adds several data elements; several threads may call this
+	 *    function at once.
+	 *
+	 * The counts go to replica `CurrentNumaNode() % nreplicas`.
+	 *
+	 * \param[in] v The data, stored contiguously as in Histogram::add_data.
+	 * \param[in] n The number of data elements.
+	 */
+	void add_data(const double *v, std::size_t n);
+
+	/**
+	 * \brief Adds the counts (and tallies) of every replica to the
+	 *    histogram and resets them.
+	 *
+	 * No thread may be adding data.
+	 */
+	void finish();
+
+	/**
+	 * \brief Gets the memory allocated for the shared counts (of every
+	 *    replica).
+	 *
+	 * \return The memory (bytes).
+	 */
+	std::size_t memoryUsage() const noexcept;
+
+	/**
+	 * \brief Determines if several threads should share one histogram
+	 *    instead of each having its own.
+	 *
+	 * The private histograms are preferred unless their (dense) bin counts
+	 * would take more than `limit` bytes.
+	 *
+	 * \param[in] nbins The number of bins.
+	 * \param[in] nthreads The number of threads.
+	 * \param[in] limit The most memory (bytes) for the private bin counts;
+	 *    SharedHistogram::private_memory_limit by default.
+	 * \return True if the threads should share one histogram.
+	 */
+	static bool preferred(std::size_t nbins, std::size_t nthreads,
+		std::size_t limit = private_memory_limit) noexcept;
+};
+
+} // namespace molstat
+
+#endif
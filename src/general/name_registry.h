@@ -0,0 +1,266 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file name_registry.h
+ * \brief A registry of named items (models, observables, ...) with hashes of
+ *    the names precomputed at compile time.
+ *
+ * The names are case insensitive. Each name is registered with its hash,
+ * which MOLSTAT_REGISTRY_KEY computes at compile time. The registry requires
+ * the hashes of its names to be distinct (a perfect hash of its names), so a
+ * lookup hashes the name once (without copying it), finds the hash with a
+ * binary search, and compares one name.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __name_registry_h__
+#define __name_registry_h__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Makes a molstat::RegistryKey for a name, with the hash calculated at
+ *    compile time.
+ *
+ * \param[in] name The name, a string literal.
+ */
+#define MOLSTAT_REGISTRY_KEY(name) \
+	molstat::RegistryKey{ name, std::integral_constant<std::uint64_t, \
+		molstat::hash_name(name)>::value }
+
+namespace molstat {
+
+/**
+ * \brief Converts an (ASCII) uppercase letter to lowercase.
+ *
+ * \param[in] c The character.
+ * \return The lowercase character.
+ */
+constexpr char fold_case(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+/**
+ * \brief Hashes a name, ignoring case (64-bit FNV-1a).
+ *
+ * \param[in] name The name.
+ * \param[in] hash The hash of the preceding characters.
+ * \return The hash.
+ */
+constexpr std::uint64_t hash_name(const char *name,
+	std::uint64_t hash = 14695981039346656037ULL)
+{
+	return *name == '\0' ? hash : hash_name(name + 1,
+		(hash ^ std::uint8_t(fold_case(*name))) * 1099511628211ULL);
+}
+
+/**
+ * \brief Hashes a name, ignoring case (64-bit FNV-1a).
+ *
+ * \param[in] name The name.
+ * \return The hash; the same as for the characters of the name.
+ */
+inline std::uint64_t hash_name(const std::string &name)
+{
+	std::uint64_t hash{ 14695981039346656037ULL };
+	for(const char c : name)
+		hash = (hash ^ std::uint8_t(fold_case(c))) * 1099511628211ULL;
+	return hash;
+}
+
+/// A name and its hash, for registering in a molstat::NameRegistry.
+struct RegistryKey
+{
+	/// The name.
+	const char *name;
+
+	/// The hash of the name (from molstat::hash_name).
+	std::uint64_t hash;
+};
+
+/**
+ * \brief A registry of items by (case insensitive) name.
+ *
+ * The registry has the lookup functions of a `std::map` (`count`, `at`), and
+ * iterates over its items in the order of their names (lowercase), as pairs
+ * of the name and the item.
+ *
+ * \tparam T The type of the items.
+ */
+template<typename T>
+class NameRegistry
+{
+private:
+	/// The names (lowercase) and items, sorted by name.
+	std::vector<std::pair<std::string, T>> entries;
+
+	/// The hashes and the indices of their entries, sorted by hash.
+	std::vector<std::pair<std::uint64_t, std::size_t>> index;
+
+	/**
+	 * \brief Finds the hash in the index.
+	 *
+	 * \param[in] hash The hash.
+	 * \return The first element of the index with at least the hash.
+	 */
+	typename std::vector<std::pair<std::uint64_t, std::size_t>>::const_iterator
+		find_hash(std::uint64_t hash) const
+	{
+		return std::lower_bound(index.cbegin(), index.cend(), hash,
+			[] (const std::pair<std::uint64_t, std::size_t> &elem,
+				std::uint64_t h) -> bool
+			{
+				return elem.first < h;
+			});
+	}
+
+public:
+	/// The iterator over the names and items.
+	using const_iterator =
+		typename std::vector<std::pair<std::string, T>>::const_iterator;
+
+	/**
+	 * \brief Registers an item.
+	 *
+	 * An item already registered with the name is replaced.
+	 *
+	 * \throw std::invalid_argument if the hash is not that of the name, or if
+	 *    a different name has the same hash.
+	 *
+	 * \param[in] key The name and its hash (see MOLSTAT_REGISTRY_KEY).
+	 * \param[in] item The item.
+	 */
+	void add(const RegistryKey &key, T item)
+	{
+		std::string name{ key.name };
+		std::transform(name.begin(), name.end(), name.begin(), fold_case);
+		if(key.hash != hash_name(name))
+			throw std::invalid_argument("Incorrect hash for the name \"" +
+				name + "\".");
+
+		const auto found = find_hash(key.hash);
+		if(found != index.cend() && found->first == key.hash)
+		{
+			if(entries[found->second].first != name)
+				throw std::invalid_argument("The names \"" + name + "\" and \"" +
+					entries[found->second].first + "\" have the same hash.");
+			entries[found->second].second = std::move(item);
+			return;
+		}
+
+		// insert the entry in order, shifting the indices after it
+		const std::size_t pos = std::lower_bound(entries.cbegin(),
+			entries.cend(), name,
+			[] (const std::pair<std::string, T> &elem, const std::string &n)
+				-> bool
+			{
+				return elem.first < n;
+			}) - entries.cbegin();
+		for(std::pair<std::uint64_t, std::size_t> &elem : index)
+			if(elem.second >= pos)
+				++elem.second;
+
+		index.emplace(found, key.hash, pos);
+		entries.emplace(entries.cbegin() + pos, std::move(name),
+			std::move(item));
+	}
+
+	/**
+	 * \brief Finds an item.
+	 *
+	 * \param[in] name The name (in any case).
+	 * \return A pointer to the item, or nullptr if no item has the name.
+	 */
+	const T *find(const std::string &name) const
+	{
+		const std::uint64_t hash{ hash_name(name) };
+		const auto found = find_hash(hash);
+		if(found == index.cend() || found->first != hash)
+			return nullptr;
+
+		// the hash may be of a name that is not registered
+		const std::string &entry = entries[found->second].first;
+		if(entry.size() != name.size() || !std::equal(name.cbegin(),
+			name.cend(), entry.cbegin(), [] (char a, char b) -> bool
+			{
+				return fold_case(a) == b;
+			}))
+			return nullptr;
+
+		return &entries[found->second].second;
+	}
+
+	/**
+	 * \brief Counts the items with a name.
+	 *
+	 * \param[in] name The name (in any case).
+	 * \return 1 if an item has the name, 0 otherwise.
+	 */
+	std::size_t count(const std::string &name) const
+	{
+		return find(name) == nullptr ? 0 : 1;
+	}
+
+	/**
+	 * \brief Gets an item.
+	 *
+	 * \throw std::out_of_range if no item has the name.
+	 *
+	 * \param[in] name The name (in any case).
+	 * \return The item.
+	 */
+	const T &at(const std::string &name) const
+	{
+		const T *item{ find(name) };
+		if(item == nullptr)
+			throw std::out_of_range("No item is named \"" + name + "\".");
+		return *item;
+	}
+
+	/**
+	 * \brief Gets the number of items.
+	 *
+	 * \return The number of items.
+	 */
+	std::size_t size() const
+	{
+		return entries.size();
+	}
+
+	/**
+	 * \brief Gets an iterator to the first item.
+	 *
+	 * \return The iterator.
+	 */
+	const_iterator begin() const
+	{
+		return entries.cbegin();
+	}
+
+	/**
+	 * \brief Gets an iterator past the last item.
+	 *
+	 * \return The iterator.
+	 */
+	const_iterator end() const
+	{
+		return entries.cend();
+	}
+};
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,158 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file nelder_mead.cc
+ * \brief Implements the Nelder-Mead simplex method.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "nelder_mead.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace molstat {
+
+NelderMeadResult MinimizeNelderMead(
+	const std::function<double(const std::vector<double> &)> &f,
+	const std::vector<double> &x0, const std::vector<double> &steps,
+	std::size_t maxiter, double tolerance)
+{
+	const std::size_t n{ x0.size() };
+	if(n == 0)
+		throw std::invalid_argument("Nothing to minimize.");
+	if(steps.size() != n)
+		throw std::invalid_argument("There must be a step for each " \
+			"coordinate.");
+
+	NelderMeadResult ret;
+
+	// points outside the function's domain are never accepted
+	const auto eval = [&f, &ret] (const std::vector<double> &x) -> double
+	{
+		++ret.evaluations;
+		const double val{ f(x) };
+		return std::isnan(val) ? std::numeric_limits<double>::infinity() : val;
+	};
+
+	// the initial simplex
+	std::vector<std::vector<double>> simplex(n + 1, x0);
+	for(std::size_t j = 0; j < n; ++j)
+		simplex[j + 1][j] += steps[j];
+	std::vector<double> values(n + 1);
+	for(std::size_t k = 0; k <= n; ++k)
+		values[k] = eval(simplex[k]);
+
+	// the vertices sorted by their values (best first)
+	std::vector<std::size_t> order(n + 1);
+	const auto sort_vertices = [&order, &values] () -> void
+	{
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(),
+			[&values] (std::size_t a, std::size_t b) -> bool
+			{
+				return values[a] < values[b];
+			});
+	};
+
+	// the point along the line from the centroid through the worst vertex
+	std::vector<double> centroid(n), trial(n), second(n);
+	const auto along = [&centroid, n] (const std::vector<double> &worst,
+		double coef, std::vector<double> &x) -> void
+	{
+		for(std::size_t j = 0; j < n; ++j)
+			x[j] = centroid[j] + coef * (worst[j] - centroid[j]);
+	};
+
+	sort_vertices();
+	while(ret.iterations < maxiter)
+	{
+		const std::size_t best{ order.front() }, worst{ order.back() };
+
+		// converged if the values and the vertices are close
+		bool close{ std::abs(values[worst] - values[best]) <= tolerance ||
+			(std::isinf(values[worst]) && std::isinf(values[best])) };
+		for(std::size_t k = 0; k <= n && close; ++k)
+			for(std::size_t j = 0; j < n && close; ++j)
+				close = std::abs(simplex[k][j] - simplex[best][j]) <=
+					tolerance * std::abs(steps[j]);
+		if(close)
+		{
+			ret.converged = true;
+			break;
+		}
+		++ret.iterations;
+
+		std::fill(centroid.begin(), centroid.end(), 0.);
+		for(std::size_t k = 0; k < n; ++k)
+			for(std::size_t j = 0; j < n; ++j)
+				centroid[j] += simplex[order[k]][j] / n;
+
+		// reflect the worst vertex through the centroid
+		along(simplex[worst], -1., trial);
+		const double reflected{ eval(trial) };
+
+		if(reflected < values[best])
+		{
+			// expand further in that direction
+			along(simplex[worst], -2., second);
+			const double expanded{ eval(second) };
+			if(expanded < reflected)
+			{
+				simplex[worst].swap(second);
+				values[worst] = expanded;
+			}
+			else
+			{
+				simplex[worst].swap(trial);
+				values[worst] = reflected;
+			}
+		}
+		else if(reflected < values[order[n - 1]])
+		{
+			simplex[worst].swap(trial);
+			values[worst] = reflected;
+		}
+		else
+		{
+			// contract (outside if the reflection improved the worst vertex)
+			const bool outside{ reflected < values[worst] };
+			along(simplex[worst], outside ? -0.5 : 0.5, second);
+			const double contracted{ eval(second) };
+
+			if(contracted < (outside ? reflected : values[worst]))
+			{
+				simplex[worst].swap(second);
+				values[worst] = contracted;
+			}
+			else
+			{
+				// shrink toward the best vertex
+				for(std::size_t k = 0; k <= n; ++k)
+				{
+					if(k == best)
+						continue;
+					for(std::size_t j = 0; j < n; ++j)
+						simplex[k][j] = simplex[best][j] +
+							0.5 * (simplex[k][j] - simplex[best][j]);
+					values[k] = eval(simplex[k]);
+				}
+			}
+		}
+
+		sort_vertices();
+	}
+
+	ret.x = simplex[order.front()];
+	ret.f = values[order.front()];
+	return ret;
+}
+
+} // namespace molstat
@@ -0,0 +1,73 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file nelder_mead.h
+ * \brief Derivative-free minimization with the Nelder-Mead simplex method.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __nelder_mead_h__
+#define __nelder_mead_h__
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace molstat {
+
+/// The result of a minimization with molstat::MinimizeNelderMead.
+struct NelderMeadResult
+{
+	/// The best point found.
+	std::vector<double> x;
+
+	/// The value of the function at the best point.
+	double f{ 0. };
+
+	/// The number of iterations performed.
+	std::size_t iterations{ 0 };
+
+	/// The number of function evaluations.
+	std::size_t evaluations{ 0 };
+
+	/// True if the simplex converged within the tolerance.
+	bool converged{ false };
+};
+
+/**
+ * \brief Minimizes a function with the Nelder-Mead simplex method.
+ *
+ * The function does not need derivatives, and may be noisy or piecewise
+ * constant (e.g., a distance between histograms). The initial simplex is the
+ * starting point and, for each coordinate, the point displaced by that
+ * coordinate's step. The standard coefficients are used (reflection 1,
+ * expansion 2, contraction 1/2, and shrinkage 1/2). The simplex converges
+ * when the function values at its vertices, and its vertices in each
+ * coordinate (relative to the initial steps), are within the tolerance.
+ *
+ * The function may return infinity (or NaN) for points outside its domain
+ * (e.g., invalid distribution parameters); such points are never accepted.
+ *
+ * \throw std::invalid_argument if the point is empty, or the numbers of
+ *    coordinates and steps differ.
+ *
+ * \param[in] f The function to minimize.
+ * \param[in] x0 The starting point.
+ * \param[in] steps The initial step in each coordinate.
+ * \param[in] maxiter The maximum number of iterations.
+ * \param[in] tolerance The convergence tolerance.
+ * \return The result.
+ */
+NelderMeadResult MinimizeNelderMead(
+	const std::function<double(const std::vector<double> &)> &f,
+	const std::vector<double> &x0, const std::vector<double> &steps,
+	std::size_t maxiter, double tolerance);
+
+} // namespace molstat
+
+#endif
@@ -25,6 +25,38 @@ double ConstantDistribution::sample(Engine &engine) const
 	return value;
 }
 
+void ConstantDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = value;
+}
+
+bool ConstantDistribution::isConstant(double &val) const
+{
+	val = value;
+	return true;
+}
+
+bool ConstantDistribution::hasQuantile() const
+{
+	return true;
+}
+
+void ConstantDistribution::quantile_n(const double *u, double *out,
+	std::size_t n) const
+{
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = value;
+}
+
+bool ConstantDistribution::getDeviceDistribution(
+	DeviceDistribution &dev) const
+{
+	dev = DeviceDistribution{ DeviceDistribution::Constant, value, 0. };
+	return true;
+}
+
 std::string ConstantDistribution::info() const
 {
 	return "Constant = " + std::to_string(value) + ".";
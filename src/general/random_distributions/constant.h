@@ -46,6 +46,19 @@ public:
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual bool hasQuantile() const override;
+
+	virtual void quantile_n(const double *u, double *out, std::size_t n)
+		const override;
+
+	virtual bool isConstant(double &val) const override;
+
+	virtual bool getDeviceDistribution(DeviceDistribution &dev) const
+		override;
+
 	virtual std::string info() const override;
 };
 
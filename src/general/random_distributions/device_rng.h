@@ -0,0 +1,142 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file device_rng.h
+ * \brief Counter-based sampling of model parameters, for code that runs on
+ *    accelerators (GPUs) as well as the host.
+ *
+ * Each random number is a function of a key and a counter (Philox4x32-10;
+ * Salmon et al.), so a trial's parameters depend only on the trial number.
+ * No engine state is carried between trials, and any partition of the
+ * trials over threads (or devices) samples the same parameters.
+ *
+ * The functions in this file are inline and free of the standard library, so
+ * that they can be compiled for a device (e.g., by nvcc).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __device_rng_h__
+#define __device_rng_h__
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+	/// Qualifier for functions that are compiled for the host and the device.
+	#define MOLSTAT_HOST_DEVICE __host__ __device__
+#else
+	/// Qualifier for functions that are compiled for the host and the device.
+	#define MOLSTAT_HOST_DEVICE
+#endif
+
+namespace molstat {
+
+/**
+ * \brief Applies the ten rounds of Philox4x32 to a counter.
+ *
+ * \param[in,out] c The counter; on output, the random bits.
+ * \param[in] k0 The low word of the key.
+ * \param[in] k1 The high word of the key.
+ */
+MOLSTAT_HOST_DEVICE inline void DevicePhilox4x32(std::uint32_t c[4],
+	std::uint32_t k0, std::uint32_t k1)
+{
+	for(int round = 0; round < 10; ++round)
+	{
+		const std::uint64_t p0{ std::uint64_t(0xD2511F53u) * c[0] },
+			p1{ std::uint64_t(0xCD9E8D57u) * c[2] };
+
+		const std::uint32_t c1{ c[1] }, c3{ c[3] };
+		c[0] = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+		c[1] = static_cast<std::uint32_t>(p1);
+		c[2] = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+		c[3] = static_cast<std::uint32_t>(p0);
+
+		k0 += 0x9E3779B9u;
+		k1 += 0xBB67AE85u;
+	}
+}
+
+/// A distribution that can be sampled by DeviceSample().
+struct DeviceDistribution
+{
+	/// The families of distributions.
+	enum Kind : std::uint32_t
+	{
+		/// Always `a`.
+		Constant,
+
+		/// Uniform on \f$[a, b)\f$.
+		Uniform,
+
+		/// Normal with mean `a` and standard deviation `b`.
+		Normal,
+
+		/// Lognormal; the logarithm is normal with mean `a` and standard
+		/// deviation `b`.
+		Lognormal
+	};
+
+	/// The family of the distribution.
+	Kind kind;
+
+	/// The first parameter.
+	double a;
+
+	/// The second parameter.
+	double b;
+};
+
+/**
+ * \brief Samples one model parameter of one trial.
+ *
+ * The counter is the trial and parameter numbers; one Philox block gives the
+ * two uniform numbers in \f$(0, 1)\f$ (53 bits each) used by the
+ * distribution. Normal numbers use the Box-Muller transformation.
+ *
+ * \param[in] dist The distribution.
+ * \param[in] key The key (e.g., from the seed of the simulation).
+ * \param[in] trial The trial number.
+ * \param[in] param The parameter number.
+ * \return The sample.
+ */
+MOLSTAT_HOST_DEVICE inline double DeviceSample(const DeviceDistribution &dist,
+	const std::uint64_t key, const std::uint64_t trial,
+	const std::uint32_t param)
+{
+	if(dist.kind == DeviceDistribution::Constant)
+		return dist.a;
+
+	std::uint32_t c[4]{ static_cast<std::uint32_t>(trial),
+		static_cast<std::uint32_t>(trial >> 32), param, 0u };
+	DevicePhilox4x32(c, static_cast<std::uint32_t>(key),
+		static_cast<std::uint32_t>(key >> 32));
+
+	// 2^-53
+	const double scale{ 1.1102230246251565404236316680908203125e-16 };
+	const double u1{ (double(((std::uint64_t(c[0]) << 32) | c[1]) >> 11) + 0.5)
+		* scale };
+	const double u2{ (double(((std::uint64_t(c[2]) << 32) | c[3]) >> 11) + 0.5)
+		* scale };
+
+	if(dist.kind == DeviceDistribution::Uniform)
+		return dist.a + (dist.b - dist.a) * u1;
+
+	const double twopi{ 6.283185307179586476925286766559 };
+	const double normal{ std::sqrt(-2. * std::log(u1)) *
+		std::cos(twopi * u2) };
+
+	if(dist.kind == DeviceDistribution::Normal)
+		return dist.a + dist.b * normal;
+
+	return std::exp(dist.a + dist.b * normal);
+}
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,245 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file empirical.cc
+ * \brief Implementation of the empirical distribution.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "empirical.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+namespace molstat {
+
+EmpiricalDistribution::EmpiricalDistribution(
+	const std::vector<double> &centers, const std::vector<double> &densities)
+	: RandomDistribution(), edges(centers.size() + 1),
+	  keep(centers.size()), alias(centers.size()), cdf(centers.size() + 1)
+{
+	const std::size_t n{ centers.size() };
+
+	if(n == 0 || densities.size() != n)
+		throw std::invalid_argument("Empirical Distribution: Every bin needs " \
+			"a center and a density.");
+
+	for(std::size_t j = 1; j < n; ++j)
+		if(!(centers[j] > centers[j - 1]))
+			throw std::invalid_argument("Empirical Distribution: The bin " \
+				"centers must be increasing.");
+
+	// the edges are halfway between the centers
+	if(n == 1)
+		edges[0] = edges[1] = centers[0];
+	else
+	{
+		for(std::size_t j = 1; j < n; ++j)
+			edges[j] = 0.5 * (centers[j - 1] + centers[j]);
+		edges[0] = centers[0] - (edges[1] - centers[0]);
+		edges[n] = centers[n - 1] + (centers[n - 1] - edges[n - 1]);
+	}
+
+	// the probability of each bin, scaled to average 1
+	std::vector<double> scaled(n);
+	double total{ 0. };
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		if(!(densities[j] >= 0.))
+			throw std::invalid_argument("Empirical Distribution: The " \
+				"densities must be non-negative.");
+
+		scaled[j] = n == 1 ? 1. : densities[j] * (edges[j + 1] - edges[j]);
+		total += scaled[j];
+	}
+	if(!(total > 0.))
+		throw std::invalid_argument("Empirical Distribution: At least one " \
+			"density must be positive.");
+	for(double &s : scaled)
+		s *= n / total;
+
+	cdf[0] = 0.;
+	for(std::size_t j = 0; j < n; ++j)
+		cdf[j + 1] = cdf[j] + scaled[j] / n;
+	cdf[n] = 1.;
+
+	// Vose's construction of the alias table: each underfull bin is topped
+	// up by an overfull one
+	std::vector<std::size_t> small, large;
+	for(std::size_t j = 0; j < n; ++j)
+		(scaled[j] < 1. ? small : large).push_back(j);
+
+	while(!small.empty() && !large.empty())
+	{
+		const std::size_t s{ small.back() }, l{ large.back() };
+		small.pop_back();
+
+		keep[s] = scaled[s];
+		alias[s] = l;
+
+		scaled[l] -= 1. - scaled[s];
+		if(scaled[l] < 1.)
+		{
+			large.pop_back();
+			small.push_back(l);
+		}
+	}
+
+	// the remaining bins are full (up to roundoff)
+	for(const std::size_t j : small)
+	{
+		keep[j] = 1.;
+		alias[j] = j;
+	}
+	for(const std::size_t j : large)
+	{
+		keep[j] = 1.;
+		alias[j] = j;
+	}
+}
+
+double EmpiricalDistribution::transform(double u) const
+{
+	// one uniform random number picks the bin and, from the leftover
+	// fraction, whether to use the alias and where to land in the bin
+	const std::size_t n{ keep.size() };
+	const double scaled{ u * n };
+	std::size_t bin{ static_cast<std::size_t>(scaled) };
+	if(bin >= n)
+		bin = n - 1;
+	double frac{ scaled - bin };
+
+	if(frac < keep[bin])
+		frac /= keep[bin];
+	else
+	{
+		frac = (frac - keep[bin]) / (1. - keep[bin]);
+		bin = alias[bin];
+	}
+
+	return edges[bin] + frac * (edges[bin + 1] - edges[bin]);
+}
+
+double EmpiricalDistribution::sample(Engine &engine) const
+{
+	double u;
+	sample_canonical_n(engine, &u, 1);
+
+	return transform(u);
+}
+
+void EmpiricalDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	sample_canonical_n(engine, out, n);
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = transform(out[j]);
+}
+
+bool EmpiricalDistribution::hasQuantile() const
+{
+	return true;
+}
+
+void EmpiricalDistribution::quantile_n(const double *u, double *out,
+	std::size_t n) const
+{
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		// the bin whose cumulative probabilities bracket u; bins without
+		// probability are never chosen
+		const std::size_t bin{ std::size_t(std::upper_bound(cdf.begin() + 1,
+			cdf.end() - 1, u[j]) - (cdf.begin() + 1)) };
+		const double width{ cdf[bin + 1] - cdf[bin] };
+		double frac{ width > 0. ? (u[j] - cdf[bin]) / width : 0.5 };
+		frac = std::min(std::max(frac, 0.), 1.);
+
+		out[j] = edges[bin] + frac * (edges[bin + 1] - edges[bin]);
+	}
+}
+
+bool EmpiricalDistribution::hasDensity() const
+{
+	return keep.size() > 1;
+}
+
+void EmpiricalDistribution::log_density_n(const double *x, double *out,
+	std::size_t n) const
+{
+	if(keep.size() == 1)
+		RandomDistribution::log_density_n(x, out, n);
+
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		if(!(x[j] >= edges.front() && x[j] <= edges.back()))
+		{
+			out[j] = -std::numeric_limits<double>::infinity();
+			continue;
+		}
+
+		// the bin containing x (the upper edge is in the last bin)
+		const std::size_t bin{ std::min(std::size_t(std::upper_bound(
+			edges.begin() + 1, edges.end(), x[j]) - (edges.begin() + 1)),
+			keep.size() - 1) };
+		out[j] = std::log((cdf[bin + 1] - cdf[bin]) /
+			(edges[bin + 1] - edges[bin]));
+	}
+}
+
+bool EmpiricalDistribution::isConstant(double &val) const
+{
+	if(keep.size() > 1)
+		return false;
+
+	val = edges[0];
+	return true;
+}
+
+std::string EmpiricalDistribution::info() const
+{
+	return "Empirical: " + std::to_string(keep.size()) + " bins between " +
+		std::to_string(edges.front()) + " and " +
+		std::to_string(edges.back()) + ".";
+}
+
+std::unique_ptr<RandomDistribution> ReadEmpiricalDistribution(
+	const std::string &filename)
+{
+	std::ifstream in(filename);
+	if(!in)
+		throw std::invalid_argument("Unable to open the file \"" + filename +
+			"\".");
+
+	std::vector<double> centers, densities;
+	std::string line;
+	TokenViews tokens;
+	for(std::size_t lineno = 1; std::getline(in, line); ++lineno)
+	{
+		tokenize(line, tokens);
+		if(tokens.size() == 0 || tokens[0][0] == '#')
+			continue;
+
+		double center, density;
+		if(tokens.size() < 2 || !parse_number(tokens[0], center) ||
+			!parse_number(tokens[1], density))
+		{
+			throw std::invalid_argument("Line " + std::to_string(lineno) +
+				" of \"" + filename + "\" does not have a bin center and a " \
+				"density.");
+		}
+
+		centers.push_back(center);
+		densities.push_back(density);
+	}
+
+	return std::unique_ptr<RandomDistribution>(
+		new EmpiricalDistribution(centers, densities));
+}
+
+} // namespace molstat
@@ -0,0 +1,123 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file empirical.h
+ * \brief Interface for the empirical (tabulated) distribution.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __empirical_h__
+#define __empirical_h__
+
+#include <memory>
+#include <vector>
+#include <string>
+#include "rng.h"
+
+namespace molstat {
+
+/**
+ * \brief Distribution tabulated as a histogram, such as from a file.
+ *
+ * The table lists bin centers and the probability density in each bin. The
+ * bin edges are halfway between consecutive centers (the first and last bins
+ * are symmetric about their centers), and the probability of each bin is its
+ * density times its width. A bin is chosen in constant time with Walker's
+ * alias method, and the value is uniform within the bin; each sample uses
+ * one uniform random number.
+ */
+class EmpiricalDistribution : public RandomDistribution
+{
+protected:
+	/// The lower edge of each bin (and, last, the upper edge of the last bin).
+	std::vector<double> edges;
+
+	/**
+	 * \brief The probability of keeping each bin (instead of its alias) in
+	 *    the alias method.
+	 */
+	std::vector<double> keep;
+
+	/// The alias of each bin.
+	std::vector<std::size_t> alias;
+
+	/**
+	 * \brief The cumulative probability at each edge, for the quantile
+	 *    function.
+	 */
+	std::vector<double> cdf;
+
+	/**
+	 * \brief Gets the sample for a uniform random number.
+	 *
+	 * The integer part of `u` times the number of bins selects the bin, and
+	 * the fractional part decides between the bin and its alias and then
+	 * places the value in the bin.
+	 *
+	 * \param[in] u Uniform random number in (0, 1).
+	 * \return The sample.
+	 */
+	double transform(double u) const;
+
+public:
+	EmpiricalDistribution() = delete;
+	~EmpiricalDistribution() = default;
+
+	/**
+	 * \brief Constructor specifying the table.
+	 *
+	 * \throw std::invalid_argument if the table is empty, the centers are not
+	 *    increasing, any density is negative, or every density is 0.
+	 *
+	 * \param[in] centers The bin centers.
+	 * \param[in] densities The probability density in each bin (need not be
+	 *    normalized).
+	 */
+	EmpiricalDistribution(const std::vector<double> &centers,
+		const std::vector<double> &densities);
+
+	virtual double sample(Engine &engine) const override;
+
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual bool hasQuantile() const override;
+
+	virtual void quantile_n(const double *u, double *out, std::size_t n)
+		const override;
+
+	virtual bool hasDensity() const override;
+
+	virtual void log_density_n(const double *x, double *out, std::size_t n)
+		const override;
+
+	virtual bool isConstant(double &val) const override;
+
+	virtual std::string info() const override;
+};
+
+/**
+ * \brief Reads the table of an empirical distribution from a file.
+ *
+ * Each line of the file has a bin center followed by the probability density
+ * in that bin; additional columns are ignored, as are blank lines and lines
+ * beginning with `#`. A one-dimensional histogram written by
+ * `molstat-simulator` is in this format.
+ *
+ * \throw std::invalid_argument if the file cannot be read or the table is
+ *    invalid (see molstat::EmpiricalDistribution).
+ *
+ * \param[in] filename The name of the file.
+ * \return The distribution.
+ */
+std::unique_ptr<RandomDistribution> ReadEmpiricalDistribution(
+	const std::string &filename);
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,484 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file engine.cc
+ * \brief Implementation of the random number engines.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "engine.h"
+#include "device_rng.h"
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <general/string_tools.h>
+
+namespace molstat {
+
+namespace {
+
+/// 128-bit unsigned integer (high, low) for the PCG64 arithmetic.
+struct UInt128
+{
+	/// The high 64 bits.
+	std::uint64_t hi;
+
+	/// The low 64 bits.
+	std::uint64_t lo;
+};
+
+/**
+ * \brief Full 64-bit by 64-bit multiplication.
+ *
+ * \param[in] a The first factor.
+ * \param[in] b The second factor.
+ * \return The 128-bit product.
+ */
+inline UInt128 mul64(const std::uint64_t a, const std::uint64_t b)
+{
+	const std::uint64_t a0{ a & 0xFFFFFFFFu }, a1{ a >> 32 };
+	const std::uint64_t b0{ b & 0xFFFFFFFFu }, b1{ b >> 32 };
+
+	const std::uint64_t p00{ a0 * b0 }, p01{ a0 * b1 };
+	const std::uint64_t p10{ a1 * b0 }, p11{ a1 * b1 };
+
+	const std::uint64_t mid{ (p00 >> 32) + (p01 & 0xFFFFFFFFu) +
+		(p10 & 0xFFFFFFFFu) };
+
+	return { p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32),
+		(mid << 32) | (p00 & 0xFFFFFFFFu) };
+}
+
+/**
+ * \brief 128-bit multiplication (modulo \f$2^{128}\f$).
+ *
+ * \param[in] a The first factor.
+ * \param[in] b The second factor.
+ * \return The product.
+ */
+inline UInt128 mul128(const UInt128 &a, const UInt128 &b)
+{
+	UInt128 ret{ mul64(a.lo, b.lo) };
+	ret.hi += a.hi * b.lo + a.lo * b.hi;
+	return ret;
+}
+
+/**
+ * \brief 128-bit addition (modulo \f$2^{128}\f$).
+ *
+ * \param[in] a The first term.
+ * \param[in] b The second term.
+ * \return The sum.
+ */
+inline UInt128 add128(const UInt128 &a, const UInt128 &b)
+{
+	const std::uint64_t lo{ a.lo + b.lo };
+	return { a.hi + b.hi + (lo < a.lo ? 1 : 0), lo };
+}
+
+/// The PCG64 (128-bit LCG) multiplier.
+const UInt128 pcg_mult{ 0x2360ED051FC65DA4ull, 0x4385DF649FCCF645ull };
+
+/**
+ * \brief Rotates a 64-bit value left.
+ *
+ * \param[in] x The value.
+ * \param[in] k The number of bits (0 < k < 64).
+ * \return The rotated value.
+ */
+inline std::uint64_t rotl(const std::uint64_t x, const int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * \brief The splitmix64 generator, used for expanding seeds.
+ *
+ * \param[in,out] x The state.
+ * \return The next value.
+ */
+inline std::uint64_t splitmix64(std::uint64_t &x)
+{
+	std::uint64_t z{ x += 0x9E3779B97F4A7C15ull };
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+/**
+ * \brief One step of xoshiro256++.
+ *
+ * \param[in,out] s The state.
+ * \return The next value.
+ */
+inline std::uint64_t xoshiroNext(std::array<std::uint64_t, 4> &s)
+{
+	const std::uint64_t result{ rotl(s[0] + s[3], 23) + s[0] };
+	const std::uint64_t t{ s[1] << 17 };
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+
+	return result;
+}
+
+/**
+ * \brief One step of PCG64.
+ *
+ * \param[in,out] p The state and increment.
+ * \return The next value.
+ */
+inline std::uint64_t pcgNext(std::array<std::uint64_t, 4> &p)
+{
+	const UInt128 state{ add128(mul128({ p[0], p[1] }, pcg_mult),
+		{ p[2], p[3] }) };
+	p[0] = state.hi;
+	p[1] = state.lo;
+
+	// XSL-RR output
+	const std::uint64_t x{ state.hi ^ state.lo };
+	const int rot{ static_cast<int>(state.hi >> 58) };
+	return (x >> rot) | (x << ((64 - rot) & 63));
+}
+
+/**
+ * \brief Advances a PCG64 state by \f$\delta\f$ steps in \f$O(\log\delta)\f$
+ *    operations.
+ *
+ * \param[in,out] p The state and increment.
+ * \param[in] delta The number of steps.
+ */
+void pcgAdvance(std::array<std::uint64_t, 4> &p, UInt128 delta)
+{
+	UInt128 cur_mult{ pcg_mult }, cur_plus{ p[2], p[3] };
+	UInt128 acc_mult{ 0, 1 }, acc_plus{ 0, 0 };
+
+	while(delta.hi != 0 || delta.lo != 0)
+	{
+		if(delta.lo & 1)
+		{
+			acc_mult = mul128(acc_mult, cur_mult);
+			acc_plus = add128(mul128(acc_plus, cur_mult), cur_plus);
+		}
+		cur_plus = mul128(add128(cur_mult, { 0, 1 }), cur_plus);
+		cur_mult = mul128(cur_mult, cur_mult);
+
+		delta.lo = (delta.lo >> 1) | (delta.hi << 63);
+		delta.hi >>= 1;
+	}
+
+	const UInt128 state{ add128(mul128(acc_mult, { p[0], p[1] }), acc_plus) };
+	p[0] = state.hi;
+	p[1] = state.lo;
+}
+
+} // anonymous namespace
+
+const EngineKind Engine::default_kind = EngineKind::Xoshiro256pp;
+
+const Engine::result_type Engine::default_seed = 5489u;
+
+EngineKind EngineKindFromName(const std::string &name)
+{
+	const std::string lname{ to_lower(name) };
+
+	if(lname == "xoshiro256++" || lname == "xoshiro")
+		return EngineKind::Xoshiro256pp;
+	else if(lname == "pcg64" || lname == "pcg")
+		return EngineKind::PCG64;
+	else if(lname == "philox4x32" || lname == "philox")
+		return EngineKind::Philox4x32;
+
+	throw std::invalid_argument("Unrecognized random number engine: \"" +
+		name + "\".\nPossible options are:\n" \
+		"   xoshiro256++ - xoshiro256++ (default).\n" \
+		"   pcg64 - PCG64 (XSL-RR).\n" \
+		"   philox4x32 - Philox4x32-10 (counter-based).");
+}
+
+std::string EngineKindName(EngineKind kind)
+{
+	switch(kind)
+	{
+	case EngineKind::PCG64:
+		return "PCG64";
+	case EngineKind::Philox4x32:
+		return "Philox4x32-10";
+	case EngineKind::Xoshiro256pp:
+	default:
+		return "xoshiro256++";
+	}
+}
+
+Engine::Engine()
+	: Engine(default_seed, default_kind)
+{
+}
+
+Engine::Engine(result_type seed, EngineKind kind)
+	: engine_kind(kind)
+{
+	std::uint64_t x{ seed };
+	seedWords({{ splitmix64(x), splitmix64(x), splitmix64(x),
+		splitmix64(x) }});
+}
+
+Engine::Engine(result_type seed, result_type substream, EngineKind kind)
+	: engine_kind(kind)
+{
+	std::seed_seq seq{ static_cast<std::uint32_t>(seed),
+		static_cast<std::uint32_t>(seed >> 32),
+		static_cast<std::uint32_t>(substream),
+		static_cast<std::uint32_t>(substream >> 32) };
+
+	seedSequence(seq);
+}
+
+Engine::Engine(std::seed_seq &seq, EngineKind kind)
+	: engine_kind(kind)
+{
+	seedSequence(seq);
+}
+
+void Engine::seedSequence(std::seed_seq &seq)
+{
+	std::array<std::uint32_t, 8> seeds;
+	seq.generate(seeds.begin(), seeds.end());
+
+	std::array<std::uint64_t, 4> words;
+	for(std::size_t j = 0; j < 4; ++j)
+		words[j] = (std::uint64_t(seeds[2*j]) << 32) | seeds[2*j + 1];
+
+	seedWords(words);
+}
+
+void Engine::seedWords(const std::array<std::uint64_t, 4> &words)
+{
+	// xoshiro256++: the state cannot be all zeros
+	xoshiro = words;
+	if(xoshiro[0] == 0 && xoshiro[1] == 0 && xoshiro[2] == 0 &&
+		xoshiro[3] == 0)
+	{
+		xoshiro[0] = 1;
+	}
+
+	// PCG64: the increment must be odd; use the standard seeding procedure
+	pcg = {{ 0, 0, words[2], words[3] | 1 }};
+	pcgNext(pcg);
+	const UInt128 state{ add128({ pcg[0], pcg[1] }, { words[0], words[1] }) };
+	pcg[0] = state.hi;
+	pcg[1] = state.lo;
+	pcgNext(pcg);
+
+	// Philox4x32: the key comes from the seed and the counter starts at 0
+	philox_key = {{ static_cast<std::uint32_t>(words[0] >> 32),
+		static_cast<std::uint32_t>(words[0]) }};
+	philox_ctr = {{ static_cast<std::uint32_t>(words[1]),
+		static_cast<std::uint32_t>(words[1] >> 32), 0, 0 }};
+	philox_buf = {{ 0, 0 }};
+	philox_used = 2; // no outputs buffered
+}
+
+void Engine::philoxBlock()
+{
+	// the rounds are shared with the counter-based sampling of device_rng.h
+	std::array<std::uint32_t, 4> c{ philox_ctr };
+	DevicePhilox4x32(c.data(), philox_key[0], philox_key[1]);
+
+	philox_buf = {{ (std::uint64_t(c[0]) << 32) | c[1],
+		(std::uint64_t(c[2]) << 32) | c[3] }};
+	philox_used = 0;
+
+	// increment the 128-bit counter
+	for(std::size_t j = 0; j < 4; ++j)
+		if(++philox_ctr[j] != 0)
+			break;
+}
+
+Engine::result_type Engine::operator()()
+{
+	switch(engine_kind)
+	{
+	case EngineKind::PCG64:
+		return pcgNext(pcg);
+
+	case EngineKind::Philox4x32:
+		if(philox_used == 2)
+			philoxBlock();
+		return philox_buf[philox_used++];
+
+	case EngineKind::Xoshiro256pp:
+	default:
+		return xoshiroNext(xoshiro);
+	}
+}
+
+void Engine::discard(unsigned long long z)
+{
+	switch(engine_kind)
+	{
+	case EngineKind::PCG64:
+		pcgAdvance(pcg, { 0, z });
+		break;
+
+	case EngineKind::Philox4x32:
+		// use the buffered outputs, then skip whole blocks
+		while(z > 0 && philox_used < 2)
+		{
+			++philox_used;
+			--z;
+		}
+		if(z > 0)
+		{
+			std::uint64_t blocks{ z / 2 };
+			for(std::size_t j = 0; j < 4 && blocks != 0; ++j)
+			{
+				const std::uint64_t sum{ philox_ctr[j] + (blocks & 0xFFFFFFFFu) };
+				philox_ctr[j] = static_cast<std::uint32_t>(sum);
+				blocks = (blocks >> 32) + (sum >> 32);
+			}
+			if(z % 2 == 1)
+			{
+				philoxBlock();
+				philox_used = 1;
+			}
+		}
+		break;
+
+	case EngineKind::Xoshiro256pp:
+	default:
+		for(; z > 0; --z)
+			xoshiroNext(xoshiro);
+		break;
+	}
+}
+
+void Engine::jump(result_type n)
+{
+	switch(engine_kind)
+	{
+	case EngineKind::PCG64:
+		// jump by n * 2^64 steps
+		pcgAdvance(pcg, { n, 0 });
+		break;
+
+	case EngineKind::Philox4x32:
+	{
+		// jump by n * 2^64 blocks (the upper half of the counter)
+		const std::uint64_t upper{ ((std::uint64_t(philox_ctr[3]) << 32) |
+			philox_ctr[2]) + n };
+		philox_ctr[2] = static_cast<std::uint32_t>(upper);
+		philox_ctr[3] = static_cast<std::uint32_t>(upper >> 32);
+		philox_used = 2;
+		break;
+	}
+
+	case EngineKind::Xoshiro256pp:
+	default:
+	{
+		// jump by 2^128 steps, n times
+		static const std::array<std::uint64_t, 4> jump_poly{{
+			0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+			0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull }};
+
+		for(; n > 0; --n)
+		{
+			std::array<std::uint64_t, 4> s{{ 0, 0, 0, 0 }};
+
+			for(const std::uint64_t word : jump_poly)
+			{
+				for(int b = 0; b < 64; ++b)
+				{
+					if(word & (std::uint64_t(1) << b))
+					{
+						for(std::size_t j = 0; j < 4; ++j)
+							s[j] ^= xoshiro[j];
+					}
+					xoshiroNext(xoshiro);
+				}
+			}
+
+			xoshiro = s;
+		}
+		break;
+	}
+	}
+}
+
+Engine Engine::stream(result_type n) const
+{
+	Engine ret{ *this };
+	ret.jump(n);
+	return ret;
+}
+
+EngineKind Engine::kind() const noexcept
+{
+	return engine_kind;
+}
+
+std::string Engine::info() const
+{
+	return EngineKindName(engine_kind);
+}
+
+std::ostream &operator<<(std::ostream &out, const Engine &engine)
+{
+	// the state of every algorithm is written, whichever is in use
+	out << static_cast<int>(engine.engine_kind);
+	for(const std::uint64_t word : engine.xoshiro)
+		out << ' ' << word;
+	for(const std::uint64_t word : engine.pcg)
+		out << ' ' << word;
+	for(const std::uint32_t word : engine.philox_ctr)
+		out << ' ' << word;
+	for(const std::uint32_t word : engine.philox_key)
+		out << ' ' << word;
+	for(const std::uint64_t word : engine.philox_buf)
+		out << ' ' << word;
+	out << ' ' << engine.philox_used;
+
+	return out;
+}
+
+std::istream &operator>>(std::istream &in, Engine &engine)
+{
+	Engine ret;
+	int kind;
+
+	in >> kind;
+	for(std::uint64_t &word : ret.xoshiro)
+		in >> word;
+	for(std::uint64_t &word : ret.pcg)
+		in >> word;
+	for(std::uint32_t &word : ret.philox_ctr)
+		in >> word;
+	for(std::uint32_t &word : ret.philox_key)
+		in >> word;
+	for(std::uint64_t &word : ret.philox_buf)
+		in >> word;
+	in >> ret.philox_used;
+
+	if(in && kind >= static_cast<int>(EngineKind::Xoshiro256pp) &&
+		kind <= static_cast<int>(EngineKind::Philox4x32) &&
+		ret.philox_used <= 2)
+	{
+		ret.engine_kind = static_cast<EngineKind>(kind);
+		engine = ret;
+	}
+	else
+		in.setstate(std::ios_base::failbit);
+
+	return in;
+}
+
+} // namespace molstat
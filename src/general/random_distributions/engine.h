@@ -0,0 +1,247 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file engine.h
+ * \brief Random number engines (bit generators) with support for
+ *    independent streams.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __engine_h__
+#define __engine_h__
+
+#include <cstdint>
+#include <array>
+#include <iosfwd>
+#include <random>
+#include <string>
+
+namespace molstat {
+
+/// The random number generation algorithms available in molstat::Engine.
+enum class EngineKind
+{
+	/// xoshiro256++ (Blackman and Vigna); the default.
+	Xoshiro256pp,
+
+	/// PCG64 (XSL-RR output on a 128-bit LCG; O'Neill).
+	PCG64,
+
+	/// Philox4x32-10 (counter-based; Salmon et al.).
+	Philox4x32
+};
+
+/**
+ * \brief Gets the engine kind from its name.
+ *
+ * Names are case insensitive: `xoshiro256++` (or `xoshiro`), `pcg64` (or
+ * `pcg`), and `philox4x32` (or `philox`).
+ *
+ * \throw std::invalid_argument if the name is not recognized.
+ *
+ * \param[in] name The name of the engine.
+ * \return The kind of engine.
+ */
+EngineKind EngineKindFromName(const std::string &name);
+
+/**
+ * \brief Gets the name of an engine kind.
+ *
+ * \param[in] kind The kind of engine.
+ * \return The name of the algorithm.
+ */
+std::string EngineKindName(EngineKind kind);
+
+/**
+ * \brief Random number engine producing 64-bit values.
+ *
+ * This class satisfies the C++11 requirements of a uniform random bit
+ * generator, so that it can be used with the distributions in `<random>`.
+ * The underlying algorithm is selected at construction.
+ *
+ * Independent streams for parallel workers are obtained with jump() or
+ * stream(). Each jump advances the engine by a fixed, very large number of
+ * steps (\f$2^{128}\f$ for xoshiro256++, \f$2^{64}\f$ for PCG64, and
+ * \f$2^{64}\f$ blocks for Philox4x32), so streams from the same seed do not
+ * overlap in practice. Streams are reproducible: the same seed, kind, and
+ * stream number always produce the same sequence.
+ */
+class Engine
+{
+public:
+	/// The type of the generated values.
+	using result_type = std::uint64_t;
+
+	/// The default engine kind.
+	static const EngineKind default_kind;
+
+	/// The seed used by the default constructor.
+	static const result_type default_seed;
+
+	/**
+	 * \brief The smallest value produced.
+	 *
+	 * \return 0.
+	 */
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+
+	/**
+	 * \brief The largest value produced.
+	 *
+	 * \return \f$2^{64}-1\f$.
+	 */
+	static constexpr result_type max()
+	{
+		return ~result_type(0);
+	}
+
+private:
+	/// The kind of engine.
+	EngineKind engine_kind;
+
+	/// State for xoshiro256++.
+	std::array<std::uint64_t, 4> xoshiro;
+
+	/// State for PCG64: the 128-bit state and increment (high, low words).
+	std::array<std::uint64_t, 4> pcg;
+
+	/// The 128-bit counter for Philox4x32.
+	std::array<std::uint32_t, 4> philox_ctr;
+
+	/// The 64-bit key for Philox4x32.
+	std::array<std::uint32_t, 2> philox_key;
+
+	/// The outputs of the current Philox4x32 block.
+	std::array<std::uint64_t, 2> philox_buf;
+
+	/// The number of outputs of the current Philox4x32 block already used.
+	unsigned philox_used;
+
+	/**
+	 * \brief Sets the state from four 64-bit words of seed material.
+	 *
+	 * \param[in] words The seed material.
+	 */
+	void seedWords(const std::array<std::uint64_t, 4> &words);
+
+	/**
+	 * \brief Sets the state from a seed sequence.
+	 *
+	 * \param[in,out] seq The seed sequence.
+	 */
+	void seedSequence(std::seed_seq &seq);
+
+	/// Computes the next Philox4x32 block and advances the counter.
+	void philoxBlock();
+
+public:
+	/// Constructs the default engine kind with the default seed.
+	Engine();
+
+	/**
+	 * \brief Constructor specifying the seed and (optionally) the kind.
+	 *
+	 * \param[in] seed The seed.
+	 * \param[in] kind The kind of engine.
+	 */
+	explicit Engine(result_type seed, EngineKind kind = default_kind);
+
+	/**
+	 * \brief Constructor for one of several independently seeded engines
+	 *    sharing a seed (for instance, one per job in a set of runs).
+	 *
+	 * The seed and the substream number are combined through std::seed_seq.
+	 * Each substream can be further divided with jump() or stream().
+	 *
+	 * \param[in] seed The seed.
+	 * \param[in] substream The substream number.
+	 * \param[in] kind The kind of engine.
+	 */
+	Engine(result_type seed, result_type substream, EngineKind kind);
+
+	/**
+	 * \brief Constructor seeding from a seed sequence.
+	 *
+	 * \param[in,out] seq The seed sequence.
+	 * \param[in] kind The kind of engine.
+	 */
+	explicit Engine(std::seed_seq &seq, EngineKind kind = default_kind);
+
+	/**
+	 * \brief Generates the next random value.
+	 *
+	 * \return The random value.
+	 */
+	result_type operator()();
+
+	/**
+	 * \brief Advances the engine.
+	 *
+	 * \param[in] z The number of values to skip.
+	 */
+	void discard(unsigned long long z);
+
+	/**
+	 * \brief Jumps the engine ahead to the start of a later stream.
+	 *
+	 * \param[in] n The number of streams to jump.
+	 */
+	void jump(result_type n = 1);
+
+	/**
+	 * \brief Gets a copy of this engine jumped ahead `n` streams.
+	 *
+	 * \param[in] n The stream number, relative to this engine.
+	 * \return The engine for the stream.
+	 */
+	Engine stream(result_type n) const;
+
+	/**
+	 * \brief Gets the kind of engine.
+	 *
+	 * \return The kind.
+	 */
+	EngineKind kind() const noexcept;
+
+	/**
+	 * \brief A short description of the engine.
+	 *
+	 * \return The name of the algorithm.
+	 */
+	std::string info() const;
+
+	/**
+	 * \brief Writes the state of an engine (as text), like the engines of
+	 *    the C++ standard library.
+	 *
+	 * \param[in,out] out The output stream.
+	 * \param[in] engine The engine.
+	 * \return The output stream.
+	 */
+	friend std::ostream &operator<<(std::ostream &out, const Engine &engine);
+
+	/**
+	 * \brief Reads the state of an engine written by operator<<.
+	 *
+	 * The engine continues the sequence of the engine that was written. If
+	 * the state cannot be read, the failbit of the stream is set and the
+	 * engine is unchanged.
+	 *
+	 * \param[in,out] in The input stream.
+	 * \param[out] engine The engine.
+	 * \return The input stream.
+	 */
+	friend std::istream &operator>>(std::istream &in, Engine &engine);
+};
+
+} // namespace molstat
+
+#endif
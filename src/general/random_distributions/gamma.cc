@@ -12,6 +12,8 @@
  */
 
 #include "gamma.h"
+#include <cmath>
+#include <limits>
 
 namespace molstat {
 
@@ -25,7 +27,36 @@ GammaDistribution::GammaDistribution(const double shape, const double scale)
 
 double GammaDistribution::sample(Engine &engine) const
 {
-	return dist(engine);
+	std::gamma_distribution<double> local{ dist.param() };
+
+	return local(engine);
+}
+
+void GammaDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	// the rejection algorithm does not transform into a simple loop; but a
+	// single local distribution is used for all of the samples
+	std::gamma_distribution<double> local{ dist.param() };
+
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = local(engine);
+}
+
+bool GammaDistribution::hasDensity() const
+{
+	return true;
+}
+
+void GammaDistribution::log_density_n(const double *x, double *out,
+	std::size_t n) const
+{
+	const double shape{ dist.alpha() }, scale{ dist.beta() };
+	const double lognorm{ std::lgamma(shape) + shape * std::log(scale) };
+
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = x[j] > 0. ? (shape - 1.) * std::log(x[j]) - x[j] / scale -
+			lognorm : -std::numeric_limits<double>::infinity();
 }
 
 std::string GammaDistribution::info() const
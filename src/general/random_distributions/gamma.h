@@ -26,8 +26,14 @@ namespace molstat {
 class GammaDistribution : public RandomDistribution
 {
 protected:
-	/// The C++11 gamma distribution
-	mutable std::gamma_distribution<double> dist;
+	/**
+	 * \brief The C++11 gamma distribution.
+	 *
+	 * Only the parameters of `dist` are used; each call to sample() draws
+	 * from a local copy so that concurrent calls (with different engines) are
+	 * safe.
+	 */
+	const std::gamma_distribution<double> dist;
 
 public:
 	GammaDistribution() = delete;
@@ -46,6 +52,14 @@ public:
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual bool hasDensity() const override;
+
+	virtual void log_density_n(const double *x, double *out, std::size_t n)
+		const override;
+
 	virtual std::string info() const override;
 };
 
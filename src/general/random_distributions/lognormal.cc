@@ -12,9 +12,26 @@
  */
 
 #include "lognormal.h"
+#include "normal.h"
+#include <cmath>
+#include <limits>
+#include <general/batch_kernels.h>
 
 namespace molstat {
 
+namespace {
+
+/// \cond
+MOLSTAT_BATCH_KERNEL
+void ExpAffineKernel(std::size_t n, double zeta, double sigma, double *x)
+{
+	for(std::size_t j = 0; j < n; ++j)
+		x[j] = std::exp(zeta + sigma * x[j]);
+}
+/// \endcond
+
+} // anonymous namespace
+
 LognormalDistribution::LognormalDistribution(const double zeta,
 	const double sigma)
 	: RandomDistribution(), dist(zeta, sigma)
@@ -26,7 +43,65 @@ LognormalDistribution::LognormalDistribution(const double zeta,
 
 double LognormalDistribution::sample(Engine &engine) const
 {
-	return dist(engine);
+	std::lognormal_distribution<double> local{ dist.param() };
+
+	return local(engine);
+}
+
+void LognormalDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	sample_standard_normal_n(engine, out, n);
+	ExpAffineKernel(n, dist.m(), dist.s(), out);
+}
+
+bool LognormalDistribution::hasQuantile() const
+{
+	return true;
+}
+
+void LognormalDistribution::quantile_n(const double *u, double *out,
+	std::size_t n) const
+{
+	const double zeta{ dist.m() }, sigma{ dist.s() };
+
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = std::exp(zeta + sigma * standard_normal_quantile(u[j]));
+}
+
+bool LognormalDistribution::hasDensity() const
+{
+	return true;
+}
+
+void LognormalDistribution::log_density_n(const double *x, double *out,
+	std::size_t n) const
+{
+	// log(sqrt(2 pi))
+	constexpr double log_sqrt2pi{ 0.91893853320467274178032973640561764 };
+	const double zeta{ dist.m() }, inverse{ 1. / dist.s() };
+	const double lognorm{ std::log(dist.s()) + log_sqrt2pi };
+
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		if(!(x[j] > 0.))
+		{
+			out[j] = -std::numeric_limits<double>::infinity();
+			continue;
+		}
+
+		const double logx{ std::log(x[j]) };
+		const double z{ (logx - zeta) * inverse };
+		out[j] = -0.5 * z * z - lognorm - logx;
+	}
+}
+
+bool LognormalDistribution::getDeviceDistribution(
+	DeviceDistribution &dev) const
+{
+	dev = DeviceDistribution{ DeviceDistribution::Lognormal, dist.m(),
+		dist.s() };
+	return true;
 }
 
 std::string LognormalDistribution::info() const
@@ -0,0 +1,341 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file multivariate_normal.cc
+ * \brief Implementation of the multivariate normal distribution.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "multivariate_normal.h"
+#include "normal.h"
+#include <algorithm>
+#include <cmath>
+
+namespace molstat {
+
+MultivariateNormalDistribution::MultivariateNormalDistribution(
+	const std::vector<double> &means_, const std::vector<double> &covariance_)
+	: means(means_), covariance(covariance_), cholesky(covariance_.size(), 0.)
+{
+	const std::size_t k{ means.size() };
+
+	if(k == 0 || covariance.size() != k * k)
+		throw std::invalid_argument("Multivariate Normal Distribution: The " \
+			"covariance matrix must have the dimension of the means.");
+
+	for(std::size_t i = 0; i < k; ++i)
+		for(std::size_t j = 0; j < i; ++j)
+			if(std::abs(covariance[i*k + j] - covariance[j*k + i]) >
+				1.e-12 * (std::abs(covariance[i*k + j]) +
+					std::abs(covariance[j*k + i])))
+			{
+				throw std::invalid_argument("Multivariate Normal Distribution: " \
+					"The covariance matrix must be symmetric.");
+			}
+
+	// Cholesky--Banachiewicz, from the lower triangle
+	for(std::size_t i = 0; i < k; ++i)
+	{
+		for(std::size_t j = 0; j <= i; ++j)
+		{
+			double sum{ covariance[i*k + j] };
+			for(std::size_t m = 0; m < j; ++m)
+				sum -= cholesky[i*k + m] * cholesky[j*k + m];
+
+			if(j < i)
+				cholesky[i*k + j] = sum / cholesky[j*k + j];
+			else if(sum > 0.)
+				cholesky[i*k + i] = std::sqrt(sum);
+			else
+				throw std::invalid_argument("Multivariate Normal Distribution: " \
+					"The covariance matrix must be positive definite.");
+		}
+	}
+}
+
+std::size_t MultivariateNormalDistribution::dimension() const noexcept
+{
+	return means.size();
+}
+
+std::shared_ptr<const MultivariateNormalDistribution>
+	MultivariateNormalDistribution::marginal(
+	const std::vector<std::size_t> &components) const
+{
+	const std::size_t k{ means.size() }, n{ components.size() };
+	std::vector<double> submeans(n), subcovariance(n * n);
+
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		submeans[i] = means[components[i]];
+		for(std::size_t j = 0; j < n; ++j)
+			subcovariance[i*n + j] = covariance[components[i]*k + components[j]];
+	}
+
+	return std::make_shared<const MultivariateNormalDistribution>(submeans,
+		subcovariance);
+}
+
+void MultivariateNormalDistribution::sample(Engine &engine, double *params,
+	const std::vector<std::size_t> &slots) const
+{
+	const std::size_t k{ means.size() };
+
+	for(std::size_t i = 0; i < k; ++i)
+		sample_standard_normal_n(engine, params + slots[i], 1);
+
+	// component i only uses the standard normals of components 0, ..., i, so
+	// the transformation is done in place from the last component
+	for(std::size_t i = k; i-- > 0;)
+	{
+		double value{ means[i] };
+		for(std::size_t m = 0; m <= i; ++m)
+			value += cholesky[i*k + m] * params[slots[m]];
+		params[slots[i]] = value;
+	}
+}
+
+void MultivariateNormalDistribution::sample_n(Engine &engine, double *params,
+	std::size_t ntrials, const std::vector<std::size_t> &slots) const
+{
+	const std::size_t k{ means.size() };
+
+	for(std::size_t i = 0; i < k; ++i)
+		sample_standard_normal_n(engine, params + slots[i]*ntrials, ntrials);
+
+	correlate_n(params, ntrials, slots);
+}
+
+void MultivariateNormalDistribution::quantile_n(double *params,
+	std::size_t ntrials, const std::vector<std::size_t> &slots) const
+{
+	const std::size_t k{ means.size() };
+
+	for(std::size_t i = 0; i < k; ++i)
+	{
+		double *const row{ params + slots[i]*ntrials };
+		for(std::size_t t = 0; t < ntrials; ++t)
+			row[t] = standard_normal_quantile(row[t]);
+	}
+
+	correlate_n(params, ntrials, slots);
+}
+
+void MultivariateNormalDistribution::correlate_n(double *params,
+	std::size_t ntrials, const std::vector<std::size_t> &slots) const
+{
+	const std::size_t k{ means.size() };
+
+	// as in sample(), row i is formed from rows 0, ..., i
+	for(std::size_t i = k; i-- > 0;)
+	{
+		double *const row{ params + slots[i]*ntrials };
+		const double diag{ cholesky[i*k + i] };
+
+		for(std::size_t t = 0; t < ntrials; ++t)
+			row[t] = means[i] + diag * row[t];
+
+		for(std::size_t m = 0; m < i; ++m)
+		{
+			const double *const zrow{ params + slots[m]*ntrials };
+			const double lim{ cholesky[i*k + m] };
+
+			for(std::size_t t = 0; t < ntrials; ++t)
+				row[t] += lim * zrow[t];
+		}
+	}
+}
+
+std::string MultivariateNormalDistribution::info() const
+{
+	const std::size_t k{ means.size() };
+	std::string ret{ "Multivariate Normal: means = (" };
+
+	for(std::size_t i = 0; i < k; ++i)
+		ret += (i == 0 ? "" : ", ") + std::to_string(means[i]);
+	ret += ") and covariance = (";
+	for(std::size_t i = 0; i < k * k; ++i)
+		ret += (i == 0 ? "" : (i % k == 0 ? "; " : ", ")) +
+			std::to_string(covariance[i]);
+
+	return ret + ").";
+}
+
+MultivariateNormalComponent::MultivariateNormalComponent(
+	std::shared_ptr<const MultivariateNormalDistribution> joint_,
+	const std::size_t index_)
+	: RandomDistribution(), joint(joint_), index(index_)
+{
+	if(joint == nullptr || index >= joint->dimension())
+		throw std::invalid_argument("Multivariate Normal Component: Invalid " \
+			"component.");
+}
+
+const std::shared_ptr<const MultivariateNormalDistribution> &
+	MultivariateNormalComponent::getJoint() const noexcept
+{
+	return joint;
+}
+
+std::size_t MultivariateNormalComponent::getIndex() const noexcept
+{
+	return index;
+}
+
+double MultivariateNormalComponent::sample(Engine &engine) const
+{
+	double ret;
+	sample_n(engine, &ret, 1);
+
+	return ret;
+}
+
+void MultivariateNormalComponent::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	const std::size_t k{ joint->dimension() };
+	const double mean{ joint->means[index] },
+		stdev{ std::sqrt(joint->covariance[index*k + index]) };
+
+	sample_standard_normal_n(engine, out, n);
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = mean + stdev * out[j];
+}
+
+bool MultivariateNormalComponent::hasQuantile() const
+{
+	return true;
+}
+
+void MultivariateNormalComponent::quantile_n(const double *u, double *out,
+	std::size_t n) const
+{
+	const std::size_t k{ joint->dimension() };
+	const double mean{ joint->means[index] },
+		stdev{ std::sqrt(joint->covariance[index*k + index]) };
+
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = mean + stdev * standard_normal_quantile(u[j]);
+}
+
+std::string MultivariateNormalComponent::info() const
+{
+	return "Component " + std::to_string(index) + " of " + joint->info();
+}
+
+bool IsJointComponent(const RandomDistribution &dist)
+{
+	return dynamic_cast<const MultivariateNormalComponent *>(&dist) != nullptr;
+}
+
+std::vector<JointParameters> GroupJointComponents(
+	const std::shared_ptr<const RandomDistribution> *dists, std::size_t n)
+{
+	// the joint distribution and components of each group
+	std::vector<const MultivariateNormalDistribution *> joints;
+	std::vector<std::vector<std::size_t>> components;
+	std::vector<std::vector<std::size_t>> slots;
+
+	for(std::size_t p = 0; p < n; ++p)
+	{
+		const MultivariateNormalComponent *comp
+			{ dynamic_cast<const MultivariateNormalComponent *>(dists[p].get()) };
+		if(comp == nullptr)
+			continue;
+
+		// add the slot to the first group of the joint distribution that does
+		// not yet have the component
+		std::size_t g{ 0 };
+		for(; g < joints.size(); ++g)
+		{
+			if(joints[g] == comp->getJoint().get() &&
+				std::find(components[g].begin(), components[g].end(),
+					comp->getIndex()) == components[g].end())
+			{
+				break;
+			}
+		}
+		if(g == joints.size())
+		{
+			joints.push_back(comp->getJoint().get());
+			components.emplace_back();
+			slots.emplace_back();
+		}
+
+		components[g].push_back(comp->getIndex());
+		slots[g].push_back(p);
+	}
+
+	std::vector<JointParameters> ret(joints.size());
+	for(std::size_t g = 0; g < joints.size(); ++g)
+	{
+		ret[g].dist = joints[g]->marginal(components[g]);
+		ret[g].slots = std::move(slots[g]);
+	}
+
+	return ret;
+}
+
+std::vector<std::shared_ptr<const RandomDistribution>>
+	JointDistributionFactory(std::size_t dimension, TokenContainer &&tokens)
+{
+	std::vector<std::shared_ptr<const RandomDistribution>> ret;
+
+	if(tokens.size() == 0)
+		throw std::invalid_argument("Empty line.");
+
+	// the first token is the type of distribution to form
+	const std::string type{ to_lower(tokens.front()) };
+	tokens.pop();
+
+	if(type == "mvnormal")
+	{
+		// the means, followed by the covariance matrix (row-major)
+		if(tokens.size() < dimension * (dimension + 1))
+			throw std::invalid_argument("Invalid multivariate normal " \
+				"distribution. Use\n" \
+				"   mvnormal means covariance\n" \
+				"where means are the " + std::to_string(dimension) +
+				" means and covariance is the " + std::to_string(dimension) +
+				"x" + std::to_string(dimension) + " covariance matrix " \
+				"(row-major).");
+
+		std::vector<double> values(dimension * (dimension + 1));
+		for(double &value : values)
+		{
+			try
+			{
+				value = cast_string<double>(tokens.front());
+			}
+			catch(const std::bad_cast &e)
+			{
+				throw std::invalid_argument("Unable to convert \"" +
+					tokens.front() + "\" to a numeric value.");
+			}
+			tokens.pop();
+		}
+
+		const std::shared_ptr<const MultivariateNormalDistribution> joint
+			{ std::make_shared<const MultivariateNormalDistribution>(
+				std::vector<double>(values.begin(), values.begin() + dimension),
+				std::vector<double>(values.begin() + dimension, values.end())) };
+
+		for(std::size_t i = 0; i < dimension; ++i)
+			ret.push_back(
+				std::make_shared<const MultivariateNormalComponent>(joint, i));
+	}
+	else
+		throw std::invalid_argument(
+			"Unrecognized joint probability distribution: \"" + type + "\".\n" \
+			"Possible options are:\n" \
+			"   MVNormal - Multivariate normal distribution.\n");
+
+	return ret;
+}
+
+} // namespace molstat
@@ -0,0 +1,266 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file multivariate_normal.h
+ * \brief Interface for the multivariate normal distribution, which samples
+ *    several correlated model parameters together.
+ *
+ * A molstat::MultivariateNormalDistribution is shared by several parameter
+ * slots through its components (molstat::MultivariateNormalComponent), each
+ * of which is an ordinary molstat::RandomDistribution. The components that a
+ * model (or submodel) uses are grouped (see GroupJointComponents()) and
+ * sampled together, so that the parameters are correlated within each
+ * trial. A component sampled on its own has the marginal (normal)
+ * distribution.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __multivariate_normal_h__
+#define __multivariate_normal_h__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "rng.h"
+
+namespace molstat {
+
+/// Multivariate normal distribution.
+class MultivariateNormalDistribution
+{
+protected:
+	/// The means.
+	const std::vector<double> means;
+
+	/// The covariance matrix (row-major).
+	const std::vector<double> covariance;
+
+	/**
+	 * \brief The lower-triangular Cholesky factor of the covariance matrix
+	 *    (row-major), so that the covariance is `L L^T`.
+	 */
+	std::vector<double> cholesky;
+
+	/**
+	 * \brief Transforms standard normal random numbers for a batch of trials
+	 *    by the Cholesky factor, in place.
+	 *
+	 * \param[in,out] params The parameters, laid out as in sample_n().
+	 * \param[in] ntrials The number of trials.
+	 * \param[in] slots The slot of each component.
+	 */
+	void correlate_n(double *params, std::size_t ntrials,
+		const std::vector<std::size_t> &slots) const;
+
+public:
+	MultivariateNormalDistribution() = delete;
+	~MultivariateNormalDistribution() = default;
+
+	/**
+	 * \brief Constructor specifying the means and the covariance matrix.
+	 *
+	 * \throw std::invalid_argument if the covariance matrix does not have the
+	 *    dimension of the means, or is not symmetric positive definite.
+	 *
+	 * \param[in] means_ The means.
+	 * \param[in] covariance_ The covariance matrix (row-major).
+	 */
+	MultivariateNormalDistribution(const std::vector<double> &means_,
+		const std::vector<double> &covariance_);
+
+	/**
+	 * \brief Gets the number of components.
+	 *
+	 * \return The dimension of the distribution.
+	 */
+	std::size_t dimension() const noexcept;
+
+	/**
+	 * \brief Gets the marginal distribution of some of the components.
+	 *
+	 * \param[in] components The components, in the order of the marginal
+	 *    distribution.
+	 * \return The marginal distribution.
+	 */
+	std::shared_ptr<const MultivariateNormalDistribution> marginal(
+		const std::vector<std::size_t> &components) const;
+
+	/**
+	 * \brief Samples each component into a slot of a set of parameters.
+	 *
+	 * \param[in] engine The random number engine.
+	 * \param[in,out] params The parameters; component `i` is stored in
+	 *    `params[slots[i]]`.
+	 * \param[in] slots The slot of each component.
+	 */
+	void sample(Engine &engine, double *params,
+		const std::vector<std::size_t> &slots) const;
+
+	/**
+	 * \brief Samples each component for a batch of trials.
+	 *
+	 * The standard normal random numbers for each component are drawn as a
+	 * batch and then transformed by the Cholesky factor, row by row.
+	 *
+	 * \param[in] engine The random number engine.
+	 * \param[in,out] params The parameters (parameter-major); component `i`
+	 *    for trial `t` is stored in `params[slots[i]*ntrials + t]`.
+	 * \param[in] ntrials The number of trials.
+	 * \param[in] slots The slot of each component.
+	 */
+	void sample_n(Engine &engine, double *params, std::size_t ntrials,
+		const std::vector<std::size_t> &slots) const;
+
+	/**
+	 * \brief Transforms uniform random numbers into samples of each component
+	 *    for a batch of trials.
+	 *
+	 * Each uniform random number is mapped to a standard normal one by the
+	 * quantile function, and these are then transformed by the Cholesky
+	 * factor as in sample_n(). Component `i` therefore depends on the
+	 * uniform random numbers of components 0, ..., `i`.
+	 *
+	 * \param[in,out] params The parameters (parameter-major); on input,
+	 *    `params[slots[i]*ntrials + t]` is a uniform random number in (0, 1),
+	 *    and on output it is component `i` for trial `t`.
+	 * \param[in] ntrials The number of trials.
+	 * \param[in] slots The slot of each component.
+	 */
+	void quantile_n(double *params, std::size_t ntrials,
+		const std::vector<std::size_t> &slots) const;
+
+	/**
+	 * \brief A description of this distribution.
+	 *
+	 * \return A string containing the description.
+	 */
+	std::string info() const;
+
+	// components sample their marginal distributions
+	friend class MultivariateNormalComponent;
+};
+
+/**
+ * \brief One component of a molstat::MultivariateNormalDistribution, for
+ *    one model parameter.
+ */
+class MultivariateNormalComponent : public RandomDistribution
+{
+protected:
+	/// The joint distribution.
+	const std::shared_ptr<const MultivariateNormalDistribution> joint;
+
+	/// The component.
+	const std::size_t index;
+
+public:
+	MultivariateNormalComponent() = delete;
+	~MultivariateNormalComponent() = default;
+
+	/**
+	 * \brief Constructor specifying the joint distribution and the
+	 *    component.
+	 *
+	 * \param[in] joint_ The joint distribution.
+	 * \param[in] index_ The component.
+	 */
+	MultivariateNormalComponent(
+		std::shared_ptr<const MultivariateNormalDistribution> joint_,
+		const std::size_t index_);
+
+	/**
+	 * \brief Gets the joint distribution.
+	 *
+	 * \return The joint distribution.
+	 */
+	const std::shared_ptr<const MultivariateNormalDistribution> &getJoint()
+		const noexcept;
+
+	/**
+	 * \brief Gets the component.
+	 *
+	 * \return The index of the component in the joint distribution.
+	 */
+	std::size_t getIndex() const noexcept;
+
+	/**
+	 * Samples the marginal distribution of this component.
+	 */
+	virtual double sample(Engine &engine) const override;
+
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual bool hasQuantile() const override;
+
+	virtual void quantile_n(const double *u, double *out, std::size_t n)
+		const override;
+
+	virtual std::string info() const override;
+};
+
+/**
+ * \brief A group of parameter slots that are sampled together from a joint
+ *    distribution.
+ */
+struct JointParameters
+{
+	/// The (marginal) joint distribution of the slots.
+	std::shared_ptr<const MultivariateNormalDistribution> dist;
+
+	/// The slot of each component of JointParameters::dist.
+	std::vector<std::size_t> slots;
+};
+
+/**
+ * \brief Determines whether a distribution is a component of a joint
+ *    distribution.
+ *
+ * \param[in] dist The distribution.
+ * \return True if the distribution is a component, false otherwise.
+ */
+bool IsJointComponent(const RandomDistribution &dist);
+
+/**
+ * \brief Groups the slots whose distributions are components of the same
+ *    joint distribution.
+ *
+ * Each group has the marginal distribution of its components. If a
+ * component fills several slots, each is in a different group (and the
+ * slots are independent).
+ *
+ * \param[in] dists The distributions of the slots.
+ * \param[in] n The number of slots.
+ * \return The groups, in the order of their first slots.
+ */
+std::vector<JointParameters> GroupJointComponents(
+	const std::shared_ptr<const RandomDistribution> *dists, std::size_t n);
+
+/**
+ * \brief Factory for joint random number distributions.
+ *
+ * The first token is the name of the distribution, and the remaining
+ * tokens are its parameters. The only joint distribution is
+ * `mvnormal means covariance`, with the `dimension` means followed by the
+ * `dimension * dimension` entries of the covariance matrix (row-major).
+ *
+ * The list of tokens is destroyed by this function.
+ *
+ * \exception std::invalid_argument if the parameters are invalid for the
+ *    specified distribution.
+ *
+ * \param[in] dimension The number of components.
+ * \param[in] tokens The tokens.
+ * \return The components of the distribution.
+ */
+std::vector<std::shared_ptr<const RandomDistribution>>
+	JointDistributionFactory(std::size_t dimension, TokenContainer &&tokens);
+
+} // namespace molstat
+
+#endif
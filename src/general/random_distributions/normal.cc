@@ -12,9 +12,32 @@
  */
 
 #include "normal.h"
+#include <cmath>
+#include <general/batch_kernels.h>
 
 namespace molstat {
 
+namespace {
+
+/// \cond
+constexpr double twopi{ 6.283185307179586476925286766559 };
+
+MOLSTAT_BATCH_KERNEL
+void BoxMullerKernel(std::size_t npairs, double *x)
+{
+	for(std::size_t j = 0; j < npairs; ++j)
+	{
+		const double r = std::sqrt(-2. * std::log(x[2*j]));
+		const double theta = twopi * x[2*j + 1];
+
+		x[2*j] = r * std::cos(theta);
+		x[2*j + 1] = r * std::sin(theta);
+	}
+}
+/// \endcond
+
+} // anonymous namespace
+
 NormalDistribution::NormalDistribution(const double mean, const double stdev)
 	: RandomDistribution(), dist(mean, stdev)
 {
@@ -25,7 +48,115 @@ NormalDistribution::NormalDistribution(const double mean, const double stdev)
 
 double NormalDistribution::sample(Engine &engine) const
 {
-	return dist(engine);
+	std::normal_distribution<double> local{ dist.param() };
+
+	return local(engine);
+}
+
+void NormalDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	sample_standard_normal_n(engine, out, n);
+	affine_n(out, n, dist.mean(), dist.stddev());
+}
+
+void sample_standard_normal_n(Engine &engine, double *out, std::size_t n)
+{
+	const std::size_t npairs{ n / 2 };
+
+	// uniform random numbers in (0, 1), transformed pairwise
+	sample_canonical_n(engine, out, 2 * npairs);
+	BoxMullerKernel(npairs, out);
+
+	// odd number of samples: use one of a final pair
+	if(n % 2 == 1)
+	{
+		double u[2];
+		sample_canonical_n(engine, u, 2);
+		out[n - 1] = std::sqrt(-2. * std::log(u[0])) * std::cos(twopi * u[1]);
+	}
+}
+
+bool NormalDistribution::hasQuantile() const
+{
+	return true;
+}
+
+void NormalDistribution::quantile_n(const double *u, double *out,
+	std::size_t n) const
+{
+	const double mean{ dist.mean() }, stdev{ dist.stddev() };
+
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = mean + stdev * standard_normal_quantile(u[j]);
+}
+
+bool NormalDistribution::hasDensity() const
+{
+	return true;
+}
+
+void NormalDistribution::log_density_n(const double *x, double *out,
+	std::size_t n) const
+{
+	// log(sqrt(2 pi))
+	constexpr double log_sqrt2pi{ 0.91893853320467274178032973640561764 };
+	const double mean{ dist.mean() }, inverse{ 1. / dist.stddev() };
+	const double lognorm{ std::log(dist.stddev()) + log_sqrt2pi };
+
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		const double z{ (x[j] - mean) * inverse };
+		out[j] = -0.5 * z * z - lognorm;
+	}
+}
+
+double standard_normal_quantile(double u)
+{
+	static const double a[6] = { -3.969683028665376e+01, 2.209460984245205e+02,
+		-2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01,
+		2.506628277459239e+00 };
+	static const double b[5] = { -5.447609879822406e+01, 1.615858368580409e+02,
+		-1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+	static const double c[6] = { -7.784894002430293e-03, -3.223964580411365e-01,
+		-2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00,
+		2.938163982698783e+00 };
+	static const double d[4] = { 7.784695709041462e-03, 3.224671290700398e-01,
+		2.445134137142996e+00, 3.754408661907416e+00 };
+	constexpr double plow{ 0.02425 };
+	constexpr double sqrt2pi{ 2.5066282746310005024157652848110452530 };
+
+	double x;
+	if(u < plow || u > 1. - plow)
+	{
+		// the tails, by symmetry
+		const double q{ std::sqrt(-2. * std::log(u < plow ? u : 1. - u)) };
+		x = (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+			((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1.);
+		if(u > 1. - plow)
+			x = -x;
+	}
+	else
+	{
+		const double q{ u - 0.5 }, r{ q * q };
+		x = (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q /
+			(((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1.);
+	}
+
+	// one step of Halley's method; the complementary error function keeps
+	// the error in the lower tail relative
+	const double e{ 0.5 * std::erfc(-x / std::sqrt(2.)) - u };
+	const double step{ e * sqrt2pi * std::exp(0.5 * x * x) };
+
+	return x - step / (1. + 0.5 * x * step);
+}
+
+bool NormalDistribution::getDeviceDistribution(
+	DeviceDistribution &dev) const
+{
+	dev = DeviceDistribution{ DeviceDistribution::Normal, dist.mean(),
+		dist.stddev() };
+	return true;
 }
 
 std::string NormalDistribution::info() const
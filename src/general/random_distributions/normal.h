@@ -26,8 +26,14 @@ namespace molstat {
 class NormalDistribution : public RandomDistribution
 {
 protected:
-	/// The C++11 normal distribution
-	mutable std::normal_distribution<double> dist;
+	/**
+	 * \brief The C++11 normal distribution.
+	 *
+	 * Only the parameters of `dist` are used; each call to sample() draws
+	 * from a local copy so that concurrent calls (with different engines) are
+	 * safe.
+	 */
+	const std::normal_distribution<double> dist;
 
 public:
 	NormalDistribution() = delete;
@@ -45,9 +51,50 @@ public:
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual bool hasQuantile() const override;
+
+	virtual void quantile_n(const double *u, double *out, std::size_t n)
+		const override;
+
+	virtual bool hasDensity() const override;
+
+	virtual void log_density_n(const double *x, double *out, std::size_t n)
+		const override;
+
+	virtual bool getDeviceDistribution(DeviceDistribution &dev) const
+		override;
+
 	virtual std::string info() const override;
 };
 
+/**
+ * \brief Fills an array with standard normal random numbers (mean 0,
+ *    standard deviation 1).
+ *
+ * Uses the Box--Muller transform on pairs of uniform random numbers; the
+ * transform is a simple loop over the array.
+ *
+ * \param[in] engine The random number engine.
+ * \param[out] out Storage for the `n` random numbers.
+ * \param[in] n The number of random numbers to draw.
+ */
+void sample_standard_normal_n(Engine &engine, double *out, std::size_t n);
+
+/**
+ * \brief Evaluates the quantile function of the standard normal
+ *    distribution.
+ *
+ * Uses P.\ J.\ Acklam's rational approximation, refined by one step of
+ * Halley's method, which is accurate to nearly machine precision.
+ *
+ * \param[in] u The probability, in (0, 1).
+ * \return The value below which the probability is `u`.
+ */
+double standard_normal_quantile(double u);
+
 } // namespace molstat
 
 #endif
@@ -0,0 +1,48 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file poisson.cc
+ * \brief Implementation of the Poisson distribution.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "poisson.h"
+
+namespace molstat {
+
+PoissonDistribution::PoissonDistribution(const double mean)
+	: RandomDistribution(), dist(mean > 0. ? mean : 1.)
+{
+	if(!(mean > 0.))
+		throw std::invalid_argument("Poisson Distribution: The mean must be " \
+			"positive.");
+}
+
+double PoissonDistribution::sample(Engine &engine) const
+{
+	std::poisson_distribution<long> local{ dist.param() };
+
+	return local(engine);
+}
+
+void PoissonDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	// a single local distribution is used for all of the samples
+	std::poisson_distribution<long> local{ dist.param() };
+
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = local(engine);
+}
+
+std::string PoissonDistribution::info() const
+{
+	return "Poisson: mean = " + std::to_string(dist.mean()) + ".";
+}
+
+} // namespace molstat
@@ -0,0 +1,66 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file poisson.h
+ * \brief Interface for the Poisson distribution.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __poisson_h__
+#define __poisson_h__
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <random>
+#include "rng.h"
+
+namespace molstat {
+
+/**
+ * \brief Poisson distribution, for counts (e.g., the number of molecules in
+ *    a junction).
+ *
+ * The samples are nonnegative integers (stored as doubles).
+ */
+class PoissonDistribution : public RandomDistribution
+{
+protected:
+	/**
+	 * \brief The C++11 Poisson distribution.
+	 *
+	 * Only the parameters of `dist` are used; each call to sample() draws
+	 * from a local copy so that concurrent calls (with different engines) are
+	 * safe.
+	 */
+	const std::poisson_distribution<long> dist;
+
+public:
+	PoissonDistribution() = delete;
+	~PoissonDistribution() = default;
+
+	/**
+	 * \brief Constructor specifying the mean.
+	 *
+	 * \throw std::invalid_argument if the mean is not positive.
+	 *
+	 * \param[in] mean The mean.
+	 */
+	PoissonDistribution(const double mean);
+
+	virtual double sample(Engine &engine) const override;
+
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual std::string info() const override;
+};
+
+} // namespace molstat
+
+#endif
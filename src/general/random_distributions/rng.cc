@@ -18,11 +18,74 @@
 #include "normal.h"
 #include "lognormal.h"
 #include "gamma.h"
+#include "poisson.h"
+#include "empirical.h"
+#include "truncated.h"
+#include <general/batch_kernels.h>
+#include <algorithm>
+#include <limits>
 
 using namespace std;
 
 namespace molstat {
 
+void RandomDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = sample(engine);
+}
+
+bool RandomDistribution::isConstant(double &value) const
+{
+	return false;
+}
+
+bool RandomDistribution::hasQuantile() const
+{
+	return false;
+}
+
+void RandomDistribution::quantile_n(const double *u, double *out,
+	std::size_t n) const
+{
+	throw logic_error("The quantile function is not implemented for this " \
+		"distribution: " + info());
+}
+
+bool RandomDistribution::hasDensity() const
+{
+	return false;
+}
+
+void RandomDistribution::log_density_n(const double *x, double *out,
+	std::size_t n) const
+{
+	throw logic_error("The density is not implemented for this " \
+		"distribution: " + info());
+}
+
+bool RandomDistribution::getDeviceDistribution(DeviceDistribution &dev) const
+{
+	return false;
+}
+
+void sample_canonical_n(Engine &engine, double *out, std::size_t n)
+{
+	// 2^-53
+	constexpr double scale{ 1.1102230246251565404236316680908203125e-16 };
+
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = (double(engine() >> 11) + 0.5) * scale;
+}
+
+MOLSTAT_BATCH_KERNEL
+void affine_n(double *x, std::size_t n, double shift, double scale)
+{
+	for(std::size_t j = 0; j < n; ++j)
+		x[j] = shift + scale * x[j];
+}
+
 std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 	TokenContainer &&tokens)
 {
@@ -35,6 +98,45 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 	string type = to_lower(tokens.front());
 	tokens.pop();
 
+	// the parameters may be followed by "truncate lower upper", which
+	// restricts the distribution to an interval
+	bool truncated{ false };
+	double tlower{ -numeric_limits<double>::infinity() },
+		tupper{ numeric_limits<double>::infinity() };
+	{
+		TokenContainer params;
+		while(!tokens.empty() && !lower_equals(tokens.front(), "truncate"))
+		{
+			params.push(move(tokens.front()));
+			tokens.pop();
+		}
+
+		if(!tokens.empty())
+		{
+			tokens.pop();
+			if(tokens.size() < 2)
+				throw invalid_argument("Invalid truncation. Use\n" \
+					"   truncate lower upper\n" \
+					"after the distribution's parameters, where lower and upper " \
+					"are the\nbounds (either may be -inf or inf).");
+
+			if(!parse_number(tokens.front(), tlower))
+				throw invalid_argument(
+					"Unable to convert the truncation bounds to numeric values.");
+			tokens.pop();
+			if(!parse_number(tokens.front(), tupper))
+				throw invalid_argument(
+					"Unable to convert the truncation bounds to numeric values.");
+
+			if(!(tlower < tupper))
+				throw invalid_argument("The lower truncation bound must be less " \
+					"than the upper truncation bound.");
+			truncated = true;
+		}
+
+		tokens = move(params);
+	}
+
 	if(type == "constant")
 	{
 		// tokens[0] is the value to return; cast it to a double
@@ -44,15 +146,13 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 				"where value is the value to be returned.");
 
 		double val;
-		try
-		{
-			val = cast_string<double>(tokens.front());
-		}
-		catch(const bad_cast &e)
-		{
+		if(!parse_number(tokens.front(), val))
 			throw invalid_argument(
 				"Unable to convert \"value\" to a numeric value.");
-		}
+
+		if(val < tlower || val > tupper)
+			throw invalid_argument(
+				"The constant value is outside the truncation interval.");
 
 		ret = unique_ptr<RandomDistribution>(new ConstantDistribution(val));
 	}
@@ -66,29 +166,18 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 				"where lower and upper are the bounds, respectively.");
 
 		double lower, upper;
-		try
-		{
-			lower = cast_string<double>(tokens.front());
-		}
-		catch(const bad_cast &e)
-		{
+		if(!parse_number(tokens.front(), lower))
 			throw invalid_argument(
 				"Unable to convert \"lower\" to a numeric value.");
-		}
 		tokens.pop();
 
-		try
-		{
-			upper = cast_string<double>(tokens.front());
-		}
-		catch(const bad_cast &e)
-		{
+		if(!parse_number(tokens.front(), upper))
 			throw invalid_argument(
 				"Unable to convert \"upper\" to a numeric value.");
-		}
 
-		ret = unique_ptr<RandomDistribution>(
-			new UniformDistribution(lower, upper));
+		// a truncated uniform distribution is uniform on the intersection
+		ret = unique_ptr<RandomDistribution>(new UniformDistribution(
+			max(lower, tlower), min(upper, tupper)));
 	}
 	else if(type == "normal" || type == "gaussian")
 	{
@@ -99,29 +188,21 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 				"   normal mean standard-deviation");
 
 		double mean, stdev;
-		try
-		{
-			mean = cast_string<double>(tokens.front());
-		}
-		catch(const bad_cast &e)
-		{
+		if(!parse_number(tokens.front(), mean))
 			throw invalid_argument(
 				"Unable to convert \"mean\" to a numeric value.");
-		}
 		tokens.pop();
 
-		try
-		{
-			stdev = cast_string<double>(tokens.front());
-		}
-		catch(const bad_cast &e)
-		{
+		if(!parse_number(tokens.front(), stdev))
 			throw invalid_argument(
 				"Unable to convert \"stdev\" to a numeric value.");
-		}
 
-		ret = unique_ptr<RandomDistribution>(
-			new NormalDistribution(mean, stdev));
+		if(truncated)
+			ret = unique_ptr<RandomDistribution>(
+				new TruncatedNormalDistribution(mean, stdev, tlower, tupper));
+		else
+			ret = unique_ptr<RandomDistribution>(
+				new NormalDistribution(mean, stdev));
 	}
 	else if(type == "lognormal")
 	{
@@ -132,29 +213,21 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 				"   lognormal zeta sigma");
 
 		double zeta, sigma;
-		try
-		{
-			zeta = cast_string<double>(tokens.front());
-		}
-		catch(const bad_cast &e)
-		{
+		if(!parse_number(tokens.front(), zeta))
 			throw invalid_argument(
 				"Unable to convert \"zeta\" to a numeric value.");
-		}
 		tokens.pop();
 
-		try
-		{
-			sigma = cast_string<double>(tokens.front());
-		}
-		catch(const bad_cast &e)
-		{
+		if(!parse_number(tokens.front(), sigma))
 			throw invalid_argument(
 				"Unable to convert \"sigma\" to a numeric value.");
-		}
 
-		ret = unique_ptr<RandomDistribution>(
-			new LognormalDistribution(zeta, sigma));
+		if(truncated)
+			ret = unique_ptr<RandomDistribution>(
+				new TruncatedLognormalDistribution(zeta, sigma, tlower, tupper));
+		else
+			ret = unique_ptr<RandomDistribution>(
+				new LognormalDistribution(zeta, sigma));
 	}
 	else if(type == "gamma")
 	{
@@ -164,29 +237,57 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 				"   gamma shape scale");
 
 		double shape, scale;
-		try
-		{
-			shape = cast_string<double>(tokens.front());
-		}
-		catch(const bad_cast &e)
-		{
+		if(!parse_number(tokens.front(), shape))
 			throw invalid_argument(
 				"Unable to convert \"shape\" to a numeric value.");
-		}
 		tokens.pop();
 
-		try
-		{
-			scale = cast_string<double>(tokens.front());
-		}
-		catch(const bad_cast &e)
-		{
+		if(!parse_number(tokens.front(), scale))
 			throw invalid_argument(
 				"Unable to convert \"scale\" to a numeric value.");
-		}
 
 		ret = unique_ptr<RandomDistribution>(
 			new GammaDistribution(shape, scale));
+
+		// other truncated distributions are sampled by rejection
+		if(truncated)
+			ret = unique_ptr<RandomDistribution>(
+				new TruncatedDistribution(move(ret), tlower, tupper));
+	}
+	else if(type == "poisson")
+	{
+		// tokens[0] is the mean
+		if(tokens.size() < 1)
+			throw invalid_argument("Invalid Poisson distribution. Use\n" \
+				"   poisson mean");
+
+		double mean;
+		if(!parse_number(tokens.front(), mean))
+			throw invalid_argument(
+				"Unable to convert \"mean\" to a numeric value.");
+
+		ret = unique_ptr<RandomDistribution>(new PoissonDistribution(mean));
+
+		// truncated by rejection
+		if(truncated)
+			ret = unique_ptr<RandomDistribution>(
+				new TruncatedDistribution(move(ret), tlower, tupper));
+	}
+	else if(type == "empirical")
+	{
+		// tokens[0] is the name of the file with the table
+		if(tokens.size() < 1)
+			throw invalid_argument("Invalid empirical distribution. Use\n" \
+				"   empirical filename\n" \
+				"where each line of the file has a bin center and the " \
+				"probability density.");
+
+		ret = ReadEmpiricalDistribution(tokens.front());
+
+		// truncated by rejection
+		if(truncated)
+			ret = unique_ptr<RandomDistribution>(
+				new TruncatedDistribution(move(ret), tlower, tupper));
 	}
 	else
 		throw invalid_argument(
@@ -197,7 +298,9 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 			"   Normal - Normal (Gaussian) distribution.\n" \
 			"   Gaussian - Normal (Gaussian) distribution.\n" \
 			"   Lognormal - Lognormal distribution.\n" \
-			"   Gamma - Gamma distribution.\n");
+			"   Gamma - Gamma distribution.\n" \
+			"   Poisson - Poisson distribution (counts).\n" \
+			"   Empirical - Distribution tabulated in a file.\n");
 
 	return ret;
 }
@@ -18,12 +18,13 @@
 #include <queue>
 #include <string>
 #include <random>
+#include <stdexcept>
 #include <general/string_tools.h>
+#include "engine.h"
+#include "device_rng.h"
 
 namespace molstat {
 
-/// The type of C++11 random number engine to use.
-using Engine = std::default_random_engine;
 
 /// Interface for random number generation.
 class RandomDistribution
@@ -35,11 +36,106 @@ public:
 	/**
 	 * \brief Samples from the random number distribution.
 	 *
+	 * Implementations must not modify shared state, so that several threads
+	 * may sample from the same distribution concurrently (each with its own
+	 * engine).
+	 *
 	 * \param[in] engine The random number engine.
 	 * \return The random number.
 	 */
 	virtual double sample(Engine &engine) const = 0;
 
+	/**
+	 * \brief Draws several samples from the random number distribution.
+	 *
+	 * The default implementation calls sample() `n` times. Distributions
+	 * should override it with a tight loop when they can. The samples need
+	 * not match those from `n` calls to sample() with the same engine state.
+	 *
+	 * \param[in] engine The random number engine.
+	 * \param[out] out Storage for the `n` random numbers.
+	 * \param[in] n The number of random numbers to draw.
+	 */
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const;
+
+	/**
+	 * \brief Determines whether this distribution always returns the same
+	 *    value.
+	 *
+	 * The default implementation returns false.
+	 *
+	 * \param[out] value The value, if the distribution is constant.
+	 * \return True if the distribution is constant, false otherwise.
+	 */
+	virtual bool isConstant(double &value) const;
+
+	/**
+	 * \brief Determines whether this distribution implements quantile_n(),
+	 *    as needed for quasi-Monte Carlo sampling.
+	 *
+	 * The default implementation returns false.
+	 *
+	 * \return True if quantile_n() is implemented, false otherwise.
+	 */
+	virtual bool hasQuantile() const;
+
+	/**
+	 * \brief Evaluates the quantile function (inverse cumulative
+	 *    distribution function) for several probabilities.
+	 *
+	 * Transforming uniform random numbers (or quasi-random points) in (0, 1)
+	 * by the quantile function gives samples from the distribution. `out`
+	 * may be the same as `u`.
+	 *
+	 * \throw std::logic_error if the distribution does not implement it (see
+	 *    hasQuantile()); this is the default.
+	 *
+	 * \param[in] u The probabilities, each in (0, 1).
+	 * \param[out] out Storage for the `n` quantiles.
+	 * \param[in] n The number of probabilities.
+	 */
+	virtual void quantile_n(const double *u, double *out, std::size_t n)
+		const;
+
+	/**
+	 * \brief Determines whether this distribution implements
+	 *    log_density_n(), as needed for importance sampling.
+	 *
+	 * The default implementation returns false.
+	 *
+	 * \return True if log_density_n() is implemented, false otherwise.
+	 */
+	virtual bool hasDensity() const;
+
+	/**
+	 * \brief Evaluates the logarithm of the probability density function at
+	 *    several values.
+	 *
+	 * Values outside the support of the distribution have a log density of
+	 * -infinity. `out` may be the same as `x`.
+	 *
+	 * \throw std::logic_error if the distribution does not implement it (see
+	 *    hasDensity()); this is the default.
+	 *
+	 * \param[in] x The values.
+	 * \param[out] out Storage for the `n` log densities.
+	 * \param[in] n The number of values.
+	 */
+	virtual void log_density_n(const double *x, double *out, std::size_t n)
+		const;
+
+	/**
+	 * \brief Describes this distribution for counter-based sampling (see
+	 *    molstat::DeviceSample), as needed to simulate on an accelerator.
+	 *
+	 * The default implementation returns false.
+	 *
+	 * \param[out] dev The description, if the distribution has one.
+	 * \return True if the distribution can be sampled by
+	 *    molstat::DeviceSample, false otherwise.
+	 */
+	virtual bool getDeviceDistribution(DeviceDistribution &dev) const;
+
 	/**
 	 * \brief A description of this random number distribution.
 	 *
@@ -54,7 +150,9 @@ public:
  * Gets parameters from a tokenized string and forms a RandomDistribution.
  *
  * The first token is the name of the distribution. The remaining tokens are
- * the parameters for the distribution.
+ * the parameters for the distribution. The parameters may be followed by
+ * `truncate lower upper` to restrict the distribution to an interval (see
+ * truncated.h); invalid parameter values are then never sampled.
  *
  * The list of tokens is destroyed by this function.
  *
@@ -67,6 +165,31 @@ public:
 std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 	TokenContainer &&tokens);
 
+/**
+ * \brief Fills an array with uniform random numbers in (0, 1).
+ *
+ * Each number uses the upper 53 bits of one engine value, and is never
+ * exactly 0 or 1.
+ *
+ * \param[in] engine The random number engine.
+ * \param[out] out Storage for the `n` random numbers.
+ * \param[in] n The number of random numbers to draw.
+ */
+void sample_canonical_n(Engine &engine, double *out, std::size_t n);
+
+/**
+ * \brief Shifts and scales an array of random numbers in place,
+ *    \f$x \to a + bx\f$.
+ *
+ * This is a batch kernel (see batch_kernels.h).
+ *
+ * \param[in,out] x The `n` numbers.
+ * \param[in] n The number of numbers.
+ * \param[in] shift The shift, \f$a\f$.
+ * \param[in] scale The scale, \f$b\f$.
+ */
+void affine_n(double *x, std::size_t n, double shift, double scale);
+
 } // namespace molstat
 
 #endif
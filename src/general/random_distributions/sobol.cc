@@ -0,0 +1,127 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sobol.cc
+ * \brief Implementation of the scrambled Sobol sequences.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "sobol.h"
+#include <stdexcept>
+#include <string>
+
+namespace molstat {
+
+/**
+ * \brief The primitive polynomials and initial direction numbers of
+ *    dimensions 2 and up (Joe and Kuo's new-joe-kuo-6.21201).
+ *
+ * Each entry has the degree `s` of the polynomial, its interior coefficients
+ * `a` (as bits, highest degree first), and the `s` initial direction numbers
+ * `m`.
+ */
+static const struct
+{
+	unsigned s;
+	unsigned a;
+	unsigned m[7];
+} joe_kuo[SobolSequence::max_dimension - 1] = {
+	{ 1, 0, { 1 } },
+	{ 2, 1, { 1, 3 } },
+	{ 3, 1, { 1, 3, 1 } },
+	{ 3, 2, { 1, 1, 1 } },
+	{ 4, 1, { 1, 1, 3, 3 } },
+	{ 4, 4, { 1, 3, 5, 13 } },
+	{ 5, 2, { 1, 1, 5, 5, 17 } },
+	{ 5, 4, { 1, 1, 5, 5, 5 } },
+	{ 5, 7, { 1, 1, 7, 11, 19 } },
+	{ 5, 11, { 1, 1, 5, 1, 1 } },
+	{ 5, 13, { 1, 1, 1, 3, 11 } },
+	{ 5, 14, { 1, 3, 5, 5, 31 } },
+	{ 6, 1, { 1, 3, 3, 9, 7, 49 } },
+	{ 6, 13, { 1, 1, 1, 15, 21, 21 } },
+	{ 6, 16, { 1, 3, 1, 13, 27, 49 } },
+	{ 6, 19, { 1, 1, 1, 15, 7, 5 } },
+	{ 6, 22, { 1, 3, 1, 15, 13, 25 } },
+	{ 6, 25, { 1, 1, 5, 5, 19, 61 } },
+	{ 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+	{ 7, 4, { 1, 3, 7, 13, 13, 15, 69 } }
+};
+
+SobolSequence::SobolSequence(std::size_t dimension, const Engine &engine)
+	: directions(dimension * bits), shifts(dimension)
+{
+	if(dimension == 0 || dimension > max_dimension)
+		throw std::invalid_argument("Sobol Sequence: Between 1 and " +
+			std::to_string(max_dimension) + " dimensions are supported.");
+
+	// direction number k (from 0) has its leading bit k+1 places below the
+	// binary point
+	for(std::size_t k = 0; k < bits; ++k)
+		directions[k] = std::uint64_t(1) << (bits - 1 - k);
+
+	for(std::size_t d = 1; d < dimension; ++d)
+	{
+		std::uint64_t *const v{ directions.data() + d*bits };
+		const unsigned s{ joe_kuo[d - 1].s }, a{ joe_kuo[d - 1].a };
+
+		for(std::size_t k = 0; k < s; ++k)
+			v[k] = std::uint64_t(joe_kuo[d - 1].m[k]) << (bits - 1 - k);
+
+		// the recurrence from the primitive polynomial
+		for(std::size_t k = s; k < bits; ++k)
+		{
+			v[k] = v[k - s] ^ (v[k - s] >> s);
+			for(std::size_t i = 1; i < s; ++i)
+				if((a >> (s - 1 - i)) & 1)
+					v[k] ^= v[k - i];
+		}
+	}
+
+	Engine local{ engine };
+	for(std::uint64_t &shift : shifts)
+		shift = local() >> (64 - bits);
+}
+
+std::size_t SobolSequence::dimension() const noexcept
+{
+	return shifts.size();
+}
+
+void SobolSequence::generate(std::uint64_t first, std::size_t n,
+	std::size_t d, double *out) const
+{
+	// 2^-53
+	constexpr double scale{ 1.1102230246251565404236316680908203125e-16 };
+	const std::uint64_t *const v{ directions.data() + d*bits };
+
+	if(n == 0)
+		return;
+
+	// point `first` uses the direction numbers of the bits of its Gray code
+	std::uint64_t x{ 0 };
+	const std::uint64_t gray{ first ^ (first >> 1) };
+	for(std::size_t k = 0; k < bits; ++k)
+		if((gray >> k) & 1)
+			x ^= v[k];
+	out[0] = (double(x ^ shifts[d]) + 0.5) * scale;
+
+	// consecutive Gray codes differ in the lowest set bit of the index
+	for(std::size_t j = 1; j < n; ++j)
+	{
+		std::uint64_t index{ first + j };
+		std::size_t k{ 0 };
+		for(; (index & 1) == 0; index >>= 1)
+			++k;
+
+		x ^= v[k];
+		out[j] = (double(x ^ shifts[d]) + 0.5) * scale;
+	}
+}
+
+} // namespace molstat
@@ -0,0 +1,94 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sobol.h
+ * \brief Scrambled Sobol sequences for quasi-Monte Carlo sampling.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __sobol_h__
+#define __sobol_h__
+
+#include <cstdint>
+#include <vector>
+#include "engine.h"
+
+namespace molstat {
+
+/**
+ * \brief A Sobol sequence with a random digital shift.
+ *
+ * Point `i` of the sequence has one coordinate in (0, 1) for each dimension.
+ * The first dimension is the van der Corput sequence; the others use the
+ * primitive polynomials and initial direction numbers of S.\ Joe and F.\ Y.\
+ * Kuo, SIAM J.\ Sci.\ Comput.\ \b 30, 2635 (2008). Each coordinate has 53
+ * bits, which are XORed with a random shift for its dimension (drawn from an
+ * engine) so that the points are uniformly distributed while keeping the
+ * stratification of the sequence; the coordinate is the center of its
+ * \f$2^{-53}\f$ interval, and is never 0 or 1.
+ *
+ * The first \f$2^m\f$ points of each dimension have exactly one point in
+ * each interval \f$[k 2^{-m}, (k+1) 2^{-m})\f$, so quantities averaged over
+ * the points converge faster than with pseudo-random numbers when they vary
+ * smoothly with the coordinates.
+ */
+class SobolSequence
+{
+public:
+	/// The maximum number of dimensions.
+	static constexpr std::size_t max_dimension = 21;
+
+	/// The number of bits in each coordinate.
+	static constexpr std::size_t bits = 53;
+
+protected:
+	/// The direction numbers, `bits` for each dimension.
+	std::vector<std::uint64_t> directions;
+
+	/// The random shift of each dimension.
+	std::vector<std::uint64_t> shifts;
+
+public:
+	SobolSequence() = delete;
+	~SobolSequence() = default;
+
+	/**
+	 * \brief Constructor specifying the number of dimensions and the engine
+	 *    for the random shifts.
+	 *
+	 * \throw std::invalid_argument if the dimension is 0 or greater than
+	 *    max_dimension.
+	 *
+	 * \param[in] dimension The number of dimensions.
+	 * \param[in] engine The engine; a copy draws the shifts, so that the same
+	 *    engine state always gives the same sequence.
+	 */
+	SobolSequence(std::size_t dimension, const Engine &engine);
+
+	/**
+	 * \brief Gets the number of dimensions.
+	 *
+	 * \return The number of dimensions.
+	 */
+	std::size_t dimension() const noexcept;
+
+	/**
+	 * \brief Generates one coordinate of consecutive points.
+	 *
+	 * \param[in] first The index of the first point.
+	 * \param[in] n The number of points.
+	 * \param[in] d The dimension.
+	 * \param[out] out Storage for the `n` coordinates.
+	 */
+	void generate(std::uint64_t first, std::size_t n, std::size_t d,
+		double *out) const;
+};
+
+} // namespace molstat
+
+#endif
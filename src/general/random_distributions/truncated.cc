@@ -0,0 +1,343 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file truncated.cc
+ * \brief Implementation of the truncated distributions.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "truncated.h"
+#include "normal.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace molstat {
+
+/**
+ * \brief Formats an interval for the descriptions of the distributions.
+ *
+ * \param[in] low The lower bound.
+ * \param[in] up The upper bound.
+ * \return The description.
+ */
+static std::string interval_info(const double low, const double up)
+{
+	return " Truncated to [" + std::to_string(low) + ", " +
+		std::to_string(up) + "].";
+}
+
+TruncatedDistribution::TruncatedDistribution(
+	std::unique_ptr<RandomDistribution> &&dist, const double low,
+	const double up)
+	: RandomDistribution(), base(std::move(dist)), lower(low), upper(up)
+{
+	if(!(lower < upper))
+		throw std::invalid_argument("Truncated Distribution: The lower bound " \
+			"must be less than the upper bound.");
+
+	double value;
+	if(base->isConstant(value) && (value < lower || value > upper))
+		throw std::invalid_argument("Truncated Distribution: The constant " \
+			"value is outside the interval.");
+}
+
+double TruncatedDistribution::sample(Engine &engine) const
+{
+	for(std::size_t attempt = 0; attempt < max_rejections; ++attempt)
+	{
+		const double value{ base->sample(engine) };
+		if(value >= lower && value <= upper)
+			return value;
+	}
+
+	throw std::runtime_error("Truncated Distribution: Unable to draw a " \
+		"value in the interval. " + base->info() + interval_info(lower, upper));
+}
+
+void TruncatedDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	// draw the outstanding values as a batch and keep those in the interval
+	std::size_t filled{ 0 }, rejected_batches{ 0 };
+	while(filled < n)
+	{
+		base->sample_n(engine, out + filled, n - filled);
+
+		std::size_t kept{ filled };
+		for(std::size_t j = filled; j < n; ++j)
+			if(out[j] >= lower && out[j] <= upper)
+				out[kept++] = out[j];
+
+		if(kept == filled)
+		{
+			++rejected_batches;
+			if(rejected_batches == max_rejections)
+				throw std::runtime_error("Truncated Distribution: Unable to " \
+					"draw a value in the interval. " + base->info() +
+					interval_info(lower, upper));
+		}
+		else
+			rejected_batches = 0;
+
+		filled = kept;
+	}
+}
+
+bool TruncatedDistribution::isConstant(double &value) const
+{
+	return base->isConstant(value);
+}
+
+std::string TruncatedDistribution::info() const
+{
+	return base->info() + interval_info(lower, upper);
+}
+
+TruncatedNormalDistribution::TruncatedNormalDistribution(const double mean_,
+	const double stdev_, const double low, const double up)
+	: RandomDistribution(), mean(mean_), stdev(stdev_),
+	  alower((low - mean_) / stdev_), aupper((up - mean_) / stdev_)
+{
+	if(stdev <= 0.)
+		throw std::invalid_argument("Truncated Normal Distribution: The " \
+			"standard deviation must be positive.");
+
+	if(!(low < up))
+		throw std::invalid_argument("Truncated Normal Distribution: The " \
+			"lower bound must be less than the upper bound.");
+}
+
+double TruncatedNormalDistribution::sample(Engine &engine) const
+{
+	return mean + stdev * sample_truncated_standard_normal(engine, alower,
+		aupper);
+}
+
+void TruncatedNormalDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = mean + stdev * sample_truncated_standard_normal(engine, alower,
+			aupper);
+}
+
+bool TruncatedNormalDistribution::hasQuantile() const
+{
+	return true;
+}
+
+void TruncatedNormalDistribution::quantile_n(const double *u, double *out,
+	std::size_t n) const
+{
+	// the standard normal distribution function and its complement
+	const auto cdf = [] (double x) -> double
+		{ return 0.5 * std::erfc(-x / std::sqrt(2.)); };
+
+	// intervals above 0 map u into the upper tail, where the complementary
+	// function keeps its relative precision
+	const bool upper_tail{ alower > 0. };
+	const double pa{ upper_tail ? cdf(-alower) : cdf(alower) },
+		pb{ upper_tail ? cdf(-aupper) : cdf(aupper) };
+
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		const double p{ pa + u[j] * (pb - pa) };
+		double x{ upper_tail ? -standard_normal_quantile(p) :
+			standard_normal_quantile(p) };
+
+		x = std::min(std::max(x, alower), aupper);
+		out[j] = mean + stdev * x;
+	}
+}
+
+bool TruncatedNormalDistribution::hasDensity() const
+{
+	return true;
+}
+
+void TruncatedNormalDistribution::log_density_n(const double *x, double *out,
+	std::size_t n) const
+{
+	// log(sqrt(2 pi))
+	constexpr double log_sqrt2pi{ 0.91893853320467274178032973640561764 };
+
+	// the probability of the interval under the normal distribution, from
+	// the upper tail for intervals above 0
+	const double mass{ alower > 0. ?
+		0.5 * (std::erfc(alower / std::sqrt(2.)) -
+			std::erfc(aupper / std::sqrt(2.))) :
+		0.5 * (std::erfc(-aupper / std::sqrt(2.)) -
+			std::erfc(-alower / std::sqrt(2.))) };
+	const double lognorm{ std::log(stdev * mass) + log_sqrt2pi };
+
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		const double z{ (x[j] - mean) / stdev };
+		out[j] = z >= alower && z <= aupper ? -0.5 * z * z - lognorm :
+			-std::numeric_limits<double>::infinity();
+	}
+}
+
+std::string TruncatedNormalDistribution::info() const
+{
+	return "Normal: mean = " + std::to_string(mean) + " and stdev = " +
+		std::to_string(stdev) + "." +
+		interval_info(mean + stdev * alower, mean + stdev * aupper);
+}
+
+/**
+ * \brief Checks the interval of a truncated lognormal distribution and
+ *    converts its lower bound to log space.
+ *
+ * \throw std::invalid_argument if the interval is empty or does not contain
+ *    positive values.
+ *
+ * \param[in] low The lower bound.
+ * \param[in] up The upper bound.
+ * \return The logarithm of the lower bound; -infinity for non-positive
+ *    bounds.
+ */
+static double log_lower_bound(const double low, const double up)
+{
+	if(!(low < up))
+		throw std::invalid_argument("Truncated Lognormal Distribution: The " \
+			"lower bound must be less than the upper bound.");
+
+	if(!(up > 0.))
+		throw std::invalid_argument("Truncated Lognormal Distribution: The " \
+			"interval must contain positive values.");
+
+	return low > 0. ? std::log(low) : -std::numeric_limits<double>::infinity();
+}
+
+TruncatedLognormalDistribution::TruncatedLognormalDistribution(
+	const double zeta, const double sigma, const double low, const double up)
+	: RandomDistribution(), logdist(zeta, sigma, log_lower_bound(low, up),
+	  std::log(up)), lower(low), upper(up)
+{
+}
+
+double TruncatedLognormalDistribution::sample(Engine &engine) const
+{
+	return std::exp(logdist.sample(engine));
+}
+
+void TruncatedLognormalDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	logdist.sample_n(engine, out, n);
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = std::exp(out[j]);
+}
+
+bool TruncatedLognormalDistribution::hasQuantile() const
+{
+	return true;
+}
+
+void TruncatedLognormalDistribution::quantile_n(const double *u, double *out,
+	std::size_t n) const
+{
+	logdist.quantile_n(u, out, n);
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = std::exp(out[j]);
+}
+
+bool TruncatedLognormalDistribution::hasDensity() const
+{
+	return true;
+}
+
+void TruncatedLognormalDistribution::log_density_n(const double *x,
+	double *out, std::size_t n) const
+{
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		if(!(x[j] > 0.))
+		{
+			out[j] = -std::numeric_limits<double>::infinity();
+			continue;
+		}
+
+		// the density of log(x), divided by x
+		const double logx{ std::log(x[j]) };
+		logdist.log_density_n(&logx, out + j, 1);
+		out[j] -= logx;
+	}
+}
+
+std::string TruncatedLognormalDistribution::info() const
+{
+	return "Lognormal: zeta = " + std::to_string(logdist.mean) +
+		" and sigma = " + std::to_string(logdist.stdev) + "." +
+		interval_info(lower, upper);
+}
+
+double sample_truncated_standard_normal(Engine &engine, double a, double b)
+{
+	constexpr double sqrt2pi{ 2.5066282746310005024157652848110452530 };
+	double u[2];
+
+	// intervals below 0: sample the mirror image
+	if(b <= 0.)
+		return -sample_truncated_standard_normal(engine, -b, -a);
+
+	if(a <= 0.)
+	{
+		// wide intervals containing 0: normal rejection
+		if(b - a >= sqrt2pi)
+		{
+			while(true)
+			{
+				double z;
+				sample_standard_normal_n(engine, &z, 1);
+				if(z >= a && z <= b)
+					return z;
+			}
+		}
+
+		// narrow intervals containing 0: uniform rejection
+		while(true)
+		{
+			sample_canonical_n(engine, u, 2);
+			const double z{ a + (b - a) * u[0] };
+			if(u[1] <= std::exp(-0.5 * z * z))
+				return z;
+		}
+	}
+
+	// intervals above 0: exponential rejection, unless the interval is narrow
+	// enough for uniform rejection to be more efficient (Robert's criterion)
+	const double root{ std::sqrt(a * a + 4.) };
+	const double alpha{ 0.5 * (a + root) };
+	const double narrow{ 2. * std::sqrt(std::exp(1.)) / (a + root) *
+		std::exp(0.25 * (a * a - a * root)) };
+
+	if(b - a < narrow)
+	{
+		while(true)
+		{
+			sample_canonical_n(engine, u, 2);
+			const double z{ a + (b - a) * u[0] };
+			if(u[1] <= std::exp(0.5 * (a * a - z * z)))
+				return z;
+		}
+	}
+
+	while(true)
+	{
+		sample_canonical_n(engine, u, 2);
+		const double z{ a - std::log(u[0]) / alpha };
+		if(z <= b && u[1] <= std::exp(-0.5 * (z - alpha) * (z - alpha)))
+			return z;
+	}
+}
+
+} // namespace molstat
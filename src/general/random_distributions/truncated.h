@@ -0,0 +1,218 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file truncated.h
+ * \brief Interface for distributions truncated to an interval.
+ *
+ * Truncating the distribution of a model parameter (e.g., to keep a coupling
+ * positive) rejects invalid values when the parameters are sampled, instead
+ * of after the observables have been calculated. The normal and lognormal
+ * distributions are sampled directly from their truncated forms; other
+ * distributions are sampled until a value is in the interval.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __truncated_h__
+#define __truncated_h__
+
+#include <memory>
+#include <string>
+#include "rng.h"
+
+namespace molstat {
+
+/**
+ * \brief A distribution truncated to an interval, sampled by rejection.
+ *
+ * Values of the underlying distribution outside the interval are discarded
+ * and drawn again.
+ */
+class TruncatedDistribution : public RandomDistribution
+{
+protected:
+	/// The underlying distribution.
+	const std::unique_ptr<const RandomDistribution> base;
+
+	/// The lower bound of the interval.
+	const double lower;
+
+	/// The upper bound of the interval.
+	const double upper;
+
+	/**
+	 * \brief The maximum number of consecutive draws (or batches of draws,
+	 *    in sample_n()) without a value in the interval.
+	 */
+	static constexpr std::size_t max_rejections = 1000000;
+
+public:
+	TruncatedDistribution() = delete;
+	~TruncatedDistribution() = default;
+
+	/**
+	 * \brief Constructor specifying the underlying distribution and the
+	 *    interval.
+	 *
+	 * \throw std::invalid_argument if the lower bound is not less than the
+	 *    upper bound, or if the distribution is constant and its value is
+	 *    outside the interval.
+	 *
+	 * \param[in] dist The underlying distribution.
+	 * \param[in] low The lower bound.
+	 * \param[in] up The upper bound.
+	 */
+	TruncatedDistribution(std::unique_ptr<RandomDistribution> &&dist,
+		const double low, const double up);
+
+	/**
+	 * \throw std::runtime_error if no value in the interval is drawn after
+	 *    many attempts (the interval has almost no probability).
+	 */
+	virtual double sample(Engine &engine) const override;
+
+	/**
+	 * \throw std::runtime_error as for sample().
+	 */
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual bool isConstant(double &value) const override;
+
+	virtual std::string info() const override;
+};
+
+/**
+ * \brief Normal distribution truncated to an interval.
+ *
+ * The samples are drawn with the rejection samplers of C.\ P.\ Robert,
+ * Stat.\ Comput.\ \b 5, 121 (1995), whose acceptance rates are high for any
+ * interval, including those far into the tails.
+ */
+class TruncatedNormalDistribution : public RandomDistribution
+{
+protected:
+	/// The mean.
+	const double mean;
+
+	/// The standard deviation.
+	const double stdev;
+
+	/// The lower bound of the interval, in standard deviations from the mean.
+	const double alower;
+
+	/// The upper bound of the interval, in standard deviations from the mean.
+	const double aupper;
+
+	friend class TruncatedLognormalDistribution;
+
+public:
+	TruncatedNormalDistribution() = delete;
+	~TruncatedNormalDistribution() = default;
+
+	/**
+	 * \brief Constructor specifying the mean, standard deviation and
+	 *    interval.
+	 *
+	 * \throw std::invalid_argument if the standard deviation is non-positive
+	 *    or the lower bound is not less than the upper bound.
+	 *
+	 * \param[in] mean_ The mean.
+	 * \param[in] stdev_ The standard deviation.
+	 * \param[in] low The lower bound.
+	 * \param[in] up The upper bound.
+	 */
+	TruncatedNormalDistribution(const double mean_, const double stdev_,
+		const double low, const double up);
+
+	virtual double sample(Engine &engine) const override;
+
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual bool hasQuantile() const override;
+
+	virtual void quantile_n(const double *u, double *out, std::size_t n)
+		const override;
+
+	virtual bool hasDensity() const override;
+
+	virtual void log_density_n(const double *x, double *out, std::size_t n)
+		const override;
+
+	virtual std::string info() const override;
+};
+
+/**
+ * \brief Lognormal distribution truncated to an interval.
+ *
+ * The logarithm of the value is a truncated normal random number (see
+ * molstat::TruncatedNormalDistribution).
+ */
+class TruncatedLognormalDistribution : public RandomDistribution
+{
+protected:
+	/// The truncated normal distribution in log space.
+	const TruncatedNormalDistribution logdist;
+
+	/// The lower bound of the interval.
+	const double lower;
+
+	/// The upper bound of the interval.
+	const double upper;
+
+public:
+	TruncatedLognormalDistribution() = delete;
+	~TruncatedLognormalDistribution() = default;
+
+	/**
+	 * \brief Constructor specifying the mean and standard deviation (in log
+	 *    space) and the interval.
+	 *
+	 * \throw std::invalid_argument if the standard deviation is non-positive
+	 *    or the interval does not contain positive values.
+	 *
+	 * \param[in] zeta The mean (in log space).
+	 * \param[in] sigma The standard deviation (in log space).
+	 * \param[in] low The lower bound.
+	 * \param[in] up The upper bound.
+	 */
+	TruncatedLognormalDistribution(const double zeta, const double sigma,
+		const double low, const double up);
+
+	virtual double sample(Engine &engine) const override;
+
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual bool hasQuantile() const override;
+
+	virtual void quantile_n(const double *u, double *out, std::size_t n)
+		const override;
+
+	virtual bool hasDensity() const override;
+
+	virtual void log_density_n(const double *x, double *out, std::size_t n)
+		const override;
+
+	virtual std::string info() const override;
+};
+
+/**
+ * \brief Draws a standard normal random number (mean 0, standard deviation
+ *    1) truncated to an interval.
+ *
+ * \param[in] engine The random number engine.
+ * \param[in] a The lower bound of the interval.
+ * \param[in] b The upper bound of the interval (greater than `a`).
+ * \return The random number.
+ */
+double sample_truncated_standard_normal(Engine &engine, double a, double b);
+
+} // namespace molstat
+
+#endif
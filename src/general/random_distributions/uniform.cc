@@ -12,6 +12,8 @@
  */
 
 #include "uniform.h"
+#include <cmath>
+#include <limits>
 
 namespace molstat {
 
@@ -25,7 +27,54 @@ UniformDistribution::UniformDistribution(const double low, const double up)
 
 double UniformDistribution::sample(Engine &engine) const
 {
-	return dist(engine);
+	std::uniform_real_distribution<double> local{ dist.param() };
+
+	return local(engine);
+}
+
+void UniformDistribution::sample_n(Engine &engine, double *out,
+	std::size_t n) const
+{
+	sample_canonical_n(engine, out, n);
+	affine_n(out, n, dist.a(), dist.b() - dist.a());
+}
+
+bool UniformDistribution::hasQuantile() const
+{
+	return true;
+}
+
+void UniformDistribution::quantile_n(const double *u, double *out,
+	std::size_t n) const
+{
+	const double lower{ dist.a() }, width{ dist.b() - dist.a() };
+
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = lower + width * u[j];
+}
+
+bool UniformDistribution::hasDensity() const
+{
+	return true;
+}
+
+void UniformDistribution::log_density_n(const double *x, double *out,
+	std::size_t n) const
+{
+	const double lower{ dist.a() }, upper{ dist.b() };
+	const double logp{ -std::log(upper - lower) };
+
+	for(std::size_t j = 0; j < n; ++j)
+		out[j] = x[j] >= lower && x[j] <= upper ? logp :
+			-std::numeric_limits<double>::infinity();
+}
+
+bool UniformDistribution::getDeviceDistribution(
+	DeviceDistribution &dev) const
+{
+	dev = DeviceDistribution{ DeviceDistribution::Uniform, dist.a(),
+		dist.b() };
+	return true;
 }
 
 std::string UniformDistribution::info() const
@@ -26,8 +26,14 @@ namespace molstat {
 class UniformDistribution : public RandomDistribution
 {
 protected:
-	/// The C++11 uniform distribution
-	mutable std::uniform_real_distribution<double> dist;
+	/**
+	 * \brief The C++11 uniform distribution.
+	 *
+	 * Only the parameters of `dist` are used; each call to sample() draws
+	 * from a local copy so that concurrent calls (with different engines) are
+	 * safe.
+	 */
+	const std::uniform_real_distribution<double> dist;
 	
 public:
 	UniformDistribution() = delete;
@@ -46,6 +52,22 @@ public:
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sample_n(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual bool hasQuantile() const override;
+
+	virtual void quantile_n(const double *u, double *out, std::size_t n)
+		const override;
+
+	virtual bool hasDensity() const override;
+
+	virtual void log_density_n(const double *x, double *out, std::size_t n)
+		const override;
+
+	virtual bool getDeviceDistribution(DeviceDistribution &dev) const
+		override;
+
 	virtual std::string info() const override;
 };
 
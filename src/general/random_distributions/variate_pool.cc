@@ -0,0 +1,57 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file variate_pool.cc
+ * \brief Implements the pool of uniform base variates.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "variate_pool.h"
+#include "rng.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace molstat {
+
+VariatePool::VariatePool(std::size_t ntrials_, std::size_t ndims_,
+	Engine engine)
+	: ntrials(ntrials_), ndims(ndims_), variates(ntrials_ * ndims_)
+{
+	if(ndims == 0)
+		throw std::invalid_argument("The pool must have at least one " \
+			"dimension.");
+
+	sample_canonical_n(engine, variates.data(), variates.size());
+}
+
+std::size_t VariatePool::size() const noexcept
+{
+	return ntrials;
+}
+
+std::size_t VariatePool::dimension() const noexcept
+{
+	return ndims;
+}
+
+void VariatePool::generate(std::uint64_t first, std::size_t n,
+	std::size_t d, double *out) const
+{
+	if(d >= ndims || first > ntrials || n > ntrials - first)
+		throw std::out_of_range("The trials are not in the pool.");
+
+	const double *const row{ variates.data() + d*ntrials + first };
+	std::copy(row, row + n, out);
+}
+
+std::size_t VariatePool::memoryUsage() const noexcept
+{
+	return variates.capacity() * sizeof(double);
+}
+
+} // namespace molstat
@@ -0,0 +1,103 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file variate_pool.h
+ * \brief A fixed pool of uniform base variates, for common random numbers.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __variate_pool_h__
+#define __variate_pool_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "engine.h"
+
+namespace molstat {
+
+/**
+ * \brief A fixed pool of uniform random numbers in (0, 1), with one
+ *    coordinate per dimension for each of a set of trials.
+ *
+ * The pool is drawn once, and its numbers are then transformed by the
+ * quantile functions of the distributions every time they are sampled (see
+ * molstat::Simulator::simulateBatchPooled). When the distributions change
+ * (e.g., for each value of a sweep, or each step of a calibration), every
+ * trial keeps its base variates, so the simulated observables are smooth
+ * functions of the distributions' parameters, and no random numbers are
+ * drawn again.
+ *
+ * The numbers are stored dimension by dimension, which is the layout of the
+ * parameters in the simulator's workspace.
+ */
+class VariatePool
+{
+private:
+	/// The number of trials.
+	const std::size_t ntrials;
+
+	/// The number of dimensions.
+	const std::size_t ndims;
+
+	/// The numbers, `ntrials` for each dimension.
+	std::vector<double> variates;
+
+public:
+	VariatePool() = delete;
+
+	/**
+	 * \brief Constructor drawing the pool from an engine.
+	 *
+	 * \throw std::invalid_argument if the dimension is 0.
+	 *
+	 * \param[in] ntrials_ The number of trials.
+	 * \param[in] ndims_ The number of dimensions.
+	 * \param[in] engine The engine; each dimension is drawn in turn.
+	 */
+	VariatePool(std::size_t ntrials_, std::size_t ndims_, Engine engine);
+
+	/**
+	 * \brief Gets the number of trials.
+	 *
+	 * \return The number of trials.
+	 */
+	std::size_t size() const noexcept;
+
+	/**
+	 * \brief Gets the number of dimensions.
+	 *
+	 * \return The number of dimensions.
+	 */
+	std::size_t dimension() const noexcept;
+
+	/**
+	 * \brief Copies one coordinate of consecutive trials.
+	 *
+	 * \throw std::out_of_range if the trials or the dimension are not in the
+	 *    pool.
+	 *
+	 * \param[in] first The index of the first trial.
+	 * \param[in] n The number of trials.
+	 * \param[in] d The dimension.
+	 * \param[out] out Storage for the `n` coordinates.
+	 */
+	void generate(std::uint64_t first, std::size_t n, std::size_t d,
+		double *out) const;
+
+	/**
+	 * \brief Gets the memory held by the pool.
+	 *
+	 * \return The memory (bytes).
+	 */
+	std::size_t memoryUsage() const noexcept;
+};
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,66 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file analytic_histogram.cc
+ * \brief Histograms calculated from the exact distribution of an
+ *    observable.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "analytic_histogram.h"
+#include <general/histogram_tools/bin_style.h>
+#include <general/histogram_tools/histogram.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace molstat {
+
+void FillAnalyticHistogram(const AnalyticCDF &cdf, const BinStyle &bstyle,
+	std::size_t ntrials, Histogram &hist)
+{
+	if(hist.numDimensions() != 1 || !hist.isStreaming())
+		throw std::invalid_argument("Only one-dimensional histograms with " \
+			"fixed bounds can be calculated from a distribution.");
+
+	const std::size_t nbins{ hist.numBins(0) };
+	const std::array<double, 2> bounds{ hist.getMaskedBounds(0) };
+	const double width{ (bounds[1] - bounds[0]) / nbins };
+
+	// the CDF at each edge; the bins are uniform in masked coordinates, and
+	// the masks are increasing
+	std::vector<double> cdfs(nbins + 1);
+	double last{ 0. };
+	for(std::size_t j = 0; j <= nbins; ++j)
+	{
+		const double u{ j == nbins ? bounds[1] : bounds[0] + j*width };
+		last = std::max(last, std::min(1., cdf(bstyle.invmask(u))));
+		cdfs[j] = last;
+	}
+
+	std::vector<double> sums(nbins);
+	std::vector<std::size_t> counts(nbins);
+	for(std::size_t j = 0; j < nbins; ++j)
+	{
+		sums[j] = ntrials * (cdfs[j+1] - cdfs[j]);
+		counts[j] = static_cast<std::size_t>(std::llround(sums[j]));
+	}
+
+	const std::array<std::size_t, 2> out{ {
+		static_cast<std::size_t>(std::llround(ntrials * cdfs[0])),
+		static_cast<std::size_t>(std::llround(ntrials * (1. - cdfs[nbins])))
+	} };
+
+	hist.useWeights();
+	hist.setRawBinCounts(counts, out[0] + out[1], { out });
+	hist.setRawBinSums(sums);
+}
+
+} // namespace molstat
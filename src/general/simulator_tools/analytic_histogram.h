@@ -0,0 +1,90 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file analytic_histogram.h
+ * \brief Histograms calculated from the exact distribution of an
+ *    observable, instead of by sampling.
+ *
+ * For a few simple models, the distribution of an observable follows from
+ * the model parameters' distributions by a change of variables. The
+ * expected count of each bin is then the number of trials times the
+ * difference of the cumulative distribution function at the bin's edges,
+ * which is exact and takes almost no time.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __analytic_histogram_h__
+#define __analytic_histogram_h__
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include "device_simulator.h"
+
+namespace molstat {
+
+class BinStyle;
+class Histogram;
+
+/**
+ * \brief The cumulative distribution function of an observable.
+ *
+ * The function is nondecreasing, from 0 to 1.
+ */
+using AnalyticCDF = std::function<double(double)>;
+
+/**
+ * \brief Interface for finding the distribution of an observable in closed
+ *    form.
+ *
+ * The simulation is described as for a device (see
+ * molstat::DeviceSimulator::translate): the distribution of each model
+ * parameter and the closed-form terms of each observable. A solver knows
+ * the distributions for some kernels and families of distributions.
+ */
+class AnalyticSolver
+{
+public:
+	virtual ~AnalyticSolver() = default;
+
+	/**
+	 * \brief Gets the cumulative distribution function of an observable.
+	 *
+	 * \param[in] program The simulation.
+	 * \param[in] obs The observable.
+	 * \param[out] reason Why the distribution is not known, if it is not.
+	 * \return The function, or an empty function if the distribution is not
+	 *    known.
+	 */
+	virtual AnalyticCDF getCDF(const DeviceProgram &program, std::size_t obs,
+		std::string &reason) const = 0;
+};
+
+/**
+ * \brief Fills a one-dimensional histogram with the expected counts of its
+ *    bins.
+ *
+ * The sums of the weights (see molstat::Histogram::useWeights) are the
+ * expected counts, which are not integers; the raw bin counts and the
+ * numbers of underflows and overflows are these rounded. The histogram's
+ * data is replaced.
+ *
+ * \throw std::invalid_argument if the histogram is not one-dimensional and
+ *    streaming.
+ *
+ * \param[in] cdf The cumulative distribution function of the observable.
+ * \param[in] bstyle The binning style of the histogram.
+ * \param[in] ntrials The number of trials.
+ * \param[in,out] hist The histogram.
+ */
+void FillAnalyticHistogram(const AnalyticCDF &cdf, const BinStyle &bstyle,
+	std::size_t ntrials, Histogram &hist);
+
+} // namespace molstat
+
+#endif
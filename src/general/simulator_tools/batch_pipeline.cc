@@ -0,0 +1,180 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file batch_pipeline.cc
+ * \brief Implementation of the pipeline from simulation to binning.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "batch_pipeline.h"
+#include <general/task_scheduler.h>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace molstat {
+
+struct BatchPipeline::Ring
+{
+	/// The batches; batch `k` is in slot `k % slots.size()`.
+	std::vector<TrialBatch> slots;
+
+	/// The number of batches submitted (written by the producer).
+	std::atomic<std::size_t> tail{ 0 };
+
+	/// Keeps the producer's and consumer's counts on separate cache lines.
+	char padding[64];
+
+	/// The number of batches binned (written by the consumer).
+	std::atomic<std::size_t> head{ 0 };
+};
+
+/**
+ * \brief Waits a little before checking a ring again.
+ *
+ * The first checks spin, the next yield to other threads, and the rest
+ * sleep briefly, so that an idle thread responds quickly without using a
+ * core for long.
+ *
+ * \param[in,out] idle The number of checks so far that found nothing.
+ */
+static void back_off(std::size_t &idle)
+{
+	if(idle >= 1024)
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	else if(idle >= 64)
+		std::this_thread::yield();
+	++idle;
+}
+
+BatchPipeline::BatchPipeline(std::size_t nproducers_,
+	std::size_t nconsumers_, std::size_t depth,
+	std::function<void(std::size_t, const TrialBatch &)> consume_,
+	const std::vector<int> &cpus)
+	: nproducers(nproducers_),
+	  nconsumers(std::max<std::size_t>(1, std::min(nconsumers_, nproducers_))),
+	  consume(std::move(consume_)), rings(new Ring[nproducers_]),
+	  errors(nconsumers, nullptr), stopping(false), threads()
+{
+	if(nproducers == 0)
+		throw std::invalid_argument("A pipeline needs at least one producer.");
+	if(depth == 0)
+		throw std::invalid_argument("The rings of a pipeline must hold at " \
+			"least one batch.");
+
+	for(std::size_t p = 0; p < nproducers; ++p)
+		rings[p].slots.resize(depth);
+
+	for(std::size_t c = 0; c < nconsumers; ++c)
+		threads.emplace_back(&BatchPipeline::serve, this, c,
+			cpus.empty() ? -1 : cpus[c % cpus.size()]);
+}
+
+BatchPipeline::~BatchPipeline()
+{
+	stopping.store(true, std::memory_order_release);
+	for(std::thread &thread : threads)
+		thread.join();
+}
+
+std::size_t BatchPipeline::numConsumers() const noexcept
+{
+	return nconsumers;
+}
+
+TrialBatch &BatchPipeline::acquire(std::size_t p)
+{
+	Ring &ring = rings[p];
+	const std::size_t tail{ ring.tail.load(std::memory_order_relaxed) };
+
+	// the slot is free once the consumer has binned the batch in it
+	std::size_t idle{ 0 };
+	while(tail - ring.head.load(std::memory_order_acquire) >=
+		ring.slots.size())
+	{
+		back_off(idle);
+	}
+
+	return ring.slots[tail % ring.slots.size()];
+}
+
+void BatchPipeline::submit(std::size_t p)
+{
+	Ring &ring = rings[p];
+	ring.tail.store(ring.tail.load(std::memory_order_relaxed) + 1,
+		std::memory_order_release);
+}
+
+void BatchPipeline::serve(std::size_t consumer, int cpu)
+{
+	PinThread(cpu);
+
+	std::size_t idle{ 0 };
+	while(true)
+	{
+		// batches submitted before the pipeline stopped are still binned
+		const bool stop{ stopping.load(std::memory_order_acquire) };
+
+		bool found{ false };
+		for(std::size_t p = consumer; p < nproducers; p += nconsumers)
+		{
+			Ring &ring = rings[p];
+			std::size_t head{ ring.head.load(std::memory_order_relaxed) };
+			const std::size_t tail{ ring.tail.load(std::memory_order_acquire) };
+
+			for(; head != tail; ++head)
+			{
+				if(errors[consumer] == nullptr)
+				{
+					try
+					{
+						consume(p, ring.slots[head % ring.slots.size()]);
+					}
+					catch(...)
+					{
+						errors[consumer] = std::current_exception();
+					}
+				}
+				ring.head.store(head + 1, std::memory_order_release);
+				found = true;
+			}
+		}
+
+		if(found)
+			idle = 0;
+		else if(stop)
+			return;
+		else
+			back_off(idle);
+	}
+}
+
+void BatchPipeline::flush()
+{
+	for(std::size_t p = 0; p < nproducers; ++p)
+	{
+		Ring &ring = rings[p];
+		std::size_t idle{ 0 };
+		while(ring.head.load(std::memory_order_acquire) !=
+			ring.tail.load(std::memory_order_relaxed))
+		{
+			back_off(idle);
+		}
+	}
+
+	for(std::exception_ptr &error : errors)
+		if(error != nullptr)
+		{
+			const std::exception_ptr first{ error };
+			std::fill(errors.begin(), errors.end(), nullptr);
+			std::rethrow_exception(first);
+		}
+}
+
+} // namespace molstat
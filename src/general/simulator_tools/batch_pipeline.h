@@ -0,0 +1,172 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file batch_pipeline.h
+ * \brief Overlaps the simulation of trials with their binning.
+ *
+ * Without a pipeline, each thread simulates a batch of trials and then bins
+ * it (and writes the raw samples) before simulating the next batch. With a
+ * pipeline, the simulating threads (producers) instead fill batches into
+ * bounded rings, and dedicated threads (consumers) bin them. The expensive
+ * and cheap stages then run at the same time, and the cache misses of a
+ * large histogram stay on the consumers' cores.
+ *
+ * Each producer has its own ring, a lock-free single-producer,
+ * single-consumer queue, and each ring is emptied by one consumer in order.
+ * The batches of a producer are thus binned in the order they were
+ * simulated, so the histograms are the same as without a pipeline.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __batch_pipeline_h__
+#define __batch_pipeline_h__
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace molstat {
+
+/// A batch of simulated trials, waiting to be binned.
+struct TrialBatch
+{
+	/// The observables of the valid trials, stored contiguously.
+	std::vector<double> values;
+
+	/// The model parameters of the valid trials (if they are written).
+	std::vector<double> params;
+
+	/// The importance weights of the valid trials (if they are used).
+	std::vector<double> weights;
+
+	/// The number of valid trials.
+	std::size_t n{ 0 };
+};
+
+/**
+ * \brief Bins batches of trials from several producers on dedicated
+ *    threads.
+ *
+ * Consumer `c` empties the rings of producers `c`, `c + nconsumers`, ...; a
+ * consumer with nothing to do spins briefly, then yields, then sleeps
+ * briefly between checks. A producer waits (in the same way) for a free
+ * slot when its ring is full, so at most `depth` batches per producer are
+ * in flight.
+ */
+class BatchPipeline
+{
+private:
+	/// The ring of one producer.
+	struct Ring;
+
+	/// The number of producers.
+	const std::size_t nproducers;
+
+	/// The number of consumers.
+	const std::size_t nconsumers;
+
+	/// The function that bins a batch.
+	const std::function<void(std::size_t, const TrialBatch &)> consume;
+
+	/// The ring of each producer.
+	std::unique_ptr<Ring[]> rings;
+
+	/// The first exception thrown (while binning) by each consumer.
+	std::vector<std::exception_ptr> errors;
+
+	/// True when the consumers should exit, once their rings are empty.
+	std::atomic<bool> stopping;
+
+	/// The consumer threads.
+	std::vector<std::thread> threads;
+
+	/**
+	 * \brief Empties the rings of a consumer until the pipeline stops.
+	 *
+	 * \param[in] consumer The consumer.
+	 * \param[in] cpu The CPU for the consumer, or -1 to not pin it.
+	 */
+	void serve(std::size_t consumer, int cpu);
+
+public:
+	BatchPipeline() = delete;
+	BatchPipeline(const BatchPipeline &) = delete;
+	BatchPipeline &operator=(const BatchPipeline &) = delete;
+
+	/**
+	 * \brief Starts the consumers.
+	 *
+	 * \throw std::invalid_argument if there are no producers or the depth
+	 *    is 0.
+	 *
+	 * \param[in] nproducers_ The number of producers.
+	 * \param[in] nconsumers_ The number of consumers; 0 is treated as 1, and
+	 *    there are at most as many consumers as producers.
+	 * \param[in] depth The number of batches in each ring.
+	 * \param[in] consume_ The function that bins a batch; its arguments are
+	 *    the producer and the batch. It is never called for one producer
+	 *    from two threads at once.
+	 * \param[in] cpus The CPU for each consumer (e.g., from NumaCpuOrder);
+	 *    empty to not pin the consumers.
+	 */
+	BatchPipeline(std::size_t nproducers_, std::size_t nconsumers_,
+		std::size_t depth,
+		std::function<void(std::size_t, const TrialBatch &)> consume_,
+		const std::vector<int> &cpus = {});
+
+	/**
+	 * \brief Bins the remaining batches and stops the consumers.
+	 */
+	~BatchPipeline();
+
+	/**
+	 * \brief Gets the number of consumers.
+	 *
+	 * \return The number of consumers.
+	 */
+	std::size_t numConsumers() const noexcept;
+
+	/**
+	 * \brief Gets the next free batch of a producer, waiting for the ring to
+	 *    have space.
+	 *
+	 * The batch keeps the buffers of a previous batch, so they need not be
+	 * reallocated. Only producer `p` may call this function (or submit())
+	 * for `p`.
+	 *
+	 * \param[in] p The producer.
+	 * \return The batch, to be filled and then passed on with submit().
+	 */
+	TrialBatch &acquire(std::size_t p);
+
+	/**
+	 * \brief Passes the batch from the last acquire() of a producer to its
+	 *    consumer.
+	 *
+	 * \param[in] p The producer.
+	 */
+	void submit(std::size_t p);
+
+	/**
+	 * \brief Waits until every submitted batch has been binned.
+	 *
+	 * The producers must not submit batches during the call.
+	 *
+	 * \throw The first exception thrown while binning since the last flush;
+	 *    the batches after it (of the same consumer) were not binned.
+	 */
+	void flush();
+};
+
+} // namespace molstat
+
+#endif
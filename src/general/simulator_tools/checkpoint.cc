@@ -0,0 +1,225 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file checkpoint.cc
+ * \brief Implementation of simulation checkpoints.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "checkpoint.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <general/binary_io.h>
+
+namespace molstat {
+
+/// The magic bytes at the start of a checkpoint file.
+static const char checkpoint_magic[8]{ 'M', 'O', 'L', 'S', 'T', 'A', 'T',
+	'C' };
+
+/// The version of the checkpoint format.
+static const std::uint64_t checkpoint_version{ 2 };
+
+/// What the stream holds, for the error messages.
+static const char checkpoint_source[]{ "the checkpoint" };
+
+void WriteCheckpoint(const std::string &filename, const Checkpoint &ckpt)
+{
+	const std::string tmpname{ filename + ".tmp" };
+	{
+		std::ofstream out(tmpname, std::ios_base::out | std::ios_base::binary);
+		if(!out)
+			throw std::runtime_error("Unable to open \"" + tmpname +
+				"\" for output.");
+
+		out.write(checkpoint_magic, sizeof(checkpoint_magic));
+		WriteBinaryUInt(out, checkpoint_version);
+		WriteBinaryUInt(out, ckpt.seed);
+		WriteBinaryString(out, ckpt.description);
+		WriteBinaryUInt(out, ckpt.threads.size());
+
+		for(const ThreadCheckpoint &thread : ckpt.threads)
+		{
+			WriteBinaryUInt(out, thread.next_trial);
+			WriteBinaryString(out, thread.engine);
+			WriteBinaryUInt(out, thread.counts.size());
+			for(const std::size_t count : thread.counts)
+				WriteBinaryUInt(out, count);
+			WriteBinaryUInt(out, thread.nout);
+			WriteBinaryUInt(out, thread.out_of_range.size());
+			for(const auto &tally : thread.out_of_range)
+			{
+				WriteBinaryUInt(out, tally[0]);
+				WriteBinaryUInt(out, tally[1]);
+			}
+			WriteBinaryUInt(out, thread.no_obs);
+			WriteBinaryUInt(out, thread.rejections.size());
+			for(const std::size_t rejection : thread.rejections)
+				WriteBinaryUInt(out, rejection);
+		}
+
+		out.close();
+		if(!out)
+			throw std::runtime_error("Unable to write \"" + tmpname + "\".");
+	}
+
+	if(std::rename(tmpname.c_str(), filename.c_str()) != 0)
+		throw std::runtime_error("Unable to replace \"" + filename + "\".");
+}
+
+Checkpoint ReadCheckpoint(const std::string &filename)
+{
+	std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+	if(!in)
+		throw std::runtime_error("Unable to open \"" + filename + "\".");
+
+	char magic[sizeof(checkpoint_magic)];
+	in.read(magic, sizeof(magic));
+	if(static_cast<std::size_t>(in.gcount()) != sizeof(magic) ||
+		!std::equal(magic, magic + sizeof(magic), checkpoint_magic))
+	{
+		throw std::runtime_error("\"" + filename + "\" is not a checkpoint.");
+	}
+	if(ReadBinaryUInt(in, checkpoint_source) != checkpoint_version)
+		throw std::runtime_error("Unsupported version of the checkpoint " \
+			"format in \"" + filename + "\".");
+
+	Checkpoint ret;
+	ret.seed = ReadBinaryUInt(in, checkpoint_source);
+	ret.description = ReadBinaryString(in, checkpoint_source);
+	ret.threads.resize(ReadBinaryUInt(in, checkpoint_source));
+
+	for(ThreadCheckpoint &thread : ret.threads)
+	{
+		thread.next_trial = ReadBinaryUInt(in, checkpoint_source);
+		thread.engine = ReadBinaryString(in, checkpoint_source);
+		thread.counts.resize(ReadBinaryUInt(in, checkpoint_source));
+		for(std::size_t &count : thread.counts)
+			count = ReadBinaryUInt(in, checkpoint_source);
+		thread.nout = ReadBinaryUInt(in, checkpoint_source);
+		thread.out_of_range.resize(ReadBinaryUInt(in, checkpoint_source));
+		for(auto &tally : thread.out_of_range)
+		{
+			tally[0] = ReadBinaryUInt(in, checkpoint_source);
+			tally[1] = ReadBinaryUInt(in, checkpoint_source);
+		}
+		thread.no_obs = ReadBinaryUInt(in, checkpoint_source);
+		thread.rejections.resize(ReadBinaryUInt(in, checkpoint_source));
+		for(std::size_t &rejection : thread.rejections)
+			rejection = ReadBinaryUInt(in, checkpoint_source);
+	}
+
+	return ret;
+}
+
+CheckpointWriter::CheckpointWriter(const std::string &filename_,
+	Checkpoint initial, double seconds)
+	: filename(filename_),
+	  interval(std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<double>(seconds))),
+	  ckpt(std::move(initial)),
+	  last_update(ckpt.threads.size(), Clock::now())
+{
+	if(!(seconds > 0.))
+		throw std::invalid_argument("The checkpoint interval must be " \
+			"positive.");
+
+	WriteCheckpoint(filename, ckpt);
+
+	worker = std::thread(&CheckpointWriter::run, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+	try
+	{
+		close();
+	}
+	catch(...)
+	{
+		// errors can only be reported by calling close() explicitly
+	}
+}
+
+void CheckpointWriter::run()
+{
+	std::unique_lock<std::mutex> lock(mtx);
+
+	while(true)
+	{
+		cv.wait_for(lock, interval, [this] { return done; });
+
+		// the final progress is written after the simulation finishes
+		const bool finished{ done };
+		flush(lock);
+		if(finished)
+			return;
+	}
+}
+
+void CheckpointWriter::flush(std::unique_lock<std::mutex> &lock)
+{
+	if(!dirty)
+		return;
+
+	// write a copy, so that the threads can update while the file is written
+	const Checkpoint copy{ ckpt };
+	dirty = false;
+	lock.unlock();
+
+	std::exception_ptr err{ nullptr };
+	try
+	{
+		WriteCheckpoint(filename, copy);
+	}
+	catch(...)
+	{
+		err = std::current_exception();
+	}
+
+	lock.lock();
+	if(err != nullptr && error == nullptr)
+		error = err;
+}
+
+bool CheckpointWriter::due(std::size_t t) const
+{
+	return Clock::now() - last_update[t] >= interval;
+}
+
+void CheckpointWriter::update(std::size_t t, ThreadCheckpoint state)
+{
+	last_update[t] = Clock::now();
+
+	std::lock_guard<std::mutex> lock(mtx);
+	ckpt.threads.at(t) = std::move(state);
+	dirty = true;
+}
+
+void CheckpointWriter::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		done = true;
+	}
+	cv.notify_all();
+
+	if(worker.joinable())
+		worker.join();
+
+	if(error != nullptr)
+	{
+		std::exception_ptr err{ error };
+		error = nullptr;
+		std::rethrow_exception(err);
+	}
+}
+
+} // namespace molstat
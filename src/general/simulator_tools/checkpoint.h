@@ -0,0 +1,207 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file checkpoint.h
+ * \brief Checkpoints of a simulation, for resuming interrupted runs.
+ *
+ * Each thread of a simulation works through its own contiguous block of
+ * trials, with its own engine and histogram. A checkpoint holds, for each
+ * thread, the next trial to simulate, the state of the engine, and the
+ * (raw) bin counts and tallies accumulated so far. Because the threads are
+ * independent, they need not be stopped at the same time: every thread's
+ * progress is consistent on its own, and a resumed run finishes with the
+ * same histogram as an uninterrupted one.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __checkpoint_h__
+#define __checkpoint_h__
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace molstat {
+
+/// The progress of one thread of a simulation.
+struct ThreadCheckpoint
+{
+	/// The first trial (in the thread's block) that has not been simulated.
+	std::size_t next_trial{ 0 };
+
+	/// The state of the thread's engine, as written by molstat::Engine.
+	std::string engine;
+
+	/// The raw bin counts of the thread's histogram.
+	std::vector<std::size_t> counts;
+
+	/// The number of data outside the histogram bounds.
+	std::size_t nout{ 0 };
+
+	/// The underflows and overflows in each dimension.
+	std::vector<std::array<std::size_t, 2>> out_of_range;
+
+	/// The number of trials that did not produce an observable.
+	std::size_t no_obs{ 0 };
+
+	/// The number of trials in which each observable was not produced.
+	std::vector<std::size_t> rejections;
+};
+
+/// The progress of a simulation (one process, with several threads).
+struct Checkpoint
+{
+	/// The seed of the simulation.
+	std::uint64_t seed{ 0 };
+
+	/**
+	 * \brief Describes the simulation (the trials, threads, and bins); a
+	 *    run can only resume from a checkpoint with the same description.
+	 */
+	std::string description;
+
+	/// The progress of each thread.
+	std::vector<ThreadCheckpoint> threads;
+};
+
+/**
+ * \brief Writes a checkpoint file.
+ *
+ * The checkpoint is written to a temporary file (the name with `.tmp`
+ * appended) that then replaces the file, so that an interruption while
+ * writing leaves the previous checkpoint intact.
+ *
+ * \throw std::runtime_error if the file cannot be written.
+ *
+ * \param[in] filename The name of the checkpoint file.
+ * \param[in] ckpt The checkpoint.
+ */
+void WriteCheckpoint(const std::string &filename, const Checkpoint &ckpt);
+
+/**
+ * \brief Reads a checkpoint file.
+ *
+ * \throw std::runtime_error if the file cannot be opened or is not a valid
+ *    checkpoint.
+ *
+ * \param[in] filename The name of the checkpoint file.
+ * \return The checkpoint.
+ */
+Checkpoint ReadCheckpoint(const std::string &filename);
+
+/**
+ * \brief Periodically writes the progress of a simulation, in the
+ *    background, while the threads simulate.
+ *
+ * Each thread calls due() between batches of trials and, when it returns
+ * true, passes a copy of its progress to update(). A background thread
+ * writes the latest progress of every thread at the same interval.
+ */
+class CheckpointWriter
+{
+private:
+	/// The clock for the checkpoint interval.
+	using Clock = std::chrono::steady_clock;
+
+	/// The name of the checkpoint file.
+	const std::string filename;
+
+	/// The time between checkpoints.
+	const Clock::duration interval;
+
+	/// The latest progress of every thread.
+	Checkpoint ckpt;
+
+	/// The time each thread last updated its progress.
+	std::vector<Clock::time_point> last_update;
+
+	/// True if the progress changed since the file was last written.
+	bool dirty{ false };
+
+	/// True once the simulation is finished.
+	bool done{ false };
+
+	/// The first error from writing the file in the background.
+	std::exception_ptr error{ nullptr };
+
+	/// Protects CheckpointWriter::ckpt and the flags.
+	std::mutex mtx;
+
+	/// Signals changes to CheckpointWriter::done.
+	std::condition_variable cv;
+
+	/// The background thread.
+	std::thread worker;
+
+	/// The work performed by the background thread.
+	void run();
+
+	/**
+	 * \brief Writes the checkpoint file, if the progress changed.
+	 *
+	 * \param[in,out] lock The (locked) lock on CheckpointWriter::mtx.
+	 */
+	void flush(std::unique_lock<std::mutex> &lock);
+
+public:
+	CheckpointWriter() = delete;
+	CheckpointWriter(const CheckpointWriter &) = delete;
+	CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+	/**
+	 * \brief Writes the initial checkpoint and starts the background thread.
+	 *
+	 * \throw std::invalid_argument if the interval is not positive.
+	 * \throw std::runtime_error if the initial checkpoint cannot be written.
+	 *
+	 * \param[in] filename_ The name of the checkpoint file.
+	 * \param[in] initial The progress at the start of the simulation.
+	 * \param[in] seconds The time between checkpoints, in seconds.
+	 */
+	CheckpointWriter(const std::string &filename_, Checkpoint initial,
+		double seconds);
+
+	/// Stops the background thread, writing the final progress.
+	~CheckpointWriter();
+
+	/**
+	 * \brief Determines if a thread should update its progress.
+	 *
+	 * Only thread `t` may call this function (or update()) for `t`.
+	 *
+	 * \param[in] t The thread.
+	 * \return True if the interval has elapsed since the last update.
+	 */
+	bool due(std::size_t t) const;
+
+	/**
+	 * \brief Updates the progress of a thread.
+	 *
+	 * \param[in] t The thread.
+	 * \param[in] state The progress of the thread.
+	 */
+	void update(std::size_t t, ThreadCheckpoint state);
+
+	/**
+	 * \brief Stops the background thread, writing the final progress.
+	 *
+	 * \throw std::runtime_error if a checkpoint could not be written.
+	 */
+	void close();
+};
+
+} // namespace molstat
+
+#endif
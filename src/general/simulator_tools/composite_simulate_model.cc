@@ -13,23 +13,97 @@
  */
 
 #include "simulate_model.h"
+#include "observable.h"
 #include "simulator_exceptions.h"
+#include <cmath>
 
 namespace molstat {
 
+thread_local std::deque<std::valarray<double>>
+	SubmodelParameterBuffers::buffers;
+
+thread_local std::size_t SubmodelParameterBuffers::top = 0;
+
+SubmodelParameterBuffers::Frame::Frame(std::size_t n)
+	: base(top)
+{
+	top += n;
+	while(buffers.size() < top)
+		buffers.emplace_back();
+}
+
+SubmodelParameterBuffers::Frame::~Frame()
+{
+	top = base;
+}
+
+std::valarray<double> &SubmodelParameterBuffers::Frame::get(std::size_t k,
+	std::size_t size)
+{
+	std::valarray<double> &buffer = buffers[base + k];
+	if(buffer.size() != size)
+		buffer.resize(size);
+	return buffer;
+}
+
+void SubmodelRoutes::append(const std::vector<std::size_t> &route)
+{
+	indices.insert(indices.end(), route.begin(), route.end());
+	offsets.push_back(indices.size());
+}
+
+std::size_t SubmodelRoutes::size() const noexcept
+{
+	return offsets.size() - 1;
+}
+
+std::size_t SubmodelRoutes::routeSize(std::size_t k) const noexcept
+{
+	return offsets[k + 1] - offsets[k];
+}
+
+const std::size_t *SubmodelRoutes::route(std::size_t k) const noexcept
+{
+	return indices.data() + offsets[k];
+}
+
+void CompositeSimulateModel::addSubmodel(
+	std::shared_ptr<SimulateModel> submodel)
+{
+	// determine the parameter indices needed for this submodel
+	const std::size_t cnparam{ get_num_composite_parameters() };
+	const std::size_t snparam{ submodel->get_num_parameters() };
+	const std::size_t offset{ get_num_parameters() };
+
+	std::vector<std::size_t> sub_params( cnparam + snparam );
+	// indices from the composite model
+	for(std::size_t j = 0; j < cnparam; ++j)
+		sub_params[j] = j;
+	// indices from the submodel
+	for(std::size_t j = 0; j < snparam; ++j)
+		sub_params[j + cnparam] = offset + j;
+
+	submodels.emplace_back(submodel);
+	submodel_routes.append(sub_params);
+}
+
 CompositeSimulateModel::SubmodelParameters
 CompositeSimulateModel::routeSubmodelParameters(
 	const std::valarray<double> &cparams) const
 {
 	SubmodelParameters ret;
 
-	// go through all of the submodels
-	// submodel.first is the pointer to the submodel
-	// submodel.second is the list of indices
-	for(const auto submodel : submodels)
-		ret.emplace_back(std::make_pair(
-			submodel.first,
-			cparams[submodel.second]));
+	// go through all of the submodels, gathering the parameters on each
+	// submodel's route
+	for(std::size_t k = 0; k < submodels.size(); ++k)
+	{
+		const std::size_t *const route{ submodel_routes.route(k) };
+		std::valarray<double> subparams(submodel_routes.routeSize(k));
+		for(std::size_t p = 0; p < subparams.size(); ++p)
+			subparams[p] = cparams[route[p]];
+
+		ret.emplace_back(submodels[k], std::move(subparams));
+	}
 
 	return ret;
 }
@@ -45,37 +119,267 @@ std::size_t CompositeSimulateModel::get_num_parameters() const
 	std::size_t ret{ get_num_composite_parameters() };
 
 	// add in the parameters for each submodel
-	for(const auto submodel : submodels)
-		ret += submodel.first->get_num_parameters();
+	for(const auto &submodel : submodels)
+		ret += submodel->get_num_parameters();
 
 	return ret;
 }
 
-std::valarray<double> CompositeSimulateModel::generateParameters(
-	Engine &engine) const
+std::vector<std::string> CompositeSimulateModel::getParameterNames() const
+{
+	// first get the parameters required directly
+	std::vector<std::string> ret{ get_names() };
+	for(std::string &name : ret)
+		name = to_lower(name);
+
+	// add in the parameters for each submodel
+	for(const auto &submodel : submodels)
+	{
+		const std::vector<std::string> subnames
+			{ submodel->getParameterNames() };
+		ret.insert(ret.end(), subnames.begin(), subnames.end());
+	}
+
+	return ret;
+}
+
+void CompositeSimulateModel::generateParameters(Engine &engine,
+	double *params) const
 {
 	std::size_t tally = get_num_composite_parameters();
-	std::valarray<double> ret(get_num_parameters());
 
 	// simulate the parameters for the composite model
 	for(std::size_t j = 0; j < tally; ++j)
 	{
-		ret[j] = dists[j]->sample(engine);
+		if(!IsJointComponent(*dists[j]))
+			params[j] = dists[j]->sample(engine);
+	}
+	for(const JointParameters &joint : joint_params)
+		joint.dist->sample(engine, params, joint.slots);
+
+	// go through the submodels, having them simulate their respective
+	// parameters directly into their slots
+	for(const auto &submodel : submodels)
+	{
+		submodel->generateParameters(engine, params + tally);
+
+		// move the tally index up for the next model
+		tally += submodel->get_num_parameters();
 	}
+}
+
+void CompositeSimulateModel::appendParameterLayout(
+	ParameterLayout &layout) const
+{
+	layout.offsets.emplace_back(this, layout.distributions.size());
+
+	// the composite model's own parameters come first
+	for(std::size_t j = 0; j < get_num_composite_parameters(); ++j)
+		layout.distributions.push_back(dists[j].get());
+
+	for(const auto &submodel : submodels)
+		submodel->appendParameterLayout(layout);
+}
 
-	// go through the submodels, having them simulate their respective parameters
-	for(const auto submodel : submodels)
+void CompositeSimulateModel::generateParameterBatch(Engine &engine,
+	std::size_t ntrials, double *params) const
+{
+	std::size_t tally = get_num_composite_parameters();
+
+	// simulate the parameters for the composite model
+	for(std::size_t j = 0; j < tally; ++j)
 	{
-		std::size_t submodel_length = submodel.first->get_num_parameters();
+		if(!IsJointComponent(*dists[j]))
+			dists[j]->sample_n(engine, params + j*ntrials, ntrials);
+	}
+	for(const JointParameters &joint : joint_params)
+		joint.dist->sample_n(engine, params, ntrials, joint.slots);
 
-		ret[std::slice(tally, submodel_length, 1)]
-			= submodel.first->generateParameters(engine);
+	// go through the submodels, having them simulate their respective
+	// parameters directly into their rows
+	for(const auto &submodel : submodels)
+	{
+		submodel->generateParameterBatch(engine, ntrials,
+			params + tally*ntrials);
 
 		// move the tally index up for the next model
-		tally += submodel_length;
+		tally += submodel->get_num_parameters();
 	}
+}
 
-	return ret;
+FusedObservableFunction CompositeSimulateModel::getSubmodelFusedFunction(
+	const SimulateModel &submodel, const std::vector<ObservableIndex> &obs,
+	bool &fused)
+{
+	FusedObservableFunction ret{ submodel.getFusedObservableFunction(obs) };
+
+	fused = static_cast<bool>(ret);
+	if(fused)
+		return ret;
+
+	// calculate the observables individually
+	std::vector<ObservableFunction> funcs;
+	for(const ObservableIndex &o : obs)
+		funcs.emplace_back(submodel.getObservableFunction(o));
+
+	return [funcs] (const std::valarray<double> &params, double *out) -> void
+	{
+		for(std::size_t j = 0; j < funcs.size(); ++j)
+		{
+			try
+			{
+				out[j] = funcs[j](params);
+			}
+			catch(const NoObservableProduced &e)
+			{
+				out[j] = NoObservableValue;
+			}
+		}
+	};
+}
+
+bool CompositeSimulateModel::appendSubmodelDeviceTerms(
+	const ObservableIndex &obs, std::vector<DeviceTerm> &terms) const
+{
+	if(submodels.empty())
+		return false;
+
+	std::vector<DeviceTerm> all, subterms;
+	for(std::size_t k = 0; k < submodels.size(); ++k)
+	{
+		if(!submodels[k]->getDeviceTerms(obs, subterms))
+			return false;
+
+		// route the submodel's parameters to those of the composite model
+		const std::size_t *const route{ submodel_routes.route(k) };
+		for(DeviceTerm &term : subterms)
+		{
+			for(std::uint32_t &p : term.params)
+				p = static_cast<std::uint32_t>(route[p]);
+			all.push_back(term);
+		}
+	}
+
+	terms.insert(terms.end(), all.begin(), all.end());
+	return true;
+}
+
+void CompositeSimulateModel::markObservableParameters(
+	const ObservableIndex &obs, std::vector<bool> &used) const
+{
+	if(composite_operations.count(obs) == 0 ||
+		tabulated_observables.count(obs) > 0)
+	{
+		SimulateModel::markObservableParameters(obs, used);
+		return;
+	}
+
+	std::vector<bool> subused;
+	for(std::size_t k = 0; k < submodels.size(); ++k)
+	{
+		subused.assign(submodel_routes.routeSize(k), false);
+		submodels[k]->markObservableParameters(obs, subused);
+
+		// route the submodel's parameters to those of the composite model
+		const std::size_t *const route{ submodel_routes.route(k) };
+		for(std::size_t p = 0; p < subused.size(); ++p)
+			if(subused[p])
+				used[route[p]] = true;
+	}
+}
+
+FusedObservableFunction CompositeSimulateModel::getFusedObservableFunction(
+	const std::vector<ObservableIndex> &obs) const
+{
+	// sort the observables into composite observables (combined from the
+	// submodels) and observables implemented by the composite model itself
+	std::vector<std::size_t> slots;
+	std::vector<ObservableIndex> subobs;
+	std::vector<std::function<double(double, double)>> opers;
+	std::vector<std::pair<std::size_t, ObservableFunction>> direct;
+
+	for(std::size_t j = 0; j < obs.size(); ++j)
+	{
+		const auto oper = composite_operations.find(obs[j]);
+
+		if(oper == composite_operations.end())
+			direct.emplace_back(j, getObservableFunction(obs[j]));
+		else
+		{
+			slots.push_back(j);
+			subobs.push_back(obs[j]);
+			opers.push_back(oper->second);
+		}
+	}
+
+	if(subobs.empty() || submodels.empty())
+		return FusedObservableFunction();
+
+	// get the fused function from each submodel; submodels that don't fuse
+	// these observables calculate them individually
+	bool fused_any{ false };
+	std::vector<FusedObservableFunction> subfuncs;
+
+	for(const auto &submodel : submodels)
+	{
+		bool fused;
+		subfuncs.emplace_back(getSubmodelFusedFunction(*submodel, subobs,
+			fused));
+		fused_any = fused_any || fused;
+	}
+
+	// nothing is shared if no submodel fuses the observables
+	if(!fused_any)
+		return FusedObservableFunction();
+
+	const SubmodelRoutes routes{ submodel_routes };
+	return [slots, opers, direct, subfuncs, routes]
+		(const std::valarray<double> &params, double *out) -> void
+	{
+		// one buffer for the parameters of each submodel and one for the
+		// submodel's observables
+		SubmodelParameterBuffers::Frame frame{ subfuncs.size() + 1 };
+		std::valarray<double> &subout =
+			frame.get(subfuncs.size(), slots.size());
+
+		for(std::size_t k = 0; k < subfuncs.size(); ++k)
+		{
+			const std::size_t *const route{ routes.route(k) };
+			std::valarray<double> &subparams =
+				frame.get(k, routes.routeSize(k));
+			for(std::size_t p = 0; p < subparams.size(); ++p)
+				subparams[p] = params[route[p]];
+
+			subfuncs[k](subparams, &subout[0]);
+
+			// combine with the previous submodels; a composite observable is
+			// not produced if any submodel doesn't produce it
+			for(std::size_t c = 0; c < slots.size(); ++c)
+			{
+				double &val = out[slots[c]];
+
+				if(k == 0)
+					val = subout[c];
+				else if(std::isnan(val) || std::isnan(subout[c]))
+					val = NoObservableValue;
+				else
+					val = opers[c](val, subout[c]);
+			}
+		}
+
+		// the observables calculated directly by the composite model
+		for(const auto &func : direct)
+		{
+			try
+			{
+				out[func.first] = func.second(params);
+			}
+			catch(const NoObservableProduced &e)
+			{
+				out[func.first] = NoObservableValue;
+			}
+		}
+	};
 }
 
 } // namespace molstat
@@ -0,0 +1,121 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file device_program.h
+ * \brief The description of a simulation that runs on an accelerator (GPU),
+ *    and the per-trial code shared by the host and the device.
+ *
+ * A simulation that can run on a device is described by plain data: the
+ * (counter-based) distribution of each model parameter and, for each
+ * observable, a list of closed-form terms whose sum is the observable. The
+ * meaning of a term's kernel number is up to the backend's evaluator (see
+ * molstat::DeviceBackend). Every trial is independent, so the trials can be
+ * spread over the threads of a device.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __device_program_h__
+#define __device_program_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <general/random_distributions/device_rng.h>
+
+namespace molstat {
+
+/// The largest number of model parameters used by one molstat::DeviceTerm.
+constexpr std::size_t DeviceMaxTermParameters = 8;
+
+/// The largest number of model parameters of a simulation on a device.
+constexpr std::size_t DeviceMaxParameters = 64;
+
+/**
+ * \brief One term of an observable that is calculated on a device.
+ *
+ * The term is a closed-form function (the kernel) of some of the trial's
+ * model parameters.
+ */
+struct DeviceTerm
+{
+	/// The kernel, as numbered by the evaluator of the backend.
+	std::uint32_t kernel;
+
+	/**
+	 * \brief The indices of the kernel's model parameters, in the order the
+	 *    kernel expects them. Unused entries are 0.
+	 */
+	std::uint32_t params[DeviceMaxTermParameters];
+};
+
+/**
+ * \brief A view of a simulation for a device (pointers to arrays in the
+ *    device's memory or, on the host, in molstat::DeviceProgram).
+ */
+struct DeviceProgramView
+{
+	/// The key for the counter-based random numbers.
+	std::uint64_t key;
+
+	/// The number of model parameters.
+	std::uint32_t nparams;
+
+	/// The distribution of each model parameter.
+	const DeviceDistribution *distributions;
+
+	/// The number of observables.
+	std::uint32_t nobs;
+
+	/**
+	 * \brief The terms of observable `j` are
+	 *    `terms[term_offsets[j]]`, ..., `terms[term_offsets[j+1] - 1]`.
+	 */
+	const std::uint32_t *term_offsets;
+
+	/// The terms of the observables.
+	const DeviceTerm *terms;
+};
+
+/**
+ * \brief Simulates one trial: samples its model parameters and sums the
+ *    terms of each observable.
+ *
+ * An observable is not produced (molstat::NoObservableValue, NaN) if one of
+ * its terms is not.
+ *
+ * \tparam Evaluate The type of the evaluator, called as
+ *    `evaluate(term, params)` for each term.
+ * \param[in] program The simulation.
+ * \param[in] evaluate The evaluator of the terms.
+ * \param[in] trial The trial number.
+ * \param[out] params Storage for the model parameters.
+ * \param[out] obs Storage for the observables.
+ */
+template<typename Evaluate>
+MOLSTAT_HOST_DEVICE inline void DeviceSimulateTrial(
+	const DeviceProgramView &program, const Evaluate &evaluate,
+	const std::uint64_t trial, double *params, double *obs)
+{
+	for(std::uint32_t p = 0; p < program.nparams; ++p)
+		params[p] = DeviceSample(program.distributions[p], program.key, trial,
+			p);
+
+	for(std::uint32_t j = 0; j < program.nobs; ++j)
+	{
+		double sum{ 0. };
+		for(std::uint32_t k = program.term_offsets[j];
+			k < program.term_offsets[j + 1]; ++k)
+		{
+			sum += evaluate(program.terms[k], params);
+		}
+		obs[j] = sum;
+	}
+}
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,148 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file device_simulator.cc
+ * \brief Simulation of closed-form models on an accelerator (GPU).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "device_simulator.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "simulator.h"
+
+namespace molstat {
+
+DeviceProgramView DeviceProgram::view() const
+{
+	return DeviceProgramView{ key,
+		static_cast<std::uint32_t>(distributions.size()), distributions.data(),
+		static_cast<std::uint32_t>(term_offsets.size() - 1),
+		term_offsets.data(), terms.data() };
+}
+
+DeviceSimulator::DeviceSimulator(const Simulator &sim,
+	std::shared_ptr<const DeviceBackend> backend_, std::uint64_t key)
+	: backend(backend_), program()
+{
+	if(backend == nullptr)
+		throw std::invalid_argument("No device backend was provided.");
+
+	program = translate(sim, key);
+}
+
+DeviceProgram DeviceSimulator::translate(const Simulator &sim,
+	std::uint64_t key)
+{
+	if(sim.obs_indices.empty())
+		throw NoObservables();
+
+	if(sim.isWeighted())
+		throw std::invalid_argument("Importance sampling is not supported on " \
+			"the device.");
+	if(!sim.joint_params.empty())
+		throw std::invalid_argument("Joint distributions are not supported " \
+			"on the device.");
+
+	const std::size_t nparams{ sim.layout.distributions.size() };
+	if(nparams > DeviceMaxParameters)
+		throw std::invalid_argument("The model has too many parameters (" +
+			std::to_string(nparams) + ") for the device; the most is " +
+			std::to_string(DeviceMaxParameters) + ".");
+
+	// the distributions of the parameters
+	const std::vector<std::string> names{ sim.getParameterNames() };
+	DeviceProgram program;
+	program.key = key;
+	program.distributions.resize(nparams);
+	for(std::size_t p = 0; p < nparams; ++p)
+	{
+		const RandomDistribution &dist = *sim.layout.distributions[p];
+		if(!dist.getDeviceDistribution(program.distributions[p]))
+			throw std::invalid_argument("The distribution of parameter \"" +
+				names[p] + "\" cannot be sampled on the device: " + dist.info());
+	}
+
+	// the terms of the observables
+	std::vector<DeviceTerm> terms;
+	program.term_offsets.push_back(0);
+	for(std::size_t j = 0; j < sim.obs_indices.size(); ++j)
+	{
+		if(!sim.model->getDeviceTerms(sim.obs_indices[j], terms))
+			throw std::invalid_argument("Observable " + std::to_string(j + 1) +
+				" is not implemented on the device for this model.");
+
+		for(const DeviceTerm &term : terms)
+			for(const std::uint32_t p : term.params)
+				if(p >= nparams)
+					throw std::logic_error("A device term refers to a parameter " \
+						"that is not in the model.");
+
+		program.terms.insert(program.terms.end(), terms.begin(), terms.end());
+		program.term_offsets.push_back(
+			static_cast<std::uint32_t>(program.terms.size()));
+	}
+
+	return program;
+}
+
+std::size_t DeviceSimulator::simulateBatch(std::uint64_t first,
+	std::size_t ntrials, double *out, std::size_t *rejections) const
+{
+	const std::size_t nobs{ numObservables() };
+
+	backend->simulate(program, first, ntrials, out);
+
+	// keep the trials that produced every observable, moving them forward
+	std::size_t nvalid{ 0 };
+	for(std::size_t t = 0; t < ntrials; ++t)
+	{
+		const double *const row{ out + t*nobs };
+
+		bool valid{ true };
+		for(std::size_t j = 0; j < nobs; ++j)
+		{
+			if(std::isnan(row[j]))
+			{
+				valid = false;
+				if(rejections != nullptr)
+					++rejections[j];
+			}
+		}
+
+		if(valid)
+		{
+			if(nvalid != t)
+				std::memmove(out + nvalid*nobs, row, nobs * sizeof(double));
+			++nvalid;
+		}
+	}
+
+	return nvalid;
+}
+
+void DeviceSimulator::generateParameters(std::uint64_t trial, double *params)
+	const
+{
+	for(std::size_t p = 0; p < program.distributions.size(); ++p)
+		params[p] = DeviceSample(program.distributions[p], program.key, trial,
+			static_cast<std::uint32_t>(p));
+}
+
+std::size_t DeviceSimulator::numObservables() const noexcept
+{
+	return program.term_offsets.size() - 1;
+}
+
+std::string DeviceSimulator::info() const
+{
+	return backend->info();
+}
+
+} // namespace molstat
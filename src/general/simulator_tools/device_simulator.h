@@ -0,0 +1,238 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file device_simulator.h
+ * \brief Simulation of closed-form models on an accelerator (GPU).
+ *
+ * A molstat::DeviceSimulator translates a molstat::Simulator into a
+ * molstat::DeviceProgram, if its model and distributions support it, and
+ * runs the trials with a molstat::DeviceBackend. The results have the same
+ * form as those of molstat::Simulator::simulateBatch, so they are binned
+ * into the same histograms.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __device_simulator_h__
+#define __device_simulator_h__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "device_program.h"
+
+namespace molstat {
+
+class Simulator;
+
+/**
+ * \brief A simulation for a device, stored on the host.
+ *
+ * Backends copy the arrays to the device and use view() there.
+ */
+struct DeviceProgram
+{
+	/// The key for the counter-based random numbers.
+	std::uint64_t key;
+
+	/// The distribution of each model parameter.
+	std::vector<DeviceDistribution> distributions;
+
+	/**
+	 * \brief The offsets of each observable's terms, with the total number
+	 *    of terms at the end.
+	 */
+	std::vector<std::uint32_t> term_offsets;
+
+	/// The terms of the observables.
+	std::vector<DeviceTerm> terms;
+
+	/**
+	 * \brief Gets a view of the program's arrays on the host.
+	 *
+	 * \return The view.
+	 */
+	DeviceProgramView view() const;
+};
+
+/**
+ * \brief Interface for running the trials of a molstat::DeviceProgram.
+ *
+ * Each backend knows a set of kernels (see molstat::DeviceTerm).
+ */
+class DeviceBackend
+{
+public:
+	virtual ~DeviceBackend() = default;
+
+	/**
+	 * \brief Simulates a range of trials.
+	 *
+	 * Several threads may call this function at once.
+	 *
+	 * \param[in] program The simulation.
+	 * \param[in] first The first trial.
+	 * \param[in] ntrials The number of trials.
+	 * \param[out] out Storage for `ntrials * nobs` observables, row-major
+	 *    (one row per trial); observables that are not produced are
+	 *    molstat::NoObservableValue.
+	 */
+	virtual void simulate(const DeviceProgram &program, std::uint64_t first,
+		std::size_t ntrials, double *out) const = 0;
+
+	/**
+	 * \brief A description of the backend (and its device).
+	 *
+	 * \return The description.
+	 */
+	virtual std::string info() const = 0;
+};
+
+/**
+ * \brief Backend that runs the device code on the host, one trial after
+ *    another.
+ *
+ * This is the reference for the other backends: they run the same
+ * molstat::DeviceSimulateTrial with the same evaluator, and produce the
+ * same trials (to rounding in the device's math library).
+ *
+ * \tparam Evaluate The evaluator of the kernels; see
+ *    molstat::DeviceSimulateTrial.
+ */
+template<typename Evaluate>
+class HostDeviceBackend : public DeviceBackend
+{
+public:
+	virtual ~HostDeviceBackend() = default;
+
+	virtual void simulate(const DeviceProgram &program, std::uint64_t first,
+		std::size_t ntrials, double *out) const override
+	{
+		const DeviceProgramView view{ program.view() };
+		const Evaluate evaluate{};
+		double params[DeviceMaxParameters];
+
+		for(std::size_t t = 0; t < ntrials; ++t)
+			DeviceSimulateTrial(view, evaluate, first + t, params,
+				out + t*view.nobs);
+	}
+
+	virtual std::string info() const override
+	{
+		return "host (reference implementation)";
+	}
+};
+
+/**
+ * \brief Simulates the trials of a molstat::Simulator with a
+ *    molstat::DeviceBackend.
+ *
+ * The model parameters are sampled with counter-based random numbers (see
+ * molstat::DeviceSample), so each trial depends only on the key and its
+ * (global) number. They are thus independent of the threads, processes, and
+ * devices, but differ from those of molstat::Simulator::simulateBatch.
+ *
+ * This requires that every model parameter be sampled independently (no
+ * joint distributions or importance sampling) from a distribution with a
+ * device description (see
+ * molstat::RandomDistribution::getDeviceDistribution), and that the model
+ * describe each observable with terms (see
+ * molstat::SimulateModel::getDeviceTerms).
+ */
+class DeviceSimulator
+{
+private:
+	/// The backend.
+	std::shared_ptr<const DeviceBackend> backend;
+
+	/// The simulation.
+	DeviceProgram program;
+
+public:
+	DeviceSimulator() = delete;
+
+	/**
+	 * \brief Translates a simulator for a backend.
+	 *
+	 * The translation uses the simulator's current distributions and
+	 * observables; it must be repeated if they change.
+	 *
+	 * \throw molstat::NoObservables if the simulator has no observables.
+	 * \throw std::invalid_argument if the backend is nullptr or the
+	 *    simulation cannot run on a device. The message gives the reason.
+	 *
+	 * \param[in] sim The simulator.
+	 * \param[in] backend_ The backend.
+	 * \param[in] key The key for the counter-based random numbers.
+	 */
+	DeviceSimulator(const Simulator &sim,
+		std::shared_ptr<const DeviceBackend> backend_, std::uint64_t key);
+
+	/**
+	 * \brief Translates a simulator into a description for a device.
+	 *
+	 * This is the translation done by the constructor, without a backend.
+	 * The description also tells which distributions and closed-form terms
+	 * make up each observable (see, e.g., molstat::AnalyticSolver).
+	 *
+	 * \throw molstat::NoObservables if the simulator has no observables.
+	 * \throw std::invalid_argument if the simulation cannot be described for
+	 *    a device. The message gives the reason.
+	 *
+	 * \param[in] sim The simulator.
+	 * \param[in] key The key for the counter-based random numbers.
+	 * \return The description.
+	 */
+	static DeviceProgram translate(const Simulator &sim, std::uint64_t key);
+
+	/**
+	 * \brief Simulates a batch of trials into a preallocated buffer.
+	 *
+	 * This is molstat::Simulator::simulateBatch for trials `first`, ...,
+	 * `first + ntrials - 1`: trials that do not produce all of the
+	 * observables are discarded, and the others are stored contiguously
+	 * (row-major) at the front of `out`.
+	 *
+	 * \param[in] first The first trial.
+	 * \param[in] ntrials The number of trials.
+	 * \param[out] out Storage for `ntrials * numObservables()` values.
+	 * \param[in,out] rejections If not nullptr, an array of
+	 *    `numObservables()` tallies; each is incremented for every trial that
+	 *    does not produce the corresponding observable.
+	 * \return The number of trials that produced all of the observables.
+	 */
+	std::size_t simulateBatch(std::uint64_t first, std::size_t ntrials,
+		double *out, std::size_t *rejections = nullptr) const;
+
+	/**
+	 * \brief Generates the model parameters of a trial, as they are sampled
+	 *    on the device.
+	 *
+	 * \param[in] trial The trial.
+	 * \param[out] params Storage for the model parameters.
+	 */
+	void generateParameters(std::uint64_t trial, double *params) const;
+
+	/**
+	 * \brief Gets the number of observables.
+	 *
+	 * \return The number of observables.
+	 */
+	std::size_t numObservables() const noexcept;
+
+	/**
+	 * \brief A description of the backend.
+	 *
+	 * \return The description.
+	 */
+	std::string info() const;
+};
+
+} // namespace molstat
+
+#endif
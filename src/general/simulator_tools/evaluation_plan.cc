@@ -0,0 +1,254 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file evaluation_plan.cc
+ * \brief Implements the molstat::EvaluationPlan class.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "evaluation_plan.h"
+#include "simulator_exceptions.h"
+#include <algorithm>
+#include <cmath>
+#include <general/event_trace.h>
+
+namespace molstat {
+
+EvaluationPlan::EvaluationPlan()
+	: kernels(), operations(), steps(), first_step(1, 0), nscratch(0),
+	terms(), term_combine()
+{
+}
+
+EvaluationPlan::EvaluationPlan(const SimulateModel &model,
+	const std::vector<ObservableIndex> &obs)
+	: EvaluationPlan()
+{
+	// the model's parameters are the plan's parameters
+	std::vector<std::size_t> slots(model.get_num_parameters());
+	for(std::size_t p = 0; p < slots.size(); ++p)
+		slots[p] = p;
+
+	for(const ObservableIndex &o : obs)
+	{
+		std::vector<std::size_t> starts{ steps.size() };
+		lower(model, o, slots, 0, 1, &starts);
+		first_step.push_back(steps.size());
+
+		// the first term is evaluated into register 0, and each later term
+		// into register 1, followed by the step that combines them
+		std::vector<Term> oterms;
+		starts.push_back(steps.size());
+		for(std::size_t k = 0; k + 1 < starts.size(); ++k)
+			oterms.push_back({ starts[k], starts[k + 1] - (k > 0 ? 1 : 0),
+				std::size_t(k > 0 ? 1 : 0), {} });
+
+		for(Term &term : oterms)
+		{
+			for(std::size_t s = term.begin; s < term.end; ++s)
+				if(steps[s].type == StepType::Kernel)
+					term.slots.insert(term.slots.end(),
+						kernels[steps[s].index].slots.begin(),
+						kernels[steps[s].index].slots.end());
+			std::sort(term.slots.begin(), term.slots.end());
+			term.slots.erase(std::unique(term.slots.begin(), term.slots.end()),
+				term.slots.end());
+		}
+
+		term_combine.push_back(oterms.size() > 1 ?
+			steps[oterms[1].end] : Step{ StepType::Kernel, 0, 0, 0 });
+		terms.push_back(std::move(oterms));
+	}
+}
+
+void EvaluationPlan::lower(const SimulateModel &model,
+	const ObservableIndex &obs, const std::vector<std::size_t> &slots,
+	std::size_t dst, std::size_t next, std::vector<std::size_t> *starts)
+{
+	// composite observables are combined from the submodels, unless the
+	// composite model tabulated the observable
+	const CompositeSimulateModel *cmodel
+		{ dynamic_cast<const CompositeSimulateModel *>(&model) };
+	if(cmodel == nullptr || model.tabulated_observables.count(obs) > 0 ||
+		cmodel->composite_operations.count(obs) == 0)
+	{
+		// getBatchObservableFunction throws IncompatibleObservable if the
+		// model and observable are incompatible
+		kernels.push_back({ model.getBatchObservableFunction(obs), slots });
+		steps.push_back({ StepType::Kernel, kernels.size() - 1, dst, 0 });
+		return;
+	}
+
+	if(cmodel->submodels.empty())
+		throw NoSubmodels();
+
+	// the operation, inline if it is recognized
+	const std::function<double(double, double)> &oper =
+		cmodel->composite_operations.at(obs);
+	StepType type{ StepType::Combine };
+	std::size_t index{ 0 };
+	if(oper.target<std::plus<double>>() != nullptr)
+		type = StepType::Add;
+	else if(oper.target<std::multiplies<double>>() != nullptr)
+		type = StepType::Multiply;
+	else
+	{
+		operations.push_back(oper);
+		index = operations.size() - 1;
+	}
+
+	for(std::size_t k = 0; k < cmodel->submodels.size(); ++k)
+	{
+		// the submodel's parameters, as indices in the plan's parameters
+		const std::size_t *const route{ cmodel->submodel_routes.route(k) };
+		std::vector<std::size_t> subslots(
+			cmodel->submodel_routes.routeSize(k));
+		for(std::size_t p = 0; p < subslots.size(); ++p)
+			subslots[p] = slots[route[p]];
+
+		if(k == 0)
+			lower(*cmodel->submodels[k], obs, subslots, dst, next);
+		else
+		{
+			// evaluate into the next scratch register and combine
+			if(starts != nullptr)
+				starts->push_back(steps.size());
+			nscratch = std::max(nscratch, next);
+			lower(*cmodel->submodels[k], obs, subslots, next, next + 1);
+			steps.push_back({ type, index, dst, next });
+		}
+	}
+}
+
+void EvaluationPlan::evaluate(std::size_t j, const double *const *params,
+	std::size_t ntrials, double *out, double *scratch) const
+{
+	run(first_step[j], first_step[j + 1], 0, params, ntrials, out, scratch);
+}
+
+void EvaluationPlan::run(std::size_t begin, std::size_t end,
+	std::size_t base, const double *const *params, std::size_t ntrials,
+	double *out, double *scratch) const
+{
+	if(ntrials == 0)
+		return;
+
+	// register `base` is the output; the scratch registers follow register 0
+	// (which is unused when it is not the output)
+	const auto reg = [out, scratch, ntrials, base] (std::size_t r) -> double *
+	{
+		return r == base ? out : scratch + (r - 1) * ntrials;
+	};
+
+	std::vector<const double *> kparams;
+
+	for(std::size_t s = begin; s < end; ++s)
+	{
+		const Step &step = steps[s];
+		double *const dst{ reg(step.dst) };
+
+		if(step.type == StepType::Kernel)
+		{
+			MOLSTAT_TRACE_EVENT("submodel observable");
+			const Kernel &kernel = kernels[step.index];
+			kparams.resize(kernel.slots.size());
+			for(std::size_t p = 0; p < kernel.slots.size(); ++p)
+				kparams[p] = params[kernel.slots[p]];
+
+			kernel.function(kparams.data(), kparams.size(), ntrials, dst);
+		}
+		else
+			combine(step, ntrials, dst, reg(step.src));
+	}
+}
+
+void EvaluationPlan::combine(const Step &step, std::size_t ntrials,
+	double *dst, const double *src) const
+{
+	switch(step.type)
+	{
+	// the arithmetic already propagates molstat::NoObservableValue (NaN)
+	case StepType::Add:
+		for(std::size_t t = 0; t < ntrials; ++t)
+			dst[t] += src[t];
+		break;
+
+	case StepType::Multiply:
+		for(std::size_t t = 0; t < ntrials; ++t)
+			dst[t] *= src[t];
+		break;
+
+	case StepType::Combine:
+	{
+		const std::function<double(double, double)> &oper =
+			operations[step.index];
+		for(std::size_t t = 0; t < ntrials; ++t)
+		{
+			if(std::isnan(dst[t]) || std::isnan(src[t]))
+				dst[t] = NoObservableValue;
+			else
+				dst[t] = oper(dst[t], src[t]);
+		}
+		break;
+	}
+
+	case StepType::Kernel:
+	default:
+		break;
+	}
+}
+
+std::size_t EvaluationPlan::numTerms(std::size_t j) const
+{
+	return terms.at(j).size();
+}
+
+const std::vector<std::size_t> &EvaluationPlan::termSlots(std::size_t j,
+	std::size_t k) const
+{
+	return terms.at(j).at(k).slots;
+}
+
+void EvaluationPlan::evaluateTerm(std::size_t j, std::size_t k,
+	const double *const *params, std::size_t ntrials, double *out,
+	double *scratch) const
+{
+	const Term &term = terms.at(j).at(k);
+	run(term.begin, term.end, term.base, params, ntrials, out, scratch);
+}
+
+void EvaluationPlan::combineTerms(std::size_t j, const double *const *values,
+	std::size_t ntrials, double *out) const
+{
+	std::copy(values[0], values[0] + ntrials, out);
+	for(std::size_t k = 1; k < terms.at(j).size(); ++k)
+		combine(term_combine[j], ntrials, out, values[k]);
+}
+
+std::size_t EvaluationPlan::numObservables() const noexcept
+{
+	return first_step.size() - 1;
+}
+
+std::size_t EvaluationPlan::numScratch() const noexcept
+{
+	return nscratch;
+}
+
+std::size_t EvaluationPlan::numKernels() const noexcept
+{
+	return kernels.size();
+}
+
+const std::vector<EvaluationPlan::Step> &EvaluationPlan::getSteps() const
+	noexcept
+{
+	return steps;
+}
+
+} // namespace molstat
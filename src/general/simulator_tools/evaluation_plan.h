@@ -0,0 +1,301 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file evaluation_plan.h
+ * \brief Defines the molstat::EvaluationPlan class, which evaluates the
+ *    observables of a model from a flat list of steps.
+ *
+ * The batch function of a composite observable (see
+ * molstat::CompositeObservable) calls the batch function of each submodel
+ * through nested closures, and each submodel may itself be composite. An
+ * evaluation plan lowers this tree, once, into a flat list: a kernel for each
+ * submodel that calculates an observable directly (with the indices of its
+ * parameters in the flattened model parameters; see
+ * molstat::ParameterLayout), and a step for each combination of two
+ * submodels' values. Evaluating a batch is then a loop over the steps.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __evaluation_plan_h__
+#define __evaluation_plan_h__
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "simulate_model.h"
+
+namespace molstat {
+
+/**
+ * \brief A flat plan for evaluating the observables of a model for a batch
+ *    of trials.
+ *
+ * Each observable is evaluated into a register: register 0 is the output,
+ * and the others are scratch space (each `ntrials` long) for the values of
+ * the submodels that are combined with it. A composite observable is lowered
+ * through the submodels whenever the composite model combines them with an
+ * operation (and has not tabulated the observable); the first submodel is
+ * evaluated into the observable's register and each later submodel into a
+ * scratch register, which is then combined with it. Other observables
+ * (including those with specialized kernels or tables) are kernels.
+ *
+ * Addition and multiplication (`std::plus<double>` and
+ * `std::multiplies<double>`) are recognized and applied inline; other
+ * operations are called through their `std::function`. As with the batch
+ * function of the composite observable, an observable is not produced
+ * (molstat::NoObservableValue) if any submodel does not produce it.
+ *
+ * The steps of each of the model's submodels (the terms of the observable)
+ * can also be evaluated separately, and the terms then combined. A term's
+ * value depends only on the parameters it reads (see termSlots()), so it
+ * can be kept when only the other parameters change (see
+ * molstat::ContributionCache). Because the terms are combined again in
+ * their original order, this works for any operation, and the combined
+ * values are identical to those of evaluate().
+ */
+class EvaluationPlan
+{
+public:
+	/// The types of steps.
+	enum class StepType
+	{
+		Kernel, ///< Evaluates a kernel into the destination register.
+		Add, ///< Adds the source register to the destination register.
+		Multiply, ///< Multiplies the destination register by the source.
+		Combine ///< Combines the registers with a general operation.
+	};
+
+	/// One step of the plan.
+	struct Step
+	{
+		/// The type of step.
+		StepType type;
+
+		/// The kernel (or operation, for StepType::Combine); unused otherwise.
+		std::size_t index;
+
+		/// The destination register.
+		std::size_t dst;
+
+		/// The source register (unused for StepType::Kernel).
+		std::size_t src;
+	};
+
+	/// The steps of one term of an observable.
+	struct Term
+	{
+		/// The first step.
+		std::size_t begin;
+
+		/// One past the last step.
+		std::size_t end;
+
+		/// The register of the term's value.
+		std::size_t base;
+
+		/// The (sorted) indices of the parameters read by the term.
+		std::vector<std::size_t> slots;
+	};
+
+private:
+	/// A submodel's batch function and the indices of its parameters.
+	struct Kernel
+	{
+		/// The batch function.
+		BatchObservableFunction function;
+
+		/// The indices of the submodel's parameters in the model parameters.
+		std::vector<std::size_t> slots;
+	};
+
+	/// The kernels.
+	std::vector<Kernel> kernels;
+
+	/// The general operations, for StepType::Combine.
+	std::vector<std::function<double(double, double)>> operations;
+
+	/// The steps, for all of the observables.
+	std::vector<Step> steps;
+
+	/**
+	 * \brief The first step of each observable; the steps of observable `j`
+	 *    are `[first_step[j], first_step[j+1])`.
+	 */
+	std::vector<std::size_t> first_step;
+
+	/// The number of scratch registers.
+	std::size_t nscratch;
+
+	/// The terms of each observable.
+	std::vector<std::vector<Term>> terms;
+
+	/**
+	 * \brief The step that combines each later term with the first, for
+	 *    each observable (unused with only one term).
+	 */
+	std::vector<Step> term_combine;
+
+	/**
+	 * \brief Runs some of the steps.
+	 *
+	 * \param[in] begin The first step.
+	 * \param[in] end One past the last step.
+	 * \param[in] base The register stored in `out`.
+	 * \param[in] params The model parameters.
+	 * \param[in] ntrials The number of trials.
+	 * \param[out] out Storage for the register `base`.
+	 * \param[out] scratch Storage for the scratch registers.
+	 */
+	void run(std::size_t begin, std::size_t end, std::size_t base,
+		const double *const *params, std::size_t ntrials, double *out,
+		double *scratch) const;
+
+	/**
+	 * \brief Applies a combination step.
+	 *
+	 * \param[in] step The step.
+	 * \param[in] ntrials The number of trials.
+	 * \param[in,out] dst The values that are combined with `src`.
+	 * \param[in] src The other values.
+	 */
+	void combine(const Step &step, std::size_t ntrials, double *dst,
+		const double *src) const;
+
+	/**
+	 * \brief Appends the steps that evaluate an observable of a (sub)model.
+	 *
+	 * \throw molstat::IncompatibleObservable if the observable is
+	 *    incompatible with the model or one of its submodels.
+	 * \throw molstat::NoSubmodels if a composite model has no submodels.
+	 *
+	 * \param[in] model The model.
+	 * \param[in] obs The observable.
+	 * \param[in] slots The indices of the model's parameters in the model
+	 *    parameters of the plan.
+	 * \param[in] dst The register for the observable.
+	 * \param[in] next The first scratch register that is not in use.
+	 * \param[out] starts If not nullptr, the first step of each submodel
+	 *    after the first is appended (when the observable is combined from
+	 *    the submodels).
+	 */
+	void lower(const SimulateModel &model, const ObservableIndex &obs,
+		const std::vector<std::size_t> &slots, std::size_t dst,
+		std::size_t next, std::vector<std::size_t> *starts = nullptr);
+
+public:
+	/**
+	 * \brief Constructs an empty plan (with no observables).
+	 */
+	EvaluationPlan();
+
+	/**
+	 * \brief Lowers the observables of a model into a plan.
+	 *
+	 * \throw molstat::IncompatibleObservable if an observable is
+	 *    incompatible with the model or one of its submodels.
+	 * \throw molstat::NoSubmodels if a composite model has no submodels.
+	 *
+	 * \param[in] model The model.
+	 * \param[in] obs The observables.
+	 */
+	EvaluationPlan(const SimulateModel &model,
+		const std::vector<ObservableIndex> &obs);
+
+	/**
+	 * \brief Evaluates one observable for a batch of trials.
+	 *
+	 * \param[in] j The observable.
+	 * \param[in] params The model parameters, as for
+	 *    molstat::BatchObservableFunction.
+	 * \param[in] ntrials The number of trials.
+	 * \param[out] out Storage for the `ntrials` values of the observable.
+	 * \param[out] scratch Storage for `numScratch() * ntrials` values.
+	 */
+	void evaluate(std::size_t j, const double *const *params,
+		std::size_t ntrials, double *out, double *scratch) const;
+
+	/**
+	 * \brief Gets the number of terms of an observable.
+	 *
+	 * An observable of a composite model that is combined from its
+	 * submodels has a term for each submodel; any other observable has one
+	 * term.
+	 *
+	 * \param[in] j The observable.
+	 * \return The number of terms.
+	 */
+	std::size_t numTerms(std::size_t j) const;
+
+	/**
+	 * \brief Gets the model parameters read by a term.
+	 *
+	 * \param[in] j The observable.
+	 * \param[in] k The term.
+	 * \return The (sorted) indices of the parameters.
+	 */
+	const std::vector<std::size_t> &termSlots(std::size_t j, std::size_t k)
+		const;
+
+	/**
+	 * \brief Evaluates one term of an observable for a batch of trials.
+	 *
+	 * \param[in] j The observable.
+	 * \param[in] k The term.
+	 * \param[in] params The model parameters, as for evaluate().
+	 * \param[in] ntrials The number of trials.
+	 * \param[out] out Storage for the `ntrials` values of the term.
+	 * \param[out] scratch Storage for `numScratch() * ntrials` values.
+	 */
+	void evaluateTerm(std::size_t j, std::size_t k,
+		const double *const *params, std::size_t ntrials, double *out,
+		double *scratch) const;
+
+	/**
+	 * \brief Combines the terms of an observable.
+	 *
+	 * \param[in] j The observable.
+	 * \param[in] values The values of the terms; term `k` of trial `t` is
+	 *    `values[k][t]`.
+	 * \param[in] ntrials The number of trials.
+	 * \param[out] out Storage for the `ntrials` values of the observable.
+	 */
+	void combineTerms(std::size_t j, const double *const *values,
+		std::size_t ntrials, double *out) const;
+
+	/**
+	 * \brief Gets the number of observables.
+	 *
+	 * \return The number of observables.
+	 */
+	std::size_t numObservables() const noexcept;
+
+	/**
+	 * \brief Gets the number of scratch registers needed by evaluate().
+	 *
+	 * \return The number of scratch registers.
+	 */
+	std::size_t numScratch() const noexcept;
+
+	/**
+	 * \brief Gets the number of kernels.
+	 *
+	 * \return The number of kernels.
+	 */
+	std::size_t numKernels() const noexcept;
+
+	/**
+	 * \brief Gets the steps of the plan.
+	 *
+	 * \return The steps, for all of the observables.
+	 */
+	const std::vector<Step> &getSteps() const noexcept;
+};
+
+} // namespace molstat
+
+#endif
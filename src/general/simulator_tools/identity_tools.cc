@@ -16,6 +16,16 @@
 
 namespace molstat {
 
+IdentityModel::IdentityModel()
+{
+	setObservableKernel<IdentityObservable, IdentityModel>(
+		[] (const IdentityModel &model, const std::valarray<double> &params)
+			-> double
+		{
+			return model.IdentityModel::identity(params);
+		});
+}
+
 std::vector<std::string> IdentityModel::get_names() const
 {
 	return { "parameter" };
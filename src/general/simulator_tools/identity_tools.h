@@ -46,6 +46,9 @@ protected:
 	virtual std::vector<std::string> get_names() const override;
 
 public:
+	/// Constructor registering the batch kernel for the identity observable.
+	IdentityModel();
+
 	virtual double identity(const std::valarray<double> &params) const override;
 };
 
@@ -16,10 +16,14 @@
 #ifndef __observable_h__
 #define __observable_h__
 
+#include <cmath>
+#include <deque>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <utility>
 #include <valarray>
+#include <vector>
 #include <typeinfo>
 #include <typeindex>
 #include <functional>
@@ -44,11 +48,13 @@ namespace molstat {
  * the molstat::SimulateModel, letting the runtime know that the model and
  * observable are \"compatible\".
  *
- * The observable function of the subclass may throw
- * molstat::NoObservableProduced if the specified set of model parameters does
+ * The observable function of the subclass should return
+ * molstat::NoObservableValue if the specified set of model parameters does
  * not result in the observable being emitted by the system. (Not all models
- * will need this feature.) The main MolStat simulator will report the number
- * of trials that do not result in an observable.
+ * will need this feature.) Throwing molstat::NoObservableProduced has the
+ * same effect, but exceptions are expensive when many trials are rejected.
+ * The main MolStat simulator will report the number of trials that do not
+ * result in each observable.
  *
  * \note When dealing with composite simulator models, the
  *    `CompositeObservable` class may be preferential to `Observable`. More
@@ -106,9 +112,91 @@ public:
 						return (cast.get()->*obsfunc)(params);
 					};
 			};
+
+		// and the generic batch version: one call through the member
+		// pointer per trial
+		batch_observables[GetObservableIndex<T>()] =
+			[obsfunc] (shared_ptr<const SimulateModel> model)
+				-> BatchObservableFunction
+			{
+				shared_ptr<const T> cast = dynamic_pointer_cast<const T>(model);
+
+				if(cast == nullptr)
+					throw IncompatibleObservable();
+
+				return [cast, obsfunc] (const double *const *params,
+					size_t nparams, size_t ntrials, double *out) -> void
+				{
+					const T *raw = cast.get();
+					EvaluateBatchObservable(
+						[raw, obsfunc] (const valarray<double> &row) -> double
+						{
+							return (raw->*obsfunc)(row);
+						}, params, nparams, ntrials, out);
+				};
+			};
 	}
 };
 
+/**
+ * \brief Per-thread, reusable storage for the parameters that a composite
+ *    observable passes to its submodels (and for the model parameters of
+ *    the simulator's trials).
+ *
+ * Each evaluation of a composite observable opens a Frame with one buffer
+ * per submodel. Frames nest (for composite submodels) and buffers keep
+ * their memory between evaluations, so routing parameters to the submodels
+ * does not allocate memory once the buffers have grown to size.
+ */
+class SubmodelParameterBuffers
+{
+private:
+	/**
+	 * \brief The buffers for this thread.
+	 *
+	 * A deque is used so that references to buffers in outer frames remain
+	 * valid as inner frames add buffers.
+	 */
+	static thread_local std::deque<std::valarray<double>> buffers;
+
+	/// The number of buffers in use by this thread.
+	static thread_local std::size_t top;
+
+public:
+	/// The buffers used by one evaluation of a composite observable.
+	class Frame
+	{
+	private:
+		/// The index of this frame's first buffer.
+		std::size_t base;
+
+	public:
+		Frame() = delete;
+		Frame(const Frame &) = delete;
+		Frame &operator=(const Frame &) = delete;
+
+		/**
+		 * \brief Opens a frame.
+		 *
+		 * \param[in] n The number of buffers needed.
+		 */
+		explicit Frame(std::size_t n);
+
+		/// Closes the frame, releasing its buffers for reuse.
+		~Frame();
+
+		/**
+		 * \brief Gets one of the frame's buffers.
+		 *
+		 * \param[in] k The index of the buffer (less than the number of
+		 *    buffers).
+		 * \param[in] size The required size of the buffer.
+		 * \return The buffer, with `size` elements.
+		 */
+		std::valarray<double> &get(std::size_t k, std::size_t size);
+	};
+};
+
 /**
  * \brief Base class for a composite observable; that is, an observable that
  *    is calculated from several submodels (used in conjunction with
@@ -180,42 +268,51 @@ protected:
 		if(cmodel->submodels.size() == 0)
 			throw NoSubmodels();
 
-		// construct a list of submodel information; that is, a list of
-		// parameters to pass to each submodel as well as the observable
-		// function.
-		std::list<std::pair<const std::valarray<size_t>,
-		                    ObservableFunction>>
-			subinfo;
+		// the observable function of each submodel, and (in one table) the
+		// indices of the parameters to pass to each submodel
+		std::vector<ObservableFunction> subfuncs;
 
 		// go through all of the submodels
-		for(const auto submodel : cmodel->submodels)
+		for(const auto &submodel : cmodel->submodels)
 		{
 			// getObservableFunction will throw IncompatibleObservable if
 			// this submodel is incompatible with the observable. let this
 			// exception pass up to the caller
-			subinfo.emplace_back(make_pair(
-				submodel.second,
-				submodel.first->getObservableFunction(oindex)));
+			subfuncs.emplace_back(submodel->getObservableFunction(oindex));
 		}
+		const SubmodelRoutes routes{ cmodel->submodel_routes };
 
 		// make the actual Observable function for the composite observable.
 		// this function goes through each submodel, calculates each
 		// "sub-observable", and combines them using the specified operation
-		return [oper, subinfo] (const std::valarray<double> &params)
+		return [oper, subfuncs, routes] (const std::valarray<double> &params)
 				-> double
 			{
 				double ret{ 0. };
 				bool isfirst{ true };
 
+				// the submodel parameters are gathered into reused buffers
+				SubmodelParameterBuffers::Frame frame{ subfuncs.size() };
+
 				// go through the submodels:
 				// calculate the observable of each and combine them using
 				// the specified operation
-				for(const auto modelinfo : subinfo)
+				for(std::size_t k = 0; k < subfuncs.size(); ++k)
 				{
-					// modelinfo.first has a valarray that filters out the
-					// correct model parameters to send to the submodel.
-					// modelinfo.second is the function
-					double obs = modelinfo.second(params[modelinfo.first]);
+					// the route has the indices of the correct model
+					// parameters to send to the submodel
+					const std::size_t *const route{ routes.route(k) };
+					std::valarray<double> &subparams =
+						frame.get(k, routes.routeSize(k));
+					for(std::size_t p = 0; p < subparams.size(); ++p)
+						subparams[p] = params[route[p]];
+
+					double obs = subfuncs[k](subparams);
+
+					// no composite observable if a submodel doesn't produce
+					// its observable
+					if(std::isnan(obs))
+						return NoObservableValue;
 
 					if(isfirst)
 					{
@@ -231,6 +328,88 @@ protected:
 			}; // end of the returned ObservableFunction
 	}
 
+	/**
+	 * \brief Generate the molstat::BatchObservableFunction for the composite
+	 *    model.
+	 *
+	 * The batch function of each submodel is evaluated on the submodel's
+	 * parameters (the parameter pointers are rearranged; no values are
+	 * copied), and the results are combined trial-by-trial.
+	 *
+	 * \throw molstat::IncompatibleObservable if any of the underlying submodels
+	 *    are incompatible with the observable.
+	 * \throw molstat::NoSubmodels if the composite model has no submodels.
+	 * \throw molstat::NotCompositeSimulateModel if the model is not a composite
+	 *    model.
+	 *
+	 * \param[in] oper Operation used to combine the observables from two
+	 *    submodels.
+	 * \param[in] model Calculate the observable using this model.
+	 * \return The function that calculates the observable for a batch.
+	 */
+	static BatchObservableFunction getCompositeBatchObservableFunction(
+		const std::function<double(double,double)> &oper,
+		const std::shared_ptr<const SimulateModel> model)
+	{
+		const ObservableIndex oindex{ GetObservableIndex<T>() };
+
+		std::shared_ptr<const CompositeSimulateModel> cmodel
+			= std::dynamic_pointer_cast<const CompositeSimulateModel>(model);
+
+		if(cmodel == nullptr)
+			throw NotCompositeSimulateModel();
+		if(cmodel->submodels.size() == 0)
+			throw NoSubmodels();
+
+		// the batch function of each submodel, and the parameter indices
+		std::vector<BatchObservableFunction> subfuncs;
+
+		for(const auto &submodel : cmodel->submodels)
+			subfuncs.emplace_back(submodel->getBatchObservableFunction(oindex));
+		const SubmodelRoutes routes{ cmodel->submodel_routes };
+
+		return [oper, subfuncs, routes] (const double *const *params,
+			std::size_t nparams, std::size_t ntrials, double *out) -> void
+		{
+			if(ntrials == 0)
+				return;
+
+			// storage for each submodel's observable (after the first)
+			SubmodelParameterBuffers::Frame frame{ 1 };
+			std::valarray<double> &subout = frame.get(0, ntrials);
+
+			std::vector<const double *> subparams;
+
+			for(std::size_t k = 0; k < subfuncs.size(); ++k)
+			{
+				const std::size_t *const route{ routes.route(k) };
+				subparams.resize(routes.routeSize(k));
+				for(std::size_t p = 0; p < subparams.size(); ++p)
+					subparams[p] = params[route[p]];
+
+				if(k == 0)
+				{
+					subfuncs[k](subparams.data(), subparams.size(), ntrials,
+						out);
+					continue;
+				}
+
+				subfuncs[k](subparams.data(), subparams.size(), ntrials,
+					&subout[0]);
+
+				// no composite observable if a submodel doesn't produce its
+				// observable
+				for(std::size_t t = 0; t < ntrials; ++t)
+				{
+					if(std::isnan(out[t]) || std::isnan(subout[t]))
+						out[t] = NoObservableValue;
+					else
+						out[t] = oper(out[t], subout[t]);
+				}
+			}
+		};
+	}
+
 public:
 	CompositeObservable() = delete;
 	virtual ~CompositeObservable() = default;
@@ -264,6 +443,11 @@ public:
 		// add the function to the list of compatible observables
 		compatible_observables[oindex] = std::bind(
 			getCompositeObservableFunction, oper, _1);
+		batch_observables[oindex] = std::bind(
+			getCompositeBatchObservableFunction, oper, _1);
+
+		// and the operation, for fusing observables
+		composite_operations[oindex] = oper;
 	}
 };
 
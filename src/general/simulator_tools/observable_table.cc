@@ -0,0 +1,203 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file observable_table.cc
+ * \brief Implements tabulation and interpolation of observables.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "observable_table.h"
+#include "simulator_exceptions.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace molstat {
+
+constexpr std::size_t ObservableTable::max_size;
+
+ObservableTable::ObservableTable(const ObservableFunction &f,
+	const std::vector<std::pair<double, double>> &ranges,
+	std::size_t npoints_)
+	: lower(ranges.size()), upper(ranges.size()), spacing(ranges.size(), 0.),
+	  varying(), strides(), values(), npoints(npoints_)
+{
+	if(npoints < 2)
+		throw std::invalid_argument("A table needs at least 2 points for " \
+			"each parameter.");
+
+	std::size_t nvalues{ 1 };
+	for(std::size_t p = 0; p < ranges.size(); ++p)
+	{
+		lower[p] = ranges[p].first;
+		upper[p] = ranges[p].second;
+
+		if(!(upper[p] >= lower[p]) || !std::isfinite(lower[p]) ||
+			!std::isfinite(upper[p]))
+		{
+			throw std::invalid_argument("Invalid range for a tabulated " \
+				"parameter.");
+		}
+
+		if(upper[p] > lower[p])
+		{
+			spacing[p] = (upper[p] - lower[p]) / (npoints - 1);
+			varying.push_back(p);
+			strides.push_back(nvalues);
+
+			if(nvalues > max_size / npoints)
+				throw std::invalid_argument("The table is too large.");
+			nvalues *= npoints;
+		}
+	}
+
+	// evaluate the observable at each grid point
+	values.resize(nvalues);
+	std::valarray<double> params(ranges.size());
+	for(std::size_t p = 0; p < ranges.size(); ++p)
+		params[p] = lower[p];
+
+	for(std::size_t j = 0; j < nvalues; ++j)
+	{
+		for(std::size_t k = 0; k < varying.size(); ++k)
+		{
+			const std::size_t p{ varying[k] };
+			params[p] = lower[p] + spacing[p] * ((j / strides[k]) % npoints);
+		}
+
+		try
+		{
+			values[j] = f(params);
+		}
+		catch(const NoObservableProduced &e)
+		{
+			values[j] = NoObservableValue;
+		}
+	}
+}
+
+std::size_t ObservableTable::size() const noexcept
+{
+	return values.size();
+}
+
+double ObservableTable::interpolate(const std::valarray<double> &params)
+	const
+{
+	// single-valued parameters must match exactly
+	for(std::size_t p = 0; p < lower.size(); ++p)
+	{
+		if(spacing[p] == 0. && params[p] != lower[p])
+			return NoObservableValue;
+	}
+
+	// find the cell and the position within it for each varying parameter
+	const std::size_t nvary{ varying.size() };
+	std::size_t base{ 0 };
+	// each varying parameter has at least 2 points, so at most 24 of them
+	// fit in max_size values
+	double frac[24];
+
+	for(std::size_t k = 0; k < nvary; ++k)
+	{
+		const std::size_t p{ varying[k] };
+		if(!(params[p] >= lower[p] && params[p] <= upper[p]))
+			return NoObservableValue;
+
+		const double x{ (params[p] - lower[p]) / spacing[p] };
+		std::size_t cell{ static_cast<std::size_t>(x) };
+		if(cell >= npoints - 1)
+			cell = npoints - 2;
+
+		frac[k] = x - cell;
+		base += cell * strides[k];
+	}
+
+	// combine the corners of the cell
+	double ret{ 0. };
+	for(std::size_t corner = 0; corner < (std::size_t(1) << nvary); ++corner)
+	{
+		double weight{ 1. };
+		std::size_t index{ base };
+
+		for(std::size_t k = 0; k < nvary; ++k)
+		{
+			if(corner & (std::size_t(1) << k))
+			{
+				weight *= frac[k];
+				index += strides[k];
+			}
+			else
+				weight *= 1. - frac[k];
+		}
+
+		ret += weight * values[index];
+	}
+
+	return ret;
+}
+
+std::vector<std::pair<double, double>> GetParameterRanges(
+	const std::vector<std::valarray<double>> &samples)
+{
+	if(samples.empty())
+		throw std::invalid_argument("No parameter samples.");
+
+	std::vector<std::pair<double, double>> ret(samples.front().size());
+	for(std::size_t p = 0; p < ret.size(); ++p)
+		ret[p] = { samples.front()[p], samples.front()[p] };
+
+	for(const std::valarray<double> &sample : samples)
+	{
+		for(std::size_t p = 0; p < ret.size(); ++p)
+		{
+			ret[p].first = std::min(ret[p].first, sample[p]);
+			ret[p].second = std::max(ret[p].second, sample[p]);
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * \brief Adds one set of parameters to the samples of a model and its
+ *    submodels.
+ *
+ * \param[in] model The model.
+ * \param[in] params The parameters for the model.
+ * \param[in,out] samples The samples for each model.
+ */
+static void AddModelSample(const SimulateModel &model,
+	const std::valarray<double> &params,
+	std::map<const SimulateModel *, std::vector<std::valarray<double>>>
+		&samples)
+{
+	samples[&model].push_back(params);
+
+	const CompositeSimulateModel *cmodel
+		{ dynamic_cast<const CompositeSimulateModel *>(&model) };
+	if(cmodel == nullptr)
+		return;
+
+	for(const auto &submodel : cmodel->routeSubmodelParameters(params))
+		AddModelSample(*submodel.first, submodel.second, samples);
+}
+
+std::map<const SimulateModel *, std::vector<std::valarray<double>>>
+	SampleModelParameters(const SimulateModel &model, Engine &engine,
+		std::size_t nsamples)
+{
+	std::map<const SimulateModel *, std::vector<std::valarray<double>>> ret;
+
+	for(std::size_t j = 0; j < nsamples; ++j)
+		AddModelSample(model, model.generateParameters(engine), ret);
+
+	return ret;
+}
+
+} // namespace molstat
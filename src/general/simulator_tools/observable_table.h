@@ -0,0 +1,129 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file observable_table.h
+ * \brief Tabulation and interpolation of observables that are expensive to
+ *    calculate.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __observable_table_h__
+#define __observable_table_h__
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <valarray>
+#include <vector>
+#include <general/random_distributions/engine.h>
+#include "simulate_model.h"
+
+namespace molstat {
+
+/**
+ * \brief Table of an observable on a regular grid of model parameters, with
+ *    multilinear interpolation.
+ *
+ * Each parameter with a range of values gets the same number of grid
+ * points; parameters with a single value are not interpolated. Parameters
+ * outside the grid, or near grid points where the observable is not
+ * produced, cannot be interpolated.
+ */
+class ObservableTable
+{
+private:
+	/// The smallest value of each parameter.
+	std::vector<double> lower;
+
+	/// The largest value of each parameter.
+	std::vector<double> upper;
+
+	/// The grid spacing for each parameter (0 for single-valued parameters).
+	std::vector<double> spacing;
+
+	/// The parameters that are interpolated.
+	std::vector<std::size_t> varying;
+
+	/// The stride in ObservableTable::values for each varying parameter.
+	std::vector<std::size_t> strides;
+
+	/// The tabulated values (molstat::NoObservableValue if not produced).
+	std::vector<double> values;
+
+	/// The number of grid points for each varying parameter.
+	std::size_t npoints;
+
+public:
+	/// The largest number of values in a table.
+	static constexpr std::size_t max_size = std::size_t(1) << 24;
+
+	ObservableTable() = delete;
+
+	/**
+	 * \brief Constructor that tabulates the observable.
+	 *
+	 * \throw std::invalid_argument if there are fewer than 2 points, if a
+	 *    range is invalid, or if the table would have more than
+	 *    ObservableTable::max_size values.
+	 *
+	 * \param[in] f The observable.
+	 * \param[in] ranges The smallest and largest value of each parameter.
+	 * \param[in] npoints_ The number of grid points for each parameter.
+	 */
+	ObservableTable(const ObservableFunction &f,
+		const std::vector<std::pair<double, double>> &ranges,
+		std::size_t npoints_);
+
+	/**
+	 * \brief Gets the number of tabulated values.
+	 *
+	 * \return The number of values.
+	 */
+	std::size_t size() const noexcept;
+
+	/**
+	 * \brief Interpolates the observable.
+	 *
+	 * \param[in] params The model parameters.
+	 * \return The interpolated observable; molstat::NoObservableValue if it
+	 *    cannot be interpolated.
+	 */
+	double interpolate(const std::valarray<double> &params) const;
+};
+
+/**
+ * \brief Gets the range of each parameter in a set of samples.
+ *
+ * \throw std::invalid_argument if there are no samples.
+ *
+ * \param[in] samples The samples.
+ * \return The smallest and largest value of each parameter.
+ */
+std::vector<std::pair<double, double>> GetParameterRanges(
+	const std::vector<std::valarray<double>> &samples);
+
+/**
+ * \brief Samples the parameters passed to each model in a (possibly
+ *    composite) model.
+ *
+ * Each sample is generated for the full model and then routed to the
+ * submodels, so the samples for a submodel include the parameters it
+ * receives from the composite model.
+ *
+ * \param[in] model The full model.
+ * \param[in] engine The random number engine.
+ * \param[in] nsamples The number of samples.
+ * \return The samples for each model (including `model`).
+ */
+std::map<const SimulateModel *, std::vector<std::valarray<double>>>
+	SampleModelParameters(const SimulateModel &model, Engine &engine,
+		std::size_t nsamples);
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,168 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file process_group.cc
+ * \brief Implements the processes of a (possibly distributed) simulation.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <config.h>
+#include "process_group.h"
+#include <cstdint>
+#include <stdexcept>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+namespace molstat {
+
+#if HAVE_MPI
+/// The MPI datatype of std::size_t.
+static const MPI_Datatype size_type{ sizeof(std::size_t) == 8 ?
+	MPI_UINT64_T : MPI_UINT32_T };
+
+/**
+ * \brief Checks the status returned by an MPI call.
+ *
+ * \throw std::runtime_error if the call failed.
+ *
+ * \param[in] status The status.
+ * \param[in] what Description of the MPI call, for error messages.
+ */
+static void check_mpi(int status, const std::string &what)
+{
+	if(status != MPI_SUCCESS)
+		throw std::runtime_error("MPI error: unable to " + what + ".");
+}
+#endif
+
+ProcessGroup::ProcessGroup(int &argc, char **&argv)
+{
+#if HAVE_MPI
+	// only the main thread of each process communicates
+	int provided;
+	check_mpi(MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided),
+		"initialize MPI");
+	MPI_Comm_rank(MPI_COMM_WORLD, &process_rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nprocesses);
+#endif
+}
+
+ProcessGroup::~ProcessGroup()
+{
+#if HAVE_MPI
+	MPI_Finalize();
+#endif
+}
+
+bool ProcessGroup::distributed() noexcept
+{
+#if HAVE_MPI
+	return true;
+#else
+	return false;
+#endif
+}
+
+int ProcessGroup::rank() const noexcept
+{
+	return process_rank;
+}
+
+int ProcessGroup::size() const noexcept
+{
+	return nprocesses;
+}
+
+bool ProcessGroup::isRoot() const noexcept
+{
+	return process_rank == 0;
+}
+
+void ProcessGroup::broadcast(std::string &str) const
+{
+#if HAVE_MPI
+	std::uint64_t len{ str.size() };
+	check_mpi(MPI_Bcast(&len, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD),
+		"broadcast a string length");
+	str.resize(len);
+	if(len > 0)
+		check_mpi(MPI_Bcast(&str[0], len, MPI_CHAR, 0, MPI_COMM_WORLD),
+			"broadcast a string");
+#endif
+}
+
+bool ProcessGroup::all(bool ok) const
+{
+#if HAVE_MPI
+	int local{ ok ? 1 : 0 }, global;
+	check_mpi(MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_LAND,
+		MPI_COMM_WORLD), "combine a condition");
+	return global != 0;
+#else
+	return ok;
+#endif
+}
+
+void ProcessGroup::sumToRoot(std::vector<double> &vals) const
+{
+#if HAVE_MPI
+	if(isRoot())
+		check_mpi(MPI_Reduce(MPI_IN_PLACE, vals.data(), vals.size(),
+			MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD), "sum values");
+	else
+		check_mpi(MPI_Reduce(vals.data(), nullptr, vals.size(), MPI_DOUBLE,
+			MPI_SUM, 0, MPI_COMM_WORLD), "sum values");
+#endif
+}
+
+void ProcessGroup::sumToRoot(std::vector<std::size_t> &vals) const
+{
+#if HAVE_MPI
+	if(isRoot())
+		check_mpi(MPI_Reduce(MPI_IN_PLACE, vals.data(), vals.size(),
+			size_type, MPI_SUM, 0, MPI_COMM_WORLD), "sum counts");
+	else
+		check_mpi(MPI_Reduce(vals.data(), nullptr, vals.size(), size_type,
+			MPI_SUM, 0, MPI_COMM_WORLD), "sum counts");
+#endif
+}
+
+double ProcessGroup::maxToRoot(double val) const
+{
+#if HAVE_MPI
+	double ret{ val };
+	check_mpi(MPI_Reduce(&val, &ret, 1, MPI_DOUBLE, MPI_MAX, 0,
+		MPI_COMM_WORLD), "find a maximum");
+	return isRoot() ? ret : val;
+#else
+	return val;
+#endif
+}
+
+void ProcessGroup::extremes(std::vector<std::array<double, 2>> &ranges) const
+{
+#if HAVE_MPI
+	// the minima are negated so that one MPI_MAX finds both extremes
+	std::vector<double> local(2 * ranges.size()), global(2 * ranges.size());
+	for(std::size_t j = 0; j < ranges.size(); ++j)
+	{
+		local[2*j] = -ranges[j][0];
+		local[2*j + 1] = ranges[j][1];
+	}
+
+	check_mpi(MPI_Allreduce(local.data(), global.data(), local.size(),
+		MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD), "find the extremes");
+
+	for(std::size_t j = 0; j < ranges.size(); ++j)
+		ranges[j] = {{ -global[2*j], global[2*j + 1] }};
+#endif
+}
+
+} // namespace molstat
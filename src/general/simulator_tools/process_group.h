@@ -0,0 +1,148 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file process_group.h
+ * \brief The processes of a (possibly distributed) simulation.
+ *
+ * When MolStat is configured with `--enable-mpi`, the processes are the
+ * ranks of `MPI_COMM_WORLD`. Otherwise there is exactly one process and
+ * the collective operations do nothing.
+ *
+ * Only the calling (main) thread of each process communicates; the worker
+ * threads of a simulation never do.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __process_group_h__
+#define __process_group_h__
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace molstat {
+
+/**
+ * \brief The processes of a simulation and the communication between them.
+ *
+ * Every collective function must be called by every process, in the same
+ * order. Process 0 is the root; it reads the input and writes the output.
+ *
+ * At most one ProcessGroup may exist at a time.
+ */
+class ProcessGroup
+{
+private:
+	/// The number (rank) of this process.
+	int process_rank{ 0 };
+
+	/// The number of processes.
+	int nprocesses{ 1 };
+
+public:
+	ProcessGroup() = delete;
+	ProcessGroup(const ProcessGroup &) = delete;
+	ProcessGroup &operator=(const ProcessGroup &) = delete;
+
+	/**
+	 * \brief Starts the process group (initializing MPI, if available).
+	 *
+	 * \throw std::runtime_error if MPI cannot be initialized.
+	 *
+	 * \param[in,out] argc The number of command-line arguments.
+	 * \param[in,out] argv The command-line arguments.
+	 */
+	ProcessGroup(int &argc, char **&argv);
+
+	/// Finishes the process group (finalizing MPI, if available).
+	~ProcessGroup();
+
+	/**
+	 * \brief Determines if MolStat was compiled with MPI.
+	 *
+	 * \return True if there can be more than one process.
+	 */
+	static bool distributed() noexcept;
+
+	/**
+	 * \brief Gets the number (rank) of this process.
+	 *
+	 * \return The rank, from 0 to size()-1.
+	 */
+	int rank() const noexcept;
+
+	/**
+	 * \brief Gets the number of processes.
+	 *
+	 * \return The number of processes.
+	 */
+	int size() const noexcept;
+
+	/**
+	 * \brief Determines if this is the root process (process 0).
+	 *
+	 * \return True for the root process.
+	 */
+	bool isRoot() const noexcept;
+
+	/**
+	 * \brief Copies a string from the root process to every process.
+	 *
+	 * \param[in,out] str On the root, the string to send. On the other
+	 *    processes, replaced by the root's string.
+	 */
+	void broadcast(std::string &str) const;
+
+	/**
+	 * \brief Determines if a condition holds on every process.
+	 *
+	 * \param[in] ok The condition on this process.
+	 * \return True if `ok` is true on every process.
+	 */
+	bool all(bool ok) const;
+
+	/**
+	 * \brief Sums values over the processes, on the root.
+	 *
+	 * \param[in,out] vals The values of this process (the same number on
+	 *    every process). On the root, replaced by the sums; unchanged on the
+	 *    other processes.
+	 */
+	void sumToRoot(std::vector<double> &vals) const;
+
+	/**
+	 * \brief Sums counts over the processes, on the root.
+	 *
+	 * \param[in,out] vals The counts of this process (the same number on
+	 *    every process). On the root, replaced by the sums; unchanged on the
+	 *    other processes.
+	 */
+	void sumToRoot(std::vector<std::size_t> &vals) const;
+
+	/**
+	 * \brief Finds the maximum of a value over the processes, on the root.
+	 *
+	 * \param[in] val The value of this process.
+	 * \return On the root, the maximum; on the other processes, `val`.
+	 */
+	double maxToRoot(double val) const;
+
+	/**
+	 * \brief Finds the extremes of ranges over all the processes.
+	 *
+	 * \param[in,out] ranges The minimum and maximum of each range on this
+	 *    process (the same number on every process). Replaced, on every
+	 *    process, by the smallest minimum and the largest maximum.
+	 */
+	void extremes(std::vector<std::array<double, 2>> &ranges) const;
+};
+
+} // namespace molstat
+
+#endif
@@ -14,6 +14,9 @@
 
 #include "simulate_model.h"
 #include "simulator_exceptions.h"
+#include "observable_table.h"
+#include <algorithm>
+#include <cmath>
 
 namespace molstat {
 
@@ -27,6 +30,21 @@ std::size_t SimulateModel::get_num_parameters() const
 	return get_names().size();
 }
 
+std::map<std::string, double> SimulateModel::get_default_values() const
+{
+	return std::map<std::string, double>();
+}
+
+std::vector<std::string> SimulateModel::getParameterNames() const
+{
+	std::vector<std::string> ret{ get_names() };
+
+	for(std::string &name : ret)
+		name = to_lower(name);
+
+	return ret;
+}
+
 ObservableFunction SimulateModel::getObservableFunction(
 	const ObservableIndex &obs) const
 {
@@ -45,17 +63,201 @@ ObservableFunction SimulateModel::getObservableFunction(
 	return obsfunc;
 }
 
+BatchObservableFunction SimulateModel::getBatchObservableFunction(
+	const ObservableIndex &obs) const
+{
+	BatchObservableFunction obsfunc;
+
+	try
+	{
+		// get the observable's factory and then bind it to this
+		obsfunc = (batch_observables.at(obs))(shared_from_this());
+	}
+	catch(const std::out_of_range &e)
+	{
+		throw IncompatibleObservable();
+	}
+
+	return obsfunc;
+}
+
+double SimulateModel::tabulateObservable(const ObservableIndex &obs,
+	const std::vector<std::valarray<double>> &samples, std::size_t npoints)
+{
+	using namespace std;
+
+	const ObservableFunction exact{ getObservableFunction(obs) };
+	const ObservableFactory exact_factory{ compatible_observables.at(obs) };
+
+	shared_ptr<const ObservableTable> table = make_shared<ObservableTable>(
+		exact, GetParameterRanges(samples), npoints);
+
+	// estimate the error from the samples
+	double error{ 0. };
+	for(size_t j = 0; j < min<size_t>(samples.size(), 1000); ++j)
+	{
+		const double interp{ table->interpolate(samples[j]) };
+		if(isnan(interp))
+			continue;
+
+		try
+		{
+			const double val{ exact(samples[j]) };
+			if(!isnan(val))
+				error = max(error, abs(interp - val));
+		}
+		catch(const NoObservableProduced &e)
+		{
+			// no error to estimate
+		}
+	}
+
+	// replace the observable's function; the original function (bound to
+	// the model later) is used where the table can't be interpolated
+	compatible_observables[obs] =
+		[exact_factory, table] (shared_ptr<const SimulateModel> model)
+			-> ObservableFunction
+		{
+			const ObservableFunction original{ exact_factory(model) };
+
+			return [original, table] (const valarray<double> &params)
+				-> double
+			{
+				const double val{ table->interpolate(params) };
+				return isnan(val) ? original(params) : val;
+			};
+		};
+
+	batch_observables[obs] =
+		[exact_factory, table] (shared_ptr<const SimulateModel> model)
+			-> BatchObservableFunction
+		{
+			const ObservableFunction original{ exact_factory(model) };
+			const ObservableTable *raw{ table.get() };
+
+			return [original, table, raw] (const double *const *params,
+				size_t nparams, size_t ntrials, double *out) -> void
+			{
+				EvaluateBatchObservable(
+					[&original, raw] (const valarray<double> &row) -> double
+					{
+						const double val{ raw->interpolate(row) };
+						return isnan(val) ? original(row) : val;
+					}, params, nparams, ntrials, out);
+			};
+		};
+
+	tabulated_observables.insert(obs);
+
+	return error;
+}
+
+FusedObservableFunction SimulateModel::getFusedObservableFunction(
+	const std::vector<ObservableIndex> &obs) const
+{
+	return FusedObservableFunction();
+}
+
+bool SimulateModel::appendDeviceTerms(const ObservableIndex &obs,
+	std::vector<DeviceTerm> &terms) const
+{
+	return false;
+}
+
+bool SimulateModel::getDeviceTerms(const ObservableIndex &obs,
+	std::vector<DeviceTerm> &terms) const
+{
+	terms.clear();
+
+	// the table replaces the model's own function
+	if(tabulated_observables.count(obs) > 0)
+		return false;
+
+	return appendDeviceTerms(obs, terms);
+}
+
+void SimulateModel::markObservableParameters(const ObservableIndex &obs,
+	std::vector<bool> &used) const
+{
+	const auto declared = observable_parameters.find(obs);
+
+	// the table may read any of the parameters
+	if(declared == observable_parameters.end() ||
+		tabulated_observables.count(obs) > 0)
+	{
+		std::fill(used.begin(), used.end(), true);
+		return;
+	}
+
+	for(const std::size_t j : declared->second)
+		used[j] = true;
+}
+
+bool SimulateModel::isConstantParameter(std::size_t j, double &value) const
+{
+	if(j >= dists.size() || dists[j] == nullptr)
+		return false;
+
+	return dists[j]->isConstant(value);
+}
+
+void SimulateModel::appendParameterLayout(ParameterLayout &layout) const
+{
+	layout.offsets.emplace_back(this, layout.distributions.size());
+
+	for(const auto &dist : dists)
+		layout.distributions.push_back(dist.get());
+}
+
+ParameterLayout SimulateModel::getParameterLayout() const
+{
+	ParameterLayout ret;
+	appendParameterLayout(ret);
+
+	return ret;
+}
+
+void SimulateModel::group_joint_parameters()
+{
+	joint_params = GroupJointComponents(dists.data(), dists.size());
+}
+
 std::valarray<double> SimulateModel::generateParameters(Engine &engine) const
+{
+	std::valarray<double> ret(get_num_parameters());
+	if(ret.size() > 0)
+		generateParameters(engine, &ret[0]);
+
+	return ret;
+}
+
+void SimulateModel::generateParameters(Engine &engine, double *params) const
 {
 	const std::size_t length = get_num_parameters();
-	std::valarray<double> ret(length);
 
 	for(std::size_t j = 0; j < length; ++j)
 	{
-		ret[j] = dists[j]->sample(engine);
+		if(!IsJointComponent(*dists[j]))
+			params[j] = dists[j]->sample(engine);
 	}
 
-	return ret;
+	for(const JointParameters &joint : joint_params)
+		joint.dist->sample(engine, params, joint.slots);
+}
+
+void SimulateModel::generateParameterBatch(Engine &engine,
+	std::size_t ntrials, double *params) const
+{
+	const std::size_t length = get_num_parameters();
+
+	for(std::size_t j = 0; j < length; ++j)
+	{
+		if(!IsJointComponent(*dists[j]))
+			dists[j]->sample_n(engine, params + j*ntrials, ntrials);
+	}
+
+	for(const JointParameters &joint : joint_params)
+		joint.dist->sample_n(engine, params, ntrials, joint.slots);
 }
 
 } // namespace molstat
@@ -37,6 +37,7 @@
 #define __simulate_model_h__
 
 #include <memory>
+#include <limits>
 #include <functional>
 #include <valarray>
 #include <vector>
@@ -47,7 +48,11 @@
 #include <typeinfo>
 #include <typeindex>
 #include <general/random_distributions/rng.h>
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/multivariate_normal.h>
 #include <general/string_tools.h>
+#include "simulator_exceptions.h"
+#include "device_program.h"
 
 namespace molstat {
 
@@ -58,12 +63,23 @@ class RandomDistribution;
 /**
  * \brief The signature of a function that calculates an observable.
  *
- * A molstat::ObservableFunction may throw molstat::NoObservableProduced if
- * the specified set of model parameters does not result in the observable.
+ * If the specified set of model parameters does not result in the
+ * observable, a molstat::ObservableFunction should return
+ * molstat::NoObservableValue (a quiet NaN). Throwing
+ * molstat::NoObservableProduced is also supported, but is much slower when
+ * many trials do not produce the observable.
  */
 using ObservableFunction =
 	std::function<double(const std::valarray<double> &)>;
 
+/**
+ * \brief The value returned by a molstat::ObservableFunction when the
+ *    observable is not produced.
+ *
+ * Check for it with `std::isnan`; NaN never compares equal to itself.
+ */
+constexpr double NoObservableValue = std::numeric_limits<double>::quiet_NaN();
+
 /**
  * \brief The signature of a function that produces an ObservableFunction,
  *    given the model.
@@ -74,6 +90,62 @@ using ObservableFunction =
 using ObservableFactory =
 	std::function<ObservableFunction(std::shared_ptr<const SimulateModel>)>;
 
+/**
+ * \brief The signature of a function that calculates an observable for a
+ *    batch of trials.
+ *
+ * The arguments are `(params, nparams, ntrials, out)`. `params[p]` points
+ * to the `ntrials` values of model parameter `p` (parameter-major storage,
+ * as from SimulateModel::generateParameterBatch(), need not be contiguous
+ * between parameters). The observable for trial `t` is stored in `out[t]`;
+ * trials that do not produce it are set to molstat::NoObservableValue.
+ */
+using BatchObservableFunction =
+	std::function<void(const double *const *, std::size_t, std::size_t,
+		double *)>;
+
+/**
+ * \brief The signature of a function that produces a
+ *    BatchObservableFunction, given the model.
+ *
+ * \throw molstat::IncompatibleObservable may be thrown if the observable
+ *    and model are incompatible.
+ */
+using BatchObservableFactory =
+	std::function<BatchObservableFunction(
+		std::shared_ptr<const SimulateModel>)>;
+
+/**
+ * \brief The signature of a function that calculates several observables
+ *    together for one set of model parameters.
+ *
+ * The arguments are `(params, out)`; `out[j]` is set to the `j`th
+ * requested observable, or to molstat::NoObservableValue if that observable
+ * is not produced. Computing the observables together lets a model share
+ * intermediate results between them.
+ */
+using FusedObservableFunction =
+	std::function<void(const std::valarray<double> &, double *)>;
+
+/**
+ * \brief Evaluates an observable function for each trial in a batch.
+ *
+ * This helper implements the loop for molstat::BatchObservableFunction
+ * objects. When `f` is a lambda, its call can be inlined into the loop.
+ *
+ * \tparam Function The type of function; the signature should be
+ *    `double(const std::valarray<double> &)`.
+ * \param[in] f The function.
+ * \param[in] params The parameters (see molstat::BatchObservableFunction).
+ * \param[in] nparams The number of parameters.
+ * \param[in] ntrials The number of trials.
+ * \param[out] out The observable for each trial.
+ */
+template<typename Function>
+void EvaluateBatchObservable(const Function &f,
+	const double *const *params, std::size_t nparams, std::size_t ntrials,
+	double *out);
+
 /**
  * \brief Alias for the index type (alias for std::type_index) of an
  *    Observable.
@@ -90,6 +162,32 @@ using ObservableIndex = std::type_index;
  */
 using SimulateModelType = std::type_index;
 
+/**
+ * \brief The flattened parameters of a model and its submodels.
+ *
+ * Composite models generate their parameters by recursing through the
+ * submodels. A molstat::ParameterLayout records, once, the distribution for
+ * each slot of the full parameter vector so that the parameters can be
+ * generated with a single loop (see molstat::Simulator).
+ */
+struct ParameterLayout
+{
+	/**
+	 * \brief The distribution for each model parameter, in the order used by
+	 *    molstat::SimulateModel::generateParameters().
+	 */
+	std::vector<const RandomDistribution *> distributions;
+
+	/**
+	 * \brief The offset of each model's own parameters in
+	 *    ParameterLayout::distributions.
+	 *
+	 * The top-level model is first, followed by the submodels (depth-first,
+	 * in the order they were added).
+	 */
+	std::vector<std::pair<const SimulateModel *, std::size_t>> offsets;
+};
+
 /**
  * \brief Base class for a model that uses model parameters to calculate
  *    observables.
@@ -120,12 +218,110 @@ protected:
 	 */
 	std::map<ObservableIndex, ObservableFactory> compatible_observables;
 
+	/**
+	 * \brief Factories for the batch versions of the observables' functions.
+	 *
+	 * molstat::Observable registers a generic implementation for each
+	 * observable; models may replace it with a specialized kernel using
+	 * setObservableKernel().
+	 */
+	std::map<ObservableIndex, BatchObservableFactory> batch_observables;
+
+	/**
+	 * \brief The observables that have been replaced by interpolation in a
+	 *    table (see tabulateObservable()).
+	 *
+	 * Models that bypass the observable functions (e.g., in
+	 * getFusedObservableFunction()) should not do so for these observables.
+	 */
+	std::set<ObservableIndex> tabulated_observables;
+
+	/**
+	 * \brief Registers a specialized (monomorphic) batch kernel for an
+	 *    observable.
+	 *
+	 * The kernel is called as `kernel(model, params)` for each trial, where
+	 * `model` has type `const M &`. The batch loop is instantiated for the
+	 * kernel's type, so a kernel that calls the observable function with a
+	 * qualified name (e.g., `model.M::function(params)`) bypasses
+	 * std::function and virtual dispatch and can be inlined. This should be
+	 * called from the constructor of the model `M`; classes derived from `M`
+	 * that override the observable function must register their own kernel.
+	 *
+	 * \tparam T The observable class.
+	 * \tparam M The model class.
+	 * \tparam Kernel The type of the kernel.
+	 * \param[in] kernel The kernel.
+	 */
+	template<typename T, typename M, typename Kernel>
+	void setObservableKernel(Kernel kernel);
+
+	/**
+	 * \brief Registers a batch kernel that works directly on the arrays of
+	 *    model parameters.
+	 *
+	 * The kernel is called as `kernel(model, params, ntrials, out)`, where
+	 * `model` has type `const M &` and the remaining arguments are as in
+	 * molstat::BatchObservableFunction. Unlike setObservableKernel(), no
+	 * parameters are copied; kernels written as loops over the arrays can be
+	 * vectorized (see batch_kernels.h). This should be called from the
+	 * constructor of the model `M`.
+	 *
+	 * \tparam T The observable class.
+	 * \tparam M The model class.
+	 * \tparam Kernel The type of the kernel.
+	 * \param[in] kernel The kernel.
+	 */
+	template<typename T, typename M, typename Kernel>
+	void setBatchObservableKernel(Kernel kernel);
+
+	/**
+	 * \brief The model parameters read by the observables that declare them
+	 *    (see setObservableParameters()).
+	 *
+	 * An observable that is not listed may read any of the parameters.
+	 */
+	std::map<ObservableIndex, std::vector<std::size_t>> observable_parameters;
+
+	/**
+	 * \brief Declares the model parameters that an observable reads.
+	 *
+	 * A simulator then does not sample the parameters that none of its
+	 * observables read. The declaration must cover every way the model
+	 * calculates the observable (its function, kernels, fused function, and
+	 * device terms); the values of the other parameters are unspecified. It
+	 * is ignored once the observable is tabulated. This should be called from
+	 * the constructor of the model.
+	 *
+	 * \tparam T The observable class.
+	 * \param[in] params The indices of the parameters, as passed to the
+	 *    functions of the observable (for a submodel, the parameters from its
+	 *    composite model come first).
+	 */
+	template<typename T>
+	void setObservableParameters(std::vector<std::size_t> params);
+
 	/**
 	 * \brief Ordered vector of random number distributions for the various
 	 *    model parameters.
 	 */
 	std::vector<std::shared_ptr<const RandomDistribution>> dists;
 
+	/**
+	 * \brief The groups of this model's parameters whose distributions are
+	 *    components of the same joint distribution.
+	 *
+	 * These parameters are sampled together (and are skipped when sampling
+	 * the other parameters). Set by group_joint_parameters().
+	 */
+	std::vector<JointParameters> joint_params;
+
+	/**
+	 * \brief Groups the parameters with joint distributions; called whenever
+	 *    SimulateModel::dists changes.
+	 */
+	void group_joint_parameters();
+
 	/**
 	 * \brief Gets a map of parameter name to index.
 	 *
@@ -133,6 +329,34 @@ protected:
 	 */
 	virtual std::vector<std::string> get_names() const = 0;
 
+	/**
+	 * \brief Gets the default values of model parameters that do not need
+	 *    distributions.
+	 *
+	 * A parameter whose distribution is not specified is fixed at its
+	 * default value; by default, every parameter needs a distribution.
+	 *
+	 * \return Map of parameter name to its default value.
+	 */
+	virtual std::map<std::string, double> get_default_values() const;
+
+	/**
+	 * \brief Appends the terms of an observable for a simulation on a device
+	 *    (see getDeviceTerms()).
+	 *
+	 * Models whose observables are closed-form functions known to a device
+	 * backend should override this function. The default implementation
+	 * returns false.
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in,out] terms The terms; on output, the observable's terms have
+	 *    been appended.
+	 * \return True if the terms were appended, false if this model cannot
+	 *    describe the observable with terms.
+	 */
+	virtual bool appendDeviceTerms(const ObservableIndex &obs,
+		std::vector<DeviceTerm> &terms) const;
+
 	SimulateModel() = default;
 
 public:
@@ -158,6 +382,14 @@ public:
 	 */
 	virtual std::size_t get_num_parameters() const;
 
+	/**
+	 * \brief Gets the (lowercase) names of the model parameters, in the
+	 *    order used by generateParameters().
+	 *
+	 * \return The names of the parameters.
+	 */
+	virtual std::vector<std::string> getParameterNames() const;
+
 	/**
 	 * \brief Gets a function that calculates an observable, given a set of
 	 *    model parameters.
@@ -173,6 +405,118 @@ public:
 	 */
 	ObservableFunction getObservableFunction(const ObservableIndex &obs) const;
 
+	/**
+	 * \brief Gets a function that calculates the observable for a batch of
+	 *    trials.
+	 *
+	 * \throw molstat::IncompatibleObservable if the observable is
+	 *    incompatible with this model.
+	 *
+	 * \param[in] obs The type_index of the class for the observable.
+	 * \return A function that calculates the observable for a batch.
+	 */
+	BatchObservableFunction getBatchObservableFunction(
+		const ObservableIndex &obs) const;
+
+	/**
+	 * \brief Replaces an observable's function with interpolation in a
+	 *    table of its values.
+	 *
+	 * The table is a regular grid spanning the range of each parameter in
+	 * `samples` (see molstat::ObservableTable). Parameters that cannot be
+	 * interpolated use the original function. This is intended for
+	 * observables that are expensive to calculate (e.g., those requiring
+	 * numerical integration).
+	 *
+	 * \throw molstat::IncompatibleObservable if the observable is
+	 *    incompatible with this model.
+	 * \throw std::invalid_argument if the table cannot be constructed.
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in] samples Sets of parameters for this model, such as from
+	 *    molstat::SampleModelParameters.
+	 * \param[in] npoints The number of grid points for each parameter.
+	 * \return An estimate of the interpolation error: the largest absolute
+	 *    difference between the table and the original function for (up to
+	 *    1000 of) the samples.
+	 */
+	double tabulateObservable(const ObservableIndex &obs,
+		const std::vector<std::valarray<double>> &samples, std::size_t npoints);
+
+	/**
+	 * \brief Gets a function that calculates several observables together.
+	 *
+	 * Models that can share work between observables (e.g., a conductance
+	 * that is calculated from the current) should override this function.
+	 * The default implementation does not fuse any observables.
+	 *
+	 * \param[in] obs The observables, in the order they are stored by the
+	 *    returned function.
+	 * \return A function that calculates all of the observables, or an empty
+	 *    function if this model does not fuse this set of observables.
+	 */
+	virtual FusedObservableFunction getFusedObservableFunction(
+		const std::vector<ObservableIndex> &obs) const;
+
+	/**
+	 * \brief Describes an observable as a sum of closed-form terms, for a
+	 *    simulation on a device (see molstat::DeviceSimulator).
+	 *
+	 * The terms' parameter indices are in the order of generateParameters().
+	 * Tabulated observables (see tabulateObservable()) have no terms.
+	 *
+	 * \param[in] obs The observable.
+	 * \param[out] terms The terms.
+	 * \return True if the observable is described by `terms`, false
+	 *    otherwise.
+	 */
+	bool getDeviceTerms(const ObservableIndex &obs,
+		std::vector<DeviceTerm> &terms) const;
+
+	/**
+	 * \brief Marks the model parameters that an observable reads.
+	 *
+	 * Without a declaration (see setObservableParameters()), or if the
+	 * observable is tabulated, every parameter is marked.
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in,out] used One flag per parameter passed to the functions of
+	 *    the observable; the flags of the parameters it reads are set.
+	 */
+	virtual void markObservableParameters(const ObservableIndex &obs,
+		std::vector<bool> &used) const;
+
+	/**
+	 * \brief Determines whether one of this model's own parameters has a
+	 *    constant distribution.
+	 *
+	 * Observable functions and kernels can use this to hoist calculations
+	 * that depend only on constant parameters out of the per-trial path.
+	 * The distributions are set when the model is constructed by
+	 * molstat::SimulateModelFactory, so this should not be called from the
+	 * model's constructor.
+	 *
+	 * \param[in] j The index of the parameter, in the order of get_names().
+	 * \param[out] value The parameter's value, if it is constant.
+	 * \return True if the parameter is constant, false otherwise.
+	 */
+	bool isConstantParameter(std::size_t j, double &value) const;
+
+	/**
+	 * \brief Appends this model's parameters to a flattened layout.
+	 *
+	 * \param[in,out] layout The layout.
+	 */
+	virtual void appendParameterLayout(ParameterLayout &layout) const;
+
+	/**
+	 * \brief Gets the flattened layout of this model's parameters.
+	 *
+	 * \return The layout; its distributions are owned by this model (and its
+	 *    submodels).
+	 */
+	ParameterLayout getParameterLayout() const;
+
 	/**
 	 * \brief Generates a set of model parameters using the specified random
 	 *    distributions.
@@ -180,10 +524,46 @@ public:
 	 * \param[in] engine The C++11 random number engine.
 	 * \return A set of model parameters.
 	 */
-	virtual std::valarray<double> generateParameters(Engine &engine) const;
+	std::valarray<double> generateParameters(Engine &engine) const;
+
+	/**
+	 * \brief Generates a set of model parameters into a caller's buffer.
+	 *
+	 * No memory is allocated; composite models have each submodel fill its
+	 * slots of the buffer in place. The values are the same as those of
+	 * generateParameters(Engine &).
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[out] params Storage for get_num_parameters() parameters.
+	 */
+	virtual void generateParameters(Engine &engine, double *params) const;
+
+	/**
+	 * \brief Generates model parameters for a batch of trials.
+	 *
+	 * The parameters are stored parameter-major: parameter `p` for trial `t`
+	 * is `params[p*ntrials + t]`. No memory is allocated.
+	 *
+	 * The random numbers are drawn in a different order than repeated calls
+	 * to generateParameters(), so the two functions produce different (but
+	 * equally distributed) parameters from the same engine state.
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[in] ntrials The number of trials.
+	 * \param[out] params Storage for `get_num_parameters() * ntrials`
+	 *    parameters.
+	 */
+	virtual void generateParameterBatch(Engine &engine, std::size_t ntrials,
+		double *params) const;
 
 	// the factory needs to get at the internal details
 	friend class SimulateModelFactory;
+
+	// so does the simulator, to replace distributions
+	friend class Simulator;
+
+	// and the evaluation plan, to see the tabulated observables
+	friend class EvaluationPlan;
 };
 
 /**
@@ -211,6 +591,61 @@ protected:
 	}
 };
 
+/**
+ * \brief The indices of the composite model parameters that are passed to
+ *    each submodel of a composite model (its routes).
+ *
+ * The routes of every submodel are stored one after another in a single
+ * array, so that routing the parameters of a trial to the submodels reads
+ * contiguous memory (rather than one allocation per submodel). The table is
+ * small and is copied into the functions that route parameters.
+ */
+class SubmodelRoutes
+{
+private:
+	/// The indices of every route, one route after another.
+	std::vector<std::size_t> indices;
+
+	/**
+	 * \brief Route `k` is `indices[offsets[k]]`, ...,
+	 *    `indices[offsets[k+1] - 1]`.
+	 */
+	std::vector<std::size_t> offsets{ 0 };
+
+public:
+	/**
+	 * \brief Appends a route.
+	 *
+	 * \param[in] route The indices of the composite model parameters for
+	 *    the submodel.
+	 */
+	void append(const std::vector<std::size_t> &route);
+
+	/**
+	 * \brief Gets the number of routes.
+	 *
+	 * \return The number of routes.
+	 */
+	std::size_t size() const noexcept;
+
+	/**
+	 * \brief Gets the length of a route.
+	 *
+	 * \param[in] k The route (less than size()).
+	 * \return The number of parameters passed to submodel `k`.
+	 */
+	std::size_t routeSize(std::size_t k) const noexcept;
+
+	/**
+	 * \brief Gets a route.
+	 *
+	 * \param[in] k The route (less than size()).
+	 * \return The indices of the parameters passed to submodel `k`
+	 *    (routeSize(k) of them).
+	 */
+	const std::size_t *route(std::size_t k) const noexcept;
+};
+
 /**
  * \brief Base class for a composite model that uses both model parameters
  *    and other independent models to calculate observables.
@@ -225,19 +660,77 @@ class CompositeSimulateModel
 protected:
 	CompositeSimulateModel() = default;
 
+	/// The underlying submodels, in the order they were added.
+	std::vector<std::shared_ptr<SimulateModel>> submodels;
+
 	/**
-	 * \brief List of the underlying submodels.
+	 * \brief The indices of the composite model parameters for each
+	 *    submodel.
 	 *
-	 * Each element in the list corresponds to a submodel; this list also helps
-	 * route the correct model parameters from the composite model to each
-	 * submodel.
+	 * Route `k` routes the correct model parameters from the composite model
+	 * to `submodels[k]`.
+	 */
+	SubmodelRoutes submodel_routes;
+
+	/**
+	 * \brief The operations used to combine the submodels' observables, for
+	 *    each composite observable.
 	 *
-	 * The first element is a pointer to the submodel and the second element is
-	 * an array of the indices of composite model parameters for that submodel.
+	 * molstat::CompositeObservable registers its operation here.
 	 */
-	std::list<std::pair<std::shared_ptr<SimulateModel>,
-		                  const std::valarray<std::size_t>>>
-		submodels;
+	std::map<ObservableIndex, std::function<double(double, double)>>
+		composite_operations;
+
+	/**
+	 * \brief Adds a submodel and determines the composite model parameters
+	 *    to pass to it.
+	 *
+	 * By default, the submodel is passed the composite model's own
+	 * parameters, followed by the submodel's parameters (which are appended
+	 * to those of the composite model). Composite models that route their
+	 * parameters differently (e.g., to several copies of a submodel) should
+	 * override this function. molstat::SimulateModelFactory calls this
+	 * function after verifying the type of the submodel.
+	 *
+	 * \param[in] submodel The submodel.
+	 */
+	virtual void addSubmodel(std::shared_ptr<SimulateModel> submodel);
+
+	/**
+	 * \brief Gets a function that calculates several observables of a
+	 *    submodel together.
+	 *
+	 * If the submodel does not fuse the observables, the returned function
+	 * calculates them individually.
+	 *
+	 * \throw molstat::IncompatibleObservable if an observable is
+	 *    incompatible with the submodel.
+	 *
+	 * \param[in] submodel The submodel.
+	 * \param[in] obs The observables.
+	 * \param[out] fused True if the submodel fuses the observables, false
+	 *    otherwise.
+	 * \return The function that calculates the observables.
+	 */
+	static FusedObservableFunction getSubmodelFusedFunction(
+		const SimulateModel &submodel, const std::vector<ObservableIndex> &obs,
+		bool &fused);
+
+	/**
+	 * \brief Appends the device terms of an observable from every submodel,
+	 *    with the parameter indices routed to those of the composite model.
+	 *
+	 * Composite models whose operation for the observable is a sum can
+	 * describe the observable with these terms (see
+	 * SimulateModel::appendDeviceTerms).
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in,out] terms The terms.
+	 * \return True if every submodel describes the observable with terms,
+	 *    false otherwise (`terms` is then unchanged).
+	 */
+	bool appendSubmodelDeviceTerms(const ObservableIndex &obs,
+		std::vector<DeviceTerm> &terms) const;
 
 public:
 	virtual ~CompositeSimulateModel() = default;
@@ -292,25 +785,97 @@ public:
 	 */
 	virtual std::size_t get_num_parameters() const override final;
 
+	/**
+	 * \brief Gets the (lowercase) names of the model parameters, in the
+	 *    order used by generateParameters().
+	 *
+	 * The composite model's parameters are first, followed by those of each
+	 * submodel (in the order the submodels were added).
+	 *
+	 * \return The names of the parameters.
+	 */
+	virtual std::vector<std::string> getParameterNames() const override final;
+
 	/**
 	 * \brief Generates a set of model parameters using the specified random
 	 *    distributions.
 	 *
 	 * This override samples from the distributions required by the composite
-	 * model, as well as all distributions for the submodels.
+	 * model, and then each submodel fills its slots (after those of the
+	 * composite model and the previous submodels).
 	 *
 	 * \param[in] engine The C++11 random number engine.
-	 * \return A set of model parameters.
+	 * \param[out] params Storage for get_num_parameters() parameters.
 	 */
-	virtual std::valarray<double> generateParameters(Engine &engine) const
+	virtual void generateParameters(Engine &engine, double *params) const
 		override final;
 
+	using SimulateModel::generateParameters;
+
+	/**
+	 * \brief Appends this model's parameters to a flattened layout.
+	 *
+	 * This override appends the composite model's parameters, followed by
+	 * those of each submodel.
+	 *
+	 * \param[in,out] layout The layout.
+	 */
+	virtual void appendParameterLayout(ParameterLayout &layout) const
+		override final;
+
+	/**
+	 * \brief Generates model parameters for a batch of trials.
+	 *
+	 * This override samples the composite model's parameters and then has
+	 * each submodel fill its block of (parameter-major) rows.
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[in] ntrials The number of trials.
+	 * \param[out] params Storage for `get_num_parameters() * ntrials`
+	 *    parameters.
+	 */
+	virtual void generateParameterBatch(Engine &engine, std::size_t ntrials,
+		double *params) const override final;
+
+	/**
+	 * \brief Gets a function that calculates several observables together.
+	 *
+	 * The composite observables are calculated from the fused functions of
+	 * the submodels; observables implemented by the composite model itself
+	 * are calculated individually.
+	 *
+	 * \throw molstat::IncompatibleObservable if an observable is
+	 *    incompatible with this model or one of its submodels.
+	 *
+	 * \param[in] obs The observables.
+	 * \return A function that calculates all of the observables, or an empty
+	 *    function if none of the submodels fuse the composite observables.
+	 */
+	virtual FusedObservableFunction getFusedObservableFunction(
+		const std::vector<ObservableIndex> &obs) const override;
+
+	/**
+	 * \brief Marks the model parameters that an observable reads.
+	 *
+	 * A composite observable (that is not tabulated) reads the parameters
+	 * that each submodel reads, routed to those of the composite model.
+	 *
+	 * \param[in] obs The observable.
+	 * \param[in,out] used One flag per parameter passed to the functions of
+	 *    the observable; the flags of the parameters it reads are set.
+	 */
+	virtual void markObservableParameters(const ObservableIndex &obs,
+		std::vector<bool> &used) const override;
+
 	// the factory needs to get at the internal details
 	friend class SimulateModelFactory;
 
 	// the CompositeObservable class needs to get at the submodel information
 	template<typename T>
 	friend class CompositeObservable;
+
+	// as does the evaluation plan, to lower the composite observables
+	friend class EvaluationPlan;
 };
 
 /**
@@ -400,6 +965,8 @@ public:
 	  *    is not a composite model.
 	  * \throw molstat::IncompatibleSubmodel if the submodel being added is not
 	  *    the type of model expected by the composite model.
+	  * \throw std::logic_error if the composite model otherwise cannot use the
+	  *    submodel (see molstat::CompositeSimulateModel::addSubmodel()).
 	  *
 	  * \param[in] submodel_add The model to be added.
 	  * \return The factory.
@@ -414,7 +981,7 @@ public:
 	  * specified is performed here.
 	  *
 	  * \throw molstat::MissingDistribution if one of the required distributions
-	  *    has not been specified.
+	  *    has not been specified (and has no default value).
 	  * \throw molstat::NoSubmodels if a composite model is being constructed
 	  *    and no submodels have been specified.
 	  *
@@ -456,6 +1023,82 @@ inline SimulateModelFactoryFunction GetSimulateModelFactory()
 }
 
 // templated definitions
+template<typename Function>
+void EvaluateBatchObservable(const Function &f,
+	const double *const *params, std::size_t nparams, std::size_t ntrials,
+	double *out)
+{
+	std::valarray<double> row(nparams);
+
+	for(std::size_t t = 0; t < ntrials; ++t)
+	{
+		for(std::size_t p = 0; p < nparams; ++p)
+			row[p] = params[p][t];
+
+		try
+		{
+			out[t] = f(row);
+		}
+		catch(const NoObservableProduced &e)
+		{
+			out[t] = NoObservableValue;
+		}
+	}
+}
+
+template<typename T, typename M, typename Kernel>
+void SimulateModel::setObservableKernel(Kernel kernel)
+{
+	using namespace std;
+
+	batch_observables[GetObservableIndex<T>()] =
+		[kernel] (shared_ptr<const SimulateModel> model)
+			-> BatchObservableFunction
+		{
+			shared_ptr<const M> cast = dynamic_pointer_cast<const M>(model);
+			if(cast == nullptr)
+				throw IncompatibleObservable();
+
+			return [cast, kernel] (const double *const *params,
+				size_t nparams, size_t ntrials, double *out) -> void
+			{
+				const M &m = *cast;
+				EvaluateBatchObservable(
+					[&m, &kernel] (const valarray<double> &row) -> double
+					{
+						return kernel(m, row);
+					}, params, nparams, ntrials, out);
+			};
+		};
+}
+
+template<typename T, typename M, typename Kernel>
+void SimulateModel::setBatchObservableKernel(Kernel kernel)
+{
+	using namespace std;
+
+	batch_observables[GetObservableIndex<T>()] =
+		[kernel] (shared_ptr<const SimulateModel> model)
+			-> BatchObservableFunction
+		{
+			shared_ptr<const M> cast = dynamic_pointer_cast<const M>(model);
+			if(cast == nullptr)
+				throw IncompatibleObservable();
+
+			return [cast, kernel] (const double *const *params,
+				size_t nparams, size_t ntrials, double *out) -> void
+			{
+				kernel(*cast, params, ntrials, out);
+			};
+		};
+}
+
+template<typename T>
+void SimulateModel::setObservableParameters(std::vector<std::size_t> params)
+{
+	observable_parameters[GetObservableIndex<T>()] = std::move(params);
+}
+
 template<typename T>
 SimulateModelFactory SimulateModelFactory::makeFactory()
 {
@@ -479,6 +1122,11 @@ SimulateModelFactory SimulateModelFactory::makeFactory()
 	// set the size of the model's vector of distributions
 	factory.model->dists.resize(factory.model->get_num_parameters());
 
+	// parameters with default values are constant unless specified
+	for(const auto &def : factory.model->get_default_values())
+		factory.setDistribution(def.first,
+			make_shared<ConstantDistribution>(def.second));
+
 	return factory;
 }
 
@@ -58,21 +58,8 @@ SimulateModelFactory &SimulateModelFactory::addSubmodel(
 	if(submodel_add->getModelType() != comp_model->getSubmodelType())
 		throw IncompatibleSubmodel();
 
-	// determine the parameter indices needed for this submodel
-	const std::size_t cnparam{ comp_model->get_num_composite_parameters() };
-	const std::size_t snparam{ submodel_add->get_num_parameters() };
-	const std::size_t offset{ comp_model->get_num_parameters() };
-
-	std::valarray<std::size_t> sub_params( cnparam + snparam );
-	// indices from the composite model
-	for(std::size_t j = 0; j < cnparam; ++j)
-		sub_params[j] = j;
-	// indices from the submodel
-	for(std::size_t j = 0; j < snparam; ++j)
-		sub_params[j + cnparam] = offset + j;
-
 	// add the model
-	comp_model->submodels.emplace_back(submodel_add, std::move(sub_params));
+	comp_model->addSubmodel(submodel_add);
 
 	return *this;
 }
@@ -88,6 +75,8 @@ std::shared_ptr<SimulateModel> SimulateModelFactory::getModel()
 	if(comp_model != nullptr && comp_model->submodels.size() == 0)
 		throw NoSubmodels();
 
+	model->group_joint_parameters();
+
 	return model;
 }
 
@@ -13,11 +13,22 @@
 #include "simulator.h"
 #include "simulate_model.h"
 #include "simulator_exceptions.h"
+#include "observable.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <general/event_trace.h>
+#include <general/string_tools.h>
 
 namespace molstat {
 
 Simulator::Simulator(std::shared_ptr<SimulateModel> model_)
-	: model(model_), obs_functions()
+	: model(model_), layout(), param_template(), independent_params(),
+	  sampled_params(), joint_params(), prune_parameters(true), proposals(),
+	  proposed_params(), obs_functions(), plan(),
+	  obs_indices(), fused_function()
 {
 	// make sure model is not a submodel
 	if(model == nullptr)
@@ -25,10 +36,142 @@ Simulator::Simulator(std::shared_ptr<SimulateModel> model_)
 
 	if(model->getModelType() != std::type_index{ typeid(SimulateModel) })
 		throw FullModelRequired();
+
+	flatten_parameters();
+}
+
+void Simulator::flatten_parameters()
+{
+	layout = model->getParameterLayout();
+
+	const std::size_t nparams{ layout.distributions.size() };
+
+	// the parameters read by the observables (all of them until there are
+	// observables)
+	std::vector<bool> used(nparams, true);
+	if(prune_parameters && !obs_indices.empty())
+	{
+		used.assign(nparams, false);
+		for(const ObservableIndex &obs : obs_indices)
+			model->markObservableParameters(obs, used);
+	}
+
+	// the constant parameters are set once
+	param_template.resize(nparams, 0.);
+	independent_params.clear();
+	sampled_params.clear();
+	for(std::size_t p = 0; p < nparams; ++p)
+	{
+		if(!IsJointComponent(*layout.distributions[p]) &&
+			!layout.distributions[p]->isConstant(param_template[p]))
+		{
+			independent_params.push_back(p);
+			if(used[p])
+				sampled_params.push_back(p);
+		}
+	}
+
+	// the groups of joint parameters, shifted to the flattened slots
+	joint_params.clear();
+	for(const auto &offset : layout.offsets)
+	{
+		for(JointParameters joint : offset.first->joint_params)
+		{
+			for(std::size_t &slot : joint.slots)
+				slot += offset.second;
+			if(std::any_of(joint.slots.begin(), joint.slots.end(),
+				[&used] (std::size_t slot) -> bool
+				{
+					return used[slot];
+				}))
+			{
+				joint_params.push_back(std::move(joint));
+			}
+		}
+	}
+
+	// keep the proposals of the parameters that are still sampled
+	// independently with a density; those of the unread parameters are kept
+	// for later, but do not weigh the trials
+	proposals.resize(nparams);
+	proposed_params.clear();
+	for(std::size_t p = 0; p < nparams; ++p)
+	{
+		if(proposals[p] == nullptr)
+			continue;
+
+		if(std::binary_search(independent_params.begin(),
+			independent_params.end(), p)
+			&& layout.distributions[p]->hasDensity())
+		{
+			if(used[p])
+				proposed_params.push_back(p);
+		}
+		else
+			proposals[p] = nullptr;
+	}
+}
+
+void Simulator::generateParameters(Engine &engine,
+	std::valarray<double> &params) const
+{
+	MOLSTAT_TRACE_EVENT("generate parameters");
+	params = param_template;
+
+	for(const std::size_t p : sampled_params)
+		params[p] = layout.distributions[p]->sample(engine);
+	for(const JointParameters &joint : joint_params)
+		joint.dist->sample(engine, &params[0], joint.slots);
+}
+
+bool Simulator::evaluateObservables(const std::valarray<double> &params,
+	double *obs, std::size_t *rejections) const
+{
+	bool produced{ true };
+
+	if(fused_function)
+	{
+		try
+		{
+			fused_function(params, obs);
+		}
+		catch(const NoObservableProduced &e)
+		{
+			for(std::size_t j = 0; j < obs_functions.size(); ++j)
+				obs[j] = NoObservableValue;
+		}
+	}
+
+	// evaluate every observable (even after one is missing) so that the
+	// rejections are tallied for each observable
+	for(std::size_t j = 0; j < obs_functions.size(); ++j)
+	{
+		if(!fused_function)
+		{
+			try
+			{
+				obs[j] = obs_functions[j](params);
+			}
+			catch(const NoObservableProduced &e)
+			{
+				obs[j] = NoObservableValue;
+			}
+		}
+
+		if(std::isnan(obs[j]))
+		{
+			produced = false;
+			if(rejections != nullptr)
+				++rejections[j];
+		}
+	}
+
+	return produced;
 }
 
 std::valarray<double> Simulator::simulate(Engine &engine) const
 {
+	MOLSTAT_TRACE_EVENT("simulate");
 	std::size_t num_obs{ obs_functions.size() };
 
 	if(num_obs == 0)
@@ -36,16 +179,587 @@ std::valarray<double> Simulator::simulate(Engine &engine) const
 
 	std::valarray<double> ret( num_obs );
 
-	// get some parameters
-	const std::valarray<double> params{ model->generateParameters(engine) };
+	// get some parameters, in this thread's reused buffer
+	SubmodelParameterBuffers::Frame frame{ 1 };
+	std::valarray<double> &params = frame.get(0, param_template.size());
+	generateParameters(engine, params);
 
 	// calculate each of the observables
-	for(std::size_t j = 0; j < num_obs; ++j)
-		ret[j] = obs_functions[j](params);
+	if(!evaluateObservables(params, &ret[0], nullptr))
+		throw NoObservableProduced();
 
 	return ret;
 }
 
+std::size_t Simulator::simulateBatch(Engine &engine, std::size_t ntrials,
+	double *out, std::vector<double> &workspace, std::size_t *rejections,
+	SimulatorTimings *timings, double *params_out, double *weights_out) const
+{
+	if(obs_functions.empty())
+		throw molstat::NoObservables();
+
+	// the clock is only read when profiling
+	ProfileClock::time_point start;
+	if(timings != nullptr)
+	{
+		timings->ntrials += ntrials;
+		start = ProfileClock::now();
+	}
+
+	// generate the parameters for all trials (parameter-major)
+	reserveWorkspace(ntrials, workspace);
+	{
+		MOLSTAT_TRACE_EVENT("generate parameters");
+		const std::size_t nparams{ layout.distributions.size() };
+		for(std::size_t p = 0, k = 0; p < nparams; ++p)
+		{
+			double *const row{ workspace.data() + p*ntrials };
+
+			if(k < sampled_params.size() && sampled_params[k] == p)
+			{
+				const RandomDistribution &dist{ proposals[p] != nullptr ?
+					*proposals[p] : *layout.distributions[p] };
+				dist.sample_n(engine, row, ntrials);
+				++k;
+			}
+			else
+				std::fill(row, row + ntrials, param_template[p]);
+		}
+		for(const JointParameters &joint : joint_params)
+			joint.dist->sample_n(engine, workspace.data(), ntrials,
+				joint.slots);
+		weighTrials(ntrials, workspace);
+	}
+	if(timings != nullptr)
+		timings->parameters += LapSeconds(start);
+
+	return evaluateBatch(ntrials, out, workspace, rejections, timings,
+		params_out, weights_out, start);
+}
+
+std::size_t Simulator::simulateBatchQMC(const SobolSequence &sobol,
+	std::uint64_t first, Engine &engine, std::size_t ntrials, double *out,
+	std::vector<double> &workspace, std::size_t *rejections,
+	SimulatorTimings *timings, double *params_out, double *weights_out) const
+{
+	if(obs_functions.empty())
+		throw molstat::NoObservables();
+
+	ProfileClock::time_point start;
+	if(timings != nullptr)
+	{
+		timings->ntrials += ntrials;
+		start = ProfileClock::now();
+	}
+
+	reserveWorkspace(ntrials, workspace);
+	generateStratified(&sobol, nullptr, first, engine, ntrials, workspace);
+	weighTrials(ntrials, workspace);
+	if(timings != nullptr)
+		timings->parameters += LapSeconds(start);
+
+	return evaluateBatch(ntrials, out, workspace, rejections, timings,
+		params_out, weights_out, start);
+}
+
+std::size_t Simulator::simulateBatchLHS(Engine &engine, std::size_t ntrials,
+	double *out, std::vector<double> &workspace, std::size_t *rejections,
+	SimulatorTimings *timings, double *params_out, double *weights_out) const
+{
+	if(obs_functions.empty())
+		throw molstat::NoObservables();
+
+	ProfileClock::time_point start;
+	if(timings != nullptr)
+	{
+		timings->ntrials += ntrials;
+		start = ProfileClock::now();
+	}
+
+	reserveWorkspace(ntrials, workspace);
+	generateStratified(nullptr, nullptr, 0, engine, ntrials, workspace);
+	weighTrials(ntrials, workspace);
+	if(timings != nullptr)
+		timings->parameters += LapSeconds(start);
+
+	return evaluateBatch(ntrials, out, workspace, rejections, timings,
+		params_out, weights_out, start);
+}
+
+std::size_t Simulator::simulateBatchPooled(const VariatePool &pool,
+	std::uint64_t first, Engine &engine, std::size_t ntrials, double *out,
+	std::vector<double> &workspace, std::size_t *rejections,
+	SimulatorTimings *timings, double *params_out, double *weights_out,
+	ContributionCache *cache) const
+{
+	if(obs_functions.empty())
+		throw molstat::NoObservables();
+	if(cache != nullptr && (first > cache->ntrials ||
+		ntrials > cache->ntrials - first))
+		throw std::out_of_range("The trials are not in the cache.");
+	if(cache != nullptr)
+	{
+		bool matches{ cache->params.size() ==
+			layout.distributions.size() * cache->ntrials &&
+			cache->first_term.size() == plan.numObservables() + 1 };
+		for(std::size_t j = 0; matches && j < plan.numObservables(); ++j)
+			matches = cache->first_term[j + 1] - cache->first_term[j] ==
+				plan.numTerms(j);
+		if(!matches)
+			throw std::invalid_argument("The cache is for another simulator.");
+	}
+
+	ProfileClock::time_point start;
+	if(timings != nullptr)
+	{
+		timings->ntrials += ntrials;
+		start = ProfileClock::now();
+	}
+
+	reserveWorkspace(ntrials, workspace);
+	generateStratified(nullptr, &pool, first, engine, ntrials, workspace);
+	weighTrials(ntrials, workspace);
+	if(timings != nullptr)
+		timings->parameters += LapSeconds(start);
+
+	return evaluateBatch(ntrials, out, workspace, rejections, timings,
+		params_out, weights_out, start, cache, first);
+}
+
+/**
+ * \brief Generates one dimension of a Latin hypercube.
+ *
+ * Value `t` is first placed randomly in the interval `[t/n, (t+1)/n)`, and
+ * the values are then randomly permuted (Fisher-Yates).
+ *
+ * \param[in] engine The C++11 random number engine.
+ * \param[out] u Storage for the `n` uniform numbers.
+ * \param[in] n The number of values.
+ */
+static void latin_hypercube(Engine &engine, double *u, std::size_t n)
+{
+	const double inverse{ 1. / n };
+
+	sample_canonical_n(engine, u, n);
+	for(std::size_t t = 0; t < n; ++t)
+		u[t] = (t + u[t]) * inverse;
+
+	for(std::size_t t = n; t > 1; --t)
+	{
+		double r;
+		sample_canonical_n(engine, &r, 1);
+		const std::size_t j{ std::min(static_cast<std::size_t>(r * t),
+			t - 1) };
+		std::swap(u[t - 1], u[j]);
+	}
+}
+
+void Simulator::generateStratified(const SobolSequence *sobol,
+	const VariatePool *pool, std::uint64_t first, Engine &engine,
+	std::size_t ntrials, std::vector<double> &workspace) const
+{
+	MOLSTAT_TRACE_EVENT("generate parameters");
+
+	// the parameters are assigned dimensions in order; those without a
+	// quantile function, or beyond the dimensions of the sequence (or pool),
+	// are sampled from the engine
+	const std::size_t ndims{ sobol != nullptr ? sobol->dimension() :
+		pool != nullptr ? pool->dimension() :
+		std::numeric_limits<std::size_t>::max() };
+	std::size_t d{ 0 };
+	const auto uniforms = [sobol, pool, first, &engine, ntrials, &d]
+		(double *row) -> void
+	{
+		if(sobol != nullptr)
+			sobol->generate(first, ntrials, d, row);
+		else if(pool != nullptr)
+			pool->generate(first, ntrials, d, row);
+		else
+			latin_hypercube(engine, row, ntrials);
+		++d;
+	};
+
+	const std::size_t nparams{ layout.distributions.size() };
+	for(std::size_t p = 0, k = 0; p < nparams; ++p)
+	{
+		double *const row{ workspace.data() + p*ntrials };
+
+		if(k < sampled_params.size() && sampled_params[k] == p)
+		{
+			const RandomDistribution &dist{ proposals[p] != nullptr ?
+				*proposals[p] : *layout.distributions[p] };
+
+			if(d < ndims && dist.hasQuantile())
+			{
+				uniforms(row);
+				dist.quantile_n(row, row, ntrials);
+			}
+			else
+				dist.sample_n(engine, row, ntrials);
+			++k;
+		}
+		else
+			std::fill(row, row + ntrials, param_template[p]);
+	}
+	for(const JointParameters &joint : joint_params)
+	{
+		if(joint.slots.size() <= ndims - d)
+		{
+			for(const std::size_t slot : joint.slots)
+				uniforms(workspace.data() + slot*ntrials);
+			joint.dist->quantile_n(workspace.data(), ntrials, joint.slots);
+		}
+		else
+			joint.dist->sample_n(engine, workspace.data(), ntrials,
+				joint.slots);
+	}
+}
+
+std::size_t Simulator::numQuasiRandomDimensions() const
+{
+	std::size_t ret{ 0 };
+
+	for(const std::size_t p : sampled_params)
+		if((proposals[p] != nullptr ? *proposals[p] : *layout.distributions[p])
+			.hasQuantile())
+			++ret;
+	for(const JointParameters &joint : joint_params)
+		ret += joint.slots.size();
+
+	return ret;
+}
+
+std::size_t Simulator::numWorkspaceRows() const
+{
+	// the parameters (parameter-major), followed by space for the
+	// observables (observable-major) and the plan's scratch registers
+	return layout.distributions.size() + obs_functions.size() +
+		(fused_function ? 0 : plan.numScratch());
+}
+
+void Simulator::reserveWorkspace(std::size_t ntrials,
+	std::vector<double> &workspace) const
+{
+	// importance sampling adds the weights and a row for the log densities
+	const std::size_t nrows{ numWorkspaceRows() +
+		(proposed_params.empty() ? 0 : 2) };
+
+	if(workspace.size() < nrows * ntrials)
+		workspace.resize(nrows * ntrials);
+}
+
+void Simulator::weighTrials(std::size_t ntrials,
+	std::vector<double> &workspace) const
+{
+	if(proposed_params.empty())
+		return;
+
+	double *const weights{ workspace.data() + numWorkspaceRows()*ntrials };
+	double *const logdens{ weights + ntrials };
+
+	// accumulate the log of the density ratio
+	std::fill(weights, weights + ntrials, 0.);
+	for(const std::size_t p : proposed_params)
+	{
+		const double *const row{ workspace.data() + p*ntrials };
+
+		layout.distributions[p]->log_density_n(row, logdens, ntrials);
+		for(std::size_t t = 0; t < ntrials; ++t)
+			weights[t] += logdens[t];
+
+		proposals[p]->log_density_n(row, logdens, ntrials);
+		for(std::size_t t = 0; t < ntrials; ++t)
+			weights[t] -= logdens[t];
+	}
+
+	// a vanishing target density (with a vanishing proposal density, which
+	// gives NaN) has no weight
+	for(std::size_t t = 0; t < ntrials; ++t)
+		weights[t] = std::isnan(weights[t]) ? 0. : std::exp(weights[t]);
+}
+
+std::size_t Simulator::evaluateBatch(std::size_t ntrials, double *out,
+	std::vector<double> &workspace, std::size_t *rejections,
+	SimulatorTimings *timings, double *params_out, double *weights_out,
+	ProfileClock::time_point &start, ContributionCache *cache,
+	std::uint64_t first) const
+{
+	MOLSTAT_TRACE_EVENT("observables");
+	const std::size_t num_obs{ obs_functions.size() };
+	const std::size_t nparams{ layout.distributions.size() };
+
+	// the weight of trial t (1 without importance sampling)
+	const double *const weights{ proposed_params.empty() ? nullptr :
+		workspace.data() + numWorkspaceRows()*ntrials };
+	const auto weight = [weights] (std::size_t t) -> double
+	{
+		return weights == nullptr ? 1. : weights[t];
+	};
+
+	// the fused observables are calculated trial-by-trial
+	if(fused_function)
+	{
+		std::valarray<double> params(nparams);
+		std::size_t nvalid{ 0 };
+
+		for(std::size_t t = 0; t < ntrials; ++t)
+		{
+			for(std::size_t p = 0; p < nparams; ++p)
+				params[p] = workspace[p*ntrials + t];
+			if(params_out != nullptr)
+				std::copy(std::begin(params), std::end(params),
+					params_out + nvalid*nparams);
+			if(weights_out != nullptr)
+				weights_out[nvalid] = weight(t);
+
+			// if this trial is discarded, the next one overwrites the row
+			if(evaluateObservables(params, out + nvalid*num_obs, rejections))
+				++nvalid;
+		}
+		if(timings != nullptr)
+			timings->combined += LapSeconds(start);
+
+		return nvalid;
+	}
+
+	// otherwise each observable is calculated for the entire batch by the
+	// plan
+	std::vector<const double *> params(nparams);
+	for(std::size_t p = 0; p < nparams; ++p)
+		params[p] = workspace.data() + p*ntrials;
+
+	double *const obs{ workspace.data() + nparams*ntrials };
+	double *const scratch{ obs + num_obs*ntrials };
+	if(cache == nullptr)
+	{
+		for(std::size_t j = 0; j < num_obs; ++j)
+		{
+			plan.evaluate(j, params.data(), ntrials, obs + j*ntrials, scratch);
+			if(timings != nullptr)
+				timings->observables[j] += LapSeconds(start);
+		}
+	}
+	else
+	{
+		// each term is calculated only if the parameters it reads changed
+		// (for any trial of the batch) since the trials were cached
+		const std::size_t stride{ cache->ntrials };
+		const bool filled{ std::all_of(cache->filled.begin() + first,
+			cache->filled.begin() + first + ntrials,
+			[] (char f) -> bool { return f != 0; }) };
+
+		std::vector<const double *> values;
+		for(std::size_t j = 0; j < num_obs; ++j)
+		{
+			values.resize(plan.numTerms(j));
+			for(std::size_t k = 0; k < values.size(); ++k)
+			{
+				double *const row{ cache->values.data() +
+					(cache->first_term[j] + k)*stride + first };
+				values[k] = row;
+
+				bool same{ filled };
+				for(const std::size_t p : plan.termSlots(j, k))
+					same = same && std::memcmp(params[p],
+						cache->params.data() + p*stride + first,
+						ntrials * sizeof(double)) == 0;
+
+				if(same)
+					cache->nreused += ntrials;
+				else
+				{
+					plan.evaluateTerm(j, k, params.data(), ntrials, row,
+						scratch);
+					cache->ncalculated += ntrials;
+				}
+			}
+			plan.combineTerms(j, values.data(), ntrials, obs + j*ntrials);
+			if(timings != nullptr)
+				timings->observables[j] += LapSeconds(start);
+		}
+
+		// the parameters are cached once every term is up to date
+		for(std::size_t p = 0; p < nparams; ++p)
+			std::copy(params[p], params[p] + ntrials,
+				cache->params.begin() + p*stride + first);
+		std::fill(cache->filled.begin() + first,
+			cache->filled.begin() + first + ntrials, 1);
+	}
+
+	// keep the trials that produced every observable
+	std::size_t nvalid{ 0 };
+
+	for(std::size_t t = 0; t < ntrials; ++t)
+	{
+		bool produced{ true };
+
+		for(std::size_t j = 0; j < num_obs; ++j)
+		{
+			const double val{ obs[j*ntrials + t] };
+			out[nvalid*num_obs + j] = val;
+
+			if(std::isnan(val))
+			{
+				produced = false;
+				if(rejections != nullptr)
+					++rejections[j];
+			}
+		}
+
+		if(params_out != nullptr)
+		{
+			for(std::size_t p = 0; p < nparams; ++p)
+				params_out[nvalid*nparams + p] = workspace[p*ntrials + t];
+		}
+		if(weights_out != nullptr)
+			weights_out[nvalid] = weight(t);
+
+		// if this trial is discarded, the next one overwrites the row
+		if(produced)
+			++nvalid;
+	}
+
+	return nvalid;
+}
+
+std::size_t Simulator::simulateTrace(Engine &engine,
+	const TraceProtocol &trace, double *out, std::size_t *rejections,
+	SimulatorTimings *timings) const
+{
+	const std::size_t num_obs{ obs_functions.size() };
+
+	if(num_obs == 0)
+		throw molstat::NoObservables();
+
+	// the clock is only read when profiling
+	ProfileClock::time_point start;
+	if(timings != nullptr)
+	{
+		timings->ntrials += trace.numPoints();
+		start = ProfileClock::now();
+	}
+
+	// find the parameters changed by the protocol
+	const std::vector<std::string> names{ model->getParameterNames() };
+	const auto find_indices = [&names] (const std::string &name)
+		-> std::vector<std::size_t>
+	{
+		std::vector<std::size_t> ret;
+		for(std::size_t p = 0; p < names.size(); ++p)
+			if(names[p] == name)
+				ret.push_back(p);
+
+		if(ret.empty())
+			throw UnknownParameter(name);
+
+		return ret;
+	};
+
+	std::vector<std::pair<std::vector<std::size_t>,
+		const TraceProtocol::DisplacementFunction *>> shifts;
+	for(const auto &shift : trace.getShifts())
+		shifts.emplace_back(find_indices(shift.first), &shift.second);
+
+	std::vector<std::pair<std::vector<std::size_t>, double>> ruptured;
+	for(const auto &rupture : trace.getRuptured())
+		ruptured.emplace_back(find_indices(rupture.first), rupture.second);
+
+	// the parameters and length for this trace, in this thread's reused
+	// buffers
+	SubmodelParameterBuffers::Frame frame{ 2 };
+	std::valarray<double> &params = frame.get(0, param_template.size());
+	generateParameters(engine, params);
+	const double length{ trace.getLength() == nullptr ?
+		std::numeric_limits<double>::infinity() :
+		trace.getLength()->sample(engine) };
+	if(timings != nullptr)
+		timings->parameters += LapSeconds(start);
+
+	std::valarray<double> &point = frame.get(1, params.size());
+	std::size_t nvalid{ 0 };
+
+	for(std::size_t j = 0; j < trace.numPoints(); ++j)
+	{
+		const double z{ trace.displacement(j) };
+
+		point = params;
+		for(const auto &shift : shifts)
+		{
+			const double dp{ (*shift.second)(z) };
+			for(const std::size_t p : shift.first)
+				point[p] += dp;
+		}
+		if(z > length)
+		{
+			for(const auto &rupture : ruptured)
+				for(const std::size_t p : rupture.first)
+					point[p] = rupture.second;
+		}
+
+		// if this point is discarded, the next one overwrites the row
+		double *row = out + nvalid*(num_obs + 1);
+		row[0] = z;
+		if(evaluateObservables(point, row + 1, rejections))
+			++nvalid;
+	}
+	if(timings != nullptr)
+		timings->combined += LapSeconds(start);
+
+	return nvalid;
+}
+
+ContributionCache::ContributionCache(const Simulator &sim,
+	std::size_t ntrials_)
+	: ntrials(ntrials_), first_term(1, 0),
+	params(sim.layout.distributions.size() * ntrials_), values(),
+	filled(ntrials_, 0), ncalculated(0), nreused(0)
+{
+	for(std::size_t j = 0; j < sim.plan.numObservables(); ++j)
+		first_term.push_back(first_term.back() + sim.plan.numTerms(j));
+	values.resize(first_term.back() * ntrials);
+}
+
+std::size_t ContributionCache::size() const noexcept
+{
+	return ntrials;
+}
+
+std::size_t ContributionCache::numCalculated() const noexcept
+{
+	return ncalculated;
+}
+
+std::size_t ContributionCache::numReused() const noexcept
+{
+	return nreused;
+}
+
+std::size_t ContributionCache::memoryUsage() const noexcept
+{
+	return (params.capacity() + values.capacity()) * sizeof(double) +
+		filled.capacity() + first_term.capacity() * sizeof(std::size_t);
+}
+
+std::size_t Simulator::numObservables() const noexcept
+{
+	return obs_functions.size();
+}
+
+std::size_t Simulator::numParameters() const noexcept
+{
+	return layout.distributions.size();
+}
+
+std::size_t Simulator::numSampledParameters() const noexcept
+{
+	return sampled_params.size();
+}
+
+std::vector<std::string> Simulator::getParameterNames() const
+{
+	return model->getParameterNames();
+}
+
 void Simulator::setObservable(std::size_t j, const ObservableIndex &obs)
 {
 	std::size_t length { obs_functions.size() };
@@ -56,11 +770,127 @@ void Simulator::setObservable(std::size_t j, const ObservableIndex &obs)
 	// getObservableFunction will throw IncompatibleObservable if this doesn't
 	// work... let it pass upwards.
 	ObservableFunction func { model->getObservableFunction(obs) };
+	std::vector<ObservableIndex> indices{ obs_indices };
+	if(j < length)
+		indices[j] = obs;
+	else
+		indices.push_back(obs);
+
+	// lower the observables into a plan for the batches
+	EvaluationPlan newplan(*model, indices);
 
 	if(j < length)
 		obs_functions[j] = func;
 	else
 		obs_functions.push_back(func);
+	obs_indices = std::move(indices);
+	plan = std::move(newplan);
+
+	// use the fused observables if the model has them
+	fused_function = model->getFusedObservableFunction(obs_indices);
+
+	// the observables determine the parameters that are sampled
+	flatten_parameters();
+}
+
+void Simulator::setDistribution(SimulateModel &owner, const std::string &name,
+	std::shared_ptr<const RandomDistribution> dist)
+{
+	if(dist == nullptr)
+		throw std::invalid_argument("No distribution specified.");
+	if(std::none_of(layout.offsets.begin(), layout.offsets.end(),
+		[&owner] (const std::pair<const SimulateModel *, std::size_t> &offset)
+			-> bool
+		{
+			return offset.first == &owner;
+		}))
+	{
+		throw std::invalid_argument("The model is not part of the simulator.");
+	}
+
+	// replace the distribution of every parameter with the name
+	const std::vector<std::string> names{ owner.get_names() };
+	const std::string lower_name{ to_lower(name) };
+	bool found{ false };
+	for(std::size_t pos = 0; pos < names.size(); ++pos)
+	{
+		if(lower_name == to_lower(names[pos]))
+		{
+			owner.dists[pos] = dist;
+			found = true;
+		}
+	}
+	if(!found)
+		throw UnknownParameter(name);
+
+	owner.group_joint_parameters();
+	flatten_parameters();
+}
+
+void Simulator::setProposal(const SimulateModel &owner,
+	const std::string &name, std::shared_ptr<const RandomDistribution> proposal)
+{
+	if(proposal == nullptr)
+		throw std::invalid_argument("No distribution specified.");
+	if(!proposal->hasDensity())
+		throw std::invalid_argument("The proposal distribution has no " \
+			"density: " + proposal->info());
+
+	// a submodel may appear several times in the layout (e.g., copies of a
+	// channel); the proposal is used for each
+	std::vector<std::size_t> offsets;
+	for(const auto &off : layout.offsets)
+		if(off.first == &owner)
+			offsets.push_back(off.second);
+	if(offsets.empty())
+		throw std::invalid_argument("The model is not part of the simulator.");
+
+	// check every parameter with the name before setting any proposals
+	const std::vector<std::string> names{ owner.get_names() };
+	const std::string lower_name{ to_lower(name) };
+	std::vector<std::size_t> slots;
+	for(std::size_t pos = 0; pos < names.size(); ++pos)
+	{
+		if(lower_name != to_lower(names[pos]))
+			continue;
+
+		for(const std::size_t offset : offsets)
+		{
+			const std::size_t p{ offset + pos };
+			if(!std::binary_search(independent_params.begin(),
+				independent_params.end(), p))
+				throw std::invalid_argument("Parameter \"" + name + "\" is " \
+					"not sampled independently, so it cannot have a proposal " \
+					"distribution.");
+			if(!layout.distributions[p]->hasDensity())
+				throw std::invalid_argument("The distribution of parameter \"" +
+					name + "\" has no density: " +
+					layout.distributions[p]->info());
+
+			slots.push_back(p);
+		}
+	}
+	if(slots.empty())
+		throw UnknownParameter(name);
+
+	for(const std::size_t p : slots)
+		proposals[p] = proposal;
+	flatten_parameters();
+}
+
+bool Simulator::isWeighted() const noexcept
+{
+	return std::any_of(proposals.begin(), proposals.end(),
+		[] (const std::shared_ptr<const RandomDistribution> &proposal) -> bool
+		{
+			return proposal != nullptr;
+		});
+}
+
+void Simulator::setParameterPruning(bool prune)
+{
+	prune_parameters = prune;
+	flatten_parameters();
 }
 
 } // namespace MolStat
@@ -28,15 +28,106 @@
 #ifndef __simulator_h__
 #define __simulator_h__
 
+#include <atomic>
 #include <memory>
+#include <string>
 #include <valarray>
 #include <vector>
 #include <typeindex>
 #include <general/random_distributions/rng.h>
+#include <general/random_distributions/sobol.h>
+#include <general/random_distributions/variate_pool.h>
 #include "simulate_model.h"
+#include "evaluation_plan.h"
+#include "simulator_profile.h"
+#include "trace_protocol.h"
 
 namespace molstat {
 
+class Simulator;
+
+/**
+ * \brief The terms of the observables of each trial of a pool of base
+ *    variates, and the model parameters they read, from the last time the
+ *    trials were simulated.
+ *
+ * Each observable is combined from its terms (one for each submodel of a
+ * composite model; see molstat::EvaluationPlan). When the trials of a pool
+ * are simulated again with a cache (see Simulator::simulateBatchPooled),
+ * each term whose parameters are unchanged (for the whole batch) is taken
+ * from the cache, and only the other terms are calculated. After changing
+ * the distributions of one submodel, only its terms are thus calculated.
+ * The terms are then combined as before, so the observables are identical
+ * to those calculated without the cache, whatever the combining operation.
+ *
+ * Different threads may use the same cache for different trials. The cache
+ * is tied to the observables of the simulator that made it.
+ */
+class ContributionCache
+{
+	friend class Simulator;
+
+private:
+	/// The number of trials.
+	const std::size_t ntrials;
+
+	/// The index of the first term of each observable (and the total).
+	std::vector<std::size_t> first_term;
+
+	/// The model parameters, `ntrials` for each parameter.
+	std::vector<double> params;
+
+	/// The values of the terms, `ntrials` for each term.
+	std::vector<double> values;
+
+	/// Whether each trial has been simulated.
+	std::vector<char> filled;
+
+	/// The numbers of terms (of trials) calculated and taken from the cache.
+	std::atomic<std::size_t> ncalculated, nreused;
+
+public:
+	ContributionCache() = delete;
+	ContributionCache(const ContributionCache &) = delete;
+	ContributionCache &operator=(const ContributionCache &) = delete;
+
+	/**
+	 * \brief Constructs an empty cache for the observables of a simulator.
+	 *
+	 * \param[in] sim The simulator.
+	 * \param[in] ntrials_ The number of trials (of the pool).
+	 */
+	ContributionCache(const Simulator &sim, std::size_t ntrials_);
+
+	/**
+	 * \brief Gets the number of trials.
+	 *
+	 * \return The number of trials.
+	 */
+	std::size_t size() const noexcept;
+
+	/**
+	 * \brief Gets the number of terms (of trials) that were calculated.
+	 *
+	 * \return The number of terms calculated.
+	 */
+	std::size_t numCalculated() const noexcept;
+
+	/**
+	 * \brief Gets the number of terms (of trials) taken from the cache.
+	 *
+	 * \return The number of terms reused.
+	 */
+	std::size_t numReused() const noexcept;
+
+	/**
+	 * \brief Gets the memory held by the cache.
+	 *
+	 * \return The memory (bytes).
+	 */
+	std::size_t memoryUsage() const noexcept;
+};
+
 /**
  * \brief Class for simulating data.
  *
@@ -49,12 +140,209 @@ private:
 	/// The actual model used to simulate data.
 	std::shared_ptr<SimulateModel> model;
 
+	/**
+	 * \brief The flattened parameters of the model, computed when the
+	 *    molstat::Simulator is constructed.
+	 */
+	ParameterLayout layout;
+
+	/**
+	 * \brief A set of model parameters with the values of the constant
+	 *    parameters filled in.
+	 */
+	std::valarray<double> param_template;
+
+	/**
+	 * \brief The indices of the model parameters that are sampled
+	 *    independently (their distributions are neither constant nor
+	 *    joint).
+	 */
+	std::vector<std::size_t> independent_params;
+
+	/**
+	 * \brief The indices of the model parameters that are sampled for each
+	 *    trial.
+	 *
+	 * These are the parameters of Simulator::independent_params that the
+	 * observables read (see Simulator::setParameterPruning). The other
+	 * parameters are copied from Simulator::param_template.
+	 */
+	std::vector<std::size_t> sampled_params;
+
+	/**
+	 * \brief The groups of model parameters with joint distributions, with
+	 *    slots in the flattened layout.
+	 *
+	 * The groups of each model and submodel (see
+	 * SimulateModel::joint_params) are sampled together after
+	 * Simulator::sampled_params, unless the observables read none of their
+	 * parameters.
+	 */
+	std::vector<JointParameters> joint_params;
+
+	/**
+	 * \brief Whether the parameters that no observable reads are skipped
+	 *    (see Simulator::setParameterPruning).
+	 */
+	bool prune_parameters;
+
+	/**
+	 * \brief The proposal distribution of each model parameter for importance
+	 *    sampling, or nullptr if the parameter is sampled from its own
+	 *    distribution.
+	 */
+	std::vector<std::shared_ptr<const RandomDistribution>> proposals;
+
+	/**
+	 * \brief The indices of the sampled model parameters with proposal
+	 *    distributions.
+	 */
+	std::vector<std::size_t> proposed_params;
+
+	/**
+	 * \brief Generates a set of model parameters from the flattened layout.
+	 *
+	 * This is equivalent to (and, without joint distributions, produces the
+	 * same values as) molstat::SimulateModel::generateParameters, without
+	 * recursing through the submodels or sampling the constant parameters.
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[out] params Storage for the model parameters.
+	 */
+	void generateParameters(Engine &engine, std::valarray<double> &params)
+		const;
+
+	/**
+	 * \brief Flattens the parameters of the model and sets the values of
+	 *    the constant parameters.
+	 *
+	 * Sets Simulator::layout, Simulator::param_template,
+	 * Simulator::independent_params, Simulator::sampled_params,
+	 * Simulator::joint_params, and Simulator::proposed_params, from the
+	 * distributions and the observables. A proposal distribution is discarded
+	 * if its parameter is no longer sampled independently with a density.
+	 */
+	void flatten_parameters();
+
 	/**
 	 * \brief The functions that calculate observables, given a set of model
 	 *    parameters.
 	 */
 	std::vector<ObservableFunction> obs_functions;
 
+	/**
+	 * \brief The plan that calculates the observables for a batch of model
+	 *    parameters (the observables of Simulator::obs_functions, with the
+	 *    composite observables lowered through the submodels).
+	 */
+	EvaluationPlan plan;
+
+	/// The observables (one per entry of Simulator::obs_functions).
+	std::vector<ObservableIndex> obs_indices;
+
+	/**
+	 * \brief Function that calculates all of the observables together, if
+	 *    the model supports it (empty otherwise).
+	 */
+	FusedObservableFunction fused_function;
+
+	/**
+	 * \brief Evaluates each observable for one set of model parameters.
+	 *
+	 * \param[in] params The model parameters.
+	 * \param[out] obs Storage for the observables.
+	 * \param[in,out] rejections If not nullptr, the tally for each observable
+	 *    is incremented when that observable is not produced.
+	 * \return True if every observable was produced, false otherwise.
+	 */
+	bool evaluateObservables(const std::valarray<double> &params, double *obs,
+		std::size_t *rejections) const;
+
+	/**
+	 * \brief Gets the number of rows (of one value per trial) in the
+	 *    workspace of a batch before the importance weights.
+	 *
+	 * \return The number of rows for the model parameters, the observables,
+	 *    and the plan's scratch registers.
+	 */
+	std::size_t numWorkspaceRows() const;
+
+	/**
+	 * \brief Resizes the workspace of a batch, if needed, to hold the model
+	 *    parameters, the observables, the plan's scratch registers, and (for
+	 *    importance sampling) the weights of the trials.
+	 *
+	 * \param[in] ntrials The number of trials in the batch.
+	 * \param[in,out] workspace The workspace.
+	 */
+	void reserveWorkspace(std::size_t ntrials,
+		std::vector<double> &workspace) const;
+
+	/**
+	 * \brief Calculates the importance weight of each trial in a batch whose
+	 *    model parameters have been generated in the workspace.
+	 *
+	 * The weight of a trial is the ratio of the densities of its parameters
+	 * under their distributions and under their proposal distributions; it is
+	 * 0 if the target density vanishes.
+	 *
+	 * \param[in] ntrials The number of trials in the batch.
+	 * \param[in,out] workspace The workspace, with the model parameters.
+	 */
+	void weighTrials(std::size_t ntrials, std::vector<double> &workspace)
+		const;
+
+	/**
+	 * \brief Generates the model parameters of a batch in the workspace from
+	 *    stratified uniform numbers, transformed by the quantile functions of
+	 *    their distributions.
+	 *
+	 * Each sampled parameter with a quantile function (of its proposal, if
+	 * set) gets the next dimension of the uniform numbers, followed by the
+	 * components of each joint distribution. The uniform numbers come from
+	 * `sobol` or `pool`, if either is not nullptr, and otherwise from a Latin
+	 * hypercube over the batch. The other parameters are sampled from the
+	 * engine.
+	 *
+	 * \param[in] sobol The Sobol sequence, or nullptr.
+	 * \param[in] pool The pool of base variates, or nullptr.
+	 * \param[in] first The index of the first point of the Sobol sequence
+	 *    (or trial of the pool).
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[in] ntrials The number of trials in the batch.
+	 * \param[in,out] workspace The workspace (already reserved).
+	 */
+	void generateStratified(const SobolSequence *sobol,
+		const VariatePool *pool, std::uint64_t first, Engine &engine,
+		std::size_t ntrials, std::vector<double> &workspace) const;
+
+	/**
+	 * \brief Calculates the observables of a batch whose model parameters
+	 *    have been generated in the workspace, and keeps the trials that
+	 *    produced every observable.
+	 *
+	 * The arguments are as in Simulator::simulateBatch.
+	 *
+	 * \param[in] ntrials The number of trials in the batch.
+	 * \param[out] out Storage for the observables.
+	 * \param[in,out] workspace The workspace, with the model parameters.
+	 * \param[in,out] rejections The tallies of rejections, or nullptr.
+	 * \param[in,out] timings The timings, or nullptr.
+	 * \param[out] params_out Storage for the kept parameters, or nullptr.
+	 * \param[out] weights_out Storage for the weights of the kept trials, or
+	 *    nullptr.
+	 * \param[in,out] start The start of the current timing lap.
+	 * \param[in,out] cache The cache of the terms of the observables, or
+	 *    nullptr.
+	 * \param[in] first The index of the first trial in the cache.
+	 * \return The number of trials that produced all of the observables.
+	 */
+	std::size_t evaluateBatch(std::size_t ntrials, double *out,
+		std::vector<double> &workspace, std::size_t *rejections,
+		SimulatorTimings *timings, double *params_out, double *weights_out,
+		ProfileClock::time_point &start, ContributionCache *cache = nullptr,
+		std::uint64_t first = 0) const;
+
 public:
 	Simulator() = delete;
 
@@ -65,6 +353,10 @@ public:
 	 * \throw molstat::FullModelRequired if the specified model is a
 	 *    submodel type.
 	 *
+	 * The model's distributions (and submodels) must not change after the
+	 * molstat::Simulator is constructed, except through
+	 * Simulator::setDistribution.
+	 *
 	 * \param[in] model_ The model to be used.
 	 */
 	Simulator(std::shared_ptr<SimulateModel> model_);
@@ -73,7 +365,12 @@ public:
 	 * \brief Calculates the desired observables using the random number
 	 *    generator.
 	 *
+	 * The model parameters are sampled from their own distributions, even if
+	 * proposal distributions have been set (see setProposal()).
+	 *
 	 * \throw molstat::NoObservables if no observables have been set.
+	 * \throw molstat::NoObservableProduced if any of the observables is not
+	 *    produced for the generated parameters.
 	 * \throw molstat::MissingDistribution if any of the model's required
 	 *    distributions is unspecified.
 	 *
@@ -82,12 +379,257 @@ public:
 	 */
 	std::valarray<double> simulate(Engine &engine) const;
 
+	/**
+	 * \brief Simulates a batch of trials into a preallocated buffer.
+	 *
+	 * Trials that do not produce all of the observables (see
+	 * molstat::NoObservableValue) are discarded; the remaining trials are
+	 * stored contiguously at the front of `out`, row-major (the observables
+	 * for the `k`th successful trial are `out[k*numObservables()]`, ...).
+	 *
+	 * If the model fuses the observables (see
+	 * molstat::SimulateModel::getFusedObservableFunction), they are
+	 * calculated together for each trial. Otherwise, each observable is
+	 * evaluated for the whole batch through its
+	 * molstat::BatchObservableFunction, avoiding a type-erased call for
+	 * every trial.
+	 *
+	 * The workspace is resized as needed to hold the batch's model
+	 * parameters and observables. Reusing it for subsequent calls avoids
+	 * further memory allocations.
+	 *
+	 * \throw molstat::NoObservables if no observables have been set.
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[in] ntrials The number of trials in the batch.
+	 * \param[out] out Storage for `ntrials * numObservables()` values.
+	 * \param[in,out] workspace Scratch space for the model parameters and
+	 *    observables.
+	 * \param[in,out] rejections If not nullptr, an array of
+	 *    `numObservables()` tallies; each is incremented for every trial that
+	 *    does not produce the corresponding observable.
+	 * \param[in,out] timings If not nullptr, the time spent generating the
+	 *    parameters and calculating the observables is added to these
+	 *    timings.
+	 * \param[out] params If not nullptr, storage for
+	 *    `ntrials * numParameters()` values; the model parameters of the
+	 *    kept trials are stored here, row-major, in the same order as `out`.
+	 *    Those that no observable reads are unspecified, unless pruning is
+	 *    disabled (see setParameterPruning()).
+	 * \param[out] weights If not nullptr, storage for `ntrials` values; the
+	 *    importance weight of each kept trial (see setProposal()) is stored
+	 *    here, in the same order as `out`. Every weight is 1 without proposal
+	 *    distributions.
+	 * \return The number of trials that produced all of the observables.
+	 */
+	std::size_t simulateBatch(Engine &engine, std::size_t ntrials,
+		double *out, std::vector<double> &workspace,
+		std::size_t *rejections = nullptr,
+		SimulatorTimings *timings = nullptr, double *params = nullptr,
+		double *weights = nullptr) const;
+
+	/**
+	 * \brief Simulates a batch of trials with quasi-Monte Carlo sampling.
+	 *
+	 * This is Simulator::simulateBatch, except that the sampled model
+	 * parameters come from points `first`, ..., `first + ntrials - 1` of a
+	 * Sobol sequence, transformed by the quantile functions of their
+	 * distributions (see molstat::RandomDistribution::quantile_n). Each
+	 * parameter with a quantile function is given the next dimension of the
+	 * sequence, followed by the components of each joint distribution.
+	 * Parameters without a quantile function, and those left over when the
+	 * sequence runs out of dimensions (see numQuasiRandomDimensions()), are
+	 * sampled from the engine.
+	 *
+	 * Batches covering consecutive ranges of points, in any order or on any
+	 * number of threads, together sample the same points of the sequence.
+	 *
+	 * \throw molstat::NoObservables if no observables have been set.
+	 *
+	 * \param[in] sobol The Sobol sequence.
+	 * \param[in] first The index of the first point of the sequence.
+	 * \param[in] engine The C++11 random number engine, for the parameters
+	 *    not given dimensions of the sequence.
+	 * \param[in] ntrials The number of trials in the batch.
+	 * \param[out] out Storage for `ntrials * numObservables()` values.
+	 * \param[in,out] workspace Scratch space, as in simulateBatch().
+	 * \param[in,out] rejections Tallies of rejections, as in simulateBatch().
+	 * \param[in,out] timings Timings, as in simulateBatch().
+	 * \param[out] params Storage for the kept model parameters, as in
+	 *    simulateBatch().
+	 * \param[out] weights Storage for the importance weights of the kept
+	 *    trials, as in simulateBatch().
+	 * \return The number of trials that produced all of the observables.
+	 */
+	std::size_t simulateBatchQMC(const SobolSequence &sobol,
+		std::uint64_t first, Engine &engine, std::size_t ntrials, double *out,
+		std::vector<double> &workspace, std::size_t *rejections = nullptr,
+		SimulatorTimings *timings = nullptr, double *params = nullptr,
+		double *weights = nullptr) const;
+
+	/**
+	 * \brief Simulates a batch of trials with Latin hypercube sampling.
+	 *
+	 * This is Simulator::simulateBatch, except that the sampled model
+	 * parameters with quantile functions (and the components of the joint
+	 * distributions) are stratified over the batch: the `ntrials` uniform
+	 * numbers for each parameter have one value in each interval of width
+	 * `1/ntrials`, randomly placed within the interval and randomly paired
+	 * with those of the other parameters. They are then transformed by the
+	 * quantile functions of the distributions (see
+	 * molstat::RandomDistribution::quantile_n). Every marginal of the batch
+	 * is thus sampled evenly, which reduces the variance of histograms (and
+	 * averages) of observables dominated by the individual parameters, with
+	 * almost the cost of random sampling. Parameters without a quantile
+	 * function are sampled from the engine.
+	 *
+	 * The stratification is over each batch, so larger batches stratify
+	 * more finely.
+	 *
+	 * \throw molstat::NoObservables if no observables have been set.
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[in] ntrials The number of trials in the batch.
+	 * \param[out] out Storage for `ntrials * numObservables()` values.
+	 * \param[in,out] workspace Scratch space, as in simulateBatch().
+	 * \param[in,out] rejections Tallies of rejections, as in simulateBatch().
+	 * \param[in,out] timings Timings, as in simulateBatch().
+	 * \param[out] params Storage for the kept model parameters, as in
+	 *    simulateBatch().
+	 * \param[out] weights Storage for the importance weights of the kept
+	 *    trials, as in simulateBatch().
+	 * \return The number of trials that produced all of the observables.
+	 */
+	std::size_t simulateBatchLHS(Engine &engine, std::size_t ntrials,
+		double *out, std::vector<double> &workspace,
+		std::size_t *rejections = nullptr,
+		SimulatorTimings *timings = nullptr, double *params = nullptr,
+		double *weights = nullptr) const;
+
+	/**
+	 * \brief Simulates a batch of trials from a fixed pool of base variates
+	 *    (common random numbers).
+	 *
+	 * This is Simulator::simulateBatchQMC, except that the uniform numbers
+	 * are trials `first`, ..., `first + ntrials - 1` of the pool, which are
+	 * transformed by the quantile functions of the current distributions.
+	 * Simulating the same trials after changing the distributions (see
+	 * setDistribution()) thus reuses their base variates, so that the
+	 * observables change smoothly with the distributions' parameters.
+	 * Parameters without a quantile function, and those left over when the
+	 * pool runs out of dimensions, are sampled from the engine; they are also
+	 * reused if the engine is reset to the same state.
+	 *
+	 * \throw molstat::NoObservables if no observables have been set.
+	 * \throw std::out_of_range if the trials are not in the pool (or cache).
+	 * \throw std::invalid_argument if the cache is for other observables.
+	 *
+	 * \param[in] pool The pool of base variates.
+	 * \param[in] first The index of the first trial of the pool.
+	 * \param[in] engine The C++11 random number engine, for the parameters
+	 *    not given dimensions of the pool.
+	 * \param[in] ntrials The number of trials in the batch.
+	 * \param[out] out Storage for `ntrials * numObservables()` values.
+	 * \param[in,out] workspace Scratch space, as in simulateBatch().
+	 * \param[in,out] rejections Tallies of rejections, as in simulateBatch().
+	 * \param[in,out] timings Timings, as in simulateBatch().
+	 * \param[out] params Storage for the kept model parameters, as in
+	 *    simulateBatch().
+	 * \param[out] weights Storage for the importance weights of the kept
+	 *    trials, as in simulateBatch().
+	 * \param[in,out] cache If not nullptr, the terms of the observables of
+	 *    the pool's trials, which are reused where their parameters have not
+	 *    changed (see molstat::ContributionCache) and then updated. Fused
+	 *    observables (see molstat::SimulateModel::getFusedObservableFunction)
+	 *    are always calculated.
+	 * \return The number of trials that produced all of the observables.
+	 */
+	std::size_t simulateBatchPooled(const VariatePool &pool,
+		std::uint64_t first, Engine &engine, std::size_t ntrials, double *out,
+		std::vector<double> &workspace, std::size_t *rejections = nullptr,
+		SimulatorTimings *timings = nullptr, double *params = nullptr,
+		double *weights = nullptr, ContributionCache *cache = nullptr) const;
+
+	/**
+	 * \brief Gets the number of dimensions of a Sobol sequence that
+	 *    Simulator::simulateBatchQMC would use for every sampled parameter.
+	 *
+	 * \return The number of sampled parameters with quantile functions (of
+	 *    their proposal distributions, if set), plus the number of components
+	 *    of the joint distributions.
+	 */
+	std::size_t numQuasiRandomDimensions() const;
+
+	/**
+	 * \brief Simulates one trace, as described by a molstat::TraceProtocol.
+	 *
+	 * One set of model parameters (and one trace length) is generated, and
+	 * the observables are calculated at each displacement of the trace. The
+	 * parameters are sampled from their own distributions, even if proposal
+	 * distributions have been set.
+	 * Each point is stored as a row of `out`: the displacement followed by
+	 * the observables. Points that do not produce all of the observables
+	 * are discarded, and the remaining points are stored contiguously.
+	 *
+	 * \throw molstat::NoObservables if no observables have been set.
+	 * \throw molstat::UnknownParameter if the protocol refers to a parameter
+	 *    that is not in the model.
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[in] trace The trace protocol.
+	 * \param[out] out Storage for `trace.numPoints() * (numObservables()+1)`
+	 *    values.
+	 * \param[in,out] rejections If not nullptr, an array of
+	 *    `numObservables()` tallies; each is incremented for every point that
+	 *    does not produce the corresponding observable.
+	 * \param[in,out] timings If not nullptr, the time spent generating the
+	 *    parameters and calculating the observables is added to these
+	 *    timings (each point is a trial).
+	 * \return The number of points that produced all of the observables.
+	 */
+	std::size_t simulateTrace(Engine &engine, const TraceProtocol &trace,
+		double *out, std::size_t *rejections = nullptr,
+		SimulatorTimings *timings = nullptr) const;
+
+	/**
+	 * \brief Gets the number of observables that have been set.
+	 *
+	 * \return The number of observables.
+	 */
+	std::size_t numObservables() const noexcept;
+
+	/**
+	 * \brief Gets the number of model parameters generated for each trial.
+	 *
+	 * \return The number of model parameters.
+	 */
+	std::size_t numParameters() const noexcept;
+
+	/**
+	 * \brief Gets the number of model parameters that are sampled
+	 *    independently for each trial.
+	 *
+	 * The other parameters are constant, have joint distributions, or are not
+	 * read by the observables (see setParameterPruning()).
+	 *
+	 * \return The number of sampled parameters.
+	 */
+	std::size_t numSampledParameters() const noexcept;
+
+	/**
+	 * \brief Gets the names of the model parameters.
+	 *
+	 * \return The names, in the order used by Simulator::simulateBatch.
+	 */
+	std::vector<std::string> getParameterNames() const;
+
 	/**
 	 * \brief Sets the `j`th observable for the simulator.
 	 *
 	 * First verify that the observable is compatible with the specified model.
 	 * If compatible, get a function for calculating the observable and store
-	 * it for use later.
+	 * it for use later. The model is also asked for a function that fuses
+	 * the observables set so far.
 	 *
 	 * \throw molstat::IncompatibleObservable If our models is incompatible
 	 *    with the desired observable.
@@ -98,6 +640,83 @@ public:
 	 * \param[in] obs The identifier of the observable.
 	 */
 	void setObservable(std::size_t j, const ObservableIndex &obs);
+
+	/**
+	 * \brief Replaces the distribution of a parameter of the model (or one
+	 *    of its submodels).
+	 *
+	 * The model (and the functions for its observables) are reused, so that
+	 * a sweep over distributions does not construct the model again. This
+	 * must not be called while trials are being simulated.
+	 *
+	 * \throw std::invalid_argument if `owner` is not part of the model or
+	 *    `dist` is nullptr.
+	 * \throw molstat::UnknownParameter if `owner` has no parameter `name`.
+	 *
+	 * \param[in,out] owner The model (or submodel) with the parameter.
+	 * \param[in] name The name of the parameter.
+	 * \param[in] dist The new distribution.
+	 */
+	void setDistribution(SimulateModel &owner, const std::string &name,
+		std::shared_ptr<const RandomDistribution> dist);
+
+	/**
+	 * \brief Sets a proposal distribution for a parameter of the model (or
+	 *    one of its submodels), for importance sampling.
+	 *
+	 * The batches (see simulateBatch()) then sample the parameter from the
+	 * proposal instead of its own distribution, and each trial carries the
+	 * weight \f$\prod_p f_p(x_p) / q_p(x_p)\f$ over the parameters with
+	 * proposals, where \f$f_p\f$ and \f$q_p\f$ are the densities of the
+	 * parameter's distribution and proposal. Weighted averages over the
+	 * trials are then averages over the model's distributions; a proposal
+	 * that oversamples a rare region reduces the variance there.
+	 *
+	 * The proposal should be positive wherever the parameter's distribution
+	 * is. It is discarded if the parameter's distribution is later replaced
+	 * (see setDistribution()) by one that is constant, joint, or without a
+	 * density.
+	 *
+	 * \throw std::invalid_argument if `owner` is not part of the model,
+	 *    `proposal` is nullptr, the parameter is not sampled independently
+	 *    (it is constant or part of a joint distribution), or either
+	 *    distribution has no density (see
+	 *    molstat::RandomDistribution::hasDensity).
+	 * \throw molstat::UnknownParameter if `owner` has no parameter `name`.
+	 *
+	 * \param[in] owner The model (or submodel) with the parameter.
+	 * \param[in] name The name of the parameter.
+	 * \param[in] proposal The proposal distribution.
+	 */
+	void setProposal(const SimulateModel &owner, const std::string &name,
+		std::shared_ptr<const RandomDistribution> proposal);
+
+	/**
+	 * \brief Determines if the trials are weighted by importance sampling.
+	 *
+	 * \return True if any parameter has a proposal distribution.
+	 */
+	bool isWeighted() const noexcept;
+
+	/**
+	 * \brief Sets whether the parameters that no observable reads are
+	 *    sampled.
+	 *
+	 * By default (`prune` is true), a parameter is only sampled if one of the
+	 * observables may read it (see
+	 * molstat::SimulateModel::markObservableParameters); the others keep an
+	 * unspecified value. Without pruning, every parameter is sampled, as is
+	 * needed when the model parameters of the trials are themselves output.
+	 *
+	 * \param[in] prune Whether to skip the unread parameters.
+	 */
+	void setParameterPruning(bool prune);
+
+	// the device simulator translates the model and its observables
+	friend class DeviceSimulator;
+
+	// the cache is laid out by the terms of the observables
+	friend class ContributionCache;
 };
 
 } // namespace MolStat
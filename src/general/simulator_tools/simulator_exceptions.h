@@ -41,6 +41,28 @@ public:
 	}
 };
 
+/**
+ * \brief Exception thrown when a model parameter is referenced by a name
+ *    that the model does not use.
+ */
+class UnknownParameter : public std::logic_error
+{
+public:
+	UnknownParameter() = delete;
+	virtual ~UnknownParameter() = default;
+
+	/**
+	 * \brief Constructor that creates the error message, given the name of
+	 *    the parameter.
+	 *
+	 * \param[in] name The name of the parameter.
+	 */
+	UnknownParameter(const std::string &name)
+		: std::logic_error("The model has no parameter \"" + name + "\".")
+	{
+	}
+};
+
 /**
  * \brief Exception thrown when the desired observable is incompatible with
  *    the model used to simulate data.
@@ -0,0 +1,141 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file simulator_profile.cc
+ * \brief Implements the timing of the phases of a simulation.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "simulator_profile.h"
+#include <stdexcept>
+
+namespace molstat {
+
+double LapSeconds(ProfileClock::time_point &start)
+{
+	const ProfileClock::time_point now{ ProfileClock::now() };
+	const std::chrono::duration<double> elapsed{ now - start };
+	start = now;
+
+	return elapsed.count();
+}
+
+void SimulatorTimings::merge(const SimulatorTimings &other)
+{
+	ntrials += other.ntrials;
+	parameters += other.parameters;
+	combined += other.combined;
+	binning += other.binning;
+
+	if(observables.size() < other.observables.size())
+		observables.resize(other.observables.size(), 0.);
+	for(std::size_t j = 0; j < other.observables.size(); ++j)
+		observables[j] += other.observables[j];
+}
+
+double SimulatorTimings::total() const
+{
+	double ret{ parameters + combined + binning };
+	for(const double obs : observables)
+		ret += obs;
+
+	return ret;
+}
+
+SimulatorProfile::SimulatorProfile(std::size_t nobs, std::size_t interval_)
+	: interval(interval_), counter(0), timings()
+{
+	if(interval == 0)
+		throw std::invalid_argument("The profiling interval must be positive.");
+
+	timings.observables.resize(nobs, 0.);
+}
+
+SimulatorTimings *SimulatorProfile::next()
+{
+	const bool timed{ counter == 0 };
+
+	++counter;
+	if(counter == interval)
+		counter = 0;
+
+	return timed ? &timings : nullptr;
+}
+
+const SimulatorTimings &SimulatorProfile::getTimings() const
+{
+	return timings;
+}
+
+void SimulatorProfile::merge(const SimulatorProfile &other)
+{
+	timings.merge(other.timings);
+}
+
+void SimulatorProfile::report(std::ostream &output, std::size_t ntrials,
+	double wall, std::size_t nthreads,
+	const std::vector<std::string> &obs_names,
+	const std::vector<std::size_t> &rejections) const
+{
+	output << "\nProfile (1 of every " << interval << " batches timed, " <<
+		timings.ntrials << " trials):\n";
+	output << "   Throughput: " << (wall > 0. ? ntrials / wall : 0.) <<
+		" trials/s (" << wall << " s using " << nthreads << " thread" <<
+		(nthreads == 1 ? "" : "s") << ").\n";
+
+	if(timings.ntrials == 0)
+		return;
+
+	// extrapolate from the timed trials to all trials
+	const double scale{ double(ntrials) / timings.ntrials };
+	const double total{ timings.total() };
+	const auto print = [&output, scale, total] (double seconds) -> void
+	{
+		output << seconds * scale << " s (" <<
+			(total > 0. ? 100. * seconds / total : 0.) << "%)";
+	};
+
+	output << "   Generating parameters: ";
+	print(timings.parameters);
+	output << '\n';
+
+	for(std::size_t j = 0; j < timings.observables.size(); ++j)
+	{
+		if(timings.observables[j] == 0. && timings.combined > 0.)
+			continue;
+
+		output << "   Observable " << j;
+		if(j < obs_names.size())
+			output << " (" << obs_names[j] << ')';
+		output << ": ";
+		print(timings.observables[j]);
+		if(j < rejections.size())
+			output << ", not produced in " << rejections[j] << " trials";
+		output << '\n';
+	}
+
+	if(timings.combined > 0.)
+	{
+		output << "   Observables (together, per trial): ";
+		print(timings.combined);
+		output << '\n';
+		for(std::size_t j = 0; j < rejections.size(); ++j)
+		{
+			output << "      Observable " << j;
+			if(j < obs_names.size())
+				output << " (" << obs_names[j] << ')';
+			output << " not produced in " << rejections[j] << " trials\n";
+		}
+	}
+
+	output << "   Binning: ";
+	print(timings.binning);
+	output << '\n';
+}
+
+} // namespace molstat
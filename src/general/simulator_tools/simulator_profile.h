@@ -0,0 +1,155 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file simulator_profile.h
+ * \brief Timing of the phases of a simulation (generating parameters,
+ *    calculating observables, binning).
+ *
+ * Profiling is sampled: only one of every few batches (or traces) is timed,
+ * and the totals are estimated from the timed trials. The untimed batches
+ * have no overhead.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __simulator_profile_h__
+#define __simulator_profile_h__
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace molstat {
+
+/// The clock used for profiling.
+using ProfileClock = std::chrono::steady_clock;
+
+/**
+ * \brief Gets the time (in seconds) elapsed since a time point, and resets
+ *    the time point to now.
+ *
+ * \param[in,out] start The time point.
+ * \return The elapsed time, in seconds.
+ */
+double LapSeconds(ProfileClock::time_point &start);
+
+/// Time spent in each phase for a set of trials.
+struct SimulatorTimings
+{
+	/// The number of trials that were timed.
+	std::size_t ntrials{ 0 };
+
+	/// Time (s) spent generating model parameters.
+	double parameters{ 0. };
+
+	/// Time (s) spent calculating each observable for a batch of trials.
+	std::vector<double> observables;
+
+	/**
+	 * \brief Time (s) spent calculating all observables together, for each
+	 *    trial (fused observables or traces).
+	 */
+	double combined{ 0. };
+
+	/// Time (s) spent adding the data to the histogram.
+	double binning{ 0. };
+
+	/**
+	 * \brief Adds another set of timings to this one.
+	 *
+	 * \param[in] other The other timings.
+	 */
+	void merge(const SimulatorTimings &other);
+
+	/**
+	 * \brief Gets the total time spent in all phases.
+	 *
+	 * \return The total time (s).
+	 */
+	double total() const;
+};
+
+/**
+ * \brief Sampled profile of a simulation.
+ *
+ * Each thread should use its own molstat::SimulatorProfile; they can be
+ * combined afterwards with merge().
+ */
+class SimulatorProfile
+{
+private:
+	/// Time one of every `interval` batches.
+	std::size_t interval;
+
+	/// The number of batches since the last timed batch.
+	std::size_t counter;
+
+	/// The timings for the timed batches.
+	SimulatorTimings timings;
+
+public:
+	SimulatorProfile() = delete;
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \throw std::invalid_argument if `interval_` is 0.
+	 *
+	 * \param[in] nobs The number of observables.
+	 * \param[in] interval_ Time one of every `interval_` batches.
+	 */
+	SimulatorProfile(std::size_t nobs, std::size_t interval_);
+
+	/**
+	 * \brief Determines whether the next batch should be timed.
+	 *
+	 * The first batch is always timed.
+	 *
+	 * \return The timings to update for the next batch, or nullptr if the
+	 *    batch is not timed.
+	 */
+	SimulatorTimings *next();
+
+	/**
+	 * \brief Gets the timings for the batches that have been timed.
+	 *
+	 * \return The timings.
+	 */
+	const SimulatorTimings &getTimings() const;
+
+	/**
+	 * \brief Combines another profile into this one.
+	 *
+	 * \param[in] other The other profile.
+	 */
+	void merge(const SimulatorProfile &other);
+
+	/**
+	 * \brief Prints the profiling report.
+	 *
+	 * Reports the throughput and the (estimated) time spent in each phase
+	 * and for each observable. The time for each phase is extrapolated from
+	 * the timed trials to all trials.
+	 *
+	 * \param[out] output The output stream.
+	 * \param[in] ntrials The total number of trials.
+	 * \param[in] wall The wall time of the simulation (s).
+	 * \param[in] nthreads The number of threads.
+	 * \param[in] obs_names The name of each observable.
+	 * \param[in] rejections The number of trials that did not produce each
+	 *    observable.
+	 */
+	void report(std::ostream &output, std::size_t ntrials, double wall,
+		std::size_t nthreads, const std::vector<std::string> &obs_names,
+		const std::vector<std::size_t> &rejections) const;
+};
+
+} // namespace molstat
+
+#endif
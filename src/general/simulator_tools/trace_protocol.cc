@@ -0,0 +1,129 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file trace_protocol.cc
+ * \brief Implements the molstat::TraceProtocol class.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include "trace_protocol.h"
+#include <cmath>
+#include <stdexcept>
+#include <general/string_tools.h>
+
+namespace molstat {
+
+const double TraceProtocol::coulomb_constant = 1.439964;
+
+TraceProtocol::TraceProtocol(std::size_t npoints_, double zmin_,
+	double zmax_)
+	: npoints(npoints_), zmin(zmin_), zmax(zmax_), length(nullptr),
+	  shifts(), ruptured()
+{
+	if(npoints == 0)
+		throw std::invalid_argument("A trace must have at least one point.");
+
+	if(!(zmax >= zmin))
+		throw std::invalid_argument("The displacements must be increasing.");
+
+	if(npoints == 1 && zmax != zmin)
+		throw std::invalid_argument("A trace with one point must have a " \
+			"single displacement.");
+}
+
+void TraceProtocol::setLength(
+	std::shared_ptr<const RandomDistribution> length_)
+{
+	length = length_;
+}
+
+void TraceProtocol::addShift(const std::string &name,
+	DisplacementFunction shift)
+{
+	shifts.emplace_back(to_lower(name), shift);
+}
+
+void TraceProtocol::setRuptured(const std::string &name, double value)
+{
+	const std::string lname{ to_lower(name) };
+
+	// replace an existing value, if there is one
+	for(auto &rupture : ruptured)
+	{
+		if(rupture.first == lname)
+		{
+			rupture.second = value;
+			return;
+		}
+	}
+
+	ruptured.emplace_back(lname, value);
+}
+
+std::size_t TraceProtocol::numPoints() const noexcept
+{
+	return npoints;
+}
+
+double TraceProtocol::displacement(std::size_t j) const noexcept
+{
+	if(npoints == 1)
+		return zmin;
+
+	return zmin + (zmax - zmin) * j / (npoints - 1);
+}
+
+std::pair<double, double> TraceProtocol::getDisplacementRange() const
+	noexcept
+{
+	return { zmin, zmax };
+}
+
+std::shared_ptr<const RandomDistribution> TraceProtocol::getLength() const
+{
+	return length;
+}
+
+const std::vector<std::pair<std::string,
+                            TraceProtocol::DisplacementFunction>>
+	&TraceProtocol::getShifts() const noexcept
+{
+	return shifts;
+}
+
+const std::vector<std::pair<std::string, double>>
+	&TraceProtocol::getRuptured() const noexcept
+{
+	return ruptured;
+}
+
+TraceProtocol::DisplacementFunction TraceProtocol::LinearShift(double a,
+	double b)
+{
+	return [a, b] (double z) -> double
+	{
+		return a + b*z;
+	};
+}
+
+TraceProtocol::DisplacementFunction TraceProtocol::ImageChargeShift(
+	double d0, double zip)
+{
+	if(0.5*d0 == zip)
+		throw std::invalid_argument("The image planes coincide at zero " \
+			"displacement.");
+
+	const double u0{ coulomb_constant / (2. * std::abs(0.5*d0 - zip)) };
+
+	return [d0, zip, u0] (double z) -> double
+	{
+		return coulomb_constant / (2. * std::abs(0.5*(d0 + z) - zip)) - u0;
+	};
+}
+
+} // namespace molstat
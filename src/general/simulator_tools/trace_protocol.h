@@ -0,0 +1,188 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file trace_protocol.h
+ * \brief Describes how model parameters change along a simulated trace
+ *    (e.g., a conductance-displacement trace from a break junction).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __trace_protocol_h__
+#define __trace_protocol_h__
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace molstat {
+
+class RandomDistribution;
+
+/**
+ * \brief Protocol for simulating traces, where each trace evaluates the
+ *    observables at a sequence of displacements.
+ *
+ * One set of model parameters is generated for each trace. At displacement
+ * \f$z\f$, each parameter with a shift is changed by \f$f(z)\f$. Each trace
+ * also has a (random) length; at displacements beyond it, the junction
+ * is ruptured and the specified parameters are replaced with fixed values
+ * (for instance, setting the number of molecules to 0).
+ *
+ * Parameters are identified by their (case-insensitive) names; a shift or
+ * replacement applies to every model parameter with that name.
+ */
+class TraceProtocol
+{
+public:
+	/// A function of the displacement.
+	using DisplacementFunction = std::function<double(double)>;
+
+	/// Coulomb's constant (eV nm / e^2) for TraceProtocol::ImageChargeShift.
+	static const double coulomb_constant;
+
+private:
+	/// The number of displacement points in each trace.
+	std::size_t npoints;
+
+	/// The first displacement.
+	double zmin;
+
+	/// The last displacement.
+	double zmax;
+
+	/// Distribution of trace lengths; nullptr if traces never rupture.
+	std::shared_ptr<const RandomDistribution> length;
+
+	/// The displacement-dependent shifts (lowercase parameter name, shift).
+	std::vector<std::pair<std::string, DisplacementFunction>> shifts;
+
+	/// The replacements after rupture (lowercase parameter name, value).
+	std::vector<std::pair<std::string, double>> ruptured;
+
+public:
+	TraceProtocol() = delete;
+
+	/**
+	 * \brief Constructor specifying the displacements.
+	 *
+	 * The displacements are evenly spaced from `zmin_` to `zmax_`,
+	 * inclusive.
+	 *
+	 * \throw std::invalid_argument if `npoints_` is 0, if `zmax_` is less
+	 *    than `zmin_`, or if `zmin_` and `zmax_` differ with only one point.
+	 *
+	 * \param[in] npoints_ The number of displacements in each trace.
+	 * \param[in] zmin_ The first displacement.
+	 * \param[in] zmax_ The last displacement.
+	 */
+	TraceProtocol(std::size_t npoints_, double zmin_, double zmax_);
+
+	/**
+	 * \brief Sets the distribution of trace lengths.
+	 *
+	 * \param[in] length_ The distribution.
+	 */
+	void setLength(std::shared_ptr<const RandomDistribution> length_);
+
+	/**
+	 * \brief Adds a displacement-dependent shift to a parameter.
+	 *
+	 * Multiple shifts for the same parameter are added together.
+	 *
+	 * \param[in] name The name of the parameter.
+	 * \param[in] shift The shift, as a function of displacement.
+	 */
+	void addShift(const std::string &name, DisplacementFunction shift);
+
+	/**
+	 * \brief Sets the value of a parameter after the trace ruptures.
+	 *
+	 * \param[in] name The name of the parameter.
+	 * \param[in] value The value.
+	 */
+	void setRuptured(const std::string &name, double value);
+
+	/**
+	 * \brief Gets the number of displacements in each trace.
+	 *
+	 * \return The number of displacements.
+	 */
+	std::size_t numPoints() const noexcept;
+
+	/**
+	 * \brief Gets a displacement.
+	 *
+	 * \param[in] j The index of the displacement.
+	 * \return The displacement.
+	 */
+	double displacement(std::size_t j) const noexcept;
+
+	/**
+	 * \brief Gets the first and last displacements.
+	 *
+	 * \return The first and last displacements.
+	 */
+	std::pair<double, double> getDisplacementRange() const noexcept;
+
+	/**
+	 * \brief Gets the distribution of trace lengths.
+	 *
+	 * \return The distribution; nullptr if traces do not rupture.
+	 */
+	std::shared_ptr<const RandomDistribution> getLength() const;
+
+	/**
+	 * \brief Gets the shifts.
+	 *
+	 * \return The (parameter name, shift) pairs.
+	 */
+	const std::vector<std::pair<std::string, DisplacementFunction>>
+		&getShifts() const noexcept;
+
+	/**
+	 * \brief Gets the replacements after rupture.
+	 *
+	 * \return The (parameter name, value) pairs.
+	 */
+	const std::vector<std::pair<std::string, double>> &getRuptured() const
+		noexcept;
+
+	/**
+	 * \brief Linear shift, \f$a + bz\f$.
+	 *
+	 * \param[in] a The intercept.
+	 * \param[in] b The slope.
+	 * \return The shift.
+	 */
+	static DisplacementFunction LinearShift(double a, double b);
+
+	/**
+	 * \brief Image-charge shift of a level between two planar electrodes.
+	 *
+	 * The electrode separation at displacement \f$z\f$ is \f$d_0 + z\f$.
+	 * The image-charge energy for a level midway between the electrodes is
+	 * \f[ U(d) = \frac{k_e}{2|d/2 - z_\mathrm{ip}|}, \f]
+	 * where \f$z_\mathrm{ip}\f$ is the distance from each electrode to its
+	 * image plane. The shift is \f$U(d_0+z) - U(d_0)\f$, so that it
+	 * vanishes at \f$z = 0\f$. Distances are in nm and energies in eV.
+	 *
+	 * \throw std::invalid_argument if \f$d_0 = 2z_\mathrm{ip}\f$.
+	 *
+	 * \param[in] d0 The electrode separation at zero displacement.
+	 * \param[in] zip The distance from each electrode to its image plane.
+	 * \return The shift.
+	 */
+	static DisplacementFunction ImageChargeShift(double d0, double zip);
+};
+
+} // namespace molstat
+
+#endif
@@ -12,6 +12,7 @@
  */
 
 #include "string_tools.h"
+#include <cerrno>
 #include <cstdlib>
 #include <stdexcept>
 #include <algorithm>
@@ -23,13 +24,13 @@ namespace molstat {
 /**
  * \brief Gets the next token in the string.
  *
- * \param[in,out] next The next character to examine (via iterator).
+ * \param[in,out] next The next character to examine.
  * \param[in] end The end of the string.
  * \param[out] tok The token, if a valid token exists.
  * \return True if a token is found, false otherwise.
  */
-static bool next_token(string::const_iterator &next,
-	string::const_iterator end, string &tok)
+static bool next_token(const char *&next, const char *const end,
+	StringView &tok)
 {
 
 	// skip past any leading whitespace
@@ -41,7 +42,7 @@ static bool next_token(string::const_iterator &next,
 	if(*next == '"')
 	{
 		// this token is delimited by quotes
-		string::const_iterator quote = next;
+		const char *quote = next;
 		do
 		{
 			++quote; // move past the current quote mark
@@ -50,25 +51,25 @@ static bool next_token(string::const_iterator &next,
 				return false;
 		} while(*(quote-1) == '\\'); // allow for escaped quotes inside
 
-		tok.assign(next+1, quote); // this omits the quotes
+		tok = StringView(next+1, quote - (next+1)); // this omits the quotes
 		next = quote;
 		++next; // move past the terminal quote
 	}
 	else if(*next == '<')
 	{
 		// this token is delimited by angle brackets
-		string::const_iterator bracket = find(next, end, '>');
+		const char *bracket = find(next, end, '>');
 		if(bracket == end) // unterminated token
 			return false;
-		tok.assign(next, bracket+1);
+		tok = StringView(next, bracket+1 - next);
 		next = bracket+1; // move past the closing bracket
 	}
 	else
 	{
-		string::const_iterator first = next;
+		const char *first = next;
 		while(next != end && !isspace(*next))
 			++next;
-		tok.assign(first, next);
+		tok = StringView(first, next - first);
 	}
 
 	return true;
@@ -77,15 +78,37 @@ static bool next_token(string::const_iterator &next,
 TokenContainer tokenize(const std::string &str)
 {
 	TokenContainer ret;
-	string::const_iterator next = str.begin();
-	string token;
+	const char *next = str.data();
+	StringView token;
 
-	while(next_token(next, str.end(), token))
-		ret.emplace(token);
+	while(next_token(next, str.data() + str.size(), token))
+		ret.emplace(token.begin(), token.end());
 
 	return ret;
 }
 
+void tokenize(const std::string &str, TokenViews &tokens)
+{
+	tokens.clear();
+	const char *next = str.data();
+	StringView token;
+
+	while(next_token(next, str.data() + str.size(), token))
+		tokens.push_back(token);
+}
+
+bool lower_equals(StringView str, StringView lower) noexcept
+{
+	if(str.size() != lower.size())
+		return false;
+
+	for(size_t j = 0; j < str.size(); ++j)
+		if(tolower(static_cast<unsigned char>(str[j])) != lower[j])
+			return false;
+
+	return true;
+}
+
 std::string to_lower(const std::string &str)
 {
 	std::string ret{ str };
@@ -119,53 +142,133 @@ std::string find_replace(const std::string &str, const std::string &find,
 	return ret;
 }
 
-template<>
-double cast_string(const std::string &str)
+/// \cond
+namespace {
+
+/**
+ * \brief A null-terminated copy of a string, which the C library's
+ *    conversion functions need.
+ *
+ * Short strings (all reasonable numbers) are copied to the stack.
+ */
+class TerminatedCopy
 {
-	double ret;
-	size_t next;
+private:
+	/// Storage for short strings.
+	char buffer[64];
+
+	/// Storage for long strings.
+	string heap;
+
+	/// The copy.
+	const char *copy;
+
+public:
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] str The string.
+	 */
+	TerminatedCopy(StringView str)
+	{
+		if(str.size() < sizeof(buffer))
+		{
+			copy_n(str.data(), str.size(), buffer);
+			buffer[str.size()] = '\0';
+			copy = buffer;
+		}
+		else
+		{
+			heap = str.str();
+			copy = heap.c_str();
+		}
+	}
+
+	/**
+	 * \brief Gets the copy.
+	 *
+	 * \return The null-terminated copy.
+	 */
+	const char *c_str() const noexcept
+	{
+		return copy;
+	}
+};
+
+} // anonymous namespace
+/// \endcond
+
+bool parse_number(StringView str, double &val) noexcept
+{
+	if(str.empty())
+		return false;
 
 	try
 	{
-		// do the conversion and get the index of the first character not used.
-		ret = stod(str, &next);
+		const TerminatedCopy copy{ str };
+		char *next;
 
-		// make sure the entire string was used.
-		if(next != str.size())
-			throw bad_cast();
+		errno = 0;
+		const double ret{ strtod(copy.c_str(), &next) };
+
+		// make sure the entire string was used and the number is representable
+		if(next != copy.c_str() + str.size() || errno == ERANGE)
+			return false;
+
+		val = ret;
+		return true;
 	}
-	catch(const invalid_argument &e)
+	catch(const bad_alloc &e)
 	{
-		throw bad_cast();
+		return false;
 	}
-
-	return ret;
 }
 
-template<>
-std::size_t cast_string(const std::string &str)
+bool parse_number(StringView str, std::size_t &val) noexcept
 {
-	size_t ret, next;
+	if(str.empty())
+		return false;
 
 	try
 	{
-		// do the conversion and get the index of the first character not used.
-		int cast = stoi(str, &next);
+		const TerminatedCopy copy{ str };
+		char *next;
 
-		// make sure the entire string was used
-		if(next != str.size())
-			throw bad_cast();
+		errno = 0;
+		const long long ret{ strtoll(copy.c_str(), &next, 10) };
 
-		// make sure the value is non-negative
-		if(cast < 0)
-			throw bad_cast();
+		// make sure the entire string was used and the number is representable
+		// (and non-negative)
+		if(next != copy.c_str() + str.size() || errno == ERANGE || ret < 0)
+			return false;
 
-		ret = cast;
+		val = ret;
+		return true;
 	}
-	catch(const invalid_argument &e)
+	catch(const bad_alloc &e)
 	{
-		throw bad_cast();
+		return false;
 	}
+}
+
+template<>
+double cast_string(const std::string &str)
+{
+	double ret;
+
+	if(!parse_number(str, ret))
+		throw bad_cast();
+
+	return ret;
+}
+
+template<>
+std::size_t cast_string(const std::string &str)
+{
+	size_t ret;
+
+	if(!parse_number(str, ret))
+		throw bad_cast();
 
 	return ret;
 }
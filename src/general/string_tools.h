@@ -14,9 +14,12 @@
 #ifndef __string_tools_h__
 #define __string_tools_h__
 
+#include <cstddef>
+#include <cstring>
 #include <string>
 #include <queue>
 #include <typeinfo>
+#include <vector>
 
 /**
  * \namespace molstat
@@ -27,6 +30,161 @@ namespace molstat {
 /// Alias for a container of tokens.
 using TokenContainer = std::queue<std::string>;
 
+/**
+ * \brief A read-only view of a range of characters (e.g., a token in a line
+ *    of input), without a copy.
+ *
+ * This is the part of C++17's `std::string_view` that MolStat needs. The
+ * characters must outlive the view.
+ */
+class StringView
+{
+private:
+	/// The first character.
+	const char *first;
+
+	/// The number of characters.
+	std::size_t length;
+
+public:
+	/**
+	 * \brief Constructor for an empty view.
+	 */
+	constexpr StringView() noexcept : first(nullptr), length(0)
+	{
+	}
+
+	/**
+	 * \brief Constructor from a range of characters.
+	 *
+	 * \param[in] first_ The first character.
+	 * \param[in] length_ The number of characters.
+	 */
+	constexpr StringView(const char *first_, std::size_t length_) noexcept
+		: first(first_), length(length_)
+	{
+	}
+
+	/**
+	 * \brief Constructor for a view of a string.
+	 *
+	 * \param[in] str The string.
+	 */
+	StringView(const std::string &str) noexcept
+		: first(str.data()), length(str.size())
+	{
+	}
+
+	/**
+	 * \brief Constructor for a view of a C string.
+	 *
+	 * \param[in] str The (null-terminated) string.
+	 */
+	StringView(const char *str) noexcept
+		: first(str), length(std::strlen(str))
+	{
+	}
+
+	/**
+	 * \brief Gets the characters.
+	 *
+	 * \return Pointer to the first character (not null-terminated).
+	 */
+	constexpr const char *data() const noexcept
+	{
+		return first;
+	}
+
+	/**
+	 * \brief Gets the number of characters.
+	 *
+	 * \return The number of characters.
+	 */
+	constexpr std::size_t size() const noexcept
+	{
+		return length;
+	}
+
+	/**
+	 * \brief Checks if the view is empty.
+	 *
+	 * \return True if there are no characters, false otherwise.
+	 */
+	constexpr bool empty() const noexcept
+	{
+		return length == 0;
+	}
+
+	/**
+	 * \brief Gets a character.
+	 *
+	 * \param[in] j The index of the character.
+	 * \return The character.
+	 */
+	constexpr char operator[](std::size_t j) const noexcept
+	{
+		return first[j];
+	}
+
+	/**
+	 * \brief Iterator to the first character.
+	 *
+	 * \return The iterator.
+	 */
+	constexpr const char *begin() const noexcept
+	{
+		return first;
+	}
+
+	/**
+	 * \brief Iterator past the last character.
+	 *
+	 * \return The iterator.
+	 */
+	constexpr const char *end() const noexcept
+	{
+		return first + length;
+	}
+
+	/**
+	 * \brief Copies the characters into a string.
+	 *
+	 * \return The string.
+	 */
+	std::string str() const
+	{
+		return std::string(first, length);
+	}
+};
+
+/**
+ * \brief Checks if two views have the same characters.
+ *
+ * \param[in] a The first view.
+ * \param[in] b The second view.
+ * \return True if the characters are the same, false otherwise.
+ */
+inline bool operator==(StringView a, StringView b) noexcept
+{
+	return a.size() == b.size() &&
+		(a.size() == 0 || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+/**
+ * \brief Checks if two views have different characters.
+ *
+ * \param[in] a The first view.
+ * \param[in] b The second view.
+ * \return False if the characters are the same, true otherwise.
+ */
+inline bool operator!=(StringView a, StringView b) noexcept
+{
+	return !(a == b);
+}
+
+/// Alias for a container of views of tokens.
+using TokenViews = std::vector<StringView>;
+
 /**
  * \brief Tokenizes a string.
  *
@@ -38,6 +196,33 @@ using TokenContainer = std::queue<std::string>;
  */
 TokenContainer tokenize(const std::string &str);
 
+/**
+ * \brief Tokenizes a string into views of its characters.
+ *
+ * The tokens are those of tokenize(const std::string&), but nothing is
+ * copied: the views refer to the string, which must outlive them. Reusing
+ * the container (e.g., for every line of a file) avoids allocations.
+ *
+ * \param[in] str The string to be tokenized.
+ * \param[out] tokens The tokens (the container is cleared first).
+ */
+void tokenize(const std::string &str, TokenViews &tokens);
+
+/// Views of a temporary string would dangle.
+void tokenize(std::string &&str, TokenViews &tokens) = delete;
+
+/**
+ * \brief Checks if a string, in lower case, is the specified (lower case)
+ *    string.
+ *
+ * This is `to_lower(str) == lower`, without a copy.
+ *
+ * \param[in] str The string.
+ * \param[in] lower The lower case string.
+ * \return True if the strings match, false otherwise.
+ */
+bool lower_equals(StringView str, StringView lower) noexcept;
+
 /**
  * \brief Returns a copy of the string, in lower case.
  *
@@ -57,6 +242,30 @@ std::string to_lower(const std::string &str);
 std::string find_replace(const std::string &str, const std::string &find,
 	const std::string &replace);
 
+/**
+ * \brief Parses a number (a double).
+ *
+ * The entire string must be used in the conversion. The number is read with
+ * `std::strtod`, without allocations or exceptions.
+ *
+ * \param[in] str The string.
+ * \param[out] val The number, if the string is one.
+ * \return True if the string is a (representable) number, false otherwise.
+ */
+bool parse_number(StringView str, double &val) noexcept;
+
+/**
+ * \brief Parses a non-negative integer (a size_t).
+ *
+ * The entire string must be used in the conversion.
+ *
+ * \param[in] str The string.
+ * \param[out] val The number, if the string is one.
+ * \return True if the string is a (representable) non-negative integer,
+ *    false otherwise.
+ */
+bool parse_number(StringView str, std::size_t &val) noexcept;
+
 /**
  * \brief Template for casting a string to the desired type.
  *
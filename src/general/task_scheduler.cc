@@ -0,0 +1,416 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file task_scheduler.cc
+ * \brief Implements the pool of threads for parallel loops.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <config.h>
+#include "task_scheduler.h"
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#if HAVE_SCHED_SETAFFINITY
+#include <sched.h>
+#endif
+
+namespace molstat {
+
+/// The scheduler whose pool this thread is in (nullptr if none).
+static thread_local const TaskScheduler *current_pool{ nullptr };
+
+/// The worker this thread is in its scheduler's pool.
+static thread_local std::size_t current_worker{ 0 };
+
+struct TaskScheduler::Job
+{
+	/// The tasks of one worker that have not been taken.
+	struct Range
+	{
+		/// Protects the range.
+		std::mutex lock;
+
+		/// The next task to take.
+		std::size_t next{ 0 };
+
+		/// The end of the range.
+		std::size_t end{ 0 };
+	};
+
+	/// The task.
+	const std::function<void(std::size_t, std::size_t)> &task;
+
+	/// The number of tasks taken at once.
+	const std::size_t chunk;
+
+	/// The range of each worker.
+	std::unique_ptr<Range[]> ranges;
+
+	/// The number of tasks not yet taken.
+	std::atomic<std::size_t> untaken;
+
+	/// True once a task has thrown; the remaining tasks are skipped.
+	std::atomic<bool> failed;
+
+	/// The first exception thrown by each worker.
+	std::vector<std::exception_ptr> errors;
+
+	/// The number of workers from the pool running tasks of the loop
+	/// (protected by the scheduler's lock).
+	std::size_t participants;
+
+	/**
+	 * \brief Divides the tasks among the workers.
+	 *
+	 * \param[in] task_ The task.
+	 * \param[in] chunk_ The number of tasks taken at once.
+	 * \param[in] nworkers The number of workers.
+	 * \param[in] ntasks The number of tasks.
+	 */
+	Job(const std::function<void(std::size_t, std::size_t)> &task_,
+		std::size_t chunk_, std::size_t nworkers, std::size_t ntasks)
+		: task(task_), chunk(std::max<std::size_t>(1, chunk_)),
+		  ranges(new Range[nworkers]), untaken(ntasks), failed(false),
+		  errors(nworkers, nullptr), participants(0)
+	{
+		for(std::size_t w = 0; w < nworkers; ++w)
+		{
+			ranges[w].next = (ntasks * w) / nworkers;
+			ranges[w].end = (ntasks * (w + 1)) / nworkers;
+		}
+	}
+};
+
+/**
+ * \brief Reads a list of numbers and ranges (e.g., "0-3,8,10-11").
+ *
+ * \param[in] list The list.
+ * \return The numbers.
+ */
+static std::vector<int> parse_cpu_list(const std::string &list)
+{
+	std::vector<int> ret;
+	std::istringstream in{ list };
+	int first, last;
+	while(in >> first)
+	{
+		last = first;
+		if(in.peek() == '-')
+		{
+			in.get();
+			if(!(in >> last))
+				break;
+		}
+		for(int k = first; k <= last; ++k)
+			ret.push_back(k);
+		if(in.peek() == ',')
+			in.get();
+	}
+	return ret;
+}
+
+/**
+ * \brief Reads the CPUs allowed for this process on each NUMA node.
+ *
+ * \return The allowed CPUs of each node (with any); one list of every
+ *    allowed CPU without information about the nodes, or no lists where CPU
+ *    affinity is not supported.
+ */
+static std::vector<std::vector<int>> read_numa_nodes()
+{
+	std::vector<std::vector<int>> nodes;
+#if HAVE_SCHED_SETAFFINITY
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+		return nodes;
+
+	std::ifstream online{ "/sys/devices/system/node/online" };
+	std::string list;
+	if(std::getline(online, list))
+	{
+		for(const int node : parse_cpu_list(list))
+		{
+			std::ifstream cpus{ "/sys/devices/system/node/node" +
+				std::to_string(node) + "/cpulist" };
+			std::vector<int> node_cpus;
+			if(std::getline(cpus, list))
+				for(const int cpu : parse_cpu_list(list))
+					if(cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+						node_cpus.push_back(cpu);
+			if(!node_cpus.empty())
+				nodes.push_back(node_cpus);
+		}
+	}
+	if(nodes.empty())
+	{
+		nodes.emplace_back();
+		for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+			if(CPU_ISSET(cpu, &allowed))
+				nodes.back().push_back(cpu);
+	}
+#endif
+	return nodes;
+}
+
+/**
+ * \brief Gets the CPUs allowed for this process on each NUMA node.
+ *
+ * The nodes are read once, before any thread is pinned (pinning narrows the
+ * CPUs allowed for the pinned thread).
+ *
+ * \return The allowed CPUs of each node.
+ */
+static const std::vector<std::vector<int>> &numa_nodes()
+{
+	static const std::vector<std::vector<int>> nodes{ read_numa_nodes() };
+	return nodes;
+}
+
+/// The NUMA node of the CPU this thread is pinned to (0 if not pinned).
+static thread_local std::size_t current_node{ 0 };
+
+void PinThread(int cpu)
+{
+#if HAVE_SCHED_SETAFFINITY
+	if(cpu < 0 || cpu >= CPU_SETSIZE)
+		return;
+
+	const std::vector<std::vector<int>> &nodes = numa_nodes();
+	for(std::size_t node = 0; node < nodes.size(); ++node)
+		if(std::find(nodes[node].begin(), nodes[node].end(), cpu) !=
+			nodes[node].end())
+		{
+			current_node = node;
+			break;
+		}
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	sched_setaffinity(0, sizeof(set), &set);
+#else
+	static_cast<void>(cpu);
+#endif
+}
+
+std::vector<int> NumaCpuOrder()
+{
+	const std::vector<std::vector<int>> &nodes = numa_nodes();
+
+	// alternate between the nodes
+	std::vector<int> ret;
+	bool any{ true };
+	for(std::size_t k = 0; any; ++k)
+	{
+		any = false;
+		for(const std::vector<int> &node : nodes)
+			if(k < node.size())
+			{
+				ret.push_back(node[k]);
+				any = true;
+			}
+	}
+	return ret;
+}
+
+std::size_t NumaNodeCount()
+{
+	return std::max<std::size_t>(1, numa_nodes().size());
+}
+
+std::size_t CurrentNumaNode() noexcept
+{
+	return current_node;
+}
+
+TaskScheduler::TaskScheduler(std::size_t nworkers_, bool pin)
+	: nworkers(std::max<std::size_t>(1, nworkers_)), threads(), lock(),
+	  wake(), left(), jobs(), stopping(false), nsteals(0)
+{
+	const std::vector<int> cpus{ pin ? NumaCpuOrder() : std::vector<int>() };
+	const auto cpu_of = [&cpus] (std::size_t worker) -> int
+	{
+		return cpus.empty() ? -1 : cpus[worker % cpus.size()];
+	};
+
+	PinThread(cpu_of(0));
+	for(std::size_t w = 1; w < nworkers; ++w)
+		threads.emplace_back(&TaskScheduler::serve, this, w, cpu_of(w));
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	{
+		const std::lock_guard<std::mutex> guard{ lock };
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for(std::thread &thread : threads)
+		thread.join();
+}
+
+std::size_t TaskScheduler::numWorkers() const noexcept
+{
+	return nworkers;
+}
+
+std::size_t TaskScheduler::numSteals() const noexcept
+{
+	return nsteals;
+}
+
+void TaskScheduler::serve(std::size_t worker, int cpu)
+{
+	PinThread(cpu);
+	current_pool = this;
+	current_worker = worker;
+
+	std::unique_lock<std::mutex> guard{ lock };
+	while(true)
+	{
+		// the innermost loop with tasks left
+		Job *job{ nullptr };
+		wake.wait(guard, [this, &job] () -> bool
+			{
+				for(auto iter = jobs.rbegin(); iter != jobs.rend(); ++iter)
+					if((*iter)->untaken > 0)
+					{
+						job = *iter;
+						return true;
+					}
+				return stopping;
+			});
+		if(job == nullptr)
+			return;
+
+		++job->participants;
+		guard.unlock();
+		work(*job, worker);
+		guard.lock();
+		--job->participants;
+		left.notify_all();
+	}
+}
+
+void TaskScheduler::work(Job &job, std::size_t worker)
+{
+	Job::Range &own = job.ranges[worker];
+
+	while(true)
+	{
+		// take a chunk from this worker's range
+		std::size_t first{ 0 }, last{ 0 };
+		{
+			const std::lock_guard<std::mutex> guard{ own.lock };
+			first = own.next;
+			last = std::min(own.end, own.next + job.chunk);
+			own.next = last;
+		}
+
+		if(first == last)
+		{
+			// steal the back half of the largest range; done if none is left
+			std::size_t victim{ worker }, largest{ 0 };
+			for(std::size_t w = 0; w < nworkers; ++w)
+			{
+				const std::lock_guard<std::mutex> guard{ job.ranges[w].lock };
+				if(job.ranges[w].end - job.ranges[w].next > largest)
+				{
+					victim = w;
+					largest = job.ranges[w].end - job.ranges[w].next;
+				}
+			}
+			if(largest == 0)
+				return;
+
+			std::size_t stolen_first, stolen_last;
+			{
+				Job::Range &range = job.ranges[victim];
+				const std::lock_guard<std::mutex> guard{ range.lock };
+				stolen_last = range.end;
+				stolen_first = range.end - (range.end - range.next + 1) / 2;
+				range.end = stolen_first;
+			}
+			if(stolen_first == stolen_last)
+				continue; // the victim took its tasks first
+
+			++nsteals;
+			const std::lock_guard<std::mutex> guard{ own.lock };
+			own.next = stolen_first;
+			own.end = stolen_last;
+			continue;
+		}
+
+		job.untaken -= last - first;
+		for(std::size_t j = first; j < last; ++j)
+		{
+			if(job.failed)
+				break;
+
+			try
+			{
+				job.task(j, worker);
+			}
+			catch(...)
+			{
+				if(job.errors[worker] == nullptr)
+					job.errors[worker] = std::current_exception();
+				job.failed = true;
+			}
+		}
+	}
+}
+
+void TaskScheduler::run(std::size_t ntasks,
+	const std::function<void(std::size_t, std::size_t)> &task,
+	std::size_t chunk)
+{
+	const std::size_t worker{ current_pool == this ? current_worker : 0 };
+
+	if(ntasks == 0)
+		return;
+	if(nworkers == 1 || ntasks == 1)
+	{
+		for(std::size_t j = 0; j < ntasks; ++j)
+			task(j, worker);
+		return;
+	}
+
+	// share the tasks with the pool and take part
+	Job job{ task, chunk, nworkers, ntasks };
+	{
+		const std::lock_guard<std::mutex> guard{ lock };
+		jobs.push_back(&job);
+	}
+	wake.notify_all();
+
+	work(job, worker);
+
+	// every task has been taken; wait for the pool to finish them
+	{
+		std::unique_lock<std::mutex> guard{ lock };
+		jobs.remove(&job);
+		left.wait(guard, [&job] () -> bool
+			{
+				return job.participants == 0;
+			});
+	}
+
+	for(const std::exception_ptr &error : job.errors)
+		if(error != nullptr)
+			std::rethrow_exception(error);
+}
+
+} // namespace molstat
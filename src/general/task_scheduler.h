@@ -0,0 +1,197 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file task_scheduler.h
+ * \brief A pool of threads that runs parallel loops with work stealing.
+ *
+ * The tasks of a loop (trial blocks, initial guesses, bootstrap resamples,
+ * files of a batch, ...) can have very different costs. Each worker starts
+ * with a contiguous range of the tasks and takes chunks from its front; a
+ * worker that runs out steals the back half of the largest remaining range.
+ * The threads are kept for the life of the scheduler, so that the simulator
+ * and fitter use one pool for all of their parallel loops.
+ *
+ * A loop may be started from within a task of another loop. Its tasks are
+ * shared with any idle workers, so that, e.g., the initial guesses of a file
+ * in a batch use the threads not needed for the other files.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#ifndef __task_scheduler_h__
+#define __task_scheduler_h__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace molstat {
+
+/**
+ * \brief A pool of threads that runs parallel loops with work stealing.
+ *
+ * The calling thread takes part in its loops as worker 0 (or, from within a
+ * task, as the worker running the task); the pool has the other workers. The
+ * worker running a task is passed to the task, so that per-worker workspace
+ * can be indexed by it. Each worker runs at most one task of a loop at a
+ * time.
+ *
+ * Loops must be started from the thread that created the scheduler or from
+ * within a task.
+ */
+class TaskScheduler
+{
+private:
+	/// The tasks of one loop.
+	struct Job;
+
+	/// The number of workers (including the calling thread).
+	const std::size_t nworkers;
+
+	/// The threads of the pool (workers 1, 2, ...).
+	std::vector<std::thread> threads;
+
+	/// Protects the list of jobs and the counts of their participants.
+	std::mutex lock;
+
+	/// Signals the pool that there are tasks (or that it is stopping).
+	std::condition_variable wake;
+
+	/// Signals the owner of a job that a worker left the job.
+	std::condition_variable left;
+
+	/// The loops with tasks to share, innermost last.
+	std::list<Job *> jobs;
+
+	/// True when the pool should exit.
+	bool stopping;
+
+	/// The number of ranges stolen.
+	std::atomic<std::size_t> nsteals;
+
+	/**
+	 * \brief Runs the tasks of the innermost loops as they appear.
+	 *
+	 * \param[in] worker The worker.
+	 * \param[in] cpu The CPU for the worker, or -1 to not pin it.
+	 */
+	void serve(std::size_t worker, int cpu);
+
+	/**
+	 * \brief Runs tasks of a loop (from its own range, then stolen) until
+	 *    every task has been taken.
+	 *
+	 * \param[in,out] job The loop.
+	 * \param[in] worker The worker.
+	 */
+	void work(Job &job, std::size_t worker);
+
+public:
+	TaskScheduler() = delete;
+	TaskScheduler(const TaskScheduler &) = delete;
+	TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+	/**
+	 * \brief Starts the pool.
+	 *
+	 * When pinned, the workers (including the calling thread) are bound to
+	 * the CPUs allowed for the process, alternating between the NUMA nodes,
+	 * so that the threads share the nodes' memory bandwidth evenly. Pinning
+	 * is skipped where it is not supported.
+	 *
+	 * \param[in] nworkers_ The number of workers (including the calling
+	 *    thread); 0 is treated as 1.
+	 * \param[in] pin Whether or not to pin the workers to CPUs.
+	 */
+	explicit TaskScheduler(std::size_t nworkers_, bool pin = false);
+
+	/**
+	 * \brief Stops the pool.
+	 */
+	~TaskScheduler();
+
+	/**
+	 * \brief Gets the number of workers.
+	 *
+	 * \return The number of workers (including the calling thread).
+	 */
+	std::size_t numWorkers() const noexcept;
+
+	/**
+	 * \brief Gets the number of ranges stolen so far.
+	 *
+	 * \return The number of steals.
+	 */
+	std::size_t numSteals() const noexcept;
+
+	/**
+	 * \brief Runs a parallel loop, returning once every task has finished.
+	 *
+	 * If a task throws, the tasks not yet started are skipped and the
+	 * exception (of the lowest-numbered worker that threw) is rethrown.
+	 *
+	 * \param[in] ntasks The number of tasks.
+	 * \param[in] task The task; its arguments are the task's number (from 0
+	 *    to ntasks-1) and the worker running it.
+	 * \param[in] chunk The number of tasks a worker takes at once from its
+	 *    range; 0 is treated as 1.
+	 */
+	void run(std::size_t ntasks,
+		const std::function<void(std::size_t, std::size_t)> &task,
+		std::size_t chunk = 1);
+};
+
+/**
+ * \brief Gets the CPUs allowed for this process, alternating between the
+ *    NUMA nodes.
+ *
+ * The first CPU of each node is listed, then the second of each node, etc.
+ * Without information about the nodes (or where CPU affinity is not
+ * supported), the allowed CPUs are listed in order, or the list is empty.
+ * The nodes are read on the first call (of this function, NumaNodeCount,
+ * or PinThread), which should come before any thread is pinned.
+ *
+ * \return The CPUs.
+ */
+std::vector<int> NumaCpuOrder();
+
+/**
+ * \brief Gets the number of NUMA nodes with CPUs allowed for this process.
+ *
+ * \return The number of nodes; 1 without information about the nodes.
+ */
+std::size_t NumaNodeCount();
+
+/**
+ * \brief Gets the NUMA node of the CPU the calling thread is pinned to.
+ *
+ * The nodes are numbered from 0 to NumaNodeCount()-1, in the order of their
+ * first CPUs in NumaCpuOrder.
+ *
+ * \return The node; 0 if the thread is not pinned.
+ */
+std::size_t CurrentNumaNode() noexcept;
+
+/**
+ * \brief Pins the calling thread to a CPU.
+ *
+ * The CPU's NUMA node is recorded for CurrentNumaNode. Nothing is done if
+ * the CPU is negative or pinning is not supported; a failure to pin is
+ * ignored.
+ *
+ * \param[in] cpu The CPU (e.g., from NumaCpuOrder).
+ */
+void PinThread(int cpu);
+
+} // namespace molstat
+
+#endif
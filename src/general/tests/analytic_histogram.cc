@@ -0,0 +1,98 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/analytic_histogram.cc
+ * \brief Test suite for histograms calculated from a distribution.
+ *
+ * \test Tests that molstat::FillAnalyticHistogram sets the expected counts
+ *    of linear and logarithmic bins (and the underflows and overflows) from
+ *    a cumulative distribution function.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+#include <general/simulator_tools/analytic_histogram.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing histograms from a distribution.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh = 1.0e-6;
+	const size_t ntrials{ 1000000 };
+
+	// a standard normal distribution, with linear bins on [-1, 2]
+	const molstat::AnalyticCDF normal{ [] (double x) -> double
+		{
+			return 0.5 * erfc(-x / sqrt(2.));
+		} };
+	shared_ptr<const molstat::BinStyle> blinear
+		{ make_shared<molstat::BinLinear>(6) };
+	molstat::Histogram hist({ blinear }, {{{ -1., 2. }}});
+	molstat::FillAnalyticHistogram(normal, *blinear, ntrials, hist);
+
+	assert(hist.isWeighted());
+	const vector<double> sums{ hist.getRawBinSums() };
+	const vector<size_t> counts{ hist.getRawBinCounts() };
+	assert(sums.size() == 6);
+	for(size_t j = 0; j < 6; ++j)
+	{
+		const double expected{ ntrials *
+			(normal(-1. + 0.5*(j+1)) - normal(-1. + 0.5*j)) };
+		assert(abs(sums[j] - expected) < thresh * ntrials);
+		assert(counts[j] == size_t(llround(expected)));
+	}
+	assert(hist.numUnderflow(0) == size_t(llround(ntrials * normal(-1.))));
+	assert(hist.numOverflow(0) ==
+		size_t(llround(ntrials * (1. - normal(2.)))));
+	assert(hist.numOutOfRange() == hist.numUnderflow(0) +
+		hist.numOverflow(0));
+
+	// F(x) = x^2 on [0, 1], with logarithmic bins on [0.01, 1]
+	const molstat::AnalyticCDF square{ [] (double x) -> double
+		{
+			return x <= 0. ? 0. : (x >= 1. ? 1. : x*x);
+		} };
+	shared_ptr<const molstat::BinStyle> blog
+		{ make_shared<molstat::BinLog>(2, 10.) };
+	molstat::Histogram loghist({ blog }, {{{ 0.01, 1. }}});
+	molstat::FillAnalyticHistogram(square, *blog, ntrials, loghist);
+
+	const vector<double> logsums{ loghist.getRawBinSums() };
+	assert(abs(logsums[0] - ntrials * (0.01 - 0.0001)) < thresh * ntrials);
+	assert(abs(logsums[1] - ntrials * (1. - 0.01)) < thresh * ntrials);
+	assert(loghist.numUnderflow(0) == 100);
+	assert(loghist.numOverflow(0) == 0);
+
+	// the histogram needs fixed bounds
+	try
+	{
+		molstat::Histogram bad(1);
+		molstat::FillAnalyticHistogram(normal, *blinear, ntrials, bad);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
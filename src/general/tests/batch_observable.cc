@@ -0,0 +1,246 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file batch_observable.cc
+ * \brief Test suite for the batch versions of observable functions.
+ *
+ * \test Tests molstat::SimulateModel::getBatchObservableFunction for models
+ *    with specialized (per-trial and vectorized) kernels, the generic
+ *    implementation, and composite models, comparing against the per-trial
+ *    molstat::ObservableFunction.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <typeinfo>
+#include <typeindex>
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/uniform.h>
+#include <general/batch_kernels.h>
+#include <general/simulator_tools/identity_tools.h>
+#include <general/simulator_tools/simulator.h>
+#include <general/simulator_tools/simulate_model.h>
+#include <general/simulator_tools/simulator_exceptions.h>
+
+/// Model whose observable is only produced for half of the parameters.
+class BatchRejectTestModel :
+	public BasicObs1
+{
+public:
+	virtual double Obs1(const valarray<double> &params) const override
+	{
+		if(params[0] >= 0.5)
+			throw molstat::NoObservableProduced();
+
+		return params[0];
+	}
+
+	virtual vector<string> get_names() const override
+	{
+		return { "a" };
+	}
+};
+
+/// Squares each element of an array.
+MOLSTAT_BATCH_KERNEL
+void SquareKernel(size_t n, const double *a, double *out)
+{
+	for(size_t t = 0; t < n; ++t)
+		out[t] = a[t] * a[t];
+}
+
+/// Model with a vectorized batch kernel.
+class VectorKernelTestModel :
+	public BasicObs2
+{
+public:
+	VectorKernelTestModel()
+	{
+		setBatchObservableKernel<BasicObs2, VectorKernelTestModel>(
+			[] (const VectorKernelTestModel &model,
+				const double *const *params, size_t n, double *out) -> void
+			{
+				SquareKernel(n, params[0], out);
+			});
+	}
+
+	virtual double Obs2(const valarray<double> &params) const override
+	{
+		return params[0] * params[0];
+	}
+
+	virtual vector<string> get_names() const override
+	{
+		return { "a" };
+	}
+};
+
+/**
+ * \brief Checks that the batch and per-trial observable functions agree.
+ *
+ * \param[in] model The model.
+ * \param[in] obs The observable.
+ * \param[in] ntrials The number of trials to check.
+ * \param[in] engine The random number engine.
+ * \return The number of trials for which the observable was produced.
+ */
+size_t check_batch(shared_ptr<molstat::SimulateModel> model,
+	const molstat::ObservableIndex &obs, size_t ntrials,
+	molstat::Engine &engine)
+{
+	constexpr double thresh = 1.e-12;
+
+	const size_t nparams{ model->get_num_parameters() };
+	vector<double> params(nparams * ntrials);
+	model->generateParameterBatch(engine, ntrials, params.data());
+
+	vector<const double *> rows(nparams);
+	for(size_t p = 0; p < nparams; ++p)
+		rows[p] = params.data() + p*ntrials;
+
+	vector<double> out(ntrials);
+	const molstat::BatchObservableFunction batch
+		{ model->getBatchObservableFunction(obs) };
+	batch(rows.data(), nparams, ntrials, out.data());
+
+	const molstat::ObservableFunction single
+		{ model->getObservableFunction(obs) };
+	valarray<double> trial(nparams);
+	size_t nproduced{ 0 };
+
+	for(size_t t = 0; t < ntrials; ++t)
+	{
+		for(size_t p = 0; p < nparams; ++p)
+			trial[p] = params[p*ntrials + t];
+
+		double expected;
+		try
+		{
+			expected = single(trial);
+		}
+		catch(const molstat::NoObservableProduced &e)
+		{
+			expected = molstat::NoObservableValue;
+		}
+
+		if(std::isnan(expected))
+			assert(std::isnan(out[t]));
+		else
+		{
+			assert(abs(out[t] - expected) < thresh);
+			++nproduced;
+		}
+	}
+
+	return nproduced;
+}
+
+/**
+ * \brief Main function for testing the batch observable functions.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr size_t ntrials = 1000;
+	molstat::Engine engine{ 5489, 0, molstat::EngineKind::Xoshiro256pp };
+
+	// the kernels run one of the compiled instruction sets
+	{
+		const string target{ molstat::BatchKernelTarget() };
+		assert(target == "avx512f" || target == "avx2" || target == "generic");
+	}
+
+	// model with a specialized kernel
+	{
+		molstat::SimulateModelFactory factory
+			{ molstat::SimulateModelFactory::makeFactory<molstat::IdentityModel>() };
+		factory.setDistribution("parameter",
+			make_shared<molstat::UniformDistribution>(-1., 1.));
+		shared_ptr<molstat::SimulateModel> model{ factory.getModel() };
+
+		assert(check_batch(model,
+			type_index{ typeid(molstat::IdentityObservable) }, ntrials,
+			engine) == ntrials);
+
+		// not all observables are compatible
+		try
+		{
+			model->getBatchObservableFunction(type_index{ typeid(BasicObs1) });
+			assert(false);
+		}
+		catch(const molstat::IncompatibleObservable &e)
+		{
+			// should be here
+		}
+	}
+
+	// model with a vectorized kernel
+	{
+		molstat::SimulateModelFactory factory
+			{ molstat::SimulateModelFactory::makeFactory<VectorKernelTestModel>() };
+		factory.setDistribution("a",
+			make_shared<molstat::UniformDistribution>(-2., 2.));
+		shared_ptr<molstat::SimulateModel> model{ factory.getModel() };
+
+		assert(check_batch(model, type_index{ typeid(BasicObs2) }, ntrials,
+			engine) == ntrials);
+	}
+
+	// generic implementation, with some trials not producing the observable
+	{
+		molstat::SimulateModelFactory factory
+			{ molstat::SimulateModelFactory::makeFactory<BatchRejectTestModel>() };
+		factory.setDistribution("a",
+			make_shared<molstat::UniformDistribution>(0., 1.));
+		shared_ptr<molstat::SimulateModel> model{ factory.getModel() };
+
+		const size_t nproduced{ check_batch(model,
+			type_index{ typeid(BasicObs1) }, ntrials, engine) };
+		assert(nproduced > 0 && nproduced < ntrials);
+	}
+
+	// composite model
+	{
+		molstat::SimulateModelFactory cfactory
+			{ molstat::SimulateModelFactory::makeFactory<CompositeTestModelAdd>() };
+		cfactory.setDistribution("ef",
+			make_shared<molstat::UniformDistribution>(-1., 1.));
+		cfactory.setDistribution("v",
+			make_shared<molstat::UniformDistribution>(0., 2.));
+
+		for(size_t k = 0; k < 3; ++k)
+		{
+			molstat::SimulateModelFactory subfactory
+				{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+			subfactory.setDistribution("eps",
+				make_shared<molstat::UniformDistribution>(-5., 5.));
+			subfactory.setDistribution("gamma",
+				make_shared<molstat::UniformDistribution>(0.1, 1.));
+			cfactory.addSubmodel(subfactory.getModel());
+		}
+		shared_ptr<molstat::SimulateModel> model{ cfactory.getModel() };
+
+		assert(check_batch(model, type_index{ typeid(BasicObs1) }, ntrials,
+			engine) == ntrials);
+		assert(check_batch(model, type_index{ typeid(BasicObs4) }, ntrials,
+			engine) == ntrials);
+
+		// an empty batch does nothing
+		const molstat::BatchObservableFunction batch
+			{ model->getBatchObservableFunction(type_index{ typeid(BasicObs1) }) };
+		batch(nullptr, model->get_num_parameters(), 0, nullptr);
+	}
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/batch_pipeline.cc
+ * \brief Test suite for the pipeline from simulation to binning.
+ *
+ * \test Tests that molstat::BatchPipeline consumes every batch of each
+ *    producer in order (with full rings), that flush() waits for the
+ *    batches and rethrows an error from a consumer, and that the pipeline
+ *    can be reused after an error.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <general/task_scheduler.h>
+#include <general/simulator_tools/batch_pipeline.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the pipeline.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const size_t nproducers{ 5 }, nbatches{ 2000 };
+
+	// each batch holds its number; the consumers check the order and sum the
+	// values. each producer's entries are only touched by its consumer.
+	vector<size_t> next(nproducers, 0);
+	vector<double> sums(nproducers, 0.);
+	vector<int> ordered(nproducers, 1);
+	molstat::BatchPipeline pipeline{ nproducers, 2, 3,
+		[&next, &sums, &ordered] (size_t p, const molstat::TrialBatch &batch)
+			-> void
+		{
+			if(batch.values[0] == -1.)
+				throw runtime_error("Bad batch.");
+
+			ordered[p] = ordered[p] && batch.values[0] == next[p];
+			++next[p];
+			for(size_t k = 0; k < batch.n; ++k)
+				sums[p] += batch.values[k];
+		} };
+	assert(pipeline.numConsumers() == 2);
+
+	// the producers fill their rings concurrently
+	{
+		molstat::TaskScheduler scheduler{ nproducers };
+		scheduler.run(nproducers, [&pipeline, nbatches] (size_t p, size_t)
+			-> void
+			{
+				for(size_t b = 0; b < nbatches; ++b)
+				{
+					molstat::TrialBatch &batch = pipeline.acquire(p);
+					batch.values.assign(p + 1, double(b));
+					batch.n = p + 1;
+					pipeline.submit(p);
+				}
+			});
+	}
+	pipeline.flush();
+
+	for(size_t p = 0; p < nproducers; ++p)
+	{
+		assert(ordered[p]);
+		assert(next[p] == nbatches);
+		assert(sums[p] == (p + 1) * 0.5 * nbatches * (nbatches - 1.));
+	}
+
+	// an error while binning is rethrown by flush
+	molstat::TrialBatch &bad = pipeline.acquire(1);
+	bad.values.assign(1, -1.);
+	bad.n = 1;
+	pipeline.submit(1);
+	try
+	{
+		pipeline.flush();
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	// the pipeline is used again after the error
+	molstat::TrialBatch &good = pipeline.acquire(1);
+	good.values.assign(1, double(nbatches));
+	good.n = 1;
+	pipeline.submit(1);
+	pipeline.flush();
+	assert(next[1] == nbatches + 1);
+
+	// bad arguments
+	try
+	{
+		molstat::BatchPipeline bad_pipeline{ 0, 1, 1,
+			[] (size_t, const molstat::TrialBatch &) -> void {} };
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	try
+	{
+		molstat::BatchPipeline bad_pipeline{ 1, 1, 0,
+			[] (size_t, const molstat::TrialBatch &) -> void {} };
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
@@ -0,0 +1,188 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file bin_styles.cc
+ * \brief Test suite for the arcsinh and bin-edge binning styles.
+ *
+ * \test Tests molstat::BinArcsinh and molstat::BinEdges, including their
+ *    construction from tokens, histograms that use them, and the relative
+ *    widths of their bins.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_arcsinh.h>
+#include <general/histogram_tools/bin_edges.h>
+#include <general/string_tools.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the arcsinh and bin-edge binning styles.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh = 1.0e-10;
+
+	// arcsinh binning
+	molstat::BinArcsinh basinh(10, 0.5);
+	for(double x = -20.; x <= 20.; x += 0.37)
+	{
+		assert(abs(basinh.invmask(basinh.mask(x)) - x) < thresh * (1. + abs(x)));
+		const double h{ 1.e-6 };
+		assert(abs(basinh.dmaskdx(x) -
+			(basinh.mask(x + h) - basinh.mask(x - h)) / (2. * h)) < 1.e-6);
+	}
+	assert(abs(basinh.mask(0.)) < thresh);
+
+	try
+	{
+		molstat::BinArcsinh bad(10, 0.);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// uneven bin edges
+	const vector<double> edges{ -1., 0., 0.01, 0.02, 0.5, 3., 3.001, 10. };
+	const molstat::BinEdges bedges(edges);
+	assert(bedges.nbins == edges.size() - 1);
+	assert(bedges.hasBounds());
+	assert(bedges.getBounds()[0] == edges.front());
+	assert(bedges.getBounds()[1] == edges.back());
+
+	// the bin of each value is the one found by a binary search
+	vector<double> values, masked;
+	for(size_t k = 0; k < 100000; ++k)
+		values.push_back(-1. + 11. * k / 100000.);
+	values.insert(values.end(), edges.begin(), edges.end() - 1);
+	masked.resize(values.size());
+	bedges.mask_n(values.data(), masked.data(), values.size());
+	for(size_t k = 0; k < values.size(); ++k)
+	{
+		const double x{ values[k] };
+		const size_t bin = upper_bound(edges.begin(), edges.end(), x) -
+			edges.begin() - 1;
+
+		assert(masked[k] == bedges.mask(x));
+		assert(static_cast<size_t>(floor(masked[k])) == bin);
+		assert(abs(bedges.invmask(masked[k]) - x) < thresh);
+		assert(abs(bedges.dmaskdx(x) * (edges[bin+1] - edges[bin]) - 1.) <
+			thresh);
+	}
+	assert(bedges.mask(edges.back()) == bedges.nbins);
+	assert(bedges.mask(-2.) < 0.);
+	assert(bedges.mask(11.) > bedges.nbins);
+
+	try
+	{
+		molstat::BinEdges bad({ 0., 1., 1., 2. });
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	try
+	{
+		molstat::BinEdges bad({ 0. });
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// a streaming histogram with the edges
+	{
+		molstat::Histogram hist({ make_shared<molstat::BinEdges>(edges) });
+		const vector<double> data{ -0.5, 0.005, 0.005, 0.015, 1., 2., 3.0005,
+			5., 10., -3., 12. };
+		hist.add_data(data.data(), data.size());
+
+		const vector<size_t> expected{ 1, 2, 1, 0, 2, 1, 2 };
+		assert(hist.getRawBinCounts() == expected);
+		assert(hist.numOutOfRange() == 2);
+
+		const vector<double> counts{ hist.getBinCounts() };
+		const vector<double> &coords{ hist.getBinCoordinates(0) };
+		for(size_t k = 0; k < expected.size(); ++k)
+		{
+			const double width{ edges[k+1] - edges[k] };
+			assert(abs(counts[k] * width - expected[k]) < thresh);
+			assert(abs(coords[k] - 0.5 * (edges[k] + edges[k+1])) < thresh);
+		}
+	}
+
+	// construction from tokens
+	{
+		auto style = molstat::BinStyleFactory(
+			molstat::tokenize("4 arcsinh 0.1 bounds -1 1"));
+		assert(style->nbins == 4);
+		assert(style->hasBounds());
+		assert(abs(style->mask(1.) - asinh(10.)) < thresh);
+
+		style = molstat::BinStyleFactory(molstat::tokenize("4 ARCSINH"));
+		assert(abs(style->mask(1.) - asinh(1.)) < thresh);
+
+		style = molstat::BinStyleFactory(molstat::tokenize("3 edges 0 1 4 9"));
+		assert(style->nbins == 3);
+		assert(style->getBounds()[1] == 9.);
+		assert(abs(style->mask(2.5) - 1.5) < thresh);
+	}
+
+	// the narrowest bins, relative to their values
+	assert(abs(bedges.relativeResolution() - 0.001 / 3.001) < thresh);
+	{
+		auto style = molstat::BinStyleFactory(
+			molstat::tokenize("4 log bounds 1 1e4"));
+		assert(abs(style->relativeResolution() - 0.9) < thresh);
+
+		style = molstat::BinStyleFactory(molstat::tokenize("4 arcsinh"));
+		try
+		{
+			style->relativeResolution();
+			assert(false);
+		}
+		catch(const logic_error &e)
+		{
+			// should be here
+		}
+	}
+
+	const vector<string> bad_lines{ "4 arcsinh -1", "4 arcsinh scale",
+		"3 edges 0 1 4", "3 edges 0 1 4 9 10", "3 edges 0 4 1 9",
+		"3 edges 0 1 4 x", "3 edges 0 1 4 9 bounds 0 9" };
+	for(const string &line : bad_lines)
+	{
+		try
+		{
+			molstat::BinStyleFactory(molstat::tokenize(line));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,91 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/binary_io.cc
+ * \brief Test suite for the binary I/O functions.
+ *
+ * \test Tests writing and reading the values of the binary file formats.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <general/binary_io.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the binary I/O functions.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	// values are read back in the order they were written
+	stringstream stream;
+	molstat::WriteBinaryUInt(stream, 0);
+	molstat::WriteBinaryUInt(stream, 12345);
+	molstat::WriteBinaryUInt(stream, UINT64_MAX);
+	molstat::WriteBinaryDouble(stream, -1.5e-300);
+	molstat::WriteBinaryString(stream, "");
+	molstat::WriteBinaryString(stream, "a string");
+	stream.write("abc", 3);
+	assert(stream.str().size() ==
+		5 * sizeof(uint64_t) + sizeof(double) + 8 + 3);
+
+	assert(molstat::ReadBinaryUInt(stream, "the test") == 0);
+	assert(molstat::ReadBinaryUInt(stream, "the test") == 12345);
+	assert(molstat::ReadBinaryUInt(stream, "the test") == UINT64_MAX);
+	assert(molstat::ReadBinaryDouble(stream, "the test") == -1.5e-300);
+	assert(molstat::ReadBinaryString(stream, "the test") == "");
+	assert(molstat::ReadBinaryString(stream, "the test") == "a string");
+
+	// reading past the end reports what the stream holds
+	char chars[4];
+	try
+	{
+		molstat::ReadBinaryBytes(stream, chars, 4, "the test");
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		assert(string(e.what()) == "Unexpected end of the test.");
+	}
+
+	stringstream partial{ string(4, '\0') };
+	try
+	{
+		molstat::ReadBinaryUInt(partial, "the test");
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	// a string longer than the rest of the stream
+	stringstream truncated;
+	molstat::WriteBinaryUInt(truncated, 10);
+	truncated.write("abc", 3);
+	try
+	{
+		molstat::ReadBinaryString(truncated, "the test");
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
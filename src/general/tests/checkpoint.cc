@@ -0,0 +1,175 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file checkpoint.cc
+ * \brief Test suite for simulation checkpoints.
+ *
+ * \test Tests writing and reading checkpoint files, rejecting invalid files,
+ *    and the periodic (background) checkpoints of molstat::CheckpointWriter.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <general/simulator_tools/checkpoint.h>
+
+using namespace std;
+
+/**
+ * \brief Makes the progress of a thread for testing.
+ *
+ * \param[in] next The next trial.
+ * \return The progress.
+ */
+static molstat::ThreadCheckpoint make_thread(size_t next)
+{
+	molstat::ThreadCheckpoint ret;
+	ret.next_trial = next;
+	ret.engine = "0 1 2 3 4";
+	ret.counts = { 1, 0, next };
+	ret.nout = 2;
+	ret.out_of_range = {{{ 1, 1 }}};
+	ret.no_obs = 3;
+	ret.rejections = { 3, 0 };
+
+	return ret;
+}
+
+/**
+ * \brief Main function for testing checkpoints.
+ *
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main()
+{
+	const string filename{ "checkpoint_test.ckpt" };
+
+	// write and read a checkpoint
+	{
+		molstat::Checkpoint ckpt;
+		ckpt.seed = 2014;
+		ckpt.description = "2 threads\n3 linear bins";
+		ckpt.threads = { make_thread(10), make_thread(25) };
+
+		molstat::WriteCheckpoint(filename, ckpt);
+		assert(!ifstream(filename + ".tmp").good());
+
+		const molstat::Checkpoint read{ molstat::ReadCheckpoint(filename) };
+		assert(read.seed == 2014);
+		assert(read.description == ckpt.description);
+		assert(read.threads.size() == 2);
+		for(size_t t = 0; t < 2; ++t)
+		{
+			const molstat::ThreadCheckpoint &a = ckpt.threads[t],
+				&b = read.threads[t];
+			assert(a.next_trial == b.next_trial);
+			assert(a.engine == b.engine);
+			assert(a.counts == b.counts);
+			assert(a.nout == b.nout);
+			assert(a.out_of_range == b.out_of_range);
+			assert(a.no_obs == b.no_obs);
+			assert(a.rejections == b.rejections);
+		}
+	}
+
+	// a truncated checkpoint
+	{
+		string contents;
+		{
+			ifstream in(filename, ios_base::in | ios_base::binary);
+			contents.assign(istreambuf_iterator<char>(in),
+				istreambuf_iterator<char>());
+		}
+		{
+			ofstream out(filename, ios_base::out | ios_base::binary);
+			out.write(contents.data(), contents.size() - 4);
+		}
+
+		try
+		{
+			molstat::ReadCheckpoint(filename);
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+	}
+
+	// not a checkpoint
+	{
+		{
+			ofstream out(filename);
+			out << "MOLSTATS";
+		}
+
+		try
+		{
+			molstat::ReadCheckpoint(filename);
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+	}
+
+	// periodic checkpoints
+	{
+		molstat::Checkpoint initial;
+		initial.seed = 7;
+		initial.threads = { make_thread(0), make_thread(50) };
+
+		molstat::CheckpointWriter writer(filename, initial, 0.001);
+		assert(molstat::ReadCheckpoint(filename).threads[0].next_trial == 0);
+
+		this_thread::sleep_for(chrono::milliseconds(5));
+		assert(writer.due(0));
+		writer.update(0, make_thread(20));
+		assert(!writer.due(0));
+
+		// the background thread writes the update
+		size_t next{ 0 };
+		for(int j = 0; j < 1000 && next != 20; ++j)
+		{
+			this_thread::sleep_for(chrono::milliseconds(5));
+			next = molstat::ReadCheckpoint(filename).threads[0].next_trial;
+		}
+		assert(next == 20);
+
+		// the final progress is written when closing
+		writer.update(1, make_thread(100));
+		writer.close();
+		const molstat::Checkpoint last{ molstat::ReadCheckpoint(filename) };
+		assert(last.seed == 7);
+		assert(last.threads[0].next_trial == 20);
+		assert(last.threads[1].next_trial == 100);
+	}
+
+	// the interval must be positive
+	try
+	{
+		molstat::CheckpointWriter writer(filename, molstat::Checkpoint{}, 0.);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	remove(filename.c_str());
+
+	return 0;
+}
@@ -0,0 +1,104 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file composite_observable_alloc.cc
+ * \brief Test suite for memory allocations when evaluating composite
+ *    observables.
+ *
+ * \test Tests that molstat::CompositeObservable routes parameters to its
+ *    submodels without allocating memory (after the first evaluation) and
+ *    that the routed parameters are correct.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <typeinfo>
+#include <typeindex>
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/random_distributions/constant.h>
+#include <general/simulator_tools/simulate_model.h>
+
+/// The number of calls to operator new.
+static size_t nallocations = 0;
+
+/// \cond
+void *operator new(size_t size)
+{
+	++nallocations;
+	void *ret{ malloc(size == 0 ? 1 : size) };
+	if(ret == nullptr)
+		throw bad_alloc();
+	return ret;
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+/// \endcond
+
+/**
+ * \brief Main function for testing allocations by composite observables.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-6;
+	constexpr double ef = 7.5, v = -6.3;
+	constexpr double eps1 = 4.1, gamma1 = 1.2, eps2 = -14.1, gamma2 = 2.9;
+
+	// composite model with two submodels
+	molstat::SimulateModelFactory cfactory
+		{ molstat::SimulateModelFactory::makeFactory<CompositeTestModelAdd>() };
+	cfactory.setDistribution("ef",
+		make_shared<molstat::ConstantDistribution>(ef));
+	cfactory.setDistribution("v",
+		make_shared<molstat::ConstantDistribution>(v));
+
+	molstat::SimulateModelFactory subfactory1
+		{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+	subfactory1.setDistribution("eps",
+		make_shared<molstat::ConstantDistribution>(eps1));
+	subfactory1.setDistribution("gamma",
+		make_shared<molstat::ConstantDistribution>(gamma1));
+	molstat::SimulateModelFactory subfactory2
+		{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+	subfactory2.setDistribution("eps",
+		make_shared<molstat::ConstantDistribution>(eps2));
+	subfactory2.setDistribution("gamma",
+		make_shared<molstat::ConstantDistribution>(gamma2));
+
+	cfactory.addSubmodel(subfactory1.getModel());
+	cfactory.addSubmodel(subfactory2.getModel());
+	shared_ptr<molstat::SimulateModel> cmodel{ cfactory.getModel() };
+
+	const molstat::ObservableFunction obs1
+		{ cmodel->getObservableFunction(type_index{ typeid(BasicObs1) }) };
+	const valarray<double> params{ ef, v, eps1, gamma1, eps2, gamma2 };
+	const double exact{ v * (eps1 - gamma1) + v * (eps2 - gamma2) };
+
+	// the first evaluation sets up the buffers
+	assert(abs(obs1(params) - exact) < thresh);
+
+	// subsequent evaluations do not allocate memory
+	const size_t before{ nallocations };
+	double sum{ 0. };
+	for(size_t j = 0; j < 1000; ++j)
+		sum += obs1(params);
+	assert(nallocations == before);
+	assert(abs(sum - 1000. * exact) < 1000. * thresh);
+
+	return 0;
+}
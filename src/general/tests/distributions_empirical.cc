@@ -0,0 +1,150 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file distributions_empirical.cc
+ * \brief Test suite for the empirical distribution.
+ *
+ * \test Tests molstat::EmpiricalDistribution by comparing the fraction of
+ *    samples in each bin to the tabulated probabilities, and tests reading
+ *    the table from a file through molstat::RandomDistributionFactory.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <general/string_tools.h>
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/empirical.h>
+
+using namespace std;
+
+/**
+ * \brief Checks the fraction of samples in each bin.
+ *
+ * The tolerance for each bin is 5 standard errors.
+ *
+ * \param[in] dist The distribution.
+ * \param[in] edges The bin edges.
+ * \param[in] probs The probability of each bin.
+ * \param[in,out] engine The random number engine.
+ */
+static void check_bins(const molstat::RandomDistribution &dist,
+	const vector<double> &edges, const vector<double> &probs,
+	molstat::Engine &engine)
+{
+	const size_t n = 400000;
+	vector<double> samples(n);
+	dist.sample_n(engine, samples.data(), n);
+
+	vector<size_t> counts(probs.size(), 0);
+	for(const double x : samples)
+	{
+		assert(x >= edges.front() && x <= edges.back());
+		for(size_t b = 0; b < probs.size(); ++b)
+			if(x < edges[b + 1] || b + 1 == probs.size())
+			{
+				++counts[b];
+				break;
+			}
+	}
+
+	for(size_t b = 0; b < probs.size(); ++b)
+		assert(abs(double(counts[b]) / n - probs[b]) <=
+			5. * sqrt(probs[b] * (1. - probs[b]) / n) + 1.e-12);
+}
+
+/**
+ * \brief Main function for testing the empirical distribution.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	molstat::Engine engine{ 0xFEEDFACE };
+
+	// uniform bins, including one with no probability
+	check_bins(molstat::EmpiricalDistribution({ 0.5, 1.5, 2.5, 3.5, 4.5 },
+		{ 1., 2., 0., 3., 4. }), { 0., 1., 2., 3., 4., 5. },
+		{ 0.1, 0.2, 0., 0.3, 0.4 }, engine);
+
+	// bins of different widths, with the same density: the probabilities are
+	// proportional to the widths, and the values are uniform within each bin
+	check_bins(molstat::EmpiricalDistribution({ 1., 2., 4. }, { 5., 5., 5. }),
+		{ 0.5, 1.5, 1.75, 3., 5. },
+		{ 1. / 4.5, 0.25 / 4.5, 1.25 / 4.5, 2. / 4.5 }, engine);
+
+	// one bin is constant
+	{
+		double value;
+		assert(molstat::EmpiricalDistribution({ 2. }, { 1. }).isConstant(value));
+		assert(value == 2.);
+		assert(!molstat::EmpiricalDistribution({ 1., 2. }, { 1., 1. })
+			.isConstant(value));
+	}
+
+	// invalid tables
+	for(const vector<vector<double>> &table : vector<vector<vector<double>>>{
+		{ {}, {} }, { { 1., 2. }, { 1. } }, { { 2., 1. }, { 1., 1. } },
+		{ { 1., 2. }, { 1., -1. } }, { { 1., 2. }, { 0., 0. } } })
+	{
+		try
+		{
+			molstat::EmpiricalDistribution(table[0], table[1]);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// read from a file, with a comment and an extra column
+	const string filename{ "distributions_empirical.dat" };
+	{
+		ofstream out(filename);
+		out << "# center density\n" \
+			"0.5 1. 10\n" \
+			"\n" \
+			"1.5 3. 11\n";
+	}
+	check_bins(*molstat::RandomDistributionFactory(
+		molstat::tokenize("empirical " + filename)), { 0., 1., 2. },
+		{ 0.25, 0.75 }, engine);
+	check_bins(*molstat::RandomDistributionFactory(
+		molstat::tokenize("Empirical " + filename + " truncate 0.5 1.5")),
+		{ 0.5, 1., 1.5 }, { 0.25, 0.75 }, engine);
+
+	{
+		ofstream out(filename);
+		out << "0.5 1.\n" \
+			"1.5\n";
+	}
+	for(const string &line : vector<string>{ "empirical",
+		"empirical " + filename, "empirical " + filename + ".missing" })
+	{
+		try
+		{
+			molstat::RandomDistributionFactory(molstat::tokenize(line));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+	remove(filename.c_str());
+
+	return 0;
+}
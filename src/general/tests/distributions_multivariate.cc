@@ -0,0 +1,251 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file distributions_multivariate.cc
+ * \brief Test suite for the multivariate normal distribution.
+ *
+ * \test Tests molstat::MultivariateNormalDistribution by comparing sample
+ *    means and covariances to their exact values, and tests that the
+ *    components of a joint distribution are correlated within each
+ *    (sub)model when parameters are generated by the models and by
+ *    molstat::Simulator.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/string_tools.h>
+#include <general/random_distributions/multivariate_normal.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/simulator.h>
+
+using namespace std;
+
+/**
+ * \brief Calculates the sample covariance of two strided sequences.
+ *
+ * \param[in] x The first sequence.
+ * \param[in] y The second sequence.
+ * \param[in] n The number of samples.
+ * \param[in] stride The stride of the sequences.
+ * \return The sample covariance.
+ */
+static double covariance(const double *x, const double *y, const size_t n,
+	const size_t stride)
+{
+	double xmean{ 0. }, ymean{ 0. };
+	for(size_t t = 0; t < n; ++t)
+	{
+		xmean += x[t*stride];
+		ymean += y[t*stride];
+	}
+	xmean /= n;
+	ymean /= n;
+
+	double ret{ 0. };
+	for(size_t t = 0; t < n; ++t)
+		ret += (x[t*stride] - xmean) * (y[t*stride] - ymean);
+
+	return ret / (n - 1);
+}
+
+/**
+ * \brief Checks a sample covariance against its exact value.
+ *
+ * The tolerance is 5 standard errors, `sqrt((s_xx s_yy + s_xy^2) / n)` for
+ * normal random variables.
+ *
+ * \param[in] x The first sequence.
+ * \param[in] y The second sequence.
+ * \param[in] n The number of samples.
+ * \param[in] stride The stride of the sequences.
+ * \param[in] sxx The exact variance of x.
+ * \param[in] syy The exact variance of y.
+ * \param[in] sxy The exact covariance.
+ */
+static void check_covariance(const double *x, const double *y, const size_t n,
+	const size_t stride, const double sxx, const double syy, const double sxy)
+{
+	assert(abs(covariance(x, y, n, stride) - sxy) <=
+		5. * sqrt((sxx * syy + sxy * sxy) / n));
+}
+
+/**
+ * \brief Main function for testing the multivariate normal distribution.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	molstat::Engine engine{ 0xFEEDFACE };
+
+	const vector<double> means{ 1., -2., 0.5 };
+	const vector<double> cov{ 4., 1.2, -0.6,
+	                          1.2, 1., 0.3,
+	                          -0.6, 0.3, 0.5 };
+	const molstat::MultivariateNormalDistribution dist(means, cov);
+	assert(dist.dimension() == 3);
+
+	// batch sampling, with the components in permuted rows
+	{
+		const size_t n = 200000;
+		const vector<size_t> slots{ 2, 0, 1 };
+		vector<double> rows(3 * n);
+		dist.sample_n(engine, rows.data(), n, slots);
+
+		for(size_t i = 0; i < 3; ++i)
+		{
+			const double *const x{ rows.data() + slots[i]*n };
+			double mean{ 0. };
+			for(size_t t = 0; t < n; ++t)
+				mean += x[t];
+			assert(abs(mean / n - means[i]) <= 5. * sqrt(cov[4*i] / n));
+
+			for(size_t j = 0; j <= i; ++j)
+				check_covariance(x, rows.data() + slots[j]*n, n, 1,
+					cov[4*i], cov[4*j], cov[3*i + j]);
+		}
+	}
+
+	// one trial at a time
+	{
+		const size_t n = 100000;
+		const vector<size_t> slots{ 0, 1, 2 };
+		vector<double> samples(3 * n);
+		for(size_t t = 0; t < n; ++t)
+			dist.sample(engine, samples.data() + 3*t, slots);
+
+		for(size_t i = 0; i < 3; ++i)
+			for(size_t j = 0; j <= i; ++j)
+				check_covariance(samples.data() + i, samples.data() + j, n, 3,
+					cov[4*i], cov[4*j], cov[3*i + j]);
+	}
+
+	// the marginal distribution of two components
+	{
+		const size_t n = 100000;
+		const auto marg = dist.marginal({ 2, 0 });
+		assert(marg->dimension() == 2);
+
+		vector<double> rows(2 * n);
+		marg->sample_n(engine, rows.data(), n, { 0, 1 });
+		check_covariance(rows.data(), rows.data() + n, n, 1, cov[8], cov[0],
+			cov[6]);
+	}
+
+	// invalid covariance matrices
+	for(const vector<double> &bad : vector<vector<double>>{ { 1., 0.5, 0.4, 1. },
+		{ 1., 2., 2., 1. }, { 1., 0., 0. } })
+	{
+		try
+		{
+			molstat::MultivariateNormalDistribution({ 0., 0. }, bad);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// the factory
+	const vector<shared_ptr<const molstat::RandomDistribution>> components
+		{ molstat::JointDistributionFactory(2,
+			molstat::tokenize("MVNormal 0.5 -1. 0.04 0.018 0.018 0.01")) };
+	assert(components.size() == 2);
+	assert(molstat::IsJointComponent(*components[1]));
+	for(const string line : { "mvnormal 0. 0. 1. 0. 0.", "normal 0. 1.",
+		"mvnormal 0. 0. 1. 0. 0. x" })
+	{
+		try
+		{
+			molstat::JointDistributionFactory(2, molstat::tokenize(line));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// a component on its own has the marginal distribution
+	{
+		const size_t n = 100000;
+		vector<double> x(n);
+		components[0]->sample_n(engine, x.data(), n);
+		check_covariance(x.data(), x.data(), n, 1, 0.04, 0.04, 0.04);
+	}
+
+	// a composite model with two submodels, each with correlated eps and
+	// gamma; the submodels' parameters are independent of each other
+	{
+		molstat::SimulateModelFactory cfactory
+			{ molstat::SimulateModelFactory::makeFactory<CompositeTestModelAdd>() };
+		cfactory.setDistribution("ef",
+			make_shared<molstat::UniformDistribution>(-1., 1.));
+		cfactory.setDistribution("v",
+			make_shared<molstat::UniformDistribution>(0., 2.));
+		for(size_t k = 0; k < 2; ++k)
+		{
+			molstat::SimulateModelFactory subfactory
+				{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+			subfactory.setDistribution("eps", components[0]);
+			subfactory.setDistribution("gamma", components[1]);
+			cfactory.addSubmodel(subfactory.getModel());
+		}
+		shared_ptr<molstat::SimulateModel> model{ cfactory.getModel() };
+		assert(model->get_num_parameters() == 6);
+
+		const size_t n = 100000;
+		const auto check_params = [n] (const double *params, size_t stride,
+			size_t pstride)
+		{
+			// eps and gamma of each submodel
+			for(size_t k = 0; k < 2; ++k)
+			{
+				const double *const eps{ params + (2 + 2*k)*pstride };
+				const double *const gamma{ eps + pstride };
+				check_covariance(eps, eps, n, stride, 0.04, 0.04, 0.04);
+				check_covariance(eps, gamma, n, stride, 0.04, 0.01, 0.018);
+			}
+
+			// independent across submodels
+			check_covariance(params + 2*pstride, params + 5*pstride, n, stride,
+				0.04, 0.01, 0.);
+		};
+
+		// generated by the model, as a batch and one trial at a time
+		vector<double> params(6 * n);
+		model->generateParameterBatch(engine, n, params.data());
+		check_params(params.data(), 1, n);
+
+		for(size_t t = 0; t < n; ++t)
+		{
+			const valarray<double> p{ model->generateParameters(engine) };
+			copy(begin(p), end(p), params.begin() + 6*t);
+		}
+		check_params(params.data(), 6, 1);
+
+		// generated by the simulator
+		molstat::Simulator sim{ model };
+		sim.setObservable(0, type_index{ typeid(BasicObs4) });
+		vector<double> out(n), workspace;
+		assert(sim.simulateBatch(engine, n, out.data(), workspace, nullptr,
+			nullptr, params.data()) == n);
+		check_params(params.data(), 6, 1);
+	}
+
+	return 0;
+}
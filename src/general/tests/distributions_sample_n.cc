@@ -0,0 +1,112 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file distributions_sample_n.cc
+ * \brief Test suite for batch sampling from random distributions.
+ *
+ * \test Tests molstat::RandomDistribution::sample_n for each distribution by
+ *    comparing sample means and variances to their exact values.
+ *
+ * \author Matthew G.\ Reuter
+ * \date October 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/uniform.h>
+#include <general/random_distributions/normal.h>
+#include <general/random_distributions/lognormal.h>
+#include <general/random_distributions/gamma.h>
+#include <general/random_distributions/poisson.h>
+
+using namespace std;
+
+/**
+ * \brief Checks the mean and variance of a batch of samples.
+ *
+ * The tolerances are 5 standard errors (approximating the variance of the
+ * sample variance with that of a normal distribution).
+ *
+ * \param[in] dist The distribution.
+ * \param[in] mean The exact mean.
+ * \param[in] var The exact variance.
+ * \param[in,out] engine The random number engine.
+ */
+static void check_moments(const molstat::RandomDistribution &dist,
+	const double mean, const double var, molstat::Engine &engine)
+{
+	// use an odd number to also test the leftover sample for Box--Muller
+	const size_t n = 400001;
+	vector<double> samples(n);
+	dist.sample_n(engine, samples.data(), n);
+
+	double smean{ 0. }, svar{ 0. };
+	for(const double x : samples)
+		smean += x;
+	smean /= n;
+	for(const double x : samples)
+		svar += (x - smean) * (x - smean);
+	svar /= (n - 1);
+
+	assert(abs(smean - mean) <= 5. * sqrt(var / n) + 1.e-12);
+	assert(abs(svar - var) <= 5. * var * sqrt(2. / (n - 1)) + 1.e-12);
+}
+
+/**
+ * \brief Main function for testing batch sampling.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	molstat::Engine engine{ 0xFEEDFACE };
+
+	// uniform numbers are in (0, 1)
+	{
+		vector<double> u(100000);
+		molstat::sample_canonical_n(engine, u.data(), u.size());
+		for(const double x : u)
+			assert(x > 0. && x < 1.);
+	}
+
+	check_moments(molstat::ConstantDistribution(2.5), 2.5, 0., engine);
+	check_moments(molstat::UniformDistribution(-1., 3.), 1., 16./12., engine);
+	check_moments(molstat::NormalDistribution(-2., 0.5), -2., 0.25, engine);
+
+	// lognormal: mean exp(zeta + sigma^2/2), variance
+	// (exp(sigma^2) - 1) exp(2 zeta + sigma^2)
+	{
+		const double zeta{ 0.3 }, sigma{ 0.4 };
+		check_moments(molstat::LognormalDistribution(zeta, sigma),
+			exp(zeta + 0.5*sigma*sigma),
+			(exp(sigma*sigma) - 1.) * exp(2.*zeta + sigma*sigma), engine);
+	}
+
+	// gamma: mean k theta, variance k theta^2
+	check_moments(molstat::GammaDistribution(3., 0.5), 1.5, 0.75, engine);
+
+	// Poisson: mean and variance lambda; the samples are counts
+	{
+		check_moments(molstat::PoissonDistribution(2.5), 2.5, 2.5, engine);
+
+		vector<double> counts(1000);
+		molstat::PoissonDistribution(2.5).sample_n(engine, counts.data(),
+			counts.size());
+		for(const double k : counts)
+			assert(k >= 0. && k == round(k));
+	}
+
+	// a zero-length batch does nothing
+	molstat::NormalDistribution(0., 1.).sample_n(engine, nullptr, 0);
+
+	return 0;
+}
@@ -0,0 +1,432 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file distributions_sobol.cc
+ * \brief Test suite for quasi-Monte Carlo sampling.
+ *
+ * \test Tests the stratification of molstat::SobolSequence, the quantile
+ *    functions of the distributions, molstat::Simulator::simulateBatchQMC,
+ *    the Latin hypercubes of molstat::Simulator::simulateBatchLHS, the
+ *    pools of base variates of molstat::Simulator::simulateBatchPooled, and
+ *    the reuse of submodel terms with molstat::ContributionCache.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/string_tools.h>
+#include <general/random_distributions/sobol.h>
+#include <general/random_distributions/variate_pool.h>
+#include <general/random_distributions/normal.h>
+#include <general/random_distributions/truncated.h>
+#include <general/random_distributions/empirical.h>
+#include <general/random_distributions/gamma.h>
+#include <general/random_distributions/multivariate_normal.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/simulator.h>
+
+using namespace std;
+
+/**
+ * \brief The standard normal distribution function.
+ *
+ * \param[in] x The value.
+ * \return The probability below `x`.
+ */
+static double normal_cdf(const double x)
+{
+	return 0.5 * erfc(-x / sqrt(2.));
+}
+
+/**
+ * \brief Calculates the mean of a strided sequence.
+ *
+ * \param[in] x The sequence.
+ * \param[in] n The number of values.
+ * \param[in] stride The stride of the sequence.
+ * \return The mean.
+ */
+static double mean(const double *x, const size_t n, const size_t stride)
+{
+	double ret{ 0. };
+	for(size_t t = 0; t < n; ++t)
+		ret += x[t*stride];
+
+	return ret / n;
+}
+
+/**
+ * \brief Main function for testing quasi-Monte Carlo sampling.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	molstat::Engine engine{ 0xFEEDFACE };
+
+	// the first 2^m points have one point in each interval of width 2^-m
+	{
+		const size_t m = 10, n = size_t(1) << m;
+		const molstat::SobolSequence sobol(
+			molstat::SobolSequence::max_dimension, engine);
+		assert(sobol.dimension() == molstat::SobolSequence::max_dimension);
+
+		vector<vector<double>> points(sobol.dimension(), vector<double>(n));
+		for(size_t d = 0; d < sobol.dimension(); ++d)
+		{
+			sobol.generate(0, n, d, points[d].data());
+
+			vector<size_t> counts(n, 0);
+			for(const double x : points[d])
+			{
+				assert(x > 0. && x < 1.);
+				++counts[size_t(x * n)];
+			}
+			for(const size_t c : counts)
+				assert(c == 1);
+
+			// generating in pieces gives the same points
+			vector<double> pieces(n);
+			sobol.generate(0, 300, d, pieces.data());
+			sobol.generate(300, n - 300, d, pieces.data() + 300);
+			assert(pieces == points[d]);
+		}
+
+		// the first two dimensions are also stratified together
+		vector<size_t> counts(n, 0);
+		for(size_t t = 0; t < n; ++t)
+			++counts[size_t(points[0][t] * 32) * 32 + size_t(points[1][t] * 32)];
+		for(const size_t c : counts)
+			assert(c == 1);
+
+		// the same engine gives the same shifts
+		vector<double> again(n);
+		molstat::SobolSequence(3, engine).generate(0, n, 2, again.data());
+		assert(again == points[2]);
+	}
+
+	for(const size_t dim : { size_t(0), molstat::SobolSequence::max_dimension
+		+ 1 })
+	{
+		try
+		{
+			molstat::SobolSequence(dim, engine);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// the standard normal quantile function, including far into the tails
+	for(const double u : { 1.e-300, 1.e-10, 0.01, 0.02425, 0.3, 0.5, 0.9,
+		0.99, 1. - 1.e-10 })
+	{
+		const double x{ molstat::standard_normal_quantile(u) };
+		assert(abs(normal_cdf(x) - u) <= 1.e-13 * min(u, 1. - u) + 1.e-16);
+	}
+
+	// truncated normal distributions, with the interval containing 0 and in
+	// the upper tail
+	for(const vector<double> &interval : vector<vector<double>>{ { -1., 1. },
+		{ 2., 5. }, { -7., -3. } })
+	{
+		const molstat::TruncatedNormalDistribution dist(1., 2.,
+			1. + 2.*interval[0], 1. + 2.*interval[1]);
+		assert(dist.hasQuantile());
+
+		const vector<double> u{ 0.001, 0.25, 0.5, 0.75, 0.999 };
+		vector<double> x(u.size());
+		dist.quantile_n(u.data(), x.data(), u.size());
+
+		const double pa{ normal_cdf(-interval[0]) },
+			pb{ normal_cdf(-interval[1]) };
+		for(size_t j = 0; j < u.size(); ++j)
+		{
+			// compare upper-tail probabilities, which are not small here
+			const double z{ (x[j] - 1.) / 2. };
+			assert(z >= interval[0] && z <= interval[1]);
+			assert(abs((pa - normal_cdf(-z)) / (pa - pb) - u[j]) <= 1.e-9);
+		}
+	}
+
+	// the empirical distribution skips bins without probability
+	{
+		const molstat::EmpiricalDistribution dist({ 0.5, 1.5, 2.5 },
+			{ 1., 0., 3. });
+		const vector<double> u{ 0.125, 0.5, 0.875 };
+		vector<double> x(u.size());
+		dist.quantile_n(u.data(), x.data(), u.size());
+
+		assert(abs(x[0] - 0.5) < 1.e-12);
+		assert(abs(x[1] - 2. - 1. / 3.) < 1.e-12);
+		assert(abs(x[2] - 2.5 - 1. / 3.) < 1.e-12);
+	}
+
+	// distributions without quantile functions
+	{
+		const molstat::GammaDistribution dist(2., 1.);
+		assert(!dist.hasQuantile());
+
+		const double u{ 0.5 };
+		double x;
+		try
+		{
+			dist.quantile_n(&u, &x, 1);
+			assert(false);
+		}
+		catch(const logic_error &e)
+		{
+			// should be here
+		}
+	}
+
+	// a composite model with uniform parameters and two submodels, each with
+	// correlated eps and gamma
+	{
+		const vector<shared_ptr<const molstat::RandomDistribution>> components
+			{ molstat::JointDistributionFactory(2,
+				molstat::tokenize("mvnormal 0.5 -1. 0.04 0.018 0.018 0.01")) };
+
+		molstat::SimulateModelFactory cfactory
+			{ molstat::SimulateModelFactory::makeFactory<CompositeTestModelAdd>() };
+		cfactory.setDistribution("ef",
+			make_shared<molstat::UniformDistribution>(-1., 1.));
+		cfactory.setDistribution("v",
+			make_shared<molstat::UniformDistribution>(0., 2.));
+		for(size_t k = 0; k < 2; ++k)
+		{
+			molstat::SimulateModelFactory subfactory
+				{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+			subfactory.setDistribution("eps", components[0]);
+			subfactory.setDistribution("gamma", components[1]);
+			cfactory.addSubmodel(subfactory.getModel());
+		}
+
+		molstat::Simulator sim{ cfactory.getModel() };
+		sim.setObservable(0, type_index{ typeid(BasicObs4) });
+		assert(sim.numQuasiRandomDimensions() == 6);
+
+		const molstat::SobolSequence sobol(sim.numQuasiRandomDimensions(),
+			engine);
+		const size_t n = 4096;
+		vector<double> out(n), workspace, params(6 * n);
+		assert(sim.simulateBatchQMC(sobol, 0, engine, n, out.data(), workspace,
+			nullptr, nullptr, params.data()) == n);
+
+		// the means are much more accurate than with random sampling (whose
+		// standard errors are about 0.01 for the uniform parameters)
+		const vector<string> names{ sim.getParameterNames() };
+		for(size_t p = 0; p < 6; ++p)
+		{
+			const double expected{ names[p] == "ef" ? 0. :
+				names[p] == "v" ? 1. : names[p] == "eps" ? 0.5 : -1. };
+			assert(abs(mean(params.data() + p, n, 6) - expected) < 1.e-3);
+		}
+
+		// the components of each submodel are correlated
+		for(size_t k = 0; k < 2; ++k)
+		{
+			const double *const eps{ params.data() + 2 + 2*k };
+			const double *const gamma{ eps + 1 };
+			const double meps{ mean(eps, n, 6) }, mgamma{ mean(gamma, n, 6) };
+			double cov{ 0. };
+			for(size_t t = 0; t < n; ++t)
+				cov += (eps[6*t] - meps) * (gamma[6*t] - mgamma);
+			assert(abs(cov / (n - 1) - 0.018) < 1.e-3);
+		}
+
+		// batches of consecutive points sample the same trials
+		vector<double> pieces(6 * n);
+		assert(sim.simulateBatchQMC(sobol, 0, engine, 1000, out.data(),
+			workspace, nullptr, nullptr, pieces.data()) == 1000);
+		assert(sim.simulateBatchQMC(sobol, 1000, engine, n - 1000, out.data(),
+			workspace, nullptr, nullptr, pieces.data() + 6000) == n - 1000);
+		for(size_t j = 0; j < 6 * n; ++j)
+			assert(abs(pieces[j] - params[j]) < 1.e-12);
+
+		// too few dimensions: the joint parameters come from the engine
+		const molstat::SobolSequence small(3, engine);
+		assert(sim.simulateBatchQMC(small, 0, engine, n, out.data(), workspace,
+			nullptr, nullptr, params.data()) == n);
+		for(size_t p = 0; p < 2; ++p)
+			assert(abs(mean(params.data() + p, n, 6) -
+				(names[p] == "ef" ? 0. : 1.)) < 1.e-3);
+
+		// a Latin hypercube has one trial in each stratum of each parameter
+		const size_t m = 1000;
+		assert(sim.simulateBatchLHS(engine, m, out.data(), workspace, nullptr,
+			nullptr, params.data()) == m);
+		for(size_t p = 0; p < 2; ++p)
+		{
+			const double lower{ names[p] == "ef" ? -1. : 0. };
+			vector<size_t> counts(m, 0);
+			for(size_t t = 0; t < m; ++t)
+				++counts[size_t((params[6*t + p] - lower) / 2. * m)];
+			for(const size_t c : counts)
+				assert(c == 1);
+		}
+
+		// including the first component of each joint distribution
+		for(size_t k = 0; k < 2; ++k)
+		{
+			vector<size_t> counts(m, 0);
+			for(size_t t = 0; t < m; ++t)
+				++counts[size_t(normal_cdf((params[6*t + 2 + 2*k] - 0.5) / 0.2)
+					* m)];
+			for(const size_t c : counts)
+				assert(c == 1);
+		}
+	}
+
+	// a pool of base variates is reused when the distribution changes
+	{
+		molstat::SimulateModelFactory factory
+			{ molstat::SimulateModelFactory::makeFactory<BasicTestModel>() };
+		factory.setDistribution("a",
+			make_shared<molstat::NormalDistribution>(0., 1.));
+		const shared_ptr<molstat::SimulateModel> model{ factory.getModel() };
+
+		molstat::Simulator sim{ model };
+		sim.setObservable(0, type_index{ typeid(BasicObs1) });
+		sim.setParameterPruning(false);
+
+		const size_t n = 1000;
+		const molstat::VariatePool pool(n, 1, engine);
+		assert(pool.size() == n && pool.dimension() == 1);
+		assert(pool.memoryUsage() >= n * sizeof(double));
+		vector<double> u(n), out(n), workspace, first(n), second(n);
+		pool.generate(0, n, 0, u.data());
+		for(const double x : u)
+			assert(x > 0. && x < 1.);
+
+		// each trial is the quantile of its base variate
+		assert(sim.simulateBatchPooled(pool, 0, engine, n, out.data(),
+			workspace, nullptr, nullptr, first.data()) == n);
+		for(size_t t = 0; t < n; ++t)
+			assert(abs(normal_cdf(first[t]) - u[t]) < 1.e-9);
+
+		// the same trials are sampled again after shifting and scaling the
+		// distribution, and batches of consecutive trials match
+		sim.setDistribution(*model, "a",
+			make_shared<molstat::NormalDistribution>(2., 0.5));
+		assert(sim.simulateBatchPooled(pool, 0, engine, 300, out.data(),
+			workspace, nullptr, nullptr, second.data()) == 300);
+		assert(sim.simulateBatchPooled(pool, 300, engine, n - 300, out.data(),
+			workspace, nullptr, nullptr, second.data() + 300) == n - 300);
+		for(size_t t = 0; t < n; ++t)
+			assert(abs(second[t] - (2. + 0.5 * first[t])) < 1.e-9);
+
+		// trials outside the pool
+		try
+		{
+			sim.simulateBatchPooled(pool, n - 10, engine, 20, out.data(),
+				workspace);
+			assert(false);
+		}
+		catch(const out_of_range &e)
+		{
+			// should be here
+		}
+	}
+
+	// with a cache, only the submodels whose parameters change are
+	// calculated again
+	{
+		molstat::SimulateModelFactory cfactory{ molstat::SimulateModelFactory::
+			makeFactory<CompositeTestModelMultiply>() };
+		cfactory.setDistribution("ef",
+			make_shared<molstat::UniformDistribution>(-1., 1.));
+		cfactory.setDistribution("v",
+			make_shared<molstat::UniformDistribution>(0., 2.));
+		vector<shared_ptr<molstat::SimulateModel>> submodels;
+		for(size_t k = 0; k < 2; ++k)
+		{
+			molstat::SimulateModelFactory subfactory{ molstat::
+				SimulateModelFactory::makeFactory<CompositeSubModel>() };
+			subfactory.setDistribution("eps",
+				make_shared<molstat::NormalDistribution>(0.5, 0.1));
+			subfactory.setDistribution("gamma",
+				make_shared<molstat::UniformDistribution>(0., 0.2));
+			submodels.emplace_back(subfactory.getModel());
+			cfactory.addSubmodel(submodels.back());
+		}
+		const shared_ptr<molstat::SimulateModel> model{ cfactory.getModel() };
+
+		molstat::Simulator sim{ model };
+		sim.setObservable(0, type_index{ typeid(BasicObs1) });
+
+		const size_t n = 1000;
+		const molstat::VariatePool pool(n, sim.numQuasiRandomDimensions(),
+			engine);
+		molstat::ContributionCache cache(sim, n);
+		assert(cache.size() == n && cache.memoryUsage() >= 6 * n *
+			sizeof(double));
+		vector<double> out(n), expected(n), workspace;
+
+		// the cached results match those without a cache
+		const auto check = [&] () -> void
+		{
+			assert(sim.simulateBatchPooled(pool, 0, engine, 400, out.data(),
+				workspace, nullptr, nullptr, nullptr, nullptr, &cache) == 400);
+			assert(sim.simulateBatchPooled(pool, 400, engine, n - 400,
+				out.data() + 400, workspace, nullptr, nullptr, nullptr, nullptr,
+				&cache) == n - 400);
+			assert(sim.simulateBatchPooled(pool, 0, engine, n, expected.data(),
+				workspace) == n);
+			for(size_t t = 0; t < n; ++t)
+				assert(out[t] == expected[t]);
+		};
+
+		// the first time, every term is calculated
+		check();
+		const size_t nterms{ cache.numCalculated() };
+		assert(nterms == 2 * n && cache.numReused() == 0);
+
+		// nothing changed
+		check();
+		assert(cache.numCalculated() == nterms && cache.numReused() == nterms);
+
+		// only the second submodel changed
+		sim.setDistribution(*submodels[1], "eps",
+			make_shared<molstat::NormalDistribution>(0.7, 0.2));
+		check();
+		assert(cache.numCalculated() == nterms + n);
+		assert(cache.numReused() == nterms + n);
+
+		// every submodel reads v
+		sim.setDistribution(*model, "v",
+			make_shared<molstat::UniformDistribution>(1., 2.));
+		check();
+		assert(cache.numCalculated() == 2 * nterms + n);
+		assert(cache.numReused() == nterms + n);
+
+		// trials outside the cache
+		molstat::ContributionCache small(sim, n / 2);
+		try
+		{
+			sim.simulateBatchPooled(pool, 0, engine, n, out.data(), workspace,
+				nullptr, nullptr, nullptr, nullptr, &small);
+			assert(false);
+		}
+		catch(const out_of_range &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file distributions_truncated.cc
+ * \brief Test suite for the truncated random distributions.
+ *
+ * \test Tests the truncated distributions (including intervals far into the
+ *    tails of the normal distribution) by checking that the samples are in
+ *    the interval and comparing sample means to their exact values, and
+ *    tests the `truncate` option of molstat::RandomDistributionFactory.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <general/string_tools.h>
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/truncated.h>
+
+using namespace std;
+
+/**
+ * \brief Exact mean of a truncated standard normal distribution.
+ *
+ * \param[in] a The lower bound.
+ * \param[in] b The upper bound.
+ * \return The mean.
+ */
+static double truncated_normal_mean(const double a, const double b)
+{
+	const double sqrt2{ sqrt(2.) }, sqrt2pi{ sqrt(2. * M_PI) };
+	const auto pdf = [sqrt2pi] (const double x) -> double
+	{
+		return isinf(x) ? 0. : exp(-0.5 * x * x) / sqrt2pi;
+	};
+
+	// use the complementary error function in the upper tail
+	const double mass{ a > 0. ? 0.5 * (erfc(a / sqrt2) - erfc(b / sqrt2)) :
+		0.5 * (erf(b / sqrt2) - erf(a / sqrt2)) };
+
+	return (pdf(a) - pdf(b)) / mass;
+}
+
+/**
+ * \brief Samples a distribution and checks the samples against an interval
+ *    and, optionally, an exact mean.
+ *
+ * \param[in] dist The distribution.
+ * \param[in] lower The lower bound of the interval.
+ * \param[in] upper The upper bound of the interval.
+ * \param[in] mean The exact mean (NaN to skip this check).
+ * \param[in] tol The tolerance for the mean.
+ * \param[in,out] engine The random number engine.
+ */
+static void check(const molstat::RandomDistribution &dist, const double lower,
+	const double upper, const double mean, const double tol,
+	molstat::Engine &engine)
+{
+	const size_t n = 200000;
+	vector<double> samples(n);
+	dist.sample_n(engine, samples.data(), n);
+
+	double smean{ 0. };
+	for(const double x : samples)
+	{
+		assert(x >= lower && x <= upper);
+		smean += x;
+	}
+	smean /= n;
+
+	if(!isnan(mean))
+		assert(abs(smean - mean) <= tol);
+
+	for(size_t j = 0; j < 1000; ++j)
+	{
+		const double x{ dist.sample(engine) };
+		assert(x >= lower && x <= upper);
+	}
+}
+
+/**
+ * \brief Main function for testing the truncated distributions.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	molstat::Engine engine{ 0xFEEDFACE };
+	const double inf{ numeric_limits<double>::infinity() };
+
+	// truncated normal distributions, covering each of the samplers: a wide
+	// and a narrow interval containing the mean, a narrow interval above the
+	// mean, an interval far into the upper tail, and an interval far into the
+	// lower tail
+	{
+		const vector<vector<double>> intervals{ { -1., 2. }, { -0.3, 0.4 },
+			{ 0.5, 0.6 }, { 6., inf }, { -9., -7. } };
+		const double mean{ 1. }, stdev{ 0.5 };
+
+		for(const vector<double> &ab : intervals)
+		{
+			const double lower{ mean + stdev * ab[0] },
+				upper{ mean + stdev * ab[1] };
+
+			// the standard deviation of the truncated distribution is at most
+			// stdev
+			check(molstat::TruncatedNormalDistribution(mean, stdev, lower, upper),
+				lower, upper, mean + stdev * truncated_normal_mean(ab[0], ab[1]),
+				5. * stdev / sqrt(200000.), engine);
+		}
+	}
+
+	// truncated lognormal distribution; a non-positive lower bound is no
+	// truncation from below
+	check(molstat::TruncatedLognormalDistribution(0., 1., 0.5, 3.), 0.5, 3.,
+		exp(0.5) * (erf((1. - log(0.5)) / sqrt(2.)) -
+			erf((1. - log(3.)) / sqrt(2.))) /
+		(erf(log(3.) / sqrt(2.)) - erf(log(0.5) / sqrt(2.))), 0.01, engine);
+	check(molstat::TruncatedLognormalDistribution(0., 1., -1., 2.), 0., 2.,
+		numeric_limits<double>::quiet_NaN(), 0., engine);
+
+	// the factory
+	{
+		auto dist = molstat::RandomDistributionFactory(
+			molstat::tokenize("normal 0. 1. truncate 0 inf"));
+		assert(dynamic_cast<molstat::TruncatedNormalDistribution*>(dist.get())
+			!= nullptr);
+		check(*dist, 0., inf, sqrt(2. / M_PI), 0.01, engine);
+
+		// uniform: the intersection of the intervals
+		dist = molstat::RandomDistributionFactory(
+			molstat::tokenize("uniform -1. 1. TRUNCATE 0. 5."));
+		check(*dist, 0., 1., 0.5, 0.01, engine);
+
+		// gamma: rejection
+		dist = molstat::RandomDistributionFactory(
+			molstat::tokenize("gamma 2. 1. truncate 1. 3."));
+		assert(dynamic_cast<molstat::TruncatedDistribution*>(dist.get())
+			!= nullptr);
+		check(*dist, 1., 3., numeric_limits<double>::quiet_NaN(), 0., engine);
+
+		dist = molstat::RandomDistributionFactory(
+			molstat::tokenize("lognormal 0. 1. truncate -inf 1."));
+		check(*dist, 0., 1., numeric_limits<double>::quiet_NaN(), 0., engine);
+
+		// constant: in the interval
+		double value;
+		dist = molstat::RandomDistributionFactory(
+			molstat::tokenize("constant 2. truncate 0. 5."));
+		assert(dist->isConstant(value) && value == 2.);
+	}
+
+	// invalid truncations
+	for(const string line : { "constant 2. truncate 3. 5.",
+		"uniform 0. 1. truncate 2. 3.", "normal 0. 1. truncate 1. 0.",
+		"normal 0. 1. truncate 1.", "normal 0. 1. truncate a b",
+		"lognormal 0. 1. truncate -2. -1." })
+	{
+		try
+		{
+			molstat::RandomDistributionFactory(molstat::tokenize(line));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// rejection from an interval with (almost) no probability
+	try
+	{
+		molstat::RandomDistributionFactory(
+			molstat::tokenize("gamma 1. 1. truncate -2. -1."))->sample(engine);
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file dual.cc
+ * \brief Test suite for the dual numbers used for automatic
+ *    differentiation.
+ *
+ * \test Tests the arithmetic and math functions of molstat::Dual against
+ *    analytic derivatives.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <general/fitter_tools/dual.h>
+
+using namespace std;
+
+/// Shortcut for dual numbers with two variables.
+using Dual2 = molstat::Dual<2>;
+
+/**
+ * \brief A function of two variables, written for both doubles and dual
+ *    numbers.
+ *
+ * \tparam T The type of the variables.
+ * \param[in] x The first variable.
+ * \param[in] y The second variable.
+ * \return The function value.
+ */
+template<typename T>
+T test_function(const T &x, const T &y)
+{
+	using std::exp;
+	using std::sqrt;
+
+	return x * y / (1. + x) - 2. * exp(-x * y) + sqrt(y) - 3. / x - y;
+}
+
+/**
+ * \brief Main function for testing the dual numbers.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-12;
+	constexpr double x0 = 0.7, y0 = 1.3;
+
+	const Dual2 x{ Dual2::variable(x0, 0) }, y{ Dual2::variable(y0, 1) };
+
+	// constants have no gradient
+	{
+		const Dual2 c{ 4. };
+		assert(c.value == 4. && c.grad[0] == 0. && c.grad[1] == 0.);
+	}
+
+	// the function agrees with its double version, and the gradient with
+	// the analytic one
+	{
+		const Dual2 f{ test_function(x, y) };
+		assert(abs(f.value - test_function(x0, y0)) < thresh);
+
+		const double dfdx{ y0 / ((1. + x0) * (1. + x0)) +
+			2. * y0 * exp(-x0 * y0) + 3. / (x0 * x0) };
+		const double dfdy{ x0 / (1. + x0) + 2. * x0 * exp(-x0 * y0) +
+			0.5 / sqrt(y0) - 1. };
+		assert(abs(f.grad[0] - dfdx) < thresh);
+		assert(abs(f.grad[1] - dfdy) < thresh);
+	}
+
+	// the other math functions
+	{
+		Dual2 f{ log(x) };
+		assert(abs(f.value - log(x0)) < thresh);
+		assert(abs(f.grad[0] - 1. / x0) < thresh && f.grad[1] == 0.);
+
+		f = pow(y, 2.5);
+		assert(abs(f.value - pow(y0, 2.5)) < thresh);
+		assert(abs(f.grad[1] - 2.5 * pow(y0, 1.5)) < thresh);
+
+		f = sin(x * y);
+		assert(abs(f.grad[0] - y0 * cos(x0 * y0)) < thresh);
+		assert(abs(f.grad[1] - x0 * cos(x0 * y0)) < thresh);
+
+		f = cos(x);
+		assert(abs(f.grad[0] + sin(x0)) < thresh);
+
+		f = atan(y);
+		assert(abs(f.grad[1] - 1. / (1. + y0 * y0)) < thresh);
+
+		f = erf(x);
+		assert(abs(f.value - erf(x0)) < thresh);
+		assert(abs(f.grad[0] - 2. / sqrt(acos(-1.)) * exp(-x0 * x0)) < thresh);
+
+		f = abs(-x);
+		assert(abs(f.value - x0) < thresh && abs(f.grad[0] - 1.) < thresh);
+	}
+
+	// compound assignment
+	{
+		Dual2 f{ x };
+		f *= y;
+		f -= 1.;
+		f /= y;
+		f += x;
+		// f = 2x - 1/y
+		assert(abs(f.value - (2. * x0 - 1. / y0)) < thresh);
+		assert(abs(f.grad[0] - 2.) < thresh);
+		assert(abs(f.grad[1] - 1. / (y0 * y0)) < thresh);
+	}
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file engine_streams.cc
+ * \brief Test suite for the random number engines.
+ *
+ * \test Tests molstat::Engine for each kind: reproducibility, independent
+ *    streams, discard, saving the state, and use with the standard library distributions.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <general/random_distributions/engine.h>
+
+using namespace std;
+
+/**
+ * \brief Tests an engine kind.
+ *
+ * \param[in] kind The kind of engine.
+ */
+static void test_kind(const molstat::EngineKind kind)
+{
+	constexpr size_t n = 1000;
+
+	molstat::Engine e1{ 12345, kind }, e2{ 12345, kind }, e3{ 54321, kind };
+	assert(e1.kind() == kind);
+	assert(e1.info() == molstat::EngineKindName(kind));
+
+	// the same seed gives the same sequence; a different seed does not
+	{
+		size_t nsame{ 0 };
+		for(size_t j = 0; j < n; ++j)
+		{
+			const molstat::Engine::result_type x{ e1() };
+			assert(x == e2());
+			if(x == e3())
+				++nsame;
+		}
+		assert(nsame == 0);
+	}
+
+	// a saved state continues the sequence (Philox4x32 mid-block, too)
+	for(size_t skip : { 0, 1, 2 })
+	{
+		molstat::Engine a{ 31415, 2, kind };
+		for(size_t j = 0; j < skip; ++j)
+			a();
+
+		stringstream state;
+		state << a;
+		molstat::Engine b;
+		state >> b;
+		assert(state && b.kind() == kind);
+		for(size_t j = 0; j < 10; ++j)
+			assert(a() == b());
+
+		// a corrupt state is rejected and leaves the engine unchanged
+		stringstream bad{ "7 1 2 3" };
+		const molstat::Engine c{ b };
+		bad >> b;
+		assert(bad.fail());
+		assert(b() == molstat::Engine(c)());
+	}
+
+	// discard is equivalent to generating and ignoring values; check several
+	// offsets (Philox4x32 produces values in pairs)
+	for(unsigned long long skip : { 0ull, 1ull, 2ull, 3ull, 17ull, 1000ull })
+	{
+		molstat::Engine a{ 777, kind }, b{ 777, kind };
+		a();
+		b();
+		for(unsigned long long j = 0; j < skip; ++j)
+			a();
+		b.discard(skip);
+		for(size_t j = 0; j < 10; ++j)
+			assert(a() == b());
+	}
+
+	// streams: jump and stream agree, are reproducible, and differ both from
+	// each other and from the base engine
+	{
+		const molstat::Engine base{ 2014, kind };
+		molstat::Engine jumped{ base };
+		jumped.jump(2);
+
+		molstat::Engine s0{ base.stream(0) }, s1{ base.stream(1) },
+			s2{ base.stream(2) }, s2b{ base.stream(1).stream(1) },
+			b{ base };
+
+		size_t nsame{ 0 };
+		for(size_t j = 0; j < n; ++j)
+		{
+			const molstat::Engine::result_type x0{ s0() }, x1{ s1() },
+				x2{ s2() };
+			assert(x0 == b());
+			assert(x2 == jumped());
+			assert(x2 == s2b());
+			if(x0 == x1 || x1 == x2 || x0 == x2)
+				++nsame;
+		}
+		assert(nsame == 0);
+	}
+
+	// substreams are reproducible and differ from each other
+	{
+		molstat::Engine a{ 2014, 0, kind }, a2{ 2014, 0, kind },
+			b{ 2014, 1, kind };
+		size_t nsame{ 0 };
+		for(size_t j = 0; j < n; ++j)
+		{
+			const molstat::Engine::result_type x{ a() };
+			assert(x == a2());
+			if(x == b())
+				++nsame;
+		}
+		assert(nsame == 0);
+	}
+
+	// the engine works with the standard library distributions
+	{
+		molstat::Engine e{ 99, kind };
+		normal_distribution<double> dist{ 1., 2. };
+		uniform_real_distribution<double> udist{ 0., 1. };
+		double mean{ 0. }, umean{ 0. };
+		constexpr size_t nsamples = 100000;
+
+		for(size_t j = 0; j < nsamples; ++j)
+		{
+			mean += dist(e);
+
+			const double u{ udist(e) };
+			assert(u >= 0. && u < 1.);
+			umean += u;
+		}
+		mean /= nsamples;
+		umean /= nsamples;
+
+		assert(abs(mean - 1.) < 5. * 2. / sqrt(nsamples));
+		assert(abs(umean - 0.5) < 5. * sqrt(1. / 12. / nsamples));
+	}
+}
+
+/**
+ * \brief Main function for testing the random number engines.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	test_kind(molstat::EngineKind::Xoshiro256pp);
+	test_kind(molstat::EngineKind::PCG64);
+	test_kind(molstat::EngineKind::Philox4x32);
+
+	// different kinds give different sequences from the same seed
+	{
+		molstat::Engine x{ 1, molstat::EngineKind::Xoshiro256pp },
+			p{ 1, molstat::EngineKind::PCG64 },
+			c{ 1, molstat::EngineKind::Philox4x32 };
+		const molstat::Engine::result_type vx{ x() }, vp{ p() }, vc{ c() };
+		assert(vx != vp && vp != vc && vx != vc);
+	}
+
+	// the default engine
+	{
+		molstat::Engine d1, d2{ molstat::Engine::default_seed };
+		assert(d1.kind() == molstat::Engine::default_kind);
+		assert(d1() == d2());
+	}
+
+	// names
+	assert(molstat::EngineKindFromName("xoshiro256++")
+		== molstat::EngineKind::Xoshiro256pp);
+	assert(molstat::EngineKindFromName("PCG64") == molstat::EngineKind::PCG64);
+	assert(molstat::EngineKindFromName("pcg") == molstat::EngineKind::PCG64);
+	assert(molstat::EngineKindFromName("Philox")
+		== molstat::EngineKind::Philox4x32);
+	try
+	{
+		molstat::EngineKindFromName("mt19937");
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
@@ -0,0 +1,231 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file evaluation_plan.cc
+ * \brief Test suite for the flat evaluation plans of observables.
+ *
+ * \test Tests molstat::EvaluationPlan for composite models combined by
+ *    addition, multiplication, and a general operation, with submodels that
+ *    do not always produce the observable, comparing against the batch
+ *    functions of the observables.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <typeinfo>
+#include <typeindex>
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/evaluation_plan.h>
+#include <general/simulator_tools/simulate_model.h>
+#include <general/simulator_tools/simulator_exceptions.h>
+
+/// Dummy composite model class using the maximum to combine submodels.
+class CompositeTestModelMax
+	: public CompositeTestModel
+{
+public:
+	/// Constructor that specifies how to combine two submodels.
+	CompositeTestModelMax() :
+		CompositeTestModel(
+			[] (double a, double b) -> double
+			{
+				return std::max(a, b);
+			}
+		) {}
+};
+
+/// Submodel whose observable is only produced for negative eps.
+class RejectSubModel
+	: public TestSubmodelType,
+	  public BasicObs1
+{
+protected:
+	virtual vector<string> get_names() const override
+	{
+		return { "eps" };
+	}
+
+public:
+	virtual double Obs1(const valarray<double> &params) const override
+	{
+		return params[2] < 0. ? params[1] * params[2] :
+			molstat::NoObservableValue;
+	}
+};
+
+/**
+ * \brief Makes a composite model with three submodels, the second of which
+ *    does not always produce the observable.
+ *
+ * \tparam T The composite model.
+ * \return The model.
+ */
+template<typename T>
+shared_ptr<molstat::SimulateModel> make_model()
+{
+	molstat::SimulateModelFactory cfactory
+		{ molstat::SimulateModelFactory::makeFactory<T>() };
+	cfactory.setDistribution("ef",
+		make_shared<molstat::UniformDistribution>(-1., 1.));
+	cfactory.setDistribution("v",
+		make_shared<molstat::UniformDistribution>(0., 2.));
+
+	for(size_t k = 0; k < 3; ++k)
+	{
+		if(k == 1)
+		{
+			molstat::SimulateModelFactory subfactory
+				{ molstat::SimulateModelFactory::makeFactory<RejectSubModel>() };
+			subfactory.setDistribution("eps",
+				make_shared<molstat::UniformDistribution>(-1., 3.));
+			cfactory.addSubmodel(subfactory.getModel());
+		}
+		else
+		{
+			molstat::SimulateModelFactory subfactory
+				{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+			subfactory.setDistribution("eps",
+				make_shared<molstat::UniformDistribution>(-5., 5.));
+			subfactory.setDistribution("gamma",
+				make_shared<molstat::UniformDistribution>(0.1, 1.));
+			cfactory.addSubmodel(subfactory.getModel());
+		}
+	}
+
+	return cfactory.getModel();
+}
+
+/**
+ * \brief Checks that a plan gives the same values as the batch functions of
+ *    the observables.
+ *
+ * \param[in] model The model.
+ * \param[in] engine The random number engine.
+ * \return The plan of BasicObs1 and BasicObs4.
+ */
+molstat::EvaluationPlan check_plan(
+	shared_ptr<molstat::SimulateModel> model, molstat::Engine &engine)
+{
+	constexpr size_t ntrials = 1000;
+	const vector<molstat::ObservableIndex> obs{
+		type_index{ typeid(BasicObs1) }, type_index{ typeid(BasicObs4) } };
+
+	const size_t nparams{ model->get_num_parameters() };
+	vector<double> params(nparams * ntrials);
+	model->generateParameterBatch(engine, ntrials, params.data());
+
+	vector<const double *> rows(nparams);
+	for(size_t p = 0; p < nparams; ++p)
+		rows[p] = params.data() + p*ntrials;
+
+	molstat::EvaluationPlan plan(*model, obs);
+	assert(plan.numObservables() == obs.size());
+	vector<double> scratch(plan.numScratch() * ntrials);
+
+	for(size_t j = 0; j < obs.size(); ++j)
+	{
+		vector<double> expected(ntrials), out(ntrials);
+		model->getBatchObservableFunction(obs[j])(rows.data(), nparams,
+			ntrials, expected.data());
+		plan.evaluate(j, rows.data(), ntrials, out.data(), scratch.data());
+
+		// the operations are applied in the same order
+		size_t nproduced{ 0 };
+		for(size_t t = 0; t < ntrials; ++t)
+		{
+			if(std::isnan(expected[t]))
+				assert(std::isnan(out[t]));
+			else
+			{
+				assert(out[t] == expected[t]);
+				++nproduced;
+			}
+		}
+
+		// the second submodel does not always produce BasicObs1
+		if(j == 0)
+			assert(nproduced > 0 && nproduced < ntrials);
+		else
+			assert(nproduced == ntrials);
+	}
+
+	return plan;
+}
+
+/**
+ * \brief Main function for testing the evaluation plans.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	molstat::Engine engine{ 5489, 0, molstat::EngineKind::Xoshiro256pp };
+	using StepType = molstat::EvaluationPlan::StepType;
+
+	// addition: the composite observable has a kernel for each submodel,
+	// combined through one scratch register; BasicObs4 is one kernel
+	{
+		const molstat::EvaluationPlan plan
+			{ check_plan(make_model<CompositeTestModelAdd>(), engine) };
+		assert(plan.numKernels() == 4);
+		assert(plan.numScratch() == 1);
+
+		const vector<StepType> types{ StepType::Kernel, StepType::Kernel,
+			StepType::Add, StepType::Kernel, StepType::Add, StepType::Kernel };
+		const vector<molstat::EvaluationPlan::Step> &steps = plan.getSteps();
+		assert(steps.size() == types.size());
+		for(size_t s = 0; s < steps.size(); ++s)
+		{
+			assert(steps[s].type == types[s]);
+			assert(steps[s].dst == (types[s] == StepType::Kernel &&
+				(s == 1 || s == 3) ? 1 : 0));
+		}
+	}
+
+	// multiplication
+	{
+		const molstat::EvaluationPlan plan
+			{ check_plan(make_model<CompositeTestModelMultiply>(), engine) };
+		assert(plan.getSteps()[2].type == StepType::Multiply);
+	}
+
+	// a general operation
+	{
+		const molstat::EvaluationPlan plan
+			{ check_plan(make_model<CompositeTestModelMax>(), engine) };
+		assert(plan.getSteps()[2].type == StepType::Combine);
+	}
+
+	// an empty plan
+	{
+		const molstat::EvaluationPlan plan;
+		assert(plan.numObservables() == 0);
+		assert(plan.numScratch() == 0);
+	}
+
+	// incompatible observables
+	try
+	{
+		molstat::EvaluationPlan plan(*make_model<CompositeTestModelAdd>(),
+			{ type_index{ typeid(BasicObs2) } });
+		assert(false);
+	}
+	catch(const molstat::IncompatibleObservable &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
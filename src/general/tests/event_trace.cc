@@ -0,0 +1,94 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/event_trace.cc
+ * \brief Test suite for the trace events.
+ *
+ * \test Tests that molstat::TraceEvent records nested events from several
+ *    threads, and that they are written in the Chrome trace format. The
+ *    events are used directly, so that the test does not depend on
+ *    `--enable-event-trace`.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <general/event_trace.h>
+
+using namespace std;
+
+/**
+ * \brief Counts the occurrences of a substring.
+ *
+ * \param[in] str The string.
+ * \param[in] sub The substring.
+ * \return The number of occurrences.
+ */
+static size_t count_of(const string &str, const string &sub)
+{
+	size_t ret{ 0 };
+
+	for(size_t pos = str.find(sub); pos != string::npos;
+		pos = str.find(sub, pos + 1))
+		++ret;
+
+	return ret;
+}
+
+/**
+ * \brief Main function for testing the trace events.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	{
+		const molstat::TraceEvent outer{ "outer" };
+		const molstat::TraceEvent inner{ "inner \"quoted\"" };
+	}
+
+	vector<thread> threads;
+	for(size_t t = 0; t < 2; ++t)
+		threads.emplace_back([] () -> void
+			{
+				const molstat::TraceEvent event{ "worker" };
+			});
+	for(thread &th : threads)
+		th.join();
+
+	// the macro records an event only when tracing is enabled
+	{
+		MOLSTAT_TRACE_EVENT("macro");
+	}
+
+	ostringstream out;
+	molstat::WriteEventTrace(out);
+	const string trace{ out.str() };
+
+	assert(trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+	assert(trace.rfind("]}\n") == trace.size() - 3);
+
+	const size_t nmacro{ count_of(trace, "\"name\":\"macro\"") };
+	assert(nmacro == HAVE_EVENT_TRACE);
+	assert(count_of(trace, "\"ph\":\"X\"") == 4 + nmacro);
+	assert(count_of(trace, "\"name\":\"outer\"") == 1);
+	assert(count_of(trace, "\"name\":\"inner \\\"quoted\\\"\"") == 1);
+	assert(count_of(trace, "\"name\":\"worker\"") == 2);
+
+	// each thread has its own number
+	assert(count_of(trace, "\"tid\":0}") == 2 + nmacro);
+	assert(count_of(trace, "\"tid\":1}") == 1);
+	assert(count_of(trace, "\"tid\":2}") == 1);
+
+	return 0;
+}
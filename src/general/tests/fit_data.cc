@@ -0,0 +1,187 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file fit_data.cc
+ * \brief Test suite for reading the data to fit.
+ *
+ * \test Tests molstat::ReadDataColumns and molstat::ReadFitData, including
+ *    comments, blank lines, missing final newlines, malformed lines, and
+ *    binary and mergeable histograms (with the weights of their counts).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <general/fitter_tools/fit_data.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/histogram_io.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Checks that reading malformed data throws an exception.
+ *
+ * \param[in] text The data.
+ * \param[in] ncol The number of numbers per line.
+ */
+void check_error(const string &text, size_t ncol)
+{
+	istringstream in{ text };
+
+	try
+	{
+		molstat::ReadDataColumns(in, ncol);
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+}
+
+/**
+ * \brief Main function for testing the data reader.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-12;
+
+	// the simulator's output, with comments, blank lines, windows line
+	// endings, and no newline at the end
+	{
+		istringstream in{ "# g pdf\n0.25 1\n\n  0.5\t2.e3  # comment\r\n"
+			"\t\n1e-2 -3.5" };
+		const auto data = molstat::ReadFitData<1>(in);
+
+		// no spurious points at EOF
+		assert(data.size() == 3);
+
+		auto iter = data.begin();
+		assert(abs(iter->first[0] - 0.25) < thresh);
+		assert(abs(iter->second - 1.) < thresh);
+		++iter;
+		assert(abs(iter->first[0] - 0.5) < thresh);
+		assert(abs(iter->second - 2000.) < thresh);
+		++iter;
+		assert(abs(iter->first[0] - 0.01) < thresh);
+		assert(abs(iter->second + 3.5) < thresh);
+	}
+
+	// two independent variables
+	{
+		istringstream in{ "1 2 3\n4 5 6\n" };
+		const auto data = molstat::ReadFitData<2>(in);
+
+		assert(data.size() == 2);
+		assert(data.back().first[0] == 4. && data.back().first[1] == 5.);
+		assert(data.back().second == 6.);
+	}
+
+	// empty data
+	{
+		istringstream in{ "\n# nothing\n" };
+		assert(molstat::ReadFitData<1>(in).size() == 0);
+	}
+
+	// binary histograms
+	{
+		shared_ptr<molstat::BinStyle> bx{ make_shared<molstat::BinLinear>(2) },
+			by{ make_shared<molstat::BinLinear>(3) };
+		bx->setBounds(0., 1.);
+		by->setBounds(0., 3.);
+		const vector<shared_ptr<const molstat::BinStyle>> styles{ bx, by };
+
+		molstat::Histogram hist(styles);
+		hist.add_data({ 0.75, 2.5 });
+		hist.add_data({ 0.75, 2.5 });
+
+		ostringstream out;
+		molstat::WriteHistogramBinary(out, hist, styles, 2, 2);
+
+		istringstream in{ out.str() };
+		vector<double> weights;
+		const auto data = molstat::ReadFitData<2>(in, &weights);
+		assert(data.size() == 6);
+		assert(weights == vector<double>(6, 1.));
+
+		// the first dimension changes the fastest
+		assert(abs(data.front().first[0] - 0.25) < 1.e-12);
+		assert(abs(data.front().first[1] - 0.5) < 1.e-12);
+		assert(abs(data.back().first[0] - 0.75) < 1.e-12);
+		assert(abs(data.back().first[1] - 2.5) < 1.e-12);
+		assert(data.back().second > 0.);
+		assert(data.front().second == 0.);
+
+		// the dimensionality must match
+		istringstream in1{ out.str() };
+		try
+		{
+			molstat::ReadFitData<1>(in1);
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+	}
+
+	// mergeable histograms: the weights recover the raw counts
+	{
+		shared_ptr<molstat::BinStyle> blog{ make_shared<molstat::BinLog>(4,
+			10.) };
+		blog->setBounds(1.e-4, 1.);
+		const vector<shared_ptr<const molstat::BinStyle>> styles{ blog };
+
+		molstat::Histogram hist(styles);
+		for(const double g : { 2.e-4, 2.e-4, 0.003, 0.5, 0.5, 0.5 })
+			hist.add_data({ g });
+
+		ostringstream out;
+		molstat::WriteHistogramMergeable(out,
+			molstat::MakeMergeableHistogram(hist, styles, 6, 6));
+
+		istringstream in{ out.str() };
+		vector<double> weights;
+		const auto data = molstat::ReadFitData<1>(in, &weights);
+		assert(data.size() == 4 && weights.size() == 4);
+
+		const vector<size_t> raw{ hist.getRawBinCounts() };
+		auto point = data.begin();
+		for(size_t j = 0; j < 4; ++j, ++point)
+		{
+			assert(weights[j] != 1.);
+			assert(abs(point->second / weights[j] - raw[j]) < thresh);
+		}
+	}
+
+	// text data are taken to be counts
+	{
+		istringstream in{ "0.1 3\n0.2 4\n" };
+		vector<double> weights;
+		molstat::ReadFitData<1>(in, &weights);
+		assert(weights == vector<double>(2, 1.));
+	}
+
+	// malformed lines
+	check_error("0.1 1\n0.2\n", 2);
+	check_error("0.1 1\n0.2", 2);
+	check_error("0.1 1 2\n", 2);
+	check_error("0.1 abc\n", 2);
+	check_error("0.1 1.5x\n", 2);
+	check_error("0.1,1\n", 2);
+
+	return 0;
+}
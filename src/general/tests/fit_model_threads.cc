@@ -0,0 +1,238 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file fit_model_threads.cc
+ * \brief Test suite for evaluating the residuals and Jacobian of a fit in
+ *    parallel.
+ *
+ * \test Tests that molstat::FitModel::f, molstat::FitModel::df, and
+ *    molstat::FitModel::fdf give the same results for any number of threads
+ *    (or with a molstat::TaskScheduler), and that they do not allocate memory
+ *    when evaluated serially. Also
+ *    tests the derived quantities of the data points.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <general/fitter_tools/fit_model_interface.h>
+
+using namespace std;
+
+/// The number of heap allocations made by the program.
+static size_t nallocations = 0;
+
+/**
+ * \brief Counts the heap allocations.
+ *
+ * \param[in] size The number of bytes to allocate.
+ * \return The allocated memory.
+ */
+void *operator new(size_t size)
+{
+	++nallocations;
+	void *ret{ malloc(size == 0 ? 1 : size) };
+	if(ret == nullptr)
+		throw bad_alloc();
+
+	return ret;
+}
+
+/**
+ * \brief Frees memory allocated by the counting operator new.
+ *
+ * \param[in] ptr The memory.
+ */
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+/**
+ * \brief Fit model for \f$f(x) = ax^2 + b\f$, with \f$x^2\f$ derived from
+ *    each point.
+ */
+class QuadraticFitModel
+	: public molstat::FitModel<1>
+{
+protected:
+	virtual vector<double> create_initial_guess(
+		const map<string, double> &values) const override
+	{
+		return { values.at("a"), values.at("b") };
+	}
+
+public:
+	QuadraticFitModel(const list<pair<array<double, 1>, double>> &data)
+		: molstat::FitModel<1>(2, data)
+	{
+		set_derived(1, [] (const array<double, 1> &x, double *d) -> void
+			{
+				d[0] = x[0] * x[0];
+			});
+	}
+
+	/**
+	 * \brief Gets \f$x^2\f$ for a point.
+	 *
+	 * \param[in] x The point.
+	 * \return \f$x^2\f$.
+	 */
+	double square(const array<double, 1> &x) const
+	{
+		return derived(x)[0];
+	}
+
+	virtual double resid(const vector<double> &fitparam,
+		const array<double, 1> &x, const double f) const override
+	{
+		return fitparam[0] * square(x) + fitparam[1] - f;
+	}
+
+	virtual void jacobian_row(const vector<double> &fitparam,
+		const array<double, 1> &x, const double f, double *jac) const override
+	{
+		jac[0] = square(x);
+		jac[1] = 1.;
+	}
+
+	virtual void append_default_guesses(list<vector<double>> &guess)
+		const override
+	{
+		guess.push_back({ 1., 0. });
+	}
+
+	virtual void print_fit(ostream &out, const vector<double> &fitparam)
+		const override
+	{
+		out << fitparam[0] << ' ' << fitparam[1];
+	}
+};
+
+/**
+ * \brief Main function for testing the parallel evaluation.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	constexpr size_t npoints = 101;
+	list<pair<array<double, 1>, double>> data;
+	for(size_t i = 0; i < npoints; ++i)
+	{
+		const double x{ 0.01 * i };
+		data.push_back({ { x }, exp(x) });
+	}
+
+	QuadraticFitModel model(data);
+	gsl_vector *x = gsl_vector_alloc(2);
+	gsl_vector_set(x, 0, 1.5);
+	gsl_vector_set(x, 1, -0.5);
+
+	gsl_vector *f1 = gsl_vector_alloc(npoints), *f2 = gsl_vector_alloc(npoints);
+	gsl_matrix *J1 = gsl_matrix_alloc(npoints, 2),
+		*J2 = gsl_matrix_alloc(npoints, 2);
+
+	// serial
+	molstat::FitModel<1>::fdf(x, &model, f1, J1);
+	for(size_t i = 0; i < npoints; ++i)
+	{
+		const double xi{ 0.01 * i };
+		assert(abs(gsl_vector_get(f1, i) - (1.5*xi*xi - 0.5 - exp(xi)))
+			< 1.e-12);
+		assert(abs(gsl_matrix_get(J1, i, 0) - xi*xi) < 1.e-12);
+	}
+
+	// the derived quantities of a point that is not in the data
+	assert(model.square({ 3. }) == 9.);
+
+	// several threads, including more threads than data points
+	for(const size_t nthreads : { 2, 7, 200 })
+	{
+		model.set_num_threads(nthreads);
+
+		molstat::FitModel<1>::f(x, &model, f2);
+		for(size_t i = 0; i < npoints; ++i)
+			assert(gsl_vector_get(f1, i) == gsl_vector_get(f2, i));
+
+		molstat::FitModel<1>::df(x, &model, J2);
+		for(size_t i = 0; i < npoints; ++i)
+			for(size_t j = 0; j < 2; ++j)
+				assert(gsl_matrix_get(J1, i, j) == gsl_matrix_get(J2, i, j));
+
+		gsl_vector_set_zero(f2);
+		gsl_matrix_set_zero(J2);
+		molstat::FitModel<1>::fdf(x, &model, f2, J2);
+		for(size_t i = 0; i < npoints; ++i)
+		{
+			assert(gsl_vector_get(f1, i) == gsl_vector_get(f2, i));
+			for(size_t j = 0; j < 2; ++j)
+				assert(gsl_matrix_get(J1, i, j) == gsl_matrix_get(J2, i, j));
+		}
+	}
+
+	// the workers of a scheduler, also from within the scheduler's tasks
+	{
+		molstat::TaskScheduler scheduler{ 3 };
+		model.set_scheduler(&scheduler);
+
+		gsl_vector_set_zero(f2);
+		gsl_matrix_set_zero(J2);
+		molstat::FitModel<1>::fdf(x, &model, f2, J2);
+		for(size_t i = 0; i < npoints; ++i)
+		{
+			assert(gsl_vector_get(f1, i) == gsl_vector_get(f2, i));
+			for(size_t j = 0; j < 2; ++j)
+				assert(gsl_matrix_get(J1, i, j) == gsl_matrix_get(J2, i, j));
+		}
+
+		gsl_vector_set_zero(f2);
+		scheduler.run(2, [&x, &model, f2] (size_t j, size_t) -> void
+			{
+				if(j == 0)
+					molstat::FitModel<1>::f(x, &model, f2);
+			});
+		for(size_t i = 0; i < npoints; ++i)
+			assert(gsl_vector_get(f1, i) == gsl_vector_get(f2, i));
+
+		model.set_scheduler(nullptr);
+	}
+
+	// after the first calls, serial evaluation does not allocate memory
+	model.set_num_threads(1);
+	{
+		const size_t before{ nallocations };
+		molstat::FitModel<1>::f(x, &model, f2);
+		molstat::FitModel<1>::df(x, &model, J2);
+		molstat::FitModel<1>::fdf(x, &model, f2, J2);
+		assert(nallocations == before);
+	}
+
+	try
+	{
+		model.set_num_threads(0);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	gsl_vector_free(x);
+	gsl_vector_free(f1);
+	gsl_vector_free(f2);
+	gsl_matrix_free(J1);
+	gsl_matrix_free(J2);
+
+	return 0;
+}
@@ -0,0 +1,303 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file fit_objective.cc
+ * \brief Test suite for the weighted least-squares and Poisson objectives of
+ *    the fits.
+ *
+ * \test Tests molstat::ObjectiveResidual against the closed forms and finite
+ *    differences, and that molstat::FitModel evaluates the objectives the
+ *    same for any number of threads, with the same results for models with
+ *    absolute and relative residuals (including empty bins).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <general/fitter_tools/fit_model_interface.h>
+
+using namespace std;
+
+/**
+ * \brief Fit model for \f$f(x) = a e^{-bx}\f$, with residuals that are
+ *    absolute or relative to the observed value.
+ */
+class ExponentialFitModel
+	: public molstat::FitModel<1>
+{
+private:
+	/// Whether or not the residuals are relative to the observed value.
+	const bool relative;
+
+protected:
+	virtual vector<double> create_initial_guess(
+		const map<string, double> &values) const override
+	{
+		return { values.at("a"), values.at("b") };
+	}
+
+public:
+	ExponentialFitModel(const list<pair<array<double, 1>, double>> &data,
+		bool relative_)
+		: molstat::FitModel<1>(2, data), relative(relative_)
+	{
+	}
+
+	virtual double resid(const vector<double> &fitparam,
+		const array<double, 1> &x, const double f) const override
+	{
+		const double model{ fitparam[0] * exp(-fitparam[1] * x[0]) };
+		return relative ? (model - f) / f : model - f;
+	}
+
+	virtual void jacobian_row(const vector<double> &fitparam,
+		const array<double, 1> &x, const double f, double *jac) const override
+	{
+		const double e{ exp(-fitparam[1] * x[0]) };
+		jac[0] = e;
+		jac[1] = -fitparam[0] * x[0] * e;
+		if(relative)
+		{
+			jac[0] /= f;
+			jac[1] /= f;
+		}
+	}
+
+	virtual double residual_scale(const array<double, 1> &x, const double f)
+		const override
+	{
+		return relative ? f : 1.;
+	}
+
+	virtual void append_default_guesses(list<vector<double>> &guess)
+		const override
+	{
+		guess.push_back({ 1., 1. });
+	}
+
+	virtual void print_fit(ostream &out, const vector<double> &fitparam)
+		const override
+	{
+		out << fitparam[0] << ' ' << fitparam[1];
+	}
+};
+
+/**
+ * \brief Main function for testing the fit objectives.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-10;
+
+	// names
+	assert(molstat::FitObjectiveFromName("Poisson") ==
+		molstat::FitObjective::Poisson);
+	assert(molstat::FitObjectiveFromName("weighted") ==
+		molstat::FitObjective::WeightedLeastSquares);
+	assert(molstat::FitObjectiveFromName("leastsquares") ==
+		molstat::FitObjective::LeastSquares);
+	try
+	{
+		molstat::FitObjectiveFromName("chi");
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// weighted least squares: a value of 8 from 4 raw counts (weight 2)
+	{
+		double jac[2]{ 1., -2. };
+		const double r{ molstat::ObjectiveResidual(
+			molstat::FitObjective::WeightedLeastSquares, 12., 8., 2., 2, jac) };
+		assert(abs(r - 1.) < thresh);
+		assert(abs(jac[0] - 0.25) < thresh && abs(jac[1] + 0.5) < thresh);
+
+		// an empty bin has the standard deviation of one count
+		assert(abs(molstat::ObjectiveResidual(
+			molstat::FitObjective::WeightedLeastSquares, 3., 0., 2., 0,
+			nullptr) - 1.5) < thresh);
+	}
+
+	// Poisson deviance residuals and their derivatives
+	for(const double f : { 0., 3., 10. })
+		for(const double model : { 0.5, 3., 7., 25. })
+		{
+			const double weight{ 0.5 }, n{ f / weight }, mu{ model / weight };
+			double jac[1]{ 1. };
+			const double r{ molstat::ObjectiveResidual(
+				molstat::FitObjective::Poisson, model, f, weight, 1, jac) };
+
+			const double deviance{ 2. * (mu - n +
+				(n > 0. ? n * log(n / mu) : 0.)) };
+			assert(abs(r * r - deviance) < thresh * (1. + deviance));
+			assert(r * (mu - n) >= 0.);
+
+			const double h{ 1.e-6 },
+				rp{ molstat::ObjectiveResidual(molstat::FitObjective::Poisson,
+					model + h, f, weight, 0, nullptr) },
+				rm{ molstat::ObjectiveResidual(molstat::FitObjective::Poisson,
+					model - h, f, weight, 0, nullptr) };
+			assert(abs(jac[0] - (rp - rm) / (2. * h)) <
+				1.e-6 * (1. + abs(jac[0])));
+		}
+
+	// the derivative is continuous where the model matches the data
+	{
+		double jac[1]{ 1. };
+		assert(molstat::ObjectiveResidual(molstat::FitObjective::Poisson, 4.,
+			4., 1., 1, jac) == 0.);
+		assert(abs(jac[0] - 0.5) < thresh);
+	}
+
+	// a nonpositive model still gives a finite residual
+	assert(isfinite(molstat::ObjectiveResidual(molstat::FitObjective::Poisson,
+		-1., 2., 1., 0, nullptr)));
+
+	// where the expected count is clamped, the residual does not change with
+	// the model, and neither does the Jacobian
+	for(const double f : { 0., 3. })
+		for(const double model : { -2., 0., 1.e-12 })
+		{
+			const double weight{ 0.5 };
+			double jac[1]{ 1. };
+			const double r{ molstat::ObjectiveResidual(
+				molstat::FitObjective::Poisson, model, f, weight, 1, jac) };
+			assert(isfinite(r));
+
+			const double h{ 1.e-13 },
+				rp{ molstat::ObjectiveResidual(molstat::FitObjective::Poisson,
+					model + h, f, weight, 0, nullptr) },
+				rm{ molstat::ObjectiveResidual(molstat::FitObjective::Poisson,
+					model - h, f, weight, 0, nullptr) };
+			assert((rp - rm) / (2. * h) == 0.);
+			assert(jac[0] == 0.);
+		}
+
+	// the models: counts from a * exp(-b x), including empty bins, with
+	// weights between the raw counts and the values
+	constexpr size_t npoints = 41;
+	list<pair<array<double, 1>, double>> data;
+	vector<double> weights;
+	for(size_t i = 0; i < npoints; ++i)
+	{
+		const double x{ 0.1 * i }, w{ 1. + 0.05 * i };
+		const double count{ floor(40. * exp(-x) + 0.5 * sin(7. * x)) };
+		data.push_back({ { x }, w * max(count, 0.) });
+		weights.push_back(w);
+	}
+	assert(data.back().second == 0.);
+
+	ExponentialFitModel absolute(data, false), relative(data, true);
+	gsl_vector *x = gsl_vector_alloc(2);
+	gsl_vector_set(x, 0, 50.);
+	gsl_vector_set(x, 1, 0.8);
+
+	gsl_vector *f1 = gsl_vector_alloc(npoints), *f2 = gsl_vector_alloc(npoints);
+	gsl_matrix *J1 = gsl_matrix_alloc(npoints, 2),
+		*J2 = gsl_matrix_alloc(npoints, 2);
+
+	for(const molstat::FitObjective objective :
+		{ molstat::FitObjective::WeightedLeastSquares,
+		  molstat::FitObjective::Poisson })
+	{
+		absolute.set_objective(objective, weights);
+		relative.set_objective(objective, weights);
+
+		// the residuals match the objective
+		molstat::FitModel<1>::fdf(x, &absolute, f1, J1);
+		auto point = data.cbegin();
+		for(size_t i = 0; i < npoints; ++i, ++point)
+		{
+			const double model{ 50. * exp(-0.8 * point->first[0]) };
+			assert(abs(gsl_vector_get(f1, i) - molstat::ObjectiveResidual(
+				objective, model, point->second, weights[i], 0, nullptr)) <
+				thresh);
+		}
+
+		// the Jacobian, by finite differences
+		for(size_t k = 0; k < 2; ++k)
+		{
+			const double h{ 1.e-6 * gsl_vector_get(x, k) };
+			gsl_vector_set(x, k, gsl_vector_get(x, k) + h);
+			molstat::FitModel<1>::f(x, &absolute, f2);
+			gsl_vector_set(x, k, gsl_vector_get(x, k) - h);
+			for(size_t i = 0; i < npoints; ++i)
+			{
+				const double fd{ (gsl_vector_get(f2, i) -
+					gsl_vector_get(f1, i)) / h };
+				assert(abs(fd - gsl_matrix_get(J1, i, k)) <
+					1.e-4 * (1. + abs(fd)));
+			}
+		}
+
+		// relative residuals give the same objective
+		molstat::FitModel<1>::fdf(x, &relative, f2, J2);
+		for(size_t i = 0; i < npoints; ++i)
+		{
+			assert(abs(gsl_vector_get(f1, i) - gsl_vector_get(f2, i)) <
+				thresh * (1. + abs(gsl_vector_get(f1, i))));
+			for(size_t k = 0; k < 2; ++k)
+				assert(abs(gsl_matrix_get(J1, i, k) - gsl_matrix_get(J2, i, k))
+					< thresh * (1. + abs(gsl_matrix_get(J1, i, k))));
+		}
+
+		// df and f give the same as fdf, with any number of threads
+		for(const size_t nthreads : { 1, 3 })
+		{
+			absolute.set_num_threads(nthreads);
+
+			molstat::FitModel<1>::f(x, &absolute, f2);
+			molstat::FitModel<1>::df(x, &absolute, J2);
+			for(size_t i = 0; i < npoints; ++i)
+			{
+				assert(gsl_vector_get(f1, i) == gsl_vector_get(f2, i));
+				for(size_t k = 0; k < 2; ++k)
+					assert(gsl_matrix_get(J1, i, k) ==
+						gsl_matrix_get(J2, i, k));
+			}
+		}
+		absolute.set_num_threads(1);
+	}
+
+	// least squares uses the model's own residuals
+	absolute.set_objective(molstat::FitObjective::LeastSquares);
+	relative.set_objective(molstat::FitObjective::LeastSquares);
+	molstat::FitModel<1>::f(x, &relative, f1);
+	assert(abs(gsl_vector_get(f1, 0) - (50. - data.front().second) /
+		data.front().second) < thresh);
+
+	// bad weights
+	for(const vector<double> &bad : { vector<double>(3, 1.),
+		vector<double>(npoints, 0.) })
+	{
+		try
+		{
+			absolute.set_objective(molstat::FitObjective::Poisson, bad);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	gsl_vector_free(x);
+	gsl_vector_free(f1);
+	gsl_vector_free(f2);
+	gsl_matrix_free(J1);
+	gsl_matrix_free(J2);
+
+	return 0;
+}
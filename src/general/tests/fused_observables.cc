@@ -0,0 +1,215 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file fused_observables.cc
+ * \brief Test suite for calculating several observables together.
+ *
+ * \test Tests molstat::SimulateModel::getFusedObservableFunction for full
+ *    and composite models, and its use by molstat::Simulator.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <typeinfo>
+#include <typeindex>
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/simulator.h>
+#include <general/simulator_tools/simulate_model.h>
+#include <general/simulator_tools/simulator_exceptions.h>
+
+/**
+ * \brief Model whose two observables share an intermediate result. Obs2 is
+ *    not produced when the parameter is at least 0.5.
+ */
+class FusedTestModel :
+	public BasicObs1,
+	public BasicObs2
+{
+public:
+	/// The number of calls to the fused function.
+	static size_t fused_calls;
+
+	virtual double Obs1(const valarray<double> &params) const override
+	{
+		return 2. * params[0];
+	}
+
+	virtual double Obs2(const valarray<double> &params) const override
+	{
+		if(params[0] >= 0.5)
+			return molstat::NoObservableValue;
+
+		return 2. * params[0] + 1.;
+	}
+
+	virtual vector<string> get_names() const override
+	{
+		return { "a" };
+	}
+
+	virtual molstat::FusedObservableFunction getFusedObservableFunction(
+		const vector<molstat::ObservableIndex> &obs) const override
+	{
+		const molstat::ObservableIndex i1{ typeid(BasicObs1) };
+		const molstat::ObservableIndex i2{ typeid(BasicObs2) };
+
+		if(obs.size() != 2 || obs[0] != i1 || obs[1] != i2)
+			return molstat::FusedObservableFunction();
+
+		return [] (const valarray<double> &params, double *out) -> void
+		{
+			++fused_calls;
+
+			const double shared{ 2. * params[0] };
+			out[0] = shared;
+			out[1] = params[0] >= 0.5 ? molstat::NoObservableValue :
+				shared + 1.;
+		};
+	}
+};
+
+size_t FusedTestModel::fused_calls = 0;
+
+/// Submodel that fuses its (single) observable.
+class FusedSubModel
+	: public CompositeSubModel
+{
+public:
+	/// The number of calls to the fused function.
+	static size_t fused_calls;
+
+	virtual molstat::FusedObservableFunction getFusedObservableFunction(
+		const vector<molstat::ObservableIndex> &obs) const override
+	{
+		if(obs.size() != 1 || obs[0] != molstat::ObservableIndex
+			{ typeid(BasicObs1) })
+		{
+			return molstat::FusedObservableFunction();
+		}
+
+		return [] (const valarray<double> &params, double *out) -> void
+		{
+			++fused_calls;
+			out[0] = params[1] * (params[2] - params[3]);
+		};
+	}
+};
+
+size_t FusedSubModel::fused_calls = 0;
+
+/**
+ * \brief Main function for testing the fused observables.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-12;
+	constexpr size_t ntrials = 1000;
+	molstat::Engine engine{ 5489, 0, molstat::EngineKind::Xoshiro256pp };
+
+	// full model
+	{
+		molstat::SimulateModelFactory factory
+			{ molstat::SimulateModelFactory::makeFactory<FusedTestModel>() };
+		factory.setDistribution("a",
+			make_shared<molstat::UniformDistribution>(0., 1.));
+		shared_ptr<molstat::SimulateModel> model{ factory.getModel() };
+
+		// this combination of observables is not fused
+		assert(!model->getFusedObservableFunction(
+			{ type_index{ typeid(BasicObs2) } }));
+
+		molstat::Simulator sim{ model };
+		sim.setObservable(0, type_index{ typeid(BasicObs1) });
+		sim.setObservable(1, type_index{ typeid(BasicObs2) });
+
+		vector<double> out(2 * ntrials), workspace;
+		size_t rejections[2] = { 0, 0 };
+		const size_t nvalid{ sim.simulateBatch(engine, ntrials, out.data(),
+			workspace, rejections) };
+
+		assert(FusedTestModel::fused_calls == ntrials);
+		assert(nvalid + rejections[1] == ntrials);
+		assert(rejections[0] == 0);
+		assert(nvalid > 0 && nvalid < ntrials);
+		for(size_t t = 0; t < nvalid; ++t)
+		{
+			assert(out[2*t] < 1.);
+			assert(abs(out[2*t + 1] - out[2*t] - 1.) < thresh);
+		}
+	}
+
+	// composite model, with one submodel that fuses its observable and one
+	// that does not
+	{
+		constexpr double ef = 1.5, v = -0.4;
+		constexpr double eps1 = 2.1, gamma1 = 0.3, eps2 = -1.2, gamma2 = 0.7;
+
+		molstat::SimulateModelFactory cfactory
+			{ molstat::SimulateModelFactory::makeFactory<CompositeTestModelAdd>() };
+		cfactory.setDistribution("ef",
+			make_shared<molstat::ConstantDistribution>(ef));
+		cfactory.setDistribution("v",
+			make_shared<molstat::ConstantDistribution>(v));
+
+		molstat::SimulateModelFactory subfactory1
+			{ molstat::SimulateModelFactory::makeFactory<FusedSubModel>() };
+		subfactory1.setDistribution("eps",
+			make_shared<molstat::ConstantDistribution>(eps1));
+		subfactory1.setDistribution("gamma",
+			make_shared<molstat::ConstantDistribution>(gamma1));
+
+		molstat::SimulateModelFactory subfactory2
+			{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+		subfactory2.setDistribution("eps",
+			make_shared<molstat::ConstantDistribution>(eps2));
+		subfactory2.setDistribution("gamma",
+			make_shared<molstat::ConstantDistribution>(gamma2));
+
+		cfactory.addSubmodel(subfactory1.getModel());
+		cfactory.addSubmodel(subfactory2.getModel());
+		shared_ptr<molstat::SimulateModel> cmodel{ cfactory.getModel() };
+
+		molstat::Simulator sim{ cmodel };
+		sim.setObservable(0, type_index{ typeid(BasicObs4) });
+		sim.setObservable(1, type_index{ typeid(BasicObs1) });
+
+		const valarray<double> obs{ sim.simulate(engine) };
+		assert(FusedSubModel::fused_calls == 1);
+		assert(abs(obs[0] - (ef + v)) < thresh);
+		assert(abs(obs[1] - v * (eps1 - gamma1 + eps2 - gamma2)) < thresh);
+
+		// the composite model only implements BasicObs4 itself; nothing
+		// to fuse
+		assert(!cmodel->getFusedObservableFunction(
+			{ type_index{ typeid(BasicObs4) } }));
+
+		// incompatible observables
+		try
+		{
+			cmodel->getFusedObservableFunction(
+				{ type_index{ typeid(BasicObs1) },
+				  type_index{ typeid(BasicObs2) } });
+			assert(false);
+		}
+		catch(const molstat::IncompatibleObservable &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file gauss_kronrod.cc
+ * \brief Test suite for adaptive Gauss-Kronrod quadrature.
+ *
+ * \test Tests molstat::AdaptiveGaussKronrod with several integrands
+ *    evaluated together.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <general/gauss_kronrod.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing adaptive Gauss-Kronrod quadrature.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-10;
+
+	// the weights of each rule integrate 1 exactly
+	{
+		double kronrod{ molstat::GaussKronrod15::kronrod_weights[7] };
+		double gauss{ molstat::GaussKronrod15::gauss_weights[3] };
+		for(size_t j = 0; j < 7; ++j)
+			kronrod += 2. * molstat::GaussKronrod15::kronrod_weights[j];
+		for(size_t j = 0; j < 3; ++j)
+			gauss += 2. * molstat::GaussKronrod15::gauss_weights[j];
+		assert(abs(kronrod - 2.) < 1.e-14);
+		assert(abs(gauss - 2.) < 1.e-14);
+	}
+
+	molstat::AdaptiveGaussKronrod<3> quad(1000);
+	size_t ncalls{ 0 };
+
+	// a polynomial (exact with one interval), a smooth function, and a
+	// sharp step, all together
+	const auto funcs = [&ncalls] (double x, array<double, 3> &vals) -> void
+	{
+		++ncalls;
+		vals[0] = x * x;
+		vals[1] = sin(x);
+		vals[2] = 1. + erf((x - 0.7) / 1.e-3);
+	};
+
+	const array<double, 3> ints(quad.integrate(funcs, 0., 2., 0., 1.e-12));
+	assert(abs(ints[0] - 8./3.) < thresh);
+	assert(abs(ints[1] - (1. - cos(2.))) < thresh);
+	assert(abs(ints[2] - 2.6) < thresh);
+
+	// the smooth integrands alone converge immediately
+	ncalls = 0;
+	const array<double, 3> smooth(quad.integrate(
+		[&ncalls] (double x, array<double, 3> &vals) -> void
+		{
+			++ncalls;
+			vals[0] = x * x;
+			vals[1] = exp(x);
+			vals[2] = 0.;
+		}, -1., 1., 0., 1.e-10));
+	assert(ncalls == 15);
+	assert(abs(smooth[0] - 2./3.) < thresh);
+	assert(abs(smooth[1] - (exp(1.) - exp(-1.))) < thresh);
+	assert(smooth[2] == 0.);
+
+	// reversed limits
+	const array<double, 3> reversed(quad.integrate(funcs, 2., 0., 0., 1.e-12));
+	assert(abs(reversed[0] + 8./3.) < thresh);
+
+	// integrable singularity at an endpoint
+	{
+		molstat::AdaptiveGaussKronrod<1> quad1(1000);
+		const array<double, 1> sing(quad1.integrate(
+			[] (double x, array<double, 1> &vals) -> void
+			{
+				vals[0] = 1. / sqrt(x);
+			}, 0., 1., 0., 1.e-8));
+		assert(abs(sing[0] - 2.) < 1.e-6);
+	}
+
+	// with a single subinterval, the best estimate is still returned
+	{
+		molstat::AdaptiveGaussKronrod<3> coarse(1);
+		const array<double, 3> est(coarse.integrate(funcs, 0., 2., 0., 1.e-12));
+		assert(abs(est[0] - 8./3.) < thresh);
+		assert(abs(est[2] - 2.6) > thresh);
+	}
+
+	return 0;
+}
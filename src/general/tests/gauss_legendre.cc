@@ -0,0 +1,100 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/gauss_legendre.cc
+ * \brief Test suite for Gauss-Legendre quadrature.
+ *
+ * \test Tests molstat::GaussLegendre: known nodes and weights, exactness for
+ *    polynomials, and convergence for a smooth function.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <general/gauss_legendre.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing Gauss-Legendre quadrature.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-13;
+
+	// need at least one point
+	try
+	{
+		molstat::GaussLegendre(0);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// one point: the midpoint rule
+	{
+		molstat::GaussLegendre rule(1);
+		assert(rule.numPoints() == 1);
+		assert(abs(rule.node(0)) < thresh);
+		assert(abs(rule.weight(0) - 2.) < thresh);
+	}
+
+	// three points: nodes 0, +-sqrt(3/5); weights 8/9, 5/9
+	{
+		molstat::GaussLegendre rule(3);
+		assert(abs(rule.node(0) + sqrt(0.6)) < thresh);
+		assert(abs(rule.node(1)) < thresh);
+		assert(abs(rule.node(2) - sqrt(0.6)) < thresh);
+		assert(abs(rule.weight(0) - 5./9.) < thresh);
+		assert(abs(rule.weight(1) - 8./9.) < thresh);
+		assert(abs(rule.weight(2) - 5./9.) < thresh);
+	}
+
+	// an n-point rule is exact for polynomials of degree 2n-1
+	for(size_t n = 1; n <= 12; ++n)
+	{
+		molstat::GaussLegendre rule(n);
+
+		double wsum{ 0. };
+		for(size_t j = 0; j < n; ++j)
+			wsum += rule.weight(j);
+		assert(abs(wsum - 2.) < thresh);
+
+		const double deg{ 2.*n - 1. };
+		const double exact{ (pow(2., deg + 1.) - pow(-1., deg + 1.)) /
+			(deg + 1.) };
+		const double approx{ rule.integrate(
+			[deg] (double x) -> double
+			{
+				return pow(x, deg);
+			}, -1., 2.) };
+		assert(abs(approx - exact) < 1.e-10 * abs(exact));
+	}
+
+	// a smooth function converges quickly
+	{
+		molstat::GaussLegendre rule(20);
+		const double approx{ rule.integrate(
+			[] (double x) -> double
+			{
+				return exp(-x) * cos(x);
+			}, 0., 3.) };
+		// antiderivative: exp(-x) (sin x - cos x) / 2
+		const double exact{ 0.5 * (exp(-3.) * (sin(3.) - cos(3.)) + 1.) };
+		assert(abs(approx - exact) < thresh);
+	}
+
+	return 0;
+}
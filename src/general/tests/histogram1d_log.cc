@@ -62,6 +62,7 @@ int main(int argc, char **argv)
 	// the average coordinate is 5.5e-5 and the bin count should be 4
 	assert(abs(hist.getCoordinates(iter)[0] - 5.5e-5) < thresh);
 	assert(abs(hist.getBinCount(iter) - 4.*bstyle->dmaskdx(5.5e-5)) < thresh);
+	assert(hist.getRawBinCount(iter) == 4.);
 
 	++iter;
 	// bin 1 (#2 above)
@@ -86,6 +87,7 @@ int main(int argc, char **argv)
 	// the average coordinate is 5.5e-1 and the bin count should be 3
 	assert(abs(hist.getCoordinates(iter)[0] - 5.5e-1) < thresh);
 	assert(abs(hist.getBinCount(iter) - 3.*bstyle->dmaskdx(5.5e-1)) < thresh);
+	assert(hist.getRawBinCount(iter) == 3.);
 
 	// just for sanity
 	++iter;
@@ -9,7 +9,8 @@
  *    binning).
  *
  * \test Tests the molstat::Histogram class with mixed linear
- *    (molstat::BinLinear) and logarithmic binning (molstat::BinLog).
+ *    (molstat::BinLinear) and logarithmic binning (molstat::BinLog),
+ *    including the separable bin weights.
  *
  * \author Matthew G.\ Reuter
  * \date October 2014
@@ -17,6 +18,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <vector>
 
 #include <general/histogram_tools/counterindex.h>
 #include <general/histogram_tools/histogram.h>
@@ -140,5 +142,23 @@ int main(int argc, char **argv)
 	++iter;
 	assert(iter.at_end());
 
+	// the per-dimension coordinates and weights, and all of the (weighted)
+	// counts at once, agree with those of each bin
+	assert(hist.numDimensions() == 2);
+	const vector<double> counts{ hist.getBinCounts() };
+	assert(counts.size() == 8);
+	for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+	{
+		for(size_t j = 0; j < 2; ++j)
+		{
+			assert(hist.getBinCoordinates(j)[ci[j]] ==
+				hist.getCoordinates(ci)[j]);
+		}
+		assert(abs(hist.getBinWeights(0)[ci[0]] *
+			hist.getBinWeights(1)[ci[1]] * hist.getRawBinCount(ci) -
+			hist.getBinCount(ci)) < thresh);
+		assert(abs(counts[ci.arrayOffset()] - hist.getBinCount(ci)) < thresh);
+	}
+
 	return 0;
 }
@@ -0,0 +1,152 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_hdf5.cc
+ * \brief Test suite for writing histograms to HDF5 files.
+ *
+ * \test Tests molstat::WriteHistogramHDF5 by reading the file back.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <hdf5.h>
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/histogram_io.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Reads an array of doubles from an attribute.
+ *
+ * \param[in] obj The object with the attribute.
+ * \param[in] name The name of the attribute.
+ * \param[in] n The number of values.
+ * \return The values.
+ */
+vector<double> read_doubles(hid_t obj, const string &name, size_t n)
+{
+	vector<double> ret(n);
+	const hid_t attr{ H5Aopen(obj, name.c_str(), H5P_DEFAULT) };
+	assert(attr >= 0);
+
+	const hid_t space{ H5Aget_space(attr) };
+	assert(H5Sget_simple_extent_npoints(space) == static_cast<hssize_t>(n));
+	H5Sclose(space);
+
+	assert(H5Aread(attr, H5T_NATIVE_DOUBLE, ret.data()) >= 0);
+	H5Aclose(attr);
+	return ret;
+}
+
+/**
+ * \brief Main function for testing HDF5 histogram output.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh = 1.0e-12;
+	const string filename{ "histogram_hdf5_test.h5" };
+
+	// a two-dimensional histogram with different bins in each dimension
+	shared_ptr<molstat::BinStyle> blinear{ make_shared<molstat::BinLinear>(3) };
+	shared_ptr<molstat::BinStyle> blog{ make_shared<molstat::BinLog>(4, 10.) };
+	blinear->setBounds(0., 3.);
+	blog->setBounds(0.1, 1000.);
+	const vector<shared_ptr<const molstat::BinStyle>> styles{ blinear, blog };
+
+	molstat::Histogram hist(styles);
+	for(size_t j = 0; j < 50; ++j)
+	{
+		const double point[2]{ 0.06 * j, pow(10., -1. + 0.08 * j) };
+		hist.add_data(point, 2);
+	}
+
+	molstat::WriteHistogramHDF5(filename, hist, styles, 51, 50);
+
+	const hid_t file{ H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT) };
+	assert(file >= 0);
+	const hid_t dset{ H5Dopen2(file, "/histogram/counts", H5P_DEFAULT) };
+	assert(dset >= 0);
+
+	// the axes are in reverse order
+	{
+		const hid_t space{ H5Dget_space(dset) };
+		hsize_t dims[2];
+		assert(H5Sget_simple_extent_ndims(space) == 2);
+		H5Sget_simple_extent_dims(space, dims, nullptr);
+		assert(dims[0] == 4 && dims[1] == 3);
+		H5Sclose(space);
+	}
+
+	// the counts, with the first dimension changing the fastest
+	{
+		vector<double> counts(12);
+		assert(H5Dread(dset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+			counts.data()) >= 0);
+		for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+			assert(counts[ci.arrayOffset()] == hist.getBinCount(ci));
+	}
+
+	// trial counts
+	{
+		uint64_t val;
+		const hid_t attr{ H5Aopen(dset, "ntrials", H5P_DEFAULT) };
+		assert(H5Aread(attr, H5T_NATIVE_UINT64, &val) >= 0);
+		assert(val == 51);
+		H5Aclose(attr);
+	}
+
+	// bin edges and coordinates
+	{
+		const vector<double> edges0{ read_doubles(dset, "edges_0", 4) };
+		for(size_t k = 0; k < 4; ++k)
+			assert(abs(edges0[k] - k) < thresh);
+
+		const vector<double> edges1{ read_doubles(dset, "edges_1", 5) };
+		for(size_t k = 0; k < 5; ++k)
+			assert(abs(edges1[k] - pow(10., -1. + k)) < thresh * edges1[k]);
+
+		const vector<double> coords1{ read_doubles(dset, "coordinates_1", 4) };
+		molstat::CounterIndex ci{ hist.begin() };
+		for(size_t k = 0; k < 4; ++k)
+		{
+			ci.setIndex(1, k);
+			assert(coords1[k] == hist.getCoordinates(ci)[1]);
+			assert(edges1[k] < coords1[k] && coords1[k] < edges1[k + 1]);
+		}
+	}
+
+	// binning style
+	{
+		const hid_t attr{ H5Aopen(dset, "style_1", H5P_DEFAULT) };
+		const hid_t type{ H5Aget_type(attr) };
+		string style(H5Tget_size(type), '\0');
+		assert(H5Aread(attr, type, &style[0]) >= 0);
+		assert(style == blog->info());
+		H5Tclose(type);
+		H5Aclose(attr);
+	}
+
+	H5Dclose(dset);
+	H5Fclose(file);
+	remove(filename.c_str());
+
+	return 0;
+}
@@ -0,0 +1,326 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_io.cc
+ * \brief Test suite for writing and reading histograms.
+ *
+ * \test Tests the text, gzip, binary, and mergeable histogram formats in
+ *    histogram_io.h, including merging histograms.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <config.h>
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/histogram_io.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing histogram output.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh = 1.0e-12;
+
+	// a two-dimensional histogram with different bins in each dimension
+	shared_ptr<molstat::BinStyle> blinear{ make_shared<molstat::BinLinear>(3) };
+	shared_ptr<molstat::BinStyle> blog{ make_shared<molstat::BinLog>(4, 10.) };
+	blinear->setBounds(0., 3.);
+	blog->setBounds(0.1, 1000.);
+	const vector<shared_ptr<const molstat::BinStyle>> styles{ blinear, blog };
+
+	molstat::Histogram hist(styles);
+	for(size_t j = 0; j < 50; ++j)
+	{
+		const double point[2]{ 0.06 * j, pow(10., -1. + 0.08 * j) };
+		hist.add_data(point, 1);
+	}
+	const double outside[2]{ 5., 1. };
+	hist.add_data(outside, 1);
+
+	assert(hist.numBins(0) == 3);
+	assert(hist.numBins(1) == 4);
+
+	// text output: one bin per line
+	{
+		ostringstream out;
+		molstat::WriteHistogramText(out, hist);
+
+		istringstream in(out.str());
+		size_t nlines{ 0 };
+		for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+		{
+			double x, y, count;
+			in >> x >> y >> count;
+			assert(in);
+			assert(abs(x - hist.getCoordinates(ci)[0]) < 1.e-4);
+			assert(abs(y - hist.getCoordinates(ci)[1]) < 1.e-4 * y);
+			++nlines;
+		}
+		assert(nlines == 12);
+	}
+
+	// the text matches the default stream formatting of each number
+	{
+		ostringstream expected;
+		for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+		{
+			const valarray<double> coords = hist.getCoordinates(ci);
+			expected << coords[0] << ' ' << coords[1] << ' ' <<
+				hist.getBinCount(ci) << '\n';
+		}
+
+		ostringstream out;
+		molstat::WriteHistogramText(out, hist);
+		assert(out.str() == expected.str());
+	}
+
+	// large histograms span several blocks of text
+	shared_ptr<molstat::BinStyle> bbig{ make_shared<molstat::BinLinear>(20000) };
+	bbig->setBounds(-1., 1.);
+	const vector<shared_ptr<const molstat::BinStyle>> bigstyles{ bbig };
+	molstat::Histogram bighist(bigstyles);
+	for(size_t j = 0; j < 1000; ++j)
+		bighist.add_data({ -1. + 0.002 * j });
+
+	ostringstream bigtext;
+	{
+		ostringstream expected;
+		for(molstat::CounterIndex ci{ bighist.begin() }; !ci.at_end(); ++ci)
+			expected << bighist.getCoordinates(ci)[0] << ' ' <<
+				bighist.getBinCount(ci) << '\n';
+
+		molstat::WriteHistogramText(bigtext, bighist);
+		assert(bigtext.str().size() > (1 << 16));
+		assert(bigtext.str() == expected.str());
+	}
+
+	// gzip output decompresses to the text output
+#if HAVE_ZLIB
+	{
+		assert(molstat::HistogramFormatFromName("GZIP") ==
+			molstat::HistogramFormat::Gzip);
+
+		ostringstream out;
+		molstat::WriteHistogramGzip(out, bighist);
+		const string compressed{ out.str() };
+		assert(compressed.size() < bigtext.str().size());
+
+		z_stream strm;
+		strm.zalloc = Z_NULL;
+		strm.zfree = Z_NULL;
+		strm.opaque = Z_NULL;
+		strm.next_in = Z_NULL;
+		strm.avail_in = 0;
+		assert(inflateInit2(&strm, 15 + 16) == Z_OK);
+
+		vector<char> text(bigtext.str().size() + 1);
+		strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(
+			compressed.data()));
+		strm.avail_in = compressed.size();
+		strm.next_out = reinterpret_cast<Bytef*>(text.data());
+		strm.avail_out = text.size();
+		assert(inflate(&strm, Z_FINISH) == Z_STREAM_END);
+		inflateEnd(&strm);
+
+		assert(string(text.data(), text.size() - strm.avail_out) ==
+			bigtext.str());
+	}
+#endif
+
+	// format names
+	assert(molstat::HistogramFormatFromName("Text") ==
+		molstat::HistogramFormat::Text);
+	assert(molstat::HistogramFormatFromName("binary") ==
+		molstat::HistogramFormat::Binary);
+	try
+	{
+		molstat::HistogramFormatFromName("xml");
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// binary output round trip
+	{
+		ostringstream out;
+		molstat::WriteHistogramBinary(out, hist, styles, 51, 50);
+
+		istringstream in(out.str());
+		assert(molstat::IsBinaryHistogram(in));
+		const molstat::HistogramData data{ molstat::ReadHistogramBinary(in) };
+
+		assert(data.ntrials == 51);
+		assert(data.nbinned == 50);
+		assert(data.styles.size() == 2);
+		assert(data.styles[0] == blinear->info());
+		assert(data.styles[1] == blog->info());
+		assert(abs(data.bounds[0][0] - 0.) < thresh);
+		assert(abs(data.bounds[0][1] - 3.) < thresh);
+		assert(abs(data.bounds[1][0] - 0.1) < thresh);
+		assert(abs(data.bounds[1][1] - 1000.) / 1000. < thresh);
+		assert(data.coordinates[0].size() == 3);
+		assert(data.coordinates[1].size() == 4);
+		assert(data.counts.size() == 12);
+
+		for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+		{
+			const valarray<double> coords{ hist.getCoordinates(ci) };
+			assert(data.coordinates[0][ci[0]] == coords[0]);
+			assert(data.coordinates[1][ci[1]] == coords[1]);
+			assert(data.counts[ci.arrayOffset()] == hist.getBinCount(ci));
+		}
+	}
+
+	// text data is not a binary histogram
+	{
+		istringstream in("0.1 2.\n");
+		assert(!molstat::IsBinaryHistogram(in));
+
+		try
+		{
+			molstat::ReadHistogramBinary(in);
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+	}
+
+	// mergeable histograms: shards merge to the histogram of all the data
+	{
+		assert(molstat::HistogramFormatFromName("Mergeable") ==
+			molstat::HistogramFormat::Mergeable);
+
+		vector<molstat::Histogram> shards;
+		for(size_t s = 0; s < 3; ++s)
+			shards.emplace_back(styles);
+		for(size_t j = 0; j < 50; ++j)
+		{
+			const double point[2]{ 0.06 * j, pow(10., -1. + 0.08 * j) };
+			shards[j % 3].add_data(point, 1);
+		}
+		const double outside[2]{ 5., 1. };
+		shards[1].add_data(outside, 1);
+
+		// write and read each shard, then merge them
+		molstat::MergeableHistogram sum;
+		for(size_t s = 0; s < 3; ++s)
+		{
+			const size_t ntrials{ s == 1 ? 18u : 17u };
+			ostringstream out;
+			molstat::WriteHistogramMergeable(out,
+				molstat::MakeMergeableHistogram(shards[s], styles, ntrials,
+					ntrials - shards[s].numOutOfRange()));
+
+			istringstream in(out.str());
+			assert(molstat::IsBinaryHistogram(in));
+			const molstat::MergeableHistogram shard{
+				molstat::ReadHistogramMergeable(in) };
+			if(s == 0)
+				sum = shard;
+			else
+				molstat::MergeHistograms(sum, shard);
+		}
+
+		assert(sum.ntrials == 52);
+		assert(sum.nbinned == 51);
+		assert(sum.nout == hist.numOutOfRange());
+		assert(sum.out_of_range[0][1] == hist.numOverflow(0));
+		for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+			assert(sum.counts[ci.arrayOffset()] == hist.getRawBinCount(ci));
+
+		// the weighted counts match the histogram of all the data
+		const molstat::HistogramData data{
+			molstat::WeightMergeableHistogram(sum) };
+		for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+			assert(data.counts[ci.arrayOffset()] == hist.getBinCount(ci));
+
+		ostringstream mergedtext, text;
+		molstat::WriteHistogramText(mergedtext, data);
+		molstat::WriteHistogramText(text, hist);
+		assert(mergedtext.str() == text.str());
+
+		// the binary reader applies the weights
+		ostringstream out;
+		molstat::WriteHistogramMergeable(out, sum);
+		istringstream in(out.str());
+		const molstat::HistogramData read{ molstat::ReadHistogramBinary(in) };
+		assert(read.ntrials == 52);
+		assert(read.counts == data.counts);
+
+		// histograms with different bins cannot be merged
+		shared_ptr<molstat::BinStyle> bother{
+			make_shared<molstat::BinLinear>(3) };
+		bother->setBounds(0., 4.);
+		molstat::Histogram other({ bother, blog });
+		try
+		{
+			molstat::MergeHistograms(sum,
+				molstat::MakeMergeableHistogram(other, { bother, blog }, 0, 0));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+
+		// a binary histogram is not mergeable
+		ostringstream binout;
+		molstat::WriteHistogramBinary(binout, hist, styles, 51, 50);
+		istringstream binin(binout.str());
+		try
+		{
+			molstat::ReadHistogramMergeable(binin);
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+	}
+
+	// truncated files are errors
+	{
+		ostringstream out;
+		molstat::WriteHistogramBinary(out, hist, styles, 51, 50);
+
+		istringstream in(out.str().substr(0, out.str().size() - 8));
+		try
+		{
+			molstat::ReadHistogramBinary(in);
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_merge.cc
+ * \brief Test suite for merging histograms.
+ *
+ * \test Tests molstat::Histogram::merge, making sure a histogram merged from
+ *    several pieces bins identically to one built from all of the data.
+ *    Also tests binning pieces separately with common extremes and summing
+ *    their raw bin counts (as is done across processes), and the Hellinger
+ *    distance between histograms (as is used to check convergence).
+ *
+ * \author Matthew G.\ Reuter
+ * \date October 2014
+ */
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the merging of histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	shared_ptr<const molstat::BinStyle> bstyle
+		{ make_shared<molstat::BinLinear>(5) };
+	const double thresh = 1.0e-6;
+
+	// the same data as in histogram1d_linear, split into three pieces
+	molstat::Histogram hist(1), piece1(1), piece2(1), empty(1);
+
+	hist.add_data({0.12}); // 1
+	hist.add_data({0.87}); // 5
+	hist.add_data({0.66}); // 4
+	hist.add_data({0.50}); // 3
+
+	piece1.add_data({0.00}); // 1
+	piece1.add_data({0.92}); // 5
+	piece1.add_data({0.42}); // 3
+	piece1.add_data({0.21}); // 2
+
+	piece2.add_data({0.18}); // 1
+	piece2.add_data({0.04}); // 1
+	piece2.add_data({0.99}); // 5
+	piece2.add_data({0.77}); // 4
+	piece2.add_data({1.00}); // 5
+
+	// cannot merge histograms with different dimensionality
+	try
+	{
+		molstat::Histogram hist2d(2);
+		hist.merge(move(hist2d));
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	hist.merge(move(piece1));
+	hist.merge(move(empty));
+	hist.merge(move(piece2));
+
+	hist.bin_data({ bstyle });
+
+	// cannot merge after binning
+	try
+	{
+		molstat::Histogram other(1);
+		other.add_data({0.5});
+		hist.merge(move(other));
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	// check the bin contents; these are the same as histogram1d_linear
+	const double counts[] = { 4., 1., 2., 2., 4. };
+	const double coords[] = { 0.1, 0.3, 0.5, 0.7, 0.9 };
+	molstat::CounterIndex iter = hist.begin();
+	for(size_t j = 0; j < 5; ++j, ++iter)
+	{
+		assert(abs(hist.getCoordinates(iter)[0] - coords[j]) < thresh);
+		assert(abs(hist.getBinCount(iter) -
+			counts[j]*bstyle->dmaskdx(coords[j])) < thresh);
+	}
+	assert(iter.at_end());
+
+	// bin the pieces separately, using the extremes of all the data, and
+	// sum the raw counts
+	{
+		molstat::Histogram first(1), second(1);
+		for(const double x : { 0.12, 0.87, 0.66, 0.50, 0.00, 0.92, 0.42 })
+			first.add_data({x});
+		for(const double x : { 0.21, 0.18, 0.04, 0.99, 0.77, 1.00 })
+			second.add_data({x});
+
+		vector<array<double, 2>> extremes{ first.getDataExtremes() };
+		const vector<array<double, 2>> other{ second.getDataExtremes() };
+		extremes[0][0] = min(extremes[0][0], other[0][0]);
+		extremes[0][1] = max(extremes[0][1], other[0][1]);
+		assert(extremes[0][0] == 0. && extremes[0][1] == 1.);
+
+		first.bin_data({ bstyle }, extremes);
+		second.bin_data({ bstyle }, extremes);
+
+		vector<size_t> sum{ first.getRawBinCounts() };
+		const vector<size_t> addend{ second.getRawBinCounts() };
+		for(size_t j = 0; j < sum.size(); ++j)
+			sum[j] += addend[j];
+		first.setRawBinCounts(sum, 0, { {{0, 0}} });
+
+		molstat::CounterIndex ci = first.begin();
+		for(size_t j = 0; j < 5; ++j, ++ci)
+			assert(abs(first.getBinCount(ci) -
+				counts[j]*bstyle->dmaskdx(coords[j])) < thresh);
+
+		// the counts must match the bins
+		try
+		{
+			first.setRawBinCounts({ 1, 2 }, 0, { {{0, 0}} });
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// the Hellinger distance depends only on the normalized counts
+	{
+		const vector<size_t> a{ 1, 2, 3, 0 }, b{ 2, 4, 6, 0 },
+			c{ 0, 0, 0, 5 }, d{ 3, 2, 1, 0 }, empty(4, 0);
+
+		assert(molstat::HellingerDistance(a, a) == 0.);
+		assert(abs(molstat::HellingerDistance(a, b)) < thresh);
+		assert(molstat::HellingerDistance(a, c) == 1.);
+		assert(molstat::HellingerDistance(a, empty) == 1.);
+		assert(abs(molstat::HellingerDistance(a, d) -
+			sqrt(1. - (2. * sqrt(3.) + 2.) / 6.)) < thresh);
+		assert(molstat::HellingerDistance(a, d) ==
+			molstat::HellingerDistance(d, a));
+
+		try
+		{
+			molstat::HellingerDistance(a, { 1, 2 });
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
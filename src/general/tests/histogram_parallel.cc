@@ -0,0 +1,85 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_parallel.cc
+ * \brief Test suite for binning stored data on several threads.
+ *
+ * \test Tests that molstat::Histogram::bin_data gives the same counts with
+ *    a scheduler (for several numbers of workers) as on the calling thread,
+ *    for dense and sparse storage.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <general/task_scheduler.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing parallel binning.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	// enough data elements for many chunks, from a simple linear
+	// congruential generator
+	vector<double> data;
+	unsigned long long state{ 2014 };
+	auto uniform = [&state]() -> double
+	{
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (state >> 11) * (1. / 9007199254740992.);
+	};
+	for(size_t k = 0; k < 200000; ++k)
+	{
+		data.push_back(uniform() * uniform());
+		data.push_back(pow(10., -3. * uniform()));
+	}
+	const size_t ndata{ data.size() / 2 };
+
+	// few bins (dense storage) and many bins (sparse storage)
+	const vector<vector<shared_ptr<const molstat::BinStyle>>> styles{
+		{ make_shared<molstat::BinLinear>(100),
+		  make_shared<molstat::BinLog>(50, 10.) },
+		{ make_shared<molstat::BinLinear>(2048),
+		  make_shared<molstat::BinLog>(2048, 10.) } };
+
+	for(const auto &style : styles)
+	{
+		molstat::Histogram serial(2);
+		serial.add_data(data.data(), ndata);
+		serial.bin_data(style);
+		assert(serial.isSparse() == (style[0]->nbins == 2048));
+
+		for(size_t nworkers : { 1, 2, 5 })
+		{
+			molstat::TaskScheduler scheduler{ nworkers };
+			molstat::Histogram parallel(2);
+			parallel.add_data(data.data(), ndata);
+			parallel.bin_data(style, &scheduler);
+
+			assert(parallel.isSparse() == serial.isSparse());
+			assert(parallel.getRawBinCounts() == serial.getRawBinCounts());
+			assert(parallel.getBinCounts() == serial.getBinCounts());
+			for(size_t j = 0; j < 2; ++j)
+				assert(parallel.getBinCoordinates(j) ==
+					serial.getBinCoordinates(j));
+		}
+	}
+
+	return 0;
+}
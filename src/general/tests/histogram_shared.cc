@@ -0,0 +1,151 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_shared.cc
+ * \brief Test suite for bin counts shared by several threads.
+ *
+ * \test Tests molstat::SharedHistogram, comparing the counts accumulated by
+ *    several threads at once (with one or several replicas of the counts)
+ *    to those of one (private) histogram, and that a histogram localized by
+ *    another thread keeps its counts.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/shared_histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing shared histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const vector<shared_ptr<const molstat::BinStyle>> styles{
+		make_shared<molstat::BinLinear>(64),
+		make_shared<molstat::BinLog>(32, 10.) };
+	const vector<array<double, 2>> bounds{ {{ 0., 1. }}, {{ 1.e-3, 1. }} };
+
+	// data (some out of range) from a simple linear congruential generator
+	const size_t nthreads{ 4 }, per_thread{ 25000 };
+	vector<double> data;
+	unsigned long long state{ 2014 };
+	for(size_t k = 0; k < 2 * nthreads * per_thread; ++k)
+	{
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		const double u{ (state >> 11) * (1. / 9007199254740992.) };
+		data.push_back(k % 2 == 0 ? 1.2 * u - 0.1 : pow(10., -3.2 * u));
+	}
+
+	// one histogram with all of the data
+	molstat::Histogram reference(styles, bounds);
+	reference.add_data(data.data(), nthreads * per_thread);
+
+	// the threads share the counts of a histogram that already has some
+	for(const size_t nreplicas : { 1, 3 })
+	{
+		const size_t before{ 100 };
+		molstat::Histogram hist(styles, bounds);
+		hist.add_data(data.data(), before);
+		{
+			molstat::SharedHistogram shared(hist, nreplicas);
+			assert(shared.memoryUsage() >=
+				nreplicas * 64 * 32 * sizeof(size_t));
+
+			vector<thread> workers;
+			for(size_t t = 0; t < nthreads; ++t)
+			{
+				// uneven blocks, so that some calls span several internal
+				// blocks
+				const size_t first{ t == 0 ? before : t * per_thread };
+				workers.emplace_back([&shared, &data, first, t, per_thread]
+					{
+						const size_t last{ (t + 1) * per_thread };
+						for(size_t k = first; k < last; k += 3000)
+							shared.add_data(&data[2 * k],
+								min<size_t>(3000, last - k));
+					});
+			}
+			for(auto &worker : workers)
+				worker.join();
+
+			shared.finish();
+		}
+
+		assert(hist.getRawBinCounts() == reference.getRawBinCounts());
+		assert(hist.getBinCounts() == reference.getBinCounts());
+		assert(hist.numOutOfRange() == reference.numOutOfRange());
+		assert(hist.numOutOfRange() > 0);
+		for(size_t j = 0; j < 2; ++j)
+		{
+			assert(hist.numUnderflow(j) == reference.numUnderflow(j));
+			assert(hist.numOverflow(j) == reference.numOverflow(j));
+		}
+	}
+
+	// a histogram localized (and then filled) by another thread
+	{
+		const size_t before{ 1000 };
+		molstat::Histogram hist(styles, bounds);
+		hist.useWeights();
+		hist.add_data(data.data(), before);
+		thread worker{ [&hist, &data, before, nthreads, per_thread]
+			{
+				hist.localize();
+				hist.add_data(&data[2 * before],
+					nthreads * per_thread - before);
+			} };
+		worker.join();
+
+		assert(hist.getRawBinCounts() == reference.getRawBinCounts());
+		assert(hist.numOutOfRange() == reference.numOutOfRange());
+		const vector<double> sums{ hist.getRawBinSums() };
+		const vector<size_t> counts{ reference.getRawBinCounts() };
+		for(size_t k = 0; k < counts.size(); ++k)
+			assert(sums[k] == counts[k]);
+	}
+
+	// only streaming histograms can be shared
+	try
+	{
+		molstat::Histogram unbinned(2);
+		molstat::SharedHistogram shared(unbinned);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// the choice between private and shared histograms
+	const size_t limit{ molstat::SharedHistogram::private_memory_limit /
+		sizeof(size_t) };
+	assert(!molstat::SharedHistogram::preferred(limit * 4, 1));
+	assert(!molstat::SharedHistogram::preferred(limit / 4, 4));
+	assert(molstat::SharedHistogram::preferred(limit / 4 + 1, 4));
+	assert(molstat::SharedHistogram::preferred(limit / 64, 128));
+	assert(!molstat::SharedHistogram::preferred(1000, 128));
+
+	// a smaller memory limit
+	assert(molstat::SharedHistogram::preferred(1000, 4, 16000));
+	assert(!molstat::SharedHistogram::preferred(1000, 4, 32000));
+
+	return 0;
+}
@@ -0,0 +1,186 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_sparse.cc
+ * \brief Test suite for histograms whose counts are stored sparsely.
+ *
+ * \test Tests the sparse storage of the molstat::Histogram class, comparing
+ *    it to dense storage of the same bins, including merging histograms with
+ *    different storage and the switch to dense storage as a histogram fills.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing sparse histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	// 2048^2 bins, enough for sparse storage
+	const vector<shared_ptr<const molstat::BinStyle>> styles{
+		make_shared<molstat::BinLinear>(2048),
+		make_shared<molstat::BinLog>(2048, 10.) };
+	const vector<array<double, 2>> bounds{ {{ 0., 1. }}, {{ 1.e-3, 1. }} };
+	assert(2048 * 2048 >= molstat::Histogram::sparse_min_bins);
+
+	// a few data elements (with duplicates and some out of range), from a
+	// simple linear congruential generator
+	vector<double> data;
+	unsigned long long state{ 2014 };
+	auto uniform = [&state]() -> double
+	{
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (state >> 11) * (1. / 9007199254740992.);
+	};
+	for(size_t k = 0; k < 5000; ++k)
+	{
+		data.push_back(1.2 * uniform() - 0.1);
+		data.push_back(pow(10., -3.2 * uniform()));
+	}
+	data.insert(data.end(), data.begin(), data.begin() + 200);
+	const size_t ndata{ data.size() / 2 };
+
+	// fill enough of a histogram (every bin in the first rows) that it is
+	// stored densely
+	molstat::Histogram fill(styles, bounds);
+	assert(fill.isSparse());
+	{
+		const vector<double> &x = fill.getBinCoordinates(0),
+			&y = fill.getBinCoordinates(1);
+		vector<double> grid;
+		for(size_t j = 0; j < 2048 / molstat::Histogram::sparse_occupancy + 1;
+			++j)
+		{
+			for(size_t i = 0; i < 2048; ++i)
+			{
+				grid.push_back(x[i]);
+				grid.push_back(y[j]);
+			}
+		}
+		fill.add_data(grid.data(), grid.size() / 2);
+	}
+	assert(!fill.isSparse());
+
+	// the same data in sparse and dense storage
+	molstat::Histogram sparse(styles, bounds), dense(fill);
+	sparse.add_data(data.data(), ndata);
+	dense.add_data(data.data(), ndata);
+	assert(sparse.isSparse());
+	assert(!dense.isSparse());
+
+	vector<size_t> raw{ dense.getRawBinCounts() };
+	{
+		const vector<size_t> filled{ fill.getRawBinCounts() };
+		for(size_t j = 0; j < raw.size(); ++j)
+			raw[j] -= filled[j];
+	}
+	assert(sparse.getRawBinCounts() == raw);
+
+	vector<double> weighted(raw.begin(), raw.end());
+	molstat::ApplyBinWeights(weighted,
+		{ dense.getBinWeights(0), dense.getBinWeights(1) });
+	assert(sparse.getBinCounts() == weighted);
+
+	assert(sparse.numOutOfRange() ==
+		dense.numOutOfRange() - fill.numOutOfRange());
+	assert(sparse.numOutOfRange() > 0);
+	for(size_t j = 0; j < 2; ++j)
+	{
+		assert(sparse.numUnderflow(j) ==
+			dense.numUnderflow(j) - fill.numUnderflow(j));
+		assert(sparse.numOverflow(j) ==
+			dense.numOverflow(j) - fill.numOverflow(j));
+	}
+
+	// individual bins
+	{
+		molstat::CounterIndex ci = sparse.begin();
+		for(size_t j = 0; j < 2048 * 600; ++j, ++ci)
+		{
+			const size_t offset{ ci.arrayOffset() };
+			if(raw[offset] == 0 && j % 97 != 0)
+				continue;
+			assert(sparse.getRawBinCount(ci) == raw[offset]);
+			assert(sparse.getBinCount(ci) == weighted[offset]);
+		}
+	}
+
+	// merging histograms with each type of storage
+	{
+		molstat::Histogram a(sparse), b(sparse);
+		a.merge(move(b));
+		assert(a.isSparse());
+		assert(b.getRawBinCounts() == vector<size_t>(raw.size(), 0));
+		assert(a.numOutOfRange() == 2 * sparse.numOutOfRange());
+
+		vector<size_t> twice{ raw };
+		for(size_t &count : twice)
+			count *= 2;
+		assert(a.getRawBinCounts() == twice);
+	}
+	{
+		molstat::Histogram a(fill), b(sparse);
+		a.merge(move(b));
+		assert(!a.isSparse());
+		assert(a.getRawBinCounts() == dense.getRawBinCounts());
+	}
+	{
+		molstat::Histogram a(sparse), b(fill);
+		a.merge(move(b));
+		assert(!a.isSparse());
+		assert(a.getRawBinCounts() == dense.getRawBinCounts());
+	}
+
+	// the storage of replaced counts depends on their occupancy
+	{
+		molstat::Histogram a(fill);
+		a.setRawBinCounts(raw, 0, { {{0, 0}}, {{0, 0}} });
+		assert(a.isSparse());
+		assert(a.getRawBinCounts() == raw);
+
+		a.setRawBinCounts(fill.getRawBinCounts(), 0, { {{0, 0}}, {{0, 0}} });
+		assert(!a.isSparse());
+		assert(a.getRawBinCounts() == fill.getRawBinCounts());
+	}
+
+	// store, then bin: a few data elements in many bins
+	{
+		molstat::Histogram stored(2);
+		stored.add_data(data.data(), ndata);
+		stored.bin_data(styles, stored.getDataExtremes());
+		assert(stored.isSparse());
+
+		size_t total{ 0 };
+		for(const size_t count : stored.getRawBinCounts())
+			total += count;
+		assert(total == ndata);
+	}
+
+	// few bins are always stored densely
+	{
+		molstat::Histogram small({ make_shared<molstat::BinLinear>(10) },
+			{ {{ 0., 1. }} });
+		assert(!small.isSparse());
+	}
+
+	return 0;
+}
@@ -0,0 +1,290 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_streaming.cc
+ * \brief Test suite for histograms in streaming mode (fixed bounds).
+ *
+ * \test Tests the streaming mode of the molstat::Histogram class, comparing
+ *    it to the usual (store, then bin) mode.
+ *
+ * \author Matthew G.\ Reuter
+ * \date October 2014
+ */
+
+#include <cassert>
+#include <cmath>
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+#include <general/string_tools.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing streaming histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh = 1.0e-6;
+	shared_ptr<const molstat::BinStyle> blinear
+		{ make_shared<molstat::BinLinear>(5) };
+	shared_ptr<const molstat::BinStyle> blog
+		{ make_shared<molstat::BinLog>(4, 10.) };
+
+	// bad constructions
+	try
+	{
+		// wrong number of bounds
+		molstat::Histogram bad({ blinear }, {});
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	try
+	{
+		// bounds that are not increasing
+		molstat::Histogram bad({ blinear }, {{{ 1., 0. }}});
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	try
+	{
+		// bounds outside the domain of the mask
+		molstat::Histogram bad({ blog }, {{{ -1., 1. }}});
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// the data from histogram1d_linear; the bounds are the same as the
+	// extremes of that data, so the results should be identical
+	molstat::Histogram hist({ blinear }, {{{ 0., 1. }}});
+	assert(hist.isStreaming());
+	const size_t bins_memory{ hist.memoryUsage() };
+	assert(bins_memory >= 5 * sizeof(size_t));
+
+	hist.add_data({0.00}); // 1
+	hist.add_data({1.00}); // 5
+	hist.add_data({0.12}); // 1
+	hist.add_data({0.87}); // 5
+	hist.add_data({0.66}); // 4
+	hist.add_data({0.50}); // 3
+	hist.add_data({0.92}); // 5
+	hist.add_data({0.42}); // 3
+	hist.add_data({0.21}); // 2
+	hist.add_data({0.18}); // 1
+	hist.add_data({0.04}); // 1
+	hist.add_data({0.99}); // 5
+	hist.add_data({0.77}); // 4
+
+	// out-of-range data
+	hist.add_data({-0.01});
+	hist.add_data({1.01});
+	assert(hist.numOutOfRange() == 2);
+
+	// the data are binned, not stored
+	assert(hist.memoryUsage() == bins_memory);
+
+	// wrong dimensionality
+	try
+	{
+		hist.add_data({ 0.4, 0.3 });
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// cannot bin a streaming histogram (it is already binned)
+	try
+	{
+		hist.bin_data({ blinear });
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	// merge in another streaming histogram
+	{
+		molstat::Histogram other({ blinear }, {{{ 0., 1. }}});
+		other.add_data({0.35}); // 2
+		other.add_data({2.00}); // out of range
+		hist.merge(move(other));
+		assert(hist.numOutOfRange() == 3);
+
+		// cannot merge a streaming and non-streaming histogram
+		molstat::Histogram stored(1);
+		try
+		{
+			hist.merge(move(stored));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+
+		// cannot merge histograms with different bins
+		molstat::Histogram different({ blinear }, {{{ 0., 2. }}});
+		try
+		{
+			hist.merge(move(different));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	const double counts[] = { 4., 2., 2., 2., 4. };
+	const double coords[] = { 0.1, 0.3, 0.5, 0.7, 0.9 };
+	molstat::CounterIndex iter = hist.begin();
+	for(size_t j = 0; j < 5; ++j, ++iter)
+	{
+		assert(abs(hist.getCoordinates(iter)[0] - coords[j]) < thresh);
+		assert(abs(hist.getBinCount(iter) -
+			counts[j]*blinear->dmaskdx(coords[j])) < thresh);
+	}
+	assert(iter.at_end());
+
+	// 2D, mixed binning styles: compare against the usual mode
+	molstat::Histogram stream2d({ blinear, blog },
+		{{{ 0., 1. }}, {{ 1., 1.e4 }}});
+	molstat::Histogram stored2d(2);
+	for(size_t j = 0; j < 200; ++j)
+	{
+		// deterministic data that covers the whole range
+		valarray<double> v{ 0.5 + 0.5*sin(0.37*j),
+			pow(10., 2. + 2.*cos(0.91*j)) };
+		stream2d.add_data(v);
+		stored2d.add_data(v);
+	}
+	// add the corners so that the extremes match the bounds
+	stored2d.add_data({ 0., 1. });
+	stored2d.add_data({ 1., 1.e4 });
+	stream2d.add_data({ 0., 1. });
+	stream2d.add_data({ 1., 1.e4 });
+	assert(stream2d.numOutOfRange() == 0);
+
+	stored2d.bin_data({ blinear, blog });
+
+	for(molstat::CounterIndex ci{ stored2d.begin() }; !ci.at_end(); ++ci)
+	{
+		const valarray<double> c1 = stored2d.getCoordinates(ci);
+		const valarray<double> c2 = stream2d.getCoordinates(ci);
+		assert(abs(c1[0] - c2[0]) < thresh * abs(c1[0]) + thresh);
+		assert(abs(c1[1] - c2[1]) < thresh * abs(c1[1]));
+		assert(abs(stored2d.getBinCount(ci) - stream2d.getBinCount(ci))
+			< thresh * abs(stored2d.getBinCount(ci)) + thresh);
+	}
+
+	// fixed bounds through the binning style and the factory
+	{
+		shared_ptr<molstat::BinStyle> bstyle
+			{ molstat::BinStyleFactory(molstat::tokenize("4 log bounds 1 1e4")) };
+		assert(bstyle->hasBounds());
+		assert(abs(bstyle->getBounds()[0] - 1.) < thresh);
+		assert(abs(bstyle->getBounds()[1] - 1.e4) < thresh);
+
+		bstyle = molstat::BinStyleFactory(
+			molstat::tokenize("3 log 2 bounds 1 8"));
+		assert(bstyle->hasBounds());
+		assert(abs(bstyle->getBounds()[1] - 8.) < thresh);
+
+		bstyle = molstat::BinStyleFactory(molstat::tokenize("3 linear"));
+		assert(!bstyle->hasBounds());
+		try
+		{
+			bstyle->getBounds();
+			assert(false);
+		}
+		catch(const logic_error &e)
+		{
+			// should be here
+		}
+
+		const char *bad[] = { "3 linear bounds 1", "3 linear bounds 2 1",
+			"3 linear extra", "3 log bounds 0 1", "3 linear bounds a b" };
+		for(const char *line : bad)
+		{
+			try
+			{
+				molstat::BinStyleFactory(molstat::tokenize(line));
+				assert(false);
+			}
+			catch(const invalid_argument &e)
+			{
+				// should be here
+			}
+		}
+
+		// need bounds in each dimension
+		try
+		{
+			molstat::Histogram nobounds({ bstyle });
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+
+		// 2D histogram with underflows and overflows
+		bstyle->setBounds(-1., 1.);
+		shared_ptr<molstat::BinStyle> bstyle2
+			{ make_shared<molstat::BinLinear>(2) };
+		bstyle2->setBounds(0., 10.);
+		molstat::Histogram hist2d({ bstyle, bstyle2 });
+
+		hist2d.add_data({ 0., 5. });   // binned
+		hist2d.add_data({ -2., 5. });  // underflow in dimension 0
+		hist2d.add_data({ 2., -1. });  // overflow in 0, underflow in 1
+		hist2d.add_data({ 0.5, 11. }); // overflow in 1
+		hist2d.add_data({ 1., 10. });  // binned (upper bounds)
+
+		assert(hist2d.numOutOfRange() == 3);
+		assert(hist2d.numUnderflow(0) == 1);
+		assert(hist2d.numOverflow(0) == 1);
+		assert(hist2d.numUnderflow(1) == 1);
+		assert(hist2d.numOverflow(1) == 1);
+
+		try
+		{
+			hist2d.numOverflow(2);
+			assert(false);
+		}
+		catch(const out_of_range &e)
+		{
+			// should be here
+		}
+
+		double total{ 0. };
+		for(molstat::CounterIndex ci{ hist2d.begin() }; !ci.at_end(); ++ci)
+			total += hist2d.getBinCount(ci);
+		assert(abs(total - 2.) < thresh);
+	}
+
+	return 0;
+}
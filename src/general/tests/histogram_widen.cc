@@ -0,0 +1,188 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_widen.cc
+ * \brief Test suite for widening the bins of streaming histograms.
+ *
+ * \test Tests keeping the data outside the bounds of a streaming
+ *    molstat::Histogram, widening its bins to include them, and binning the
+ *    stored data of another histogram.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the widening of histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh = 1.0e-12;
+	const vector<shared_ptr<const molstat::BinStyle>> styles{
+		make_shared<molstat::BinLinear>(10),
+		make_shared<molstat::BinLog>(6, 10.) };
+
+	// data from a simple linear congruential generator; the first dimension
+	// is in [-0.5, 2.5] and the second in [1e-4, 1e2] (some are negative)
+	vector<double> data;
+	unsigned long long state{ 2014 };
+	auto uniform = [&state]() -> double
+	{
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (state >> 11) * (1. / 9007199254740992.);
+	};
+	const size_t ndata{ 5000 };
+	for(size_t k = 0; k < ndata; ++k)
+	{
+		data.push_back(3. * uniform() - 0.5);
+		data.push_back(k % 100 == 0 ? -1. : pow(10., 6. * uniform() - 4.));
+	}
+
+	// the histogram keeps the data outside [0, 1] x [1e-3, 1]
+	molstat::Histogram hist(styles, {{{ 0., 1. }}, {{ 1.e-3, 1. }}});
+	hist.retainOutOfRange(true);
+	hist.add_data(data.data(), ndata / 2);
+
+	// half of the data are binned by another histogram (with the same bins),
+	// and the kept data are merged
+	{
+		molstat::Histogram other(styles, {{{ 0., 1. }}, {{ 1.e-3, 1. }}});
+		other.retainOutOfRange(true);
+		other.add_data(&data[ndata], ndata / 2);
+		hist.merge(move(other));
+	}
+	assert(hist.numRetained() == hist.numOutOfRange());
+	assert(hist.numRetained() > ndata / 2);
+
+	// the extremes (masked) of the kept data; negative values are ignored
+	const vector<array<double, 2>> extremes{ hist.getRetainedExtremes() };
+	assert(extremes[0][0] >= -0.5 && extremes[0][0] < -0.49);
+	assert(extremes[0][1] <= 2.5 && extremes[0][1] > 2.49);
+	assert(extremes[1][0] >= -4. && extremes[1][0] < -3.99);
+	assert(extremes[1][1] <= 2. && extremes[1][1] > 1.99);
+
+	assert(hist.widen(extremes));
+
+	// dimension 0: 5 bins below and 15 above, so the width is quadrupled and
+	// the 10 extra bins are split between the sides. dimension 1: 2 bins
+	// below and 4 above, so the width is doubled (with no extra bins).
+	{
+		const auto bounds0 = hist.getMaskedBounds(0);
+		const auto bounds1 = hist.getMaskedBounds(1);
+		assert(abs(bounds0[0] + 1.) < thresh && abs(bounds0[1] - 3.) < thresh);
+		assert(abs(bounds1[0] + 4.) < thresh && abs(bounds1[1] - 2.) < thresh);
+	}
+
+	// the same as binning all of the data in the final bins
+	{
+		molstat::Histogram reference(styles, {{{ -1., 3. }}, {{ 1.e-4, 1.e2 }}});
+		reference.add_data(data.data(), ndata);
+
+		assert(hist.getRawBinCounts() == reference.getRawBinCounts());
+		assert(hist.numOutOfRange() == reference.numOutOfRange());
+		assert(hist.numOutOfRange() == ndata / 100);
+		assert(hist.numRetained() == 0);
+		for(size_t j = 0; j < 2; ++j)
+		{
+			assert(hist.numUnderflow(j) == reference.numUnderflow(j));
+			assert(hist.numOverflow(j) == reference.numOverflow(j));
+			for(size_t k = 0; k < hist.numBins(j); ++k)
+			{
+				assert(abs(hist.getBinCoordinates(j)[k] -
+					reference.getBinCoordinates(j)[k]) < thresh);
+				assert(abs(hist.getBinWeights(j)[k] /
+					reference.getBinWeights(j)[k] - 1.) < thresh);
+			}
+		}
+	}
+
+	// nothing changes if the extremes are inside the bounds (or unknown)
+	assert(!hist.widen({ {{ 0., 1. }}, {{ numeric_limits<double>::max(),
+		numeric_limits<double>::lowest() }} }));
+	assert(abs(hist.getMaskedBounds(0)[1] - 3.) < thresh);
+
+	// only overflows: the lower bound stays
+	{
+		molstat::Histogram one({ styles[0] }, {{{ 0., 1. }}});
+		const vector<double> values{ 0.05, 0.55, 1.15 };
+		one.add_data(values.data(), values.size());
+		assert(one.numRetained() == 0);
+		assert(one.numOutOfRange() == 1);
+
+		// the values outside were not kept, so they remain outside
+		assert(one.widen({ {{ 0.05, 1.15 }} }));
+		assert(abs(one.getMaskedBounds(0)[0]) < thresh);
+		assert(abs(one.getMaskedBounds(0)[1] - 2.) < thresh);
+		assert(one.numOutOfRange() == 1);
+		const vector<size_t> expected{ 1, 0, 1, 0, 0, 0, 0, 0, 0, 0 };
+		assert(one.getRawBinCounts() == expected);
+
+		one.retainOutOfRange(true);
+		one.add_data(values.data() + 2, 1);
+		assert(one.numRetained() == 0);
+		const double far{ 5. };
+		one.add_data(&far, 1);
+		assert(one.numRetained() == 1);
+		one.retainOutOfRange(false);
+		assert(one.numRetained() == 0);
+	}
+
+	// binning the stored data of another histogram
+	{
+		molstat::Histogram stored(2);
+		stored.add_data(data.data(), ndata);
+
+		molstat::Histogram streamed(styles, {{{ 0., 1. }}, {{ 1.e-3, 1. }}});
+		streamed.add_stored(move(stored));
+
+		molstat::Histogram reference(styles, {{{ 0., 1. }}, {{ 1.e-3, 1. }}});
+		reference.add_data(data.data(), ndata);
+		assert(streamed.getRawBinCounts() == reference.getRawBinCounts());
+		assert(streamed.numOutOfRange() == reference.numOutOfRange());
+
+		try
+		{
+			// the stored histogram must not be streaming
+			molstat::Histogram bad(styles, {{{ 0., 1. }}, {{ 1.e-3, 1. }}});
+			streamed.add_stored(move(bad));
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+	}
+
+	// only streaming histograms keep data outside the bounds
+	try
+	{
+		molstat::Histogram stored(2);
+		stored.retainOutOfRange(true);
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
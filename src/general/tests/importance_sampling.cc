@@ -0,0 +1,321 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file importance_sampling.cc
+ * \brief Test suite for importance sampling.
+ *
+ * \test Tests the densities of the distributions, weighted histograms
+ *    (molstat::Histogram::useWeights), and the weights of the trials from
+ *    molstat::Simulator::setProposal.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/empirical.h>
+#include <general/random_distributions/gamma.h>
+#include <general/random_distributions/lognormal.h>
+#include <general/random_distributions/normal.h>
+#include <general/random_distributions/truncated.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/simulator.h>
+#include <general/simulator_tools/simulator_exceptions.h>
+
+using namespace std;
+
+/**
+ * \brief Checks that a density is normalized and has the same mean as the
+ *    samples of its distribution.
+ *
+ * \param[in] dist The distribution.
+ * \param[in] lower The lower end of the region with the probability.
+ * \param[in] upper The upper end of the region with the probability.
+ * \param[in,out] engine The engine for the samples.
+ */
+static void check_density(const molstat::RandomDistribution &dist,
+	const double lower, const double upper, molstat::Engine &engine)
+{
+	assert(dist.hasDensity());
+
+	// the midpoint rule
+	const size_t npoints = 200000;
+	const double h{ (upper - lower) / npoints };
+	vector<double> x(npoints), logf(npoints);
+	for(size_t j = 0; j < npoints; ++j)
+		x[j] = lower + (j + 0.5) * h;
+	dist.log_density_n(x.data(), logf.data(), npoints);
+
+	double norm{ 0. }, mean{ 0. };
+	for(size_t j = 0; j < npoints; ++j)
+	{
+		norm += exp(logf[j]) * h;
+		mean += x[j] * exp(logf[j]) * h;
+	}
+	assert(abs(norm - 1.) < 1.e-3);
+
+	const size_t nsamples = 200000;
+	vector<double> samples(nsamples);
+	dist.sample_n(engine, samples.data(), nsamples);
+	double sample_mean{ 0. };
+	for(const double s : samples)
+		sample_mean += s / nsamples;
+	assert(abs(mean - sample_mean) < 0.02 * max(1., abs(mean)));
+}
+
+/**
+ * \brief Main function for testing importance sampling.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	molstat::Engine engine{ 0x1DEA };
+	const double inf{ numeric_limits<double>::infinity() };
+
+	// the densities of the distributions
+	check_density(molstat::UniformDistribution(-1., 3.), -2., 4., engine);
+	check_density(molstat::NormalDistribution(1., 2.), -19., 21., engine);
+	check_density(molstat::LognormalDistribution(0.5, 0.4), 0., 20., engine);
+	check_density(molstat::GammaDistribution(2.5, 0.5), 0., 20., engine);
+	check_density(molstat::TruncatedNormalDistribution(1., 2., 0., 3.), -1.,
+		4., engine);
+	check_density(molstat::TruncatedNormalDistribution(0., 1., 2., 4.), 1.,
+		5., engine);
+	check_density(molstat::TruncatedLognormalDistribution(0.5, 0.4, 1., 3.),
+		0., 4., engine);
+	check_density(molstat::EmpiricalDistribution({ 0.5, 1.5, 2.5 },
+		{ 1., 0., 3. }), 0., 3., engine);
+
+	// a value without probability
+	{
+		const double x{ 5. };
+		double logf;
+		molstat::UniformDistribution(-1., 3.).log_density_n(&x, &logf, 1);
+		assert(logf == -inf);
+	}
+
+	// distributions without densities
+	for(const shared_ptr<const molstat::RandomDistribution> &dist :
+		vector<shared_ptr<const molstat::RandomDistribution>>{
+			make_shared<molstat::ConstantDistribution>(1.),
+			make_shared<molstat::EmpiricalDistribution>(vector<double>{ 1. },
+				vector<double>{ 1. }) })
+	{
+		assert(!dist->hasDensity());
+
+		const double x{ 1. };
+		double logf;
+		try
+		{
+			dist->log_density_n(&x, &logf, 1);
+			assert(false);
+		}
+		catch(const logic_error &e)
+		{
+			// should be here
+		}
+	}
+
+	// weighted histograms
+	{
+		shared_ptr<molstat::BinStyle> bstyle
+			{ make_shared<molstat::BinLinear>(4) };
+		bstyle->setBounds(0., 4.);
+		const vector<shared_ptr<const molstat::BinStyle>> bstyles{ bstyle };
+
+		molstat::Histogram hist(bstyles), other(bstyles);
+		const vector<double> v{ 0.5, 1.5, 1.7, 3.5, 5. },
+			w{ 0.25, 2., 1., 0.5, 10. };
+
+		// unit counts before the weights are used
+		hist.add_data(v.data(), 1);
+		assert(!hist.isWeighted());
+		hist.add_data(v.data() + 1, w.data() + 1, v.size() - 1);
+		assert(hist.isWeighted());
+		assert((hist.getRawBinSums() == vector<double>{ 1., 3., 0., 0.5 }));
+		assert((hist.getRawBinCounts() == vector<size_t>{ 1, 2, 0, 1 }));
+		assert(hist.numOutOfRange() == 1);
+
+		// the bin counts are the weights
+		const vector<double> counts{ hist.getBinCounts() };
+		const vector<double> sums{ hist.getRawBinSums() };
+		for(size_t j = 0; j < 4; ++j)
+			assert(abs(counts[j] - sums[j]) < 1.e-12);
+
+		// merging with an unweighted histogram
+		other.add_data(v.data(), 3);
+		hist.merge(move(other));
+		assert((hist.getRawBinSums() == vector<double>{ 2., 5., 0., 0.5 }));
+		assert((other.getRawBinSums() == vector<double>{ 0., 0., 0., 0. }));
+
+		// the sums can be set (as when combining processes)
+		hist.setRawBinCounts({ 1, 1, 1, 1 }, 0, { {{ 0, 0 }} });
+		hist.setRawBinSums({ 1., 2., 3., 4. });
+		assert((hist.getRawBinSums() == vector<double>{ 1., 2., 3., 4. }));
+		try
+		{
+			hist.setRawBinSums({ 1. });
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+
+		// the data outside the bounds cannot be kept
+		try
+		{
+			hist.retainOutOfRange(true);
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+
+		// only streaming histograms are weighted
+		try
+		{
+			molstat::Histogram(1).useWeights();
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+
+		assert(molstat::HellingerDistance(hist.getRawBinSums(),
+			hist.getRawBinSums()) < 1.e-12);
+	}
+
+	// a normal parameter sampled from a wider, shifted proposal
+	{
+		molstat::SimulateModelFactory factory
+			{ molstat::SimulateModelFactory::makeFactory<BasicTestModel>() };
+		factory.setDistribution("a",
+			make_shared<molstat::NormalDistribution>(0., 1.));
+		const shared_ptr<molstat::SimulateModel> model{ factory.getModel() };
+
+		molstat::Simulator sim{ model };
+		sim.setObservable(0, type_index{ typeid(BasicObs1) });
+		assert(!sim.isWeighted());
+
+		// without proposals, every weight is 1
+		const size_t n = 200000;
+		vector<double> out(n), weights(n), workspace;
+		assert(sim.simulateBatch(engine, 10, out.data(), workspace, nullptr,
+			nullptr, nullptr, weights.data()) == 10);
+		for(size_t t = 0; t < 10; ++t)
+			assert(weights[t] == 1.);
+
+		sim.setProposal(*model, "A",
+			make_shared<molstat::NormalDistribution>(2., 1.5));
+		assert(sim.isWeighted());
+		assert(sim.simulateBatch(engine, n, out.data(), workspace, nullptr,
+			nullptr, nullptr, weights.data()) == n);
+
+		// the weighted averages are over the standard normal distribution,
+		// including its tail
+		double sum{ 0. }, mean{ 0. }, tail{ 0. };
+		size_t ntail{ 0 };
+		for(size_t t = 0; t < n; ++t)
+		{
+			sum += weights[t];
+			mean += weights[t] * out[t];
+			if(out[t] > 3.)
+			{
+				tail += weights[t];
+				++ntail;
+			}
+		}
+		assert(abs(sum / n - 1.) < 0.02);
+		assert(abs(mean / sum) < 0.02);
+		assert(abs(tail / sum / (0.5 * erfc(3. / sqrt(2.))) - 1.) < 0.05);
+
+		// the proposal samples the tail far more often than the distribution
+		assert(ntail > 100 * 0.5 * erfc(3. / sqrt(2.)) * n / 10);
+
+		// the same weights with quasi-Monte Carlo sampling
+		const molstat::SobolSequence sobol(sim.numQuasiRandomDimensions(),
+			engine);
+		assert(sim.simulateBatchQMC(sobol, 0, engine, 1 << 16, out.data(),
+			workspace, nullptr, nullptr, nullptr, weights.data()) == 1 << 16);
+		sum = mean = 0.;
+		for(size_t t = 0; t < (1 << 16); ++t)
+		{
+			sum += weights[t];
+			mean += weights[t] * out[t];
+		}
+		assert(abs(mean / sum) < 0.01);
+
+		// invalid proposals
+		try
+		{
+			sim.setProposal(*model, "b",
+				make_shared<molstat::NormalDistribution>(0., 1.));
+			assert(false);
+		}
+		catch(const molstat::UnknownParameter &e)
+		{
+			// should be here
+		}
+		try
+		{
+			sim.setProposal(*model, "a",
+				make_shared<molstat::ConstantDistribution>(0.));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+		try
+		{
+			molstat::SimulateModelFactory factory2
+				{ molstat::SimulateModelFactory::makeFactory<BasicTestModel>() };
+			factory2.setDistribution("a",
+				make_shared<molstat::NormalDistribution>(0., 1.));
+			sim.setProposal(*factory2.getModel(), "a",
+				make_shared<molstat::NormalDistribution>(0., 1.));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+
+		// the proposal is discarded when the parameter becomes constant
+		sim.setDistribution(*model, "a",
+			make_shared<molstat::ConstantDistribution>(1.));
+		assert(!sim.isWeighted());
+		try
+		{
+			sim.setProposal(*model, "a",
+				make_shared<molstat::NormalDistribution>(0., 1.));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,186 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file kernel_density.cc
+ * \brief Test suite for kernel density estimates from binned data.
+ *
+ * \test Tests molstat::KernelDensityCounts, comparing the convolutions by
+ *    fast Fourier transform to direct sums, and
+ *    molstat::KernelDensityBandwidths.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/kernel_density.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Smooths bin counts along one dimension with a Gaussian by direct
+ *    summation.
+ *
+ * \param[in] counts The bin counts, with the first dimension changing the
+ *    fastest.
+ * \param[in] n The number of bins in the dimension.
+ * \param[in] stride The distance between consecutive bins in the dimension.
+ * \param[in] sigma The standard deviation of the Gaussian, in bins.
+ * \return The smoothed counts.
+ */
+static vector<double> direct_smooth(const vector<double> &counts,
+	const size_t n, const size_t stride, const double sigma)
+{
+	double sum{ 0. };
+	for(int r = -1000; r <= 1000; ++r)
+		sum += exp(-0.5 * r * r / (sigma * sigma));
+
+	vector<double> ret(counts.size(), 0.);
+	for(size_t i = 0; i < counts.size(); ++i)
+	{
+		const size_t k{ (i / stride) % n };
+		for(size_t l = 0; l < n; ++l)
+		{
+			const double z{ (static_cast<double>(l) - k) / sigma };
+			if(abs(z) <= ceil(8. * sigma) / sigma)
+				ret[i] += counts[i + l * stride - k * stride] *
+					exp(-0.5 * z * z) / sum;
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * \brief Main function for testing kernel density estimates.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh = 1.0e-9;
+	const vector<shared_ptr<const molstat::BinStyle>> styles{
+		make_shared<molstat::BinLinear>(50),
+		make_shared<molstat::BinLog>(37, 10.) };
+	const vector<array<double, 2>> bounds{ {{ -3., 3. }}, {{ 1.e-2, 1. }} };
+
+	// data from a simple linear congruential generator
+	vector<double> data;
+	unsigned long long state{ 2014 };
+	auto uniform = [&state]() -> double
+	{
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (state >> 11) * (1. / 9007199254740992.);
+	};
+	const size_t ndata{ 20000 };
+	for(size_t k = 0; k < ndata; ++k)
+	{
+		const double u1{ uniform() }, u2{ uniform() };
+		data.push_back(sqrt(-2. * log(1. - u1)) * cos(6.283185307179586 * u2));
+		data.push_back(pow(10., -2. * uniform()));
+	}
+
+	molstat::Histogram hist(styles, bounds);
+	hist.add_data(data.data(), ndata);
+
+	// several bandwidths in each dimension (in masked coordinates), including
+	// no smoothing and kernels wider than the histogram
+	const vector<array<double, 2>> cases{ {{ 0., 0. }}, {{ 0.3, 0. }},
+		{{ 0., 0.1 }}, {{ 0.05, 0.02 }}, {{ 10., 5. }} };
+	for(const auto &bw : cases)
+	{
+		const vector<double> kde{ molstat::KernelDensityCounts(hist,
+			{ bw[0], bw[1] }) };
+
+		const vector<size_t> raw{ hist.getRawBinCounts() };
+		vector<double> expected(raw.begin(), raw.end());
+		if(bw[0] > 0.)
+			expected = direct_smooth(expected, 50, 1, bw[0] * 50. / 6.);
+		if(bw[1] > 0.)
+			expected = direct_smooth(expected, 37, 50, bw[1] * 37. / 2.);
+
+		// the same weights as the histogram
+		const vector<double> &w0 = hist.getBinWeights(0),
+			&w1 = hist.getBinWeights(1);
+		assert(kde.size() == expected.size());
+		double scale{ 0. };
+		for(size_t i = 0; i < kde.size(); ++i)
+		{
+			expected[i] *= w0[i % 50] * w1[i / 50];
+			scale = max(scale, abs(expected[i]));
+		}
+		for(size_t i = 0; i < kde.size(); ++i)
+			assert(abs(kde[i] - expected[i]) < thresh * scale);
+
+		if(bw[0] == 0. && bw[1] == 0.)
+			assert(kde == hist.getBinCounts());
+	}
+
+	// smoothing (away from the bounds) preserves the number of data
+	{
+		molstat::Histogram spike({ make_shared<molstat::BinLinear>(200) },
+			{{{ 0., 1. }}});
+		const vector<double> values(1000, 0.5);
+		spike.add_data(values.data(), values.size());
+
+		const vector<double> kde{ molstat::KernelDensityCounts(spike,
+			{ 0.02 }) };
+		const vector<double> &w = spike.getBinWeights(0);
+		double total{ 0. };
+		for(size_t i = 0; i < kde.size(); ++i)
+			total += kde[i] / w[i];
+		assert(abs(total - values.size()) < 1.e-8 * values.size());
+
+		// symmetric about the spike
+		assert(kde[100] > kde[100 - 3]);
+		assert(abs(kde[100 + 3] - kde[100 - 3]) < thresh * kde[100]);
+	}
+
+	// Silverman's rule for the (standard) normal data in dimension 0
+	{
+		const vector<double> h{ molstat::KernelDensityBandwidths(hist) };
+		assert(h.size() == 2);
+		const double n{ static_cast<double>(ndata - hist.numOutOfRange()) };
+		assert(abs(h[0] / (1.06 * pow(n, -0.2)) - 1.) < 0.05);
+		assert(h[1] > 0.);
+
+		molstat::Histogram empty(styles, bounds);
+		assert(molstat::KernelDensityBandwidths(empty) ==
+			vector<double>(2, 0.));
+	}
+
+	// bad bandwidths
+	try
+	{
+		molstat::KernelDensityCounts(hist, { 0.1 });
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	try
+	{
+		molstat::KernelDensityCounts(hist, { 0.1, -0.1 });
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
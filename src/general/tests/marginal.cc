@@ -0,0 +1,164 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file marginal.cc
+ * \brief Test suite for marginal histograms and conditional slices.
+ *
+ * \test Tests molstat::MarginalHistogramData, comparing marginal histograms
+ *    (and slices) of a 3D histogram to histograms of the same data in fewer
+ *    dimensions, and molstat::CheckMarginalSpec.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/marginal.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing marginal histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh = 1.0e-12;
+	const vector<shared_ptr<const molstat::BinStyle>> styles{
+		make_shared<molstat::BinLinear>(4),
+		make_shared<molstat::BinLog>(3, 10.),
+		make_shared<molstat::BinLinear>(5) };
+	const vector<array<double, 2>> bounds{ {{ 0., 2. }}, {{ 1.e-3, 1. }},
+		{{ -1., 1. }} };
+
+	// data from a simple linear congruential generator; some are outside
+	// the bounds of dimension 0
+	vector<double> data;
+	unsigned long long state{ 2014 };
+	auto uniform = [&state]() -> double
+	{
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (state >> 11) * (1. / 9007199254740992.);
+	};
+	const size_t ndata{ 3000 };
+	for(size_t k = 0; k < ndata; ++k)
+	{
+		data.push_back(2.2 * uniform());
+		data.push_back(pow(10., -3. * uniform()));
+		data.push_back(2. * uniform() - 1.);
+	}
+
+	molstat::Histogram hist(styles, bounds);
+	hist.add_data(data.data(), ndata);
+
+	// the marginal histogram of dimensions 2 and 0 (in that order)
+	{
+		molstat::MarginalSpec spec;
+		spec.dimensions = { 2, 0 };
+		const molstat::HistogramData marginal{
+			molstat::MarginalHistogramData(hist, styles, ndata, spec) };
+
+		molstat::Histogram reference({ styles[2], styles[0] },
+			{ bounds[2], bounds[0] });
+		vector<double> values;
+		for(size_t k = 0; k < ndata; ++k)
+		{
+			values.push_back(data[3*k + 2]);
+			values.push_back(data[3*k]);
+		}
+		reference.add_data(values.data(), ndata);
+
+		// the data of dimension 1 are inside its bounds
+		assert(marginal.ntrials == ndata);
+		assert(marginal.nbinned == ndata - reference.numOutOfRange());
+		assert(marginal.coordinates.size() == 2);
+		assert(marginal.coordinates[0] == hist.getBinCoordinates(2));
+		assert(marginal.coordinates[1] == hist.getBinCoordinates(0));
+		assert(abs(marginal.bounds[0][0] + 1.) < thresh);
+		assert(abs(marginal.bounds[1][1] - 2.) < thresh);
+		assert(marginal.styles[0] == styles[2]->info());
+
+		const vector<double> expected{ reference.getBinCounts() };
+		assert(marginal.counts.size() == expected.size());
+		for(size_t k = 0; k < expected.size(); ++k)
+			assert(abs(marginal.counts[k] - expected[k]) <
+				thresh * abs(expected[k]));
+	}
+
+	// a slice: dimension 0 where dimension 1 is in [1e-2, 1] (the upper two
+	// bins) and dimension 2 is in [-1, 0.1] (the lower three bins, whose
+	// coordinates are -0.8, -0.4, and 0)
+	{
+		molstat::MarginalSpec spec;
+		spec.dimensions = { 0 };
+		spec.slices.push_back({ 1, {{ 1.e-2, 1. }} });
+		spec.slices.push_back({ 2, {{ -1., 0.1 }} });
+		const molstat::HistogramData marginal{
+			molstat::MarginalHistogramData(hist, styles, ndata, spec) };
+
+		molstat::Histogram reference({ styles[0] }, { bounds[0] });
+		vector<double> values;
+		for(size_t k = 0; k < ndata; ++k)
+			if(data[3*k + 1] >= 1.e-2 && data[3*k + 1] <= 1. &&
+				data[3*k + 2] >= -1. && data[3*k + 2] < 0.2)
+			{
+				values.push_back(data[3*k]);
+			}
+		reference.add_data(values.data(), values.size());
+
+		assert(marginal.nbinned == values.size() - reference.numOutOfRange());
+		const vector<double> expected{ reference.getBinCounts() };
+		assert(marginal.counts.size() == expected.size());
+		for(size_t k = 0; k < expected.size(); ++k)
+			assert(abs(marginal.counts[k] - expected[k]) <
+				thresh * abs(expected[k]));
+	}
+
+	// the marginal histogram of all the dimensions is the histogram
+	{
+		molstat::MarginalSpec spec;
+		spec.dimensions = { 0, 1, 2 };
+		const molstat::HistogramData marginal{
+			molstat::MarginalHistogramData(hist, styles, ndata, spec) };
+		const vector<double> expected{ hist.getBinCounts() };
+		for(size_t k = 0; k < expected.size(); ++k)
+			assert(abs(marginal.counts[k] - expected[k]) <
+				thresh * abs(expected[k]));
+	}
+
+	// bad specifications
+	const vector<molstat::MarginalSpec> bad{
+		{ {}, {} },
+		{ { 3 }, {} },
+		{ { 0, 0 }, {} },
+		{ { 0 }, { { 0, {{ 0., 1. }} } } },
+		{ { 0 }, { { 4, {{ 0., 1. }} } } },
+		{ { 0 }, { { 1, {{ 1., 0. }} } } } };
+	for(const auto &spec : bad)
+	{
+		try
+		{
+			molstat::CheckMarginalSpec(spec, 3);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/name_registry.cc
+ * \brief Test suite for the registry of named items.
+ *
+ * \test Tests that molstat::NameRegistry finds items by case-insensitive
+ *    name, rejects unregistered names, iterates in the order of the names,
+ *    and detects incorrect hashes.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <general/name_registry.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the registry.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	// the hashes at compile time and run time agree, ignoring case
+	static_assert(molstat::hash_name("Model") == molstat::hash_name("model"),
+		"The hash should ignore case.");
+	assert(molstat::hash_name(string("MODEL")) == molstat::hash_name("model"));
+	assert(molstat::hash_name("model") != molstat::hash_name("models"));
+
+	molstat::NameRegistry<int> registry;
+	registry.add(MOLSTAT_REGISTRY_KEY("ZetaModel"), 3);
+	registry.add(MOLSTAT_REGISTRY_KEY("AlphaModel"), 1);
+	registry.add(MOLSTAT_REGISTRY_KEY("MiddleModel"), 2);
+	assert(registry.size() == 3);
+
+	assert(registry.count("alphamodel") == 1);
+	assert(registry.at("ALPHAMODEL") == 1);
+	assert(registry.at("MiddleModel") == 2);
+	assert(*registry.find("zetamodel") == 3);
+
+	assert(registry.count("betamodel") == 0);
+	assert(registry.count("alphamode") == 0);
+	assert(registry.find("") == nullptr);
+	try
+	{
+		registry.at("betamodel");
+		assert(false);
+	}
+	catch(const out_of_range &e)
+	{
+		// should be here
+	}
+
+	// the items are iterated in the order of their (lowercase) names
+	vector<string> names;
+	for(const auto &entry : registry)
+		names.push_back(entry.first);
+	assert((names == vector<string>{ "alphamodel", "middlemodel",
+		"zetamodel" }));
+
+	// registering a name again replaces the item
+	registry.add(MOLSTAT_REGISTRY_KEY("alphaMODEL"), 4);
+	assert(registry.size() == 3);
+	assert(registry.at("alphamodel") == 4);
+	assert(registry.at("middlemodel") == 2);
+	assert(registry.at("zetamodel") == 3);
+
+	// the hash must be that of the name
+	try
+	{
+		registry.add(molstat::RegistryKey{ "BadModel", 0 }, 5);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+	assert(registry.size() == 3);
+
+	return 0;
+}
@@ -0,0 +1,113 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/nelder_mead.cc
+ * \brief Test suite for the Nelder-Mead minimization.
+ *
+ * \test Tests molstat::MinimizeNelderMead on the Rosenbrock function, on a
+ *    function with a restricted domain, and on a piecewise-constant
+ *    function.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <general/nelder_mead.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the Nelder-Mead minimization.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	// the Rosenbrock function, with its minimum at (1, 1)
+	{
+		const auto rosenbrock = [] (const vector<double> &x) -> double
+		{
+			return 100. * (x[1] - x[0]*x[0]) * (x[1] - x[0]*x[0]) +
+				(1. - x[0]) * (1. - x[0]);
+		};
+
+		const molstat::NelderMeadResult result{ molstat::MinimizeNelderMead(
+			rosenbrock, { -1.2, 1. }, { 0.5, 0.5 }, 5000, 1.e-10) };
+		assert(result.converged);
+		assert(abs(result.x[0] - 1.) < 1.e-4);
+		assert(abs(result.x[1] - 1.) < 1.e-4);
+		assert(result.f < 1.e-8);
+		assert(result.evaluations > result.iterations);
+
+		// too few iterations
+		const molstat::NelderMeadResult partial{ molstat::MinimizeNelderMead(
+			rosenbrock, { -1.2, 1. }, { 0.5, 0.5 }, 5, 1.e-10) };
+		assert(!partial.converged);
+		assert(partial.iterations == 5);
+		assert(partial.f <= rosenbrock({ -1.2, 1. }));
+	}
+
+	// a function defined only for positive x; the minimum is at x = 0.1
+	{
+		const auto restricted = [] (const vector<double> &x) -> double
+		{
+			if(x[0] <= 0.)
+				return numeric_limits<double>::quiet_NaN();
+			return x[0] - 0.1 * log(x[0]);
+		};
+
+		const molstat::NelderMeadResult result{ molstat::MinimizeNelderMead(
+			restricted, { 2. }, { -1.5 }, 1000, 1.e-8) };
+		assert(result.converged);
+		assert(abs(result.x[0] - 0.1) < 1.e-5);
+	}
+
+	// a piecewise-constant function (like a distance between histograms)
+	{
+		const auto steps = [] (const vector<double> &x) -> double
+		{
+			return floor(10. * abs(x[0] - 0.33)) + floor(10. * abs(x[1] + 0.5));
+		};
+
+		const molstat::NelderMeadResult result{ molstat::MinimizeNelderMead(
+			steps, { 1., 1. }, { 0.3, 0.3 }, 1000, 1.e-6) };
+		assert(result.f == 0.);
+		assert(abs(result.x[0] - 0.33) < 0.1);
+		assert(abs(result.x[1] + 0.5) < 0.1);
+	}
+
+	// bad arguments
+	try
+	{
+		molstat::MinimizeNelderMead([] (const vector<double> &x) -> double
+			{ return 0.; }, {}, {}, 10, 1.e-6);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	try
+	{
+		molstat::MinimizeNelderMead([] (const vector<double> &x) -> double
+			{ return 0.; }, { 1., 2. }, { 1. }, 10, 1.e-6);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
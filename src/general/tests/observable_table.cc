@@ -0,0 +1,204 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file observable_table.cc
+ * \brief Test suite for tabulating observables.
+ *
+ * \test Tests molstat::ObservableTable, molstat::SampleModelParameters, and
+ *    molstat::SimulateModel::tabulateObservable.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <typeinfo>
+#include <typeindex>
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/observable_table.h>
+#include <general/simulator_tools/simulator.h>
+#include <general/simulator_tools/simulate_model.h>
+#include <general/simulator_tools/simulator_exceptions.h>
+
+/// Submodel with an observable that counts its evaluations.
+class CountingSubModel
+	: public CompositeSubModel
+{
+public:
+	/// The number of evaluations.
+	static size_t calls;
+
+	virtual double Obs1(const valarray<double> &params) const override
+	{
+		++calls;
+		return CompositeSubModel::Obs1(params);
+	}
+};
+
+size_t CountingSubModel::calls = 0;
+
+/**
+ * \brief Main function for testing tabulated observables.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-12;
+
+	// a bilinear function is interpolated exactly
+	{
+		const molstat::ObservableFunction f =
+			[] (const valarray<double> &params) -> double
+			{
+				return 1. + 2.*params[0] - params[1] + 0.5*params[0]*params[1];
+			};
+		molstat::ObservableTable table(f, { {0., 1.}, {-1., 3.}, {2., 2.} }, 5);
+
+		// the single-valued parameter is not gridded
+		assert(table.size() == 25);
+
+		const valarray<double> p1{ 0.37, 1.2, 2. };
+		assert(abs(table.interpolate(p1) - f(p1)) < thresh);
+		const valarray<double> p2{ 1., 3., 2. };
+		assert(abs(table.interpolate(p2) - f(p2)) < thresh);
+
+		// outside the table
+		assert(std::isnan(table.interpolate({ 1.1, 0., 2. })));
+		assert(std::isnan(table.interpolate({ 0.5, 0., 2.1 })));
+	}
+
+	// a smooth function converges with the grid spacing
+	{
+		const molstat::ObservableFunction f =
+			[] (const valarray<double> &params) -> double
+			{
+				return sin(params[0]);
+			};
+		molstat::ObservableTable coarse(f, { {0., 3.} }, 11);
+		molstat::ObservableTable fine(f, { {0., 3.} }, 101);
+
+		double coarse_err{ 0. }, fine_err{ 0. };
+		for(double x = 0.; x <= 3.; x += 0.01)
+		{
+			coarse_err = max(coarse_err, abs(coarse.interpolate({ x }) - sin(x)));
+			fine_err = max(fine_err, abs(fine.interpolate({ x }) - sin(x)));
+		}
+
+		// linear interpolation error is at most h^2 max|f''| / 8
+		assert(coarse_err <= 0.3 * 0.3 / 8. + thresh);
+		assert(fine_err < coarse_err / 50.);
+	}
+
+	// bad tables
+	try
+	{
+		molstat::ObservableTable([] (const valarray<double> &) { return 0.; },
+			{ {0., 1.} }, 1);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+	try
+	{
+		molstat::ObservableTable([] (const valarray<double> &) { return 0.; },
+			{ {1., 0.} }, 3);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// tabulate a submodel's observable in a composite model
+	{
+		constexpr double ef = 0.3;
+		constexpr size_t nsamples = 200;
+		molstat::Engine engine{ 17, 0, molstat::EngineKind::Xoshiro256pp };
+
+		molstat::SimulateModelFactory cfactory
+			{ molstat::SimulateModelFactory::makeFactory<CompositeTestModelAdd>() };
+		cfactory.setDistribution("ef",
+			make_shared<molstat::ConstantDistribution>(ef));
+		cfactory.setDistribution("v",
+			make_shared<molstat::UniformDistribution>(0.5, 1.5));
+
+		molstat::SimulateModelFactory subfactory
+			{ molstat::SimulateModelFactory::makeFactory<CountingSubModel>() };
+		subfactory.setDistribution("eps",
+			make_shared<molstat::UniformDistribution>(-1., 1.));
+		subfactory.setDistribution("gamma",
+			make_shared<molstat::ConstantDistribution>(0.2));
+		shared_ptr<molstat::SimulateModel> submodel{ subfactory.getModel() };
+
+		cfactory.addSubmodel(submodel);
+		shared_ptr<molstat::SimulateModel> cmodel{ cfactory.getModel() };
+
+		// samples for both models; the submodel gets ef and v
+		const auto samples =
+			molstat::SampleModelParameters(*cmodel, engine, nsamples);
+		assert(samples.size() == 2);
+		assert(samples.at(cmodel.get()).size() == nsamples);
+		const vector<valarray<double>> &subsamples = samples.at(submodel.get());
+		assert(subsamples.size() == nsamples);
+		assert(subsamples[0].size() == 4);
+		assert(abs(subsamples[0][0] - ef) < thresh);
+
+		// the observable (v * (eps - gamma)) is bilinear, so the table is
+		// exact
+		const double error{ submodel->tabulateObservable(
+			type_index{ typeid(BasicObs1) }, subsamples, 9) };
+		assert(error < thresh);
+
+		// the composite observable now uses the table
+		molstat::Simulator sim{ cmodel };
+		sim.setObservable(0, type_index{ typeid(BasicObs1) });
+
+		CountingSubModel::calls = 0;
+		for(size_t j = 0; j < 100; ++j)
+			sim.simulate(engine);
+
+		vector<double> out(100), workspace;
+		assert(sim.simulateBatch(engine, 100, out.data(), workspace) == 100);
+
+		// only the few trials outside the sampled ranges use the exact
+		// observable
+		assert(CountingSubModel::calls < 20);
+		CountingSubModel::calls = 0;
+
+		// outside the table, the exact observable is used
+		const molstat::ObservableFunction obs{ submodel->getObservableFunction(
+			type_index{ typeid(BasicObs1) }) };
+		assert(abs(obs({ ef, 1., 0.5, 0.2 }) - 0.3) < thresh);
+		assert(CountingSubModel::calls == 0);
+		assert(abs(obs({ ef, 2., 0.5, 0.2 }) - 2. * 0.3) < thresh);
+		assert(CountingSubModel::calls == 1);
+
+		// incompatible observable
+		try
+		{
+			submodel->tabulateObservable(type_index{ typeid(BasicObs2) },
+				subsamples, 9);
+			assert(false);
+		}
+		catch(const molstat::IncompatibleObservable &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
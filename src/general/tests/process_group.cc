@@ -0,0 +1,79 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file process_group.cc
+ * \brief Test suite for the processes of a simulation.
+ *
+ * \test Tests the collective operations of molstat::ProcessGroup. The test
+ *    passes with any number of processes (e.g., when run with `mpirun`).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <array>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include <general/simulator_tools/process_group.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the process group.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	molstat::ProcessGroup group(argc, argv);
+	const size_t rank = group.rank(), n = group.size();
+
+	assert(rank < n);
+	assert(group.isRoot() == (rank == 0));
+	if(!molstat::ProcessGroup::distributed())
+		assert(n == 1);
+
+	// the root's string reaches every process
+	string str{ group.isRoot() ? "seed 42\nthreads 4\n" : "" };
+	group.broadcast(str);
+	assert(str == "seed 42\nthreads 4\n");
+
+	// sums of each process's rank
+	vector<double> vals{ 1., double(rank) };
+	vector<size_t> counts{ rank, 2 };
+	group.sumToRoot(vals);
+	group.sumToRoot(counts);
+	if(group.isRoot())
+	{
+		assert(vals[0] == n);
+		assert(vals[1] == n * (n - 1) / 2);
+		assert(counts[0] == n * (n - 1) / 2);
+		assert(counts[1] == 2 * n);
+	}
+	else
+	{
+		assert(vals[1] == rank);
+		assert(counts[0] == rank);
+	}
+
+	assert(group.maxToRoot(rank) == (group.isRoot() ? n - 1 : rank));
+
+	// the extremes over every process
+	vector<array<double, 2>> ranges{ {{ -1. * rank, 1. * rank }},
+		{{ 5., 5. }} };
+	group.extremes(ranges);
+	assert(ranges[0][0] == 1. - n && ranges[0][1] == n - 1.);
+	assert(ranges[1][0] == 5. && ranges[1][1] == 5.);
+
+	assert(group.all(true));
+	assert(!group.all(rank != 0));
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/sample_buffer.cc
+ * \brief Test suite for the molstat::SampleBuffer class.
+ *
+ * \test Tests the molstat::SampleBuffer class: chunking, the per-dimension
+ *    layout, and splicing.
+ *
+ * \author Matthew G.\ Reuter
+ * \date October 2014
+ */
+
+#include <cassert>
+#include <cmath>
+
+#include <general/histogram_tools/sample_buffer.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the molstat::SampleBuffer class.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	// can't have 0 samples per chunk
+	try
+	{
+		molstat::SampleBuffer bad(2, 0);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// use small chunks to test the chunking
+	molstat::SampleBuffer buffer(2, 3);
+	assert(buffer.empty());
+	assert(buffer.dimensionality() == 2);
+	assert(buffer.memoryUsage() == 0);
+
+	for(size_t j = 0; j < 7; ++j)
+		buffer.push_back({ double(j), -double(j) });
+	assert(buffer.size() == 7);
+	assert(buffer.memoryUsage() >= 3 * 6 * sizeof(double));
+
+	// wrong dimensionality
+	try
+	{
+		buffer.push_back({ 1. });
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// 3 chunks: 3, 3, and 1 sample(s); each dimension is contiguous
+	{
+		size_t nchunks{ 0 }, j{ 0 };
+		for(const auto &chunk : buffer)
+		{
+			assert(chunk.count == (nchunks < 2 ? 3 : 1));
+			for(size_t i = 0; i < chunk.count; ++i, ++j)
+			{
+				assert(chunk.dimension(0)[i] == double(j));
+				assert(chunk.dimension(1)[i] == -double(j));
+			}
+			++nchunks;
+		}
+		assert(nchunks == 3);
+		assert(j == 7);
+	}
+
+	// splice in another buffer
+	molstat::SampleBuffer other(2, 3);
+	other.push_back({ 10., -10. });
+	other.push_back({ 11., -11. });
+
+	molstat::SampleBuffer other1d(1);
+	try
+	{
+		buffer.splice(other1d);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	buffer.splice(other);
+	assert(other.empty());
+	assert(other.begin() == other.end());
+	assert(buffer.size() == 9);
+
+	// adding more data should go to the partially filled last chunk
+	buffer.push_back({ 7., -7. });
+	{
+		double sum{ 0. };
+		size_t total{ 0 }, nchunks{ 0 };
+		for(const auto &chunk : buffer)
+		{
+			for(size_t i = 0; i < chunk.count; ++i)
+			{
+				sum += chunk.dimension(0)[i];
+				assert(chunk.dimension(1)[i] == -chunk.dimension(0)[i]);
+			}
+			total += chunk.count;
+			++nchunks;
+		}
+		assert(total == 10);
+		assert(nchunks == 4);
+		assert(abs(sum - 49.) < 1.e-12);
+	}
+
+	buffer.clear();
+	assert(buffer.empty());
+	assert(buffer.memoryUsage() == 0);
+	assert(buffer.begin() == buffer.end());
+
+	return 0;
+}
@@ -0,0 +1,236 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/sample_file.cc
+ * \brief Test suite for writing raw sample files.
+ *
+ * \test Tests molstat::SampleWriter (including concurrent writers and
+ *    buffer handoffs), molstat::ReadSampleFileHeader,
+ *    molstat::SampleFileReader, and molstat::RebinSamples.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <general/histogram_tools/sample_file.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the raw sample files.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	// need at least one value
+	{
+		ostringstream out;
+		try
+		{
+			molstat::SampleWriter bad(out, {}, {});
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// several threads write samples (two values and one parameter) through
+	// small buffers, so that many handoffs occur
+	const size_t nthreads{ 4 }, per_call{ 5 }, ncalls{ 20 };
+	ostringstream out;
+	{
+		molstat::SampleWriter writer(out, { "x", "y" }, { "p" }, 7);
+
+		vector<thread> threads;
+		for(size_t t = 0; t < nthreads; ++t)
+		{
+			threads.emplace_back([&writer, t, per_call, ncalls]() -> void
+			{
+				for(size_t c = 0; c < ncalls; ++c)
+				{
+					vector<double> values(2 * per_call), params(per_call);
+					for(size_t k = 0; k < per_call; ++k)
+					{
+						const double id = (t * ncalls + c) * per_call + k;
+						values[2*k] = id;
+						values[2*k + 1] = -id;
+						params[k] = 0.5 * id;
+					}
+					writer.write(values.data(), params.data(), per_call);
+				}
+			});
+		}
+		for(auto &th : threads)
+			th.join();
+
+		assert(writer.size() == nthreads * ncalls * per_call);
+		writer.close();
+		writer.close(); // no further effect
+
+		try
+		{
+			const double v[2]{ 0., 0. };
+			writer.write(v, v, 1);
+			assert(false);
+		}
+		catch(const logic_error &e)
+		{
+			// should be here
+		}
+	}
+
+	// read the file back
+	istringstream in(out.str());
+	const molstat::SampleFileHeader header{ molstat::ReadSampleFileHeader(in) };
+	assert(header.ndim == 2);
+	assert(header.nparams == 1);
+	assert((header.names == vector<string>{ "x", "y", "p" }));
+	assert(in.tellg() == static_cast<streamoff>(header.size));
+	assert(header.size % 8 == 0);
+
+	const size_t nsamples{ nthreads * ncalls * per_call };
+	assert(out.str().size() == header.size + 3 * sizeof(double) * nsamples);
+
+	vector<double> rows(3 * nsamples);
+	in.read(reinterpret_cast<char*>(rows.data()), rows.size() * sizeof(double));
+	assert(in);
+
+	// each sample appears exactly once, with its values intact
+	vector<bool> seen(nsamples, false);
+	for(size_t k = 0; k < nsamples; ++k)
+	{
+		const size_t id = static_cast<size_t>(rows[3*k]);
+		assert(id < nsamples && !seen[id]);
+		seen[id] = true;
+		assert(rows[3*k + 1] == -rows[3*k]);
+		assert(rows[3*k + 2] == 0.5 * rows[3*k]);
+	}
+
+	// without parameters
+	{
+		ostringstream out2;
+		{
+			molstat::SampleWriter writer(out2, { "g" }, {});
+			const double v[3]{ 1., 2., 3. };
+			writer.write(v, nullptr, 3);
+		} // the destructor finishes the file
+
+		istringstream in2(out2.str());
+		const molstat::SampleFileHeader h2{ molstat::ReadSampleFileHeader(in2) };
+		assert(h2.ndim == 1 && h2.nparams == 0);
+		double v[3];
+		in2.read(reinterpret_cast<char*>(v), sizeof(v));
+		assert(in2 && v[0] == 1. && v[1] == 2. && v[2] == 3.);
+	}
+
+	// map a file and bin it again
+	{
+		const string filename{ "sample_file_test.dat" };
+		const size_t nrebin{ 10007 };
+		vector<double> values(2 * nrebin), params(nrebin);
+		for(size_t k = 0; k < nrebin; ++k)
+		{
+			values[2*k] = sin(0.1 * k);
+			values[2*k + 1] = exp(cos(0.3 * k));
+			params[k] = k;
+		}
+
+		{
+			ofstream fout(filename, ios_base::binary);
+			molstat::SampleWriter writer(fout, { "a", "b" }, { "k" }, 100);
+			writer.write(values.data(), params.data(), nrebin);
+			writer.close();
+		}
+
+		const molstat::SampleFileReader samples(filename);
+		assert(samples.size() == nrebin);
+		assert(samples.rowLength() == 3);
+		assert(samples.data()[3 * 17 + 2] == 17.);
+
+		// bounds from the data: the same as binning the data directly
+		shared_ptr<molstat::BinStyle> blinear{
+			make_shared<molstat::BinLinear>(13) };
+		shared_ptr<molstat::BinStyle> blog{
+			make_shared<molstat::BinLog>(7, 10.) };
+		const vector<shared_ptr<const molstat::BinStyle>> styles{ blog,
+			blinear };
+
+		molstat::Histogram direct(2);
+		for(size_t k = 0; k < nrebin; ++k)
+			direct.add_data({ values[2*k + 1], values[2*k] });
+		direct.bin_data(styles);
+
+		const molstat::Histogram rebinned{ molstat::RebinSamples(samples,
+			{ 1, 0 }, styles, 3) };
+		for(molstat::CounterIndex ci{ direct.begin() }; !ci.at_end(); ++ci)
+		{
+			assert(abs(rebinned.getBinCount(ci) - direct.getBinCount(ci)) <=
+				1.e-12 * abs(direct.getBinCount(ci)));
+			assert(abs(rebinned.getCoordinates(ci)[0] -
+				direct.getCoordinates(ci)[0]) < 1.e-12);
+		}
+
+		// fixed bounds: samples outside of them are counted
+		shared_ptr<molstat::BinStyle> bfixed{
+			make_shared<molstat::BinLinear>(4) };
+		bfixed->setBounds(0., 1.);
+		const molstat::Histogram positive{ molstat::RebinSamples(samples,
+			{ 0 }, { bfixed }, 4) };
+		size_t npositive{ 0 };
+		for(size_t k = 0; k < nrebin; ++k)
+			if(values[2*k] >= 0.)
+				++npositive;
+		assert(positive.numOutOfRange() == nrebin - npositive);
+
+		// a column that does not exist
+		try
+		{
+			molstat::RebinSamples(samples, { 3 }, { blinear }, 1);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+
+		remove(filename.c_str());
+	}
+
+	// not a sample file
+	{
+		istringstream bad("MOLSTATH");
+		try
+		{
+			molstat::ReadSampleFileHeader(bad);
+			assert(false);
+		}
+		catch(const runtime_error &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
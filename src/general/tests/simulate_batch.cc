@@ -0,0 +1,512 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file simulate_batch.cc
+ * \brief Test suite for simulating batches of trials.
+ *
+ * \test Tests molstat::SimulateModel::generateParameterBatch and
+ *    molstat::Simulator::simulateBatch, including composite models, trials
+ *    that do not produce an observable, and the tallies of such trials,
+ *    molstat::Simulator::setDistribution, and the pruning of parameters that
+ *    the observables do not read.
+ *
+ * \author Matthew G.\ Reuter
+ * \date October 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <typeinfo>
+#include <typeindex>
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/simulator.h>
+#include <general/simulator_tools/simulate_model.h>
+#include <general/simulator_tools/simulator_exceptions.h>
+
+/// Model whose observable is only produced for half of the parameters.
+class RejectTestModel :
+	public BasicObs1
+{
+public:
+	virtual double Obs1(const valarray<double> &params) const override
+	{
+		if(params[0] >= 0.5)
+			throw molstat::NoObservableProduced();
+
+		return params[0];
+	}
+
+	virtual vector<string> get_names() const override
+	{
+		return { "a" };
+	}
+};
+
+/// Submodel whose observable (v * eps) declares the parameters it reads.
+class PrunedSubModel
+	: public TestSubmodelType,
+	  public BasicObs1
+{
+protected:
+	virtual vector<string> get_names() const override
+	{
+		return { "eps", "gamma" };
+	}
+
+public:
+	PrunedSubModel()
+	{
+		setObservableParameters<BasicObs1>({ 1, 2 });
+	}
+
+	virtual double Obs1(const valarray<double> &params) const override
+	{
+		return params[1] * params[2];
+	}
+};
+
+/**
+ * \brief Model with two observables that signal rejections without
+ *    exceptions (Obs1) and with exceptions (Obs2).
+ */
+class MixedRejectTestModel :
+	public BasicObs1,
+	public BasicObs2
+{
+public:
+	virtual double Obs1(const valarray<double> &params) const override
+	{
+		if(params[0] >= 0.5)
+			return molstat::NoObservableValue;
+
+		return params[0];
+	}
+
+	virtual double Obs2(const valarray<double> &params) const override
+	{
+		if(params[0] < 0.25)
+			throw molstat::NoObservableProduced();
+
+		return 2. * params[0];
+	}
+
+	virtual vector<string> get_names() const override
+	{
+		return { "a" };
+	}
+};
+
+/**
+ * \brief Model whose batch kernel hoists the part of its observable that
+ *    depends only on a constant parameter.
+ */
+class HoistTestModel :
+	public BasicObs1
+{
+public:
+	/// The number of times exp(b) has been calculated.
+	static size_t exp_calls;
+
+	HoistTestModel()
+	{
+		setBatchObservableKernel<BasicObs1, HoistTestModel>(
+			[] (const HoistTestModel &model, const double *const *params,
+				size_t n, double *out) -> void
+			{
+				double b;
+				if(model.isConstantParameter(1, b))
+				{
+					++exp_calls;
+					const double expb{ exp(b) };
+					for(size_t t = 0; t < n; ++t)
+						out[t] = params[0][t] * expb;
+				}
+				else
+				{
+					for(size_t t = 0; t < n; ++t)
+					{
+						++exp_calls;
+						out[t] = params[0][t] * exp(params[1][t]);
+					}
+				}
+			});
+	}
+
+	virtual double Obs1(const valarray<double> &params) const override
+	{
+		return params[0] * exp(params[1]);
+	}
+
+	virtual vector<string> get_names() const override
+	{
+		return { "a", "b" };
+	}
+};
+
+size_t HoistTestModel::exp_calls = 0;
+
+/**
+ * \brief Main function for testing batch simulation.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-6;
+	constexpr double ef = 7.5, v = -6.3;
+	constexpr double eps1 = 4.1, gamma1 = 1.2, eps2 = -14.1, gamma2 = 2.9;
+	constexpr size_t ntrials = 10;
+
+	molstat::Engine engine;
+	vector<double> workspace;
+
+	// composite model with two submodels
+	molstat::SimulateModelFactory cfactory
+		{ molstat::SimulateModelFactory::makeFactory<CompositeTestModelAdd>() };
+	cfactory.setDistribution("ef",
+		make_shared<molstat::ConstantDistribution>(ef));
+	cfactory.setDistribution("v",
+		make_shared<molstat::ConstantDistribution>(v));
+
+	molstat::SimulateModelFactory subfactory1
+		{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+	subfactory1.setDistribution("eps",
+		make_shared<molstat::ConstantDistribution>(eps1));
+	subfactory1.setDistribution("gamma",
+		make_shared<molstat::ConstantDistribution>(gamma1));
+	molstat::SimulateModelFactory subfactory2
+		{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+	subfactory2.setDistribution("eps",
+		make_shared<molstat::ConstantDistribution>(eps2));
+	subfactory2.setDistribution("gamma",
+		make_shared<molstat::ConstantDistribution>(gamma2));
+
+	cfactory.addSubmodel(subfactory1.getModel());
+	cfactory.addSubmodel(subfactory2.getModel());
+	shared_ptr<molstat::SimulateModel> cmodel{ cfactory.getModel() };
+
+	// the parameters are parameter-major and ordered as in generateParameters
+	{
+		const size_t nparams{ cmodel->get_num_parameters() };
+		assert(nparams == 6);
+
+		vector<double> params(nparams * ntrials);
+		cmodel->generateParameterBatch(engine, ntrials, params.data());
+		const valarray<double> single{ cmodel->generateParameters(engine) };
+
+		for(size_t p = 0; p < nparams; ++p)
+			for(size_t t = 0; t < ntrials; ++t)
+				assert(abs(params[p*ntrials + t] - single[p]) < thresh);
+
+		// the parameters can be written in place, at an offset in a buffer
+		vector<double> buffer(nparams + 2, -1.);
+		cmodel->generateParameters(engine, buffer.data() + 1);
+		assert(buffer.front() == -1. && buffer.back() == -1.);
+		for(size_t p = 0; p < nparams; ++p)
+			assert(abs(buffer[p + 1] - single[p]) < thresh);
+	}
+
+	// the flattened layout follows the same order, with each submodel's own
+	// parameters after the composite model's
+	{
+		const molstat::ParameterLayout layout{ cmodel->getParameterLayout() };
+		assert(layout.distributions.size() == cmodel->get_num_parameters());
+		assert(layout.offsets.size() == 3);
+		assert(layout.offsets[0].first == cmodel.get());
+		assert(layout.offsets[0].second == 0);
+		assert(layout.offsets[1].second == 2);
+		assert(layout.offsets[2].second == 4);
+
+		const double expected[6] = { ef, v, eps1, gamma1, eps2, gamma2 };
+		for(size_t p = 0; p < 6; ++p)
+			assert(abs(layout.distributions[p]->sample(engine) - expected[p])
+				< thresh);
+	}
+
+	// simulate the batch and compare against simulate
+	molstat::Simulator sim{ cmodel };
+	vector<double> out(2 * ntrials);
+
+	try
+	{
+		sim.simulateBatch(engine, ntrials, out.data(), workspace);
+		assert(false);
+	}
+	catch(const molstat::NoObservables &e)
+	{
+		// should be here
+	}
+
+	sim.setObservable(0, type_index{ typeid(BasicObs4) });
+	sim.setObservable(1, type_index{ typeid(BasicObs1) });
+	assert(sim.numObservables() == 2);
+
+	{
+		const valarray<double> data{ sim.simulate(engine) };
+		assert(sim.simulateBatch(engine, ntrials, out.data(), workspace)
+			== ntrials);
+		for(size_t t = 0; t < ntrials; ++t)
+		{
+			assert(abs(out[2*t] - data[0]) < thresh);
+			assert(abs(out[2*t + 1] - data[1]) < thresh);
+		}
+		assert(abs(data[1] - (v * (eps1 - gamma1) + v * (eps2 - gamma2)))
+			< thresh);
+	}
+
+	// trials without an observable are discarded
+	{
+		molstat::SimulateModelFactory rfactory
+			{ molstat::SimulateModelFactory::makeFactory<RejectTestModel>() };
+		rfactory.setDistribution("a",
+			make_shared<molstat::UniformDistribution>(0., 1.));
+		shared_ptr<molstat::SimulateModel> rmodel{ rfactory.getModel() };
+		molstat::Simulator rsim{ rmodel };
+		rsim.setObservable(0, type_index{ typeid(BasicObs1) });
+
+		constexpr size_t nbatch = 1000;
+		vector<double> robs(nbatch);
+
+		// draw the same parameters that the batch will use
+		molstat::Engine engine1, engine2;
+		vector<double> params(nbatch);
+		rmodel->generateParameterBatch(engine1, nbatch, params.data());
+
+		const size_t nvalid{ rsim.simulateBatch(engine2, nbatch, robs.data(),
+			workspace) };
+		assert(nvalid > 0 && nvalid < nbatch);
+
+		// the successful trials are stored contiguously, in order
+		size_t k{ 0 };
+		for(size_t t = 0; t < nbatch; ++t)
+		{
+			if(params[t] < 0.5)
+			{
+				assert(abs(robs[k] - params[t]) < thresh);
+				++k;
+			}
+		}
+		assert(k == nvalid);
+
+		// the parameters of the successful trials can also be kept
+		molstat::Engine engine3;
+		assert(rsim.numParameters() == 1);
+		assert(rsim.getParameterNames().size() == 1);
+		vector<double> rparams(nbatch);
+		assert(rsim.simulateBatch(engine3, nbatch, robs.data(), workspace,
+			nullptr, nullptr, rparams.data()) == nvalid);
+		for(size_t j = 0; j < nvalid; ++j)
+			assert(rparams[j] == robs[j]);
+	}
+
+	// rejections are tallied for each observable, whether they are signaled
+	// by NoObservableValue or by NoObservableProduced
+	{
+		molstat::SimulateModelFactory mfactory
+			{ molstat::SimulateModelFactory::makeFactory<MixedRejectTestModel>() };
+		mfactory.setDistribution("a",
+			make_shared<molstat::UniformDistribution>(0., 1.));
+		shared_ptr<molstat::SimulateModel> mmodel{ mfactory.getModel() };
+		molstat::Simulator msim{ mmodel };
+		msim.setObservable(0, type_index{ typeid(BasicObs1) });
+		msim.setObservable(1, type_index{ typeid(BasicObs2) });
+
+		constexpr size_t nbatch = 1000;
+		vector<double> mobs(2 * nbatch);
+		size_t rejections[2] = { 0, 0 };
+
+		molstat::Engine engine1, engine2;
+		vector<double> params(nbatch);
+		mmodel->generateParameterBatch(engine1, nbatch, params.data());
+
+		const size_t nvalid{ msim.simulateBatch(engine2, nbatch, mobs.data(),
+			workspace, rejections) };
+
+		size_t k{ 0 }, nreject1{ 0 }, nreject2{ 0 };
+		for(size_t t = 0; t < nbatch; ++t)
+		{
+			if(params[t] >= 0.5)
+				++nreject1;
+			else if(params[t] < 0.25)
+				++nreject2;
+			else
+			{
+				assert(abs(mobs[2*k] - params[t]) < thresh);
+				assert(abs(mobs[2*k + 1] - 2.*params[t]) < thresh);
+				++k;
+			}
+		}
+		assert(k == nvalid);
+		assert(rejections[0] == nreject1);
+		assert(rejections[1] == nreject2);
+
+		// simulate reports a missing observable with an exception
+		bool rejected{ false };
+		for(size_t t = 0; t < 100 && !rejected; ++t)
+		{
+			try
+			{
+				msim.simulate(engine2);
+			}
+			catch(const molstat::NoObservableProduced &e)
+			{
+				rejected = true;
+			}
+		}
+		assert(rejected);
+	}
+
+	// constant parameters are filled in without being sampled, and the
+	// random parameters are unchanged
+	{
+		constexpr double b = 0.7;
+		molstat::SimulateModelFactory hfactory
+			{ molstat::SimulateModelFactory::makeFactory<HoistTestModel>() };
+		hfactory.setDistribution("a",
+			make_shared<molstat::UniformDistribution>(0., 1.));
+		hfactory.setDistribution("b",
+			make_shared<molstat::ConstantDistribution>(b));
+		shared_ptr<molstat::SimulateModel> hmodel{ hfactory.getModel() };
+
+		double value;
+		assert(!hmodel->isConstantParameter(0, value));
+		assert(hmodel->isConstantParameter(1, value));
+		assert(abs(value - b) < thresh);
+		assert(!hmodel->isConstantParameter(2, value));
+
+		molstat::Simulator hsim{ hmodel };
+		hsim.setObservable(0, type_index{ typeid(BasicObs1) });
+
+		constexpr size_t nbatch = 1000;
+		vector<double> hobs(nbatch);
+
+		molstat::Engine engine1, engine2;
+		vector<double> params(2 * nbatch);
+		hmodel->generateParameterBatch(engine1, nbatch, params.data());
+
+		HoistTestModel::exp_calls = 0;
+		assert(hsim.simulateBatch(engine2, nbatch, hobs.data(), workspace)
+			== nbatch);
+		assert(HoistTestModel::exp_calls == 1);
+		for(size_t t = 0; t < nbatch; ++t)
+		{
+			assert(abs(params[nbatch + t] - b) < thresh);
+			assert(abs(hobs[t] - params[t] * exp(b)) < thresh);
+		}
+
+		const valarray<double> single{ hmodel->generateParameters(engine1) };
+		const valarray<double> data{ hsim.simulate(engine2) };
+		assert(abs(data[0] - single[0] * exp(b)) < thresh);
+
+		// replacing the distribution of b reuses the model; the kernel sees
+		// the new constant, and the random parameters are unchanged
+		constexpr double b2 = -0.3;
+		hsim.setDistribution(*hmodel, "B",
+			make_shared<molstat::ConstantDistribution>(b2));
+		assert(hmodel->isConstantParameter(1, value));
+		assert(abs(value - b2) < thresh);
+
+		molstat::Engine engine3;
+		assert(hsim.simulateBatch(engine3, nbatch, hobs.data(), workspace)
+			== nbatch);
+		for(size_t t = 0; t < nbatch; ++t)
+			assert(abs(hobs[t] - params[t] * exp(b2)) < thresh);
+
+		// a random distribution is then sampled for each trial
+		hsim.setDistribution(*hmodel, "b",
+			make_shared<molstat::UniformDistribution>(0., 1.));
+		assert(!hmodel->isConstantParameter(1, value));
+		HoistTestModel::exp_calls = 0;
+		hsim.simulateBatch(engine3, nbatch, hobs.data(), workspace);
+		assert(HoistTestModel::exp_calls == nbatch);
+
+		try
+		{
+			hsim.setDistribution(*hmodel, "c",
+				make_shared<molstat::ConstantDistribution>(b));
+			assert(false);
+		}
+		catch(const molstat::UnknownParameter &e)
+		{
+			// should be here
+		}
+
+		try
+		{
+			// a model that is not part of the simulator
+			molstat::SimulateModelFactory ofactory
+				{ molstat::SimulateModelFactory::makeFactory<HoistTestModel>() };
+			ofactory.setDistribution("a",
+				make_shared<molstat::UniformDistribution>(0., 1.));
+			ofactory.setDistribution("b",
+				make_shared<molstat::ConstantDistribution>(b));
+			hsim.setDistribution(*ofactory.getModel(), "b",
+				make_shared<molstat::ConstantDistribution>(b));
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// only the parameters read by the observables are sampled
+	{
+		molstat::SimulateModelFactory pfactory{ molstat::SimulateModelFactory::
+			makeFactory<CompositeTestModelAdd>() };
+		pfactory.setDistribution("ef",
+			make_shared<molstat::UniformDistribution>(0., 1.));
+		pfactory.setDistribution("v",
+			make_shared<molstat::UniformDistribution>(1., 2.));
+		for(size_t k = 0; k < 2; ++k)
+			pfactory.addSubmodel(
+				molstat::SimulateModelFactory::makeFactory<PrunedSubModel>()
+				.setDistribution("eps",
+					make_shared<molstat::UniformDistribution>(-1., 1.))
+				.setDistribution("gamma",
+					make_shared<molstat::UniformDistribution>(2., 3.))
+				.getModel());
+		shared_ptr<molstat::SimulateModel> pmodel{ pfactory.getModel() };
+
+		// without observables, every parameter is sampled
+		molstat::Simulator psim{ pmodel };
+		assert(psim.numParameters() == 6);
+		assert(psim.numSampledParameters() == 6);
+
+		// the composite observable reads v and each eps
+		psim.setObservable(0, type_index{ typeid(BasicObs1) });
+		assert(psim.numSampledParameters() == 3);
+
+		constexpr size_t nbatch = 100;
+		vector<double> pobs(nbatch), params(6 * nbatch);
+		assert(psim.simulateBatch(engine, nbatch, pobs.data(), workspace,
+			nullptr, nullptr, params.data()) == nbatch);
+		for(size_t t = 0; t < nbatch; ++t)
+		{
+			const double *const p{ params.data() + 6*t };
+			assert(p[1] >= 1. && p[1] < 2.);
+			assert(abs(pobs[t] - p[1] * (p[2] + p[4])) < thresh);
+		}
+
+		// an observable without a declaration reads everything
+		psim.setObservable(1, type_index{ typeid(BasicObs4) });
+		assert(psim.numSampledParameters() == 6);
+
+		// as does a simulator without pruning
+		molstat::Simulator fullsim{ pmodel };
+		fullsim.setObservable(0, type_index{ typeid(BasicObs1) });
+		fullsim.setParameterPruning(false);
+		assert(fullsim.numSampledParameters() == 6);
+	}
+
+	return 0;
+}
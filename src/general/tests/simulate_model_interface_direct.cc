@@ -23,6 +23,30 @@
 #include <general/simulator_tools/simulator.h>
 #include <general/simulator_tools/simulate_model.h>
 
+/// Dummy model whose second parameter has a default value.
+class DefaultTestModel :
+	public BasicObs1
+{
+public:
+	/// The default value of the parameter "b".
+	constexpr static double bdefault = 3.5;
+
+	virtual double Obs1(const valarray<double> &params) const override
+	{
+		return params[0] * params[1];
+	}
+
+	virtual vector<string> get_names() const override
+	{
+		return { "a", "b" };
+	}
+
+	virtual map<string, double> get_default_values() const override
+	{
+		return { { "b", bdefault } };
+	}
+};
+
 /**
  * \brief Main function for testing the various MolStat classes for
  *    simulating data.
@@ -334,5 +358,26 @@ int main(int argc, char **argv)
 		}
 	}
 
+	// parameters with default values need not be specified
+	{
+		molstat::SimulateModelFactory dfactory
+			{ molstat::SimulateModelFactory::makeFactory<DefaultTestModel>() };
+		dfactory.setDistribution("a",
+			make_shared<molstat::ConstantDistribution>(distvalue1));
+
+		molstat::Simulator sim{ dfactory.getModel() };
+		sim.setObservable(0, type_index{ typeid(BasicObs1) });
+		data = sim.simulate(engine);
+		assert(abs(data[0] - distvalue1 * DefaultTestModel::bdefault) < 1.e-6);
+
+		// ... but can be
+		dfactory.setDistribution("b",
+			make_shared<molstat::ConstantDistribution>(distvalue2));
+		molstat::Simulator sim2{ dfactory.getModel() };
+		sim2.setObservable(0, type_index{ typeid(BasicObs1) });
+		data = sim2.simulate(engine);
+		assert(abs(data[0] - distvalue1 * distvalue2) < 1.e-6);
+	}
+
 	return 0;
 }
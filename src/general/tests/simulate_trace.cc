@@ -0,0 +1,173 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file simulate_trace.cc
+ * \brief Test suite for simulating traces.
+ *
+ * \test Tests molstat::TraceProtocol and molstat::Simulator::simulateTrace,
+ *    including parameter shifts and rupture in a composite model.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <typeinfo>
+#include <typeindex>
+#include "simulate_model_interface_observables.h"
+#include "simulate_model_interface_models.h"
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/constant.h>
+#include <general/simulator_tools/simulator.h>
+#include <general/simulator_tools/simulate_model.h>
+#include <general/simulator_tools/simulator_exceptions.h>
+#include <general/simulator_tools/trace_protocol.h>
+
+/**
+ * \brief Main function for testing trace simulation.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr double thresh = 1.e-6;
+	constexpr double ef = 7.5, v = -6.3;
+	constexpr double eps1 = 4.1, gamma1 = 1.2, eps2 = -14.1, gamma2 = 2.9;
+	constexpr double length = 0.5;
+	constexpr size_t npoints = 11;
+
+	// bad protocols
+	try
+	{
+		molstat::TraceProtocol(0, 0., 1.);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+	try
+	{
+		molstat::TraceProtocol(5, 1., 0.);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// the displacements
+	molstat::TraceProtocol trace(npoints, 0., 1.);
+	assert(trace.numPoints() == npoints);
+	assert(abs(trace.displacement(0)) < thresh);
+	assert(abs(trace.displacement(npoints - 1) - 1.) < thresh);
+	assert(abs(trace.displacement(3) - 0.3) < thresh);
+
+	// the image-charge shift vanishes at zero displacement and decreases the
+	// energy as the electrodes separate
+	{
+		const auto ic = molstat::TraceProtocol::ImageChargeShift(0.5, 0.1);
+		assert(abs(ic(0.)) < thresh);
+		assert(ic(0.2) < 0.);
+		assert(abs(ic(0.2) - molstat::TraceProtocol::coulomb_constant *
+			(1. / (2. * 0.25) - 1. / (2. * 0.15))) < thresh);
+	}
+
+	// composite model with two submodels
+	molstat::SimulateModelFactory cfactory
+		{ molstat::SimulateModelFactory::makeFactory<CompositeTestModelAdd>() };
+	cfactory.setDistribution("ef",
+		make_shared<molstat::ConstantDistribution>(ef));
+	cfactory.setDistribution("v",
+		make_shared<molstat::ConstantDistribution>(v));
+
+	molstat::SimulateModelFactory subfactory1
+		{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+	subfactory1.setDistribution("eps",
+		make_shared<molstat::ConstantDistribution>(eps1));
+	subfactory1.setDistribution("gamma",
+		make_shared<molstat::ConstantDistribution>(gamma1));
+	molstat::SimulateModelFactory subfactory2
+		{ molstat::SimulateModelFactory::makeFactory<CompositeSubModel>() };
+	subfactory2.setDistribution("eps",
+		make_shared<molstat::ConstantDistribution>(eps2));
+	subfactory2.setDistribution("gamma",
+		make_shared<molstat::ConstantDistribution>(gamma2));
+
+	cfactory.addSubmodel(subfactory1.getModel());
+	cfactory.addSubmodel(subfactory2.getModel());
+	shared_ptr<molstat::SimulateModel> cmodel{ cfactory.getModel() };
+
+	// the parameter names
+	{
+		const vector<string> names{ cmodel->getParameterNames() };
+		const vector<string> expected
+			{ "ef", "v", "eps", "gamma", "eps", "gamma" };
+		assert(names == expected);
+	}
+
+	molstat::Simulator sim{ cmodel };
+	sim.setObservable(0, type_index{ typeid(BasicObs4) });
+	sim.setObservable(1, type_index{ typeid(BasicObs1) });
+
+	molstat::Engine engine;
+	vector<double> out(npoints * 3);
+
+	// without shifts, every point is the same
+	assert(sim.simulateTrace(engine, trace, out.data()) == npoints);
+	for(size_t j = 0; j < npoints; ++j)
+	{
+		assert(abs(out[3*j] - trace.displacement(j)) < thresh);
+		assert(abs(out[3*j + 1] - (ef + v)) < thresh);
+		assert(abs(out[3*j + 2] - v * (eps1 - gamma1 + eps2 - gamma2))
+			< thresh);
+	}
+
+	// shift both eps parameters by z, and turn off v once the trace ruptures
+	trace.addShift("EPS", molstat::TraceProtocol::LinearShift(0., 1.));
+	trace.setRuptured("v", 0.);
+	trace.setLength(make_shared<molstat::ConstantDistribution>(length));
+
+	assert(sim.simulateTrace(engine, trace, out.data()) == npoints);
+	for(size_t j = 0; j < npoints; ++j)
+	{
+		const double z{ trace.displacement(j) };
+		assert(abs(out[3*j] - z) < thresh);
+
+		if(z > length)
+		{
+			assert(abs(out[3*j + 1] - ef) < thresh);
+			assert(abs(out[3*j + 2]) < thresh);
+		}
+		else
+		{
+			assert(abs(out[3*j + 1] - (ef + v)) < thresh);
+			assert(abs(out[3*j + 2] -
+				v * (eps1 + z - gamma1 + eps2 + z - gamma2)) < thresh);
+		}
+	}
+
+	// parameters must be in the model
+	{
+		molstat::TraceProtocol bad(npoints, 0., 1.);
+		bad.addShift("width", molstat::TraceProtocol::LinearShift(0., 1.));
+		try
+		{
+			sim.simulateTrace(engine, bad, out.data());
+			assert(false);
+		}
+		catch(const molstat::UnknownParameter &e)
+		{
+			// should be here
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,96 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file simulator_profile.cc
+ * \brief Test suite for profiling simulations.
+ *
+ * \test Tests molstat::SimulatorProfile and the timings collected by
+ *    molstat::Simulator::simulateBatch.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <cassert>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <typeinfo>
+#include <typeindex>
+#include <general/random_distributions/rng.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/identity_tools.h>
+#include <general/simulator_tools/simulator.h>
+#include <general/simulator_tools/simulator_profile.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the profiling.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	// one of every three batches is timed, starting with the first
+	{
+		molstat::SimulatorProfile profile(2, 3);
+		assert(profile.next() != nullptr);
+		assert(profile.next() == nullptr);
+		assert(profile.next() == nullptr);
+		assert(profile.next() != nullptr);
+		assert(profile.getTimings().observables.size() == 2);
+	}
+
+	try
+	{
+		molstat::SimulatorProfile profile(1, 0);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// timings from simulating batches
+	{
+		molstat::SimulateModelFactory factory
+			{ molstat::SimulateModelFactory::makeFactory<molstat::IdentityModel>() };
+		factory.setDistribution("parameter",
+			make_shared<molstat::UniformDistribution>(-1., 1.));
+		molstat::Simulator sim{ factory.getModel() };
+		sim.setObservable(0, type_index{ typeid(molstat::IdentityObservable) });
+
+		constexpr size_t ntrials = 100;
+		molstat::Engine engine;
+		vector<double> out(ntrials), workspace;
+		molstat::SimulatorProfile profile1(1, 2), profile2(1, 2);
+
+		for(size_t j = 0; j < 4; ++j)
+			sim.simulateBatch(engine, ntrials, out.data(), workspace, nullptr,
+				profile1.next());
+		sim.simulateBatch(engine, ntrials, out.data(), workspace, nullptr,
+			profile2.next());
+
+		assert(profile1.getTimings().ntrials == 2 * ntrials);
+		assert(profile2.getTimings().ntrials == ntrials);
+		assert(profile1.getTimings().parameters >= 0.);
+		assert(profile1.getTimings().observables[0] >= 0.);
+		assert(profile1.getTimings().combined == 0.);
+
+		profile1.merge(profile2);
+		assert(profile1.getTimings().ntrials == 3 * ntrials);
+
+		ostringstream report;
+		profile1.report(report, 5 * ntrials, 1., 1, { "Identity" }, { 0 });
+		assert(report.str().find("500 trials/s") != string::npos);
+		assert(report.str().find("Observable 0 (Identity)") != string::npos);
+	}
+
+	return 0;
+}
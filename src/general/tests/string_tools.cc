@@ -77,6 +77,51 @@ int main(int argc, char **argv)
 		molstat::tokenize(" Other forms\tof\nwhitespace   "),
 		{ "Other", "forms", "of", "whitespace" });
 
+	// the views of the tokens are the same tokens, without copies
+	{
+		const string line{ " A \"multi-word phrase\"\t<a b>  4.5e1 " };
+		molstat::TokenViews views{ "stale" };
+		molstat::tokenize(line, views);
+
+		assert(views.size() == 4);
+		assert(views[0] == "A");
+		assert(views[1] == "multi-word phrase");
+		assert(views[2] == "<a b>");
+		assert(views[3] == "4.5e1");
+		assert(views[3].data() == line.data() + line.find("4.5e1"));
+		assert(views[1].str() == "multi-word phrase");
+
+		const string blank{ " \t" };
+		molstat::tokenize(blank, views);
+		assert(views.empty());
+	}
+
+	// case-insensitive comparisons
+	assert(molstat::lower_equals("BoUnDs", "bounds"));
+	assert(molstat::lower_equals("", ""));
+	assert(!molstat::lower_equals("bound", "bounds"));
+	assert(!molstat::lower_equals("boundz", "bounds"));
+
+	// the parsers use the entire string and do not throw
+	{
+		double d{ 0. };
+		size_t n{ 0 };
+
+		assert(molstat::parse_number(molstat::StringView("4.5-1.4", 3), d));
+		assert(d == 4.5);
+		assert(!molstat::parse_number("4.5-1.4", d));
+		assert(!molstat::parse_number("", d));
+		assert(!molstat::parse_number("1e999", d));
+		assert(molstat::parse_number("-inf", d) && d < 0. && isinf(d));
+		assert(molstat::parse_number(string(100, '0') + "2.5", d) && d == 2.5);
+
+		assert(molstat::parse_number(molstat::StringView("12", 1), n));
+		assert(n == 1);
+		assert(!molstat::parse_number("-1", n));
+		assert(!molstat::parse_number("1.5", n));
+		assert(!molstat::parse_number("", n));
+	}
+
 	// check the find and replace function
 	{
 		string orig{ "Hello, world!" };
@@ -94,6 +139,7 @@ int main(int argc, char **argv)
 	// to size_t
 	assert(4 == molstat::cast_string<size_t>("4"));
 	assert(0 == molstat::cast_string<size_t>("0"));
+	assert(5000000000ull == molstat::cast_string<size_t>("5000000000"));
 
 	// some bad size_t casts
 	try
@@ -127,6 +173,16 @@ int main(int argc, char **argv)
 		// should be here
 	}
 
+	try
+	{
+		molstat::cast_string<size_t>("100000000000000000000000");
+		assert(false);
+	}
+	catch(const bad_cast &e)
+	{
+		// should be here
+	}
+
 	// to double
 	assert(abs(4.5 - molstat::cast_string<double>("4.5")) < 1.e-6);
 	assert(abs(1.1e2 - molstat::cast_string<double>("1.1e2")) < 1.e-6);
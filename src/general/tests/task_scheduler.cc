@@ -0,0 +1,162 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/task_scheduler.cc
+ * \brief Test suite for the work-stealing task scheduler.
+ *
+ * \test Tests that molstat::TaskScheduler runs every task once, balances
+ *    tasks of uneven cost by stealing, runs nested loops, passes exceptions
+ *    back to the caller, and still works when its workers are pinned (to
+ *    CPUs on known NUMA nodes).
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <general/task_scheduler.h>
+
+using namespace std;
+
+/**
+ * \brief Checks that a loop runs every task exactly once, on valid workers.
+ *
+ * \param[in,out] scheduler The scheduler.
+ * \param[in] ntasks The number of tasks.
+ * \param[in] chunk The number of tasks taken at once.
+ */
+static void check_loop(molstat::TaskScheduler &scheduler, size_t ntasks,
+	size_t chunk)
+{
+	unique_ptr<atomic<size_t>[]> counts{ new atomic<size_t>[ntasks]() };
+	atomic<bool> bad_worker{ false };
+
+	scheduler.run(ntasks, [&] (size_t j, size_t worker) -> void
+		{
+			++counts[j];
+			if(worker >= scheduler.numWorkers())
+				bad_worker = true;
+		}, chunk);
+
+	for(size_t j = 0; j < ntasks; ++j)
+		assert(counts[j] == 1);
+	assert(!bad_worker);
+}
+
+/**
+ * \brief Main function for testing the task scheduler.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	molstat::TaskScheduler scheduler{ 4 };
+	assert(scheduler.numWorkers() == 4);
+
+	check_loop(scheduler, 0, 1);
+	check_loop(scheduler, 1, 1);
+	check_loop(scheduler, 3, 1);
+	check_loop(scheduler, 1000, 1);
+	check_loop(scheduler, 1000, 7);
+
+	// the first worker's tasks are slow, so the others steal them
+	{
+		const size_t before{ scheduler.numSteals() };
+		vector<size_t> ran_on(40);
+		scheduler.run(ran_on.size(), [&ran_on] (size_t j, size_t worker)
+			-> void
+			{
+				if(j < 10)
+					this_thread::sleep_for(chrono::milliseconds(5));
+				ran_on[j] = worker;
+			});
+		assert(scheduler.numSteals() > before);
+
+		bool others{ false };
+		for(size_t j = 0; j < 10; ++j)
+			others = others || ran_on[j] != ran_on[0];
+		assert(others);
+	}
+
+	// nested loops; each worker runs one task of a loop at a time
+	{
+		vector<atomic<size_t>> counts(8 * 50);
+		scheduler.run(8, [&scheduler, &counts] (size_t j, size_t) -> void
+			{
+				vector<atomic<int>> running(scheduler.numWorkers());
+				atomic<bool> overlap{ false };
+				scheduler.run(50, [&counts, &running, &overlap, j]
+					(size_t k, size_t worker) -> void
+					{
+						if(running[worker]++ != 0)
+							overlap = true;
+						++counts[50 * j + k];
+						--running[worker];
+					});
+				assert(!overlap);
+			});
+		for(const atomic<size_t> &count : counts)
+			assert(count == 1);
+	}
+
+	// an exception stops the loop and is rethrown
+	try
+	{
+		scheduler.run(100, [] (size_t j, size_t) -> void
+			{
+				if(j == 37)
+					throw runtime_error("task 37");
+			});
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		assert(string(e.what()) == "task 37");
+	}
+
+	// the scheduler is usable after an exception
+	check_loop(scheduler, 100, 1);
+
+	// one worker runs the tasks in order on the calling thread
+	{
+		molstat::TaskScheduler serial{ 1 };
+		vector<size_t> order;
+		serial.run(5, [&order] (size_t j, size_t worker) -> void
+			{
+				assert(worker == 0);
+				order.push_back(j);
+			});
+		assert((order == vector<size_t>{ 0, 1, 2, 3, 4 }));
+	}
+
+	// pinned workers, which know their NUMA nodes
+	{
+		const size_t nnodes{ molstat::NumaNodeCount() };
+		assert(nnodes >= 1);
+		assert(molstat::CurrentNumaNode() == 0);
+
+		molstat::TaskScheduler pinned{ 3, true };
+		check_loop(pinned, 500, 2);
+
+		atomic<bool> bad_node{ false };
+		pinned.run(30, [&bad_node, nnodes] (size_t, size_t) -> void
+			{
+				if(molstat::CurrentNumaNode() >= nnodes)
+					bad_node = true;
+			});
+		assert(!bad_node);
+	}
+
+	return 0;
+}
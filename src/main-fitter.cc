@@ -28,6 +28,13 @@
 #include <map>
 #include <string>
 #include <limits>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_multifit_nlin.h>
@@ -35,9 +42,13 @@
 #include <config.h>
 
 #include "general/string_tools.h"
+#include "general/name_registry.h"
+#include "general/task_scheduler.h"
 #include "general/histogram_tools/bin_style.h"
 #include "general/histogram_tools/bin_linear.h"
+#include "general/fitter_tools/fit_data.h"
 #include "general/fitter_tools/fit_model_interface.h"
+#include "general/fitter_tools/fit_solver.h"
 
 #if BUILD_TRANSPORT_FITTER
 #include "electron_transport/fitter_models/transport_fit_module.h"
@@ -45,6 +56,1005 @@
 
 using namespace std;
 
+/// The result of fitting the data from one initial guess.
+struct GuessResult
+{
+	/// Whether or not the fit succeeded (did not error out).
+	bool hasfit{ false };
+
+	/// The residual of the fit.
+	double resid{ 0. };
+
+	/// The fit parameters.
+	vector<double> fit;
+
+	/// The iteration-by-iteration output, if requested.
+	string log;
+};
+
+/// The options for fitting a set of data, read from the input.
+struct FitOptions
+{
+	/// Whether or not to output iteration-by-iteration results.
+	bool iterprint{ false };
+
+	/// Whether or not to report the profile of each initial guess.
+	bool profile{ false };
+
+	/// The maximum number of iterations per initial guess.
+	size_t maxiter{ 100 };
+
+	/// The number of threads to use.
+	size_t nthreads{ 1 };
+
+	/// Whether or not to pin the threads to CPUs.
+	bool pin{ false };
+
+	/// The scheduler for the parallel work (guesses, files, resamples, and
+	/// data points).
+	molstat::TaskScheduler *scheduler{ nullptr };
+
+	/**
+	 * \brief The number of iterations in the first round of the multistart
+	 *    scheduler; 0 disables pruning.
+	 */
+	size_t prune_iter{ 0 };
+
+	/**
+	 * \brief Guesses whose residuals exceed this factor times the best
+	 *    residual are abandoned.
+	 */
+	double prune_factor{ 10. };
+
+	/// Whether or not to use the model's default initial guesses.
+	bool usedefaultguess{ false };
+
+	/**
+	 * \brief The user-specified initial guesses, as name/value tokens (they
+	 *    are processed once the model is instantiated).
+	 */
+	list<molstat::TokenContainer> guesses;
+
+	/**
+	 * \brief The parameters of a previous fit to start from, as name/value
+	 *    tokens; empty for no warm start.
+	 */
+	molstat::TokenContainer warmstart;
+
+	/// The relative perturbation of the warm-start parameters.
+	double warmstart_spread{ 0.1 };
+
+	/// The number of bootstrap resamples; 0 for no bootstrap.
+	size_t bootstrap{ 0 };
+
+	/// The confidence level of the bootstrap intervals.
+	double bootstrap_level{ 0.95 };
+
+	/// The seed for the bootstrap resamples.
+	uint64_t bootstrap_seed{ 1 };
+
+	/// The binning style of the data.
+	shared_ptr<const molstat::BinStyle> binstyle;
+
+	/// The factory for the non-linear least-squares solver.
+	molstat::FitSolverFactory solver;
+
+	/// The convergence criteria for the fits.
+	molstat::FitTolerance tolerance;
+
+	/// The objective of the fits.
+	molstat::FitObjective objective{ molstat::FitObjective::LeastSquares };
+};
+
+/// The best fit to the data in one file.
+struct DataResult
+{
+	/// Whether or not a fit was found.
+	bool hasfit{ false };
+
+	/// The residual of the best fit.
+	double resid{ 0. };
+
+	/// The best-fit parameters, as printed by the model.
+	string params;
+
+	/// The iteration-by-iteration output for all guesses, if requested.
+	string log;
+
+	/// The profile of each guess (one line per guess), if requested.
+	string profile;
+
+	/// The bootstrap report (each line starts with `#`), if requested.
+	string bootstrap;
+
+	/// Any error messages, one per line.
+	string errors;
+};
+
+/**
+ * \brief Gets the time elapsed since a starting time.
+ *
+ * \param[in] start The starting time.
+ * \return The elapsed time (s).
+ */
+static double SecondsSince(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - start)
+		.count();
+}
+
+/// A data file listed in a batch manifest.
+struct BatchEntry
+{
+	/// The name of the data file.
+	string filename;
+
+	/// Whether or not to use the model's default initial guesses.
+	bool usedefaultguess{ false };
+
+	/// Initial guesses for this file, in addition to those in the input.
+	list<molstat::TokenContainer> guesses;
+};
+
+/**
+ * \brief The fit from one initial guess, which can be iterated a few steps
+ *    at a time.
+ *
+ * Each guess has its own GSL solver, so that the multistart scheduler can
+ * alternate between guesses.
+ *
+ * \tparam N The number of independent variables in the fit function.
+ */
+template<std::size_t N>
+class GuessFit
+{
+private:
+	/// The solver.
+	unique_ptr<molstat::FitSolver> solver;
+
+	/// The number of iterations performed.
+	size_t iter;
+
+	/// The GSL status of the fit.
+	int status;
+
+	/// Whether or not the fit was abandoned by the scheduler.
+	bool pruned;
+
+	/// The iteration-by-iteration output, if requested.
+	ostringstream log;
+
+	/// The work done by the fit, and the time spent in the solver and model.
+	molstat::FitProfile profile;
+
+public:
+	GuessFit() = delete;
+
+	/**
+	 * \brief Constructor; sets up the fit from an initial guess.
+	 *
+	 * \param[in] model The model.
+	 * \param[in] fdf The GSL handle for the model; it must outlive this
+	 *    object.
+	 * \param[in] factory The factory for the solver.
+	 * \param[in] initval The initial guess.
+	 * \param[in] iterprint Whether or not to record the iteration-by-iteration
+	 *    output.
+	 */
+	GuessFit(const molstat::FitModel<N> &model, gsl_multifit_function_fdf &fdf,
+		const molstat::FitSolverFactory &factory, const vector<double> &initval,
+		bool iterprint)
+		: solver(), iter(0), status(GSL_CONTINUE), pruned(false), log(),
+		  profile()
+	{
+		// load the initial values
+		unique_ptr<gsl_vector, decltype(&gsl_vector_free)>
+			vec(gsl_vector_alloc(model.nfit), &gsl_vector_free);
+		for(size_t i = 0; i < model.nfit; ++i)
+			gsl_vector_set(vec.get(), i, initval[i]);
+
+		// setting up the solver evaluates the model at the initial guess
+		{
+			const molstat::FitProfileScope scope{ profile };
+			const chrono::steady_clock::time_point start
+				{ chrono::steady_clock::now() };
+			solver = factory(fdf, vec.get());
+			profile.solver_seconds += SecondsSince(start);
+		}
+
+		if(iterprint)
+		{
+			log << "Iter=" << setw(3) << iter << ", ";
+			model.print_fit(log, molstat::gsl_to_std(solver->position()));
+			log << endl;
+		}
+	}
+
+	/**
+	 * \brief Determines if the fit should keep iterating.
+	 *
+	 * \param[in] maxiter The maximum number of iterations.
+	 * \return True if the fit has not converged, errored out, been pruned, or
+	 *    reached the maximum number of iterations.
+	 */
+	bool active(size_t maxiter) const
+	{
+		return status == GSL_CONTINUE && !pruned && iter < maxiter;
+	}
+
+	/**
+	 * \brief Determines if the fit errored out.
+	 *
+	 * \return True if the GSL reported an error.
+	 */
+	bool errored() const
+	{
+		return status != GSL_CONTINUE && status != GSL_SUCCESS &&
+			status != GSL_ENOPROG;
+	}
+
+	/**
+	 * \brief Performs more iterations of the fit.
+	 *
+	 * \param[in] model The model.
+	 * \param[in] niter The number of additional iterations to perform.
+	 * \param[in] maxiter The maximum number of iterations.
+	 * \param[in] tol The convergence criteria.
+	 * \param[in] iterprint Whether or not to record the iteration-by-iteration
+	 *    output.
+	 */
+	void iterate(const molstat::FitModel<N> &model, size_t niter,
+		size_t maxiter, const molstat::FitTolerance &tol, bool iterprint)
+	{
+		MOLSTAT_TRACE_EVENT("fit guess");
+		const size_t stop{ min(maxiter, iter + niter) };
+		const molstat::FitProfileScope scope{ profile };
+
+		while(status == GSL_CONTINUE && iter < stop)
+		{
+			++iter;
+			chrono::steady_clock::time_point start
+				{ chrono::steady_clock::now() };
+			status = solver->iterate();
+			profile.solver_seconds += SecondsSince(start);
+			if(iterprint)
+			{
+				log << "Iter=" << setw(3) << iter << ", ";
+				model.print_fit(log, molstat::gsl_to_std(solver->position()));
+				log << endl;
+			}
+
+			if(status)
+				break;
+
+			start = chrono::steady_clock::now();
+			status = solver->test(tol);
+			profile.solver_seconds += SecondsSince(start);
+		}
+	}
+
+	/**
+	 * \brief Reports the profile of the fit: the iterations, the numbers of
+	 *    evaluations of the residuals and Jacobian, the time spent in the
+	 *    model and in the GSL (the rest of the solver's time), and the status.
+	 *
+	 * \param[out] out The output stream; one tab-separated line is written.
+	 * \param[in] guess The number of the guess.
+	 */
+	void report(ostream &out, size_t guess) const
+	{
+		out << guess << '\t' << iter << '\t' << profile.nresid << '\t' <<
+			profile.njac << '\t' << scientific << setprecision(3) <<
+			profile.model_seconds << '\t' <<
+			max(0., profile.solver_seconds - profile.model_seconds) << '\t' <<
+			(pruned ? "abandoned" : gsl_strerror(status)) << '\n';
+	}
+
+	/**
+	 * \brief Gets the profile of the fit.
+	 *
+	 * \return The profile.
+	 */
+	const molstat::FitProfile &getProfile() const
+	{
+		return profile;
+	}
+
+	/**
+	 * \brief Gets the current residual of the fit.
+	 *
+	 * \return The residual.
+	 */
+	double residual() const
+	{
+		return gsl_blas_dnrm2(solver->residuals());
+	}
+
+	/**
+	 * \brief Abandons the fit.
+	 *
+	 * \param[in] iterprint Whether or not to record the iteration-by-iteration
+	 *    output.
+	 */
+	void prune(bool iterprint)
+	{
+		pruned = true;
+
+		if(iterprint)
+			log << "Abandoned after " << iter << " iterations; residual = " <<
+				scientific << setprecision(6) << residual() << '\n' << endl;
+	}
+
+	/**
+	 * \brief Gets the result of the fit.
+	 *
+	 * \param[in] model The model.
+	 * \param[in] iterprint Whether or not to record the iteration-by-iteration
+	 *    output.
+	 * \return The result of the fit.
+	 */
+	GuessResult result(const molstat::FitModel<N> &model, bool iterprint)
+	{
+		GuessResult ret;
+
+		if(pruned)
+		{
+			ret.log = log.str();
+			return ret;
+		}
+
+		if(iterprint)
+		{
+			if(status != GSL_CONTINUE && status != GSL_SUCCESS)
+				log << "   " << gsl_strerror(status) << '\n' << endl;
+		}
+
+		// did we converge, iteration out, or error out?
+		if(errored())
+		{
+			// errored out
+			ret.log = log.str();
+			return ret;
+		}
+
+		// do some final processing
+		ret.resid = residual();
+		if(iterprint)
+			log << "Residual = " << scientific << setprecision(6) << ret.resid <<
+				'\n' << endl;
+
+		ret.fit.resize(model.nfit);
+		for(size_t i = 0; i < model.nfit; ++i)
+			ret.fit[i] = gsl_vector_get(solver->position(), i);
+
+		ret.hasfit = true;
+		ret.log = log.str();
+
+		return ret;
+	}
+};
+
+/**
+ * \brief Reads the data to fit from a file and, if necessary, "unmasks" it
+ *    so that we fit in g, not some function of g.
+ *
+ * \throw std::runtime_error if the file cannot be opened or read.
+ *
+ * \tparam N The number of independent variables.
+ * \param[in] filename The name of the file. Each line has the value(s) of
+ *    the observable(s) and the probability density function for these
+ *    values.
+ * \param[in] binstyle The binning style of the first observable (the
+ *    conductance).
+ * \param[out] raw If not nullptr, the values of the data points as read
+ *    (before unmasking).
+ * \param[out] weights If not nullptr, the factor between the raw count and
+ *    the (unmasked) value of each data point (see molstat::ReadFitData).
+ * \return The data points.
+ */
+template<std::size_t N>
+list<pair<array<double, N>, double>> ReadData(const string &filename,
+	const molstat::BinStyle &binstyle, vector<double> *raw = nullptr,
+	vector<double> *weights = nullptr)
+{
+	list<pair<array<double, N>, double>> data;
+
+	ifstream f(filename, ios_base::binary);
+	if(!f)
+		throw runtime_error("Error opening " + filename + " for input.");
+
+	try
+	{
+		data = molstat::ReadFitData<N>(f, weights);
+	}
+	catch(const runtime_error &e)
+	{
+		throw runtime_error("Error reading " + filename + ": " + e.what());
+	}
+	f.close();
+
+	if(raw != nullptr)
+	{
+		raw->clear();
+		for(const pair<array<double, N>, double> &point : data)
+			raw->push_back(point.second);
+	}
+
+	// use the bin type to "unmask", if necessary, the data
+	size_t j{ 0 };
+	for(pair<array<double, N>, double> &point : data)
+	{
+		// transform the independent variable back to g
+		point.first[0] = binstyle.invmask(point.first[0]);
+
+		// transform the PDF: P_g(g)
+		//    = P_mask(g)(mask(g)) * dmaskdx(invmask(u))
+		const double dmaskdx{ binstyle.dmaskdx(point.first[0]) };
+		point.second *= dmaskdx;
+		if(weights != nullptr)
+			(*weights)[j++] *= dmaskdx;
+	}
+
+	return data;
+}
+
+/**
+ * \brief Estimates confidence intervals of the fitting parameters by
+ *    bootstrapping the histogram.
+ *
+ * Each resample draws every bin count from a Poisson distribution whose mean
+ * is the observed count (the values as read are taken to be counts, as
+ * written by `molstat-simulator`), and is fit from the best fit only. The
+ * resamples are tasks of the scheduler; each has its own random number
+ * stream (from the seed and the resample's number), so the report does not
+ * depend on the threads. The intervals are the percentiles of the
+ * resamples' fits.
+ *
+ * \tparam N The number of independent variables in the fit function.
+ * \param[in] factory The factory for the model.
+ * \param[in] data The data points (unmasked).
+ * \param[in] raw The values of the data points as read (the bin counts).
+ * \param[in] weights The factor between the raw count and the value of each
+ *    data point, for the objective of the fits.
+ * \param[in] bestfit The best fit to the data.
+ * \param[in] options The options for the fit.
+ * \return The report; each line starts with `#`.
+ */
+template<std::size_t N>
+string Bootstrap(const molstat::FitModelFactory<N> &factory,
+	const list<pair<array<double, N>, double>> &data,
+	const vector<double> &raw, const vector<double> &weights,
+	const vector<double> &bestfit, const FitOptions &options)
+{
+	MOLSTAT_TRACE_EVENT("bootstrap");
+	const size_t nresamples{ options.bootstrap };
+	vector<vector<double>> fits(nresamples);
+
+	options.scheduler->run(nresamples, [&] (size_t b, size_t) -> void
+		{
+			seed_seq seq{ uint32_t(options.bootstrap_seed),
+				uint32_t(options.bootstrap_seed >> 32), uint32_t(b),
+				uint32_t(uint64_t(b) >> 32) };
+			mt19937_64 engine{ seq };
+
+			// a bin with count c has c'/c times the value
+			list<pair<array<double, N>, double>> resample{ data };
+			auto count = raw.cbegin();
+			for(pair<array<double, N>, double> &point : resample)
+			{
+				const double c{ *count++ };
+				if(c > 0.)
+					point.second *= poisson_distribution<long>(c)(engine) / c;
+			}
+
+			const unique_ptr<molstat::FitModel<N>> model{ factory(resample) };
+			model->set_scheduler(options.scheduler);
+			model->set_objective(options.objective, weights);
+			gsl_multifit_function_fdf fdf{ model->gsl_handle() };
+			GuessFit<N> fit{ *model, fdf, options.solver, bestfit, false };
+			fit.iterate(*model, options.maxiter, options.maxiter,
+				options.tolerance, false);
+
+			const GuessResult result{ fit.result(*model, false) };
+			if(result.hasfit)
+			{
+				fits[b] = result.fit;
+				model->process_fit_parameters(fits[b]);
+			}
+		});
+
+	// the fits of the resamples, by parameter
+	const size_t nfit{ bestfit.size() };
+	vector<vector<double>> values(nfit);
+	for(const vector<double> &fit : fits)
+		for(size_t i = 0; i < fit.size(); ++i)
+			values[i].push_back(fit[i]);
+
+	ostringstream ret;
+	const size_t nfits{ values[0].size() };
+	ret << "# Bootstrap: " << nfits << " of " << nresamples <<
+		" resamples were fit\n";
+	if(nfits < 2)
+		return ret.str();
+
+	// the percentiles (interpolated between the sorted values), and the
+	// standard deviation
+	const auto percentile = [] (const vector<double> &sorted, double q)
+		-> double
+	{
+		const double pos{ q * (sorted.size() - 1) };
+		const size_t j{ min(sorted.size() - 2, size_t(pos)) };
+		return sorted[j] + (pos - j) * (sorted[j + 1] - sorted[j]);
+	};
+	vector<double> lower(nfit), upper(nfit), stddev(nfit);
+	for(size_t i = 0; i < nfit; ++i)
+	{
+		sort(values[i].begin(), values[i].end());
+		lower[i] = percentile(values[i], 0.5 * (1. - options.bootstrap_level));
+		upper[i] = percentile(values[i], 0.5 * (1. + options.bootstrap_level));
+
+		double mean{ 0. }, var{ 0. };
+		for(const double x : values[i])
+			mean += x / nfits;
+		for(const double x : values[i])
+			var += (x - mean) * (x - mean) / (nfits - 1);
+		stddev[i] = sqrt(var);
+	}
+
+	// the model prints the parameters with their names
+	const unique_ptr<molstat::FitModel<N>> model{ factory(data) };
+	const double percent{ 100. * options.bootstrap_level };
+	ret << "# Lower " << percent << "% limit: ";
+	model->print_fit(ret, lower);
+	ret << "\n# Upper " << percent << "% limit: ";
+	model->print_fit(ret, upper);
+	ret << "\n# Standard error: ";
+	model->print_fit(ret, stddev);
+	ret << '\n';
+
+	return ret.str();
+}
+
+/**
+ * \brief Fits the data in one file, using all of the initial guesses.
+ *
+ * Without pruning, each guess is iterated to completion in one round. With
+ * pruning, all guesses are iterated a few steps at a time (the rounds get
+ * longer as fewer guesses remain), and after each round the guesses whose
+ * residuals are far worse than the best are abandoned.
+ *
+ * In each round the active guesses are divided among the threads. The model
+ * is shared (its evaluation functions are const and use per-thread scratch
+ * space); each guess has its own solver. The pruning decisions are made
+ * between rounds and the results are stored by guess, so the output (and the
+ * best fit) does not depend on the threads.
+ *
+ * \tparam N The number of independent variables in the fit function.
+ * \param[in] factory The factory for the model.
+ * \param[in] filename The name of the file containing the data.
+ * \param[in] options The options for the fit.
+ * \return The best fit.
+ */
+template<std::size_t N>
+DataResult FitData(const molstat::FitModelFactory<N> &factory,
+	const string &filename, const FitOptions &options)
+{
+	DataResult ret;
+	ostringstream errors;
+
+	// read in the data points from the specified file
+	list<pair<array<double, N>, double>> data;
+	vector<double> raw, weights;
+	const bool counts
+		{ options.objective != molstat::FitObjective::LeastSquares };
+	try
+	{
+		data = ReadData<N>(filename, *options.binstyle,
+			options.bootstrap > 0 ? &raw : nullptr,
+			counts ? &weights : nullptr);
+	}
+	catch(const runtime_error &e)
+	{
+		ret.errors = string(e.what()) + '\n';
+		return ret;
+	}
+
+	// set the model (it stores its own copy of the data)
+	unique_ptr<molstat::FitModel<N>> model{ factory(data) };
+	model->set_scheduler(options.scheduler);
+	model->set_objective(options.objective, weights);
+
+	// process the initial guesses
+	list<vector<double>> initvals;
+	for(const molstat::TokenContainer &guess : options.guesses)
+	{
+		try
+		{
+			molstat::TokenContainer tokens{ guess };
+			model->append_initial_guess(move(tokens), initvals);
+		}
+		catch(const invalid_argument &e)
+		{
+			errors << "Error: " << e.what() << " Skipping input line.\n";
+		}
+	}
+
+	// seed from a previous fit: the previous parameters and a cloud of
+	// perturbations, one parameter at a time
+	if(!options.warmstart.empty())
+	{
+		try
+		{
+			molstat::TokenContainer tokens{ options.warmstart };
+			list<vector<double>> seed;
+			model->append_initial_guess(move(tokens), seed);
+			initvals.push_back(seed.front());
+
+			if(options.warmstart_spread > 0.)
+			{
+				for(size_t i = 0; i < model->nfit; ++i)
+					for(const double sign : { -1., 1. })
+					{
+						vector<double> guess{ seed.front() };
+						const double delta{ sign * options.warmstart_spread };
+						guess[i] = guess[i] == 0. ? delta : guess[i] * (1. + delta);
+						initvals.push_back(guess);
+					}
+			}
+		}
+		catch(const invalid_argument &e)
+		{
+			errors << "Error: Unable to warm start from the previous fit. " <<
+				e.what() << '\n';
+		}
+	}
+
+	// do we need to load the default guesses? (not when warm starting, unless
+	// requested)
+	if(options.usedefaultguess || initvals.size() == 0)
+		model->append_default_guesses(initvals);
+
+	// perform fits with all the initial values
+	gsl_multifit_function_fdf fdf{ model->gsl_handle() };
+	vector<unique_ptr<GuessFit<N>>> fits;
+	for(const vector<double> &guess : initvals)
+		fits.emplace_back(new GuessFit<N>(*model, fdf, options.solver, guess,
+			options.iterprint));
+
+	const size_t maxiter{ options.maxiter };
+	const bool iterprint{ options.iterprint };
+	size_t round_iter{ options.prune_iter > 0 ? options.prune_iter : maxiter };
+	while(true)
+	{
+		MOLSTAT_TRACE_EVENT("fit round");
+		vector<GuessFit<N>*> active;
+		for(const auto &fit : fits)
+			if(fit->active(maxiter))
+				active.push_back(fit.get());
+		if(active.empty())
+			break;
+
+		// workers not needed for the guesses evaluate the data points in
+		// parallel
+		options.scheduler->run(active.size(),
+			[&model, &active, &options, round_iter, maxiter, iterprint]
+			(size_t j, size_t) -> void
+			{
+				active[j]->iterate(*model, round_iter, maxiter,
+					options.tolerance, iterprint);
+			});
+
+		if(options.prune_iter == 0)
+			break;
+
+		// abandon the guesses that are unlikely to win
+		double best{ numeric_limits<double>::max() };
+		for(const auto &fit : fits)
+			if(!fit->errored())
+				best = min(best, fit->residual());
+		for(GuessFit<N> *fit : active)
+			if(fit->active(maxiter) &&
+				fit->residual() > options.prune_factor * best)
+			{
+				fit->prune(iterprint);
+			}
+
+		round_iter *= 2;
+	}
+
+	// collect the output for each guess (in order) and find the best fit
+	vector<double> bestfit;
+	ostringstream log, profile;
+	molstat::FitProfile total;
+	if(options.profile)
+		profile << "# guess\titerations\tresiduals\tjacobians\tmodel_s\tgsl_s" \
+			"\tstatus\n";
+	for(size_t k = 0; k < fits.size(); ++k)
+	{
+		const unique_ptr<GuessFit<N>> &fit = fits[k];
+		const GuessResult result{ fit->result(*model, iterprint) };
+		log << result.log;
+
+		if(options.profile)
+		{
+			fit->report(profile, k + 1);
+
+			const molstat::FitProfile &guess = fit->getProfile();
+			total.nresid += guess.nresid;
+			total.njac += guess.njac;
+			total.model_seconds += guess.model_seconds;
+			total.solver_seconds += guess.solver_seconds;
+		}
+
+		if(result.hasfit && (!ret.hasfit || result.resid < ret.resid))
+		{
+			ret.resid = result.resid;
+			bestfit = result.fit;
+			ret.hasfit = true;
+		}
+	}
+	ret.log = log.str();
+
+	if(options.profile)
+	{
+		profile << "total\t-\t" << total.nresid << '\t' << total.njac << '\t' <<
+			scientific << setprecision(3) << total.model_seconds << '\t' <<
+			max(0., total.solver_seconds - total.model_seconds) << "\t-\n";
+		ret.profile = profile.str();
+	}
+
+	// did we get a fit?
+	if(!ret.hasfit)
+		errors << "Error fitting.\n";
+	else
+	{
+		// make sure the fit parameters are good
+		model->process_fit_parameters(bestfit);
+
+		ostringstream params;
+		model->print_fit(params, bestfit);
+		ret.params = params.str();
+
+		if(options.bootstrap > 0)
+			ret.bootstrap = Bootstrap<N>(factory, data, raw, weights, bestfit,
+				options);
+	}
+	ret.errors = errors.str();
+
+	return ret;
+}
+
+/**
+ * \brief Reads the results of previous fits, for warm starting.
+ *
+ * The file is the output of a previous run of the fitter: either the
+ * \"Resid = ...\" output for one data file or the table of results from
+ * batch mode. Failed fits and lines beginning with `#` are ignored.
+ *
+ * \throw std::runtime_error if the file cannot be opened.
+ *
+ * \param[in] filename The name of the file.
+ * \return The name/value tokens of each fit, keyed by the name of the data
+ *    file (an empty name for the output for one data file).
+ */
+map<string, molstat::TokenContainer> ReadPreviousFits(const string &filename)
+{
+	map<string, molstat::TokenContainer> ret;
+
+	ifstream f(filename);
+	if(!f)
+		throw runtime_error("Error opening " + filename + " for input.");
+
+	string line;
+	while(getline(f, line))
+	{
+		// comments (e.g., the bootstrap report) are skipped
+		if(!line.empty() && line[0] == '#')
+			continue;
+
+		// the parameters are printed as "name=value, name=value, ..."
+		string file, params;
+		const size_t tab{ line.find('\t') };
+		if(tab != string::npos)
+		{
+			// a row of the table: file, residual, parameters
+			const size_t tab2{ line.find('\t', tab + 1) };
+			if(tab2 == string::npos ||
+				line.compare(tab + 1, tab2 - tab - 1, "-") == 0)
+			{
+				continue;
+			}
+
+			file = line.substr(0, tab);
+			params = line.substr(tab2 + 1);
+		}
+		else if(line.find('=') != string::npos &&
+			molstat::to_lower(line).compare(0, 5, "resid") != 0)
+		{
+			params = line;
+		}
+		else
+			continue;
+
+		if(!file.empty() && file[0] == '#')
+			continue;
+
+		ret[file] = molstat::tokenize(molstat::find_replace(
+			molstat::find_replace(params, ",", " "), "=", " "));
+	}
+
+	return ret;
+}
+
+/**
+ * \brief Reads a batch manifest: a list of data files to fit, each with
+ *    optional initial guesses of its own.
+ *
+ * Each line of the manifest either names a data file or, if it begins with
+ * `guess`, specifies an initial guess for the most recently named file (with
+ * the same syntax as in the input file).
+ *
+ * \throw std::runtime_error if the manifest cannot be opened.
+ *
+ * \param[in] filename The name of the manifest.
+ * \return The entries in the manifest.
+ */
+vector<BatchEntry> ReadManifest(const string &filename)
+{
+	vector<BatchEntry> ret;
+
+	ifstream f(filename);
+	if(!f)
+		throw runtime_error("Error opening " + filename + " for input.");
+
+	string line;
+	while(getline(f, line))
+	{
+		molstat::TokenContainer tokens = molstat::tokenize(line);
+		if(tokens.size() == 0)
+			continue;
+
+		if(molstat::to_lower(tokens.front()) != "guess")
+		{
+			ret.emplace_back();
+			ret.back().filename = tokens.front();
+			continue;
+		}
+
+		tokens.pop();
+		if(ret.size() == 0)
+			cerr << "Error: Initial guess specified before any data file in the"
+				" manifest. Skipping line." << endl;
+		else if(tokens.size() == 0)
+			cerr << "Error: No initial guess specified. Skipping line." << endl;
+		else if(molstat::to_lower(tokens.front()) == "default")
+			ret.back().usedefaultguess = true;
+		else
+			ret.back().guesses.emplace_back(move(tokens));
+	}
+
+	return ret;
+}
+
+/**
+ * \brief Fits the data in one file, or each file in a batch manifest, and
+ *    prints the results.
+ *
+ * \tparam N The number of independent variables in the fit function.
+ * \param[in] factory The factory for the model.
+ * \param[in] datafile The name of the file containing the data (if not in
+ *    batch mode).
+ * \param[in] manifest The name of the batch manifest; empty if not in batch
+ *    mode.
+ * \param[in] options The options for the fits.
+ * \param[in] warmstarts Previous fits for warm starting, keyed by data file.
+ */
+template<std::size_t N>
+void RunFits(const molstat::FitModelFactory<N> &factory,
+	const string &datafile, const string &manifest, FitOptions options,
+	const map<string, molstat::TokenContainer> &warmstarts)
+{
+	// the previous fit (if any) to warm start a data file from: that of
+	// the same file, otherwise one without a file name
+	const auto previous_fit = [&warmstarts] (const string &file)
+		-> molstat::TokenContainer
+	{
+		auto iter = warmstarts.find(file);
+		if(iter == warmstarts.end())
+			iter = warmstarts.find("");
+
+		return iter == warmstarts.end() ? molstat::TokenContainer() :
+			iter->second;
+	};
+
+	if(manifest.empty())
+	{
+		// fit the data in one file
+		options.warmstart = previous_fit(datafile);
+		const DataResult result{ FitData<N>(factory, datafile, options) };
+
+		cerr << result.errors << result.profile;
+		if(options.iterprint)
+			cout << result.log;
+
+		if(result.hasfit)
+		{
+			// print out the fit
+			cout << "Resid = " << scientific << setprecision(6) << result.resid
+				<< '\n' << result.params << endl;
+			cout << result.bootstrap << flush;
+		}
+
+		return;
+	}
+
+	// batch mode: fit the data in each file of the manifest
+	vector<BatchEntry> entries;
+	try
+	{
+		entries = ReadManifest(manifest);
+	}
+	catch(const runtime_error &e)
+	{
+		cerr << e.what() << endl;
+		return;
+	}
+
+	// the files are tasks of the scheduler; workers not needed for the files
+	// are used for the initial guesses of each file
+	vector<DataResult> results(entries.size());
+	options.scheduler->run(entries.size(), [&factory, &options, &entries,
+		&results, &previous_fit] (size_t j, size_t) -> void
+		{
+			// the global options, plus the entry's own guesses
+			FitOptions entry_options{ options };
+			entry_options.usedefaultguess =
+				options.usedefaultguess || entries[j].usedefaultguess;
+			entry_options.guesses.insert(entry_options.guesses.end(),
+				entries[j].guesses.begin(), entries[j].guesses.end());
+			entry_options.warmstart = previous_fit(entries[j].filename);
+
+			results[j] = FitData<N>(factory, entries[j].filename,
+				entry_options);
+		});
+
+	// print the errors, profiles, and iteration output for each file, then
+	// the table of results (in the order of the manifest)
+	for(size_t j = 0; j < entries.size(); ++j)
+	{
+		istringstream errors{ results[j].errors + results[j].profile };
+		string line;
+		while(getline(errors, line))
+			cerr << entries[j].filename << ": " << line << '\n';
+
+		if(options.iterprint)
+			cout << "File " << entries[j].filename << '\n' << results[j].log;
+	}
+	cerr << flush;
+
+	cout << "# file\tresid\tfit\n";
+	for(size_t j = 0; j < entries.size(); ++j)
+	{
+		cout << entries[j].filename << '\t';
+		if(results[j].hasfit)
+			cout << scientific << setprecision(6) << results[j].resid << '\t' <<
+				results[j].params << '\n';
+		else
+			cout << "-\tno fit\n";
+	}
+
+	// the bootstrap reports, with the file names
+	for(size_t j = 0; j < entries.size(); ++j)
+	{
+		istringstream report{ results[j].bootstrap };
+		string line;
+		while(getline(report, line))
+			cout << "# " << entries[j].filename << ": " << line.substr(2) <<
+				'\n';
+	}
+	cout << flush;
+}
+
 /**
  * \brief Main function.
  *
@@ -57,36 +1067,23 @@ using namespace std;
  */
 int main(int argc, char **argv)
 {
-	// non-linear fitting tools
-	unique_ptr<gsl_multifit_fdfsolver,
-	           decltype(&gsl_multifit_fdfsolver_free)>
-		solver(nullptr, &gsl_multifit_fdfsolver_free);
-	gsl_multifit_function_fdf fdf;
-
-	// status of the fit
-	unique_ptr<gsl_vector, decltype(&gsl_vector_free)>
-		vec(nullptr, &gsl_vector_free);
-	bool hasfit, iterprint, usedefaultguess;
-	double resid, bestresid;
-	int status;
-
-	// the model we're fitting against
-	unique_ptr<molstat::FitModel<1>> model;
 	// the list of models:
-	// stored as a map of string (model name) to a model factory, given the
-	// list of data
-	map<string, molstat::FitModelFactory<1>> models;
+	// stored as a registry from the model name (case insensitive) to a model
+	// factory, given the list of data; one registry for each dimension of the
+	// data
+	molstat::NameRegistry<molstat::FitModelFactory<1>> models1;
+	molstat::NameRegistry<molstat::FitModelFactory<2>> models2;
 
-	// the data we're fitting
-	list<pair<array<double, 1>, double>> data;
+	// the options for the fits
+	FitOptions options;
 
-	// various parameters for determining the best fit
-	vector<double> bestfit;
-	list<vector<double>> initvals;
-	list<vector<double>>::const_iterator initval;
+	// the data file, or the batch manifest
+	string datafile, manifest;
 
-	// counters & auxiliary variables
-	size_t i, iter, maxiter;
+	// previous fits for warm starting, keyed by data file
+	map<string, molstat::TokenContainer> warmstarts;
+
+	// auxiliary variables
 	string line, modelname;
 
 	gsl_set_error_handler_off();
@@ -94,7 +1091,8 @@ int main(int argc, char **argv)
 	// load the models
 	// FitModelAdd calls appear here
 	#if BUILD_TRANSPORT_FITTER
-	molstat::transport::load_models(models);
+	molstat::transport::load_models(models1);
+	molstat::transport::load_models(models2);
 	#endif
 
 	// set up the fit -- read in parameters from stdin
@@ -117,7 +1115,8 @@ int main(int argc, char **argv)
 	// instantiating the model)
 	modelname = tokens.front();
 
-	// Line 2: The file name of the conductance histogram data to fit
+	// Line 2: The file name of the conductance histogram data to fit, or
+	// "batch" and the file name of a manifest of data files
 	if(cin)
 		getline(cin, line);
 	else
@@ -131,52 +1130,35 @@ int main(int argc, char **argv)
 		cerr << "Error: file name expected in line 2." << endl;
 		return 0;
 	}
-
-	// read in the data points from the specified file
+	datafile = tokens.front();
+	if(tokens.size() > 1 && molstat::to_lower(datafile) == "batch")
 	{
-		ifstream f(tokens.front());
-		if(!f)
-		{
-			cerr << "Error opening " << tokens.front() << " for input." << endl;
-			return 0;
-		}
-		// read all lines in the file.
-		while(f)
-		{
-			double g, pdf;
-			f >> g >> pdf;
-			data.emplace_back(pair<array<double, 1>, double>({{g}}, pdf));
-		}
-		f.close();
+		tokens.pop();
+		manifest = tokens.front();
 	}
-	size_t nbin = data.size();
 
-	// set the model
-	try
-	{
-		// models.at() returns a function for instantiating the model
-		model = models.at(molstat::to_lower(modelname))(data);
-	}
-	catch(const out_of_range &e)
+	// make sure the model exists; it is instantiated once the data has been
+	// processed (the model stores its own copy of the data)
+	if(models1.count(modelname) == 0 && models2.count(modelname) == 0)
 	{
 		fprintf(stderr, "Error: model \"%s\" not found.\n", modelname.c_str());
 		return 0;
 	}
-	// set the vector size for the number of fitting parameters
-	bestfit.resize(model->nfit);
-
-	// set up GSL details
-	fdf = model->gsl_handle();
-	vec.reset(gsl_vector_alloc(model->nfit));
 
 	// Remaining lines: auxiliary options
 	// default options
-	iterprint = false; // don't print details at every iteration
-	maxiter = 100; // only allow 100 iterations per initial guess
-	initvals.clear(); // no initial guesses
-	usedefaultguess = false; // user specifies to use the default guesses
+	options.iterprint = false; // don't print details at every iteration
+	options.profile = false; // don't report the profile of each guess
+	options.maxiter = 100; // only allow 100 iterations per initial guess
+	// use all of the hardware threads (the results do not depend on them)
+	options.nthreads = max<size_t>(1, thread::hardware_concurrency());
+	options.prune_iter = 0; // run every initial guess to completion
+	options.prune_factor = 10.;
+	options.guesses.clear(); // no initial guesses
+	options.usedefaultguess = false; // user specifies to use the default guesses
 	// default is linear bins
-	unique_ptr<molstat::BinStyle> binstyle{ new molstat::BinLinear(1) };
+	options.binstyle = make_shared<molstat::BinLinear>(1);
+	options.solver = molstat::GetFitSolverFactory(molstat::tokenize("lmsder"));
 
 	// process the lines and override any of the default options
 	try
@@ -190,9 +1172,13 @@ int main(int argc, char **argv)
 				tokens.pop();
 
 				if(line == "print")
-					iterprint = true;
+					options.iterprint = true;
 				else if(line == "noprint")
-					iterprint = false;
+					options.iterprint = false;
+				else if(line == "profile")
+					options.profile = true;
+				else if(line == "noprofile")
+					options.profile = false;
 				else if(line == "guess")
 				{
 					// this line specifies a guess -- is it to use the defaults
@@ -209,20 +1195,13 @@ int main(int argc, char **argv)
 						if(line == "default")
 						{
 							tokens.pop();
-							usedefaultguess = true;
+							options.usedefaultguess = true;
 						}
 						else // this is a user-specified initial guess
 						{
-							// process the initial guess
-							try
-							{
-								model->append_initial_guess(move(tokens), initvals);
-							}
-							catch(const invalid_argument &e)
-							{
-								cerr << "Error: " << e.what() <<
-									" Skipping input line." << endl;
-							}
+							// the initial guess is processed once the model is
+							// instantiated
+							options.guesses.emplace_back(move(tokens));
 						}
 					}
 				}
@@ -249,7 +1228,7 @@ int main(int argc, char **argv)
 
 						try
 						{
-							binstyle = molstat::BinStyleFactory(move(tc));
+							options.binstyle = molstat::BinStyleFactory(move(tc));
 						}
 						catch(const invalid_argument &e)
 						{
@@ -269,7 +1248,8 @@ int main(int argc, char **argv)
 					{
 						try
 						{
-							maxiter = molstat::cast_string<size_t>(tokens.front());
+							options.maxiter =
+								molstat::cast_string<size_t>(tokens.front());
 							tokens.pop();
 						}
 						catch(const bad_cast &e)
@@ -279,124 +1259,266 @@ int main(int argc, char **argv)
 						}
 					}
 				}
-				// add other keywords/options here
-			}
-		}
-	}
-	catch(const runtime_error &e)
-	{
-		// this just means we hit EOF -- stop trying to read more
-	}
-
-	// use the bin type to "unmask", if necessary, the data so that we fit in
-	// g, not some function of g
-	for(list<pair<array<double, 1>, double>>::iterator iter = data.begin();
-		iter != data.end(); ++iter)
-	{
-
-		// transform the independent variable back to g
-		(*iter).first[0] = binstyle->invmask((*iter).first[0]);
-
-		// transform the PDF: P_g(g)
-		//    = P_mask(g)(mask(g)) * dmaskdx(invmask(u))
-		(*iter).second *= binstyle->dmaskdx((*iter).first[0]);
-	}
-
-	// do we need to load the default guesses?
-	if(usedefaultguess || initvals.size() == 0)
-		model->append_default_guesses(initvals);
+				else if(line == "threads") // the number of threads for the fits
+				{
+					if(tokens.size() == 0)
+					{
+						cerr << "Error: Number of threads unspecified." \
+							" Skipping line." << endl;
+					}
+					else
+					{
+						try
+						{
+							const size_t n
+								{ molstat::cast_string<size_t>(tokens.front()) };
+							tokens.pop();
 
-	solver.reset(
-		gsl_multifit_fdfsolver_alloc(gsl_multifit_fdfsolver_lmsder, nbin,
-			model->nfit));
+							if(n == 0)
+								cerr << "Error: At least 1 thread must be specified." \
+									" Skipping line." << endl;
+							else
+								options.nthreads = n;
 
-	// we don't have a successful fit at the start... set the residual as high
-	// as possible
-	hasfit = false;
-	bestresid = std::numeric_limits<double>::max();
+							// optionally pin the threads to CPUs
+							if(tokens.size() > 0 &&
+								molstat::to_lower(tokens.front()) == "pin")
+							{
+								options.pin = true;
+							}
+						}
+						catch(const bad_cast &e)
+						{
+							cerr << "Error interpreting number of threads." \
+								" Skipping line." << endl;
+						}
+					}
+				}
+				else if(line == "prune") // abandon guesses that won't win
+				{
+					// optional: iterations in the first round, then the factor
+					try
+					{
+						size_t n{ 5 };
+						double factor{ 10. };
 
-	// perform fits with all the initial values
-	for(initval = initvals.cbegin(); initval != initvals.cend(); ++initval)
-	{
-		// load the initial values
-		for(i = 0; i < model->nfit; ++i)
-			gsl_vector_set(vec.get(), i, (*initval)[i]);
+						if(tokens.size() > 0)
+						{
+							n = molstat::cast_string<size_t>(tokens.front());
+							tokens.pop();
+						}
+						if(tokens.size() > 0)
+						{
+							factor = molstat::cast_string<double>(tokens.front());
+							tokens.pop();
+						}
 
-		gsl_multifit_fdfsolver_set(solver.get(), &fdf, vec.get());
+						if(n == 0 || !(factor >= 1.))
+							cerr << "Error: Pruning requires a positive number of" \
+								" iterations and a factor of at least 1." \
+								" Skipping line." << endl;
+						else
+						{
+							options.prune_iter = n;
+							options.prune_factor = factor;
+						}
+					}
+					catch(const bad_cast &e)
+					{
+						cerr << "Error interpreting the pruning parameters." \
+							" Skipping line." << endl;
+					}
+				}
+				else if(line == "noprune")
+					options.prune_iter = 0;
+				else if(line == "solver") // the non-linear least-squares solver
+				{
+					try
+					{
+						options.solver = molstat::GetFitSolverFactory(move(tokens));
+					}
+					catch(const invalid_argument &e)
+					{
+						cerr << "Error: " << e.what() << " Skipping line." << endl;
+					}
+				}
+				else if(line == "tolerance") // the convergence criteria
+				{
+					try
+					{
+						if(tokens.size() != 2)
+							throw bad_cast();
 
-		// start iterating
-		iter = 0;
-		if(iterprint)
-		{
-			cout << "Iter=" << setw(3) << iter << ", ";
-			model->print_fit(cout, molstat::gsl_to_std(solver->x));
-			cout << endl;
-		}
+						molstat::FitTolerance tol;
+						tol.epsabs = molstat::cast_string<double>(tokens.front());
+						tokens.pop();
+						tol.epsrel = molstat::cast_string<double>(tokens.front());
+						tokens.pop();
 
-		do
-		{
-			++iter;
-			status = gsl_multifit_fdfsolver_iterate(solver.get());
-			if(iterprint)
-			{
-				cout << "Iter=" << setw(3) << iter << ", ";
-				model->print_fit(cout, molstat::gsl_to_std(solver->x));
-				cout << endl;
-			}
+						if(!(tol.epsabs >= 0.) || !(tol.epsrel >= 0.) ||
+							tol.epsabs + tol.epsrel == 0.)
+							cerr << "Error: The tolerances must be non-negative and" 								" not both zero. Skipping line." << endl;
+						else
+							options.tolerance = tol;
+					}
+					catch(const bad_cast &e)
+					{
+						cerr << "Error interpreting the tolerances (absolute and" 							" relative). Skipping line." << endl;
+					}
+				}
+				else if(line == "precision") // of the models' integrals
+				{
+					try
+					{
+						if(tokens.size() == 0)
+							throw bad_cast();
 
-			if(status)
-				break;
+						molstat::SetFitIntegrationTolerance(
+							molstat::cast_string<double>(tokens.front()));
+						tokens.pop();
+					}
+					catch(const bad_cast &e)
+					{
+						cerr << "Error interpreting the precision. Skipping" \
+							" line." << endl;
+					}
+					catch(const invalid_argument &e)
+					{
+						cerr << "Error: " << e.what() << " Skipping line." << endl;
+					}
+				}
+				else if(line == "objective") // the quantity minimized
+				{
+					if(tokens.size() == 0)
+						cerr << "Error: No fit objective specified. Skipping" \
+							" line." << endl;
+					else
+					{
+						try
+						{
+							options.objective =
+								molstat::FitObjectiveFromName(tokens.front());
+						}
+						catch(const invalid_argument &e)
+						{
+							cerr << "Error: " << e.what() <<
+								" Skipping line." << endl;
+						}
+						tokens.pop();
+					}
+				}
+				else if(line == "warmstart") // start from previous fits
+				{
+					if(tokens.size() == 0)
+					{
+						cerr << "Error: No file of previous fits specified." \
+							" Skipping line." << endl;
+					}
+					else
+					{
+						try
+						{
+							map<string, molstat::TokenContainer> fits
+								{ ReadPreviousFits(tokens.front()) };
+							tokens.pop();
 
-			status = gsl_multifit_test_delta(solver->dx, solver->x, 1.0e-4,
-				1.0e-4);
-		} while(status == GSL_CONTINUE && iter < maxiter);
+							double spread{ 0.1 };
+							if(tokens.size() > 0)
+							{
+								spread = molstat::cast_string<double>(tokens.front());
+								tokens.pop();
+							}
 
-		if(iterprint)
-		{
-			if(status != GSL_CONTINUE && status != GSL_SUCCESS)
-				cout << "   " << gsl_strerror(status) << '\n' << endl;
-		}
+							if(!(spread >= 0.))
+								cerr << "Error: The warm-start spread must be" \
+									" non-negative. Skipping line." << endl;
+							else if(fits.size() == 0)
+								cerr << "Error: No previous fits found. Skipping" \
+									" line." << endl;
+							else
+							{
+								warmstarts = move(fits);
+								options.warmstart_spread = spread;
+							}
+						}
+						catch(const runtime_error &e)
+						{
+							cerr << e.what() << " Skipping line." << endl;
+						}
+						catch(const bad_cast &e)
+						{
+							cerr << "Error interpreting the warm-start spread." \
+								" Skipping line." << endl;
+						}
+					}
+				}
+				else if(line == "bootstrap") // confidence intervals
+				{
+					// the number of resamples, then optionally the confidence
+					// level and seed
+					try
+					{
+						if(tokens.size() == 0)
+							throw bad_cast();
 
-		// did we converge, iteration out, or error out?
-		if(status != GSL_CONTINUE && status != GSL_SUCCESS &&
-			status != GSL_ENOPROG)
-		{
-			// errored out
-			continue; // try the next guess of initial values
-		}
+						const size_t n
+							{ molstat::cast_string<size_t>(tokens.front()) };
+						tokens.pop();
 
-		// do some final processing
-		resid = gsl_blas_dnrm2(solver->f);
-		if(iterprint)
-			cout << "Residual = " << scientific << setprecision(6) << resid <<
-				'\n' << endl;
+						double level{ 0.95 };
+						if(tokens.size() > 0)
+						{
+							level =
+								molstat::cast_string<double>(tokens.front());
+							tokens.pop();
+						}
 
-		if(!hasfit || resid < bestresid)
-		{
-			// copy over the parameters
-			bestresid = resid;
-			for(i = 0; i < model->nfit; ++i)
-				bestfit[i] = gsl_vector_get(solver->x, i);
+						uint64_t seed{ 1 };
+						if(tokens.size() > 0)
+						{
+							seed =
+								molstat::cast_string<uint64_t>(tokens.front());
+							tokens.pop();
+						}
 
-			hasfit = true;
+						if(n < 2 || !(level > 0.) || !(level < 1.))
+							cerr << "Error: The bootstrap requires at least 2" \
+								" resamples and a level between 0 and 1." \
+								" Skipping line." << endl;
+						else
+						{
+							options.bootstrap = n;
+							options.bootstrap_level = level;
+							options.bootstrap_seed = seed;
+						}
+					}
+					catch(const bad_cast &e)
+					{
+						cerr << "Error interpreting the bootstrap parameters" \
+							" (resamples [level [seed]]). Skipping line." <<
+							endl;
+					}
+				}
+				// add other keywords/options here
+			}
 		}
 	}
-
-	// did we get a fit?
-	if(!hasfit)
+	catch(const runtime_error &e)
 	{
-		cerr << "Error fitting." << endl;
+		// this just means we hit EOF -- stop trying to read more
 	}
-	else
-	{
-		// make sure the fit parameters are good
-		model->process_fit_parameters(bestfit);
 
-		// print ou the fit
-		cout << "Resid = " << scientific << setprecision(6) << bestresid << '\n';
-		model->print_fit(cout, bestfit);
-		cout << endl;
-	}
+	// one pool of threads for all of the parallel work
+	molstat::TaskScheduler scheduler{ options.nthreads, options.pin };
+	options.scheduler = &scheduler;
+
+	// the models are sorted by the dimension of the data
+	if(models1.count(modelname) > 0)
+		RunFits<1>(models1.at(modelname), datafile, manifest,
+			options, warmstarts);
+	else
+		RunFits<2>(models2.at(modelname), datafile, manifest,
+			options, warmstarts);
 
 	return 0;
 }
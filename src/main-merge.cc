@@ -0,0 +1,158 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file main-merge.cc
+ * \brief Main function for merging histograms from independent runs.
+ *
+ * Usage: `molstat-merge [-f format] output input [input ...]`
+ *
+ * The inputs are mergeable histograms (e.g., from shards of a distributed
+ * simulation) with identical bins. The output is their sum, written in the
+ * specified format (`mergeable`, by default). Because the sum of mergeable
+ * histograms is mergeable, the outputs can be merged again; large numbers
+ * of shards can be combined with a tree reduction.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <general/histogram_tools/histogram_io.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for merging histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	molstat::HistogramFormat format{ molstat::HistogramFormat::Mergeable };
+	vector<string> args(argv + 1, argv + argc);
+
+	// optional: the output format
+	if(args.size() >= 2 && args[0] == "-f")
+	{
+		try
+		{
+			format = molstat::HistogramFormatFromName(args[1]);
+		}
+		catch(const invalid_argument &e)
+		{
+			cout << "FATAL ERROR: " << e.what() << endl;
+			return 0;
+		}
+
+		args.erase(args.begin(), args.begin() + 2);
+	}
+
+	if(args.size() < 2)
+	{
+		cout << "Usage: molstat-merge [-f format] output input [input ...]" <<
+			endl;
+		return 0;
+	}
+	if(format == molstat::HistogramFormat::HDF5)
+	{
+		cout << "FATAL ERROR: molstat-merge cannot write HDF5 histograms." <<
+			endl;
+		return 0;
+	}
+
+	const string histfilename{ args[0] };
+	molstat::MergeableHistogram sum;
+
+	try
+	{
+		// read the histograms one at a time, adding each to the sum
+		for(size_t j = 1; j < args.size(); ++j)
+		{
+			ifstream histin(args[j], ios_base::in | ios_base::binary);
+			if(!histin)
+				throw runtime_error("Unable to open \"" + args[j] + "\".");
+
+			molstat::MergeableHistogram shard;
+			try
+			{
+				shard = molstat::ReadHistogramMergeable(histin);
+			}
+			catch(const runtime_error &e)
+			{
+				throw runtime_error("\"" + args[j] + "\": " + e.what());
+			}
+
+			if(j == 1)
+				sum = move(shard);
+			else
+			{
+				try
+				{
+					molstat::MergeHistograms(sum, shard);
+				}
+				catch(const invalid_argument &e)
+				{
+					throw runtime_error("\"" + args[j] + "\": " + e.what());
+				}
+			}
+		}
+
+		cout << "Merged " << (args.size() - 1) << " histogram" <<
+			(args.size() == 2 ? "" : "s") << ": " << sum.nbinned << " of the " <<
+			sum.ntrials << " trials were binned (" << sum.nout <<
+			" were outside the histogram bounds).\n";
+		for(size_t j = 0; j < sum.out_of_range.size(); ++j)
+		{
+			cout << "   Dimension " << j << ": " << sum.out_of_range[j][0] <<
+				" underflow(s), " << sum.out_of_range[j][1] << " overflow(s)." <<
+				'\n';
+		}
+		cout << "Histogram Output File: " << histfilename << " (" <<
+			molstat::HistogramFormatName(format) << ")" << endl;
+
+		ofstream histout(histfilename,
+			format == molstat::HistogramFormat::Text ? std::ios_base::out :
+			std::ios_base::out | std::ios_base::binary);
+		if(!histout)
+			throw runtime_error("Unable to open \"" + histfilename +
+				"\" for output.");
+
+		switch(format)
+		{
+		case molstat::HistogramFormat::Mergeable:
+			molstat::WriteHistogramMergeable(histout, sum);
+			break;
+		case molstat::HistogramFormat::Binary:
+			molstat::WriteHistogramBinary(histout,
+				molstat::WeightMergeableHistogram(sum));
+			break;
+		case molstat::HistogramFormat::Gzip:
+			molstat::WriteHistogramGzip(histout,
+				molstat::WeightMergeableHistogram(sum));
+			break;
+		case molstat::HistogramFormat::Text:
+		default:
+			molstat::WriteHistogramText(histout,
+				molstat::WeightMergeableHistogram(sum));
+			break;
+		}
+	}
+	catch(const exception &e)
+	{
+		cout << "FATAL ERROR: " << e.what() << endl;
+		return 0;
+	}
+
+	return 0;
+}
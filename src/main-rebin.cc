@@ -0,0 +1,251 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file main-rebin.cc
+ * \brief Main function for binning raw samples (written by the simulator)
+ *    into a histogram, without repeating the simulation.
+ *
+ * This code reads the input parameters from standard in: the raw sample
+ * file, the columns to bin (and how to bin them), the output file, and the
+ * number of threads. The sample file is memory mapped and binned in
+ * parallel.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <thread>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <general/string_tools.h>
+#include <general/histogram_tools/bin_style.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/histogram_io.h>
+#include <general/histogram_tools/sample_file.h>
+
+using namespace std;
+
+/**
+ * \brief Prints an error message.
+ *
+ * \param[in,out] output The output stream.
+ * \param[in] lineno The line number.
+ * \param[in] message The error message.
+ */
+static void printError(std::ostream &output, std::size_t lineno,
+	const std::string &message)
+{
+	output << "Error on line " << setw(2) << lineno << ": " << message << endl;
+}
+
+/**
+ * \brief Main function for binning raw samples.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	string samplefilename;
+	string histfilename{ "histogram.dat" };
+	molstat::HistogramFormat format{ molstat::HistogramFormat::Text };
+	size_t nthreads{ 1 };
+
+	// the column (name or index) and binning style of each dimension
+	vector<pair<string, shared_ptr<const molstat::BinStyle>>> dims;
+
+	// process the input deck
+	size_t lineno{ 1 };
+	for(string line; getline(cin, line); ++lineno)
+	{
+		molstat::TokenContainer tokens = molstat::tokenize(line);
+		if(tokens.size() == 0) // empty line
+			continue;
+
+		const string command{ molstat::to_lower(tokens.front()) };
+		tokens.pop();
+
+		if(command == "samples")
+		{
+			if(tokens.size() == 0)
+				printError(cout, lineno, "No raw sample file name specified.");
+			else
+				samplefilename = tokens.front();
+		}
+		else if(command == "bin")
+		{
+			if(tokens.size() < 3)
+			{
+				printError(cout, lineno, "No column, number of bins, and/or " \
+					"binning style specified.");
+			}
+			else
+			{
+				const string column{ molstat::to_lower(tokens.front()) };
+				tokens.pop();
+
+				try
+				{
+					dims.emplace_back(column,
+						molstat::BinStyleFactory(move(tokens)));
+				}
+				catch(const invalid_argument &e)
+				{
+					// indent the error message
+					printError(cout, lineno,
+						molstat::find_replace(e.what(), "\n", "\n   "));
+				}
+			}
+		}
+		else if(command == "output")
+		{
+			if(tokens.size() == 0)
+				printError(cout, lineno, "No output file name specified.");
+			else
+			{
+				histfilename = tokens.front();
+				tokens.pop();
+
+				// optional: the output format
+				if(tokens.size() > 0)
+				{
+					try
+					{
+						format = molstat::HistogramFormatFromName(tokens.front());
+					}
+					catch(const invalid_argument &e)
+					{
+						printError(cout, lineno,
+							molstat::find_replace(e.what(), "\n", "\n   "));
+					}
+				}
+			}
+		}
+		else if(command == "threads")
+		{
+			try
+			{
+				if(tokens.size() == 0)
+					throw bad_cast();
+
+				nthreads = molstat::cast_string<size_t>(tokens.front());
+				if(nthreads == 0)
+					throw bad_cast();
+			}
+			catch(const bad_cast &e)
+			{
+				printError(cout, lineno, "The number of threads must be a " \
+					"positive number.");
+				nthreads = 1;
+			}
+		}
+		else
+			printError(cout, lineno, "Unknown command: \"" + command + "\".");
+	}
+
+	if(samplefilename.empty())
+	{
+		cout << "FATAL ERROR: No raw sample file specified." << endl;
+		return 0;
+	}
+	if(dims.empty())
+	{
+		cout << "FATAL ERROR: No columns to bin." << endl;
+		return 0;
+	}
+
+	try
+	{
+		const molstat::SampleFileReader samples(samplefilename);
+		const molstat::SampleFileHeader &header = samples.header();
+
+		// find each column, by name or by index
+		vector<size_t> columns;
+		vector<shared_ptr<const molstat::BinStyle>> bstyles;
+		for(const auto &dim : dims)
+		{
+			size_t col{ header.names.size() };
+			for(size_t k = 0; k < header.names.size(); ++k)
+				if(molstat::to_lower(header.names[k]) == dim.first)
+					col = k;
+
+			if(col == header.names.size())
+			{
+				try
+				{
+					col = molstat::cast_string<size_t>(dim.first);
+				}
+				catch(const bad_cast &e)
+				{
+					throw runtime_error("Unknown column \"" + dim.first + "\".");
+				}
+			}
+
+			columns.push_back(col);
+			bstyles.push_back(dim.second);
+		}
+
+		cout << "Binning " << samples.size() << " samples from \"" <<
+			samplefilename << "\" using " << nthreads << " thread" <<
+			(nthreads == 1 ? "" : "s") << ".\n";
+		for(size_t j = 0; j < columns.size(); ++j)
+		{
+			cout << "   Dimension " << j << ": column " << columns[j];
+			if(columns[j] < header.names.size())
+				cout << " (" << header.names[columns[j]] << ')';
+			cout << ", " << bstyles[j]->info() << '\n';
+		}
+		cout << "Histogram Output File: " << histfilename << " (" <<
+			molstat::HistogramFormatName(format) << ")" << endl;
+
+		const molstat::Histogram hist{ molstat::RebinSamples(samples, columns,
+			bstyles, nthreads) };
+
+		cout << hist.numOutOfRange() << " of the samples were outside the " \
+			"histogram bounds." << endl;
+		const size_t nbinned{ samples.size() - hist.numOutOfRange() };
+
+		if(format == molstat::HistogramFormat::HDF5)
+			molstat::WriteHistogramHDF5(histfilename, hist, bstyles,
+				samples.size(), nbinned);
+		else
+		{
+			ofstream histout(histfilename,
+				format == molstat::HistogramFormat::Text ? std::ios_base::out :
+				std::ios_base::out | std::ios_base::binary);
+			if(!histout)
+				throw runtime_error("Unable to open \"" + histfilename +
+					"\" for output.");
+
+			if(format == molstat::HistogramFormat::Binary)
+				molstat::WriteHistogramBinary(histout, hist, bstyles,
+					samples.size(), nbinned);
+			else if(format == molstat::HistogramFormat::Gzip)
+				molstat::WriteHistogramGzip(histout, hist);
+			else if(format == molstat::HistogramFormat::Mergeable)
+				molstat::WriteHistogramMergeable(histout,
+					molstat::MakeMergeableHistogram(hist, bstyles, samples.size(),
+						nbinned));
+			else
+				molstat::WriteHistogramText(histout, hist);
+		}
+	}
+	catch(const exception &e)
+	{
+		cout << "FATAL ERROR: " << e.what() << endl;
+		return 0;
+	}
+
+	return 0;
+}
@@ -33,21 +33,133 @@
  */
 
 #include "main-simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
 #include <iomanip>
+#include <limits>
+#include <sstream>
+#include <random>
+#include <set>
 
 #include <config.h>
 
 #include <general/simulator_tools/simulator_exceptions.h>
 #include <general/random_distributions/rng.h>
+#include <general/random_distributions/multivariate_normal.h>
 #include <general/histogram_tools/bin_style.h>
 #include <general/simulator_tools/identity_tools.h>
+#include <general/simulator_tools/trace_protocol.h>
+#include <general/simulator_tools/observable_table.h>
+#include <general/batch_kernels.h>
+#include <general/binary_io.h>
 
 #if BUILD_TRANSPORT_SIMULATOR
 #include <electron_transport/simulator_models/transport_simulate_module.h>
+#include <electron_transport/simulator_models/rectangular_barrier.h>
+#include <electron_transport/simulator_models/tight_binding_channel.h>
 #endif
 
 using namespace std;
 
+/// \cond
+namespace {
+
+/// The magic bytes at the start of a compiled configuration.
+const char compiled_magic[8]{ 'M', 'O', 'L', 'S', 'T', 'A', 'T', 'D' };
+
+/// What the stream holds, for the error messages.
+const char compiled_source[]{ "the compiled configuration" };
+
+using molstat::WriteBinaryUInt;
+using molstat::ReadBinaryUInt;
+using molstat::WriteBinaryDouble;
+using molstat::ReadBinaryDouble;
+using molstat::WriteBinaryString;
+using molstat::ReadBinaryString;
+
+/// The version of the compiled configuration format.
+const std::uint64_t compiled_version{ 12 };
+
+/**
+ * \brief Copies the tokens of a line into a list of words.
+ *
+ * \param[in] tokens The tokens.
+ * \return The words.
+ */
+vector<string> ToWords(molstat::TokenContainer tokens)
+{
+	vector<string> ret;
+	for(; tokens.size() > 0; tokens.pop())
+		ret.push_back(move(tokens.front()));
+	return ret;
+}
+
+/**
+ * \brief Copies a list of words into tokens (e.g., for a factory).
+ *
+ * \param[in] words The words.
+ * \return The tokens.
+ */
+molstat::TokenContainer ToTokens(const vector<string> &words)
+{
+	molstat::TokenContainer ret;
+	for(const string &word : words)
+		ret.push(word);
+	return ret;
+}
+
+/**
+ * \brief Splits the comma-separated parameter names of a joint
+ *    distribution.
+ *
+ * \param[in] names The names.
+ * \return The list of names.
+ */
+vector<string> SplitNames(const string &names)
+{
+	vector<string> ret;
+	for(size_t begin = 0, end = 0; end != string::npos; begin = end + 1)
+	{
+		end = names.find(',', begin);
+		ret.push_back(names.substr(begin, end - begin));
+	}
+	return ret;
+}
+
+/**
+ * \brief Writes a list of words to a binary stream.
+ *
+ * \param[in,out] out The output stream.
+ * \param[in] words The words.
+ */
+void write_words(ostream &out, const vector<string> &words)
+{
+	WriteBinaryUInt(out, words.size());
+	for(const string &word : words)
+		WriteBinaryString(out, word);
+}
+
+/**
+ * \brief Reads a list of words written by write_words.
+ *
+ * \throw std::runtime_error if the stream ends early.
+ *
+ * \param[in,out] in The input stream.
+ * \return The words.
+ */
+vector<string> read_words(istream &in)
+{
+	vector<string> ret(ReadBinaryUInt(in, compiled_source));
+	for(string &word : ret)
+		word = ReadBinaryString(in, compiled_source);
+	return ret;
+}
+
+} // anonymous namespace
+/// \endcond
+
 inline void SimulatorInputParse::printError(std::ostream &output,
 	std::size_t lineno, std::string message)
 {
@@ -57,39 +169,151 @@ inline void SimulatorInputParse::printError(std::ostream &output,
 std::unique_ptr<molstat::Simulator> SimulatorInputParse::createSimulator(
 	std::ostream &output)
 {
-	// the map of model instantiators
-	map<string, molstat::SimulateModelFactoryFunction> models;
+	// the registry of model instantiators
+	molstat::NameRegistry<molstat::SimulateModelFactoryFunction> models;
 
-	// the map of observable indexes
-	map<string, molstat::ObservableIndex> observables;
+	// the registry of observable indexes
+	molstat::NameRegistry<molstat::ObservableIndex> observables;
 
 	// load model and observable names
 	// the general syntax for loading models is
-	// models.emplace( molstat::to_lower(name),
-	//                 molstat::GetSimulateModelFactory<model_type>() );
+	// models.add( MOLSTAT_REGISTRY_KEY(name),
+	//             molstat::GetSimulateModelFactory<model_type>() );
 	//
 	// and likewise for observables,
-	// observables.emplace( molstat::to_lower(name),
-	//                      molstat::GetObservableIndex<observable_type>() );
-	models.emplace( molstat::to_lower("IdentityModel"),
+	// observables.add( MOLSTAT_REGISTRY_KEY(name),
+	//                  molstat::GetObservableIndex<observable_type>() );
+	models.add( MOLSTAT_REGISTRY_KEY("IdentityModel"),
 		molstat::GetSimulateModelFactory<molstat::IdentityModel>() );
-	observables.emplace( molstat::to_lower("Identity"),
+	observables.add( MOLSTAT_REGISTRY_KEY("Identity"),
 		molstat::GetObservableIndex<molstat::IdentityObservable>() );
 
 	#if BUILD_TRANSPORT_SIMULATOR
 	// load transport models
 	molstat::transport::load_models(models);
 	molstat::transport::load_observables(observables);
+
+	// the quadrature for energy integrals. a precision replaces the
+	// tolerances of adaptive quadrature with a relative tolerance.
+	double epsabs{ quadrature_tolerance }, epsrel{ quadrature_tolerance };
+	const double needed{ integrationPrecision() };
+	if(needed > 0.)
+	{
+		epsabs = 0.;
+		epsrel = needed;
+	}
+	molstat::transport::RectangularBarrier::setStaticGQuadrature(
+		quadrature_order, epsabs, epsrel);
+	molstat::transport::TightBindingChannel::setStaticGQuadrature(
+		quadrature_order, epsabs, epsrel);
 	#endif
 
+	// a calibration tunes its variables (starting from their given values)
+	// against one target histogram
+	for(const CalibrationVariable &var : calibrate_variables)
+		if(!sweep_values.empty() && var.name == sweep_name)
+			throw runtime_error("\"$" + sweep_name + "\" cannot be both the " \
+				"sweep variable and a calibration variable.");
+	if(!calibrate_filename.empty())
+	{
+		if(calibrate_variables.empty())
+			throw runtime_error("A calibration requires at least one " \
+				"variable (see vary).");
+		if(!sweep_values.empty())
+			throw runtime_error("Calibrations cannot be combined with sweeps.");
+		if(trace != nullptr)
+			throw runtime_error("Calibrations are not supported for traces.");
+		for(const CalibrationVariable &var : calibrate_variables)
+			if(!refersTo(top_model, '$' + var.name))
+				throw runtime_error("No distribution depends on the " \
+					"calibration variable \"$" + var.name + "\".");
+	}
+
+	// the distributions that depend on the sweep variable start with its
+	// first value (and those that depend on a calibration's variables, with
+	// their starting values)
+	if(sweepModelInformation(top_model, 0) == 0 && !sweep_values.empty())
+		throw runtime_error("No distribution depends on the sweep variable \"$"
+			+ sweep_name + "\".");
+
+	if(sampling != SamplingMethod::Random && trace != nullptr)
+		throw runtime_error("Only random sampling is supported for traces.");
+
 	// make the model
 	// if there are exceptions, let them pass up to the caller
+	list<pair<shared_ptr<molstat::SimulateModel>, ModelInformation>> tabulate;
+	list<pair<shared_ptr<molstat::SimulateModel>,
+		map<string, shared_ptr<const molstat::RandomDistribution>>>> proposed;
+	swept_models.clear();
 	shared_ptr<molstat::SimulateModel> model
-		{ constructModel(output, models, top_model) };
+		{ constructModel(output, models, top_model, tabulate, swept_models,
+			proposed) };
+
+	// tabulate observables over the range of parameters for each model,
+	// found from a pilot sample
+	if(!tabulate.empty())
+	{
+		constexpr size_t pilot_samples = 10000;
+		molstat::Engine pilot{ rng_seed, rng_stream, engine_kind };
+		const auto samples =
+			molstat::SampleModelParameters(*model, pilot, pilot_samples);
+
+		for(const auto &tab : tabulate)
+		{
+			// skip submodels that were not added to the model
+			const auto model_samples = samples.find(tab.first.get());
+			if(model_samples == samples.end())
+				continue;
+
+			for(const auto &table : tab.second.tables)
+			{
+				try
+				{
+					const double error{ tab.first->tabulateObservable(
+						observables.at(table.first), model_samples->second,
+						table.second) };
+
+					if(!json_report)
+						output << "Tabulated " << table.first << " for model "
+							<< tab.second.name << "; estimated interpolation " \
+							"error " << error << '.' << endl;
+				}
+				catch(const out_of_range &e)
+				{
+					output << "Unknown observable to tabulate: \"" << table.first
+						<< "\"." << endl;
+				}
+				catch(const exception &e)
+				{
+					output << "Error tabulating " << table.first << " for model " <<
+						tab.second.name << ":\n   " << e.what() << endl;
+				}
+			}
+		}
+	}
 	
 	// make the simulator
 	unique_ptr<molstat::Simulator> sim{ new molstat::Simulator(model) };
 
+	// set the proposal distributions for importance sampling
+	for(const auto &prop : proposed)
+	{
+		for(const auto &dist : prop.second)
+		{
+			try
+			{
+				sim->setProposal(*prop.first, dist.first, dist.second);
+			}
+			catch(const exception &e)
+			{
+				throw runtime_error("Unable to set the proposal distribution " \
+					"of \"" + dist.first + "\":\n   " + e.what());
+			}
+		}
+	}
+	if(sim->isWeighted() && trace != nullptr)
+		throw runtime_error("Importance sampling is not supported for traces.");
+
 	// set the observables
 	bool bad_obs { false };
 	auto obs_iter = obs_bins.begin();
@@ -189,6 +413,20 @@ void SimulatorInputParse::readInput(std::istream &input, std::ostream &output)
 				top_model = move(model);
 			}
 		}
+		else if(command == "trace")
+		{
+			// enter the trace reader to process input lines until the
+			// "endtrace" command is found
+			TraceInformation info;
+			shared_ptr<molstat::TraceProtocol> protocol
+				{ readTrace(input, output, ++lineno, info) };
+
+			if(protocol != nullptr)
+			{
+				trace = protocol;
+				trace_info = move(info);
+			}
+		}
 		else if(command == "observable" || command == "observable_x" ||
 			command == "observable_y")
 		{
@@ -208,14 +446,14 @@ void SimulatorInputParse::readInput(std::istream &input, std::ostream &output)
 				// construct the binning style
 				try
 				{
+					vector<string> words{ ToWords(tokens) };
 					shared_ptr<molstat::BinStyle> binstyle
 						{ molstat::BinStyleFactory(move(tokens)) };
 
 					// store the observable name and binning style
-					if(command == "observable_y")
-						obs_bins.emplace(1, make_pair(obsname, binstyle));
-					else
-						obs_bins.emplace(0, make_pair(obsname, binstyle));
+					const size_t axis{ command == "observable_y" ? 1u : 0u };
+					obs_bins.emplace(axis, make_pair(obsname, binstyle));
+					bin_specs.emplace(axis, move(words));
 				}
 				catch(const invalid_argument &e)
 				{
@@ -234,162 +472,1868 @@ void SimulatorInputParse::readInput(std::istream &input, std::ostream &output)
 			else
 			{
 				histfilename = tokens.front();
+				tokens.pop();
+
+				// optional: the output format
+				if(tokens.size() > 0)
+				{
+					try
+					{
+						histformat = molstat::HistogramFormatFromName(tokens.front());
+					}
+					catch(const invalid_argument &e)
+					{
+						// indent the error message
+						printError(output, lineno,
+							molstat::find_replace(e.what(), "\n", "\n   "));
+					}
+				}
 			}
 		}
-		else if(command == "trials")
+		else if(command == "samples")
 		{
 			if(tokens.size() == 0)
 			{
-				printError(output, lineno, "Number of trials not specified.");
+				printError(output, lineno, "No raw sample file name specified.");
 			}
 			else
 			{
-				try
+				samplefilename = tokens.front();
+				tokens.pop();
+
+				// optional: also write the model parameters
+				if(tokens.size() > 0)
 				{
-					trials = molstat::cast_string<size_t>(tokens.front());
-					if(trials == 0)
+					if(molstat::to_lower(tokens.front()) == "parameters")
+						sample_params = true;
+					else
+						printError(output, lineno, "Unknown raw sample option: \"" +
+							tokens.front() + "\".");
+				}
+			}
+		}
+		else if(command == "density")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno,
+					"No kernel density estimate file name specified.");
+			}
+			else
+			{
+				densityfilename = tokens.front();
+				tokens.pop();
+
+				// optional: the output format (the bandwidths are numbers)
+				bool have_format{ tokens.size() > 0 };
+				if(have_format)
+				{
+					try
+					{
+						molstat::cast_string<double>(tokens.front());
+						have_format = false;
+					}
+					catch(const bad_cast &e)
+					{
+						// not a number, so it must be the format
+					}
+				}
+				if(have_format)
+				{
+					try
+					{
+						densityformat =
+							molstat::HistogramFormatFromName(tokens.front());
+						if(densityformat == molstat::HistogramFormat::Mergeable ||
+							densityformat == molstat::HistogramFormat::HDF5)
+						{
+							printError(output, lineno, "Kernel density estimates " \
+								"can only be written as text, gzip, or binary.");
+						}
+					}
+					catch(const invalid_argument &e)
+					{
+						// indent the error message
 						printError(output, lineno,
-							"More than 0 trials should be specified.");
+							molstat::find_replace(e.what(), "\n", "\n   "));
+					}
+					tokens.pop();
 				}
-				catch(const bad_cast &e)
+
+				// optional: the bandwidth in each dimension
+				density_bandwidths.clear();
+				for(; tokens.size() > 0; tokens.pop())
 				{
-					printError(output, lineno, "Unable to convert \"" + tokens.front() +
-						"\" to a non-negative number.");
+					try
+					{
+						const double h{ molstat::cast_string<double>(tokens.front()) };
+						if(!(h >= 0.))
+							printError(output, lineno,
+								"The bandwidths must not be negative.");
+						else
+							density_bandwidths.push_back(h);
+					}
+					catch(const bad_cast &e)
+					{
+						printError(output, lineno, "Unable to convert \"" +
+							tokens.front() + "\" to a number.");
+					}
 				}
 			}
 		}
-		else
+		else if(command == "sweep")
 		{
-			printError(output, lineno, "Unknown command: \"" + command + "\".");
-		}
-
-		// move to the next line
-		++lineno;
-	}
-}
-
-SimulatorInputParse::ModelInformation SimulatorInputParse::readModel(
-	std::istream &input, std::ostream &output, std::size_t &lineno)
-{
-	ModelInformation ret;
+			// sweep name value [value ...]
+			// sweep name linear first last count
+			if(tokens.size() < 2)
+			{
+				printError(output, lineno, "A sweep requires a variable name " \
+					"and at least one value.");
+			}
+			else
+			{
+				const string name{ tokens.front()[0] == '$' ?
+					tokens.front().substr(1) : tokens.front() };
+				tokens.pop();
+				vector<string> values;
 
-	while(input)
-	{
-		string line;
-		getline(input, line);
+				try
+				{
+					if(molstat::to_lower(tokens.front()) == "linear")
+					{
+						tokens.pop();
+						if(tokens.size() != 3)
+							throw invalid_argument("A linear sweep requires the " \
+								"first and last values and the number of values.");
 
-		// tokenize the string
-		molstat::TokenContainer tokens = molstat::tokenize(line);
-		if(tokens.size() == 0) // empty line
-		{
-			++lineno;
-			continue;
-		}
+						const double first{ molstat::cast_string<double>(
+							tokens.front()) };
+						tokens.pop();
+						const double last{ molstat::cast_string<double>(
+							tokens.front()) };
+						tokens.pop();
+						const size_t count{ molstat::cast_string<size_t>(
+							tokens.front()) };
+						if(count == 0)
+							throw invalid_argument("A sweep requires at least " \
+								"one value.");
 
-		// the first token is the command name, pop it off and then process the
-		// rest of the tokens
-		string command { molstat::to_lower(tokens.front()) };
-		tokens.pop();
+						for(size_t k = 0; k < count; ++k)
+						{
+							ostringstream value;
+							value << (count == 1 ? first :
+								first + (last - first) * k / (count - 1));
+							values.push_back(value.str());
+						}
+					}
+					else
+					{
+						for(; tokens.size() > 0; tokens.pop())
+						{
+							molstat::cast_string<double>(tokens.front());
+							values.push_back(tokens.front());
+						}
+					}
 
-		// go through the supported commands
-		if(command == "endmodel")
-		{
-			// we're done here
-			return ret;
+					if(name.empty())
+						printError(output, lineno, "No sweep variable name.");
+					else
+					{
+						sweep_name = name;
+						sweep_values = move(values);
+					}
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a number.");
+				}
+				catch(const invalid_argument &e)
+				{
+					printError(output, lineno, e.what());
+				}
+			}
 		}
-		else if(command == "model")
+		else if(command == "calibrate")
 		{
-			// the total lineno needs to be passed to the (sub)model reader
-			const size_t mylineno{ lineno };
-
-			// enter the (sub)model reader to process input lines until the
-			// appropriate "endmodel" command is found
-			ModelInformation model = readModel(input, output, ++lineno);
-
-			// make sure there is a name (model type) specified
+			// calibrate target [trials] [iterations] [tolerance]
 			if(tokens.size() == 0)
 			{
-				printError(output, mylineno, "No submodel type specified.");
+				printError(output, lineno, "No target histogram specified.");
 			}
 			else
 			{
-				// store the name of the model type
-				model.name = molstat::to_lower(tokens.front());
+				calibrate_filename = tokens.front();
+				tokens.pop();
 
-				// set this to the parser's top model
-				ret.submodels.emplace_back( move(model) );
+				try
+				{
+					if(tokens.size() > 0)
+					{
+						const size_t n{ molstat::cast_string<size_t>(
+							tokens.front()) };
+						if(n == 0)
+							throw invalid_argument("The calibration requires " \
+								"at least one trial.");
+						calibrate_trials = n;
+						tokens.pop();
+					}
+					if(tokens.size() > 0)
+					{
+						calibrate_iterations = molstat::cast_string<size_t>(
+							tokens.front());
+						tokens.pop();
+					}
+					if(tokens.size() > 0)
+					{
+						const double tol{ molstat::cast_string<double>(
+							tokens.front()) };
+						if(!(tol > 0.))
+							throw invalid_argument("The calibration " \
+								"tolerance must be positive.");
+						calibrate_tolerance = tol;
+					}
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a number.");
+				}
+				catch(const invalid_argument &e)
+				{
+					printError(output, lineno, e.what());
+				}
 			}
 		}
-		else if(command == "distribution")
+		else if(command == "vary")
 		{
-			// make sure there are tokens, if so, push the tokens
+			// vary name initial [step]
 			if(tokens.size() < 2)
 			{
-				printError(output, lineno,
-					"No distribution name and/or type specified.");
+				printError(output, lineno, "A variable requires a name and a " \
+					"starting value.");
 			}
 			else
 			{
-				const string name{ tokens.front() };
+				CalibrationVariable var;
+				var.name = tokens.front()[0] == '$' ? tokens.front().substr(1) :
+					tokens.front();
 				tokens.pop();
 
-				// construct the random number distribution
 				try
 				{
-					shared_ptr<const molstat::RandomDistribution> dist
-						{ molstat::RandomDistributionFactory(move(tokens)) };
-					ret.dists.emplace(name, dist);
+					var.initial = molstat::cast_string<double>(tokens.front());
+					tokens.pop();
+
+					// by default, a tenth of the starting value
+					var.step = tokens.size() > 0 ?
+						molstat::cast_string<double>(tokens.front()) :
+						(var.initial != 0. ? 0.1 * abs(var.initial) : 0.1);
+
+					if(var.name.empty())
+						printError(output, lineno, "No variable name.");
+					else if(!(var.step != 0.) || !isfinite(var.step))
+						printError(output, lineno, "The step must be nonzero.");
+					else if(any_of(calibrate_variables.begin(),
+						calibrate_variables.end(),
+						[&var] (const CalibrationVariable &other) -> bool
+						{ return other.name == var.name; }))
+						printError(output, lineno, "The variable \"$" +
+							var.name + "\" is already defined.");
+					else
+						calibrate_variables.push_back(var);
 				}
-				catch(const invalid_argument &e)
+				catch(const bad_cast &e)
 				{
-					// indent the error message
-					printError(output, lineno,
-						molstat::find_replace(e.what(), "\n", "\n   "));
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a number.");
 				}
 			}
 		}
-		else
+		else if(command == "marginal")
 		{
-			printError(output, lineno,
-				"Unknown model command: \"" + command + "\".");
-		}
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno,
+					"No marginal histogram file name specified.");
+			}
+			else
+			{
+				MarginalOutput marginal;
+				marginal.filename = tokens.front();
+				marginal.format = molstat::HistogramFormat::Text;
+				tokens.pop();
 
-		// move to the next line
-		++lineno;
-	}
+				// optional: the output format (the dimensions are numbers)
+				bool have_format{ tokens.size() > 0 &&
+					molstat::to_lower(tokens.front()) != "given" };
+				if(have_format)
+				{
+					try
+					{
+						molstat::cast_string<size_t>(tokens.front());
+						have_format = false;
+					}
+					catch(const bad_cast &e)
+					{
+						// not a number, so it must be the format
+					}
+				}
+				if(have_format)
+				{
+					try
+					{
+						marginal.format =
+							molstat::HistogramFormatFromName(tokens.front());
+						if(marginal.format == molstat::HistogramFormat::Mergeable ||
+							marginal.format == molstat::HistogramFormat::HDF5)
+						{
+							printError(output, lineno, "Marginal histograms can " \
+								"only be written as text, gzip, or binary.");
+						}
+					}
+					catch(const invalid_argument &e)
+					{
+						// indent the error message
+						printError(output, lineno,
+							molstat::find_replace(e.what(), "\n", "\n   "));
+					}
+					tokens.pop();
+				}
 
-	// if we're here, we hit EOF before finding the appropriate endmodel command
-	throw runtime_error("Missing \"endmodel\" command.");
-}
+				// the dimensions to keep, then the slices of the others
+				bool ok{ true };
+				for(; tokens.size() > 0 &&
+					molstat::to_lower(tokens.front()) != "given"; tokens.pop())
+				{
+					try
+					{
+						marginal.spec.dimensions.push_back(
+							molstat::cast_string<size_t>(tokens.front()));
+					}
+					catch(const bad_cast &e)
+					{
+						printError(output, lineno, "Unable to convert \"" +
+							tokens.front() + "\" to a dimension.");
+						ok = false;
+					}
+				}
+				if(marginal.spec.dimensions.empty())
+				{
+					printError(output, lineno,
+						"No dimensions specified for the marginal histogram.");
+					ok = false;
+				}
 
-std::shared_ptr<molstat::SimulateModel> SimulatorInputParse::constructModel(
-	std::ostream &output,
-	const std::map<std::string,
-	               molstat::SimulateModelFactoryFunction> &models,
-	ModelInformation &info)
-{
-	// see if the name specified is valid
-	if(models.count(info.name) == 0)
-		throw runtime_error("Unknown model: \"" + info.name + "\".");
+				while(ok && tokens.size() > 0)
+				{
+					// given dimension lower upper
+					if(molstat::to_lower(tokens.front()) != "given")
+					{
+						printError(output, lineno, "Expected \"given\" instead " \
+							"of \"" + tokens.front() + "\".");
+						ok = false;
+						break;
+					}
+					tokens.pop();
+					if(tokens.size() < 3)
+					{
+						printError(output, lineno, "A slice requires a dimension " \
+							"and the lower and upper values.");
+						ok = false;
+						break;
+					}
 
-	molstat::SimulateModelFactory factory{ models.at(info.name)() };
+					try
+					{
+						molstat::HistogramSlice slice;
+						slice.dimension =
+							molstat::cast_string<size_t>(tokens.front());
+						tokens.pop();
+						slice.range[0] = molstat::cast_string<double>(tokens.front());
+						tokens.pop();
+						slice.range[1] = molstat::cast_string<double>(tokens.front());
+						tokens.pop();
+						marginal.spec.slices.push_back(slice);
+					}
+					catch(const bad_cast &e)
+					{
+						printError(output, lineno, "Unable to convert \"" +
+							tokens.front() + "\" to a number.");
+						ok = false;
+					}
+				}
 
-	// set the distributions, removing any distributions that aren't used
-	{
-		auto dist_iter = info.dists.cbegin();
-		while(dist_iter != info.dists.cend())
+				// the dimensions are checked against the histogram later
+				if(ok)
+					marginals.push_back(move(marginal));
+			}
+		}
+		else if(command == "histogram")
 		{
-			bool used;
-			factory.setDistribution(dist_iter->first, dist_iter->second, &used);
-			if(!used)
+			// the file name, then (optionally) the format, the observable, the
+			// number of bins, and the binning style
+			if(tokens.size() < 4)
 			{
-				// this distribution wasn't used... remove it from the list
-				auto here = dist_iter;
-				++dist_iter;
-				info.dists.erase(here);
+				printError(output, lineno, "No file name, observable, number " \
+					"of bins, and/or binning style specified.");
 			}
 			else
-				++dist_iter;
+			{
+				const string filename{ tokens.front() };
+				tokens.pop();
+
+				// optional: the output format (observables are not formats)
+				bool have_format{ true };
+				molstat::HistogramFormat hformat
+					{ molstat::HistogramFormat::Text };
+				try
+				{
+					hformat = molstat::HistogramFormatFromName(tokens.front());
+					tokens.pop();
+				}
+				catch(const invalid_argument &e)
+				{
+					have_format = false;
+				}
+
+				const string obsname{ molstat::to_lower(tokens.front()) };
+				tokens.pop();
+
+				try
+				{
+					vector<string> words{ ToWords(tokens) };
+					shared_ptr<molstat::BinStyle> binstyle
+						{ molstat::BinStyleFactory(move(tokens)) };
+					if(!binstyle->hasBounds())
+						throw invalid_argument("The additional histograms " \
+							"require fixed bounds.");
+
+					// each line adds a dimension to the histogram of its file
+					auto found = find_if(histograms.begin(), histograms.end(),
+						[&filename] (const HistogramOutput &h) -> bool
+						{
+							return h.filename == filename;
+						});
+					if(found == histograms.end())
+					{
+						HistogramOutput histogram;
+						histogram.filename = filename;
+						histogram.format = molstat::HistogramFormat::Text;
+						histograms.push_back(move(histogram));
+						found = histograms.end() - 1;
+					}
+
+					if(have_format)
+						found->format = hformat;
+					found->observables.push_back(obsname);
+					found->bstyles.push_back(binstyle);
+					found->bin_specs.push_back(move(words));
+				}
+				catch(const invalid_argument &e)
+				{
+					// indent the error message
+					printError(output, lineno,
+						molstat::find_replace(e.what(), "\n", "\n   "));
+				}
+			}
+		}
+		else if(command == "checkpoint")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No checkpoint file name specified.");
+			}
+			else
+			{
+				checkpointfilename = tokens.front();
+				tokens.pop();
+
+				// optional: the time between checkpoints, in seconds
+				if(tokens.size() > 0)
+				{
+					try
+					{
+						const double seconds
+							{ molstat::cast_string<double>(tokens.front()) };
+						if(!(seconds > 0.))
+							printError(output, lineno,
+								"The checkpoint interval must be positive.");
+						else
+							checkpoint_interval = seconds;
+					}
+					catch(const bad_cast &e)
+					{
+						printError(output, lineno, "Unable to convert \"" +
+							tokens.front() + "\" to a positive number.");
+					}
+				}
+			}
+		}
+		else if(command == "resume")
+		{
+			resume_run = true;
+		}
+		else if(command == "converge")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No convergence tolerance specified.");
+			}
+			else
+			{
+				try
+				{
+					const double tolerance
+						{ molstat::cast_string<double>(tokens.front()) };
+					if(!(tolerance > 0. && tolerance < 1.))
+						printError(output, lineno, "The convergence tolerance " \
+							"must be between 0 and 1.");
+					else
+						converge_tolerance = tolerance;
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a number.");
+				}
+				tokens.pop();
+
+				// optional: the number of trials between checks
+				if(tokens.size() > 0)
+				{
+					try
+					{
+						const size_t interval
+							{ molstat::cast_string<size_t>(tokens.front()) };
+						if(interval == 0)
+							printError(output, lineno,
+								"The convergence interval must be positive.");
+						else
+							converge_interval = interval;
+					}
+					catch(const bad_cast &e)
+					{
+						printError(output, lineno, "Unable to convert \"" +
+							tokens.front() + "\" to a positive number.");
+					}
+				}
+			}
+		}
+		else if(command == "progress")
+		{
+			// all optional: the fraction of the trials between partial
+			// histograms and their file
+			progress_fraction = 0.1;
+			if(tokens.size() > 0)
+			{
+				try
+				{
+					const double fraction
+						{ molstat::cast_string<double>(tokens.front()) };
+					if(!(fraction > 0. && fraction < 1.))
+						printError(output, lineno,
+							"The progress fraction must be between 0 and 1.");
+					else
+						progress_fraction = fraction;
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a number.");
+				}
+				tokens.pop();
+			}
+			if(tokens.size() > 0)
+				progress_filename = tokens.front();
+		}
+		else if(command == "pilot")
+		{
+			// all optional: the fraction of the trials in the pilot run, the
+			// margin around its data, and the largest fraction of the data
+			// outside the bounds before the bins are widened
+			pilot_fraction = 0.01;
+			const array<string, 3> names{{ "pilot fraction", "pilot margin",
+				"overflow fraction" }};
+			array<double *, 3> settings{{ &pilot_fraction, &pilot_margin,
+				&pilot_overflow }};
+			for(size_t k = 0; k < settings.size() && tokens.size() > 0;
+				++k, tokens.pop())
+			{
+				try
+				{
+					const double value
+						{ molstat::cast_string<double>(tokens.front()) };
+					if(!(value >= 0.) || (k != 1 && !(value > 0. && value < 1.)))
+						printError(output, lineno, "The " + names[k] + " must be " +
+							(k == 1 ? "non-negative." : "between 0 and 1."));
+					else
+						*settings[k] = value;
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a number.");
+				}
+			}
+		}
+		else if(command == "memory")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "Memory limit not specified.");
+			}
+			else
+			{
+				try
+				{
+					const double limit
+						{ molstat::cast_string<double>(tokens.front()) };
+					if(!(limit > 0.))
+						printError(output, lineno,
+							"The memory limit must be positive.");
+					else
+						memory_limit = limit;
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a number.");
+				}
+			}
+		}
+		else if(command == "trials")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "Number of trials not specified.");
+			}
+			else
+			{
+				try
+				{
+					trials = molstat::cast_string<size_t>(tokens.front());
+					if(trials == 0)
+						printError(output, lineno,
+							"More than 0 trials should be specified.");
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" + tokens.front() +
+						"\" to a non-negative number.");
+				}
+			}
+		}
+		else if(command == "threads")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "Number of threads not specified.");
+			}
+			else
+			{
+				try
+				{
+					const size_t n{ molstat::cast_string<size_t>(tokens.front()) };
+					if(n == 0)
+						printError(output, lineno,
+							"At least 1 thread must be specified.");
+					else
+						nthreads = n;
+					tokens.pop();
+
+					// optionally pin the threads to CPUs
+					pin_threads = false;
+					if(tokens.size() > 0)
+					{
+						if(molstat::to_lower(tokens.front()) == "pin")
+							pin_threads = true;
+						else
+							printError(output, lineno,
+								"Unknown threads option \"" + tokens.front() + "\".");
+					}
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" + tokens.front() +
+						"\" to a positive number.");
+				}
+			}
+		}
+		else if(command == "blocks")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "Number of blocks not specified.");
+			}
+			else
+			{
+				try
+				{
+					const size_t n{ molstat::cast_string<size_t>(tokens.front()) };
+					if(n == 0)
+						printError(output, lineno,
+							"At least 1 block must be specified.");
+					else
+						nblocks = n;
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a positive number.");
+				}
+			}
+		}
+		else if(command == "pipeline")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "Number of binning threads not " \
+					"specified.");
+			}
+			else
+			{
+				try
+				{
+					pipeline_binners =
+						molstat::cast_string<size_t>(tokens.front());
+					tokens.pop();
+
+					// optionally the number of batches waiting per thread
+					if(tokens.size() > 0)
+					{
+						const size_t depth{
+							molstat::cast_string<size_t>(tokens.front()) };
+						if(depth == 0)
+							printError(output, lineno,
+								"The pipeline depth must be positive.");
+						else
+							pipeline_depth = depth;
+					}
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a non-negative number.");
+				}
+			}
+		}
+		else if(command == "rng")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No random number engine specified.");
+			}
+			else
+			{
+				try
+				{
+					engine_kind = molstat::EngineKindFromName(tokens.front());
+				}
+				catch(const invalid_argument &e)
+				{
+					// indent the error message
+					printError(output, lineno,
+						molstat::find_replace(e.what(), "\n", "\n   "));
+				}
+			}
+		}
+		else if(command == "device")
+		{
+			if(tokens.size() == 0)
+				printError(output, lineno, "No device specified.");
+			else if(tokens.front() == "gpu")
+				use_gpu = true;
+			else if(tokens.front() == "cpu")
+				use_gpu = false;
+			else
+				printError(output, lineno, "Unknown device \"" + tokens.front() +
+					"\". Use \"cpu\" or \"gpu\".");
+		}
+		else if(command == "analytic")
+		{
+			analytic = true;
+		}
+		else if(command == "report")
+		{
+			if(tokens.size() == 0)
+				printError(output, lineno, "No report style specified.");
+			else if(tokens.front() == "json")
+				json_report = true;
+			else if(tokens.front() == "text")
+				json_report = false;
+			else
+				printError(output, lineno, "Unknown report style \"" +
+					tokens.front() + "\". Use \"text\" or \"json\".");
+		}
+		else if(command == "seed" || command == "stream")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No " + command + " specified.");
+			}
+			else
+			{
+				try
+				{
+					const size_t n{ molstat::cast_string<size_t>(tokens.front()) };
+					if(command == "seed")
+					{
+						rng_seed = n;
+						seed_specified = true;
+					}
+					else
+						rng_stream = n;
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" + tokens.front() +
+						"\" to a non-negative number.");
+				}
+			}
+		}
+		else if(command == "sampling")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No sampling method specified.");
+			}
+			else
+			{
+				const string method{ molstat::to_lower(tokens.front()) };
+				tokens.pop();
+
+				if(method == "pool" && tokens.size() > 0)
+				{
+					if(molstat::to_lower(tokens.front()) == "incremental")
+						incremental = true;
+					else
+						printError(output, lineno, "Unknown pool option: \"" +
+							tokens.front() + "\".");
+				}
+				else
+					incremental = false;
+
+				if(method == "sobol")
+					sampling = SamplingMethod::Sobol;
+				else if(method == "lhs" || method == "latin")
+					sampling = SamplingMethod::LatinHypercube;
+				else if(method == "pool")
+					sampling = SamplingMethod::Pool;
+				else if(method == "random")
+					sampling = SamplingMethod::Random;
+				else
+					printError(output, lineno,
+						"Unknown sampling method: \"" + method + "\".");
+			}
+		}
+		else if(command == "quadrature")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No quadrature specified.");
+			}
+			else
+			{
+				const string type{ molstat::to_lower(tokens.front()) };
+				tokens.pop();
+
+				try
+				{
+					if(type == "adaptive")
+					{
+						double tol{ 1.e-9 };
+						if(tokens.size() > 0)
+							tol = molstat::cast_string<double>(tokens.front());
+
+						if(!(tol > 0.))
+							printError(output, lineno,
+								"The quadrature tolerance must be positive.");
+						else
+						{
+							quadrature_order = 0;
+							quadrature_tolerance = tol;
+						}
+					}
+					else if(type == "gausslegendre")
+					{
+						if(tokens.size() == 0)
+							printError(output, lineno,
+								"Number of quadrature points not specified.");
+						else
+						{
+							const size_t n
+								{ molstat::cast_string<size_t>(tokens.front()) };
+							if(n == 0)
+								printError(output, lineno,
+									"At least 1 quadrature point must be specified.");
+							else
+								quadrature_order = n;
+						}
+					}
+					else
+					{
+						printError(output, lineno,
+							"Unknown quadrature: \"" + type + "\".");
+					}
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a number.");
+				}
+			}
+		}
+		else if(command == "precision")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No precision specified.");
+			}
+			else
+			{
+				try
+				{
+					if(molstat::lower_equals(tokens.front(), "bins"))
+					{
+						tokens.pop();
+
+						double fraction{ 0.001 };
+						if(tokens.size() > 0)
+							fraction =
+								molstat::cast_string<double>(tokens.front());
+
+						if(!(fraction > 0.))
+							printError(output, lineno,
+								"The fraction of a bin must be positive.");
+						else
+						{
+							precision = 0.;
+							precision_fraction = fraction;
+						}
+					}
+					else
+					{
+						const double value
+							{ molstat::cast_string<double>(tokens.front()) };
+
+						if(!(value > 0.))
+							printError(output, lineno,
+								"The precision must be positive.");
+						else
+						{
+							precision = value;
+							precision_fraction = 0.;
+						}
+					}
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a number.");
+				}
+			}
+		}
+		else if(command == "profile")
+		{
+			if(tokens.size() == 0)
+				profile_interval = 10;
+			else
+			{
+				try
+				{
+					const size_t n{ molstat::cast_string<size_t>(tokens.front()) };
+					if(n == 0)
+						printError(output, lineno,
+							"The profiling interval must be positive.");
+					else
+						profile_interval = n;
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" + tokens.front() +
+						"\" to a positive number.");
+				}
+			}
+		}
+		else if(command == "compile")
+		{
+			if(tokens.size() == 0)
+				printError(output, lineno, "No file name specified.");
+			else
+				compilefilename = tokens.front();
+		}
+		else if(command == "load")
+		{
+			if(tokens.size() == 0)
+				printError(output, lineno, "No file name specified.");
+			else
+			{
+				try
+				{
+					readCompiled(tokens.front());
+				}
+				catch(const runtime_error &e)
+				{
+					// indent the error message
+					printError(output, lineno,
+						molstat::find_replace(e.what(), "\n", "\n   "));
+				}
+			}
+		}
+		else
+		{
+			printError(output, lineno, "Unknown command: \"" + command + "\".");
+		}
+
+		// move to the next line
+		++lineno;
+	}
+
+	// without a specified seed, use a non-deterministic one (it is reported
+	// by printState, so that the run can be reproduced)
+	if(!seed_specified)
+	{
+		random_device rd;
+		rng_seed = (molstat::Engine::result_type(rd()) << 32) ^ rd();
+	}
+}
+
+SimulatorInputParse::ModelInformation SimulatorInputParse::readModel(
+	std::istream &input, std::ostream &output, std::size_t &lineno)
+{
+	ModelInformation ret;
+
+	while(input)
+	{
+		string line;
+		getline(input, line);
+
+		// tokenize the string
+		molstat::TokenContainer tokens = molstat::tokenize(line);
+		if(tokens.size() == 0) // empty line
+		{
+			++lineno;
+			continue;
+		}
+
+		// the first token is the command name, pop it off and then process the
+		// rest of the tokens
+		string command { molstat::to_lower(tokens.front()) };
+		tokens.pop();
+
+		// go through the supported commands
+		if(command == "endmodel")
+		{
+			// we're done here
+			return ret;
+		}
+		else if(command == "model")
+		{
+			// the total lineno needs to be passed to the (sub)model reader
+			const size_t mylineno{ lineno };
+
+			// enter the (sub)model reader to process input lines until the
+			// appropriate "endmodel" command is found
+			ModelInformation model = readModel(input, output, ++lineno);
+
+			// make sure there is a name (model type) specified
+			if(tokens.size() == 0)
+			{
+				printError(output, mylineno, "No submodel type specified.");
+			}
+			else
+			{
+				// store the name of the model type
+				model.name = molstat::to_lower(tokens.front());
+
+				// set this to the parser's top model
+				ret.submodels.emplace_back( move(model) );
+			}
+		}
+		else if(command == "tabulate")
+		{
+			if(tokens.size() < 2)
+			{
+				printError(output, lineno,
+					"No observable and/or number of points specified.");
+			}
+			else
+			{
+				const string name{ molstat::to_lower(tokens.front()) };
+				tokens.pop();
+
+				try
+				{
+					const size_t n{ molstat::cast_string<size_t>(tokens.front()) };
+					if(n < 2)
+						printError(output, lineno,
+							"At least 2 points must be specified.");
+					else
+						ret.tables[name] = n;
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" +
+						tokens.front() + "\" to a positive number.");
+				}
+			}
+		}
+		else if(command == "proposal")
+		{
+			if(tokens.size() < 2)
+			{
+				printError(output, lineno,
+					"No parameter name and/or distribution type specified.");
+			}
+			else
+			{
+				const string name{ tokens.front() };
+				tokens.pop();
+
+				try
+				{
+					vector<string> words{ ToWords(tokens) };
+					ret.proposals[name] =
+						molstat::RandomDistributionFactory(move(tokens));
+					ret.proposal_specs[name] = move(words);
+				}
+				catch(const invalid_argument &e)
+				{
+					// indent the error message
+					printError(output, lineno,
+						molstat::find_replace(e.what(), "\n", "\n   "));
+				}
+			}
+		}
+		else if(command == "distribution")
+		{
+			// make sure there are tokens, if so, push the tokens
+			if(tokens.size() < 2)
+			{
+				printError(output, lineno,
+					"No distribution name and/or type specified.");
+			}
+			else
+			{
+				const string name{ tokens.front() };
+				tokens.pop();
+
+				// distributions with the sweep variable ($name) are constructed
+				// once its values are known (joint distributions cannot use it)
+				vector<string> words{ ToWords(tokens) };
+				if(name.find(',') == string::npos &&
+					any_of(words.begin(), words.end(),
+					[] (const string &word) -> bool { return word[0] == '$'; }))
+				{
+					if(ret.dists.count(name) == 0)
+						ret.swept.emplace(name, move(words));
+				}
+				else if(name.find(',') != string::npos)
+				{
+					// a joint distribution for several parameters (separated by
+					// commas); each parameter gets one component
+					const vector<string> names{ SplitNames(name) };
+
+					set<string> unique;
+					for(const string &n : names)
+						unique.insert(molstat::to_lower(n));
+					if(unique.size() != names.size() || unique.count("") > 0)
+					{
+						printError(output, lineno, "Invalid list of parameter " \
+							"names for a joint distribution.");
+					}
+					else
+					{
+						try
+						{
+							const auto components = molstat::JointDistributionFactory(
+								names.size(), move(tokens));
+							for(size_t j = 0; j < names.size(); ++j)
+							{
+								if(ret.swept.count(names[j]) == 0)
+									ret.dists.emplace(names[j], components[j]);
+							}
+							ret.dist_specs.emplace_back(name, move(words));
+						}
+						catch(const invalid_argument &e)
+						{
+							// indent the error message
+							printError(output, lineno,
+								molstat::find_replace(e.what(), "\n", "\n   "));
+						}
+					}
+				}
+				else if(ret.swept.count(name) == 0)
+				{
+					// construct the random number distribution
+					try
+					{
+						shared_ptr<const molstat::RandomDistribution> dist
+							{ molstat::RandomDistributionFactory(move(tokens)) };
+						ret.dists.emplace(name, dist);
+						ret.dist_specs.emplace_back(name, move(words));
+					}
+					catch(const invalid_argument &e)
+					{
+						// indent the error message
+						printError(output, lineno,
+							molstat::find_replace(e.what(), "\n", "\n   "));
+					}
+				}
+			}
+		}
+		else
+		{
+			printError(output, lineno,
+				"Unknown model command: \"" + command + "\".");
+		}
+
+		// move to the next line
+		++lineno;
+	}
+
+	// if we're here, we hit EOF before finding the appropriate endmodel command
+	throw runtime_error("Missing \"endmodel\" command.");
+}
+
+std::shared_ptr<molstat::TraceProtocol> SimulatorInputParse::readTrace(
+	std::istream &input, std::ostream &output, std::size_t &lineno,
+	TraceInformation &info)
+{
+	// the protocol needs the displacements before anything else, so store
+	// the other commands until the end
+	info = TraceInformation();
+	bool have_displacement{ false };
+
+	while(input)
+	{
+		string line;
+		getline(input, line);
+
+		// tokenize the string
+		molstat::TokenContainer tokens = molstat::tokenize(line);
+		if(tokens.size() == 0) // empty line
+		{
+			++lineno;
+			continue;
+		}
+
+		// the first token is the command name, pop it off and then process the
+		// rest of the tokens
+		string command { molstat::to_lower(tokens.front()) };
+		tokens.pop();
+
+		try
+		{
+			// go through the supported commands
+			if(command == "endtrace")
+			{
+				// we're done here
+				if(info.npoints == 0)
+				{
+					printError(output, lineno,
+						"The number of points in each trace was not specified.");
+					return nullptr;
+				}
+				if(!have_displacement)
+				{
+					printError(output, lineno,
+						"The range of displacements was not specified.");
+					return nullptr;
+				}
+
+				return makeTrace(info);
+			}
+			else if(command == "points")
+			{
+				if(tokens.size() == 0)
+					throw invalid_argument("Number of points not specified.");
+
+				info.npoints = molstat::cast_string<size_t>(tokens.front());
+				if(info.npoints == 0)
+					throw invalid_argument("At least 1 point must be specified.");
+			}
+			else if(command == "displacement")
+			{
+				if(tokens.size() < 2)
+					throw invalid_argument("Initial and final displacements not " \
+						"specified.");
+
+				info.zmin = molstat::cast_string<double>(tokens.front());
+				tokens.pop();
+				info.zmax = molstat::cast_string<double>(tokens.front());
+				if(!(info.zmax >= info.zmin))
+					throw invalid_argument("The final displacement must not be " \
+						"less than the initial displacement.");
+				have_displacement = true;
+			}
+			else if(command == "length")
+			{
+				if(tokens.size() == 0)
+					throw invalid_argument("No distribution specified.");
+
+				// construct the distribution to check it
+				vector<string> words{ ToWords(tokens) };
+				molstat::RandomDistributionFactory(move(tokens));
+				info.length = move(words);
+			}
+			else if(command == "shift")
+			{
+				if(tokens.size() < 2)
+					throw invalid_argument("No parameter name and/or shift type " \
+						"specified.");
+
+				const string name{ tokens.front() };
+				tokens.pop();
+				const string type{ molstat::to_lower(tokens.front()) };
+				tokens.pop();
+
+				// both shift types take two numbers
+				if(tokens.size() < 2)
+					throw invalid_argument("Two numbers are needed for the \"" +
+						type + "\" shift.");
+				const double a{ molstat::cast_string<double>(tokens.front()) };
+				tokens.pop();
+				const double b{ molstat::cast_string<double>(tokens.front()) };
+
+				if(type == "linear" || type == "imagecharge")
+					info.shifts.push_back({ name, type, a, b });
+				else
+					throw invalid_argument("Unknown shift type: \"" + type +
+						"\".\nPossible options are:\n" \
+						"   linear a b - Shift by a + b*z.\n" \
+						"   imagecharge d0 zip - Image-charge shift for an " \
+						"initial electrode\n      separation d0 and image-plane " \
+						"distance zip.");
+			}
+			else if(command == "rupture")
+			{
+				if(tokens.size() < 2)
+					throw invalid_argument("No parameter name and/or value " \
+						"specified.");
+
+				const string name{ tokens.front() };
+				tokens.pop();
+				info.ruptured.emplace_back(name,
+					molstat::cast_string<double>(tokens.front()));
+			}
+			else
+			{
+				printError(output, lineno,
+					"Unknown trace command: \"" + command + "\".");
+			}
+		}
+		catch(const bad_cast &e)
+		{
+			printError(output, lineno, "Unable to convert a value to a number.");
+		}
+		catch(const invalid_argument &e)
+		{
+			// indent the error message
+			printError(output, lineno,
+				molstat::find_replace(e.what(), "\n", "\n   "));
+		}
+
+		// move to the next line
+		++lineno;
+	}
+
+	// if we're here, we hit EOF before finding the appropriate endtrace command
+	throw runtime_error("Missing \"endtrace\" command.");
+}
+
+std::shared_ptr<molstat::TraceProtocol> SimulatorInputParse::makeTrace(
+	const TraceInformation &info)
+{
+	shared_ptr<molstat::TraceProtocol> ret{ make_shared<molstat::TraceProtocol>(
+		info.npoints, info.zmin, info.zmax) };
+
+	if(!info.length.empty())
+		ret->setLength(molstat::RandomDistributionFactory(
+			ToTokens(info.length)));
+
+	for(const TraceInformation::Shift &shift : info.shifts)
+	{
+		if(shift.type == "linear")
+			ret->addShift(shift.name,
+				molstat::TraceProtocol::LinearShift(shift.a, shift.b));
+		else
+			ret->addShift(shift.name,
+				molstat::TraceProtocol::ImageChargeShift(shift.a, shift.b));
+	}
+
+	for(const auto &rupture : info.ruptured)
+		ret->setRuptured(rupture.first, rupture.second);
+
+	return ret;
+}
+
+void SimulatorInputParse::writeModelInformation(std::ostream &out,
+	const ModelInformation &info)
+{
+	WriteBinaryString(out, info.name);
+
+	WriteBinaryUInt(out, info.dist_specs.size());
+	for(const auto &spec : info.dist_specs)
+	{
+		WriteBinaryString(out, spec.first);
+		write_words(out, spec.second);
+	}
+
+	WriteBinaryUInt(out, info.swept.size());
+	for(const auto &spec : info.swept)
+	{
+		WriteBinaryString(out, spec.first);
+		write_words(out, spec.second);
+	}
+
+	WriteBinaryUInt(out, info.proposal_specs.size());
+	for(const auto &spec : info.proposal_specs)
+	{
+		WriteBinaryString(out, spec.first);
+		write_words(out, spec.second);
+	}
+
+	WriteBinaryUInt(out, info.tables.size());
+	for(const auto &table : info.tables)
+	{
+		WriteBinaryString(out, table.first);
+		WriteBinaryUInt(out, table.second);
+	}
+
+	WriteBinaryUInt(out, info.submodels.size());
+	for(const ModelInformation &submodel : info.submodels)
+		writeModelInformation(out, submodel);
+}
+
+SimulatorInputParse::ModelInformation
+	SimulatorInputParse::readModelInformation(std::istream &in)
+{
+	ModelInformation ret;
+	ret.name = ReadBinaryString(in, compiled_source);
+
+	ret.dist_specs.resize(ReadBinaryUInt(in, compiled_source));
+	for(auto &spec : ret.dist_specs)
+	{
+		spec.first = ReadBinaryString(in, compiled_source);
+		spec.second = read_words(in);
+	}
+
+	for(std::uint64_t n = ReadBinaryUInt(in, compiled_source); n > 0; --n)
+	{
+		const string name{ ReadBinaryString(in, compiled_source) };
+		ret.swept[name] = read_words(in);
+	}
+
+	for(std::uint64_t n = ReadBinaryUInt(in, compiled_source); n > 0; --n)
+	{
+		const string name{ ReadBinaryString(in, compiled_source) };
+		ret.proposal_specs[name] = read_words(in);
+	}
+
+	for(std::uint64_t n = ReadBinaryUInt(in, compiled_source); n > 0; --n)
+	{
+		const string name{ ReadBinaryString(in, compiled_source) };
+		ret.tables[name] = ReadBinaryUInt(in, compiled_source);
+	}
+
+	for(std::uint64_t n = ReadBinaryUInt(in, compiled_source); n > 0; --n)
+		ret.submodels.emplace_back(readModelInformation(in));
+
+	// construct the distributions as readModel did
+	try
+	{
+		for(const auto &spec : ret.dist_specs)
+		{
+			if(spec.first.find(',') != string::npos)
+			{
+				const vector<string> names{ SplitNames(spec.first) };
+				const auto components = molstat::JointDistributionFactory(
+					names.size(), ToTokens(spec.second));
+				for(size_t j = 0; j < names.size(); ++j)
+				{
+					if(ret.swept.count(names[j]) == 0)
+						ret.dists.emplace(names[j], components[j]);
+				}
+			}
+			else if(ret.swept.count(spec.first) == 0)
+			{
+				ret.dists.emplace(spec.first,
+					molstat::RandomDistributionFactory(ToTokens(spec.second)));
+			}
+		}
+
+		for(const auto &spec : ret.proposal_specs)
+			ret.proposals[spec.first] =
+				molstat::RandomDistributionFactory(ToTokens(spec.second));
+	}
+	catch(const invalid_argument &e)
+	{
+		throw runtime_error("Invalid distribution in model " + ret.name +
+			":\n" + e.what());
+	}
+
+	return ret;
+}
+
+void SimulatorInputParse::writeCompiled(const std::string &filename) const
+{
+	ofstream out(filename, ios_base::out | ios_base::binary);
+	if(!out)
+		throw runtime_error("Unable to open \"" + filename + "\" for output.");
+
+	out.write(compiled_magic, sizeof(compiled_magic));
+	WriteBinaryUInt(out, compiled_version);
+
+	writeModelInformation(out, top_model);
+
+	WriteBinaryString(out, sweep_name);
+	write_words(out, sweep_values);
+
+	WriteBinaryString(out, calibrate_filename);
+	WriteBinaryUInt(out, calibrate_trials);
+	WriteBinaryUInt(out, calibrate_iterations);
+	WriteBinaryDouble(out, calibrate_tolerance);
+	WriteBinaryUInt(out, calibrate_variables.size());
+	for(const CalibrationVariable &var : calibrate_variables)
+	{
+		WriteBinaryString(out, var.name);
+		WriteBinaryDouble(out, var.initial);
+		WriteBinaryDouble(out, var.step);
+	}
+
+	WriteBinaryUInt(out, obs_bins.size());
+	for(const auto &obs_bin : obs_bins)
+	{
+		WriteBinaryUInt(out, obs_bin.first);
+		WriteBinaryString(out, obs_bin.second.first);
+		write_words(out, bin_specs.at(obs_bin.first));
+	}
+
+	WriteBinaryString(out, histfilename);
+	WriteBinaryUInt(out, static_cast<std::uint64_t>(histformat));
+	WriteBinaryString(out, samplefilename);
+	WriteBinaryUInt(out, sample_params);
+	WriteBinaryString(out, densityfilename);
+	WriteBinaryUInt(out, static_cast<std::uint64_t>(densityformat));
+	WriteBinaryUInt(out, density_bandwidths.size());
+	for(const double h : density_bandwidths)
+		WriteBinaryDouble(out, h);
+
+	WriteBinaryUInt(out, marginals.size());
+	for(const MarginalOutput &marginal : marginals)
+	{
+		WriteBinaryString(out, marginal.filename);
+		WriteBinaryUInt(out, static_cast<std::uint64_t>(marginal.format));
+		WriteBinaryUInt(out, marginal.spec.dimensions.size());
+		for(const size_t dim : marginal.spec.dimensions)
+			WriteBinaryUInt(out, dim);
+		WriteBinaryUInt(out, marginal.spec.slices.size());
+		for(const molstat::HistogramSlice &slice : marginal.spec.slices)
+		{
+			WriteBinaryUInt(out, slice.dimension);
+			WriteBinaryDouble(out, slice.range[0]);
+			WriteBinaryDouble(out, slice.range[1]);
+		}
+	}
+
+	WriteBinaryUInt(out, histograms.size());
+	for(const HistogramOutput &histogram : histograms)
+	{
+		WriteBinaryString(out, histogram.filename);
+		WriteBinaryUInt(out, static_cast<std::uint64_t>(histogram.format));
+		WriteBinaryUInt(out, histogram.observables.size());
+		for(size_t j = 0; j < histogram.observables.size(); ++j)
+		{
+			WriteBinaryString(out, histogram.observables[j]);
+			write_words(out, histogram.bin_specs[j]);
+		}
+	}
+
+	WriteBinaryString(out, checkpointfilename);
+	WriteBinaryDouble(out, checkpoint_interval);
+	WriteBinaryUInt(out, resume_run);
+	WriteBinaryDouble(out, converge_tolerance);
+	WriteBinaryUInt(out, converge_interval);
+	WriteBinaryDouble(out, progress_fraction);
+	WriteBinaryString(out, progress_filename);
+	WriteBinaryDouble(out, pilot_fraction);
+	WriteBinaryDouble(out, pilot_margin);
+	WriteBinaryDouble(out, pilot_overflow);
+	WriteBinaryDouble(out, memory_limit);
+	WriteBinaryUInt(out, trials);
+	WriteBinaryUInt(out, nthreads);
+	WriteBinaryUInt(out, pin_threads);
+	WriteBinaryUInt(out, pipeline_binners);
+	WriteBinaryUInt(out, pipeline_depth);
+	WriteBinaryUInt(out, nblocks);
+	WriteBinaryUInt(out, static_cast<std::uint64_t>(engine_kind));
+	WriteBinaryUInt(out, use_gpu);
+	WriteBinaryUInt(out, analytic);
+	WriteBinaryUInt(out, static_cast<std::uint64_t>(sampling));
+	WriteBinaryUInt(out, incremental);
+	WriteBinaryUInt(out, seed_specified);
+	WriteBinaryUInt(out, rng_seed);
+	WriteBinaryUInt(out, rng_stream);
+	WriteBinaryUInt(out, quadrature_order);
+	WriteBinaryDouble(out, quadrature_tolerance);
+	WriteBinaryDouble(out, precision);
+	WriteBinaryDouble(out, precision_fraction);
+	WriteBinaryUInt(out, profile_interval);
+	WriteBinaryUInt(out, json_report);
+
+	WriteBinaryUInt(out, trace != nullptr);
+	if(trace != nullptr)
+	{
+		WriteBinaryUInt(out, trace_info.npoints);
+		WriteBinaryDouble(out, trace_info.zmin);
+		WriteBinaryDouble(out, trace_info.zmax);
+		write_words(out, trace_info.length);
+		WriteBinaryUInt(out, trace_info.shifts.size());
+		for(const TraceInformation::Shift &shift : trace_info.shifts)
+		{
+			WriteBinaryString(out, shift.name);
+			WriteBinaryString(out, shift.type);
+			WriteBinaryDouble(out, shift.a);
+			WriteBinaryDouble(out, shift.b);
+		}
+		WriteBinaryUInt(out, trace_info.ruptured.size());
+		for(const auto &rupture : trace_info.ruptured)
+		{
+			WriteBinaryString(out, rupture.first);
+			WriteBinaryDouble(out, rupture.second);
+		}
+	}
+
+	out.close();
+	if(!out)
+		throw runtime_error("Unable to write \"" + filename + "\".");
+}
+
+void SimulatorInputParse::readCompiled(const std::string &filename)
+{
+	ifstream in(filename, ios_base::in | ios_base::binary);
+	if(!in)
+		throw runtime_error("Unable to open \"" + filename + "\".");
+
+	char magic[sizeof(compiled_magic)];
+	in.read(magic, sizeof(magic));
+	if(static_cast<size_t>(in.gcount()) != sizeof(magic) ||
+		!equal(magic, magic + sizeof(magic), compiled_magic))
+	{
+		throw runtime_error("\"" + filename + "\" is not a compiled " \
+			"configuration.");
+	}
+	if(ReadBinaryUInt(in, compiled_source) != compiled_version)
+		throw runtime_error("\"" + filename + "\" was compiled by a " \
+			"different version of MolStat.");
+
+	// the new state replaces the current one (except the compile command)
+	// once it is complete
+	SimulatorInputParse loaded;
+	loaded.compilefilename = compilefilename;
+
+	loaded.top_model = readModelInformation(in);
+
+	loaded.sweep_name = ReadBinaryString(in, compiled_source);
+	loaded.sweep_values = read_words(in);
+
+	loaded.calibrate_filename = ReadBinaryString(in, compiled_source);
+	loaded.calibrate_trials = ReadBinaryUInt(in, compiled_source);
+	loaded.calibrate_iterations = ReadBinaryUInt(in, compiled_source);
+	loaded.calibrate_tolerance = ReadBinaryDouble(in, compiled_source);
+	loaded.calibrate_variables.resize(ReadBinaryUInt(in, compiled_source));
+	for(CalibrationVariable &var : loaded.calibrate_variables)
+	{
+		var.name = ReadBinaryString(in, compiled_source);
+		var.initial = ReadBinaryDouble(in, compiled_source);
+		var.step = ReadBinaryDouble(in, compiled_source);
+	}
+
+	for(std::uint64_t n = ReadBinaryUInt(in, compiled_source); n > 0; --n)
+	{
+		const size_t axis{ ReadBinaryUInt(in, compiled_source) };
+		const string name{ ReadBinaryString(in, compiled_source) };
+		vector<string> words{ read_words(in) };
+
+		try
+		{
+			loaded.obs_bins.emplace(axis, make_pair(name,
+				shared_ptr<molstat::BinStyle>(
+					molstat::BinStyleFactory(ToTokens(words)))));
+		}
+		catch(const invalid_argument &e)
+		{
+			throw runtime_error("Invalid binning style for " + name + ":\n" +
+				e.what());
+		}
+		loaded.bin_specs.emplace(axis, move(words));
+	}
+
+	loaded.histfilename = ReadBinaryString(in, compiled_source);
+	loaded.histformat = static_cast<molstat::HistogramFormat>(
+		ReadBinaryUInt(in, compiled_source));
+	loaded.samplefilename = ReadBinaryString(in, compiled_source);
+	loaded.sample_params = ReadBinaryUInt(in, compiled_source) != 0;
+	loaded.densityfilename = ReadBinaryString(in, compiled_source);
+	loaded.densityformat = static_cast<molstat::HistogramFormat>(
+		ReadBinaryUInt(in, compiled_source));
+	loaded.density_bandwidths.resize(ReadBinaryUInt(in, compiled_source));
+	for(double &h : loaded.density_bandwidths)
+		h = ReadBinaryDouble(in, compiled_source);
+
+	loaded.marginals.resize(ReadBinaryUInt(in, compiled_source));
+	for(MarginalOutput &marginal : loaded.marginals)
+	{
+		marginal.filename = ReadBinaryString(in, compiled_source);
+		marginal.format = static_cast<molstat::HistogramFormat>(
+			ReadBinaryUInt(in, compiled_source));
+		marginal.spec.dimensions.resize(ReadBinaryUInt(in, compiled_source));
+		for(size_t &dim : marginal.spec.dimensions)
+			dim = ReadBinaryUInt(in, compiled_source);
+		marginal.spec.slices.resize(ReadBinaryUInt(in, compiled_source));
+		for(molstat::HistogramSlice &slice : marginal.spec.slices)
+		{
+			slice.dimension = ReadBinaryUInt(in, compiled_source);
+			slice.range[0] = ReadBinaryDouble(in, compiled_source);
+			slice.range[1] = ReadBinaryDouble(in, compiled_source);
+		}
+	}
+
+	loaded.histograms.resize(ReadBinaryUInt(in, compiled_source));
+	for(HistogramOutput &histogram : loaded.histograms)
+	{
+		histogram.filename = ReadBinaryString(in, compiled_source);
+		histogram.format = static_cast<molstat::HistogramFormat>(
+			ReadBinaryUInt(in, compiled_source));
+		const size_t ndim{ ReadBinaryUInt(in, compiled_source) };
+		for(size_t j = 0; j < ndim; ++j)
+		{
+			histogram.observables.push_back(
+				ReadBinaryString(in, compiled_source));
+			vector<string> words{ read_words(in) };
+
+			try
+			{
+				histogram.bstyles.emplace_back(
+					molstat::BinStyleFactory(ToTokens(words)));
+			}
+			catch(const invalid_argument &e)
+			{
+				throw runtime_error("Invalid binning style for " +
+					histogram.observables.back() + " in " + histogram.filename +
+					":\n" + e.what());
+			}
+			histogram.bin_specs.push_back(move(words));
+		}
+	}
+
+	loaded.checkpointfilename = ReadBinaryString(in, compiled_source);
+	loaded.checkpoint_interval = ReadBinaryDouble(in, compiled_source);
+	loaded.resume_run = ReadBinaryUInt(in, compiled_source) != 0;
+	loaded.converge_tolerance = ReadBinaryDouble(in, compiled_source);
+	loaded.converge_interval = ReadBinaryUInt(in, compiled_source);
+	loaded.progress_fraction = ReadBinaryDouble(in, compiled_source);
+	loaded.progress_filename = ReadBinaryString(in, compiled_source);
+	loaded.pilot_fraction = ReadBinaryDouble(in, compiled_source);
+	loaded.pilot_margin = ReadBinaryDouble(in, compiled_source);
+	loaded.pilot_overflow = ReadBinaryDouble(in, compiled_source);
+	loaded.memory_limit = ReadBinaryDouble(in, compiled_source);
+	loaded.trials = ReadBinaryUInt(in, compiled_source);
+	loaded.nthreads = ReadBinaryUInt(in, compiled_source);
+	loaded.pin_threads = ReadBinaryUInt(in, compiled_source) != 0;
+	loaded.pipeline_binners = ReadBinaryUInt(in, compiled_source);
+	loaded.pipeline_depth = ReadBinaryUInt(in, compiled_source);
+	loaded.nblocks = ReadBinaryUInt(in, compiled_source);
+	loaded.engine_kind = static_cast<molstat::EngineKind>(
+		ReadBinaryUInt(in, compiled_source));
+	loaded.use_gpu = ReadBinaryUInt(in, compiled_source) != 0;
+	loaded.analytic = ReadBinaryUInt(in, compiled_source) != 0;
+	loaded.sampling = static_cast<SamplingMethod>(
+		ReadBinaryUInt(in, compiled_source));
+	loaded.incremental = ReadBinaryUInt(in, compiled_source) != 0;
+	loaded.seed_specified = ReadBinaryUInt(in, compiled_source) != 0;
+	loaded.rng_seed = ReadBinaryUInt(in, compiled_source);
+	loaded.rng_stream = ReadBinaryUInt(in, compiled_source);
+	loaded.quadrature_order = ReadBinaryUInt(in, compiled_source);
+	loaded.quadrature_tolerance = ReadBinaryDouble(in, compiled_source);
+	loaded.precision = ReadBinaryDouble(in, compiled_source);
+	loaded.precision_fraction = ReadBinaryDouble(in, compiled_source);
+	loaded.profile_interval = ReadBinaryUInt(in, compiled_source);
+	loaded.json_report = ReadBinaryUInt(in, compiled_source) != 0;
+
+	if(ReadBinaryUInt(in, compiled_source) != 0)
+	{
+		TraceInformation &info = loaded.trace_info;
+		info.npoints = ReadBinaryUInt(in, compiled_source);
+		info.zmin = ReadBinaryDouble(in, compiled_source);
+		info.zmax = ReadBinaryDouble(in, compiled_source);
+		info.length = read_words(in);
+		info.shifts.resize(ReadBinaryUInt(in, compiled_source));
+		for(TraceInformation::Shift &shift : info.shifts)
+		{
+			shift.name = ReadBinaryString(in, compiled_source);
+			shift.type = ReadBinaryString(in, compiled_source);
+			shift.a = ReadBinaryDouble(in, compiled_source);
+			shift.b = ReadBinaryDouble(in, compiled_source);
+		}
+		info.ruptured.resize(ReadBinaryUInt(in, compiled_source));
+		for(auto &rupture : info.ruptured)
+		{
+			rupture.first = ReadBinaryString(in, compiled_source);
+			rupture.second = ReadBinaryDouble(in, compiled_source);
+		}
+
+		try
+		{
+			loaded.trace = makeTrace(info);
+		}
+		catch(const invalid_argument &e)
+		{
+			throw runtime_error(string("Invalid trace protocol:\n") + e.what());
+		}
+	}
+
+	*this = move(loaded);
+}
+
+std::shared_ptr<molstat::SimulateModel> SimulatorInputParse::constructModel(
+	std::ostream &output,
+	const molstat::NameRegistry<molstat::SimulateModelFactoryFunction>
+		&models,
+	ModelInformation &info,
+	std::list<std::pair<std::shared_ptr<molstat::SimulateModel>,
+	                    ModelInformation>> &tabulate,
+	std::list<std::pair<std::shared_ptr<molstat::SimulateModel>,
+	          std::map<std::string, std::vector<std::string>>>> &swept,
+	std::list<std::pair<std::shared_ptr<molstat::SimulateModel>,
+	          std::map<std::string,
+	          std::shared_ptr<const molstat::RandomDistribution>>>> &proposed)
+{
+	// see if the name specified is valid
+	if(models.count(info.name) == 0)
+		throw runtime_error("Unknown model: \"" + info.name + "\".");
+
+	molstat::SimulateModelFactory factory{ models.at(info.name)() };
+
+	// set the distributions, removing any distributions that aren't used
+	{
+		auto dist_iter = info.dists.cbegin();
+		while(dist_iter != info.dists.cend())
+		{
+			bool used;
+			factory.setDistribution(dist_iter->first, dist_iter->second, &used);
+			if(!used)
+			{
+				// this distribution wasn't used... remove it from the list
+				auto here = dist_iter;
+				++dist_iter;
+				info.swept.erase(here->first);
+				info.dists.erase(here);
+			}
+			else
+				++dist_iter;
 		}
 	}
 
@@ -402,7 +2346,8 @@ std::shared_ptr<molstat::SimulateModel> SimulatorInputParse::constructModel(
 			{
 				// create the submodel
 				shared_ptr<molstat::SimulateModel> submodel 
-					{ constructModel(output, models, *submodel_iter) };
+					{ constructModel(output, models, *submodel_iter, tabulate,
+						swept, proposed) };
 
 				// add the submodel
 				factory.addSubmodel(submodel);
@@ -434,14 +2379,227 @@ std::shared_ptr<molstat::SimulateModel> SimulatorInputParse::constructModel(
 			molstat::find_replace(info.to_string(), "\n", "\n   "));
 	}
 
+	if(!info.tables.empty())
+		tabulate.emplace_back(model, info);
+	if(!info.swept.empty())
+		swept.emplace_back(model, info.swept);
+	if(!info.proposals.empty())
+		proposed.emplace_back(model, info.proposals);
+
 	return model;
 }
 
+std::shared_ptr<const molstat::RandomDistribution>
+	SimulatorInputParse::sweepDistribution(
+	const std::vector<std::string> &words, std::size_t point,
+	const std::vector<double> &values) const
+{
+	// substitute the value of the sweep variable or a calibration variable
+	molstat::TokenContainer tokens;
+	string substituted;
+	for(const string &word : words)
+	{
+		if(word[0] != '$')
+		{
+			tokens.push(word);
+			continue;
+		}
+
+		string value;
+		if(!sweep_values.empty() && word.substr(1) == sweep_name)
+			value = sweep_values.at(point);
+		for(size_t k = 0; k < calibrate_variables.size() && value.empty(); ++k)
+		{
+			if(word.substr(1) != calibrate_variables[k].name)
+				continue;
+
+			ostringstream str;
+			str << setprecision(17) << (values.empty() ?
+				calibrate_variables[k].initial : values.at(k));
+			value = str.str();
+		}
+		if(value.empty())
+			throw runtime_error("Unknown sweep variable: \"" + word + "\".");
+
+		tokens.push(value);
+		substituted += (substituted.empty() ? "" : ", ") + word.substr(1) +
+			" = " + value;
+	}
+
+	try
+	{
+		return molstat::RandomDistributionFactory(move(tokens));
+	}
+	catch(const invalid_argument &e)
+	{
+		throw runtime_error("Invalid distribution for " + substituted +
+			":\n   " + molstat::find_replace(e.what(), "\n", "\n   "));
+	}
+}
+
+bool SimulatorInputParse::refersTo(const ModelInformation &info,
+	const std::string &name)
+{
+	for(const auto &dist : info.swept)
+		if(find(dist.second.begin(), dist.second.end(), name) !=
+			dist.second.end())
+			return true;
+
+	for(const ModelInformation &submodel : info.submodels)
+		if(refersTo(submodel, name))
+			return true;
+
+	return false;
+}
+
+std::size_t SimulatorInputParse::sweepModelInformation(ModelInformation &info,
+	std::size_t point) const
+{
+	std::size_t ret{ info.swept.size() };
+	for(const auto &dist : info.swept)
+		info.dists[dist.first] = sweepDistribution(dist.second, point);
+
+	for(ModelInformation &submodel : info.submodels)
+		ret += sweepModelInformation(submodel, point);
+
+	return ret;
+}
+
+double SimulatorInputParse::integrationPrecision() const
+{
+	if(precision_fraction == 0.)
+		return precision;
+
+	// the narrowest bin of the observables with fixed bounds
+	double resolution{ numeric_limits<double>::infinity() };
+	for(const auto &obs_bin : obs_bins)
+		if(obs_bin.second.second->hasBounds())
+			resolution = min(resolution,
+				obs_bin.second.second->relativeResolution());
+
+	return isfinite(resolution) ? precision_fraction * resolution : 0.;
+}
+
+void SimulatorInputParse::applySweep(molstat::Simulator &sim,
+	std::size_t point) const
+{
+	for(const auto &swept : swept_models)
+		for(const auto &dist : swept.second)
+			sim.setDistribution(*swept.first, dist.first,
+				sweepDistribution(dist.second, point));
+}
+
+std::string SimulatorInputParse::calibrationFileName() const
+{
+	return calibrate_filename;
+}
+
+std::size_t SimulatorInputParse::calibrationTrials() const noexcept
+{
+	return calibrate_trials;
+}
+
+std::size_t SimulatorInputParse::calibrationIterations() const noexcept
+{
+	return calibrate_iterations;
+}
+
+double SimulatorInputParse::calibrationTolerance() const noexcept
+{
+	return calibrate_tolerance;
+}
+
+std::vector<SimulatorInputParse::CalibrationVariable>
+	SimulatorInputParse::calibrationVariables() const
+{
+	return calibrate_variables;
+}
+
+void SimulatorInputParse::applyCalibration(molstat::Simulator &sim,
+	const std::vector<double> &values) const
+{
+	for(const auto &swept : swept_models)
+		for(const auto &dist : swept.second)
+			sim.setDistribution(*swept.first, dist.first,
+				sweepDistribution(dist.second, 0, values));
+}
+
 std::size_t SimulatorInputParse::numTrials() const noexcept
 {
 	return trials;
 }
 
+std::size_t SimulatorInputParse::numThreads() const noexcept
+{
+	return nthreads;
+}
+
+bool SimulatorInputParse::pinThreads() const noexcept
+{
+	return pin_threads;
+}
+
+std::size_t SimulatorInputParse::pipelineBinners() const noexcept
+{
+	return pipeline_binners;
+}
+
+std::size_t SimulatorInputParse::pipelineDepth() const noexcept
+{
+	return pipeline_depth;
+}
+
+std::size_t SimulatorInputParse::numBlocks() const noexcept
+{
+	return nblocks;
+}
+
+molstat::EngineKind SimulatorInputParse::engineKind() const noexcept
+{
+	return engine_kind;
+}
+
+bool SimulatorInputParse::useGPU() const noexcept
+{
+	return use_gpu;
+}
+
+bool SimulatorInputParse::analyticHistogram() const noexcept
+{
+	return analytic;
+}
+
+SimulatorInputParse::SamplingMethod SimulatorInputParse::samplingMethod()
+	const noexcept
+{
+	return sampling;
+}
+
+bool SimulatorInputParse::incrementalPool() const noexcept
+{
+	return incremental;
+}
+
+molstat::Engine::result_type SimulatorInputParse::seed() const noexcept
+{
+	return rng_seed;
+}
+
+bool SimulatorInputParse::seedSpecified() const noexcept
+{
+	return seed_specified;
+}
+
+void SimulatorInputParse::setSeed(molstat::Engine::result_type seed) noexcept
+{
+	rng_seed = seed;
+}
+
+molstat::Engine::result_type SimulatorInputParse::stream() const noexcept
+{
+	return rng_stream;
+}
+
 std::string SimulatorInputParse::ModelInformation::to_string() const
 {
 	// first put in the name
@@ -455,7 +2613,29 @@ std::string SimulatorInputParse::ModelInformation::to_string() const
 	// load in the distributions
 	for(auto dist : dists)
 	{
-		ret += "\n      " + dist.first + " -> " + dist.second->info();
+		ret += "\n      " + dist.first + " -> ";
+
+		// distributions that depend on the sweep variable
+		const auto words = swept.find(dist.first);
+		if(words == swept.end())
+			ret += dist.second->info();
+		else
+		{
+			ret += "swept:";
+			for(const string &word : words->second)
+				ret += ' ' + word;
+		}
+	}
+
+	// proposal distributions for importance sampling
+	for(const auto &prop : proposals)
+		ret += "\n   Proposal: " + prop.first + " -> " + prop.second->info();
+
+	// tabulated observables
+	for(const auto &table : tables)
+	{
+		ret += "\n   Tabulated: " + table.first + " (" +
+			std::to_string(table.second) + " points)";
 	}
 
 	// submodel information
@@ -481,7 +2661,13 @@ void SimulatorInputParse::printState(std::ostream &output) const
 			for(auto obs_bin : obs_bins)
 			{
 				output << obs_bin.first << " -> " << obs_bin.second.first <<
-					" (" << obs_bin.second.second->info() << ")\n";
+					" (" << obs_bin.second.second->info();
+				if(obs_bin.second.second->hasBounds())
+				{
+					const auto bounds = obs_bin.second.second->getBounds();
+					output << " in [" << bounds[0] << ", " << bounds[1] << ']';
+				}
+				output << ")\n";
 			}
 		}
 		else
@@ -489,12 +2675,194 @@ void SimulatorInputParse::printState(std::ostream &output) const
 	}
 	output << '\n';
 
-	output << trials << " data point";
-	if(trials != 1)
+	if(trace != nullptr)
+	{
+		const auto range = trace->getDisplacementRange();
+		output << trials << " trace";
+		if(trials != 1)
+			output << 's';
+		output << " of " << trace->numPoints() << " point";
+		if(trace->numPoints() != 1)
+			output << 's';
+		output << " (displacements " << range.first << " to " << range.second <<
+			')';
+	}
+	else
+	{
+		output << trials << " data point";
+		if(trials != 1)
+			output << 's';
+	}
+	output << " will be simulated using " << nthreads << " thread";
+	if(nthreads != 1)
 		output << 's';
-	output << " will be simulated.\n";
+	if(pin_threads)
+		output << " (pinned to CPUs)";
+	output << ".\n";
+	if(nblocks > 0)
+		output << "The trials are divided into " << nblocks << " block" <<
+			(nblocks != 1 ? "s" : "") << ", regardless of the threads.\n";
+	if(pipeline_binners > 0)
+	{
+		output << "Pipeline: " << pipeline_binners << " binning thread";
+		if(pipeline_binners != 1)
+			output << 's';
+		output << ", up to " << pipeline_depth << " batch" <<
+			(pipeline_depth != 1 ? "es" : "") << " waiting per thread\n";
+	}
+
+	output << "Random Number Engine: " << molstat::EngineKindName(engine_kind)
+		<< " (seed " << rng_seed << ", stream " << rng_stream << ")\n";
+
+	// the instruction set of the batch kernels is selected at startup
+	output << "Vector Instructions: " << molstat::BatchKernelTarget() << '\n';
+
+	if(use_gpu)
+		output << "Device: GPU, if the model supports it\n";
+	if(analytic)
+		output << "Histogram: exact, if the model and distributions allow it\n";
+
+	if(sampling == SamplingMethod::Sobol)
+		output << "Sampling: Sobol sequence (quasi-Monte Carlo)\n";
+	else if(sampling == SamplingMethod::LatinHypercube)
+		output << "Sampling: Latin hypercube (over each batch of trials)\n";
+	else if(sampling == SamplingMethod::Pool)
+	{
+		output << "Sampling: a fixed pool of base variates (common random " \
+			"numbers)";
+		if(incremental)
+			output << ", re-simulated incrementally";
+		output << '\n';
+	}
+
+	const double needed{ integrationPrecision() };
+	output << "Quadrature: ";
+	if(quadrature_order > 0)
+		output << quadrature_order << "-point Gauss-Legendre\n";
+	else if(needed > 0.)
+		output << "adaptive (relative tolerance " << needed << ")\n";
+	else
+		output << "adaptive (tolerance " << quadrature_tolerance << ")\n";
+
+	if(precision > 0. || precision_fraction > 0.)
+	{
+		output << "Precision: ";
+		if(precision_fraction > 0.)
+			output << precision_fraction << " of the narrowest bin";
+		else
+			output << "relative " << precision;
+		if(precision_fraction > 0. && needed == 0.)
+			output << " (unused; no observable has fixed bounds)";
+		else if(quadrature_order > 0)
+			output << " (unused by Gauss-Legendre quadrature)";
+		output << '\n';
+	}
+
+	if(profile_interval > 0)
+		output << "Profiling: 1 of every " << profile_interval << " batches " \
+			"timed\n";
+
+	output << "Histogram Output File: " << histfilename << " (" <<
+		molstat::HistogramFormatName(histformat) << ")\n";
+
+	if(!samplefilename.empty())
+	{
+		output << "Raw Sample File: " << samplefilename;
+		if(sample_params)
+			output << " (with model parameters)";
+		output << '\n';
+	}
+
+	if(!densityfilename.empty())
+	{
+		output << "Kernel Density Estimate File: " << densityfilename << " (" <<
+			molstat::HistogramFormatName(densityformat) << "; bandwidths";
+		if(density_bandwidths.empty())
+			output << " from Silverman's rule";
+		for(const double h : density_bandwidths)
+			output << ' ' << h;
+		output << ")\n";
+	}
+
+	if(!sweep_values.empty())
+	{
+		output << "Sweep: $" << sweep_name << " over " << sweep_values.size() <<
+			" value(s):";
+		for(const string &value : sweep_values)
+			output << ' ' << value;
+		output << '\n';
+	}
+
+	if(!calibrate_filename.empty())
+	{
+		output << "Calibration: tune";
+		for(const CalibrationVariable &var : calibrate_variables)
+			output << " $" << var.name << " (from " << var.initial <<
+				", step " << var.step << ')';
+		output << " to the histogram in " << calibrate_filename << " (" <<
+			calibrate_trials << " trials per simulation, at most " <<
+			calibrate_iterations << " iterations, tolerance " <<
+			calibrate_tolerance << ")\n";
+	}
+
+	for(const MarginalOutput &marginal : marginals)
+	{
+		output << "Marginal Histogram File: " << marginal.filename << " (" <<
+			molstat::HistogramFormatName(marginal.format) << "; dimension(s)";
+		for(const size_t j : marginal.spec.dimensions)
+			output << ' ' << j;
+		for(const molstat::HistogramSlice &slice : marginal.spec.slices)
+			output << ", dimension " << slice.dimension << " in [" <<
+				slice.range[0] << ", " << slice.range[1] << ']';
+		output << ")\n";
+	}
+
+	for(const HistogramOutput &histogram : histograms)
+	{
+		output << "Additional Histogram File: " << histogram.filename << " (" <<
+			molstat::HistogramFormatName(histogram.format) << ';';
+		for(size_t j = 0; j < histogram.observables.size(); ++j)
+		{
+			const auto bounds = histogram.bstyles[j]->getBounds();
+			output << (j > 0 ? ", " : " ") << histogram.observables[j] <<
+				" with " << histogram.bstyles[j]->info() << " in [" <<
+				bounds[0] << ", " << bounds[1] << ']';
+		}
+		output << ")\n";
+	}
+
+	if(!checkpointfilename.empty())
+	{
+		output << "Checkpoint File: " << checkpointfilename << " (every " <<
+			checkpoint_interval << " s";
+		if(resume_run)
+			output << "; resuming from it, if it exists";
+		output << ")\n";
+	}
+
+	if(pilot_fraction > 0.)
+		output << "Pilot Run: " << pilot_fraction << " of the trials, " \
+			"margin " << pilot_margin << ", widening the bins when more than " <<
+			pilot_overflow << " of the data are outside them\n";
+
+	if(memory_limit > 0.)
+		output << "Memory Limit: " << memory_limit << " MiB of stored data " \
+			"and histograms per process\n";
+
+	if(converge_tolerance > 0.)
+		output << "Convergence: stop once the Hellinger distance between " \
+			"rounds of " << converge_interval << " trials is at most " <<
+			converge_tolerance << '\n';
+
+	if(progress_fraction > 0.)
+		output << "Partial Histograms: every " << progress_fraction <<
+			" of the trials, to " << progressFileName() << '\n';
+}
 
-	output << "Histogram Output File: " << histfilename << '\n';
+std::shared_ptr<const molstat::TraceProtocol>
+	SimulatorInputParse::getTraceProtocol() const
+{
+	return trace;
 }
 
 std::string SimulatorInputParse::outputFileName() const
@@ -502,6 +2870,139 @@ std::string SimulatorInputParse::outputFileName() const
 	return histfilename;
 }
 
+molstat::HistogramFormat SimulatorInputParse::outputFormat() const noexcept
+{
+	return histformat;
+}
+
+std::string SimulatorInputParse::sampleFileName() const
+{
+	return samplefilename;
+}
+
+bool SimulatorInputParse::sampleParameters() const noexcept
+{
+	return sample_params;
+}
+
+std::string SimulatorInputParse::densityFileName() const
+{
+	return densityfilename;
+}
+
+molstat::HistogramFormat SimulatorInputParse::densityFormat() const noexcept
+{
+	return densityformat;
+}
+
+std::vector<double> SimulatorInputParse::densityBandwidths() const
+{
+	return density_bandwidths;
+}
+
+std::string SimulatorInputParse::sweepName() const
+{
+	return sweep_name;
+}
+
+std::vector<std::string> SimulatorInputParse::sweepValues() const
+{
+	return sweep_values;
+}
+
+std::vector<SimulatorInputParse::MarginalOutput>
+	SimulatorInputParse::getMarginals() const
+{
+	return marginals;
+}
+
+std::vector<SimulatorInputParse::HistogramOutput>
+	SimulatorInputParse::getHistograms() const
+{
+	return histograms;
+}
+
+std::string SimulatorInputParse::checkpointFileName() const
+{
+	return checkpointfilename;
+}
+
+std::string SimulatorInputParse::compileFileName() const
+{
+	return compilefilename;
+}
+
+double SimulatorInputParse::checkpointInterval() const noexcept
+{
+	return checkpoint_interval;
+}
+
+bool SimulatorInputParse::resume() const noexcept
+{
+	return resume_run;
+}
+
+double SimulatorInputParse::convergenceTolerance() const noexcept
+{
+	return converge_tolerance;
+}
+
+std::size_t SimulatorInputParse::convergenceInterval() const noexcept
+{
+	return converge_interval;
+}
+
+double SimulatorInputParse::progressFraction() const noexcept
+{
+	return progress_fraction;
+}
+
+std::string SimulatorInputParse::progressFileName() const
+{
+	return progress_filename.empty() ? histfilename + ".partial" :
+		progress_filename;
+}
+
+double SimulatorInputParse::pilotFraction() const noexcept
+{
+	return pilot_fraction;
+}
+
+double SimulatorInputParse::pilotMargin() const noexcept
+{
+	return pilot_margin;
+}
+
+double SimulatorInputParse::pilotOverflow() const noexcept
+{
+	return pilot_overflow;
+}
+
+std::size_t SimulatorInputParse::memoryLimit() const noexcept
+{
+	return static_cast<std::size_t>(memory_limit * 1048576. + 0.5);
+}
+
+std::size_t SimulatorInputParse::profileInterval() const noexcept
+{
+	return profile_interval;
+}
+
+bool SimulatorInputParse::jsonReport() const noexcept
+{
+	return json_report;
+}
+
+std::vector<std::string> SimulatorInputParse::getObservableNames() const
+{
+	vector<string> ret(obs_bins.size());
+
+	for(const auto &obs_bin : obs_bins)
+		ret[obs_bin.first] = obs_bin.second.first;
+
+	return ret;
+}
+
 std::vector<std::shared_ptr<molstat::BinStyle>>
 	SimulatorInputParse::getBinStyles() const
 {
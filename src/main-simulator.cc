@@ -21,47 +21,752 @@
 #include <valarray>
 #include <iostream>
 #include <fstream>
+#include <exception>
+#include <algorithm>
+#include <random>
+#include <array>
+#include <sstream>
+#include <iterator>
+#include <limits>
+#include <iomanip>
+#include <cstdio>
+#include <sys/resource.h>
 
+#include <config.h>
+
+#include <general/event_trace.h>
+#include <general/nelder_mead.h>
 #include <general/string_tools.h>
+#include <general/task_scheduler.h>
 #include <general/random_distributions/rng.h>
-#include <general/histogram_tools/counterindex.h>
+#include <general/random_distributions/sobol.h>
+#include <general/random_distributions/variate_pool.h>
 #include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/histogram_io.h>
+#include <general/histogram_tools/shared_histogram.h>
+#include <general/histogram_tools/kernel_density.h>
+#include <general/histogram_tools/marginal.h>
+#include <general/histogram_tools/sample_file.h>
 #include <general/histogram_tools/bin_linear.h>
 #include <general/simulator_tools/simulator_exceptions.h>
+#include <general/simulator_tools/simulator_profile.h>
+#include <general/simulator_tools/checkpoint.h>
+#include <general/simulator_tools/batch_pipeline.h>
+#include <general/simulator_tools/process_group.h>
+#include <general/simulator_tools/trace_protocol.h>
+#include <general/simulator_tools/device_simulator.h>
+#include <general/simulator_tools/analytic_histogram.h>
+
+#if BUILD_TRANSPORT_SIMULATOR
+#include <electron_transport/simulator_models/transport_device.h>
+#endif
 
 #include "main-simulator.h"
 
 using namespace std;
 
 /**
- * \brief Main function for simulating a histogram.
+ * \brief Quotes a string for JSON.
  *
- * Parses the input parameters and outputs randomly generated data
- * for the desired observable.
+ * \param[in] str The string.
+ * \return The quoted string, with the special characters escaped.
+ */
+static string json_string(const string &str)
+{
+	string ret{ "\"" };
+	for(const char c : str)
+	{
+		switch(c)
+		{
+		case '"':
+			ret += "\\\"";
+			break;
+		case '\\':
+			ret += "\\\\";
+			break;
+		case '\n':
+			ret += "\\n";
+			break;
+		case '\t':
+			ret += "\\t";
+			break;
+		default:
+			if(static_cast<unsigned char>(c) < 0x20)
+			{
+				const char hex[]{ "0123456789abcdef" };
+				ret += "\\u00";
+				ret += hex[(c >> 4) & 0xF];
+				ret += hex[c & 0xF];
+			}
+			else
+				ret += c;
+			break;
+		}
+	}
+	return ret + '"';
+}
+
+/**
+ * \brief Formats a number for JSON.
  *
- * \param[in] argc The number of command-line arguments.
- * \param[in] argv The command-line arguments.
- * \return Exit status; 0 for normal.
+ * \param[in] x The number.
+ * \return The number, or `null` if it is not finite.
  */
-int main(int argc, char **argv)
+static string json_number(const double x)
 {
-	// name of the histogram output file with a default name
-	string histfilename{"histogram.dat"};
+	if(!isfinite(x))
+		return "null";
 
-	// process the input deck
-	SimulatorInputParse parser;
+	ostringstream ret;
+	ret << setprecision(10) << x;
+	return ret.str();
+}
+
+/**
+ * \brief Gets the peak resident memory of this process.
+ *
+ * \return The memory (MiB); 0 if it is unavailable.
+ */
+static double PeakResidentMiB()
+{
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0.;
+
+	// bytes on macOS, KiB elsewhere
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1048576.;
+#else
+	return usage.ru_maxrss / 1024.;
+#endif
+}
+
+/**
+ * \brief Draws the pool of base variates of this process's trials.
+ *
+ * The pool's engine is seeded apart from the threads' streams, by the seed,
+ * stream, and process.
+ *
+ * \param[in] group The processes of the simulation.
+ * \param[in] parser The input parameters.
+ * \param[in] sim The simulator.
+ * \param[in] ntrials The number of trials of this process.
+ * \return The pool.
+ */
+static unique_ptr<molstat::VariatePool> make_pool(
+	const molstat::ProcessGroup &group, const SimulatorInputParse &parser,
+	const molstat::Simulator &sim, size_t ntrials)
+{
+	seed_seq seq{ parser.seed() & 0xFFFFFFFFu, parser.seed() >> 32,
+		parser.stream() & 0xFFFFFFFFu, parser.stream() >> 32,
+		molstat::Engine::result_type(0xBA5E), molstat::Engine::result_type(
+		group.rank()) };
+
+	return unique_ptr<molstat::VariatePool>(new molstat::VariatePool(ntrials,
+		max<size_t>(1, sim.numQuasiRandomDimensions()),
+		molstat::Engine{ seq, parser.engineKind() }));
+}
+
+/// The trials of one process, divided into blocks for its threads.
+struct TrialBlocks
+{
+	/// The first trial of the process.
+	size_t first_trial;
+
+	/// The number of trials of the process.
+	size_t local_trials;
+
+	/// The first trial of each block.
+	vector<size_t> begin;
+
+	/// The trial after the last of each block.
+	vector<size_t> end;
+
+	/// The stream (of the engine) of each block.
+	vector<size_t> streams;
+
+	/// The number of blocks of every process.
+	size_t total;
+};
+
+/**
+ * \brief Divides the trials among the processes and then into blocks.
+ *
+ * Each block has its own stream of the engine and its own histogram; the
+ * threads simulate the blocks and the histograms are combined in the order
+ * of the blocks. By default, the trials are divided among the processes (in
+ * contiguous shares) and then among the threads of each process, one block
+ * per thread. With `blocks`, the trials are instead divided into that many
+ * blocks (at least one per process, and at most one per trial) and block
+ * `k` uses stream `k`, so that each trial is simulated with the same stream
+ * and binned in the same block for any numbers of threads and processes.
+ *
+ * \param[in] group The processes of the simulation.
+ * \param[in] parser The input parameters.
+ * \param[in] ntrials The number of trials (of every process).
+ * \return This process's blocks.
+ */
+static TrialBlocks divide_trials(const molstat::ProcessGroup &group,
+	const SimulatorInputParse &parser, size_t ntrials)
+{
+	const size_t rank(group.rank()), nprocs(group.size());
+	TrialBlocks ret;
+
+	if(parser.numBlocks() == 0)
+	{
+		ret.first_trial = (ntrials * rank) / nprocs;
+		ret.local_trials = (ntrials * (rank + 1)) / nprocs - ret.first_trial;
+		const size_t nblocks{ max<size_t>(1,
+			min(parser.numThreads(), ret.local_trials)) };
+		for(size_t b = 0; b < nblocks; ++b)
+		{
+			ret.begin.push_back(ret.first_trial +
+				(ret.local_trials * b) / nblocks);
+			ret.end.push_back(ret.first_trial +
+				(ret.local_trials * (b + 1)) / nblocks);
+			ret.streams.push_back(rank * parser.numThreads() + b);
+		}
+		ret.total = nprocs * nblocks;
+		return ret;
+	}
+
+	// the blocks of every process, and this process's share of them; more
+	// blocks than trials would only be empty
+	ret.total = max(min(parser.numBlocks(), ntrials), nprocs);
+	for(size_t k = (ret.total * rank) / nprocs;
+		k < (ret.total * (rank + 1)) / nprocs; ++k)
+	{
+		ret.begin.push_back((ntrials * k) / ret.total);
+		ret.end.push_back((ntrials * (k + 1)) / ret.total);
+		ret.streams.push_back(k);
+	}
+	ret.first_trial = ret.begin.front();
+	ret.local_trials = ret.end.back() - ret.first_trial;
+	return ret;
+}
+
+/**
+ * \brief Gets the engine of each block.
+ *
+ * The streams of a process's blocks are consecutive, so each block's engine
+ * is the previous block's engine jumped once.
+ *
+ * \param[in] blocks The blocks.
+ * \param[in] base_engine The engine from which the streams are derived.
+ * \return The engine of each block.
+ */
+static vector<molstat::Engine> block_engines(const TrialBlocks &blocks,
+	const molstat::Engine &base_engine)
+{
+	vector<molstat::Engine> ret;
+	ret.reserve(blocks.streams.size());
+	for(size_t t = 0; t < blocks.streams.size(); ++t)
+	{
+		if(t == 0)
+			ret.push_back(base_engine.stream(blocks.streams[0]));
+		else
+		{
+			ret.push_back(ret.back());
+			ret.back().jump(blocks.streams[t] - blocks.streams[t - 1]);
+		}
+	}
+	return ret;
+}
+
+/**
+ * \brief Reports how many of the submodel terms were reused from the cache.
+ *
+ * \param[in] group The processes of the simulation.
+ * \param[in] cache This process's cache.
+ * \param[in,out] info The stream for informational output.
+ */
+static void report_cache(const molstat::ProcessGroup &group,
+	const molstat::ContributionCache &cache, ostream &info)
+{
+	vector<size_t> counts{ cache.numReused(), cache.numCalculated() };
+	group.sumToRoot(counts);
+
+	info << "So far, " << counts[0] << " of " << (counts[0] + counts[1]) <<
+		" submodel term(s) were reused from the cache." << endl;
+}
+
+/**
+ * \brief Sums the (raw) bin counts of a histogram from every process on the
+ *    root.
+ *
+ * \param[in] group The processes.
+ * \param[in,out] hist This process's histogram; on the root, the histogram of
+ *    every process.
+ */
+static void sum_histogram(const molstat::ProcessGroup &group,
+	molstat::Histogram &hist)
+{
+	const size_t ndim{ hist.numDimensions() };
+	vector<size_t> counts{ hist.getRawBinCounts() };
+	vector<size_t> tallies{ hist.numOutOfRange() };
+	for(size_t j = 0; j < ndim; ++j)
+	{
+		tallies.push_back(hist.numUnderflow(j));
+		tallies.push_back(hist.numOverflow(j));
+	}
+
+	group.sumToRoot(counts);
+	group.sumToRoot(tallies);
+
+	vector<array<size_t, 2>> out_of_range(ndim);
+	for(size_t j = 0; j < ndim; ++j)
+		out_of_range[j] = {{ tallies[2*j + 1], tallies[2*j + 2] }};
+
+	// the sums of the weights are set after the counts
+	vector<double> sums;
+	if(hist.isWeighted())
+	{
+		sums = hist.getRawBinSums();
+		group.sumToRoot(sums);
+	}
+	hist.setRawBinCounts(move(counts), tallies[0], out_of_range);
+	if(hist.isWeighted())
+		hist.setRawBinSums(move(sums));
+}
+
+/**
+ * \brief Writes a histogram in one of the output formats, and closes its
+ *    file.
+ *
+ * \param[in,out] out The output stream; HDF5 files are instead written by
+ *    name.
+ * \param[in] filename The name of the file.
+ * \param[in] format The format.
+ * \param[in] hist The histogram.
+ * \param[in] bstyles The binning style of each dimension.
+ * \param[in] ntotal The number of trials.
+ * \param[in] nbinned The number of trials in the bins.
+ * \param[in,out] output Output stream for any error messages.
+ */
+static void write_histogram(ofstream &out, const string &filename,
+	molstat::HistogramFormat format, const molstat::Histogram &hist,
+	const vector<shared_ptr<const molstat::BinStyle>> &bstyles,
+	size_t ntotal, size_t nbinned, ostream &output)
+{
+	switch(format)
+	{
+	case molstat::HistogramFormat::Binary:
+		molstat::WriteHistogramBinary(out, hist, bstyles, ntotal, nbinned);
+		break;
+	case molstat::HistogramFormat::Gzip:
+		molstat::WriteHistogramGzip(out, hist);
+		break;
+	case molstat::HistogramFormat::Mergeable:
+		molstat::WriteHistogramMergeable(out,
+			molstat::MakeMergeableHistogram(hist, bstyles, ntotal, nbinned));
+		break;
+	case molstat::HistogramFormat::HDF5:
+		try
+		{
+			molstat::WriteHistogramHDF5(filename, hist, bstyles, ntotal,
+				nbinned);
+		}
+		catch(const exception &e)
+		{
+			output << "FATAL ERROR: " << e.what() << endl;
+		}
+		break;
+	case molstat::HistogramFormat::Text:
+	default:
+		molstat::WriteHistogramText(out, hist);
+		break;
+	}
+
+	out.close();
+}
+
+/**
+ * \brief Reads the target histogram of a calibration.
+ *
+ * The target is a histogram written by the simulator, either in the text
+ * format (a line per bin, with its coordinates and count) or the binary
+ * format. Its bins must be those of the simulated histogram.
+ *
+ * \throw std::runtime_error if the file cannot be read or its bins differ.
+ *
+ * \param[in] filename The name of the file.
+ * \param[in] hist A histogram with the simulated bins.
+ * \return The bin counts, with the first dimension changing the fastest.
+ */
+static vector<double> read_target(const string &filename,
+	const molstat::Histogram &hist)
+{
+	ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+	if(!in)
+		throw runtime_error("Unable to open the target histogram \"" +
+			filename + "\".");
+
+	// the coordinates of the target's bins and their counts
+	const size_t ndim{ hist.numDimensions() };
+	vector<vector<double>> coordinates;
+	vector<double> counts;
+	if(molstat::IsBinaryHistogram(in))
+	{
+		molstat::HistogramData data{ molstat::ReadHistogramBinary(in) };
+		if(data.coordinates.size() != ndim)
+			throw runtime_error("The target histogram has " +
+				to_string(data.coordinates.size()) + " dimension(s); " +
+				to_string(ndim) + " expected.");
+		coordinates = move(data.coordinates);
+		counts = move(data.counts);
+	}
+	else
+	{
+		// with the text format, the coordinates of each line are checked
+		// against those of the bin in the same place
+		coordinates.resize(ndim);
+		string line;
+		while(getline(in, line))
+		{
+			istringstream words(line.substr(0, line.find('#')));
+			vector<double> values;
+			double value;
+			while(words >> value)
+				values.push_back(value);
+			if(!words.eof())
+				throw runtime_error("Unable to read the target histogram \"" +
+					filename + "\".");
+			if(values.empty())
+				continue;
+			if(values.size() != ndim + 1)
+				throw runtime_error("Each line of the target histogram must " \
+					"have " + to_string(ndim) + " coordinate(s) and a count.");
+
+			for(size_t j = 0; j < ndim; ++j)
+				coordinates[j].push_back(values[j]);
+			counts.push_back(values[ndim]);
+		}
+	}
+
+	// the coordinates are compared to the precision of the text format,
+	// relative to the larger of the coordinate and the bin spacing
+	const auto same = [] (double a, const vector<double> &coords, size_t k)
+		-> bool
+	{
+		double spacing{ abs(coords[k]) };
+		if(k > 0)
+			spacing = max(spacing, abs(coords[k] - coords[k - 1]));
+		if(k + 1 < coords.size())
+			spacing = max(spacing, abs(coords[k + 1] - coords[k]));
+		return abs(a - coords[k]) <= 1.e-4 * spacing;
+	};
+
+	size_t nbins{ 1 };
+	for(size_t j = 0; j < ndim; ++j)
+		nbins *= hist.getBinCoordinates(j).size();
+	bool match{ counts.size() == nbins };
+	for(molstat::CounterIndex ci{ hist.begin() }; match && !ci.at_end(); ++ci)
+	{
+		const size_t k{ ci.arrayOffset() };
+		for(size_t j = 0; j < ndim && match; ++j)
+		{
+			const vector<double> &coords = hist.getBinCoordinates(j);
+			match = same(coordinates[j].size() == nbins ? coordinates[j][k] :
+				coordinates[j].at(ci[j]), coords, ci[j]);
+		}
+	}
+	if(!match)
+		throw runtime_error("The bins of the target histogram \"" + filename +
+			"\" are not those of the simulation.");
+
+	return counts;
+}
+
+/**
+ * \brief Calibrates the distributions of a simulation to a target histogram.
+ *
+ * The variables of the calibration (see SimulatorInputParse) are tuned to
+ * minimize the Hellinger distance between the simulated and target
+ * histograms, using the Nelder-Mead method. Each simulation uses the same
+ * random numbers (common random numbers), so that the distance changes
+ * smoothly with the variables; with a pool of base variates (see
+ * molstat::VariatePool), each simulation transforms the same variates. The
+ * trials are divided among the processes and threads as in the full
+ * simulation.
+ *
+ * \param[in] group The processes of the simulation.
+ * \param[in] parser The input parameters.
+ * \param[in,out] sim The simulator; its distributions are left with the best
+ *    values of the variables.
+ * \param[in] bstyles The binning styles, each with fixed bounds.
+ * \param[in,out] scheduler The scheduler for the threads.
+ * \param[in,out] output The output stream for errors.
+ * \param[in,out] info The output stream for informational messages.
+ * \param[out] result The result of the minimization.
+ * \return False if the calibration failed (the error is reported).
+ */
+static bool calibrate(molstat::ProcessGroup &group,
+	const SimulatorInputParse &parser, molstat::Simulator &sim,
+	const vector<shared_ptr<const molstat::BinStyle>> &bstyles,
+	molstat::TaskScheduler &scheduler, ostream &output, ostream &info,
+	molstat::NelderMeadResult &result)
+{
+	const vector<SimulatorInputParse::CalibrationVariable> variables
+		{ parser.calibrationVariables() };
+	vector<double> x0, steps;
+	for(const auto &var : variables)
+	{
+		x0.push_back(var.initial);
+		steps.push_back(var.step);
+	}
+
+	// the root reads the target
+	vector<double> target;
+	bool ok{ true };
+	if(group.isRoot())
+	{
+		try
+		{
+			target = read_target(parser.calibrationFileName(),
+				molstat::Histogram(bstyles));
+		}
+		catch(const exception &e)
+		{
+			output << "FATAL ERROR: " << e.what() << endl;
+			ok = false;
+		}
+	}
+	if(!group.all(ok))
+		return false;
+
+	// divide the trials as in the full simulation; each block's engine is
+	// reset for every simulation
+	const size_t ntrials{ parser.calibrationTrials() };
+	const TrialBlocks blocks{ divide_trials(group, parser, ntrials) };
+	const size_t nblocks{ blocks.begin.size() };
+	const size_t local_trials{ blocks.local_trials };
+	const vector<molstat::Engine> engines{ block_engines(blocks,
+		molstat::Engine{ parser.seed(), parser.stream(),
+		parser.engineKind() }) };
+	const bool weighted{ sim.isWeighted() };
+	const size_t nobs{ sim.numObservables() };
+	const unique_ptr<molstat::VariatePool> pool{ parser.samplingMethod() ==
+		SimulatorInputParse::SamplingMethod::Pool ?
+		make_pool(group, parser, sim, local_trials) : nullptr };
+	const unique_ptr<molstat::ContributionCache> cache{
+		pool != nullptr && parser.incrementalPool() ?
+		new molstat::ContributionCache(sim, local_trials) : nullptr };
+
+	const auto distance = [&] (const vector<double> &x) -> double
+	{
+		// points with invalid distributions are outside the domain (every
+		// process finds the same)
+		try
+		{
+			parser.applyCalibration(sim, x);
+		}
+		catch(const runtime_error &e)
+		{
+			return numeric_limits<double>::infinity();
+		}
+
+		vector<molstat::Histogram> thread_hists;
+		thread_hists.reserve(nblocks);
+		for(size_t t = 0; t < nblocks; ++t)
+		{
+			thread_hists.emplace_back(bstyles);
+			if(weighted)
+				thread_hists.back().useWeights();
+		}
+		vector<exception_ptr> thread_errors(nblocks, nullptr);
+
+		const auto run = [&] (size_t t) -> void
+		{
+			try
+			{
+				molstat::Engine engine{ engines[t] };
+				const size_t batch_size{ 1024 };
+				vector<double> observables(batch_size * nobs), workspace;
+				vector<double> weights(weighted ? batch_size : 0);
+				double *const wptr{ weighted ? weights.data() : nullptr };
+
+				for(size_t j = blocks.begin[t]; j < blocks.end[t];
+					j += batch_size)
+				{
+					const size_t n{ min(batch_size, blocks.end[t] - j) };
+					const size_t nvalid{ pool != nullptr ?
+						sim.simulateBatchPooled(*pool, j - blocks.first_trial,
+							engine, n,
+							observables.data(), workspace, nullptr, nullptr,
+							nullptr, wptr, cache.get()) :
+						sim.simulateBatch(engine, n, observables.data(),
+							workspace, nullptr, nullptr, nullptr, wptr) };
+					if(weighted)
+						thread_hists[t].add_data(observables.data(), wptr,
+							nvalid);
+					else
+						thread_hists[t].add_data(observables.data(), nvalid);
+				}
+			}
+			catch(...)
+			{
+				thread_errors[t] = current_exception();
+			}
+		};
+
+		scheduler.run(nblocks, [&run] (size_t t, size_t) -> void
+			{
+				run(t);
+			});
+
+		bool simulated{ true };
+		try
+		{
+			for(size_t t = 0; t < nblocks; ++t)
+			{
+				if(thread_errors[t] != nullptr)
+					rethrow_exception(thread_errors[t]);
+				if(t > 0)
+					thread_hists[0].merge(move(thread_hists[t]));
+			}
+		}
+		catch(const exception &e)
+		{
+			cout << "FATAL ERROR: " << e.what() << endl;
+			simulated = false;
+		}
+		if(!group.all(simulated))
+			throw runtime_error("The calibration failed.");
+
+		// the distance is calculated on the root and sent to the others (the
+		// text keeps every digit, so that every process takes the same steps)
+		vector<double> counts{ thread_hists[0].getBinCounts() };
+		group.sumToRoot(counts);
+		string text;
+		if(group.isRoot())
+		{
+			ostringstream str;
+			str << setprecision(17) <<
+				molstat::HellingerDistance(target, counts);
+			text = str.str();
+		}
+		group.broadcast(text);
+		return molstat::cast_string<double>(text);
+	};
+
+	info << "Calibrating the distributions to \"" <<
+		parser.calibrationFileName() << "\"..." << endl;
 	try
 	{
-		parser.readInput(cin, cout);
+		result = molstat::MinimizeNelderMead(distance, x0, steps,
+			parser.calibrationIterations(), parser.calibrationTolerance());
+		parser.applyCalibration(sim, result.x);
 	}
 	catch(const runtime_error &e)
 	{
-		cout << "FATAL ERROR: " << e.what() << endl;
-		return 0;
+		// a failed simulation has already been reported
+		return false;
+	}
+
+	if(!isfinite(result.f))
+	{
+		output << "FATAL ERROR: The calibration did not find valid " \
+			"distributions." << endl;
+		return false;
+	}
+
+	info << "The calibration " << (result.converged ? "converged" :
+		"did not converge") << " after " << result.iterations <<
+		" iteration(s) (" << result.evaluations << " simulations of " <<
+		ntrials << " trials); the Hellinger distance to the target is " <<
+		result.f << '.' << endl;
+	for(size_t k = 0; k < variables.size(); ++k)
+		info << "   $" << variables[k].name << " = " << setprecision(10) <<
+			result.x[k] << setprecision(6) << endl;
+	if(cache != nullptr)
+		report_cache(group, *cache, info);
+
+	return true;
+}
+
+/**
+ * \brief Simulates the histogram(s) of one input deck.
+ *
+ * \param[in] group The processes of the simulation.
+ * \param[in] deck The input deck (only used by the root process, which sends
+ *    it to the others).
+ * \return Exit status; 0 for normal, 1 if a fatal error was reported.
+ */
+static int simulate(molstat::ProcessGroup &group, string deck)
+{
+	ostream nowhere{ nullptr };
+	ostream &output = group.isRoot() ? cout : nowhere;
+	const molstat::ProfileClock::time_point run_start{
+		molstat::ProfileClock::now() };
+
+	// process the input deck
+	// the root parses it and, with several processes, sends it to the others
+	SimulatorInputParse parser;
+	bool parsed{ true };
+	if(group.isRoot())
+	{
+		try
+		{
+			istringstream input(deck);
+			parser.readInput(input, output);
+		}
+		catch(const runtime_error &e)
+		{
+			output << "FATAL ERROR: " << e.what() << endl;
+			parsed = false;
+		}
+	}
+	if(!group.all(parsed))
+		return 1;
+
+	// each process writes its own checkpoint (the process number is appended
+	// to the name when there are several)
+	const auto checkpoint_name = [&parser, &group] (int rank) -> string
+	{
+		return parser.checkpointFileName() +
+			(group.size() > 1 ? "." + to_string(rank) : "");
+	};
+
+	// when resuming without a specified seed, use the seed of the checkpoint
+	if(group.isRoot() && parser.resume() && !parser.seedSpecified() &&
+		!parser.checkpointFileName().empty() &&
+		ifstream(checkpoint_name(0)).good())
+	{
+		try
+		{
+			parser.setSeed(molstat::ReadCheckpoint(checkpoint_name(0)).seed);
+		}
+		catch(const runtime_error &e)
+		{
+			output << "FATAL ERROR: " << e.what() << endl;
+			parsed = false;
+		}
+	}
+	if(!group.all(parsed))
+		return 1;
+
+	// the other processes read the same input, with the root's seed (which
+	// is random if the input did not specify it); the seed goes last so that
+	// a loaded configuration does not replace it
+	if(group.size() > 1)
+	{
+		if(group.isRoot())
+			deck += "\nseed " + to_string(parser.seed()) + "\n";
+		group.broadcast(deck);
+
+		if(!group.isRoot())
+		{
+			istringstream input(deck);
+			parser.readInput(input, output);
+		}
 	}
 
 	// for debugging purposes, we may want to print the state here
-	// parser.printState(cout);
+	// parser.printState(output);
+
+	// the informational messages; a JSON report replaces them with one line
+	// per simulation (errors are still written to output)
+	ostream &info = parser.jsonReport() ? nowhere : output;
 
 	// readInput did some checking (syntax of input file, etc.), but is
 	// incomplete... no verifying model names are correct, all observables
@@ -72,8 +777,8 @@ int main(int argc, char **argv)
 	const size_t ntrials{ parser.numTrials() };
 	if(ntrials == 0)
 	{
-		cout << "FATAL ERROR: There must be at least one trial." << endl;
-		return 0;
+		output << "FATAL ERROR: There must be at least one trial." << endl;
+		return 1;
 	}
 
 	// create the simulator
@@ -82,29 +787,184 @@ int main(int argc, char **argv)
 	unique_ptr<molstat::Simulator> sim{ nullptr };
 	try
 	{
-		sim = parser.createSimulator(cout);
+		sim = parser.createSimulator(output);
 	}
 	catch(const exception &e)
 	{
-		cout << "FATAL ERROR: " << e.what() << endl;
-		return 0;
+		output << "FATAL ERROR: " << e.what() << endl;
+		return 1;
 	}
 
-	// open the output file
-	ofstream histout(parser.outputFileName(), std::ios_base::app);
-	if(!histout)
+	// checkpoints cannot rewind the raw samples, so they are exclusive
+	if(parser.resume() && parser.checkpointFileName().empty())
 	{
-		cout << "FATAL ERROR: Unable to open \"" << parser.outputFileName() <<
-			"\" for output." << endl;
-		return 0;
+		output << "FATAL ERROR: No checkpoint file from which to resume." <<
+			endl;
+		return 1;
+	}
+	if(!parser.checkpointFileName().empty() &&
+		!parser.sampleFileName().empty())
+	{
+		output << "FATAL ERROR: Checkpoints cannot be written with the raw " \
+			"samples." << endl;
+		return 1;
 	}
 
-	// print the simulator information
-	parser.printState(cout);
+	// each value of a sweep is a separate simulation, which neither
+	// checkpoints nor the raw samples follow
+	if(!parser.sweepValues().empty() &&
+		(!parser.checkpointFileName().empty() ||
+		 !parser.sampleFileName().empty()))
+	{
+		output << "FATAL ERROR: Sweeps cannot be combined with checkpoints or " \
+			"the raw samples." << endl;
+		return 1;
+	}
 
-	// initialize the random number engine
-	//molstat::Engine engine{ 0xFEEDFACE }; // use this line for debugging
-	molstat::Engine engine{ static_cast<unsigned int>(time(nullptr)) };
+	// compiling the input only saves the (validated) configuration
+	if(!parser.compileFileName().empty())
+	{
+		bool compiled{ true };
+		if(group.isRoot())
+		{
+			try
+			{
+				parser.writeCompiled(parser.compileFileName());
+				output << "Compiled configuration written to \"" <<
+					parser.compileFileName() << "\"." << endl;
+			}
+			catch(const runtime_error &e)
+			{
+				output << "FATAL ERROR: " << e.what() << endl;
+				compiled = false;
+			}
+		}
+		return group.all(compiled) ? 0 : 1;
+	}
+
+	// with a sweep, the output files of each value of the sweep variable
+	// have the value appended to their names
+	const vector<string> sweep_values{ parser.sweepValues() };
+	const auto output_name = [&sweep_values] (const string &name,
+		size_t point) -> string
+	{
+		return sweep_values.empty() ? name : name + "." + sweep_values[point];
+	};
+
+	// opens the output files (replacing any existing files) on the root: the
+	// histogram, the kernel density estimate and the marginal histograms (if
+	// requested)
+	const molstat::HistogramFormat format{ parser.outputFormat() };
+	const molstat::HistogramFormat densityformat{ parser.densityFormat() };
+	const vector<SimulatorInputParse::MarginalOutput> marginals
+		{ parser.getMarginals() };
+	const vector<SimulatorInputParse::HistogramOutput> extras
+		{ parser.getHistograms() };
+	ofstream histout, densityout;
+	vector<ofstream> marginalout(group.isRoot() ? marginals.size() : 0),
+		extraout(group.isRoot() ? extras.size() : 0);
+	const auto open_outputs = [&parser, &group, &output, &output_name,
+		&marginals, &extras, &histout, &densityout, &marginalout, &extraout,
+		format, densityformat]
+		(size_t point) -> bool
+	{
+		bool opened{ true };
+		if(!group.isRoot())
+			return group.all(opened);
+
+		const string histfilename{ output_name(parser.outputFileName(), point) };
+		histout.open(histfilename,
+			format == molstat::HistogramFormat::Text ? std::ios_base::out :
+			std::ios_base::out | std::ios_base::binary);
+		if(!histout)
+		{
+			output << "FATAL ERROR: Unable to open \"" << histfilename <<
+				"\" for output." << endl;
+			opened = false;
+		}
+
+		// HDF5 files are written by the HDF5 library; opening the stream only
+		// checks that the file can be created
+		else if(format == molstat::HistogramFormat::HDF5)
+			histout.close();
+
+		if(opened && !parser.densityFileName().empty())
+		{
+			const string densityfilename{
+				output_name(parser.densityFileName(), point) };
+			densityout.open(densityfilename,
+				densityformat == molstat::HistogramFormat::Text ?
+				std::ios_base::out : std::ios_base::out | std::ios_base::binary);
+			if(!densityout)
+			{
+				output << "FATAL ERROR: Unable to open \"" << densityfilename <<
+					"\" for output." << endl;
+				opened = false;
+			}
+		}
+
+		for(size_t m = 0; m < marginalout.size() && opened; ++m)
+		{
+			const string marginalfilename{
+				output_name(marginals[m].filename, point) };
+			marginalout[m].open(marginalfilename,
+				marginals[m].format == molstat::HistogramFormat::Text ?
+				std::ios_base::out : std::ios_base::out | std::ios_base::binary);
+			if(!marginalout[m])
+			{
+				output << "FATAL ERROR: Unable to open \"" << marginalfilename <<
+					"\" for output." << endl;
+				opened = false;
+			}
+		}
+
+		for(size_t e = 0; e < extraout.size() && opened; ++e)
+		{
+			const string extrafilename{
+				output_name(extras[e].filename, point) };
+			extraout[e].open(extrafilename,
+				extras[e].format == molstat::HistogramFormat::Text ?
+				std::ios_base::out :
+				std::ios_base::out | std::ios_base::binary);
+			if(!extraout[e])
+			{
+				output << "FATAL ERROR: Unable to open \"" << extrafilename <<
+					"\" for output." << endl;
+				opened = false;
+			}
+			else if(extras[e].format == molstat::HistogramFormat::HDF5)
+				extraout[e].close();
+		}
+
+		return group.all(opened);
+	};
+	if(!open_outputs(0))
+		return 1;
+
+	// open the raw sample file, if requested
+	// with several processes, each writes its own file (the process number
+	// is appended to the name)
+	ofstream sampleout;
+	string samplefilename{ parser.sampleFileName() };
+	if(!samplefilename.empty())
+	{
+		if(group.size() > 1)
+			samplefilename += "." + to_string(group.rank());
+
+		sampleout.open(samplefilename,
+			std::ios_base::out | std::ios_base::binary);
+		if(!sampleout)
+			cout << "FATAL ERROR: Unable to open \"" << samplefilename <<
+				"\" for output." << endl;
+	}
+	if(!group.all(!sampleout.fail()))
+		return 1;
+
+	// print the simulator information
+	parser.printState(info);
+	if(group.size() > 1)
+		info << "The trials are divided among " << group.size() <<
+			" processes." << endl;
 
 	// create the histogram object
 	// first need the bin styles to determine the dimensionality
@@ -116,68 +976,1695 @@ int main(int argc, char **argv)
 			bstyles[j] = nonconst[j];
 	} // this was necessary to add const to the pointer
 
-	molstat::Histogram hist(bstyles.size());
+	// when simulating traces, the first dimension of the histogram is the
+	// displacement, with one (linear) bin per point
+	const shared_ptr<const molstat::TraceProtocol> trace
+		{ parser.getTraceProtocol() };
+	const size_t npoints{ trace == nullptr ? 1 : trace->numPoints() };
+	if(trace != nullptr)
+	{
+		const auto range = trace->getDisplacementRange();
+		const double halfwidth{ npoints == 1 ? 0.5 :
+			0.5 * (range.second - range.first) / (npoints - 1) };
 
-	// Get the requested number of samples
-	// count the number of trials that don't emit the observable
-	size_t no_obs { 0 };
-	for (size_t j = 0; j < ntrials; ++j)
+		shared_ptr<molstat::BinStyle> zstyle
+			{ make_shared<molstat::BinLinear>(npoints) };
+		zstyle->setBounds(range.first - halfwidth, range.second + halfwidth);
+		bstyles.insert(bstyles.begin(), zstyle);
+	}
+
+	// if every dimension has fixed bounds, bin the data as it is generated
+	// (streaming); otherwise, store all of the data and bin it at the end
+	bool streaming{ !bstyles.empty() };
+	for(const auto &bstyle : bstyles)
+		streaming = streaming && bstyle != nullptr && bstyle->hasBounds();
+
+	// checkpoints hold the bin counts, which requires fixed bounds
+	const string checkpointfilename{ parser.checkpointFileName().empty() ?
+		"" : checkpoint_name(group.rank()) };
+	if(!checkpointfilename.empty() && !streaming)
+	{
+		output << "FATAL ERROR: Checkpoints require fixed bounds for every " \
+			"observable." << endl;
+		return 1;
+	}
+
+	// so does checking the histogram for convergence during the simulation
+	const double tolerance{ parser.convergenceTolerance() };
+	if(tolerance > 0. && !streaming)
+	{
+		output << "FATAL ERROR: Convergence checks require fixed bounds for " \
+			"every observable." << endl;
+		return 1;
+	}
+
+	// importance sampling accumulates the weights of the trials in the bins,
+	// which also requires fixed bounds. the weights are not kept in the
+	// checkpoints or the raw samples.
+	const bool weighted{ sim->isWeighted() };
+	if(weighted)
+	{
+		string error;
+		if(!streaming)
+			error = "Importance sampling requires fixed bounds for every " \
+				"observable.";
+		else if(!checkpointfilename.empty())
+			error = "Checkpoints cannot be written with importance sampling.";
+		else if(sampleout.is_open())
+			error = "The raw samples cannot be written with importance " \
+				"sampling.";
+
+		if(!error.empty())
+		{
+			output << "FATAL ERROR: " << error << endl;
+			return 1;
+		}
+	}
+
+	// the kernel density estimate needs a bandwidth for every dimension
+	// (including the displacement of traces), if any are specified
+	const vector<double> bandwidths{ parser.densityBandwidths() };
+	if(!bandwidths.empty() && bandwidths.size() != bstyles.size())
+	{
+		output << "FATAL ERROR: The kernel density estimate requires a " \
+			"bandwidth for each of the " << bstyles.size() << " dimension(s)." <<
+			endl;
+		return 1;
+	}
+
+	// the marginal histograms must keep (and slice) dimensions of the
+	// histogram (including the displacement of traces)
+	for(const auto &marginal : marginals)
 	{
 		try
 		{
-			// add the data to the list
-			hist.add_data(sim->simulate(engine));
+			molstat::CheckMarginalSpec(marginal.spec, bstyles.size());
 		}
-		catch(const molstat::NoObservableProduced &e)
+		catch(const invalid_argument &e)
 		{
-			// one of the observables was not emitted for the randomly generated
-			// parameters
-			++no_obs;
+			output << "FATAL ERROR: Marginal histogram \"" << marginal.filename <<
+				"\": " << e.what() << endl;
+			return 1;
 		}
 	}
 
-	// print out the number of trials that did not produce an observable
-	cout << '\n' << no_obs << " of the " << ntrials << " trials (" <<
-		(100. * no_obs / ntrials) << "%) did not produce an observable.\n" <<
-		(ntrials - no_obs) << " of the " << ntrials << " trials (" <<
-		(100. * (ntrials - no_obs) / ntrials) <<
-		"%) were binned into a histogram." << endl;
+	// the additional histograms bin observables (or the displacement of
+	// traces) of the same trials, each with its own bins. they are not kept
+	// in the checkpoints.
+	vector<vector<size_t>> extra_columns(extras.size());
+	{
+		vector<string> columns{ parser.getObservableNames() };
+		if(trace != nullptr)
+			columns.insert(columns.begin(), "displacement");
+
+		for(size_t e = 0; e < extras.size(); ++e)
+			for(const string &name : extras[e].observables)
+			{
+				const auto found = find(columns.begin(), columns.end(), name);
+				if(found == columns.end())
+				{
+					output << "FATAL ERROR: Histogram \"" <<
+						extras[e].filename << "\": \"" << name << "\" is " \
+						"not an observable of the simulation." << endl;
+					return 1;
+				}
+				extra_columns[e].push_back(found - columns.begin());
+			}
+	}
+	if(!extras.empty() && !checkpointfilename.empty())
+	{
+		output << "FATAL ERROR: Checkpoints cannot be written with " \
+			"additional histograms." << endl;
+		return 1;
+	}
+
+	// the raw samples are written in the background as they are simulated
+	// (with traces, each point is a sample, and the displacement is first)
+	unique_ptr<molstat::SampleWriter> samples{ nullptr };
+	const bool write_params{ parser.sampleParameters() };
+	if(write_params)
+		// the written parameters must all be sampled
+		sim->setParameterPruning(false);
+	if(sampleout.is_open())
+	{
+		if(trace != nullptr && write_params)
+		{
+			output << "FATAL ERROR: The model parameters cannot be written with " \
+				"the raw samples of traces." << endl;
+			return 1;
+		}
+
+		vector<string> value_names{ parser.getObservableNames() };
+		if(trace != nullptr)
+			value_names.insert(value_names.begin(), "displacement");
+
+		samples.reset(new molstat::SampleWriter(sampleout, value_names,
+			write_params ? sim->getParameterNames() : vector<string>{}));
+	}
+
+	// one pool of threads for the calibration and every round of trials
+	molstat::TaskScheduler scheduler{ parser.numThreads(),
+		parser.pinThreads() };
+
+	// a calibration first tunes the distributions to the target histogram
+	// (from short simulations, binned as they are generated); the full
+	// simulation then uses the calibrated distributions
+	molstat::NelderMeadResult calibration;
+	if(!parser.calibrationFileName().empty())
+	{
+		if(!streaming)
+		{
+			output << "FATAL ERROR: Calibrations require fixed bounds for " \
+				"every observable." << endl;
+			return 1;
+		}
+		if(!calibrate(group, parser, *sim, bstyles, scheduler, output, info,
+			calibration))
+		{
+			return 1;
+		}
+	}
 
-	// make the histogram
-	// if we encounter a bad dimension -- specifically, one where there is no
-	// range of data (all trials yield the same value) and more than one bin
-	// is specified -- override the binstyle for that dimension and try again
-	bool binned { false };
-	do
+	// with a sweep, simulate each value of the sweep variable in turn; the
+	// model is reused, with its distributions set for each value
+	const bool all_fixed{ streaming };
+	const vector<shared_ptr<const molstat::BinStyle>> all_styles{ bstyles };
+	unique_ptr<molstat::VariatePool> pool{ nullptr };
+	unique_ptr<molstat::ContributionCache> cache{ nullptr };
+	for(size_t point = 0; point < max<size_t>(1, sweep_values.size());
+		++point)
 	{
+		if(!sweep_values.empty())
+		{
+			bool swept{ true };
+			try
+			{
+				parser.applySweep(*sim, point);
+			}
+			catch(const exception &e)
+			{
+				output << "FATAL ERROR: " << e.what() << endl;
+				swept = false;
+			}
+			if(!group.all(swept) || (point > 0 && !open_outputs(point)))
+				return 1;
+
+			info << "\n===== Sweep " << (point + 1) << " of " <<
+				sweep_values.size() << ": " << parser.sweepName() << " = " <<
+				sweep_values[point] << " =====" << endl;
+		}
+
+		// each value starts from the same bins
+		streaming = all_fixed;
+		bstyles = all_styles;
+
+		// divide the trials among the processes and then into blocks (by
+		// default, one per thread). each block has its own engine (a separate
+		// stream from the same seed), its own histogram, and its own count of
+		// trials that don't emit the observable. the threads simulate the
+		// blocks, which are combined (in order) once all threads finish.
+		const TrialBlocks blocks{ divide_trials(group, parser, ntrials) };
+		const size_t first_trial{ blocks.first_trial };
+		const size_t local_trials{ blocks.local_trials };
+		const size_t nblocks{ blocks.begin.size() };
+		const size_t nthreads{ min(parser.numThreads(), nblocks) };
+
+		// with a pool of base variates, this process's trials are drawn once
+		// and reused for every value of a sweep
+		if(parser.samplingMethod() == SimulatorInputParse::SamplingMethod::Pool
+			&& pool == nullptr)
+		{
+			pool = make_pool(group, parser, *sim, local_trials);
+			info << "The pool of base variates has " << pool->dimension() <<
+				" dimension(s) and takes " <<
+				(pool->memoryUsage() / 1048576.) << " MiB" <<
+				(group.size() > 1 ? " (per process)." : ".") << endl;
+
+			// the submodel terms of the trials are kept for the next value
+			if(parser.incrementalPool())
+			{
+				cache.reset(new molstat::ContributionCache(*sim, local_trials));
+				info << "The cache of submodel terms takes " <<
+					(cache->memoryUsage() / 1048576.) << " MiB" <<
+					(group.size() > 1 ? " (per process)." : ".") << endl;
+			}
+		}
+
+		// without fixed bounds, the data of every trial are stored until the
+		// end. if they would exceed the memory limit, the bounds are instead
+		// found with a pilot run (of fewer trials, if need be), so that the
+		// data are binned as they are generated. the estimate uses the most
+		// trials of any process, so that every process decides alike.
+		const size_t memory_limit{ parser.memoryLimit() };
+		double pilot_fraction{ parser.pilotFraction() };
+		bool memory_pilot{ false };
+		if(!streaming && memory_limit > 0)
+		{
+			const double stored{ static_cast<double>(sizeof(double)) *
+				((ntrials + group.size() - 1) / group.size()) * npoints *
+				bstyles.size() };
+			if(stored > memory_limit)
+			{
+				memory_pilot = true;
+				pilot_fraction = min(pilot_fraction > 0. ? pilot_fraction :
+					0.01, 0.5 * memory_limit / stored);
+				info << "Storing the data would take " << (stored / 1048576.) <<
+					" MiB, more than the memory limit; the bounds are found " \
+					"with a pilot run of " << pilot_fraction << " of the " \
+					"trials instead." << endl;
+			}
+		}
+
+		// for the few models whose observable has a closed-form distribution,
+		// the histogram is instead the expected counts of the bins (from the
+		// distribution's CDF at the bin edges), and no trials are simulated.
+		// the trials are simulated if anything is unsupported.
+		molstat::AnalyticCDF analytic_cdf;
+		if(parser.analyticHistogram())
+		{
+			string reason;
+			shared_ptr<const molstat::AnalyticSolver> solver{ nullptr };
+#if BUILD_TRANSPORT_SIMULATOR
+			solver = make_shared<molstat::transport::AnalyticChannelSolver>();
+#endif
+
+			if(solver == nullptr)
+				reason = "No model has a closed-form distribution.";
+			else if(bstyles.size() != 1)
+				reason = "Only histograms of one observable are calculated.";
+			else if(!streaming)
+				reason = "The observable needs fixed bounds.";
+			else if(trace != nullptr)
+				reason = "Traces are always simulated.";
+			else if(weighted)
+				reason = "Importance sampling is not supported.";
+			else if(write_params || samples != nullptr)
+				reason = "Raw samples need simulated trials.";
+			else if(!extras.empty())
+				reason = "Additional histograms need simulated trials.";
+			else if(!checkpointfilename.empty() || tolerance > 0. ||
+				parser.profileInterval() > 0)
+				reason = "Checkpoints, convergence checks, and profiles need " \
+					"simulated trials.";
+			else
+			{
+				try
+				{
+					const molstat::DeviceProgram program
+						{ molstat::DeviceSimulator::translate(*sim, 0) };
+					analytic_cdf = solver->getCDF(program, 0, reason);
+				}
+				catch(const invalid_argument &e)
+				{
+					reason = e.what();
+				}
+			}
+
+			if(analytic_cdf)
+				info << "The histogram is calculated from the exact " \
+					"distribution of the observable." << endl;
+			else
+				info << "The trials are simulated. " << reason << endl;
+		}
+
+		// with many bins (and threads), the threads instead share the bin counts
+		// of one (streaming) histogram. checkpoints need each thread's counts,
+		// as does importance sampling (the shared bins are not weighted).
+		size_t nbins{ 1 };
+		if(streaming)
+			for(const auto &bstyle : bstyles)
+				nbins *= bstyle->nbins;
+		const bool shared_bins{ streaming && checkpointfilename.empty() &&
+			!weighted && !analytic_cdf &&
+			molstat::SharedHistogram::preferred(nbins, nblocks,
+				memory_limit > 0 ? min(memory_limit,
+				molstat::SharedHistogram::private_memory_limit) :
+				molstat::SharedHistogram::private_memory_limit) };
+
+		vector<molstat::Histogram> thread_hists;
+		thread_hists.reserve(nblocks);
+		for(size_t t = 0; t < (shared_bins ? 1 : nblocks); ++t)
+		{
+			if(streaming)
+				thread_hists.emplace_back(bstyles);
+			else
+				thread_hists.emplace_back(bstyles.size());
+
+			if(weighted)
+				thread_hists.back().useWeights();
+		}
+		// with pinned threads, the threads of each NUMA node share a replica of
+		// the counts in the node's memory
+		const size_t nreplicas{ shared_bins && parser.pinThreads() ?
+			min(molstat::NumaNodeCount(), nthreads) : 1 };
+		unique_ptr<molstat::SharedHistogram> shared_hist{ shared_bins ?
+			new molstat::SharedHistogram(thread_hists[0], nreplicas) :
+			nullptr };
+		if(shared_bins)
+		{
+			info << "The " << nthreads << " threads share one histogram (" <<
+				nbins << " bins";
+			if(nreplicas > 1)
+				info << ", with a copy of the counts on each of the " <<
+					nreplicas << " NUMA nodes";
+			info << ")." << endl;
+		}
+		// each block's additional histograms (which always have fixed bounds)
+		// and its buffer for their columns of the data
+		vector<vector<molstat::Histogram>> extra_hists(nblocks);
+		for(size_t t = 0; t < nblocks; ++t)
+			for(const auto &extra : extras)
+			{
+				extra_hists[t].emplace_back(
+					vector<shared_ptr<const molstat::BinStyle>>(
+						extra.bstyles.begin(), extra.bstyles.end()));
+				if(weighted)
+					extra_hists[t].back().useWeights();
+			}
+		vector<vector<double>> extra_buffers(nblocks);
+		const size_t ncolumns{ bstyles.size() };
+
+		vector<size_t> thread_no_obs(nblocks, 0);
+		const size_t nobs{ sim->numObservables() };
+		vector<vector<size_t>> thread_rejections(nblocks,
+			vector<size_t>(nobs, 0));
+		vector<exception_ptr> thread_errors(nblocks, nullptr);
+
+		// the sums of the importance weights (and their squares) of each
+		// thread's binned trials, for the effective sample size
+		vector<array<double, 2>> thread_weights(nblocks, {{ 0., 0. }});
+
+		// closed-form transport models can run their trials on a GPU instead.
+		// the parameters come from counter-based random numbers keyed by the
+		// seed and stream, so they depend only on the (global) trial number.
+		// the simulation stays on the CPU if anything is unsupported.
+		unique_ptr<molstat::DeviceSimulator> device{ nullptr };
+		if(parser.useGPU() && !analytic_cdf)
+		{
+			string reason;
+			shared_ptr<const molstat::DeviceBackend> backend{ nullptr };
+#if BUILD_TRANSPORT_SIMULATOR
+			backend = molstat::transport::GetGPUChannelBackend();
+#endif
+
+			if(backend == nullptr)
+				reason = "No GPU is available.";
+			else if(trace != nullptr)
+				reason = "Traces are not simulated on the GPU.";
+			else if(parser.samplingMethod() !=
+				SimulatorInputParse::SamplingMethod::Random)
+				reason = "Only random sampling is supported on the GPU.";
+			else if(write_params)
+				reason = "The model parameters cannot be written from the GPU.";
+			else
+			{
+				seed_seq seq{ parser.seed() & 0xFFFFFFFFu, parser.seed() >> 32,
+					parser.stream() & 0xFFFFFFFFu, parser.stream() >> 32,
+					molstat::Engine::result_type(0xDE71CE) };
+				array<uint32_t, 2> key;
+				seq.generate(key.begin(), key.end());
+
+				try
+				{
+					device.reset(new molstat::DeviceSimulator(*sim, backend,
+						(uint64_t(key[1]) << 32) | key[0]));
+				}
+				catch(const invalid_argument &e)
+				{
+					reason = e.what();
+				}
+			}
+
+			if(device != nullptr)
+				info << "Simulating on the GPU: " << device->info() << endl;
+			else
+				info << "Simulating on the CPU. " << reason << endl;
+		}
+
+		// the number of trials simulated at once by each thread (a GPU needs
+		// many trials at once)
+		const size_t batch_size{ device != nullptr ? size_t(65536) : 1024 };
+
+		// each thread times a sample of its batches (or traces) when profiling
+		const size_t profile_interval{ parser.profileInterval() };
+		vector<molstat::SimulatorProfile> thread_profiles;
+		if(profile_interval > 0)
+			thread_profiles.assign(nblocks,
+				molstat::SimulatorProfile(nobs, profile_interval));
+
+		// the engine from which each block's stream is derived
+		// the seed and substream (job) number select an independently seeded
+		// engine, so the results depend only on them and the blocks (by
+		// default, the numbers of processes and threads). each process uses a
+		// disjoint set of streams.
+		const molstat::Engine base_engine{ parser.seed(), parser.stream(),
+			parser.engineKind() };
+
+		// each block's (contiguous) trials and its own (non-overlapping) stream
+		vector<size_t> thread_begin{ blocks.begin }, thread_end{ blocks.end };
+		if(analytic_cdf)
+			thread_end = thread_begin;
+		vector<molstat::Engine> thread_engines{ block_engines(blocks,
+			base_engine) };
+		const vector<size_t> thread_start{ thread_begin };
+
+		// with quasi-Monte Carlo sampling, every thread and process samples
+		// its (global) trials from the same Sobol sequence. its random shift
+		// comes from an engine seeded apart from the threads' streams, so that
+		// it does not depend on the numbers of threads and processes.
+		unique_ptr<molstat::SobolSequence> sobol{ nullptr };
+		const SimulatorInputParse::SamplingMethod sampling
+			{ parser.samplingMethod() };
+		if(sampling == SimulatorInputParse::SamplingMethod::Sobol)
+		{
+			seed_seq seq{ parser.seed() & 0xFFFFFFFFu, parser.seed() >> 32,
+				parser.stream() & 0xFFFFFFFFu, parser.stream() >> 32,
+				molstat::Engine::result_type(0x50B01) };
+			sobol.reset(new molstat::SobolSequence(max<size_t>(1,
+				min(sim->numQuasiRandomDimensions(),
+				molstat::SobolSequence::max_dimension)),
+				molstat::Engine{ seq, parser.engineKind() }));
+		}
+
+		// the progress of a thread, for checkpoints
+		const auto snapshot = [&thread_hists, &thread_no_obs, &thread_rejections,
+			&bstyles] (size_t t, size_t next, const molstat::Engine &engine)
+			-> molstat::ThreadCheckpoint
+		{
+			molstat::ThreadCheckpoint ret;
+			ret.next_trial = next;
+
+			ostringstream state;
+			state << engine;
+			ret.engine = state.str();
+
+			ret.counts = thread_hists[t].getRawBinCounts();
+			ret.nout = thread_hists[t].numOutOfRange();
+			for(size_t j = 0; j < bstyles.size(); ++j)
+				ret.out_of_range.push_back({{ thread_hists[t].numUnderflow(j),
+					thread_hists[t].numOverflow(j) }});
+			ret.no_obs = thread_no_obs[t];
+			ret.rejections = thread_rejections[t];
+
+			return ret;
+		};
+
+		// start the checkpoints, resuming each thread's progress if requested
+		// a checkpoint is only resumed by the same simulation (the same seed,
+		// trials, processes, threads, and bins)
+		unique_ptr<molstat::CheckpointWriter> checkpoints{ nullptr };
+		size_t resumed_trials{ 0 };
+		if(!checkpointfilename.empty())
+		{
+			ostringstream desc;
+			desc.precision(17);
+			desc << molstat::EngineKindName(parser.engineKind()) << " stream " <<
+				parser.stream() << ", " << ntrials << " trials of " << npoints <<
+				" point(s), process " << group.rank() << " of " << group.size() <<
+				", " << nblocks << (parser.numBlocks() == 0 ? " thread(s), " :
+				" block(s), ") << nobs << " observable(s)";
+			if(tolerance > 0.)
+				desc << ", convergence to " << tolerance << " every " <<
+					parser.convergenceInterval() << " trials";
+			for(const auto &bstyle : bstyles)
+			{
+				const auto bounds = bstyle->getBounds();
+				desc << '\n' << bstyle->info() << " in [" << bounds[0] << ", " <<
+					bounds[1] << ']';
+			}
+
+			molstat::Checkpoint ckpt;
+			ckpt.seed = parser.seed();
+			ckpt.description = desc.str();
+
+			bool started{ true };
+			try
+			{
+				if(parser.resume() && ifstream(checkpointfilename).good())
+				{
+					const molstat::Checkpoint saved
+						{ molstat::ReadCheckpoint(checkpointfilename) };
+					if(saved.seed != ckpt.seed ||
+						saved.description != ckpt.description ||
+						saved.threads.size() != nblocks)
+					{
+						throw runtime_error("The checkpoint \"" + checkpointfilename +
+							"\" is from a different simulation.");
+					}
+
+					for(size_t t = 0; t < nblocks; ++t)
+					{
+						const molstat::ThreadCheckpoint &state = saved.threads[t];
+
+						istringstream engine_state(state.engine);
+						engine_state >> thread_engines[t];
+						if(!engine_state || state.next_trial < thread_begin[t] ||
+							state.next_trial > thread_end[t] ||
+							state.rejections.size() != nobs)
+						{
+							throw runtime_error("The checkpoint \"" +
+								checkpointfilename + "\" is corrupt.");
+						}
+
+						thread_hists[t].setRawBinCounts(state.counts, state.nout,
+							state.out_of_range);
+						thread_no_obs[t] = state.no_obs;
+						thread_rejections[t] = state.rejections;
+
+						resumed_trials += state.next_trial - thread_begin[t];
+						thread_begin[t] = state.next_trial;
+					}
+				}
+
+				for(size_t t = 0; t < nblocks; ++t)
+					ckpt.threads.push_back(snapshot(t, thread_begin[t],
+						thread_engines[t]));
+				checkpoints.reset(new molstat::CheckpointWriter(checkpointfilename,
+					move(ckpt), parser.checkpointInterval()));
+			}
+			catch(const exception &e)
+			{
+				cout << "FATAL ERROR: " << e.what() << endl;
+				started = false;
+			}
+			if(!group.all(started))
+				return 1;
+
+			vector<size_t> resumed{ resumed_trials };
+			group.sumToRoot(resumed);
+			if(resumed[0] > 0)
+				info << "Resuming from the checkpoint: " << resumed[0] <<
+					" of the " << ntrials << (trace == nullptr ? " trials" :
+					" traces") << " were already simulated." << endl;
+		}
+
+		// with pinned threads, the bin counts of each thread's histograms are
+		// moved to the memory of the node that bins its data (the simulating
+		// thread, or its binning thread with a pipeline) on the first addition
+		vector<unsigned char> localized(nblocks, !parser.pinThreads());
+
+		// adds the data from a thread to its histogram (or the shared one) and
+		// its additional histograms, with the importance weights (if not
+		// nullptr)
+		const auto add_data = [&thread_hists, &shared_hist, &extra_hists,
+			&extra_columns, &extra_buffers, &localized, ncolumns]
+			(size_t t, const double *v, const double *w, size_t n) -> void
+		{
+			if(!localized[t])
+			{
+				if(shared_hist == nullptr)
+					thread_hists[t].localize();
+				for(molstat::Histogram &extra : extra_hists[t])
+					extra.localize();
+				localized[t] = 1;
+			}
+
+			if(shared_hist != nullptr)
+				shared_hist->add_data(v, n);
+			else if(w != nullptr)
+				thread_hists[t].add_data(v, w, n);
+			else
+				thread_hists[t].add_data(v, n);
+
+			// gather the columns of each additional histogram
+			vector<double> &buffer = extra_buffers[t];
+			for(size_t e = 0; e < extra_hists[t].size(); ++e)
+			{
+				const vector<size_t> &columns = extra_columns[e];
+				const size_t ndim{ columns.size() };
+				buffer.resize(n * ndim);
+				for(size_t k = 0; k < n; ++k)
+					for(size_t j = 0; j < ndim; ++j)
+						buffer[k*ndim + j] = v[k*ncolumns + columns[j]];
+
+				if(w != nullptr)
+					extra_hists[t][e].add_data(buffer.data(), w, n);
+				else
+					extra_hists[t][e].add_data(buffer.data(), n);
+			}
+		};
+
+		// with a pipeline, the threads simulate batches into bounded rings and
+		// dedicated threads bin them (and write the raw samples). each thread's
+		// batches are binned in order, so the histograms are unchanged.
+		unique_ptr<molstat::BatchPipeline> pipeline{ nullptr };
+		if(parser.pipelineBinners() > 0)
+		{
+			if(trace != nullptr)
+				info << "Traces are not pipelined; each thread bins its own " \
+					"data." << endl;
+			else if(checkpoints != nullptr)
+				info << "Checkpointed simulations are not pipelined; each " \
+					"thread bins its own data." << endl;
+			else
+			{
+				// the binning threads are pinned to the CPUs after those of the
+				// simulating threads
+				vector<int> cpus;
+				if(parser.pinThreads())
+				{
+					const vector<int> order{ molstat::NumaCpuOrder() };
+					for(size_t c = 0; c < parser.pipelineBinners() &&
+						!order.empty(); ++c)
+						cpus.push_back(order[(nthreads + c) % order.size()]);
+				}
+
+				pipeline.reset(new molstat::BatchPipeline(nblocks,
+					parser.pipelineBinners(), parser.pipelineDepth(),
+					[&add_data, &samples, weighted]
+					(size_t t, const molstat::TrialBatch &batch) -> void
+					{
+						add_data(t, batch.values.data(),
+							weighted ? batch.weights.data() : nullptr, batch.n);
+						if(samples != nullptr)
+							samples->write(batch.values.data(),
+								batch.params.data(), batch.n);
+					}, cpus));
+			}
+		}
+
+		// the trials each thread simulates next (when checking for convergence,
+		// only a round of its trials)
+		vector<size_t> thread_next{ thread_begin }, thread_stop{ thread_end };
+
+		const auto run_trials = [&sim, &add_data, &thread_no_obs,
+			&thread_rejections, &thread_errors, &thread_profiles,
+			&thread_engines, &thread_next, &thread_stop, &checkpoints, &snapshot,
+			&trace, &samples, &sobol, &pool, &cache, &device, &pipeline,
+			&thread_weights, write_params, weighted, sampling, npoints, nobs,
+			batch_size, first_trial]
+			(const size_t t) -> void
+		{
+			try
+			{
+				molstat::Engine &engine = thread_engines[t];
+				const size_t first{ thread_next[t] }, last{ thread_stop[t] };
+
+				if(trace != nullptr)
+				{
+					// each trial is a trace; each point has the displacement and
+					// the observables
+					vector<double> points(npoints * (nobs + 1));
+
+					for(size_t j = first; j < last; ++j)
+					{
+						molstat::SimulatorTimings *const timings
+							{ thread_profiles.empty() ? nullptr :
+							  thread_profiles[t].next() };
+
+						const size_t nvalid{ sim->simulateTrace(engine, *trace,
+							points.data(), thread_rejections[t].data(), timings) };
+						thread_no_obs[t] += npoints - nvalid;
+
+						molstat::ProfileClock::time_point start;
+						if(timings != nullptr)
+							start = molstat::ProfileClock::now();
+						add_data(t, points.data(), nullptr, nvalid);
+						if(samples != nullptr)
+							samples->write(points.data(), nullptr, nvalid);
+						if(timings != nullptr)
+							timings->binning += molstat::LapSeconds(start);
+
+						// save the progress periodically (and at the end)
+						if(checkpoints != nullptr &&
+							(j + 1 == last || checkpoints->due(t)))
+						{
+							checkpoints->update(t, snapshot(t, j + 1, engine));
+						}
+					}
+
+					return;
+				}
+
+				// simulate the trials in batches; the buffers are reused (with
+				// a pipeline, those of the free batch in the thread's ring)
+				vector<double> observables(pipeline != nullptr ? 0 :
+					batch_size * nobs);
+				vector<double> workspace;
+				vector<double> params(write_params && pipeline == nullptr ?
+					batch_size * sim->numParameters() : 0);
+				vector<double> weights(weighted && pipeline == nullptr ?
+					batch_size : 0);
+
+				for(size_t j = first; j < last; j += batch_size)
+				{
+					const size_t n{ min(batch_size, last - j) };
+					molstat::SimulatorTimings *const timings
+						{ thread_profiles.empty() ? nullptr :
+						  thread_profiles[t].next() };
+
+					// with a pipeline, the time waiting for a free batch counts
+					// as binning
+					molstat::ProfileClock::time_point start;
+					if(timings != nullptr)
+						start = molstat::ProfileClock::now();
+					molstat::TrialBatch *const batch{ pipeline == nullptr ?
+						nullptr : &pipeline->acquire(t) };
+					if(batch != nullptr)
+					{
+						batch->values.resize(batch_size * nobs);
+						batch->params.resize(write_params ?
+							batch_size * sim->numParameters() : 0);
+						batch->weights.resize(weighted ? batch_size : 0);
+						if(timings != nullptr)
+							timings->binning += molstat::LapSeconds(start);
+					}
+					vector<double> &vbuf = batch == nullptr ? observables :
+						batch->values;
+					vector<double> &pbuf = batch == nullptr ? params :
+						batch->params;
+					vector<double> &wbuf = batch == nullptr ? weights :
+						batch->weights;
+
+					// trials where one of the observables was not emitted for the
+					// randomly generated parameters are discarded. the trial
+					// numbers are global, so the points of the Sobol sequence do
+					// not depend on the threads or a resumed checkpoint.
+					size_t nvalid;
+					double *const pptr{ write_params ? pbuf.data() : nullptr };
+					double *const wptr{ weighted ? wbuf.data() : nullptr };
+					if(device != nullptr)
+						nvalid = device->simulateBatch(j, n, vbuf.data(),
+							thread_rejections[t].data());
+					else if(sobol != nullptr)
+						nvalid = sim->simulateBatchQMC(*sobol, j, engine, n,
+							vbuf.data(), workspace, thread_rejections[t].data(),
+							timings, pptr, wptr);
+					else if(pool != nullptr)
+						nvalid = sim->simulateBatchPooled(*pool,
+							j - first_trial, engine, n, vbuf.data(), workspace,
+							thread_rejections[t].data(), timings, pptr, wptr,
+							cache.get());
+					else if(sampling ==
+						SimulatorInputParse::SamplingMethod::LatinHypercube)
+						nvalid = sim->simulateBatchLHS(engine, n, vbuf.data(),
+							workspace, thread_rejections[t].data(), timings,
+							pptr, wptr);
+					else
+						nvalid = sim->simulateBatch(engine, n, vbuf.data(),
+							workspace, thread_rejections[t].data(), timings,
+							pptr, wptr);
+					thread_no_obs[t] += n - nvalid;
+					for(size_t k = 0; k < (weighted ? nvalid : 0); ++k)
+					{
+						thread_weights[t][0] += wbuf[k];
+						thread_weights[t][1] += wbuf[k] * wbuf[k];
+					}
+
+					// pass the batch on to be binned (pipelines are not used
+					// with checkpoints)
+					if(batch != nullptr)
+					{
+						batch->n = nvalid;
+						pipeline->submit(t);
+						continue;
+					}
+
+					// add the data to the histogram (and the raw samples)
+					if(timings != nullptr)
+						start = molstat::ProfileClock::now();
+					add_data(t, vbuf.data(), wptr, nvalid);
+					if(samples != nullptr)
+						samples->write(vbuf.data(), pbuf.data(), nvalid);
+					if(timings != nullptr)
+						timings->binning += molstat::LapSeconds(start);
+
+					// save the progress periodically (and at the end)
+					if(checkpoints != nullptr &&
+						(j + n == last || checkpoints->due(t)))
+					{
+						checkpoints->update(t, snapshot(t, j + n, engine));
+					}
+				}
+			}
+			catch(...)
+			{
+				thread_errors[t] = current_exception();
+			}
+		};
+
+		// the raw bin counts (or sums of the weights) of all the threads, for
+		// convergence checks
+		const auto current_counts = [&thread_hists, &shared_hist]()
+			-> vector<double>
+		{
+			if(shared_hist != nullptr)
+				shared_hist->finish();
+
+			vector<double> ret{ thread_hists[0].getRawBinSums() };
+			for(size_t t = 1; t < thread_hists.size(); ++t)
+			{
+				const vector<double> counts{ thread_hists[t].getRawBinSums() };
+				for(size_t k = 0; k < ret.size(); ++k)
+					ret[k] += counts[k];
+			}
+			return ret;
+		};
+
+		// when checking for convergence, the trials are simulated in rounds of
+		// (about) the convergence interval. each thread simulates its share of a
+		// round, and the histogram (of all the processes) is then compared to
+		// that of the previous round; the simulation stops once they are within
+		// the tolerance. the rounds are aligned to the start of each thread's
+		// block of trials, so that resuming from a checkpoint keeps the rounds.
+		size_t round_trials{ tolerance > 0. ?
+			max<size_t>(1, parser.convergenceInterval() / blocks.total) :
+			ntrials };
+		vector<double> previous_counts;
+		if(tolerance > 0.)
+		{
+			previous_counts = current_counts();
+			group.sumToRoot(previous_counts);
+		}
+		double distance{ 1. };
+		bool converged{ false };
+
+		// the peak memory (bytes) of this process's stored data, histograms,
+		// pool of base variates, and cache, as measured after each round of
+		// trials and around the binning
+		size_t peak_memory{ 0 };
+		const auto track_memory = [&thread_hists, &extra_hists, &shared_hist,
+			&pool, &cache, &peak_memory] () -> void
+		{
+			size_t bytes{ (shared_hist == nullptr ? 0 :
+				shared_hist->memoryUsage()) +
+				(pool == nullptr ? 0 : pool->memoryUsage()) +
+				(cache == nullptr ? 0 : cache->memoryUsage()) };
+			for(const auto &hist : thread_hists)
+				bytes += hist.memoryUsage();
+			for(const auto &hists : extra_hists)
+				for(const auto &hist : hists)
+					bytes += hist.memoryUsage();
+			peak_memory = max(peak_memory, bytes);
+		};
+
+		// runs the current trials of every thread (each thread's trials, with
+		// its engine, are a task of the scheduler)
+		const auto run_threads = [&run_trials, &thread_next, &thread_stop,
+			&track_memory, &scheduler, &pipeline, &thread_errors, nblocks]
+			() -> void
+		{
+			scheduler.run(nblocks, [&run_trials] (size_t t, size_t) -> void
+				{
+					run_trials(t);
+				});
+
+			// the batches must be binned before the histograms are used
+			if(pipeline != nullptr)
+			{
+				try
+				{
+					pipeline->flush();
+				}
+				catch(...)
+				{
+					if(thread_errors[0] == nullptr)
+						thread_errors[0] = current_exception();
+				}
+			}
+			thread_next = thread_stop;
+			track_memory();
+		};
+
+		molstat::ProfileClock::time_point wall_start{
+			molstat::ProfileClock::now() };
+
+		// without fixed bounds, a pilot run (the first trials of each thread)
+		// can instead find the bounds, with a margin. the pilot data are then
+		// binned, and the rest of the data are binned as they are generated, in
+		// rounds of (about) the pilot size. the data outside the bounds are kept
+		// until the end of a round; if too many were outside, the bins are
+		// widened to include them.
+		bool piloted{ false };
+		if(!streaming && pilot_fraction > 0.)
+		{
+			const double fraction{ pilot_fraction };
+			size_t pilot_trials{ 0 };
+			for(size_t t = 0; t < nblocks; ++t)
+			{
+				thread_stop[t] = min(thread_end[t], thread_begin[t] + max<size_t>(1,
+					ceil(fraction * (thread_end[t] - thread_begin[t]))));
+				pilot_trials += thread_stop[t] - thread_begin[t];
+			}
+			run_threads();
+
+			// errors are reported below, once every process stops
+			bool ok{ true };
+			for(size_t t = 0; t < nblocks; ++t)
+				ok = ok && thread_errors[t] == nullptr;
+
+			if(group.all(ok))
+			{
+				// the extremes of the pilot data (from every process)
+				vector<array<double, 2>> extremes(bstyles.size(),
+					{{ numeric_limits<double>::max(),
+					   numeric_limits<double>::lowest() }});
+				for(size_t t = 0; t < nblocks; ++t)
+				{
+					const vector<array<double, 2>> local
+						{ thread_hists[t].getDataExtremes() };
+					for(size_t j = 0; j < bstyles.size(); ++j)
+					{
+						extremes[j][0] = min(extremes[j][0], local[j][0]);
+						extremes[j][1] = max(extremes[j][1], local[j][1]);
+					}
+				}
+				group.extremes(extremes);
+
+				// extend the (masked) extremes by the margin on each side; the
+				// fixed bounds are kept
+				vector<array<double, 2>> bounds(bstyles.size());
+				bool found{ true };
+				for(size_t j = 0; j < bstyles.size(); ++j)
+				{
+					if(bstyles[j]->hasBounds())
+					{
+						bounds[j] = bstyles[j]->getBounds();
+						continue;
+					}
+
+					const double lower{ bstyles[j]->mask(extremes[j][0]) },
+						upper{ bstyles[j]->mask(extremes[j][1]) };
+					if(!isfinite(lower) || !isfinite(upper) || lower > upper)
+					{
+						found = false;
+						continue;
+					}
+
+					const double margin{ upper > lower ?
+						parser.pilotMargin() * (upper - lower) : 0.5 };
+					bounds[j] = {{ bstyles[j]->invmask(lower - margin),
+						bstyles[j]->invmask(upper + margin) }};
+				}
+
+				// bin the pilot data with these bounds
+				vector<molstat::Histogram> streamed;
+				try
+				{
+					if(found)
+					{
+						streamed.reserve(nblocks);
+						for(size_t t = 0; t < nblocks; ++t)
+						{
+							streamed.emplace_back(bstyles, bounds);
+							streamed[t].retainOutOfRange(true);
+							streamed[t].add_stored(move(thread_hists[t]));
+						}
+					}
+				}
+				catch(const exception &e)
+				{
+					found = false;
+				}
+
+				vector<size_t> total{ pilot_trials };
+				group.sumToRoot(total);
+				if(group.all(found))
+				{
+					thread_hists.swap(streamed);
+					streaming = piloted = true;
+					round_trials = max<size_t>(1, ceil(fraction * ntrials /
+						blocks.total));
+
+					info << "The pilot run of " << total[0] << (trace == nullptr ?
+						" trials" : " traces") << " set the bounds:" << endl;
+					for(size_t j = 0; j < bstyles.size(); ++j)
+						info << "   Dimension " << j << ": [" << bounds[j][0] <<
+							", " << bounds[j][1] << ']' << endl;
+				}
+				else if(memory_pilot)
+				{
+					output << "FATAL ERROR: The pilot run could not set the " \
+						"bounds, and storing the data would exceed the " \
+						"memory limit." << endl;
+					return 1;
+				}
+				else
+					info << "The pilot run could not set the bounds; all of the " \
+						"data are stored instead." << endl;
+			}
+		}
+
+		// widens the bins (of every thread and process) to include the data kept
+		// outside them, if more than the allowed fraction of the data (of all
+		// the processes) were outside
+		const auto widen_bins = [&thread_hists, &thread_next, &thread_start,
+			&thread_no_obs, &bstyles, &group, &info, &parser, nblocks, npoints]
+			() -> void
+		{
+			vector<size_t> tallies{ 0, 0 };
+			for(size_t t = 0; t < nblocks; ++t)
+			{
+				tallies[0] += thread_hists[t].numRetained();
+				tallies[1] += (thread_next[t] - thread_start[t]) * npoints -
+					thread_no_obs[t];
+			}
+			group.sumToRoot(tallies);
+			if(group.all(!group.isRoot() ||
+				tallies[0] <= parser.pilotOverflow() * tallies[1]))
+			{
+				return;
+			}
+
+			// the (masked) extremes of the kept data; fixed bounds are not changed
+			vector<array<double, 2>> extremes(bstyles.size(),
+				{{ numeric_limits<double>::max(),
+				   numeric_limits<double>::lowest() }});
+			for(size_t t = 0; t < nblocks; ++t)
+			{
+				const vector<array<double, 2>> local
+					{ thread_hists[t].getRetainedExtremes() };
+				for(size_t j = 0; j < bstyles.size(); ++j)
+				{
+					if(bstyles[j]->hasBounds())
+						continue;
+					extremes[j][0] = min(extremes[j][0], local[j][0]);
+					extremes[j][1] = max(extremes[j][1], local[j][1]);
+				}
+			}
+			group.extremes(extremes);
+
+			// the kept data that still cannot be binned are discarded
+			bool changed{ false };
+			for(auto &hist : thread_hists)
+				changed = hist.widen(extremes) || changed;
+
+			info << tallies[0] << " of the " << tallies[1] << " data were " \
+				"outside the bounds; ";
+			if(!changed)
+			{
+				info << "the bins could not be widened to include them." << endl;
+				return;
+			}
+			info << "the bins were widened:" << endl;
+			for(size_t j = 0; j < bstyles.size(); ++j)
+			{
+				const array<double, 2> masked{ thread_hists[0].getMaskedBounds(j) };
+				info << "   Dimension " << j << ": [" <<
+					bstyles[j]->invmask(masked[0]) << ", " <<
+					bstyles[j]->invmask(masked[1]) << ']' << endl;
+			}
+		};
+
+		// with partial histograms, the histogram of the trials so far (of every
+		// thread and process) is written after each round, for front-ends to
+		// show while the simulation continues. the file is replaced at once, so
+		// it is never read half written. without convergence checks (or a
+		// pilot run), the rounds are the fraction of the trials, rounded up to
+		// whole batches so that the trials draw the same random numbers (and
+		// give the same histogram) as in one round.
+		const double progress{ parser.progressFraction() };
+		if(progress > 0.)
+		{
+			if(streaming && tolerance == 0. && !piloted)
+				round_trials = batch_size * max<size_t>(1,
+					ceil(progress * ntrials / blocks.total / batch_size));
+			else if(!streaming)
+				info << "Partial histograms need fixed bounds for every " \
+					"observable (or a pilot run); only the final histogram " \
+					"is written." << endl;
+		}
+		const auto write_progress = [&thread_hists, &shared_hist, &thread_next,
+			&thread_start, &thread_no_obs, &group, &parser, &output_name,
+			&bstyles, &trace, &info, &output, format, point, npoints, nblocks,
+			ntrials] () -> void
+		{
+			if(shared_hist != nullptr)
+				shared_hist->finish();
+
+			// the raw counts (and sums of the weights) of this process
+			molstat::Histogram partial{ thread_hists[0] };
+			partial.retainOutOfRange(false);
+			const size_t ndim{ partial.numDimensions() };
+			vector<size_t> counts{ partial.getRawBinCounts() };
+			vector<double> sums;
+			if(partial.isWeighted())
+				sums = partial.getRawBinSums();
+			size_t nout{ partial.numOutOfRange() };
+			vector<array<size_t, 2>> out_of_range(ndim);
+			for(size_t j = 0; j < ndim; ++j)
+				out_of_range[j] = {{ partial.numUnderflow(j),
+					partial.numOverflow(j) }};
+			for(size_t t = 1; t < thread_hists.size(); ++t)
+			{
+				const vector<size_t> more{ thread_hists[t].getRawBinCounts() };
+				for(size_t k = 0; k < counts.size(); ++k)
+					counts[k] += more[k];
+				if(partial.isWeighted())
+				{
+					const vector<double> sum{ thread_hists[t].getRawBinSums() };
+					for(size_t k = 0; k < sums.size(); ++k)
+						sums[k] += sum[k];
+				}
+				nout += thread_hists[t].numOutOfRange();
+				for(size_t j = 0; j < ndim; ++j)
+				{
+					out_of_range[j][0] += thread_hists[t].numUnderflow(j);
+					out_of_range[j][1] += thread_hists[t].numOverflow(j);
+				}
+			}
+			partial.setRawBinCounts(move(counts), nout, out_of_range);
+			if(partial.isWeighted())
+				partial.setRawBinSums(move(sums));
+			sum_histogram(group, partial);
+
+			vector<size_t> tallies{ 0, 0 };
+			for(size_t t = 0; t < nblocks; ++t)
+			{
+				tallies[0] += thread_next[t] - thread_start[t];
+				tallies[1] += thread_no_obs[t];
+			}
+			group.sumToRoot(tallies);
+			if(!group.isRoot())
+				return;
+
+			const size_t ntotal{ tallies[0] * npoints };
+			const string filename{ output_name(parser.progressFileName(),
+				point) };
+			const string temporary{ filename + ".tmp" };
+			ofstream out{ temporary, format == molstat::HistogramFormat::Text ?
+				std::ios_base::out :
+				std::ios_base::out | std::ios_base::binary };
+			if(!out)
+			{
+				output << "Unable to open \"" << temporary << "\" for the " \
+					"partial histogram." << endl;
+				return;
+			}
+			write_histogram(out, temporary, format, partial, bstyles, ntotal,
+				ntotal - tallies[1] - partial.numOutOfRange(), output);
+			if(rename(temporary.c_str(), filename.c_str()) != 0)
+			{
+				output << "Unable to write the partial histogram to \"" <<
+					filename << "\"." << endl;
+				return;
+			}
+
+			info << "Partial histogram of " << tallies[0] << " of the " <<
+				ntrials << (trace == nullptr ? " trials (" : " traces (") <<
+				(100. * tallies[0] / ntrials) << "%) written to \"" <<
+				filename << "\"." << endl;
+		};
+
+		// Get the requested number of samples
+		while(true)
+		{
+			for(size_t t = 0; t < nblocks; ++t)
+				thread_stop[t] = min(thread_end[t], thread_start[t] +
+					((thread_next[t] - thread_start[t]) / round_trials + 1) *
+					round_trials);
+			run_threads();
+
+			if(tolerance == 0. && !piloted && !(progress > 0. && streaming))
+				break;
+
+			// errors are reported below, once every process stops
+			bool ok{ true }, finished{ true };
+			for(size_t t = 0; t < nblocks; ++t)
+			{
+				ok = ok && thread_errors[t] == nullptr;
+				finished = finished && thread_next[t] == thread_end[t];
+			}
+			if(!group.all(ok))
+				break;
+			finished = group.all(finished);
+
+			if(piloted)
+				widen_bins();
+			if(progress > 0. && streaming && !finished)
+				write_progress();
+
+			if(piloted || tolerance == 0.)
+			{
+				if(finished)
+					break;
+				continue;
+			}
+
+			// compare the histogram to that of the previous round (on the root)
+			vector<double> counts{ current_counts() };
+			group.sumToRoot(counts);
+			if(group.isRoot())
+			{
+				distance = molstat::HellingerDistance(previous_counts, counts);
+				converged = distance <= tolerance;
+				previous_counts = move(counts);
+			}
+			converged = group.all(!group.isRoot() || converged);
+
+			if(converged || finished)
+				break;
+		}
+		pipeline.reset();
+		const double local_wall{ molstat::LapSeconds(wall_start) };
+
+		// write the final checkpoint; the histogram does not depend on it
+		if(checkpoints != nullptr)
+		{
+			try
+			{
+				checkpoints->close();
+			}
+			catch(const exception &e)
+			{
+				cout << "Unable to write the checkpoint: " << e.what() << endl;
+			}
+		}
+
+		// the data still outside the bounds after a pilot run are not needed
+		if(piloted)
+			for(auto &hist : thread_hists)
+				hist.retainOutOfRange(false);
+
+		// combine the results of each thread (into the histogram from thread 0)
+		size_t no_obs { 0 };
+		vector<size_t> rejections(nobs, 0);
+		bool simulated{ true };
 		try
 		{
-			hist.bin_data(bstyles);
-			binned = true;
+			for(size_t t = 0; t < nblocks; ++t)
+			{
+				if(thread_errors[t] != nullptr)
+					rethrow_exception(thread_errors[t]);
+
+				if(t > 0 && shared_hist == nullptr)
+					thread_hists[0].merge(move(thread_hists[t]));
+				for(size_t e = 0; t > 0 && e < extras.size(); ++e)
+					extra_hists[0][e].merge(move(extra_hists[t][e]));
+				no_obs += thread_no_obs[t];
+				for(size_t j = 0; j < nobs; ++j)
+					rejections[j] += thread_rejections[t][j];
+			}
+
+			if(shared_hist != nullptr)
+				shared_hist->finish();
+		}
+		catch(const exception &e)
+		{
+			cout << "FATAL ERROR: " << e.what() << endl;
+			simulated = false;
 		}
-		catch(const size_t &bad_dim)
+		if(!group.all(simulated))
+			return 1;
+		molstat::Histogram &hist = thread_hists[0];
+
+		// the expected counts of this process's trials
+		if(analytic_cdf)
+		{
+			molstat::FillAnalyticHistogram(analytic_cdf, *bstyles[0],
+				local_trials, hist);
+			thread_next = blocks.end;
+		}
+
+		// finish writing the raw samples
+		if(samples != nullptr)
+		{
+			bool closed{ true };
+			try
+			{
+				samples->close();
+			}
+			catch(const exception &e)
+			{
+				cout << "FATAL ERROR: " << e.what() << endl;
+				closed = false;
+			}
+			if(!group.all(closed))
+				return 1;
+
+			vector<size_t> nsamples{ samples->size() };
+			group.sumToRoot(nsamples);
+			info << nsamples[0] << " raw samples were written to \"" <<
+				parser.sampleFileName() << (group.size() > 1 ?
+					".<process>\" (one file per process)." : "\".") << endl;
+		}
+
+		// the trials simulated by this process (which may stop early when
+		// checking for convergence)
+		size_t local_simulated{ 0 };
+		for(size_t t = 0; t < nblocks; ++t)
+			local_simulated += thread_next[t] - thread_start[t];
+
+		// the timings are those of this process (excluding any trials resumed
+		// from a checkpoint)
+		const size_t local_total{ (local_simulated - resumed_trials) * npoints };
+		const vector<size_t> local_rejections{ rejections };
+
+		// combine the results of each process (on the root)
+		{
+			vector<size_t> counts{ rejections };
+			counts.push_back(no_obs);
+			counts.push_back(local_simulated);
+			group.sumToRoot(counts);
+			local_simulated = counts.back();
+			counts.pop_back();
+			no_obs = counts.back();
+			counts.pop_back();
+			rejections = counts;
+		}
+		const size_t nsimulated{ local_simulated };
+		const double wall{ group.maxToRoot(local_wall) };
+
+		// the sums of the importance weights of every thread and process
+		vector<double> weight_sums{ 0., 0. };
+		for(size_t t = 0; t < nblocks; ++t)
+		{
+			weight_sums[0] += thread_weights[t][0];
+			weight_sums[1] += thread_weights[t][1];
+		}
+		group.sumToRoot(weight_sums);
+
+		// report the convergence of the histogram
+		if(tolerance > 0.)
+		{
+			const string unit{ trace == nullptr ? " trials" : " traces" };
+			info << '\n';
+			if(converged)
+				info << "The histogram converged after " << nsimulated <<
+					" of the " << ntrials << unit;
+			else
+				info << "The histogram did not converge within the " << ntrials <<
+					unit;
+			info << " (the Hellinger distance between the last two rounds " \
+				"was " << distance << ")." << endl;
+		}
+
+		// print out the number of trials that did not produce an observable
+		// (with traces, each point is a trial)
+		const size_t ntotal{ nsimulated * npoints };
+		const string trial_name{ trace == nullptr ? "trials" : "trace points" };
+		info << '\n' << no_obs << " of the " << ntotal << ' ' << trial_name <<
+			" (" << (100. * no_obs / ntotal) << "%) did not produce an " \
+			"observable.\n" << (ntotal - no_obs) << " of the " << ntotal << ' ' <<
+			trial_name << " (" << (100. * (ntotal - no_obs) / ntotal) <<
+			"%) were binned into a histogram." << endl;
+		if(no_obs > 0)
 		{
-			// one dimension specified multiple bins and does not have a range of
-			// values
-			cout << "Empty data range in dimension " << bad_dim << "; however, " \
-				"more than 1 bin was requested.\nOnly using 1 bin." << endl;
-			bstyles[bad_dim] = make_shared<const molstat::BinLinear>(1);
+			for(size_t j = 0; j < nobs; ++j)
+			{
+				info << "   Observable " << j << " was not produced in " <<
+					rejections[j] << " of the " << trial_name << '.' << endl;
+			}
 		}
-	} while(!binned);
 
-	// go through the bins
-	molstat::CounterIndex ci { hist.begin() };
+		// the effective sample size, (sum w)^2 / sum w^2, of the weighted
+		// trials; it is much smaller than the number of trials when the
+		// proposals are poorly matched to the distributions
+		if(weighted && weight_sums[1] > 0.)
+			info << "The effective sample size of the weighted trials is " <<
+				(weight_sums[0] * weight_sums[0] / weight_sums[1]) << " (the " \
+				"mean weight is " << (weight_sums[0] / (ntotal - no_obs)) <<
+				")." << endl;
 
-	for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+		// report the timings (of the root process)
+		if(!thread_profiles.empty())
+		{
+			for(size_t t = 1; t < nblocks; ++t)
+				thread_profiles[0].merge(thread_profiles[t]);
+			if(group.size() > 1)
+				info << "\nThe profile is for process 0 (of " << group.size() <<
+					"); the wall time of the slowest process was " << wall << " s.";
+			thread_profiles[0].report(info, local_total, local_wall, nthreads,
+				parser.getObservableNames(), local_rejections);
+		}
+
+		// make the histogram (already done if streaming)
+		// the bounds are the extremes of the data from every process, so that
+		// every process has the same bins
+		// if we encounter a bad dimension -- specifically, one where there is no
+		// range of data (all trials yield the same value) and more than one bin
+		// is specified -- override the binstyle for that dimension and try again
+		if(!streaming)
+		{
+			track_memory();
+			vector<array<double, 2>> extremes{ hist.getDataExtremes() };
+			group.extremes(extremes);
+
+			bool binned { false };
+			while(!binned)
+			{
+				try
+				{
+					hist.bin_data(bstyles, extremes, &scheduler);
+					binned = true;
+				}
+				catch(const size_t &bad_dim)
+				{
+					// one dimension specified multiple bins and does not have a
+					// range of values
+					output << "Empty data range in dimension " << bad_dim <<
+						"; however, more than 1 bin was requested.\nOnly using 1 " \
+						"bin." << endl;
+					bstyles[bad_dim] = make_shared<const molstat::BinLinear>(1);
+				}
+			}
+			track_memory();
+		}
+
+		// the largest peak memory of any process
+		const double peak_mib{ group.maxToRoot(peak_memory / 1048576.) },
+			resident_mib{ group.maxToRoot(PeakResidentMiB()) };
+
+		// sum the (raw) bin counts of every process on the root
+		if(group.size() > 1)
+		{
+			sum_histogram(group, hist);
+			for(molstat::Histogram &extra : extra_hists[0])
+				sum_histogram(group, extra);
+		}
+
+		// only the root writes the histogram
+		if(!group.isRoot())
+			continue;
+		MOLSTAT_TRACE_EVENT("write output");
+
+		// report the data that were outside the fixed bounds
+		if(streaming)
+		{
+			info << hist.numOutOfRange() << " of the trials that produced an " \
+				"observable were outside the histogram bounds." << endl;
+			for(size_t j = 0; j < bstyles.size(); ++j)
+			{
+				info << "   Dimension " << j << ": " << hist.numUnderflow(j) <<
+					" underflow(s), " << hist.numOverflow(j) << " overflow(s)." <<
+					endl;
+			}
+		}
+
+		if(cache != nullptr)
+			report_cache(group, *cache, info);
+
+		// report the memory
+		info << "The stored data and histograms" << (pool == nullptr ? "" :
+			cache == nullptr ? " (and the pool of base variates)" :
+			" (and the pool of base variates and cache)") << " took at most " <<
+			peak_mib << " MiB" <<
+			(group.size() > 1 ? " (of any process)" : "") <<
+			"; the peak resident memory was " << resident_mib << " MiB." <<
+			endl;
+		if(memory_limit > 0 && peak_mib * 1048576. > memory_limit)
+			info << "WARNING: The memory limit (" <<
+				(memory_limit / 1048576.) << " MiB) was exceeded." << endl;
+
+		// output the bins
+		write_histogram(histout, output_name(parser.outputFileName(), point),
+			format, hist, bstyles, ntotal,
+			ntotal - no_obs - hist.numOutOfRange(), output);
+
+		// smooth the histogram into a kernel density estimate
+		if(densityout.is_open())
+		{
+			molstat::HistogramData density{ molstat::MakeHistogramData(hist,
+				bstyles, ntotal, ntotal - no_obs - hist.numOutOfRange()) };
+			density.counts = molstat::KernelDensityCounts(hist,
+				bandwidths.empty() ? molstat::KernelDensityBandwidths(hist) :
+				bandwidths);
+
+			switch(densityformat)
+			{
+			case molstat::HistogramFormat::Binary:
+				molstat::WriteHistogramBinary(densityout, density);
+				break;
+			case molstat::HistogramFormat::Gzip:
+				molstat::WriteHistogramGzip(densityout, density);
+				break;
+			case molstat::HistogramFormat::Text:
+			default:
+				molstat::WriteHistogramText(densityout, density);
+				break;
+			}
+
+			densityout.close();
+		}
+
+		// sum the bin counts into the marginal histograms
+		for(size_t m = 0; m < marginalout.size(); ++m)
+		{
+			const molstat::HistogramData marginal{ molstat::MarginalHistogramData(
+				hist, bstyles, ntotal, marginals[m].spec) };
+
+			switch(marginals[m].format)
+			{
+			case molstat::HistogramFormat::Binary:
+				molstat::WriteHistogramBinary(marginalout[m], marginal);
+				break;
+			case molstat::HistogramFormat::Gzip:
+				molstat::WriteHistogramGzip(marginalout[m], marginal);
+				break;
+			case molstat::HistogramFormat::Text:
+			default:
+				molstat::WriteHistogramText(marginalout[m], marginal);
+				break;
+			}
+
+			marginalout[m].close();
+		}
+
+		// the additional histograms of the same trials
+		for(size_t e = 0; e < extraout.size(); ++e)
+		{
+			const molstat::Histogram &extra = extra_hists[0][e];
+			const size_t nbinned{ ntotal - no_obs - extra.numOutOfRange() };
+			info << "Histogram \"" << extras[e].filename << "\": " <<
+				extra.numOutOfRange() << " of the trials that produced an " \
+				"observable were outside its bounds." << endl;
+
+			write_histogram(extraout[e], output_name(extras[e].filename, point),
+				extras[e].format, extra,
+				vector<shared_ptr<const molstat::BinStyle>>(
+					extras[e].bstyles.begin(), extras[e].bstyles.end()),
+				ntotal, nbinned, output);
+		}
+
+		// the JSON report: one line per simulation
+		if(parser.jsonReport())
+		{
+			output << "{\"trials\":" << nsimulated;
+			if(trace != nullptr)
+				output << ",\"points\":" << npoints;
+			if(!sweep_values.empty())
+				output << ",\"sweep\":" << json_string(parser.sweepName()) <<
+					",\"value\":" << json_string(sweep_values[point]);
+			if(!calibration.x.empty())
+			{
+				const vector<SimulatorInputParse::CalibrationVariable> variables
+					{ parser.calibrationVariables() };
+				output << ",\"calibrated\":{";
+				for(size_t k = 0; k < variables.size(); ++k)
+					output << (k > 0 ? "," : "") <<
+						json_string(variables[k].name) << ':' <<
+						json_number(calibration.x[k]);
+				output << "},\"calibration_distance\":" <<
+					json_number(calibration.f) <<
+					",\"calibration_converged\":" <<
+					(calibration.converged ? "true" : "false");
+			}
+			output << ",\"binned\":" <<
+				(ntotal - no_obs - hist.numOutOfRange()) <<
+				",\"no_observable\":" << no_obs << ",\"rejections\":[";
+			for(size_t j = 0; j < nobs; ++j)
+				output << (j > 0 ? "," : "") << rejections[j];
+			output << "],\"out_of_range\":" << hist.numOutOfRange();
+			if(tolerance > 0.)
+				output << ",\"converged\":" << (converged ? "true" : "false") <<
+					",\"distance\":" << json_number(distance);
+			if(weighted)
+				output << ",\"effective_sample_size\":" << json_number(
+					weight_sums[1] > 0. ?
+					weight_sums[0] * weight_sums[0] / weight_sums[1] : 0.);
+			output << ",\"seed\":" << parser.seed() << ",\"stream\":" <<
+				parser.stream() << ",\"processes\":" << group.size() <<
+				",\"threads\":" << nthreads << ",\"peak_memory_mib\":" <<
+				json_number(peak_mib) << ",\"output\":" <<
+				json_string(output_name(parser.outputFileName(), point)) <<
+				",\"simulation_seconds\":" << json_number(wall) <<
+				",\"total_seconds\":" << json_number(
+					chrono::duration<double>(molstat::ProfileClock::now() -
+					run_start).count()) << '}' << endl;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * \brief Main function for simulating a histogram.
+ *
+ * Parses the input parameters and outputs randomly generated data
+ * for the desired observable.
+ *
+ * With the `--server` argument, the simulator instead reads a stream of jobs
+ * from standard in and runs each without restarting. The lines of a job are
+ * added to the base deck (later commands replace earlier ones) and the job
+ * ends with a line containing `run`; the simulator then writes `done n`
+ * (for the nth job) to standard out, or `error n` if the job failed. A job
+ * that ends with `base` replaces the base deck instead of running, and
+ * `quit` (or the end of the input) stops the server.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	// the processes of the simulation (only one, unless MolStat was compiled
+	// with MPI); the root process reads the input and writes the output
+	molstat::ProcessGroup group(argc, argv);
+
+	bool server{ false };
+	for(int j = 1; j < argc; ++j)
+		server = server || string(argv[j]) == "--server";
+
+	if(!server)
 	{
-		const valarray<double> coords = hist.getCoordinates(ci);
-		for(size_t j = 0; j < coords.size(); ++j)
-			histout << coords[j] << ' ';
-		histout << hist.getBinCount(ci) << endl;
+		string deck;
+		if(group.isRoot())
+			deck.assign(istreambuf_iterator<char>(cin),
+				istreambuf_iterator<char>());
+		return simulate(group, deck);
 	}
 
-	// close the output stream
-	histout.close();
+	// server mode: the root reads each job and tells the other processes what
+	// to do
+	string base, job;
+	size_t njobs{ 0 };
+	while(true)
+	{
+		string command{ "quit" };
+		if(group.isRoot())
+		{
+			string line;
+			molstat::TokenViews tokens;
+			while(getline(cin, line))
+			{
+				molstat::tokenize(line, tokens);
+				if(tokens.size() == 1)
+				{
+					const string word{ molstat::to_lower(tokens[0].str()) };
+					if(word == "run" || word == "base" || word == "quit")
+					{
+						command = word;
+						break;
+					}
+				}
+				job += line + '\n';
+			}
+		}
+		group.broadcast(command);
+
+		if(command == "quit")
+			break;
+		else if(command == "base")
+			base = move(job);
+		else
+		{
+			++njobs;
+			const int status{ simulate(group, base + job) };
+			if(group.isRoot())
+				cout << (status == 0 ? "done " : "error ") << njobs << endl;
+		}
+		job.clear();
+	}
 
 	return 0;
 }
@@ -22,12 +22,17 @@
 #include <list>
 #include <map>
 
+#include <general/name_registry.h>
 #include <general/simulator_tools/simulator.h>
+#include <general/random_distributions/engine.h>
+#include <general/histogram_tools/histogram_io.h>
+#include <general/histogram_tools/marginal.h>
 
 // forward declarations
 namespace molstat {
 class RandomDistribution;
 class BinStyle;
+class TraceProtocol;
 }
 
 /**
@@ -44,6 +49,72 @@ class BinStyle;
  */
 class SimulatorInputParse
 {
+public:
+	/// The methods for sampling the model parameters.
+	enum class SamplingMethod
+	{
+		/// Pseudo-random numbers from the engine; the default.
+		Random,
+
+		/// A Sobol sequence (quasi-Monte Carlo).
+		Sobol,
+
+		/// A Latin hypercube over each batch of trials.
+		LatinHypercube,
+
+		/// A fixed pool of base variates, reused when the distributions
+		/// change (common random numbers).
+		Pool
+	};
+
+	/// A marginal histogram (or conditional slice) to write.
+	struct MarginalOutput
+	{
+		/// The file name.
+		std::string filename;
+
+		/// The output format.
+		molstat::HistogramFormat format;
+
+		/// The dimensions kept and the slices of the other dimensions.
+		molstat::MarginalSpec spec;
+	};
+
+	/**
+	 * \brief An additional histogram of the same trials, with its own
+	 *    (fixed) bins.
+	 */
+	struct HistogramOutput
+	{
+		/// The file name.
+		std::string filename;
+
+		/// The output format.
+		molstat::HistogramFormat format;
+
+		/// The observable (or `displacement`) of each dimension.
+		std::vector<std::string> observables;
+
+		/// The binning style of each dimension.
+		std::vector<std::shared_ptr<molstat::BinStyle>> bstyles;
+
+		/// The words of the specification of each binning style.
+		std::vector<std::vector<std::string>> bin_specs;
+	};
+
+	/// A variable tuned by a calibration; distributions refer to `$name`.
+	struct CalibrationVariable
+	{
+		/// The name of the variable (without the `$`).
+		std::string name;
+
+		/// The starting value.
+		double initial;
+
+		/// The initial step of the search.
+		double step;
+	};
+
 private:
 	/// Data structure that stores information about models to be created.
 	struct ModelInformation
@@ -55,9 +126,36 @@ private:
 		std::map<std::string,
 		          std::shared_ptr<const molstat::RandomDistribution>> dists;
 
+		/**
+		 * \brief The words of the specifications of the distributions in
+		 *    `dists`, in the order they were read. Joint distributions are
+		 *    listed under their comma-separated parameter names.
+		 */
+		std::vector<std::pair<std::string, std::vector<std::string>>>
+			dist_specs;
+
+		/**
+		 * \brief The distributions that depend on the sweep variable, as the
+		 *    words of their specifications (e.g., `normal $x 0.1`).
+		 */
+		std::map<std::string, std::vector<std::string>> swept;
+
+		/// The proposal distributions for importance sampling.
+		std::map<std::string,
+		          std::shared_ptr<const molstat::RandomDistribution>> proposals;
+
+		/// The words of the specifications of the proposal distributions.
+		std::map<std::string, std::vector<std::string>> proposal_specs;
+
 		/// A list of submodels to be created.
 		std::list<ModelInformation> submodels;
 
+		/**
+		 * \brief The observables to tabulate for this model, with the number
+		 *    of grid points for each parameter.
+		 */
+		std::map<std::string, std::size_t> tables;
+
 		/**
 		 * \brief Gets a string representation of the model information.
 		 *
@@ -66,9 +164,72 @@ private:
 		std::string to_string() const;
 	};
 
+	/// Data structure that stores the specification of a trace protocol.
+	struct TraceInformation
+	{
+		/// A shift of a model parameter with displacement.
+		struct Shift
+		{
+			/// The name of the parameter.
+			std::string name;
+
+			/// The type of shift (`linear` or `imagecharge`).
+			std::string type;
+
+			/// The two numbers of the shift.
+			double a, b;
+		};
+
+		/// The number of displacements in each trace.
+		std::size_t npoints{ 0 };
+
+		/// The first and last displacements.
+		double zmin{ 0. }, zmax{ 0. };
+
+		/**
+		 * \brief The words of the specification of the distribution of trace
+		 *    lengths; empty if the traces do not rupture.
+		 */
+		std::vector<std::string> length;
+
+		/// The shifts of the model parameters.
+		std::vector<Shift> shifts;
+
+		/// The values of the model parameters after the junction ruptures.
+		std::vector<std::pair<std::string, double>> ruptured;
+	};
+
 	/// The top-level simulate model information.
 	ModelInformation top_model;
 
+	/// The name of the sweep variable; empty if there is no sweep.
+	std::string sweep_name;
+
+	/// The values of the sweep variable, as written in the input deck.
+	std::vector<std::string> sweep_values;
+
+	/// The target histogram of a calibration; empty if there is none.
+	std::string calibrate_filename;
+
+	/// The number of trials in each simulation of the calibration.
+	std::size_t calibrate_trials{ 20000 };
+
+	/// The maximum number of iterations of the calibration.
+	std::size_t calibrate_iterations{ 200 };
+
+	/// The convergence tolerance of the calibration.
+	double calibrate_tolerance{ 1.e-3 };
+
+	/// The variables tuned by the calibration.
+	std::vector<CalibrationVariable> calibrate_variables;
+
+	/**
+	 * \brief The constructed models (including submodels) with distributions
+	 *    that depend on the sweep variable, and those distributions.
+	 */
+	std::list<std::pair<std::shared_ptr<molstat::SimulateModel>,
+		std::map<std::string, std::vector<std::string>>>> swept_models;
+
 	/**
 	 * \brief Map of observable index (axis) to a pair of observable name
 	 *    and the binning style.
@@ -77,12 +238,201 @@ private:
 	         std::pair<std::string, std::shared_ptr<molstat::BinStyle>>>
 		obs_bins;
 
+	/// The words of the specification of each observable's binning style.
+	std::map<std::size_t, std::vector<std::string>> bin_specs;
+
 	/// File name for the histogram output.
 	std::string histfilename{ "histogram.dat" };
 
+	/// The format of the histogram output.
+	molstat::HistogramFormat histformat{ molstat::HistogramFormat::Text };
+
+	/// File name for the raw samples; empty if they are not written.
+	std::string samplefilename;
+
+	/// True if the model parameters are written with the raw samples.
+	bool sample_params{ false };
+
+	/// File name for the kernel density estimate; empty if it is not written.
+	std::string densityfilename;
+
+	/// The format of the kernel density estimate.
+	molstat::HistogramFormat densityformat{ molstat::HistogramFormat::Text };
+
+	/**
+	 * \brief The bandwidth of the kernel density estimate in each dimension;
+	 *    empty if the bandwidths are chosen automatically.
+	 */
+	std::vector<double> density_bandwidths;
+
+	/// The marginal histograms (and conditional slices) to write.
+	std::vector<MarginalOutput> marginals;
+
+	/// The additional histograms to write.
+	std::vector<HistogramOutput> histograms;
+
+	/// File name for checkpoints; empty if checkpoints are not written.
+	std::string checkpointfilename;
+
+	/// The time between checkpoints, in seconds.
+	double checkpoint_interval{ 600. };
+
+	/// True if the simulation resumes from the checkpoint (if it exists).
+	bool resume_run{ false };
+
+	/**
+	 * \brief The tolerance for stopping the simulation once the histogram
+	 *    converges; 0 if the simulation does not stop early.
+	 */
+	double converge_tolerance{ 0. };
+
+	/// The number of trials between convergence checks.
+	std::size_t converge_interval{ 10000 };
+
+	/**
+	 * \brief The fraction of the trials between partial histograms; 0 if
+	 *    only the final histogram is written.
+	 */
+	double progress_fraction{ 0. };
+
+	/// The file for the partial histograms; empty for the default.
+	std::string progress_filename;
+
+	/**
+	 * \brief The fraction of the trials in the pilot run that finds the
+	 *    bounds of observables without fixed bounds; 0 if there is no pilot
+	 *    run.
+	 */
+	double pilot_fraction{ 0. };
+
+	/**
+	 * \brief The margin added to each side of the range of the pilot data
+	 *    (as a fraction of the range, in masked coordinates).
+	 */
+	double pilot_margin{ 0.1 };
+
+	/**
+	 * \brief The largest fraction of the data outside the bounds (found by
+	 *    the pilot run) before the bins are widened.
+	 */
+	double pilot_overflow{ 0.01 };
+
+	/**
+	 * \brief The most memory (MiB) each process may use for the stored data
+	 *    and histograms; 0 if there is no limit.
+	 */
+	double memory_limit{ 0. };
+
 	/// The number of trials (i.e., data points to simulate).
 	std::size_t trials{ 0 };
 
+	/// The number of threads to use when simulating the trials.
+	std::size_t nthreads{ 1 };
+
+	/// Whether or not the threads are pinned to CPUs.
+	bool pin_threads{ false };
+
+	/**
+	 * \brief The number of threads that bin the simulated batches (0 if the
+	 *    threads bin their own batches).
+	 */
+	std::size_t pipeline_binners{ 0 };
+
+	/// The number of batches each simulating thread can have waiting.
+	std::size_t pipeline_depth{ 4 };
+
+	/**
+	 * \brief The number of blocks the trials are divided into, regardless of
+	 *    the threads and processes (0 for one block per thread).
+	 */
+	std::size_t nblocks{ 0 };
+
+	/// The kind of random number engine to use.
+	molstat::EngineKind engine_kind{ molstat::Engine::default_kind };
+
+	/**
+	 * \brief Whether or not the trials are simulated on a GPU, when the
+	 *    model and distributions allow it.
+	 */
+	bool use_gpu{ false };
+
+	/**
+	 * \brief Whether or not the histogram is calculated from the exact
+	 *    distribution of the observable, when the model and distributions
+	 *    allow it.
+	 */
+	bool analytic{ false };
+
+	/// The trace protocol; nullptr if not simulating traces.
+	std::shared_ptr<molstat::TraceProtocol> trace{ nullptr };
+
+	/// The method for sampling the model parameters.
+	SamplingMethod sampling{ SamplingMethod::Random };
+
+	/**
+	 * \brief Whether or not the submodel terms of the pool's trials are
+	 *    cached, so that they are recalculated only when their parameters
+	 *    change.
+	 */
+	bool incremental{ false };
+
+	/// Whether or not the seed was specified in the input deck.
+	bool seed_specified{ false };
+
+	/**
+	 * \brief The seed for the random number engine.
+	 *
+	 * If unspecified, a seed is drawn from std::random_device at the end of
+	 * readInput.
+	 */
+	molstat::Engine::result_type rng_seed{ 0 };
+
+	/// The substream (job) number for the random number engine.
+	molstat::Engine::result_type rng_stream{ 0 };
+
+	/**
+	 * \brief The number of Gauss-Legendre points for energy integrals; 0 for
+	 *    adaptive quadrature.
+	 */
+	std::size_t quadrature_order{ 0 };
+
+	/// The tolerance for adaptive quadrature.
+	double quadrature_tolerance{ 1.e-9 };
+
+	/**
+	 * \brief The relative precision needed of the observables, which
+	 *    replaces the tolerance of adaptive quadrature; 0 if not requested.
+	 */
+	double precision{ 0. };
+
+	/**
+	 * \brief The precision as a fraction of the narrowest bin, relative to
+	 *    its values (see molstat::BinStyle::relativeResolution()); 0 if the
+	 *    precision is not taken from the bins.
+	 */
+	double precision_fraction{ 0. };
+
+	/**
+	 * \brief Time one of every `profile_interval` batches of trials; 0 if
+	 *    profiling is disabled.
+	 */
+	std::size_t profile_interval{ 0 };
+
+	/**
+	 * \brief Whether or not the run is reported by a single line of JSON
+	 *    instead of the (verbose) text.
+	 */
+	bool json_report{ false };
+
+	/// The specification of the trace protocol, if there is one.
+	TraceInformation trace_info;
+
+	/**
+	 * \brief File name for the compiled configuration; empty if the input
+	 *    deck is simulated instead.
+	 */
+	std::string compilefilename;
+
 	/**
 	 * \brief Prints an error message.
 	 *
@@ -107,6 +457,67 @@ private:
 	static ModelInformation readModel(std::istream &input, std::ostream &output,
 		std::size_t &lineno);
 
+	/**
+	 * \brief Reads a trace protocol from the input stream.
+	 *
+	 * \throw std::runtime_error if there is a fatal error reading the input
+	 *    deck (notably, a lack of "endtrace" before EOF).
+	 *
+	 * \param[in,out] input The input stream.
+	 * \param[in,out] output Output stream for any error messages.
+	 * \param[in,out] lineno The input line number.
+	 * \param[out] info The specification of the trace protocol.
+	 * \return The trace protocol; nullptr if it could not be constructed.
+	 */
+	static std::shared_ptr<molstat::TraceProtocol> readTrace(
+		std::istream &input, std::ostream &output, std::size_t &lineno,
+		TraceInformation &info);
+
+	/**
+	 * \brief Constructs a trace protocol from its specification.
+	 *
+	 * \throw std::invalid_argument if the distribution of trace lengths is
+	 *    invalid.
+	 *
+	 * \param[in] info The specification.
+	 * \return The trace protocol.
+	 */
+	static std::shared_ptr<molstat::TraceProtocol> makeTrace(
+		const TraceInformation &info);
+
+	/**
+	 * \brief Writes the information of a model (and its submodels) to a
+	 *    compiled configuration.
+	 *
+	 * \param[in,out] out The (binary) output stream.
+	 * \param[in] info The model information.
+	 */
+	static void writeModelInformation(std::ostream &out,
+		const ModelInformation &info);
+
+	/**
+	 * \brief Reads the information of a model (and its submodels) from a
+	 *    compiled configuration, constructing its distributions.
+	 *
+	 * \throw std::runtime_error if the stream ends early or a distribution
+	 *    cannot be constructed.
+	 *
+	 * \param[in,out] in The (binary) input stream.
+	 * \return The model information.
+	 */
+	static ModelInformation readModelInformation(std::istream &in);
+
+	/**
+	 * \brief Replaces the state of the parser with a compiled configuration
+	 *    (see writeCompiled()).
+	 *
+	 * \throw std::runtime_error if the file cannot be read or is not a
+	 *    compiled configuration.
+	 *
+	 * \param[in] filename The name of the file.
+	 */
+	void readCompiled(const std::string &filename);
+
 	/**
 	 * \brief Constructs a model from the
 	 *    SimulatorInputParser::ModelInformation.
@@ -116,13 +527,75 @@ private:
 	 * \param[in,out] output Output stream for any error messages.
 	 * \param[in] models Map of available models.
 	 * \param[in] info The model information from the input deck.
+	 * \param[out] tabulate The constructed models (including submodels) that
+	 *    have observables to tabulate, with their information.
+	 * \param[out] swept The constructed models (including submodels) with
+	 *    distributions that depend on the sweep variable.
+	 * \param[out] proposed The constructed models (including submodels) with
+	 *    proposal distributions, and those distributions.
 	 * \return The constructed model.
 	 */
 	static std::shared_ptr<molstat::SimulateModel> constructModel(
 		std::ostream &output,
-		const std::map<std::string,
-		               molstat::SimulateModelFactoryFunction> &models,
-		ModelInformation &info);
+		const molstat::NameRegistry<molstat::SimulateModelFactoryFunction>
+			&models,
+		ModelInformation &info,
+		std::list<std::pair<std::shared_ptr<molstat::SimulateModel>,
+		                    ModelInformation>> &tabulate,
+		std::list<std::pair<std::shared_ptr<molstat::SimulateModel>,
+		          std::map<std::string, std::vector<std::string>>>> &swept,
+		std::list<std::pair<std::shared_ptr<molstat::SimulateModel>,
+		          std::map<std::string,
+		          std::shared_ptr<const molstat::RandomDistribution>>>>
+			&proposed);
+
+	/**
+	 * \brief Constructs a distribution that depends on the sweep variable or
+	 *    the variables of a calibration.
+	 *
+	 * \throw std::runtime_error if the specification refers to another
+	 *    variable or is invalid.
+	 *
+	 * \param[in] words The words of the distribution's specification.
+	 * \param[in] point The index of the value of the sweep variable.
+	 * \param[in] values The values of the calibration's variables; their
+	 *    starting values if empty.
+	 * \return The distribution.
+	 */
+	std::shared_ptr<const molstat::RandomDistribution> sweepDistribution(
+		const std::vector<std::string> &words, std::size_t point,
+		const std::vector<double> &values = {}) const;
+
+	/**
+	 * \brief Determines if a model or its submodels have a distribution that
+	 *    refers to a variable.
+	 *
+	 * \param[in] info The model information.
+	 * \param[in] name The name of the variable (with the `$`).
+	 * \return True if a distribution refers to the variable.
+	 */
+	static bool refersTo(const ModelInformation &info,
+		const std::string &name);
+
+	/**
+	 * \brief Sets the distributions that depend on the sweep variable, for
+	 *    one of its values, in a model and its submodels.
+	 *
+	 * \param[in,out] info The model information.
+	 * \param[in] point The index of the value of the sweep variable.
+	 * \return The number of distributions that depend on the sweep variable.
+	 */
+	std::size_t sweepModelInformation(ModelInformation &info,
+		std::size_t point) const;
+
+	/**
+	 * \brief Gets the relative precision needed of the observables (see the
+	 *    `precision` command).
+	 *
+	 * \return The precision; 0 if none was requested, or if it is taken
+	 *    from the bins and no observable has fixed bounds.
+	 */
+	double integrationPrecision() const;
 
 public:
 	/**
@@ -156,6 +629,29 @@ public:
 	 */
 	std::unique_ptr<molstat::Simulator> createSimulator(std::ostream &output);
 
+	/**
+	 * \brief Writes the configuration (everything but the `compile` command)
+	 *    to a binary file, which the `load` command restores without
+	 *    reading the input deck.
+	 *
+	 * The configuration should be validated by createSimulator() first. The
+	 * distributions, binning styles, and trace protocol are stored as the
+	 * words of their specifications and constructed when loaded; files that
+	 * they refer to (e.g., empirical distributions) are read again.
+	 *
+	 * \throw std::runtime_error if the file cannot be written.
+	 *
+	 * \param[in] filename The name of the file.
+	 */
+	void writeCompiled(const std::string &filename) const;
+
+	/**
+	 * \brief Gets the file name for the compiled configuration.
+	 *
+	 * \return The file name; empty if the input deck is simulated instead.
+	 */
+	std::string compileFileName() const;
+
 	/**
 	 * \brief Gets the number of trials.
 	 *
@@ -163,6 +659,124 @@ public:
 	 */
 	std::size_t numTrials() const noexcept;
 
+	/**
+	 * \brief Gets the number of threads to use for the simulation.
+	 *
+	 * \return The number of threads.
+	 */
+	std::size_t numThreads() const noexcept;
+
+	/**
+	 * \brief Determines if the threads are pinned to CPUs (`threads n pin`).
+	 *
+	 * \return True if the threads are pinned.
+	 */
+	bool pinThreads() const noexcept;
+
+	/**
+	 * \brief Gets the number of threads that bin the simulated batches
+	 *    (`pipeline`).
+	 *
+	 * \return The number of binning threads; 0 if the simulating threads bin
+	 *    their own batches.
+	 */
+	std::size_t pipelineBinners() const noexcept;
+
+	/**
+	 * \brief Gets the number of batches each simulating thread can have
+	 *    waiting to be binned.
+	 *
+	 * \return The depth of the pipeline.
+	 */
+	std::size_t pipelineDepth() const noexcept;
+
+	/**
+	 * \brief Gets the number of blocks the trials are divided into
+	 *    (`blocks`).
+	 *
+	 * \return The number of blocks; 0 if each thread of each process has one
+	 *    block.
+	 */
+	std::size_t numBlocks() const noexcept;
+
+	/**
+	 * \brief Gets the kind of random number engine to use.
+	 *
+	 * \return The engine kind.
+	 */
+	molstat::EngineKind engineKind() const noexcept;
+
+	/**
+	 * \brief Determines if the trials should be simulated on a GPU.
+	 *
+	 * The simulation falls back to the CPU if the model, distributions, or
+	 * options are not supported on the GPU, or no GPU is available.
+	 *
+	 * \return True if a GPU was requested.
+	 */
+	bool useGPU() const noexcept;
+
+	/**
+	 * \brief Determines if the histogram should be calculated from the exact
+	 *    distribution of the observable (`analytic`).
+	 *
+	 * The trials are simulated if the model, distributions, or options do
+	 * not allow it.
+	 *
+	 * \return True if an exact histogram was requested.
+	 */
+	bool analyticHistogram() const noexcept;
+
+	/**
+	 * \brief Gets the method for sampling the model parameters.
+	 *
+	 * \return The sampling method.
+	 */
+	SamplingMethod samplingMethod() const noexcept;
+
+	/**
+	 * \brief Determines if the trials of the pool are re-simulated
+	 *    incrementally (`sampling pool incremental`).
+	 *
+	 * \return True if the submodel terms are cached.
+	 */
+	bool incrementalPool() const noexcept;
+
+	/**
+	 * \brief Gets the seed for the random number engine.
+	 *
+	 * \return The seed.
+	 */
+	molstat::Engine::result_type seed() const noexcept;
+
+	/**
+	 * \brief Determines if the seed was specified in the input deck.
+	 *
+	 * \return True if the seed was specified; false if it is random.
+	 */
+	bool seedSpecified() const noexcept;
+
+	/**
+	 * \brief Replaces the seed (e.g., with that of a resumed simulation).
+	 *
+	 * \param[in] seed The seed.
+	 */
+	void setSeed(molstat::Engine::result_type seed) noexcept;
+
+	/**
+	 * \brief Gets the substream (job) number for the random number engine.
+	 *
+	 * \return The substream number.
+	 */
+	molstat::Engine::result_type stream() const noexcept;
+
+	/**
+	 * \brief Gets the trace protocol.
+	 *
+	 * \return The trace protocol; nullptr if traces are not simulated.
+	 */
+	std::shared_ptr<const molstat::TraceProtocol> getTraceProtocol() const;
+
 	/**
 	 * \brief Prints the state of the input parser.
 	 *
@@ -179,6 +793,249 @@ public:
 	 */
 	std::string outputFileName() const;
 
+	/**
+	 * \brief Gets the format of the histogram output.
+	 *
+	 * \return The output format.
+	 */
+	molstat::HistogramFormat outputFormat() const noexcept;
+
+	/**
+	 * \brief Gets the file name for the raw samples.
+	 *
+	 * \return The file name; empty if the raw samples are not written.
+	 */
+	std::string sampleFileName() const;
+
+	/**
+	 * \brief Determines if the model parameters are written with the raw
+	 *    samples.
+	 *
+	 * \return True if the model parameters are written.
+	 */
+	bool sampleParameters() const noexcept;
+
+	/**
+	 * \brief Gets the file name for the kernel density estimate.
+	 *
+	 * \return The file name; empty if the estimate is not written.
+	 */
+	std::string densityFileName() const;
+
+	/**
+	 * \brief Gets the format of the kernel density estimate.
+	 *
+	 * \return The output format.
+	 */
+	molstat::HistogramFormat densityFormat() const noexcept;
+
+	/**
+	 * \brief Gets the bandwidths of the kernel density estimate.
+	 *
+	 * \return The bandwidth in each dimension (in masked coordinates); empty
+	 *    if the bandwidths are chosen automatically.
+	 */
+	std::vector<double> densityBandwidths() const;
+
+	/**
+	 * \brief Gets the name of the sweep variable.
+	 *
+	 * \return The name (without the `$`); empty if there is no sweep.
+	 */
+	std::string sweepName() const;
+
+	/**
+	 * \brief Gets the values of the sweep variable.
+	 *
+	 * \return The values, as written in the input deck; empty if there is no
+	 *    sweep.
+	 */
+	std::vector<std::string> sweepValues() const;
+
+	/**
+	 * \brief Sets the distributions that depend on the sweep variable in the
+	 *    simulator's model, for one of its values.
+	 *
+	 * The model constructed by createSimulator is reused (see
+	 * molstat::Simulator::setDistribution).
+	 *
+	 * \throw std::runtime_error if a distribution cannot be constructed.
+	 *
+	 * \param[in,out] sim The simulator from createSimulator.
+	 * \param[in] point The index of the value of the sweep variable.
+	 */
+	void applySweep(molstat::Simulator &sim, std::size_t point) const;
+
+	/**
+	 * \brief Gets the target histogram of a calibration.
+	 *
+	 * \return The file name; empty if there is no calibration.
+	 */
+	std::string calibrationFileName() const;
+
+	/**
+	 * \brief Gets the number of trials in each simulation of the
+	 *    calibration.
+	 *
+	 * \return The number of trials.
+	 */
+	std::size_t calibrationTrials() const noexcept;
+
+	/**
+	 * \brief Gets the maximum number of iterations of the calibration.
+	 *
+	 * \return The number of iterations.
+	 */
+	std::size_t calibrationIterations() const noexcept;
+
+	/**
+	 * \brief Gets the convergence tolerance of the calibration.
+	 *
+	 * \return The tolerance.
+	 */
+	double calibrationTolerance() const noexcept;
+
+	/**
+	 * \brief Gets the variables tuned by the calibration.
+	 *
+	 * \return The variables.
+	 */
+	std::vector<CalibrationVariable> calibrationVariables() const;
+
+	/**
+	 * \brief Sets the distributions that depend on the calibration's
+	 *    variables in the simulator's model, for values of the variables.
+	 *
+	 * \throw std::runtime_error if a distribution cannot be constructed
+	 *    (e.g., the values are outside the distribution's domain).
+	 *
+	 * \param[in,out] sim The simulator from createSimulator.
+	 * \param[in] values The value of each variable.
+	 */
+	void applyCalibration(molstat::Simulator &sim,
+		const std::vector<double> &values) const;
+
+	/**
+	 * \brief Gets the marginal histograms (and conditional slices) to write.
+	 *
+	 * \return The marginal histograms; empty if none are written.
+	 */
+	std::vector<MarginalOutput> getMarginals() const;
+
+	/**
+	 * \brief Gets the additional histograms to write, which bin the same
+	 *    trials as the histogram.
+	 *
+	 * \return The additional histograms; empty if none are written.
+	 */
+	std::vector<HistogramOutput> getHistograms() const;
+
+	/**
+	 * \brief Gets the file name for checkpoints.
+	 *
+	 * \return The file name; empty if checkpoints are not written.
+	 */
+	std::string checkpointFileName() const;
+
+	/**
+	 * \brief Gets the time between checkpoints.
+	 *
+	 * \return The time, in seconds.
+	 */
+	double checkpointInterval() const noexcept;
+
+	/**
+	 * \brief Determines if the simulation resumes from its checkpoint.
+	 *
+	 * \return True if the simulation resumes (when the checkpoint exists).
+	 */
+	bool resume() const noexcept;
+
+	/**
+	 * \brief Gets the tolerance for convergence of the histogram.
+	 *
+	 * \return The largest Hellinger distance between the histograms of
+	 *    consecutive rounds for which the simulation stops; 0 if the
+	 *    simulation always simulates every trial.
+	 */
+	double convergenceTolerance() const noexcept;
+
+	/**
+	 * \brief Gets the number of trials in each round between convergence
+	 *    checks.
+	 *
+	 * \return The number of trials.
+	 */
+	std::size_t convergenceInterval() const noexcept;
+
+	/**
+	 * \brief Gets the fraction of the trials between partial histograms.
+	 *
+	 * \return The fraction; 0 if only the final histogram is written.
+	 */
+	double progressFraction() const noexcept;
+
+	/**
+	 * \brief Gets the file name for the partial histograms.
+	 *
+	 * \return The file name; by default, the name of the output file with
+	 *    ".partial" appended.
+	 */
+	std::string progressFileName() const;
+
+	/**
+	 * \brief Gets the fraction of the trials in the pilot run.
+	 *
+	 * \return The fraction; 0 if there is no pilot run.
+	 */
+	double pilotFraction() const noexcept;
+
+	/**
+	 * \brief Gets the margin added to the range of the pilot data.
+	 *
+	 * \return The margin, as a fraction of the range (in masked
+	 *    coordinates).
+	 */
+	double pilotMargin() const noexcept;
+
+	/**
+	 * \brief Gets the largest fraction of the data outside the bounds
+	 *    before the bins are widened.
+	 *
+	 * \return The fraction.
+	 */
+	double pilotOverflow() const noexcept;
+
+	/**
+	 * \brief Gets the most memory each process may use for the stored data
+	 *    and histograms.
+	 *
+	 * \return The limit (bytes); 0 if there is no limit.
+	 */
+	std::size_t memoryLimit() const noexcept;
+
+	/**
+	 * \brief Gets the profiling interval.
+	 *
+	 * \return One of every this many batches of trials is timed; 0 if
+	 *    profiling is disabled.
+	 */
+	std::size_t profileInterval() const noexcept;
+
+	/**
+	 * \brief Determines if the run is reported by a single line of JSON.
+	 *
+	 * \return True for the JSON summary, false for the text report.
+	 */
+	bool jsonReport() const noexcept;
+
+	/**
+	 * \brief Gets the names of the observables.
+	 *
+	 * \return The name of each observable, in output order.
+	 */
+	std::vector<std::string> getObservableNames() const;
+
 	/**
 	 * \brief Get the binning styles.
 	 *
@@ -0,0 +1,607 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file molstat_python.cc
+ * \brief The Python module for running the simulator in-process.
+ *
+ * The `molstat` module has two types. `molstat.Simulation` is constructed
+ * from the text of a `molstat-simulator` input deck (the model, observables
+ * and bins; output commands are ignored) and simulates trials or histograms
+ * on request. `molstat.Array` holds the results; it supports the buffer
+ * protocol, so `numpy.asarray` (or `memoryview`) views the data without
+ * copying it.
+ *
+ * \author Matthew G.\ Reuter
+ * \date November 2014
+ */
+
+#include <Python.h>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_style.h>
+#include <general/random_distributions/engine.h>
+#include <general/simulator_tools/simulator.h>
+#include <main-simulator.h>
+
+using namespace std;
+
+/**
+ * \brief The data of a molstat.Array: a block of doubles with its shape and
+ *    strides (in bytes).
+ */
+struct ArrayData
+{
+	/// The values.
+	vector<double> values;
+
+	/// The number of values in each dimension.
+	vector<Py_ssize_t> shape;
+
+	/// The number of bytes between consecutive values in each dimension.
+	vector<Py_ssize_t> strides;
+};
+
+/**
+ * \brief The Python object for a molstat.Array.
+ */
+struct ArrayObject
+{
+	PyObject_HEAD
+
+	/// The data (owned by the object).
+	ArrayData *data;
+};
+
+/**
+ * \brief The state of a molstat.Simulation.
+ */
+struct SimulationState
+{
+	/// The parsed input deck.
+	SimulatorInputParse parser;
+
+	/// The simulator.
+	unique_ptr<molstat::Simulator> sim;
+
+	/// The random number engine, which continues from call to call.
+	unique_ptr<molstat::Engine> engine;
+
+	/// The messages from parsing the input deck.
+	string log;
+};
+
+/**
+ * \brief The Python object for a molstat.Simulation.
+ */
+struct SimulationObject
+{
+	PyObject_HEAD
+
+	/// The state (owned by the object).
+	SimulationState *state;
+};
+
+static PyTypeObject ArrayType = { PyVarObject_HEAD_INIT(nullptr, 0) };
+static PyTypeObject SimulationType = { PyVarObject_HEAD_INIT(nullptr, 0) };
+
+/**
+ * \brief Makes a molstat.Array from its data.
+ *
+ * \param[in] data The data.
+ * \return The new array; nullptr (with a Python exception) on failure.
+ */
+static PyObject *NewArray(ArrayData &&data)
+{
+	ArrayObject *ret{ PyObject_New(ArrayObject, &ArrayType) };
+	if(ret == nullptr)
+		return nullptr;
+
+	ret->data = new ArrayData(move(data));
+	return reinterpret_cast<PyObject*>(ret);
+}
+
+/**
+ * \brief Makes a molstat.Array of a 1D vector.
+ *
+ * \param[in] values The values.
+ * \return The new array; nullptr (with a Python exception) on failure.
+ */
+static PyObject *NewArray(vector<double> values)
+{
+	ArrayData data;
+	data.shape = { static_cast<Py_ssize_t>(values.size()) };
+	data.strides = { sizeof(double) };
+	data.values = move(values);
+	return NewArray(move(data));
+}
+
+/**
+ * \brief Converts the current C++ exception into a Python exception.
+ *
+ * Only to be called from a catch block.
+ *
+ * \return nullptr, for returning to Python.
+ */
+static PyObject *SetPythonError()
+{
+	try
+	{
+		throw;
+	}
+	catch(const invalid_argument &e)
+	{
+		PyErr_SetString(PyExc_ValueError, e.what());
+	}
+	catch(const exception &e)
+	{
+		PyErr_SetString(PyExc_RuntimeError, e.what());
+	}
+	catch(size_t j)
+	{
+		// from molstat::Histogram::bin_data
+		PyErr_SetString(PyExc_ValueError, ("All of the values of dimension " +
+			to_string(j) + " are the same.").c_str());
+	}
+	catch(...)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "Unknown error.");
+	}
+
+	return nullptr;
+}
+
+static void Array_dealloc(PyObject *self)
+{
+	delete reinterpret_cast<ArrayObject*>(self)->data;
+	PyObject_Del(self);
+}
+
+static int Array_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+	ArrayData &data = *reinterpret_cast<ArrayObject*>(self)->data;
+
+	// consumers that do not take strides need C-ordered values
+	bool c_order{ true };
+	Py_ssize_t stride{ sizeof(double) };
+	for(size_t j = data.shape.size(); j-- > 0;)
+	{
+		c_order = c_order && (data.shape[j] <= 1 || data.strides[j] == stride);
+		stride *= data.shape[j];
+	}
+	if(!c_order && (flags & PyBUF_STRIDES) != PyBUF_STRIDES)
+	{
+		PyErr_SetString(PyExc_BufferError, "The array is not C-contiguous.");
+		view->obj = nullptr;
+		return -1;
+	}
+
+	view->obj = self;
+	Py_INCREF(self);
+	view->buf = data.values.data();
+	view->len = data.values.size() * sizeof(double);
+	view->readonly = 0;
+	view->itemsize = sizeof(double);
+	view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>("d") : nullptr;
+	view->ndim = data.shape.size();
+	view->shape = (flags & PyBUF_ND) ? data.shape.data() : nullptr;
+	view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ?
+		data.strides.data() : nullptr;
+	view->suboffsets = nullptr;
+	view->internal = nullptr;
+
+	return 0;
+}
+
+static PyObject *Array_shape(PyObject *self, void *)
+{
+	const ArrayData &data = *reinterpret_cast<ArrayObject*>(self)->data;
+
+	PyObject *ret{ PyTuple_New(data.shape.size()) };
+	if(ret == nullptr)
+		return nullptr;
+	for(size_t j = 0; j < data.shape.size(); ++j)
+		PyTuple_SET_ITEM(ret, j, PyLong_FromSsize_t(data.shape[j]));
+	return ret;
+}
+
+static PyBufferProcs ArrayBuffer;
+
+static PyGetSetDef ArrayGetSet[] = {
+	{ const_cast<char*>("shape"), Array_shape, nullptr,
+		const_cast<char*>("The number of values in each dimension."),
+		nullptr },
+	{ nullptr, nullptr, nullptr, nullptr, nullptr }
+};
+
+static void Simulation_dealloc(PyObject *self)
+{
+	delete reinterpret_cast<SimulationObject*>(self)->state;
+	Py_TYPE(self)->tp_free(self);
+}
+
+static PyObject *Simulation_new(PyTypeObject *type, PyObject *args,
+	PyObject *kwargs)
+{
+	static const char *keywords[] = { "deck", nullptr };
+	const char *deck{ nullptr };
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "s",
+		const_cast<char**>(keywords), &deck))
+	{
+		return nullptr;
+	}
+
+	// errors in the deck are reported (in the log) as by molstat-simulator
+	unique_ptr<SimulationState> state{ new SimulationState };
+	ostringstream log;
+	try
+	{
+		istringstream input(deck);
+		state->parser.readInput(input, log);
+		state->sim = state->parser.createSimulator(log);
+		state->log = log.str();
+	}
+	catch(const exception &e)
+	{
+		PyErr_SetString(PyExc_ValueError,
+			(string(e.what()) + "\n" + log.str()).c_str());
+		return nullptr;
+	}
+
+	if(state->parser.getTraceProtocol() != nullptr)
+	{
+		PyErr_SetString(PyExc_ValueError,
+			"Traces are not supported by the Python module.");
+		return nullptr;
+	}
+
+	// the trials are returned without their importance weights
+	if(state->sim->isWeighted())
+	{
+		PyErr_SetString(PyExc_ValueError,
+			"Importance sampling is not supported by the Python module.");
+		return nullptr;
+	}
+
+	state->engine.reset(new molstat::Engine(state->parser.seed(),
+		state->parser.stream(), state->parser.engineKind()));
+
+	SimulationObject *ret{
+		reinterpret_cast<SimulationObject*>(type->tp_alloc(type, 0)) };
+	if(ret == nullptr)
+		return nullptr;
+
+	ret->state = state.release();
+	return reinterpret_cast<PyObject*>(ret);
+}
+
+/**
+ * \brief Simulates trials, keeping those that produce all of the
+ *    observables.
+ *
+ * \param[in] state The simulation.
+ * \param[in] ntrials The number of trials.
+ * \return The observables of the kept trials, row-major.
+ */
+static vector<double> SimulateTrials(SimulationState &state,
+	size_t ntrials)
+{
+	const size_t nobs{ state.sim->numObservables() };
+	vector<double> ret(ntrials * nobs), workspace;
+
+	const size_t nkept{ state.sim->simulateBatch(*state.engine, ntrials,
+		ret.data(), workspace) };
+	ret.resize(nkept * nobs);
+
+	return ret;
+}
+
+static PyObject *Simulation_simulate(PyObject *self, PyObject *args)
+{
+	SimulationState &state = *reinterpret_cast<SimulationObject*>(self)->state;
+
+	Py_ssize_t ntrials;
+	if(!PyArg_ParseTuple(args, "n", &ntrials))
+		return nullptr;
+	if(ntrials < 0)
+	{
+		PyErr_SetString(PyExc_ValueError,
+			"The number of trials cannot be negative.");
+		return nullptr;
+	}
+
+	try
+	{
+		ArrayData data;
+		data.values = SimulateTrials(state, ntrials);
+
+		const Py_ssize_t nobs = state.sim->numObservables();
+		data.shape = { static_cast<Py_ssize_t>(data.values.size()) / nobs,
+			nobs };
+		data.strides = { static_cast<Py_ssize_t>(nobs * sizeof(double)),
+			sizeof(double) };
+
+		return NewArray(move(data));
+	}
+	catch(...)
+	{
+		return SetPythonError();
+	}
+}
+
+/**
+ * \brief Makes the Python result of a histogram: its bin counts and the bin
+ *    coordinates of each dimension.
+ *
+ * \param[in] hist The (binned) histogram.
+ * \return The tuple (counts, coordinates); nullptr (with a Python
+ *    exception) on failure.
+ */
+static PyObject *HistogramResult(const molstat::Histogram &hist)
+{
+	const size_t ndim{ hist.numDimensions() };
+
+	// the counts are column-major (dimension 0 varies fastest), which the
+	// strides describe
+	ArrayData counts;
+	counts.values = hist.getBinCounts();
+	Py_ssize_t stride{ sizeof(double) };
+	for(size_t j = 0; j < ndim; ++j)
+	{
+		counts.shape.push_back(hist.numBins(j));
+		counts.strides.push_back(stride);
+		stride *= hist.numBins(j);
+	}
+
+	PyObject *coordinates{ PyList_New(ndim) };
+	if(coordinates == nullptr)
+		return nullptr;
+	for(size_t j = 0; j < ndim; ++j)
+	{
+		PyObject *array{ NewArray(hist.getBinCoordinates(j)) };
+		if(array == nullptr)
+		{
+			Py_DECREF(coordinates);
+			return nullptr;
+		}
+		PyList_SET_ITEM(coordinates, j, array);
+	}
+
+	PyObject *array{ NewArray(move(counts)) };
+	if(array == nullptr)
+	{
+		Py_DECREF(coordinates);
+		return nullptr;
+	}
+
+	return Py_BuildValue("(NN)", array, coordinates);
+}
+
+static PyObject *Simulation_histogram(PyObject *self, PyObject *args)
+{
+	SimulationState &state = *reinterpret_cast<SimulationObject*>(self)->state;
+
+	Py_ssize_t ntrials;
+	PyObject *callback{ Py_None };
+	double fraction{ 0.1 };
+	if(!PyArg_ParseTuple(args, "n|Od", &ntrials, &callback, &fraction))
+		return nullptr;
+	if(ntrials <= 0)
+	{
+		PyErr_SetString(PyExc_ValueError,
+			"There must be at least one trial.");
+		return nullptr;
+	}
+	if(callback == Py_None)
+		callback = nullptr;
+	else if(!PyCallable_Check(callback))
+	{
+		PyErr_SetString(PyExc_TypeError, "The callback must be callable.");
+		return nullptr;
+	}
+	if(!(fraction > 0. && fraction <= 1.))
+	{
+		PyErr_SetString(PyExc_ValueError,
+			"The fraction of the trials between callbacks must be in (0, 1].");
+		return nullptr;
+	}
+
+	try
+	{
+		const size_t nobs{ state.sim->numObservables() };
+
+		// bin the trials as the simulator does: in fixed bounds if every
+		// dimension has them, otherwise in the extremes of the data
+		vector<shared_ptr<const molstat::BinStyle>> bstyles;
+		bool streaming{ true };
+		for(const auto &bstyle : state.parser.getBinStyles())
+		{
+			bstyles.push_back(bstyle);
+			streaming = streaming && bstyle->hasBounds();
+		}
+		if(callback != nullptr && !streaming)
+		{
+			PyErr_SetString(PyExc_ValueError, "Partial histograms need fixed " \
+				"bounds for every observable.");
+			return nullptr;
+		}
+
+		// with a callback, the trials are simulated (and binned) in parts, and
+		// the histogram of the trials so far is passed on after each part but
+		// the last
+		molstat::Histogram hist{ streaming ? molstat::Histogram(bstyles) :
+			molstat::Histogram(nobs) };
+		const size_t part{ callback == nullptr ? size_t(ntrials) :
+			max<size_t>(1, ceil(fraction * ntrials)) };
+		for(size_t done = 0; done < size_t(ntrials);)
+		{
+			const size_t n{ min(part, size_t(ntrials) - done) };
+			const vector<double> values{ SimulateTrials(state, n) };
+			hist.add_data(values.data(), values.size() / nobs);
+			done += n;
+
+			if(callback != nullptr && done < size_t(ntrials))
+			{
+				PyObject *partial{ HistogramResult(hist) };
+				if(partial == nullptr)
+					return nullptr;
+				PyObject *result{ PyObject_CallFunction(callback, "OOn",
+					PyTuple_GET_ITEM(partial, 0), PyTuple_GET_ITEM(partial, 1),
+					static_cast<Py_ssize_t>(done)) };
+				Py_DECREF(partial);
+				if(result == nullptr)
+					return nullptr; // the callback raised an exception
+				Py_DECREF(result);
+			}
+		}
+		if(!streaming)
+			hist.bin_data(bstyles);
+
+		return HistogramResult(hist);
+	}
+	catch(...)
+	{
+		return SetPythonError();
+	}
+}
+
+/**
+ * \brief Makes a Python list of strings.
+ *
+ * \param[in] strings The strings.
+ * \return The list; nullptr (with a Python exception) on failure.
+ */
+static PyObject *StringList(const vector<string> &strings)
+{
+	PyObject *ret{ PyList_New(strings.size()) };
+	if(ret == nullptr)
+		return nullptr;
+
+	for(size_t j = 0; j < strings.size(); ++j)
+	{
+		PyObject *str{ PyUnicode_FromString(strings[j].c_str()) };
+		if(str == nullptr)
+		{
+			Py_DECREF(ret);
+			return nullptr;
+		}
+		PyList_SET_ITEM(ret, j, str);
+	}
+
+	return ret;
+}
+
+static PyObject *Simulation_observables(PyObject *self, void *)
+{
+	const SimulationState &state =
+		*reinterpret_cast<SimulationObject*>(self)->state;
+	return StringList(state.parser.getObservableNames());
+}
+
+static PyObject *Simulation_parameters(PyObject *self, void *)
+{
+	const SimulationState &state =
+		*reinterpret_cast<SimulationObject*>(self)->state;
+	return StringList(state.sim->getParameterNames());
+}
+
+static PyObject *Simulation_log(PyObject *self, void *)
+{
+	const SimulationState &state =
+		*reinterpret_cast<SimulationObject*>(self)->state;
+	return PyUnicode_FromString(state.log.c_str());
+}
+
+static PyMethodDef SimulationMethods[] = {
+	{ "simulate", Simulation_simulate, METH_VARARGS,
+		"simulate(ntrials)\n\n"
+		"Simulates ntrials trials. Returns an Array of shape (nkept, nobs)\n"
+		"with the observables of the trials that produced all of them." },
+	{ "histogram", Simulation_histogram, METH_VARARGS,
+		"histogram(ntrials[, callback[, fraction]])\n\n"
+		"Simulates ntrials trials and bins them as specified by the deck.\n"
+		"Returns (counts, coordinates): an Array with the (weighted) count\n"
+		"of each bin, indexed by the bin of each observable, and a list of\n"
+		"Arrays with the bin coordinates of each observable.\n\n"
+		"With a callback (and fixed bounds), the trials are simulated in\n"
+		"parts of fraction (default 0.1) of ntrials, and after each part\n"
+		"but the last, callback(counts, coordinates, ntrials_so_far) is\n"
+		"called with the histogram so far." },
+	{ nullptr, nullptr, 0, nullptr }
+};
+
+static PyGetSetDef SimulationGetSet[] = {
+	{ const_cast<char*>("observables"), Simulation_observables, nullptr,
+		const_cast<char*>("The names of the observables, in order."),
+		nullptr },
+	{ const_cast<char*>("parameters"), Simulation_parameters, nullptr,
+		const_cast<char*>("The names of the model parameters."), nullptr },
+	{ const_cast<char*>("log"), Simulation_log, nullptr,
+		const_cast<char*>("The messages from reading the input deck."),
+		nullptr },
+	{ nullptr, nullptr, nullptr, nullptr, nullptr }
+};
+
+static PyModuleDef MolStatModule = {
+	PyModuleDef_HEAD_INIT,
+	"molstat",
+	"Simulates single-molecule data in-process with MolStat.",
+	-1,
+	nullptr, nullptr, nullptr, nullptr, nullptr
+};
+
+/**
+ * \brief Initializes the Python module.
+ *
+ * \return The module; nullptr (with a Python exception) on failure.
+ */
+PyMODINIT_FUNC PyInit_molstat()
+{
+	ArrayBuffer.bf_getbuffer = Array_getbuffer;
+	ArrayBuffer.bf_releasebuffer = nullptr;
+
+	ArrayType.tp_name = "molstat.Array";
+	ArrayType.tp_basicsize = sizeof(ArrayObject);
+	ArrayType.tp_dealloc = Array_dealloc;
+	ArrayType.tp_as_buffer = &ArrayBuffer;
+	ArrayType.tp_flags = Py_TPFLAGS_DEFAULT;
+	ArrayType.tp_doc = "Results of a simulation; use numpy.asarray (or " \
+		"memoryview) to view them without copying.";
+	ArrayType.tp_getset = ArrayGetSet;
+
+	SimulationType.tp_name = "molstat.Simulation";
+	SimulationType.tp_basicsize = sizeof(SimulationObject);
+	SimulationType.tp_dealloc = Simulation_dealloc;
+	SimulationType.tp_flags = Py_TPFLAGS_DEFAULT;
+	SimulationType.tp_doc = "Simulation(deck)\n\n" \
+		"A simulation described by a molstat-simulator input deck.";
+	SimulationType.tp_methods = SimulationMethods;
+	SimulationType.tp_getset = SimulationGetSet;
+	SimulationType.tp_new = Simulation_new;
+
+	if(PyType_Ready(&ArrayType) < 0 || PyType_Ready(&SimulationType) < 0)
+		return nullptr;
+
+	PyObject *module{ PyModule_Create(&MolStatModule) };
+	if(module == nullptr)
+		return nullptr;
+
+	Py_INCREF(&ArrayType);
+	PyModule_AddObject(module, "Array",
+		reinterpret_cast<PyObject*>(&ArrayType));
+	Py_INCREF(&SimulationType);
+	PyModule_AddObject(module, "Simulation",
+		reinterpret_cast<PyObject*>(&SimulationType));
+
+	return module;
+}
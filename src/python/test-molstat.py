@@ -0,0 +1,92 @@
+# This file is a part of MolStat, which is distributed under the Creative
+# Commons Attribution-NonCommercial 4.0 International Public License.
+#
+# (c) 2014 Northwestern University.
+
+##
+ # @file python/test-molstat.py
+ # @brief Make sure that the Python module simulates the same trials and
+ #    histograms as the deck specifies, passes on partial histograms, and
+ #    that it reports bad decks.
+ #
+ # @test Test suite for the Python module.
+ #
+ # @author Matthew G.\ Reuter
+ # @date November 2014
+
+import molstat
+
+## @cond
+
+bins = 20
+deck = \
+	'observable Identity ' + str(bins) + ' linear bounds -4 4\n' \
+	'model IdentityModel\n' \
+	'	distribution parameter normal 1. 0.5\n' \
+	'endmodel\n' \
+	'seed 2014\n'
+
+sim = molstat.Simulation(deck)
+assert sim.observables == ['identity']
+assert sim.parameters == ['parameter']
+
+# the trials, viewed without copying
+trials = sim.simulate(10000)
+assert trials.shape == (10000, 1)
+view = memoryview(trials)
+assert view.format == 'd' and view.shape == (10000, 1)
+values = [row[0] for row in view.tolist()]
+mean = sum(values) / len(values)
+assert abs(mean - 1.) < 0.05
+
+# the same seed gives the same trials, and later calls continue the stream
+again = molstat.Simulation(deck)
+assert memoryview(again.simulate(10000)).tolist() == view.tolist()
+assert memoryview(sim.simulate(10)).tolist() != \
+	memoryview(molstat.Simulation(deck).simulate(10)).tolist()
+
+# the histogram has the bins of the deck
+counts, coordinates = sim.histogram(5000)
+assert counts.shape == (bins,)
+assert len(coordinates) == 1 and coordinates[0].shape == (bins,)
+centers = memoryview(coordinates[0]).tolist()
+assert abs(centers[0] + 3.8) < 1.e-12 and abs(centers[-1] - 3.8) < 1.e-12
+assert sum(memoryview(counts).tolist()) > 0.
+
+# with a callback, the histogram so far is passed on after each part; the
+# callback can stop the simulation by raising an exception
+parts = []
+def record(counts, coordinates, ntrials):
+	assert counts.shape == (bins,) and len(coordinates) == 1
+	parts.append((ntrials, sum(memoryview(counts).tolist())))
+counts, coordinates = sim.histogram(1000, record, 0.25)
+assert [part[0] for part in parts] == [250, 500, 750]
+assert parts[0][1] <= parts[1][1] <= parts[2][1] <= \
+	sum(memoryview(counts).tolist())
+
+class Stop(Exception):
+	pass
+def stop(counts, coordinates, ntrials):
+	raise Stop()
+try:
+	sim.histogram(1000, stop)
+	assert False
+except Stop:
+	pass
+
+# partial histograms need fixed bounds
+try:
+	molstat.Simulation(deck.replace(' bounds -4 4', '')).histogram(100,
+		record)
+	assert False
+except ValueError:
+	pass
+
+# bad decks are reported
+try:
+	molstat.Simulation('observable Identity 10 linear\n')
+	assert False
+except ValueError:
+	pass
+
+## @endcond
@@ -7,6 +7,11 @@ import numpy as np
 # and the symmetric one site channel model in MolStat.
 # This simulation process works by simulating single traces using MolStat
 # These single traces are then histogrammed
+# (molstat-simulator can now simulate such traces in a single process using a
+# "trace" block in the input deck; see ../TraceInput.txt. With the
+# ImageChargeChannel model, the separation is a model parameter and the
+# image-charge and coupling renormalizations are applied by MolStat; see
+# ../ImageChargeTraceInput.txt)
 
 # To simulate a single trace, a file for the trace number is created
 # Then, a single trial input is run in molstat for each distance point
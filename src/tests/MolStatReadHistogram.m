@@ -0,0 +1,65 @@
+function [counts, coords, ntrials, nbinned] = MolStatReadHistogram(filename)
+% MolStatReadHistogram  Reads a histogram written by molstat-simulator.
+%
+%   [counts, coords, ntrials, nbinned] = MolStatReadHistogram(filename)
+%
+%   Both the text and binary formats are accepted (see histogram_io.h).
+%   counts is an array with one dimension per histogram dimension, such that
+%   counts(i,j,...) is the count of the bin at coords{1}(i), coords{2}(j),
+%   and so on. ntrials and nbinned (the numbers of trials and of binned
+%   trials) are only available for binary histograms; they are NaN for text
+%   histograms.
+
+fid = fopen(filename, 'r', 'l');
+if fid < 0
+    error('Unable to open %s.', filename);
+end
+cleanup = onCleanup(@() fclose(fid));
+
+magic = fread(fid, [1 8], '*char');
+if ~strcmp(magic, 'MOLSTATH')
+    % text: one bin per line, the coordinates followed by the count
+    frewind(fid);
+    data = table2array(readtable(filename, 'FileType', 'text', ...
+        'ReadVariableNames', false, 'Delimiter', ' ', ...
+        'MultipleDelimsAsOne', true));
+    ndim = size(data, 2) - 1;
+    coords = cell(1, ndim);
+    nbins = zeros(1, max(ndim, 2));
+    nbins(:) = 1;
+    for j = 1:ndim
+        coords{j} = unique(data(:, j), 'stable');
+        nbins(j) = numel(coords{j});
+    end
+    % the first dimension changes the fastest, as in Matlab
+    counts = reshape(data(:, end), nbins);
+    ntrials = NaN;
+    nbinned = NaN;
+    return;
+end
+
+header = fread(fid, 4, 'uint64');
+if header(1) ~= 1
+    error('Unsupported binary histogram version in %s.', filename);
+end
+ndim = header(2);
+ntrials = header(3);
+nbinned = header(4);
+
+nbins = zeros(1, max(ndim, 2));
+nbins(:) = 1;
+for j = 1:ndim
+    nbins(j) = fread(fid, 1, 'uint64');
+    fread(fid, 2, 'double'); % bounds
+    len = fread(fid, 1, 'uint64');
+    fread(fid, [1 len], '*char'); % binning style
+end
+
+coords = cell(1, ndim);
+for j = 1:ndim
+    coords{j} = fread(fid, nbins(j), 'double');
+end
+
+% the first dimension changes the fastest, as in Matlab
+counts = reshape(fread(fid, prod(nbins), 'double'), nbins);
+end
@@ -0,0 +1,75 @@
+# This file is a part of MolStat, which is distributed under the Creative
+# Commons Attribution-NonCommercial 4.0 International Public License.
+#
+# (c) 2014 Northwestern University.
+
+##
+ # @file tests/simulator-seed.py
+ # @brief Make sure that simulations are reproducible for a given seed,
+ #    stream, and number of threads (or blocks, for any number of threads).
+ # 
+ # @test Test suite for the simulator program.
+ #
+ # @author Matthew G.\ Reuter
+ # @date November 2014
+
+import subprocess
+import os
+
+## @cond
+
+# runtime variables
+trials = 100000
+datfile = 'hist-seed.dat'
+bins = 20
+
+# runs the simulator and returns the histogram (as a string)
+def simulate(extra):
+	process = subprocess.Popen('../molstat-simulator', \
+		stdout=subprocess.PIPE, \
+		stdin=subprocess.PIPE, \
+		stderr=subprocess.PIPE)
+	output = process.communicate( \
+	'observable Identity ' + str(bins) + ' linear\n' \
+	'model IdentityModel\n' \
+	'	distribution parameter normal 0. 1.\n' \
+	'endmodel\n' \
+	'trials ' + str(trials) + '\n' \
+	'output ' + datfile + '\n' + extra)
+
+	hist = open(datfile, 'r')
+	ret = hist.read()
+	hist.close()
+
+	# delete the output histogram file
+	os.remove(datfile)
+
+	assert(len(ret) > 0)
+	return ret
+
+for engine in ['xoshiro256++', 'pcg64', 'philox4x32']:
+	print engine
+	base = 'rng ' + engine + '\nthreads 3\nseed 12345\n'
+
+	# the same seed, stream, and number of threads reproduce the histogram
+	ref = simulate(base)
+	assert(simulate(base) == ref)
+	assert(simulate(base + 'stream 0\n') == ref)
+
+	# different seeds or streams do not
+	assert(simulate(base + 'stream 1\n') != ref)
+	assert(simulate(base + 'seed 54321\n') != ref)
+
+	# with blocks, the histogram does not depend on the number of threads
+	ref = simulate(base + 'blocks 6\n')
+	for threads in [1, 2, 4, 7]:
+		assert(simulate(base + 'blocks 6\nthreads ' + str(threads) + '\n') == \
+			ref)
+
+	# one block per thread is the default
+	assert(simulate(base + 'blocks 3\n') == simulate(base))
+
+# without a seed, a different seed is used each time
+assert(simulate('') != simulate(''))
+
+## @endcond
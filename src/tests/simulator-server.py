@@ -0,0 +1,65 @@
+# This file is a part of MolStat, which is distributed under the Creative
+# Commons Attribution-NonCommercial 4.0 International Public License.
+#
+# (c) 2014 Northwestern University.
+
+##
+ # @file tests/simulator-server.py
+ # @brief Make sure that the simulator's server mode runs each job, keeps
+ #    the base deck, and reports failed jobs without stopping.
+ #
+ # @test Test suite for the simulator program.
+ #
+ # @author Matthew G.\ Reuter
+ # @date November 2014
+
+import subprocess
+import os
+
+## @cond
+
+# runtime variables
+datfiles = ['hist-server-1.dat', 'hist-server-3.dat']
+bins = 20
+
+process = subprocess.Popen(['../molstat-simulator', '--server'], \
+	stdout=subprocess.PIPE, \
+	stdin=subprocess.PIPE, \
+	stderr=subprocess.PIPE)
+output = process.communicate(( \
+	'observable Identity ' + str(bins) + ' linear\n' \
+	'model IdentityModel\n' \
+	'	distribution parameter normal 0. 1.\n' \
+	'endmodel\n' \
+	'trials 1000\n' \
+	'seed 12345\n' \
+	'base\n' \
+	'output ' + datfiles[0] + '\n' \
+	'run\n' \
+	'trials 0\n' \
+	'run\n' \
+	'output ' + datfiles[1] + '\n' \
+	'run\n' \
+	'quit\n').encode())[0].decode()
+
+# the second job fails; the others (from the same base deck) do not
+status = [line for line in output.splitlines() \
+	if line.startswith('done ') or line.startswith('error ')]
+assert(status == ['done 1', 'error 2', 'done 3'])
+assert('FATAL ERROR' in output)
+assert(process.returncode == 0)
+
+# both successful jobs wrote the same histogram
+hists = []
+for datfile in datfiles:
+	hist = open(datfile, 'r')
+	hists.append(hist.read())
+	hist.close()
+
+	# delete the output histogram file
+	os.remove(datfile)
+
+assert(len(hists[0]) > 0)
+assert(hists[0] == hists[1])
+
+## @endcond